@@ -39,8 +39,29 @@
  *    One can peek at the data on any given GstAggregatorPad with the
  *    gst_aggregator_pad_get_buffer () method, and take ownership of it
  *    with the gst_aggregator_pad_steal_buffer () method. When a buffer
- *    has been taken with steal_buffer (), a new buffer can be queued
- *    on that pad.
+ *    has been taken with steal_buffer (), the next buffer queued on that
+ *    pad, if any, takes its place.
+ *  </para></listitem>
+ *  <listitem><para>
+ *    Each GstAggregatorPad queues incoming buffers up to the limits set
+ *    with its "max-buffers" and "max-time" properties, upstream is only
+ *    blocked once those are reached. By default a single buffer is queued.
+ *  </para></listitem>
+ *  <listitem><para>
+ *    Serialized events, such as CAPS or SEGMENT, received while buffers are
+ *    queued on a pad are queued with them. They are handed to the
+ *    sink_event () vmethod from the aggregation thread once the buffers
+ *    before them have been consumed, so they only apply to the buffers
+ *    that follow them.
+ *  </para></listitem>
+ *  <listitem><para>
+ *    When upstream is live, the subclass' aggregate () method is also called
+ *    once the clock reaches the running time of the next output buffer plus
+ *    the latency, even if some pads have no data at that point. Those pads
+ *    are marked as late (see gst_aggregator_pad_is_late ()) and a
+ *    "GstAggregatorPadLate" element message is posted for each of them. The
+ *    "latency" property adds to the upstream latency to give slow inputs
+ *    more time to deliver.
  *  </para></listitem>
  *  <listitem><para>
  *    If the subclass wishes to push a buffer downstream in its aggregate
@@ -69,6 +90,7 @@
 /*  Might become API */
 static void gst_aggregator_merge_tags (GstAggregator * aggregator,
     const GstTagList * tags, GstTagMergeMode mode);
+static inline void _add_aggregate_gsource (GstAggregator * self);
 
 GST_DEBUG_CATEGORY_STATIC (aggregator_debug);
 #define GST_CAT_DEFAULT aggregator_debug
@@ -106,6 +128,16 @@ GST_DEBUG_CATEGORY_STATIC (aggregator_debug);
   g_cond_broadcast(&(((GstAggregatorPad* )pad)->priv->event_cond)); \
   }
 
+#define DEFAULT_PAD_MAX_BUFFERS 1
+#define DEFAULT_PAD_MAX_TIME    0
+
+enum
+{
+  PAD_PROP_0,
+  PAD_PROP_MAX_BUFFERS,
+  PAD_PROP_MAX_TIME
+};
+
 struct _GstAggregatorPadPrivate
 {
   gboolean pending_flush_start;
@@ -113,17 +145,179 @@ struct _GstAggregatorPadPrivate
   gboolean pending_eos;
   gboolean flushing;
 
+  /* buffers and serialized events queued behind GstAggregatorPad->buffer,
+   * oldest first, and how many of them are buffers */
+  GQueue queue;
+  guint num_buffers;
+  /* queue limits, 0 for none */
+  guint max_buffers;
+  GstClockTime max_time;
+
+  /* missed the last live deadline, and how often it happened */
+  gboolean late;
+  guint64 late_count;
+
   GMutex event_lock;
   GCond event_cond;
 };
 
+static inline GstClockTime
+_buffer_running_time (GstAggregatorPad * aggpad, GstBuffer * buffer)
+{
+  GstClockTime ts = GST_BUFFER_DTS (buffer);
+
+  if (!GST_CLOCK_TIME_IS_VALID (ts))
+    ts = GST_BUFFER_PTS (buffer);
+
+  return gst_segment_to_running_time (&aggpad->segment, GST_FORMAT_TIME, ts);
+}
+
+/* Must be called with the pad EVENT lock */
+static gboolean
+_aggpad_queue_is_empty (GstAggregatorPad * aggpad)
+{
+  return aggpad->buffer == NULL && g_queue_is_empty (&aggpad->priv->queue);
+}
+
+/* Must be called with the pad EVENT lock */
+static GstBuffer *
+_aggpad_peek_queued_buffer (GstAggregatorPad * aggpad, gboolean tail)
+{
+  GList *l = tail ? aggpad->priv->queue.tail : aggpad->priv->queue.head;
+
+  for (; l; l = tail ? l->prev : l->next) {
+    if (GST_IS_BUFFER (l->data))
+      return l->data;
+  }
+
+  return NULL;
+}
+
+/* Must be called with the pad EVENT lock */
+static gboolean
+_aggpad_queue_is_full (GstAggregatorPad * aggpad)
+{
+  GstAggregatorPadPrivate *priv = aggpad->priv;
+  guint n_buffers;
+
+  n_buffers = priv->num_buffers + (aggpad->buffer ? 1 : 0);
+  if (n_buffers == 0)
+    return FALSE;
+
+  if (priv->max_buffers && n_buffers >= priv->max_buffers)
+    return TRUE;
+
+  if (priv->max_time && n_buffers > 1) {
+    GstBuffer *head, *tail;
+    GstClockTime start, end;
+
+    head = aggpad->buffer ? aggpad->buffer :
+        _aggpad_peek_queued_buffer (aggpad, FALSE);
+    tail = _aggpad_peek_queued_buffer (aggpad, TRUE);
+
+    start = _buffer_running_time (aggpad, head);
+    end = _buffer_running_time (aggpad, tail);
+    if (GST_CLOCK_TIME_IS_VALID (end) && GST_BUFFER_DURATION_IS_VALID (tail))
+      end += GST_BUFFER_DURATION (tail);
+
+    if (GST_CLOCK_TIME_IS_VALID (start) && GST_CLOCK_TIME_IS_VALID (end) &&
+        end > start && end - start >= priv->max_time)
+      return TRUE;
+  }
+
+  return FALSE;
+}
+
+/* Must be called with the pad EVENT lock. Makes the next queued buffer the
+ * head of the queue, unless a serialized event has to be handled first */
+static void
+_aggpad_promote_buffer (GstAggregatorPad * aggpad)
+{
+  GstAggregatorPadPrivate *priv = aggpad->priv;
+
+  if (aggpad->buffer == NULL &&
+      GST_IS_BUFFER (g_queue_peek_head (&priv->queue))) {
+    aggpad->buffer = g_queue_pop_head (&priv->queue);
+    priv->num_buffers--;
+  }
+
+  if (_aggpad_queue_is_empty (aggpad) && priv->pending_eos) {
+    priv->pending_eos = FALSE;
+    aggpad->eos = TRUE;
+  }
+  PAD_BROADCAST_EVENT (aggpad);
+}
+
+/* Must be called with the pad EVENT lock */
+static GstBuffer *
+_aggpad_pop_buffer (GstAggregatorPad * aggpad)
+{
+  GstBuffer *buffer = aggpad->buffer;
+
+  aggpad->buffer = NULL;
+  _aggpad_promote_buffer (aggpad);
+
+  return buffer;
+}
+
+/* Must be called with the pad EVENT lock. Queued events are kept, they
+ * still have to reach the subclass, unless @events is TRUE */
+static void
+_aggpad_drop_buffers (GstAggregatorPad * aggpad, gboolean events)
+{
+  GstAggregatorPadPrivate *priv = aggpad->priv;
+  GList *l, *next;
+
+  gst_buffer_replace (&aggpad->buffer, NULL);
+
+  for (l = priv->queue.head; l; l = next) {
+    next = l->next;
+    if (events || GST_IS_BUFFER (l->data)) {
+      gst_mini_object_unref (l->data);
+      g_queue_delete_link (&priv->queue, l);
+    }
+  }
+  priv->num_buffers = 0;
+
+  _aggpad_promote_buffer (aggpad);
+}
+
+/* Hands the serialized events at the head of the queue of @aggpad to the
+ * subclass, from the aggregation thread */
+static gboolean
+_aggpad_apply_queued_events (GstAggregator * self, GstAggregatorPad * aggpad,
+    gpointer user_data)
+{
+  GstAggregatorClass *klass = GST_AGGREGATOR_GET_CLASS (self);
+  GstEvent *event;
+
+  PAD_LOCK_EVENT (aggpad);
+  while (aggpad->buffer == NULL &&
+      GST_IS_EVENT (g_queue_peek_head (&aggpad->priv->queue))) {
+    event = g_queue_pop_head (&aggpad->priv->queue);
+    PAD_UNLOCK_EVENT (aggpad);
+
+    GST_DEBUG_OBJECT (aggpad, "Handling queued event %" GST_PTR_FORMAT, event);
+    if (!klass->sink_event (self, aggpad, event))
+      GST_WARNING_OBJECT (aggpad, "Failed to handle queued event");
+
+    PAD_LOCK_EVENT (aggpad);
+  }
+  _aggpad_promote_buffer (aggpad);
+  PAD_UNLOCK_EVENT (aggpad);
+
+  return TRUE;
+}
+
 static gboolean
 _aggpad_flush (GstAggregatorPad * aggpad, GstAggregator * agg)
 {
   GstAggregatorPadClass *klass = GST_AGGREGATOR_PAD_GET_CLASS (aggpad);
 
   aggpad->eos = FALSE;
+  aggpad->priv->pending_eos = FALSE;
   aggpad->priv->flushing = FALSE;
+  aggpad->priv->late = FALSE;
 
   if (klass->flush)
     return klass->flush (aggpad, agg);
@@ -176,6 +370,24 @@ struct _GstAggregatorPrivate
 
   GstTagList *tags;
   gboolean tags_changed;
+
+  /* protected by the OBJECT_LOCK */
+  GstClockTime latency;         /* additional latency, property */
+  GstClockTime sub_latency_min; /* latency of the subclass */
+  GstClockTime sub_latency_max;
+  gboolean latency_live;        /* upstream latency from the last query */
+  GstClockTime latency_min;
+  GstClockTime latency_max;
+  GstClockID aggregate_id;      /* pending live deadline */
+  GstClockTime timeout_running_time;    /* last deadline reached */
+};
+
+#define DEFAULT_LATENCY 0
+
+enum
+{
+  PROP_0,
+  PROP_LATENCY
 };
 
 typedef struct
@@ -395,16 +607,154 @@ _remove_all_sources (GstAggregator * self)
   MAIN_CONTEXT_UNLOCK (self);
 }
 
+static void
+_unschedule_live_timeout (GstAggregator * self)
+{
+  GstAggregatorPrivate *priv = self->priv;
+
+  GST_OBJECT_LOCK (self);
+  if (priv->aggregate_id) {
+    gst_clock_id_unschedule (priv->aggregate_id);
+    gst_clock_id_unref (priv->aggregate_id);
+    priv->aggregate_id = NULL;
+  }
+  priv->timeout_running_time = GST_CLOCK_TIME_NONE;
+  GST_OBJECT_UNLOCK (self);
+}
+
+static gboolean
+_live_timeout_cb (GstClock * clock, GstClockTime time, GstClockID id,
+    GstAggregator * self)
+{
+  GST_DEBUG_OBJECT (self, "Live deadline %" GST_TIME_FORMAT " reached",
+      GST_TIME_ARGS (time));
+
+  if (self->priv->running)
+    _add_aggregate_gsource (self);
+
+  return TRUE;
+}
+
+/* Returns TRUE if upstream is live and the deadline of the next output
+ * buffer passed, otherwise makes sure we try to aggregate again once it
+ * does. */
+static gboolean
+_check_live_timeout (GstAggregator * self, GstClockTime * running_time)
+{
+  GstAggregatorPrivate *priv = self->priv;
+  GstClockTime position, deadline, now;
+  GstClock *clock;
+
+  GST_OBJECT_LOCK (self);
+  clock = GST_ELEMENT_CLOCK (self);
+  if (!priv->latency_live || clock == NULL ||
+      GST_STATE (self) != GST_STATE_PLAYING ||
+      GST_ELEMENT (self)->numsinkpads == 0 ||
+      self->segment.format != GST_FORMAT_TIME)
+    goto no_timeout;
+
+  position = self->segment.position;
+  if (!GST_CLOCK_TIME_IS_VALID (position) || position < self->segment.start)
+    position = self->segment.start;
+  *running_time = gst_segment_to_running_time (&self->segment,
+      GST_FORMAT_TIME, position);
+
+  /* Only time out once for a given output position */
+  if (!GST_CLOCK_TIME_IS_VALID (*running_time) ||
+      *running_time == priv->timeout_running_time)
+    goto no_timeout;
+
+  deadline = GST_ELEMENT_CAST (self)->base_time + *running_time +
+      priv->latency_min + priv->sub_latency_min + priv->latency;
+  now = gst_clock_get_time (clock);
+
+  if (now >= deadline) {
+    GST_DEBUG_OBJECT (self, "Missed the deadline of running time %"
+        GST_TIME_FORMAT " by %" GST_TIME_FORMAT, GST_TIME_ARGS (*running_time),
+        GST_TIME_ARGS (now - deadline));
+    priv->timeout_running_time = *running_time;
+    if (priv->aggregate_id) {
+      gst_clock_id_unschedule (priv->aggregate_id);
+      gst_clock_id_unref (priv->aggregate_id);
+      priv->aggregate_id = NULL;
+    }
+    GST_OBJECT_UNLOCK (self);
+    return TRUE;
+  }
+
+  if (priv->aggregate_id) {
+    if (gst_clock_id_get_time (priv->aggregate_id) == deadline)
+      goto no_timeout;
+
+    gst_clock_id_unschedule (priv->aggregate_id);
+    gst_clock_id_unref (priv->aggregate_id);
+  }
+
+  GST_LOG_OBJECT (self, "Waiting for the deadline %" GST_TIME_FORMAT,
+      GST_TIME_ARGS (deadline));
+  priv->aggregate_id = gst_clock_new_single_shot_id (clock, deadline);
+  gst_clock_id_wait_async (priv->aggregate_id,
+      (GstClockCallback) _live_timeout_cb, gst_object_ref (self),
+      (GDestroyNotify) gst_object_unref);
+
+no_timeout:
+  GST_OBJECT_UNLOCK (self);
+  return FALSE;
+}
+
+static gboolean
+_mark_late_pads (GstAggregator * self, GstAggregatorPad * aggpad,
+    GstClockTime * running_time)
+{
+  gboolean late;
+  guint64 count = 0;
+
+  PAD_LOCK_EVENT (aggpad);
+  late = aggpad->buffer == NULL && !aggpad->eos;
+  aggpad->priv->late = late;
+  if (late)
+    count = ++aggpad->priv->late_count;
+  PAD_UNLOCK_EVENT (aggpad);
+
+  if (late) {
+    GST_DEBUG_OBJECT (aggpad, "No data for running time %" GST_TIME_FORMAT
+        ", late %" G_GUINT64_FORMAT " times", GST_TIME_ARGS (*running_time),
+        count);
+    gst_element_post_message (GST_ELEMENT_CAST (self),
+        gst_message_new_element (GST_OBJECT_CAST (self),
+            gst_structure_new ("GstAggregatorPadLate",
+                "pad", GST_TYPE_PAD, aggpad,
+                "running-time", G_TYPE_UINT64, *running_time,
+                "late-count", G_TYPE_UINT64, count, NULL)));
+  }
+
+  return TRUE;
+}
+
 static gboolean
 aggregate_func (GstAggregator * self)
 {
   GstAggregatorPrivate *priv = self->priv;
   GstAggregatorClass *klass = GST_AGGREGATOR_GET_CLASS (self);
+  GstClockTime running_time;
 
   GST_LOG_OBJECT (self, "Checking aggregate");
-  while (priv->send_eos && gst_aggregator_iterate_sinkpads (self,
-          (GstAggregatorPadForeachFunc) _check_all_pads_with_data_or_eos,
-          NULL) && priv->running) {
+  while (priv->send_eos && priv->running) {
+    gst_aggregator_iterate_sinkpads (self,
+        (GstAggregatorPadForeachFunc) _aggpad_apply_queued_events, NULL);
+
+    if (!gst_aggregator_iterate_sinkpads (self,
+            (GstAggregatorPadForeachFunc) _check_all_pads_with_data_or_eos,
+            NULL)) {
+      if (!_check_live_timeout (self, &running_time))
+        break;
+
+      GST_DEBUG_OBJECT (self, "Live deadline reached, aggregating the "
+          "available data");
+      gst_aggregator_iterate_sinkpads (self,
+          (GstAggregatorPadForeachFunc) _mark_late_pads, &running_time);
+    }
+
     GST_TRACE_OBJECT (self, "Actually aggregating!");
 
     priv->flow_return = klass->aggregate (self);
@@ -445,6 +795,7 @@ static gboolean
 _start (GstAggregator * self)
 {
   self->priv->running = TRUE;
+  self->priv->timeout_running_time = GST_CLOCK_TIME_NONE;
   self->priv->send_stream_start = TRUE;
   self->priv->send_segment = TRUE;
   self->priv->send_eos = TRUE;
@@ -468,6 +819,7 @@ _stop_srcpad_task (GstAggregator * self, GstEvent * flush_start)
       flush_start ? "Pausing" : "Stopping");
 
   self->priv->running = FALSE;
+  _unschedule_live_timeout (self);
 
   /*  Clean the stack of GSource set on the MainContext */
   g_main_context_wakeup (self->priv->mcontext);
@@ -513,6 +865,7 @@ _flush (GstAggregator * self)
   GstAggregatorClass *klass = GST_AGGREGATOR_GET_CLASS (self);
 
   GST_DEBUG_OBJECT (self, "Flushing everything");
+  _unschedule_live_timeout (self);
   g_atomic_int_set (&priv->send_segment, TRUE);
   g_atomic_int_set (&priv->flush_seeking, FALSE);
   g_atomic_int_set (&priv->tags_changed, FALSE);
@@ -556,12 +909,11 @@ _sink_event (GstAggregator * self, GstAggregatorPad * aggpad, GstEvent * event)
   switch (GST_EVENT_TYPE (event)) {
     case GST_EVENT_FLUSH_START:
     {
-      GstBuffer *tmpbuf;
-
       g_atomic_int_set (&aggpad->priv->flushing, TRUE);
-      /*  Remove pad buffer and wake up the streaming thread */
-      tmpbuf = gst_aggregator_pad_steal_buffer (aggpad);
-      gst_buffer_replace (&tmpbuf, NULL);
+      /*  Remove pad buffers and wake up the streaming thread */
+      PAD_LOCK_EVENT (aggpad);
+      _aggpad_drop_buffers (aggpad, FALSE);
+      PAD_UNLOCK_EVENT (aggpad);
       if (g_atomic_int_compare_and_exchange (&padpriv->pending_flush_start,
               TRUE, FALSE) == TRUE) {
         GST_DEBUG_OBJECT (aggpad, "Expecting FLUSH_STOP now");
@@ -620,12 +972,12 @@ _sink_event (GstAggregator * self, GstAggregatorPad * aggpad, GstEvent * event)
     {
       GST_DEBUG_OBJECT (aggpad, "EOS");
 
-      /* We still have a buffer, and we don't want the subclass to have to
-       * check for it. Mark pending_eos, eos will be set when steal_buffer is
-       * called
+      /* We still have buffers, and we don't want the subclass to have to
+       * check for them. Mark pending_eos, eos will be set when steal_buffer
+       * has emptied the queue
        */
       PAD_LOCK_EVENT (aggpad);
-      if (!aggpad->buffer) {
+      if (_aggpad_queue_is_empty (aggpad)) {
         aggpad->eos = TRUE;
       } else {
         aggpad->priv->pending_eos = TRUE;
@@ -728,16 +1080,15 @@ failure:
 static void
 _release_pad (GstElement * element, GstPad * pad)
 {
-  GstBuffer *tmpbuf;
-
   GstAggregator *self = GST_AGGREGATOR (element);
   GstAggregatorPad *aggpad = GST_AGGREGATOR_PAD (pad);
 
   GST_INFO_OBJECT (pad, "Removing pad");
 
   g_atomic_int_set (&aggpad->priv->flushing, TRUE);
-  tmpbuf = gst_aggregator_pad_steal_buffer (aggpad);
-  gst_buffer_replace (&tmpbuf, NULL);
+  PAD_LOCK_EVENT (aggpad);
+  _aggpad_drop_buffers (aggpad, TRUE);
+  PAD_UNLOCK_EVENT (aggpad);
   gst_element_remove_pad (element, pad);
 
   /* Something changed make sure we try to aggregate */
@@ -793,12 +1144,114 @@ _request_new_pad (GstElement * element,
   return GST_PAD (agg_pad);
 }
 
+typedef struct
+{
+  gboolean result;
+  gboolean live;
+  GstClockTime min;
+  GstClockTime max;
+} LatencyData;
+
+static gboolean
+_query_latency_func (GstAggregator * self, GstPad * pad, LatencyData * data)
+{
+  GstQuery *query;
+  GstClockTime min, max;
+  gboolean live;
+
+  query = gst_query_new_latency ();
+
+  if (gst_pad_peer_query (pad, query)) {
+    gst_query_parse_latency (query, &live, &min, &max);
+
+    GST_LOG_OBJECT (pad, "got latency live:%s min:%" GST_TIME_FORMAT
+        " max:%" GST_TIME_FORMAT, live ? "true" : "false",
+        GST_TIME_ARGS (min), GST_TIME_ARGS (max));
+
+    /* take the maximum of the minimum latencies, and the minimum of the
+     * maximum ones */
+    if (min > data->min)
+      data->min = min;
+
+    if (GST_CLOCK_TIME_IS_VALID (max) &&
+        (!GST_CLOCK_TIME_IS_VALID (data->max) || max < data->max))
+      data->max = max;
+
+    data->live |= live;
+  } else {
+    GST_LOG_OBJECT (pad, "latency query failed");
+    data->result = FALSE;
+  }
+
+  gst_query_unref (query);
+
+  return TRUE;
+}
+
+static gboolean
+_query_latency (GstAggregator * self, GstQuery * query)
+{
+  GstAggregatorPrivate *priv = self->priv;
+  LatencyData data;
+
+  data.result = TRUE;
+  data.live = FALSE;
+  data.min = 0;
+  data.max = GST_CLOCK_TIME_NONE;
+
+  gst_aggregator_iterate_sinkpads (self,
+      (GstAggregatorPadForeachFunc) _query_latency_func, &data);
+
+  if (!data.result)
+    return FALSE;
+
+  if (GST_CLOCK_TIME_IS_VALID (data.max) && data.min > data.max) {
+    GST_ELEMENT_WARNING (self, CORE, CLOCK, (NULL),
+        ("Impossible to configure latency: max %" GST_TIME_FORMAT " < min %"
+            GST_TIME_FORMAT ". Add queues or other buffering elements.",
+            GST_TIME_ARGS (data.max), GST_TIME_ARGS (data.min)));
+    return FALSE;
+  }
+
+  GST_OBJECT_LOCK (self);
+  priv->latency_live = data.live;
+  priv->latency_min = data.min;
+  priv->latency_max = data.max;
+
+  /* add our own latency, we only time out in live mode */
+  if (data.live) {
+    data.min += priv->sub_latency_min + priv->latency;
+    if (GST_CLOCK_TIME_IS_VALID (data.max)) {
+      if (GST_CLOCK_TIME_IS_VALID (priv->sub_latency_max))
+        data.max += priv->sub_latency_max + priv->latency;
+      else
+        data.max = GST_CLOCK_TIME_NONE;
+    }
+  }
+  GST_OBJECT_UNLOCK (self);
+
+  GST_DEBUG_OBJECT (self, "Calculated total latency: live %s, min %"
+      GST_TIME_FORMAT ", max %" GST_TIME_FORMAT,
+      (data.live ? "yes" : "no"), GST_TIME_ARGS (data.min),
+      GST_TIME_ARGS (data.max));
+
+  gst_query_set_latency (query, data.live, data.min, data.max);
+
+  return TRUE;
+}
+
 static gboolean
 _src_query (GstAggregator * self, GstQuery * query)
 {
   gboolean res = TRUE;
 
   switch (GST_QUERY_TYPE (query)) {
+    case GST_QUERY_LATENCY:
+    {
+      res = _query_latency (self, query);
+
+      goto discard;
+    }
     case GST_QUERY_SEEKING:
     {
       GstFormat format;
@@ -1018,11 +1471,59 @@ _sink_query (GstAggregator * self, GstAggregatorPad * aggpad, GstQuery * query)
   return gst_pad_query_default (pad, GST_OBJECT (self), query);
 }
 
+static void
+gst_aggregator_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstAggregator *self = GST_AGGREGATOR (object);
+  gboolean changed = FALSE;
+
+  switch (prop_id) {
+    case PROP_LATENCY:
+    {
+      GstClockTime latency = g_value_get_uint64 (value);
+
+      GST_OBJECT_LOCK (self);
+      changed = self->priv->latency != latency;
+      self->priv->latency = latency;
+      GST_OBJECT_UNLOCK (self);
+      break;
+    }
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+
+  if (changed)
+    gst_element_post_message (GST_ELEMENT_CAST (self),
+        gst_message_new_latency (GST_OBJECT_CAST (self)));
+}
+
+static void
+gst_aggregator_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GstAggregator *self = GST_AGGREGATOR (object);
+
+  switch (prop_id) {
+    case PROP_LATENCY:
+      GST_OBJECT_LOCK (self);
+      g_value_set_uint64 (value, self->priv->latency);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
 static void
 gst_aggregator_finalize (GObject * object)
 {
   GstAggregator *self = (GstAggregator *) object;
 
+  if (self->priv->aggregate_id)
+    gst_clock_id_unref (self->priv->aggregate_id);
   g_mutex_clear (&self->priv->mcontext_lock);
 
   G_OBJECT_CLASS (aggregator_parent_class)->finalize (object);
@@ -1066,8 +1567,17 @@ gst_aggregator_class_init (GstAggregatorClass * klass)
   gstelement_class->release_pad = GST_DEBUG_FUNCPTR (_release_pad);
   gstelement_class->change_state = GST_DEBUG_FUNCPTR (_change_state);
 
+  gobject_class->set_property = gst_aggregator_set_property;
+  gobject_class->get_property = gst_aggregator_get_property;
   gobject_class->finalize = gst_aggregator_finalize;
   gobject_class->dispose = gst_aggregator_dispose;
+
+  g_object_class_install_property (gobject_class, PROP_LATENCY,
+      g_param_spec_uint64 ("latency", "Buffer latency",
+          "Additional latency in live mode to allow upstream "
+          "to take longer to produce buffers for the current "
+          "position (in ns)", 0, G_MAXUINT64, DEFAULT_LATENCY,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 }
 
 static void
@@ -1090,6 +1600,14 @@ gst_aggregator_init (GstAggregator * self, GstAggregatorClass * klass)
 
   priv->padcount = -1;
   priv->tags_changed = FALSE;
+  priv->latency = DEFAULT_LATENCY;
+  priv->latency_live = FALSE;
+  priv->latency_min = 0;
+  priv->latency_max = GST_CLOCK_TIME_NONE;
+  priv->sub_latency_min = 0;
+  priv->sub_latency_max = 0;
+  priv->aggregate_id = NULL;
+  priv->timeout_running_time = GST_CLOCK_TIME_NONE;
   _reset_flow_values (self);
 
   priv->mcontext = g_main_context_new ();
@@ -1153,8 +1671,10 @@ _chain (GstPad * pad, GstObject * object, GstBuffer * buffer)
     goto eos;
 
   PAD_LOCK_EVENT (aggpad);
-  if (aggpad->buffer) {
-    GST_DEBUG_OBJECT (aggpad, "Waiting for buffer to be consumed");
+  while (_aggpad_queue_is_full (aggpad) &&
+      g_atomic_int_get (&aggpad->priv->flushing) == FALSE) {
+    GST_DEBUG_OBJECT (aggpad, "Queue full, waiting for a buffer to be "
+        "consumed");
     PAD_WAIT_EVENT (aggpad);
   }
   PAD_UNLOCK_EVENT (aggpad);
@@ -1168,9 +1688,22 @@ _chain (GstPad * pad, GstObject * object, GstBuffer * buffer)
   }
 
   PAD_LOCK_EVENT (aggpad);
-  if (aggpad->buffer)
-    gst_buffer_unref (aggpad->buffer);
-  aggpad->buffer = actual_buf;
+  if (g_atomic_int_get (&aggpad->priv->flushing) == TRUE) {
+    PAD_UNLOCK_EVENT (aggpad);
+    if (actual_buf)
+      gst_buffer_unref (actual_buf);
+    GST_DEBUG_OBJECT (aggpad, "Started flushing while clipping");
+    return GST_FLOW_FLUSHING;
+  }
+  if (actual_buf) {
+    if (_aggpad_queue_is_empty (aggpad)) {
+      aggpad->buffer = actual_buf;
+    } else {
+      g_queue_push_tail (&aggpad->priv->queue, actual_buf);
+      aggpad->priv->num_buffers++;
+    }
+    aggpad->priv->late = FALSE;
+  }
   PAD_UNLOCK_EVENT (aggpad);
 
   _add_aggregate_gsource (self);
@@ -1207,6 +1740,24 @@ static gboolean
 pad_event_func (GstPad * pad, GstObject * parent, GstEvent * event)
 {
   GstAggregatorClass *klass = GST_AGGREGATOR_GET_CLASS (parent);
+  GstAggregatorPad *aggpad = GST_AGGREGATOR_PAD (pad);
+
+  /* Serialized events only apply to the buffers after them, queue them
+   * behind the buffers that are already waiting. EOS is tracked with
+   * pending_eos instead */
+  if (GST_EVENT_IS_SERIALIZED (event) && GST_EVENT_TYPE (event) != GST_EVENT_EOS
+      && GST_EVENT_TYPE (event) != GST_EVENT_FLUSH_STOP) {
+    PAD_LOCK_EVENT (aggpad);
+    if (!_aggpad_queue_is_empty (aggpad)) {
+      GST_DEBUG_OBJECT (aggpad, "Queuing event %" GST_PTR_FORMAT, event);
+      g_queue_push_tail (&aggpad->priv->queue, event);
+      PAD_UNLOCK_EVENT (aggpad);
+
+      _add_aggregate_gsource (GST_AGGREGATOR (parent));
+      return TRUE;
+    }
+    PAD_UNLOCK_EVENT (aggpad);
+  }
 
   return klass->sink_event (GST_AGGREGATOR (parent),
       GST_AGGREGATOR_PAD (pad), event);
@@ -1221,7 +1772,7 @@ pad_activate_mode_func (GstPad * pad,
   if (active == FALSE) {
     PAD_LOCK_EVENT (aggpad);
     g_atomic_int_set (&aggpad->priv->flushing, TRUE);
-    gst_buffer_replace (&aggpad->buffer, NULL);
+    _aggpad_drop_buffers (aggpad, FALSE);
     PAD_BROADCAST_EVENT (aggpad);
     PAD_UNLOCK_EVENT (aggpad);
   } else {
@@ -1270,15 +1821,63 @@ static void
 gst_aggregator_pad_dispose (GObject * object)
 {
   GstAggregatorPad *pad = (GstAggregatorPad *) object;
-  GstBuffer *buf;
 
-  buf = gst_aggregator_pad_steal_buffer (pad);
-  if (buf)
-    gst_buffer_unref (buf);
+  PAD_LOCK_EVENT (pad);
+  _aggpad_drop_buffers (pad, TRUE);
+  PAD_UNLOCK_EVENT (pad);
 
   G_OBJECT_CLASS (aggregator_pad_parent_class)->dispose (object);
 }
 
+static void
+gst_aggregator_pad_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstAggregatorPad *pad = (GstAggregatorPad *) object;
+
+  switch (prop_id) {
+    case PAD_PROP_MAX_BUFFERS:
+      PAD_LOCK_EVENT (pad);
+      pad->priv->max_buffers = g_value_get_uint (value);
+      /* the queue might not be full anymore */
+      PAD_BROADCAST_EVENT (pad);
+      PAD_UNLOCK_EVENT (pad);
+      break;
+    case PAD_PROP_MAX_TIME:
+      PAD_LOCK_EVENT (pad);
+      pad->priv->max_time = g_value_get_uint64 (value);
+      PAD_BROADCAST_EVENT (pad);
+      PAD_UNLOCK_EVENT (pad);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_aggregator_pad_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GstAggregatorPad *pad = (GstAggregatorPad *) object;
+
+  switch (prop_id) {
+    case PAD_PROP_MAX_BUFFERS:
+      PAD_LOCK_EVENT (pad);
+      g_value_set_uint (value, pad->priv->max_buffers);
+      PAD_UNLOCK_EVENT (pad);
+      break;
+    case PAD_PROP_MAX_TIME:
+      PAD_LOCK_EVENT (pad);
+      g_value_set_uint64 (value, pad->priv->max_time);
+      PAD_UNLOCK_EVENT (pad);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
 static void
 gst_aggregator_pad_class_init (GstAggregatorPadClass * klass)
 {
@@ -1290,6 +1889,20 @@ gst_aggregator_pad_class_init (GstAggregatorPadClass * klass)
   gobject_class->constructed = GST_DEBUG_FUNCPTR (_pad_constructed);
   gobject_class->finalize = GST_DEBUG_FUNCPTR (gst_aggregator_pad_finalize);
   gobject_class->dispose = GST_DEBUG_FUNCPTR (gst_aggregator_pad_dispose);
+  gobject_class->set_property = gst_aggregator_pad_set_property;
+  gobject_class->get_property = gst_aggregator_pad_get_property;
+
+  g_object_class_install_property (gobject_class, PAD_PROP_MAX_BUFFERS,
+      g_param_spec_uint ("max-buffers", "Max buffers",
+          "Maximum number of buffers queued on the pad (0 = unlimited)",
+          0, G_MAXUINT, DEFAULT_PAD_MAX_BUFFERS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PAD_PROP_MAX_TIME,
+      g_param_spec_uint64 ("max-time", "Max time",
+          "Maximum amount of data (in ns) queued on the pad (0 = unlimited)",
+          0, G_MAXUINT64, DEFAULT_PAD_MAX_TIME,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 }
 
 static void
@@ -1300,6 +1913,9 @@ gst_aggregator_pad_init (GstAggregatorPad * pad)
       GstAggregatorPadPrivate);
 
   pad->buffer = NULL;
+  g_queue_init (&pad->priv->queue);
+  pad->priv->max_buffers = DEFAULT_PAD_MAX_BUFFERS;
+  pad->priv->max_time = DEFAULT_PAD_MAX_TIME;
   g_mutex_init (&pad->priv->event_lock);
   g_cond_init (&pad->priv->event_cond);
 
@@ -1309,7 +1925,8 @@ gst_aggregator_pad_init (GstAggregatorPad * pad)
  * gst_aggregator_pad_steal_buffer:
  * @pad: the pad to get buffer from
  *
- * Steal the ref to the buffer currently queued in @pad.
+ * Steal the ref to the buffer at the head of the queue of @pad. The next
+ * queued buffer, if any, becomes the head of the queue.
  *
  * Returns: (transfer full): The buffer in @pad or NULL if no buffer was
  *   queued. You should unref the buffer after usage.
@@ -1322,13 +1939,7 @@ gst_aggregator_pad_steal_buffer (GstAggregatorPad * pad)
   PAD_LOCK_EVENT (pad);
   if (pad->buffer) {
     GST_TRACE_OBJECT (pad, "Consuming buffer");
-    buffer = pad->buffer;
-    pad->buffer = NULL;
-    if (pad->priv->pending_eos) {
-      pad->priv->pending_eos = FALSE;
-      pad->eos = TRUE;
-    }
-    PAD_BROADCAST_EVENT (pad);
+    buffer = _aggpad_pop_buffer (pad);
     GST_DEBUG_OBJECT (pad, "Consummed: %" GST_PTR_FORMAT, buffer);
   }
   PAD_UNLOCK_EVENT (pad);
@@ -1336,13 +1947,35 @@ gst_aggregator_pad_steal_buffer (GstAggregatorPad * pad)
   return buffer;
 }
 
+/**
+ * gst_aggregator_pad_is_late:
+ * @pad: the pad to check
+ *
+ * In live mode, check whether @pad had no data when the deadline of the
+ * buffer currently being aggregated was reached. The flag is cleared once
+ * a new buffer is queued on @pad.
+ *
+ * Returns: %TRUE if @pad missed the last deadline
+ */
+gboolean
+gst_aggregator_pad_is_late (GstAggregatorPad * pad)
+{
+  gboolean late;
+
+  PAD_LOCK_EVENT (pad);
+  late = pad->priv->late;
+  PAD_UNLOCK_EVENT (pad);
+
+  return late;
+}
+
 /**
  * gst_aggregator_pad_get_buffer:
  * @pad: the pad to get buffer from
  *
- * Returns: (transfer full): A reference to the buffer in @pad or
- * NULL if no buffer was queued. You should unref the buffer after
- * usage.
+ * Returns: (transfer full): A reference to the buffer at the head of the
+ * queue of @pad or NULL if no buffer was queued. You should unref the buffer
+ * after usage.
  */
 GstBuffer *
 gst_aggregator_pad_get_buffer (GstAggregatorPad * pad)
@@ -1357,6 +1990,41 @@ gst_aggregator_pad_get_buffer (GstAggregatorPad * pad)
   return buffer;
 }
 
+/**
+ * gst_aggregator_set_latency:
+ * @self: a #GstAggregator
+ * @min_latency: minimum latency
+ * @max_latency: maximum latency
+ *
+ * Lets #GstAggregator sub-classes tell the baseclass what their internal
+ * latency is, for example the duration of the output buffers they have to
+ * wait for before producing them. It is added to the upstream latency when
+ * answering latency queries and when computing the live deadline of the
+ * output buffers. Will also post a LATENCY message on the bus so the pipeline
+ * can reconfigure its global latency.
+ */
+void
+gst_aggregator_set_latency (GstAggregator * self,
+    GstClockTime min_latency, GstClockTime max_latency)
+{
+  gboolean changed;
+
+  g_return_if_fail (GST_IS_AGGREGATOR (self));
+  g_return_if_fail (GST_CLOCK_TIME_IS_VALID (min_latency));
+  g_return_if_fail (max_latency >= min_latency);
+
+  GST_OBJECT_LOCK (self);
+  changed = self->priv->sub_latency_min != min_latency ||
+      self->priv->sub_latency_max != max_latency;
+  self->priv->sub_latency_min = min_latency;
+  self->priv->sub_latency_max = max_latency;
+  GST_OBJECT_UNLOCK (self);
+
+  if (changed)
+    gst_element_post_message (GST_ELEMENT_CAST (self),
+        gst_message_new_latency (GST_OBJECT_CAST (self)));
+}
+
 /**
  * gst_aggregator_merge_tags:
  * @self: a #GstAggregator
@@ -61,7 +61,7 @@ typedef struct _GstAggregatorPadPrivate GstAggregatorPadPrivate;
 
 /**
  * GstAggregatorPad:
- * @buffer: currently queued buffer.
+ * @buffer: buffer at the head of the queue of the pad.
  * @segment: last segment received.
  *
  * The implementation the GstPad to use with #GstAggregator
@@ -106,6 +106,7 @@ GType gst_aggregator_pad_get_type           (void);
 
 GstBuffer * gst_aggregator_pad_steal_buffer (GstAggregatorPad *  pad);
 GstBuffer * gst_aggregator_pad_get_buffer   (GstAggregatorPad *  pad);
+gboolean    gst_aggregator_pad_is_late      (GstAggregatorPad *  pad);
 
 /*********************
  * GstAggregator API *
@@ -169,12 +170,14 @@ struct _GstAggregator
  *                  Called when the src pad is activated, it will start/stop its
  *                  pad task right after that call.
  * @aggregate:      Mandatory.
- *                  Called when buffers are queued on all sinkpads. Classes
- *                  should iterate the GstElement->sinkpads and peek or steal
- *                  buffers from the #GstAggregatorPads. If the subclass returns
- *                  GST_FLOW_EOS, sending of the eos event will be taken care
- *                  of. Once / if a buffer has been constructed from the
- *                  aggregated buffers, the subclass should call _finish_buffer.
+ *                  Called when buffers are queued on all sinkpads, or in live
+ *                  mode once the deadline of the next output buffer is
+ *                  reached. Classes should iterate the GstElement->sinkpads
+ *                  and peek or steal buffers from the #GstAggregatorPads. If
+ *                  the subclass returns GST_FLOW_EOS, sending of the eos event
+ *                  will be taken care of. Once / if a buffer has been
+ *                  constructed from the aggregated buffers, the subclass
+ *                  should call _finish_buffer.
  * @stop:           Optional.
  *                  Should be linked up first. Called when the
  *                  element goes from PAUSED to READY. The subclass should free
@@ -244,6 +247,9 @@ GstFlowReturn  gst_aggregator_finish_buffer         (GstAggregator
                                                      GstBuffer                    *  buffer);
 void           gst_aggregator_set_src_caps          (GstAggregator                *  agg,
                                                      GstCaps                      *  caps);
+void           gst_aggregator_set_latency           (GstAggregator                *  self,
+                                                     GstClockTime                    min_latency,
+                                                     GstClockTime                    max_latency);
 
 GType gst_aggregator_get_type(void);
 
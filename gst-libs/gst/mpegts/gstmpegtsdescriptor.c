@@ -702,13 +702,36 @@ _new_descriptor_with_extension (guint8 tag, guint8 tag_extension, guint8 length)
   return descriptor;
 }
 
+/* Descriptors coming from parsed sections are allocated in one go with
+ * their data (right after the structure), which halves the number of
+ * allocations for tables with many descriptors (like EIT schedules). Such
+ * descriptors point to themselves in the first reserved field */
+#define DESCRIPTOR_HAS_INLINE_DATA(desc) \
+    ((desc)->_gst_reserved[0] == (gpointer) (desc))
+
+static GstMpegtsDescriptor *
+_new_descriptor_from_data (const guint8 * data, gsize size)
+{
+  GstMpegtsDescriptor *desc;
+
+  desc = g_malloc (sizeof (GstMpegtsDescriptor) + size);
+  memset (desc, 0, sizeof (GstMpegtsDescriptor));
+  desc->_gst_reserved[0] = desc;
+  desc->data = (guint8 *) (desc + 1);
+  memcpy (desc->data, data, size);
+
+  return desc;
+}
+
 static GstMpegtsDescriptor *
 _copy_descriptor (GstMpegtsDescriptor * desc)
 {
   GstMpegtsDescriptor *copy;
 
-  copy = g_slice_dup (GstMpegtsDescriptor, desc);
-  copy->data = g_memdup (desc->data, desc->length + 2);
+  copy = _new_descriptor_from_data (desc->data, desc->length + 2);
+  copy->tag = desc->tag;
+  copy->tag_extension = desc->tag_extension;
+  copy->length = desc->length;
 
   return copy;
 }
@@ -722,6 +745,11 @@ _copy_descriptor (GstMpegtsDescriptor * desc)
 void
 gst_mpegts_descriptor_free (GstMpegtsDescriptor * desc)
 {
+  if (DESCRIPTOR_HAS_INLINE_DATA (desc)) {
+    g_free (desc);
+    return;
+  }
+
   g_free ((gpointer) desc->data);
   g_slice_free (GstMpegtsDescriptor, desc);
 }
@@ -790,13 +818,11 @@ gst_mpegts_parse_descriptors (guint8 * buffer, gsize buf_len)
   data = buffer;
 
   for (i = 0; i < nb_desc; i++) {
-    GstMpegtsDescriptor *desc = g_slice_new0 (GstMpegtsDescriptor);
+    GstMpegtsDescriptor *desc;
 
-    desc->data = data;
+    desc = _new_descriptor_from_data (data, data[1] + 2);
     desc->tag = *data++;
     desc->length = *data++;
-    /* Copy the data now that we known the size */
-    desc->data = g_memdup (desc->data, desc->length + 2);
     GST_LOG ("descriptor 0x%02x length:%d", desc->tag, desc->length);
     GST_MEMDUMP ("descriptor", desc->data + 2, desc->length);
     /* extended descriptors */
@@ -29,12 +29,22 @@
  * Boston, MA 02110-1301, USA.
  */
 
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
 #include <string.h>
 #include <stdlib.h>
 
 #include "mpegts.h"
 #include "gstmpegts-private.h"
 
+#if defined (HAVE_CPU_X86_64) && defined (__GNUC__)
+#define HAVE_CRC32_CLMUL 1
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
 /**
  * SECTION:gstmpegts
  * @title: Mpeg-ts helper library
@@ -127,19 +137,162 @@ static const guint32 crc_tab[256] = {
   0xbcb4666d, 0xb8757bda, 0xb5365d03, 0xb1f740b4
 };
 
-/* _calc_crc32 relicenced to LGPL from fluendo ts demuxer */
-guint32
-_calc_crc32 (const guint8 * data, guint datalen)
+/* Slicing-by-8 tables: crc_tab_s8[n][i] is the CRC of byte i followed by
+ * n zero bytes, crc_tab_s8[0] being crc_tab */
+static guint32 crc_tab_s8[8][256];
+
+typedef guint32 (*CalcCrc32Func) (guint32 crc, const guint8 * data,
+    gsize len);
+
+/* _calc_crc32_bytewise relicenced to LGPL from fluendo ts demuxer */
+static guint32
+_calc_crc32_bytewise (guint32 crc, const guint8 * data, gsize len)
 {
-  gint i;
-  guint32 crc = 0xffffffff;
+  gsize i;
 
-  for (i = 0; i < datalen; i++) {
+  for (i = 0; i < len; i++)
     crc = (crc << 8) ^ crc_tab[((crc >> 24) ^ *data++) & 0xff];
-  }
+
   return crc;
 }
 
+static guint32
+_calc_crc32_slice8 (guint32 crc, const guint8 * data, gsize len)
+{
+  while (len >= 8) {
+    crc ^= GST_READ_UINT32_BE (data);
+    crc = crc_tab_s8[7][crc >> 24] ^ crc_tab_s8[6][(crc >> 16) & 0xff] ^
+        crc_tab_s8[5][(crc >> 8) & 0xff] ^ crc_tab_s8[4][crc & 0xff] ^
+        crc_tab_s8[3][data[4]] ^ crc_tab_s8[2][data[5]] ^
+        crc_tab_s8[1][data[6]] ^ crc_tab_s8[0][data[7]];
+    data += 8;
+    len -= 8;
+  }
+
+  return _calc_crc32_bytewise (crc, data, len);
+}
+
+#ifdef HAVE_CRC32_CLMUL
+/* Below this size, setting up the folding is not worth it */
+#define CRC32_CLMUL_MIN_SIZE 64
+
+#define CRC32_LOAD(p) \
+    _mm_shuffle_epi8 (_mm_loadu_si128 ((const __m128i *) (p)), bswap)
+/* x * x^n + b, with the x^(n+64) and x^n mod P constants in k */
+#define CRC32_FOLD(x, k, b) \
+    _mm_xor_si128 (_mm_xor_si128 (_mm_clmulepi64_si128 (x, k, 0x11), \
+            _mm_clmulepi64_si128 (x, k, 0x00)), b)
+
+/* Folds the data 128 bits at a time with carry-less multiplications until
+ * only 128 bits (congruent to the data modulo the CRC polynomial) remain,
+ * which then go through the tables */
+__attribute__ ((target ("pclmul,ssse3")))
+static guint32
+_calc_crc32_clmul (guint32 crc, const guint8 * data, gsize len)
+{
+  const __m128i bswap = _mm_set_epi8 (0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11,
+      12, 13, 14, 15);
+  /* x^576 and x^512 mod P, to fold 4 blocks in parallel */
+  const __m128i k4 = _mm_set_epi64x (0x8833794c, 0xe6228b11);
+  /* x^192 and x^128 mod P, to fold one block into the next one */
+  const __m128i k1 = _mm_set_epi64x (0xc5b9cd4c, 0xe8a45605);
+  __m128i x0, x1, x2, x3;
+  guint8 tmp[16];
+
+  if (len < CRC32_CLMUL_MIN_SIZE)
+    return _calc_crc32_slice8 (crc, data, len);
+
+  /* The initial CRC value is equivalent to xoring the first 32 bits */
+  x0 = _mm_xor_si128 (CRC32_LOAD (data), _mm_set_epi32 (crc, 0, 0, 0));
+  x1 = CRC32_LOAD (data + 16);
+  x2 = CRC32_LOAD (data + 32);
+  x3 = CRC32_LOAD (data + 48);
+  data += 64;
+  len -= 64;
+
+  while (len >= 64) {
+    x0 = CRC32_FOLD (x0, k4, CRC32_LOAD (data));
+    x1 = CRC32_FOLD (x1, k4, CRC32_LOAD (data + 16));
+    x2 = CRC32_FOLD (x2, k4, CRC32_LOAD (data + 32));
+    x3 = CRC32_FOLD (x3, k4, CRC32_LOAD (data + 48));
+    data += 64;
+    len -= 64;
+  }
+
+  x0 = CRC32_FOLD (x0, k1, x1);
+  x0 = CRC32_FOLD (x0, k1, x2);
+  x0 = CRC32_FOLD (x0, k1, x3);
+  while (len >= 16) {
+    x0 = CRC32_FOLD (x0, k1, CRC32_LOAD (data));
+    data += 16;
+    len -= 16;
+  }
+
+  _mm_storeu_si128 ((__m128i *) tmp, _mm_shuffle_epi8 (x0, bswap));
+  crc = _calc_crc32_slice8 (0, tmp, 16);
+
+  return _calc_crc32_slice8 (crc, data, len);
+}
+
+#undef CRC32_LOAD
+#undef CRC32_FOLD
+
+static gboolean
+_crc32_have_clmul (void)
+{
+  guint eax, ebx, ecx, edx;
+
+  if (!__get_cpuid (1, &eax, &ebx, &ecx, &edx))
+    return FALSE;
+
+  return (ecx & bit_PCLMUL) && (ecx & bit_SSSE3);
+}
+#endif
+
+/* Used until gst_mpegts_initialize() picked the fastest implementation */
+static CalcCrc32Func calc_crc32_func = _calc_crc32_bytewise;
+
+/* Picks the CRC implementation at runtime. GST_MPEGTS_CRC32 can be set to
+ * "bytewise", "slice8" or "clmul" to force one (for comparing them) */
+static void
+_initialize_crc32 (void)
+{
+  const gchar *impl = g_getenv ("GST_MPEGTS_CRC32");
+  guint i, n;
+
+  for (i = 0; i < 256; i++)
+    crc_tab_s8[0][i] = crc_tab[i];
+  for (n = 1; n < 8; n++) {
+    for (i = 0; i < 256; i++) {
+      guint32 crc = crc_tab_s8[n - 1][i];
+      crc_tab_s8[n][i] = (crc << 8) ^ crc_tab[crc >> 24];
+    }
+  }
+
+  if (!g_strcmp0 (impl, "bytewise")) {
+    calc_crc32_func = _calc_crc32_bytewise;
+    impl = "bytewise";
+  } else {
+    calc_crc32_func = _calc_crc32_slice8;
+    impl = "slice8";
+#ifdef HAVE_CRC32_CLMUL
+    if (g_strcmp0 (g_getenv ("GST_MPEGTS_CRC32"), "slice8")
+        && _crc32_have_clmul ()) {
+      calc_crc32_func = _calc_crc32_clmul;
+      impl = "clmul";
+    }
+#endif
+  }
+
+  GST_DEBUG ("Using %s CRC32 implementation", impl);
+}
+
+guint32
+_calc_crc32 (const guint8 * data, guint datalen)
+{
+  return calc_crc32_func (0xffffffff, data, datalen);
+}
+
 gpointer
 __common_section_checks (GstMpegtsSection * section, guint min_size,
     GstMpegtsParseFunc parsefunc, GDestroyNotify destroynotify)
@@ -1006,6 +1159,7 @@ gst_mpegts_initialize (void)
   QUARK_TOT = g_quark_from_string ("tot");
   QUARK_SECTION = g_quark_from_string ("section");
 
+  _initialize_crc32 ();
   __initialize_descriptors ();
 }
 
@@ -0,0 +1,235 @@
+/* GStreamer
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* A fixed set of worker threads running batches of independent tasks, for
+ * splitting the processing of a frame over several cores. The thread calling
+ * gst_parallelized_task_runner_run() takes part in the processing and only
+ * returns once all tasks of the batch are done. */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "gstparallelizedtaskrunner.h"
+
+struct _GstParallelizedTaskRunner
+{
+  /* number of threads asked for, n_threads is lower if some of them could
+   * not be created */
+  guint n_wanted;
+  guint n_threads;
+  GThread **threads;
+
+  GMutex lock;
+  GCond cond_todo;
+  GCond cond_done;
+
+  /* current batch, protected by lock */
+  GstParallelizedTaskFunc func;
+  gpointer *task_data;
+  guint n_tasks;
+  guint next_task;
+  guint n_done;
+
+  gboolean quit;
+};
+
+/* Must be called with the lock, which is released while the task runs */
+static void
+gst_parallelized_task_runner_run_next (GstParallelizedTaskRunner * self)
+{
+  guint idx = self->next_task++;
+
+  g_mutex_unlock (&self->lock);
+  self->func (self->task_data[idx]);
+  g_mutex_lock (&self->lock);
+
+  if (++self->n_done == self->n_tasks)
+    g_cond_signal (&self->cond_done);
+}
+
+static gpointer
+gst_parallelized_task_runner_thread_func (GstParallelizedTaskRunner * self)
+{
+  g_mutex_lock (&self->lock);
+  while (TRUE) {
+    while (!self->quit && self->next_task >= self->n_tasks)
+      g_cond_wait (&self->cond_todo, &self->lock);
+
+    if (self->quit)
+      break;
+
+    gst_parallelized_task_runner_run_next (self);
+  }
+  g_mutex_unlock (&self->lock);
+
+  return NULL;
+}
+
+/**
+ * gst_parallelized_task_runner_new:
+ * @n_threads: number of threads processing tasks, including the calling
+ *   one, or 0 for the number of processors
+ *
+ * Returns: a new #GstParallelizedTaskRunner, free with
+ *   gst_parallelized_task_runner_free()
+ */
+GstParallelizedTaskRunner *
+gst_parallelized_task_runner_new (guint n_threads)
+{
+  GstParallelizedTaskRunner *self;
+  guint i;
+
+  if (n_threads == 0)
+    n_threads = g_get_num_processors ();
+
+  self = g_slice_new0 (GstParallelizedTaskRunner);
+  self->n_wanted = n_threads;
+  self->n_threads = n_threads;
+  g_mutex_init (&self->lock);
+  g_cond_init (&self->cond_todo);
+  g_cond_init (&self->cond_done);
+
+  /* the calling thread is one of the workers */
+  self->threads = g_new0 (GThread *, n_threads);
+  for (i = 1; i < n_threads; i++) {
+    GError *err = NULL;
+
+    self->threads[i] = g_thread_try_new ("parallelized-task-runner",
+        (GThreadFunc) gst_parallelized_task_runner_thread_func, self, &err);
+    if (self->threads[i] == NULL) {
+      GST_WARNING ("Failed to create worker thread: %s", err->message);
+      g_clear_error (&err);
+      break;
+    }
+  }
+  self->n_threads = i;
+
+  return self;
+}
+
+/**
+ * gst_parallelized_task_runner_free:
+ * @self: a #GstParallelizedTaskRunner
+ *
+ * Stops the worker threads and frees @self.
+ */
+void
+gst_parallelized_task_runner_free (GstParallelizedTaskRunner * self)
+{
+  guint i;
+
+  g_mutex_lock (&self->lock);
+  self->quit = TRUE;
+  g_cond_broadcast (&self->cond_todo);
+  g_mutex_unlock (&self->lock);
+
+  for (i = 1; i < self->n_threads; i++)
+    g_thread_join (self->threads[i]);
+
+  g_free (self->threads);
+  g_mutex_clear (&self->lock);
+  g_cond_clear (&self->cond_todo);
+  g_cond_clear (&self->cond_done);
+  g_slice_free (GstParallelizedTaskRunner, self);
+}
+
+/**
+ * gst_parallelized_task_runner_update:
+ * @runner: (inout): location of a #GstParallelizedTaskRunner, may point to
+ *   %NULL
+ * @n_threads: number of threads processing tasks, or 0 for the number of
+ *   processors
+ *
+ * Replaces the runner at @runner by a new one if there is none yet or if it
+ * was created for another number of threads.
+ *
+ * Returns: %TRUE if a new runner was created
+ */
+gboolean
+gst_parallelized_task_runner_update (GstParallelizedTaskRunner ** runner,
+    guint n_threads)
+{
+  if (n_threads == 0)
+    n_threads = g_get_num_processors ();
+
+  if (*runner && (*runner)->n_wanted == n_threads)
+    return FALSE;
+
+  if (*runner)
+    gst_parallelized_task_runner_free (*runner);
+  *runner = gst_parallelized_task_runner_new (n_threads);
+
+  return TRUE;
+}
+
+/**
+ * gst_parallelized_task_runner_get_n_threads:
+ * @self: a #GstParallelizedTaskRunner
+ *
+ * Returns: the number of threads processing tasks, including the one
+ *   calling gst_parallelized_task_runner_run()
+ */
+guint
+gst_parallelized_task_runner_get_n_threads (GstParallelizedTaskRunner * self)
+{
+  return self->n_threads;
+}
+
+/**
+ * gst_parallelized_task_runner_run:
+ * @self: a #GstParallelizedTaskRunner
+ * @func: the function to call for each task
+ * @task_data: (array length=n_tasks): the data of each task
+ * @n_tasks: number of tasks
+ *
+ * Calls @func on each element of @task_data, spread over the threads of
+ * @self, and waits for all of them to be done. Not reentrant, a runner can
+ * only run one batch of tasks at a time.
+ */
+void
+gst_parallelized_task_runner_run (GstParallelizedTaskRunner * self,
+    GstParallelizedTaskFunc func, gpointer * task_data, guint n_tasks)
+{
+  guint i;
+
+  if (n_tasks == 0)
+    return;
+
+  if (self->n_threads == 1 || n_tasks == 1) {
+    for (i = 0; i < n_tasks; i++)
+      func (task_data[i]);
+    return;
+  }
+
+  g_mutex_lock (&self->lock);
+  self->func = func;
+  self->task_data = task_data;
+  self->n_tasks = n_tasks;
+  self->next_task = 0;
+  self->n_done = 0;
+  g_cond_broadcast (&self->cond_todo);
+
+  /* help out, then wait for the tasks still running elsewhere */
+  while (self->next_task < self->n_tasks)
+    gst_parallelized_task_runner_run_next (self);
+
+  while (self->n_done < self->n_tasks)
+    g_cond_wait (&self->cond_done, &self->lock);
+  g_mutex_unlock (&self->lock);
+}
@@ -0,0 +1,50 @@
+/* GStreamer
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __GST_PARALLELIZED_TASK_RUNNER_H__
+#define __GST_PARALLELIZED_TASK_RUNNER_H__
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+typedef struct _GstParallelizedTaskRunner GstParallelizedTaskRunner;
+
+/**
+ * GstParallelizedTaskFunc:
+ * @task_data: the data of one of the tasks given to
+ *   gst_parallelized_task_runner_run()
+ */
+typedef void (*GstParallelizedTaskFunc) (gpointer task_data);
+
+GstParallelizedTaskRunner * gst_parallelized_task_runner_new         (guint n_threads);
+void                        gst_parallelized_task_runner_free        (GstParallelizedTaskRunner * self);
+
+gboolean                    gst_parallelized_task_runner_update      (GstParallelizedTaskRunner ** runner,
+                                                                      guint n_threads);
+
+guint                       gst_parallelized_task_runner_get_n_threads (GstParallelizedTaskRunner * self);
+
+void                        gst_parallelized_task_runner_run         (GstParallelizedTaskRunner * self,
+                                                                      GstParallelizedTaskFunc func,
+                                                                      gpointer * task_data,
+                                                                      guint n_tasks);
+
+G_END_DECLS
+
+#endif /* __GST_PARALLELIZED_TASK_RUNNER_H__ */
@@ -41,6 +41,7 @@
 #include <string.h>
 
 #include "videoconvert.h"
+#include "gstparallelizedtaskrunner.h"
 
 #include "gstvideoaggregator.h"
 #include "gstvideoaggregatorpad.h"
@@ -50,6 +51,9 @@ GST_DEBUG_CATEGORY_STATIC (gst_videoaggregator_debug);
 
 /* Needed prototypes */
 static void gst_videoaggregator_reset_qos (GstVideoAggregator * vagg);
+static gboolean gst_videoaggregator_pad_prepare_frame (GstVideoAggregatorPad *
+    pad, GstVideoAggregator * vagg);
+static guint gst_videoaggregator_get_slice_threads (GstVideoAggregator * vagg);
 
 /****************************************
  * GstVideoAggregatorPad implementation *
@@ -60,15 +64,38 @@ enum
 {
   PROP_PAD_0,
   PROP_PAD_ZORDER,
+  PROP_PAD_POOL_ALLOCATIONS,
+  PROP_PAD_BUFFER_ALLOCATIONS,
 };
 
 
 struct _GstVideoAggregatorPadPrivate
 {
-  /* Converter, if NULL no conversion is done */
+  /* Converter, if NULL no conversion is done, split over slice_threads */
   VideoConvert *convert;
+  guint slice_threads;
+
+  /* The frames of the current buffer, aggregated_frame points to one of
+   * them */
+  GstVideoFrame frame;
+  GstVideoFrame converted_frame;
+
+  /* Pool of the converted buffers, for pool_info */
+  GstBufferPool *pool;
+  GstVideoInfo pool_info;
+
+  /* protected by the OBJECT_LOCK */
+  guint64 pool_allocations;
+  guint64 buffer_allocations;
+
+  /* Time spent preparing the frames, for the debug logs */
+  GstClockTime prepare_time;
+  guint64 prepared_frames;
 };
 
+/* Set on the buffers of the pools once they have been counted */
+static GQuark counted_quark;
+
 G_DEFINE_TYPE (GstVideoAggregatorPad, gst_videoaggregator_pad,
     GST_TYPE_AGGREGATOR_PAD);
 
@@ -82,6 +109,16 @@ gst_videoaggregator_pad_get_property (GObject * object, guint prop_id,
     case PROP_PAD_ZORDER:
       g_value_set_uint (value, pad->zorder);
       break;
+    case PROP_PAD_POOL_ALLOCATIONS:
+      GST_OBJECT_LOCK (pad);
+      g_value_set_uint64 (value, pad->priv->pool_allocations);
+      GST_OBJECT_UNLOCK (pad);
+      break;
+    case PROP_PAD_BUFFER_ALLOCATIONS:
+      GST_OBJECT_LOCK (pad);
+      g_value_set_uint64 (value, pad->priv->buffer_allocations);
+      GST_OBJECT_UNLOCK (pad);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -133,6 +170,60 @@ _flush_pad (GstAggregatorPad * aggpad, GstAggregator * aggregator)
   return TRUE;
 }
 
+static gboolean
+gst_videoaggregator_pad_set_info (GstVideoAggregatorPad * pad,
+    GstVideoAggregator * vagg, GstVideoInfo * current_info,
+    GstVideoInfo * wanted_info)
+{
+  gchar *colorimetry, *best_colorimetry;
+  const gchar *chroma, *best_chroma;
+
+  if (pad->priv->convert)
+    badvideoconvert_convert_free (pad->priv->convert);
+  pad->priv->convert = NULL;
+
+  colorimetry = gst_video_colorimetry_to_string (&current_info->colorimetry);
+  chroma = gst_video_chroma_to_string (current_info->chroma_site);
+  best_colorimetry =
+      gst_video_colorimetry_to_string (&wanted_info->colorimetry);
+  best_chroma = gst_video_chroma_to_string (wanted_info->chroma_site);
+
+  if (GST_VIDEO_INFO_FORMAT (wanted_info) !=
+      GST_VIDEO_INFO_FORMAT (current_info) ||
+      GST_VIDEO_INFO_WIDTH (wanted_info) != GST_VIDEO_INFO_WIDTH (current_info)
+      || GST_VIDEO_INFO_HEIGHT (wanted_info) !=
+      GST_VIDEO_INFO_HEIGHT (current_info) ||
+      g_strcmp0 (colorimetry, best_colorimetry) ||
+      g_strcmp0 (chroma, best_chroma)) {
+    GST_DEBUG_OBJECT (pad, "This pad will be converted from %d %dx%d to "
+        "%d %dx%d", GST_VIDEO_INFO_FORMAT (current_info),
+        GST_VIDEO_INFO_WIDTH (current_info),
+        GST_VIDEO_INFO_HEIGHT (current_info),
+        GST_VIDEO_INFO_FORMAT (wanted_info),
+        GST_VIDEO_INFO_WIDTH (wanted_info),
+        GST_VIDEO_INFO_HEIGHT (wanted_info));
+    pad->priv->convert = badvideoconvert_convert_new (current_info,
+        wanted_info);
+    pad->conversion_info = *wanted_info;
+    if (!pad->priv->convert) {
+      g_free (colorimetry);
+      g_free (best_colorimetry);
+      GST_WARNING_OBJECT (pad, "No path found for conversion");
+      return FALSE;
+    }
+    pad->priv->slice_threads = gst_videoaggregator_get_slice_threads (vagg);
+    badvideoconvert_convert_set_n_threads (pad->priv->convert,
+        pad->priv->slice_threads);
+  } else {
+    GST_DEBUG_OBJECT (pad, "This pad will not need conversion");
+  }
+
+  g_free (colorimetry);
+  g_free (best_colorimetry);
+
+  return TRUE;
+}
+
 static void
 gst_videoaggregator_pad_finalize (GObject * o)
 {
@@ -142,6 +233,12 @@ gst_videoaggregator_pad_finalize (GObject * o)
     badvideoconvert_convert_free (vaggpad->priv->convert);
   vaggpad->priv->convert = NULL;
 
+  if (vaggpad->priv->pool) {
+    gst_buffer_pool_set_active (vaggpad->priv->pool, FALSE);
+    gst_object_unref (vaggpad->priv->pool);
+  }
+  vaggpad->priv->pool = NULL;
+
   G_OBJECT_CLASS (gst_videoaggregator_pad_parent_class)->finalize (o);
 }
 
@@ -159,10 +256,24 @@ gst_videoaggregator_pad_class_init (GstVideoAggregatorPadClass * klass)
       g_param_spec_uint ("zorder", "Z-Order", "Z Order of the picture",
           0, 10000, DEFAULT_PAD_ZORDER,
           G_PARAM_READWRITE | GST_PARAM_CONTROLLABLE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (gobject_class, PROP_PAD_POOL_ALLOCATIONS,
+      g_param_spec_uint64 ("pool-allocations", "Pool allocations",
+          "Number of buffer pools created for the converted frames", 0,
+          G_MAXUINT64, 0, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (gobject_class, PROP_PAD_BUFFER_ALLOCATIONS,
+      g_param_spec_uint64 ("buffer-allocations", "Buffer allocations",
+          "Number of buffers allocated for the converted frames", 0,
+          G_MAXUINT64, 0, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
 
   g_type_class_add_private (klass, sizeof (GstVideoAggregatorPadPrivate));
 
+  counted_quark =
+      g_quark_from_static_string ("GstVideoAggregatorPadCountedBuffer");
+
   aggpadclass->flush = GST_DEBUG_FUNCPTR (_flush_pad);
+  klass->set_info = GST_DEBUG_FUNCPTR (gst_videoaggregator_pad_set_info);
+  klass->prepare_frame =
+      GST_DEBUG_FUNCPTR (gst_videoaggregator_pad_prepare_frame);
 }
 
 static void
@@ -178,6 +289,7 @@ gst_videoaggregator_pad_init (GstVideoAggregatorPad * vaggpad)
   vaggpad->converted_buffer = NULL;
 
   vaggpad->priv->convert = NULL;
+  vaggpad->priv->pool = NULL;
 }
 
 /*********************************
@@ -264,6 +376,13 @@ gst_videoaggregator_child_proxy_init (gpointer g_iface, gpointer iface_data)
         g_thread_self());                                           \
   } G_STMT_END
 
+#define DEFAULT_CONVERSION_THREADS 0
+enum
+{
+  PROP_0,
+  PROP_CONVERSION_THREADS
+};
+
 struct _GstVideoAggregatorPrivate
 {
   /* Lock to prevent the state to change while aggregating */
@@ -284,12 +403,44 @@ struct _GstVideoAggregatorPrivate
   /* current caps */
   GstCaps *current_caps;
   gboolean send_caps;
+
+  /* Prepares the frames of the pads in parallel, conversion_threads is
+   * protected by the OBJECT_LOCK */
+  guint conversion_threads;
+  GstParallelizedTaskRunner *task_runner;
 };
 
 G_DEFINE_ABSTRACT_TYPE_WITH_CODE (GstVideoAggregator, gst_videoaggregator,
     GST_TYPE_AGGREGATOR, G_IMPLEMENT_INTERFACE (GST_TYPE_CHILD_PROXY,
         gst_videoaggregator_child_proxy_init));
 
+/* The frames of the pads get prepared in parallel on at most one thread per
+ * pad, and the conversion of each of them is only split over the conversion
+ * threads left to each pad, so that the converters of all the pads together
+ * do not use more than conversion_threads.
+ * Must be called with the OBJECT_LOCK. */
+static guint
+gst_videoaggregator_get_prepare_threads (GstVideoAggregator * vagg)
+{
+  guint n_threads = vagg->priv->conversion_threads;
+
+  if (n_threads == 0)
+    n_threads = g_get_num_processors ();
+
+  return CLAMP (GST_ELEMENT (vagg)->numsinkpads, 1, n_threads);
+}
+
+static guint
+gst_videoaggregator_get_slice_threads (GstVideoAggregator * vagg)
+{
+  guint n_threads = vagg->priv->conversion_threads;
+
+  if (n_threads == 0)
+    n_threads = g_get_num_processors ();
+
+  return MAX (n_threads / MAX (GST_ELEMENT (vagg)->numsinkpads, 1), 1);
+}
+
 static void
 _find_best_video_format (GstVideoAggregator * vagg, GstCaps * downstream_caps,
     GstVideoInfo * best_info, GstVideoFormat * best_format,
@@ -363,6 +514,91 @@ _find_best_video_format (GstVideoAggregator * vagg, GstCaps * downstream_caps,
   g_hash_table_unref (formats_table);
 }
 
+/* (Re)creates the pool of the converted buffers of @pad when the conversion
+ * changed, so that the buffers are reused from one frame to the next */
+static gboolean
+gst_videoaggregator_pad_update_pool (GstVideoAggregatorPad * pad)
+{
+  static GstAllocationParams params = { 0, 15, 0, 0, };
+  GstVideoAggregatorPadPrivate *priv = pad->priv;
+  GstStructure *config;
+  GstCaps *caps;
+
+  if (priv->pool && (priv->convert == NULL ||
+          GST_VIDEO_INFO_FORMAT (&priv->pool_info) !=
+          GST_VIDEO_INFO_FORMAT (&pad->conversion_info) ||
+          GST_VIDEO_INFO_WIDTH (&priv->pool_info) !=
+          GST_VIDEO_INFO_WIDTH (&pad->conversion_info) ||
+          GST_VIDEO_INFO_HEIGHT (&priv->pool_info) !=
+          GST_VIDEO_INFO_HEIGHT (&pad->conversion_info))) {
+    gst_buffer_pool_set_active (priv->pool, FALSE);
+    gst_object_unref (priv->pool);
+    priv->pool = NULL;
+  }
+
+  if (priv->pool || priv->convert == NULL)
+    return TRUE;
+
+  priv->pool = gst_video_buffer_pool_new ();
+  caps = gst_video_info_to_caps (&pad->conversion_info);
+  config = gst_buffer_pool_get_config (priv->pool);
+  gst_buffer_pool_config_set_params (config, caps,
+      GST_VIDEO_INFO_SIZE (&pad->conversion_info), 1, 0);
+  gst_buffer_pool_config_set_allocator (config, NULL, &params);
+  gst_caps_unref (caps);
+
+  if (!gst_buffer_pool_set_config (priv->pool, config) ||
+      !gst_buffer_pool_set_active (priv->pool, TRUE)) {
+    GST_WARNING_OBJECT (pad, "Could not set up the pool of converted buffers");
+    gst_object_unref (priv->pool);
+    priv->pool = NULL;
+    return FALSE;
+  }
+  priv->pool_info = pad->conversion_info;
+
+  GST_OBJECT_LOCK (pad);
+  priv->pool_allocations++;
+  GST_OBJECT_UNLOCK (pad);
+
+  GST_DEBUG_OBJECT (pad, "Created a pool of %" G_GSIZE_FORMAT " bytes buffers",
+      GST_VIDEO_INFO_SIZE (&pad->conversion_info));
+
+  return TRUE;
+}
+
+/* (Re)creates the converter of @pad, which is then kept for all the frames
+ * until the caps change or need_conversion_update is set again */
+static gboolean
+gst_videoaggregator_pad_update_conversion (GstVideoAggregatorPad * pad,
+    GstVideoAggregator * vagg)
+{
+  GstVideoAggregatorPadClass *klass = GST_VIDEO_AGGREGATOR_PAD_GET_CLASS (pad);
+  GstVideoInfo wanted_info;
+
+  pad->need_conversion_update = FALSE;
+
+  if (!pad->info.finfo ||
+      GST_VIDEO_INFO_FORMAT (&pad->info) == GST_VIDEO_FORMAT_UNKNOWN)
+    return TRUE;
+
+  /* the output format, at the size of the pad */
+  wanted_info = vagg->info;
+  gst_video_info_set_format (&wanted_info, GST_VIDEO_INFO_FORMAT (&vagg->info),
+      GST_VIDEO_INFO_WIDTH (&pad->info), GST_VIDEO_INFO_HEIGHT (&pad->info));
+  wanted_info.colorimetry = vagg->info.colorimetry;
+  wanted_info.chroma_site = vagg->info.chroma_site;
+  wanted_info.interlace_mode = vagg->info.interlace_mode;
+  wanted_info.par_n = vagg->info.par_n;
+  wanted_info.par_d = vagg->info.par_d;
+  wanted_info.fps_n = vagg->info.fps_n;
+  wanted_info.fps_d = vagg->info.fps_d;
+
+  if (!klass->set_info (pad, vagg, &pad->info, &wanted_info))
+    return FALSE;
+
+  return gst_videoaggregator_pad_update_pool (pad);
+}
+
 static gboolean
 gst_videoaggregator_update_converters (GstVideoAggregator * vagg)
 {
@@ -421,44 +657,13 @@ gst_videoaggregator_update_converters (GstVideoAggregator * vagg)
   /* Then browse the sinks once more, setting or unsetting conversion if needed */
   GST_OBJECT_LOCK (vagg);
   for (tmp = GST_ELEMENT (vagg)->sinkpads; tmp; tmp = tmp->next) {
-    gchar *colorimetry;
-    const gchar *chroma;
-
     pad = tmp->data;
 
-    if (!pad->info.finfo)
-      continue;
-
-    if (GST_VIDEO_INFO_FORMAT (&pad->info) == GST_VIDEO_FORMAT_UNKNOWN)
-      continue;
-
-    if (pad->priv->convert)
-      badvideoconvert_convert_free (pad->priv->convert);
-
-    pad->priv->convert = NULL;
-
-    colorimetry = gst_video_colorimetry_to_string (&(pad->info.colorimetry));
-    chroma = gst_video_chroma_to_string (pad->info.chroma_site);
-
-    if (best_format != GST_VIDEO_INFO_FORMAT (&pad->info) ||
-        g_strcmp0 (colorimetry, best_colorimetry) ||
-        g_strcmp0 (chroma, best_chroma)) {
-      GST_DEBUG_OBJECT (pad, "This pad will be converted from %d to %d",
-          GST_VIDEO_INFO_FORMAT (&pad->info),
-          GST_VIDEO_INFO_FORMAT (&best_info));
-      pad->priv->convert = badvideoconvert_convert_new (&pad->info, &best_info);
-      pad->need_conversion_update = TRUE;
-      if (!pad->priv->convert) {
-        g_free (colorimetry);
-        g_free (best_colorimetry);
-        GST_WARNING ("No path found for conversion");
-        GST_OBJECT_UNLOCK (vagg);
-        return FALSE;
-      }
-    } else {
-      GST_DEBUG_OBJECT (pad, "This pad will not need conversion");
+    if (!gst_videoaggregator_pad_update_conversion (pad, vagg)) {
+      g_free (best_colorimetry);
+      GST_OBJECT_UNLOCK (vagg);
+      return FALSE;
     }
-    g_free (colorimetry);
   }
   GST_OBJECT_UNLOCK (vagg);
 
@@ -975,17 +1180,28 @@ gst_videoaggregator_fill_queues (GstVideoAggregator * vagg,
         continue;
       }
     } else {
+      /* In live mode a pad can lack data without being EOS when the deadline
+       * was reached, only EOS pads can end the stream */
+      if (!is_eos)
+        eos = FALSE;
+
       if (pad->end_time != -1) {
         if (pad->end_time <= output_start_time) {
-          gst_buffer_replace (&pad->buffer, NULL);
-          pad->start_time = pad->end_time = -1;
-          if (is_eos) {
-            GST_DEBUG ("I just need more data");
-            need_more_data = TRUE;
+          if (!is_eos && gst_aggregator_pad_is_late (bpad)) {
+            GST_DEBUG_OBJECT (pad, "Late, repeating the last frame");
+          } else {
+            gst_buffer_replace (&pad->buffer, NULL);
+            pad->start_time = pad->end_time = -1;
+            if (is_eos) {
+              GST_DEBUG ("I just need more data");
+              need_more_data = TRUE;
+            }
           }
         } else if (is_eos) {
           eos = FALSE;
         }
+      } else if (!is_eos) {
+        GST_DEBUG_OBJECT (pad, "Late without any frame yet, skipping it");
       }
     }
   }
@@ -1000,76 +1216,163 @@ gst_videoaggregator_fill_queues (GstVideoAggregator * vagg,
 }
 
 static gboolean
-prepare_frames (GstVideoAggregator * vagg, GstVideoAggregatorPad * pad)
+sync_pad_values (GstVideoAggregator * vagg, GstVideoAggregatorPad * pad)
 {
   GstAggregatorPad *bpad = GST_AGGREGATOR_PAD (pad);
+  GstClockTime timestamp;
+  gint64 stream_time;
 
-  static GstAllocationParams params = { 0, 15, 0, 0, };
+  if (pad->buffer == NULL)
+    return TRUE;
 
-  if (pad->buffer != NULL) {
-    guint outsize;
-    GstClockTime timestamp;
-    gint64 stream_time;
-    GstSegment *seg;
-    GstVideoFrame *converted_frame;
-    GstBuffer *converted_buf = NULL;
-    GstVideoFrame *frame = g_slice_new0 (GstVideoFrame);
+  timestamp = GST_BUFFER_TIMESTAMP (pad->buffer);
+  stream_time = gst_segment_to_stream_time (&bpad->segment, GST_FORMAT_TIME,
+      timestamp);
 
-    seg = &bpad->segment;
+  /* sync object properties on stream time */
+  if (GST_CLOCK_TIME_IS_VALID (stream_time))
+    gst_object_sync_values (GST_OBJECT (pad), stream_time);
 
-    timestamp = GST_BUFFER_TIMESTAMP (pad->buffer);
+  return TRUE;
+}
 
-    stream_time = gst_segment_to_stream_time (seg, GST_FORMAT_TIME, timestamp);
+static gboolean
+gst_videoaggregator_pad_prepare_frame (GstVideoAggregatorPad * pad,
+    GstVideoAggregator * vagg)
+{
+  GstVideoAggregatorPadPrivate *priv = pad->priv;
+  GstBuffer *converted_buf = NULL;
+  GstFlowReturn ret;
 
-    /* sync object properties on stream time */
-    if (GST_CLOCK_TIME_IS_VALID (stream_time))
-      gst_object_sync_values (GST_OBJECT (pad), stream_time);
+  if (pad->buffer == NULL)
+    return TRUE;
 
+  if (!gst_video_frame_map (&priv->frame, &pad->buffer_vinfo, pad->buffer,
+          GST_MAP_READ)) {
+    GST_WARNING_OBJECT (vagg, "Could not map input buffer");
+    return TRUE;
+  }
 
-    if (!gst_video_frame_map (frame, &pad->buffer_vinfo, pad->buffer,
-            GST_MAP_READ)) {
-      GST_WARNING_OBJECT (vagg, "Could not map input buffer");
-    }
+  /* The converter is only rebuilt when the wanted conversion changed, and
+   * only gets a new share of the threads when the number of pads changed */
+  GST_OBJECT_LOCK (vagg);
+  if (pad->need_conversion_update &&
+      !gst_videoaggregator_pad_update_conversion (pad, vagg))
+    GST_WARNING_OBJECT (pad, "Could not update the conversion");
+  if (priv->convert &&
+      priv->slice_threads != gst_videoaggregator_get_slice_threads (vagg)) {
+    priv->slice_threads = gst_videoaggregator_get_slice_threads (vagg);
+    badvideoconvert_convert_set_n_threads (priv->convert,
+        priv->slice_threads);
+  }
+  GST_OBJECT_UNLOCK (vagg);
 
-    if (pad->priv->convert) {
-      gint converted_size;
+  if (priv->convert == NULL) {
+    pad->aggregated_frame = &priv->frame;
+    return TRUE;
+  }
 
-      converted_frame = g_slice_new0 (GstVideoFrame);
+  if (priv->pool == NULL ||
+      (ret = gst_buffer_pool_acquire_buffer (priv->pool, &converted_buf,
+              NULL)) != GST_FLOW_OK) {
+    GST_WARNING_OBJECT (vagg, "Could not get a buffer for the converted frame");
+    gst_video_frame_unmap (&priv->frame);
+    return FALSE;
+  }
 
-      /* We wait until here to set the conversion infos, in case vagg->info changed */
-      if (pad->need_conversion_update) {
-        pad->conversion_info = vagg->info;
-        gst_video_info_set_format (&(pad->conversion_info),
-            GST_VIDEO_INFO_FORMAT (&vagg->info), pad->info.width,
-            pad->info.height);
-        pad->need_conversion_update = FALSE;
-      }
+  /* Buffers only get allocated until the pool holds enough of them */
+  if (!gst_mini_object_get_qdata (GST_MINI_OBJECT_CAST (converted_buf),
+          counted_quark)) {
+    gst_mini_object_set_qdata (GST_MINI_OBJECT_CAST (converted_buf),
+        counted_quark, GINT_TO_POINTER (TRUE), NULL);
+    GST_OBJECT_LOCK (pad);
+    priv->buffer_allocations++;
+    GST_OBJECT_UNLOCK (pad);
+  }
 
-      converted_size = pad->conversion_info.size;
-      outsize = GST_VIDEO_INFO_SIZE (&vagg->info);
-      converted_size = converted_size > outsize ? converted_size : outsize;
-      converted_buf = gst_buffer_new_allocate (NULL, converted_size, &params);
+  if (!gst_video_frame_map (&priv->converted_frame, &pad->conversion_info,
+          converted_buf, GST_MAP_READWRITE)) {
+    GST_WARNING_OBJECT (vagg, "Could not map converted frame");
+    gst_buffer_unref (converted_buf);
+    gst_video_frame_unmap (&priv->frame);
+    return FALSE;
+  }
 
-      if (!gst_video_frame_map (converted_frame, &(pad->conversion_info),
-              converted_buf, GST_MAP_READWRITE)) {
-        GST_WARNING_OBJECT (vagg, "Could not map converted frame");
+  badvideoconvert_convert_convert (priv->convert, &priv->converted_frame,
+      &priv->frame);
+  gst_video_frame_unmap (&priv->frame);
 
-        return FALSE;
-      }
+  pad->converted_buffer = converted_buf;
+  pad->aggregated_frame = &priv->converted_frame;
 
-      badvideoconvert_convert_convert (pad->priv->convert, converted_frame,
-          frame);
-      pad->converted_buffer = converted_buf;
-      gst_video_frame_unmap (frame);
-    } else {
-      converted_frame = frame;
-      converted_buf = pad->buffer;
-    }
+  return TRUE;
+}
+
+typedef struct
+{
+  GstVideoAggregator *vagg;
+  GstVideoAggregatorPad *pad;
+} PrepareFrameTask;
 
-    pad->aggregated_frame = converted_frame;
+static void
+gst_videoaggregator_prepare_frame_task (PrepareFrameTask * task)
+{
+  GstVideoAggregatorPad *pad = task->pad;
+  GstVideoAggregatorPadClass *klass = GST_VIDEO_AGGREGATOR_PAD_GET_CLASS (pad);
+  GstClockTime start, elapsed;
+
+  if (pad->buffer == NULL)
+    return;
+
+  start = gst_util_get_timestamp ();
+  if (!klass->prepare_frame (pad, task->vagg))
+    GST_WARNING_OBJECT (pad, "Could not prepare the frame");
+  elapsed = gst_util_get_timestamp () - start;
+
+  pad->priv->prepare_time += elapsed;
+  pad->priv->prepared_frames++;
+  GST_LOG_OBJECT (pad, "Prepared frame in %" GST_TIME_FORMAT ", %"
+      GST_TIME_FORMAT " on average over %" G_GUINT64_FORMAT " frames",
+      GST_TIME_ARGS (elapsed),
+      GST_TIME_ARGS (pad->priv->prepare_time / pad->priv->prepared_frames),
+      pad->priv->prepared_frames);
+}
+
+/* Maps and converts the frames of all pads, spread over the conversion
+ * threads, and returns once they are all done */
+static void
+prepare_frames (GstVideoAggregator * vagg)
+{
+  GstVideoAggregatorPrivate *priv = vagg->priv;
+  PrepareFrameTask *tasks;
+  gpointer *task_data;
+  guint n_pads, i;
+  GList *l;
+
+  GST_OBJECT_LOCK (vagg);
+  if (gst_parallelized_task_runner_update (&priv->task_runner,
+          gst_videoaggregator_get_prepare_threads (vagg))) {
+    GST_DEBUG_OBJECT (vagg, "Preparing frames with %u threads",
+        gst_parallelized_task_runner_get_n_threads (priv->task_runner));
   }
 
-  return TRUE;
+  n_pads = GST_ELEMENT (vagg)->numsinkpads;
+  tasks = g_newa (PrepareFrameTask, n_pads);
+  task_data = g_newa (gpointer, n_pads);
+  for (l = GST_ELEMENT (vagg)->sinkpads, i = 0; l; l = l->next, i++) {
+    tasks[i].vagg = vagg;
+    tasks[i].pad = gst_object_ref (l->data);
+    task_data[i] = &tasks[i];
+  }
+  GST_OBJECT_UNLOCK (vagg);
+
+  /* prepare_frame takes the OBJECT_LOCK as needed */
+  gst_parallelized_task_runner_run (priv->task_runner,
+      (GstParallelizedTaskFunc) gst_videoaggregator_prepare_frame_task,
+      task_data, n_pads);
+
+  for (i = 0; i < n_pads; i++)
+    gst_object_unref (tasks[i].pad);
 }
 
 static gboolean
@@ -1077,10 +1380,10 @@ clean_pad (GstVideoAggregator * vagg, GstVideoAggregatorPad * pad)
 {
   if (pad->aggregated_frame) {
     gst_video_frame_unmap (pad->aggregated_frame);
-    g_slice_free (GstVideoFrame, pad->aggregated_frame);
     pad->aggregated_frame = NULL;
   }
 
+  /* goes back to the pool */
   if (pad->converted_buffer) {
     gst_buffer_unref (pad->converted_buffer);
     pad->converted_buffer = NULL;
@@ -1111,9 +1414,13 @@ gst_videoaggregator_do_aggregate (GstVideoAggregator * vagg,
   GST_BUFFER_DURATION (*outbuf) = output_end_time - output_start_time;
 
   if (vagg_klass->disable_frame_conversion == FALSE) {
-    /* Here we convert all the frames the subclass will have to aggregate */
+    /* Sync the properties of all pads first, the preparation of a pad can
+     * depend on the others (e.g. when it is hidden by them) */
     gst_aggregator_iterate_sinkpads (GST_AGGREGATOR (vagg),
-        (GstAggregatorPadForeachFunc) prepare_frames, NULL);
+        (GstAggregatorPadForeachFunc) sync_pad_values, NULL);
+
+    /* Here we convert all the frames the subclass will have to aggregate */
+    prepare_frames (vagg);
   }
 
   ret = vagg_klass->aggregate_frames (vagg, *outbuf);
@@ -1358,87 +1665,6 @@ gst_videoaggregator_query_duration (GstVideoAggregator * vagg, GstQuery * query)
   return res;
 }
 
-static gboolean
-gst_videoaggregator_query_latency (GstVideoAggregator * vagg, GstQuery * query)
-{
-  GstClockTime min, max;
-  gboolean live;
-  gboolean res;
-  GstIterator *it;
-  gboolean done;
-  GValue item = { 0 };
-
-  res = TRUE;
-  done = FALSE;
-  live = FALSE;
-  min = 0;
-  max = GST_CLOCK_TIME_NONE;
-
-  /* Take maximum of all latency values */
-  it = gst_element_iterate_sink_pads (GST_ELEMENT_CAST (vagg));
-  while (!done) {
-    switch (gst_iterator_next (it, &item)) {
-      case GST_ITERATOR_DONE:
-        done = TRUE;
-        break;
-      case GST_ITERATOR_OK:
-      {
-        GstPad *pad = g_value_get_object (&item);
-        GstQuery *peerquery;
-        GstClockTime min_cur, max_cur;
-        gboolean live_cur;
-
-        peerquery = gst_query_new_latency ();
-
-        /* Ask peer for latency */
-        res &= gst_pad_peer_query (pad, peerquery);
-
-        /* take max from all valid return values */
-        if (res) {
-          gst_query_parse_latency (peerquery, &live_cur, &min_cur, &max_cur);
-
-          if (min_cur > min)
-            min = min_cur;
-
-          if (max_cur != GST_CLOCK_TIME_NONE &&
-              ((max != GST_CLOCK_TIME_NONE && max_cur > max) ||
-                  (max == GST_CLOCK_TIME_NONE)))
-            max = max_cur;
-
-          live = live || live_cur;
-        }
-
-        gst_query_unref (peerquery);
-        g_value_reset (&item);
-        break;
-      }
-      case GST_ITERATOR_RESYNC:
-        live = FALSE;
-        min = 0;
-        max = GST_CLOCK_TIME_NONE;
-        res = TRUE;
-        gst_iterator_resync (it);
-        break;
-      default:
-        res = FALSE;
-        done = TRUE;
-        break;
-    }
-  }
-  g_value_unset (&item);
-  gst_iterator_free (it);
-
-  if (res) {
-    /* store the results */
-    GST_DEBUG_OBJECT (vagg, "Calculated total latency: live %s, min %"
-        GST_TIME_FORMAT ", max %" GST_TIME_FORMAT,
-        (live ? "yes" : "no"), GST_TIME_ARGS (min), GST_TIME_ARGS (max));
-    gst_query_set_latency (query, live, min, max);
-  }
-
-  return res;
-}
-
 static gboolean
 gst_videoaggregator_src_query (GstAggregator * agg, GstQuery * query)
 {
@@ -1468,8 +1694,6 @@ gst_videoaggregator_src_query (GstAggregator * agg, GstQuery * query)
       res = gst_videoaggregator_query_duration (vagg, query);
       break;
     case GST_QUERY_LATENCY:
-      res = gst_videoaggregator_query_latency (vagg, query);
-      break;
     case GST_QUERY_CAPS:
       res =
           GST_AGGREGATOR_CLASS (gst_videoaggregator_parent_class)->src_query
@@ -1859,6 +2083,10 @@ gst_videoaggregator_dispose (GObject * o)
 
   gst_caps_replace (&vagg->priv->current_caps, NULL);
 
+  if (vagg->priv->task_runner)
+    gst_parallelized_task_runner_free (vagg->priv->task_runner);
+  vagg->priv->task_runner = NULL;
+
   G_OBJECT_CLASS (gst_videoaggregator_parent_class)->dispose (o);
 }
 
@@ -1866,7 +2094,14 @@ static void
 gst_videoaggregator_get_property (GObject * object,
     guint prop_id, GValue * value, GParamSpec * pspec)
 {
+  GstVideoAggregator *vagg = GST_VIDEO_AGGREGATOR (object);
+
   switch (prop_id) {
+    case PROP_CONVERSION_THREADS:
+      GST_OBJECT_LOCK (vagg);
+      g_value_set_uint (value, vagg->priv->conversion_threads);
+      GST_OBJECT_UNLOCK (vagg);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -1877,7 +2112,20 @@ static void
 gst_videoaggregator_set_property (GObject * object,
     guint prop_id, const GValue * value, GParamSpec * pspec)
 {
+  GstVideoAggregator *vagg = GST_VIDEO_AGGREGATOR (object);
+
   switch (prop_id) {
+    case PROP_CONVERSION_THREADS:{
+      GList *l;
+
+      GST_OBJECT_LOCK (vagg);
+      vagg->priv->conversion_threads = g_value_get_uint (value);
+      /* the converters get rebuilt with their share of the threads */
+      for (l = GST_ELEMENT (vagg)->sinkpads; l; l = l->next)
+        GST_VIDEO_AGGREGATOR_PAD (l->data)->need_conversion_update = TRUE;
+      GST_OBJECT_UNLOCK (vagg);
+      break;
+    }
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -1903,6 +2151,13 @@ gst_videoaggregator_class_init (GstVideoAggregatorClass * klass)
   gobject_class->get_property = gst_videoaggregator_get_property;
   gobject_class->set_property = gst_videoaggregator_set_property;
 
+  g_object_class_install_property (gobject_class, PROP_CONVERSION_THREADS,
+      g_param_spec_uint ("conversion-threads", "Conversion threads",
+          "Number of threads converting the input frames in parallel, "
+          "0 for the number of processors", 0, G_MAXUINT,
+          DEFAULT_CONVERSION_THREADS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gstelement_class->request_new_pad =
       GST_DEBUG_FUNCPTR (gst_videoaggregator_request_new_pad);
   gstelement_class->release_pad =
@@ -1941,6 +2196,8 @@ gst_videoaggregator_init (GstVideoAggregator * vagg)
       GstVideoAggregatorPrivate);
 
   vagg->priv->current_caps = NULL;
+  vagg->priv->conversion_threads = DEFAULT_CONVERSION_THREADS;
+  vagg->priv->task_runner = NULL;
 
   g_mutex_init (&vagg->priv->lock);
   g_mutex_init (&vagg->priv->setcaps_lock);
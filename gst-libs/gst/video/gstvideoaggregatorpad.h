@@ -32,12 +32,15 @@ G_BEGIN_DECLS
 #define GST_VIDEO_AGGREGATOR_PAD(obj) \
         (G_TYPE_CHECK_INSTANCE_CAST((obj),GST_TYPE_VIDEO_AGGREGATOR_PAD, GstVideoAggregatorPad))
 #define GST_VIDEO_AGGREGATOR_PAD_CLASS(klass) \
-        (G_TYPE_CHECK_CLASS_CAST((klass),GST_TYPE_COMPOSITOR_PAD, GstVideoAggregatorPadClass))
+        (G_TYPE_CHECK_CLASS_CAST((klass),GST_TYPE_VIDEO_AGGREGATOR_PAD, GstVideoAggregatorPadClass))
+#define GST_VIDEO_AGGREGATOR_PAD_GET_CLASS(obj) \
+        (G_TYPE_INSTANCE_GET_CLASS((obj),GST_TYPE_VIDEO_AGGREGATOR_PAD, GstVideoAggregatorPadClass))
 #define GST_IS_VIDEO_AGGREGATOR_PAD(obj) \
         (G_TYPE_CHECK_INSTANCE_TYPE((obj),GST_TYPE_VIDEO_AGGREGATOR_PAD))
 #define GST_IS_VIDEO_AGGREGATOR_PAD_CLASS(klass) \
         (G_TYPE_CHECK_CLASS_TYPE((klass),GST_TYPE_VIDEO_AGGREGATOR_PAD))
 
+typedef struct _GstVideoAggregator GstVideoAggregator;
 typedef struct _GstVideoAggregatorPad GstVideoAggregatorPad;
 typedef struct _GstVideoAggregatorPadClass GstVideoAggregatorPadClass;
 typedef struct _GstVideoAggregatorPadPrivate GstVideoAggregatorPadPrivate;
@@ -79,10 +82,30 @@ struct _GstVideoAggregatorPad
   gpointer          _gst_reserved[GST_PADDING];
 };
 
+/**
+ * GstVideoAggregatorPadClass:
+ * @set_info:      Sets up the conversion of the frames of the pad from
+ *                 @current_info to @wanted_info, which is the output format
+ *                 at the size of the pad. Called when the caps change and
+ *                 when @need_conversion_update is set. Subclasses can change
+ *                 the size of @wanted_info to have the frames scaled.
+ * @prepare_frame: Prepares the frame of the pad buffer (if any) and sets
+ *                 @aggregated_frame. The default implementation maps the
+ *                 buffer and converts it to the output format if needed.
+ *                 Subclasses can skip the frame of a pad that would not be
+ *                 visible in the output by not setting @aggregated_frame.
+ */
 struct _GstVideoAggregatorPadClass
 {
   GstAggregatorPadClass parent_class;
 
+  gboolean          (*set_info)      (GstVideoAggregatorPad * pad,
+                                      GstVideoAggregator * videoaggregator,
+                                      GstVideoInfo * current_info,
+                                      GstVideoInfo * wanted_info);
+  gboolean          (*prepare_frame) (GstVideoAggregatorPad * pad,
+                                      GstVideoAggregator * videoaggregator);
+
   gpointer          _gst_reserved[GST_PADDING];
 };
 
@@ -33,17 +33,31 @@
 
 static void videoconvert_convert_generic (VideoConvert * convert,
     GstVideoFrame * dest, const GstVideoFrame * src);
+static void videoconvert_convert_scale (VideoConvert * convert,
+    GstVideoFrame * dest, const GstVideoFrame * src);
 static void videoconvert_convert_matrix8 (VideoConvert * convert,
     gpointer pixels);
 static void videoconvert_convert_matrix16 (VideoConvert * convert,
     gpointer pixels);
 static gboolean videoconvert_convert_lookup_fastpath (VideoConvert * convert);
 static gboolean videoconvert_convert_compute_matrix (VideoConvert * convert);
-static gboolean videoconvert_convert_compute_resample (VideoConvert * convert);
+static gboolean videoconvert_convert_compute_resample (VideoConvert * convert,
+    gboolean scale);
+static void videoconvert_convert_compute_scale (VideoConvert * convert);
 static void videoconvert_dither_verterr (VideoConvert * convert,
     guint16 * pixels, int j);
 static void videoconvert_dither_halftone (VideoConvert * convert,
     guint16 * pixels, int j);
+static void videoconvert_convert_free_slices (VideoConvert * convert);
+static void alloc_tmplines (VideoConvert * convert, guint lines, gint width);
+
+/* Lines of the slices of threaded conversions, a multiple of the lines
+ * processed together by the chroma resampling and the interlaced fast paths */
+#define SLICE_ALIGN 16
+
+/* fixed point of the scaling filter taps */
+#define TAP_SHIFT 12
+#define TAP_ONE (1 << TAP_SHIFT)
 
 
 VideoConvert *
@@ -58,16 +72,34 @@ badvideoconvert_convert_new (GstVideoInfo * in_info, GstVideoInfo * out_info)
   convert->out_info = *out_info;
   convert->dither16 = NULL;
 
-  convert->width = GST_VIDEO_INFO_WIDTH (in_info);
-  convert->height = GST_VIDEO_INFO_HEIGHT (in_info);
+  convert->width = GST_VIDEO_INFO_WIDTH (out_info);
+  convert->height = GST_VIDEO_INFO_HEIGHT (out_info);
+  convert->in_width = GST_VIDEO_INFO_WIDTH (in_info);
+  convert->in_height = GST_VIDEO_INFO_HEIGHT (in_info);
+  convert->slice_start = 0;
+  convert->slice_end = convert->height;
+  convert->n_threads = 1;
+
+  if (convert->in_width != convert->width ||
+      convert->in_height != convert->height) {
+    convert->convert = videoconvert_convert_scale;
+    if (!videoconvert_convert_compute_matrix (convert))
+      goto no_convert;
+
+    if (!videoconvert_convert_compute_resample (convert, TRUE))
+      goto no_convert;
 
-  if (!videoconvert_convert_lookup_fastpath (convert)) {
+    videoconvert_convert_compute_scale (convert);
+  } else if (!videoconvert_convert_lookup_fastpath (convert)) {
     convert->convert = videoconvert_convert_generic;
     if (!videoconvert_convert_compute_matrix (convert))
       goto no_convert;
 
-    if (!videoconvert_convert_compute_resample (convert))
+    if (!videoconvert_convert_compute_resample (convert, FALSE))
       goto no_convert;
+
+    alloc_tmplines (convert, convert->down_n_lines + convert->up_n_lines,
+        convert->width);
   }
 
   width = convert->width;
@@ -90,6 +122,8 @@ badvideoconvert_convert_free (VideoConvert * convert)
 {
   gint i;
 
+  videoconvert_convert_free_slices (convert);
+
   if (convert->upsample)
     gst_video_chroma_resample_free (convert->upsample);
   if (convert->downsample)
@@ -100,6 +134,13 @@ badvideoconvert_convert_free (VideoConvert * convert)
   g_free (convert->tmplines);
   g_free (convert->errline);
 
+  g_free (convert->x_offsets);
+  g_free (convert->x_weights);
+  g_free (convert->y_offsets);
+  g_free (convert->y_weights);
+  g_free (convert->scale_line_idx);
+  g_free (convert->scale_lines);
+
   g_free (convert);
 }
 
@@ -118,13 +159,182 @@ badvideoconvert_convert_set_dither (VideoConvert * convert, int type)
       convert->dither16 = videoconvert_dither_halftone;
       break;
   }
+
+  /* the slices are copies of the converter */
+  badvideoconvert_convert_set_n_threads (convert, convert->n_threads);
+}
+
+/* A converter for the lines @start to @end of the frames of @convert */
+static VideoConvert *
+videoconvert_convert_new_slice (VideoConvert * convert, gint start, gint end)
+{
+  VideoConvert *slice;
+
+  slice = g_memdup (convert, sizeof (VideoConvert));
+  slice->slice_start = start;
+  slice->slice_end = end;
+  slice->n_slices = 0;
+  slice->slices = NULL;
+  slice->task_runner = NULL;
+
+  alloc_tmplines (slice, convert->n_tmplines, MAX (convert->in_width,
+          convert->width));
+  slice->errline = g_malloc0 (sizeof (guint16) * convert->width * 4);
+  if (convert->convert == videoconvert_convert_scale) {
+    slice->scale_line_idx = g_new (gint, convert->y_taps);
+    slice->scale_lines = g_new (gpointer, convert->y_taps);
+  }
+
+  return slice;
+}
+
+static void
+videoconvert_convert_free_slices (VideoConvert * convert)
+{
+  guint i, j;
+
+  for (i = 0; i < convert->n_slices; i++) {
+    VideoConvert *slice = convert->slices[i];
+
+    for (j = 0; j < slice->n_tmplines; j++)
+      g_free (slice->tmplines[j]);
+    g_free (slice->tmplines);
+    g_free (slice->errline);
+    g_free (slice->scale_line_idx);
+    g_free (slice->scale_lines);
+    g_free (slice);
+  }
+  g_free (convert->slices);
+  convert->slices = NULL;
+  convert->n_slices = 0;
+
+  if (convert->task_runner)
+    gst_parallelized_task_runner_free (convert->task_runner);
+  convert->task_runner = NULL;
+}
+
+/**
+ * badvideoconvert_convert_set_n_threads:
+ * @convert: a #VideoConvert
+ * @n_threads: number of threads, 0 for the number of processors
+ *
+ * Splits the conversion of each frame in slices of lines converted in
+ * parallel by @n_threads threads. The default of 1 converts the frames in
+ * the calling thread.
+ *
+ * The error diffusion dither carries the error of a line over to the next
+ * one, so the frames are converted in the calling thread while it is
+ * selected, to give the same output as with 1 thread.
+ */
+void
+badvideoconvert_convert_set_n_threads (VideoConvert * convert,
+    guint n_threads)
+{
+  gint slice_height, start;
+  guint i;
+
+  videoconvert_convert_free_slices (convert);
+  convert->n_threads = n_threads;
+
+  if (n_threads == 1 || convert->height <= SLICE_ALIGN ||
+      convert->dither16 == videoconvert_dither_verterr)
+    return;
+
+  convert->task_runner = gst_parallelized_task_runner_new (n_threads);
+  n_threads = gst_parallelized_task_runner_get_n_threads (convert->task_runner);
+
+  slice_height = (convert->height + n_threads - 1) / n_threads;
+  slice_height = GST_ROUND_UP_N (slice_height, SLICE_ALIGN);
+  convert->n_slices = (convert->height + slice_height - 1) / slice_height;
+  if (convert->n_slices <= 1) {
+    videoconvert_convert_free_slices (convert);
+    return;
+  }
+
+  convert->slices = g_new (VideoConvert *, convert->n_slices);
+  for (i = 0, start = 0; i < convert->n_slices; i++, start += slice_height) {
+    convert->slices[i] = videoconvert_convert_new_slice (convert, start,
+        MIN (start + slice_height, convert->height));
+  }
+
+  GST_DEBUG ("converting %u slices of %d lines with %u threads",
+      convert->n_slices, slice_height, n_threads);
+}
+
+/* Makes @view the lines @start to @end of @frame */
+static void
+videoconvert_frame_lines (GstVideoFrame * view, const GstVideoFrame * frame,
+    gint start, gint end)
+{
+  const GstVideoFormatInfo *finfo = frame->info.finfo;
+  guint c;
+
+  *view = *frame;
+  GST_VIDEO_INFO_HEIGHT (&view->info) = end - start;
+
+  for (c = 0; c < GST_VIDEO_FORMAT_INFO_N_COMPONENTS (finfo); c++) {
+    guint plane = GST_VIDEO_FORMAT_INFO_PLANE (finfo, c);
+
+    view->data[plane] = (guint8 *) frame->data[plane] +
+        GST_VIDEO_FORMAT_INFO_SCALE_HEIGHT (finfo, c, start) *
+        GST_VIDEO_FRAME_PLANE_STRIDE (frame, plane);
+  }
+}
+
+typedef struct
+{
+  VideoConvert *slice;
+  GstVideoFrame *dest;
+  const GstVideoFrame *src;
+} VideoConvertSliceTask;
+
+static void
+videoconvert_convert_slice_task (VideoConvertSliceTask * task)
+{
+  VideoConvert *slice = task->slice;
+  GstVideoFrame dest, src;
+
+  /* The generic and scaling paths only write the lines of the slice, but
+   * read the input lines around it for the resampling */
+  if (slice->convert == videoconvert_convert_generic ||
+      slice->convert == videoconvert_convert_scale) {
+    slice->convert (slice, task->dest, task->src);
+    return;
+  }
+
+  /* The fast paths convert whole frames, the slice is given as one */
+  videoconvert_frame_lines (&dest, task->dest, slice->slice_start,
+      slice->slice_end);
+  videoconvert_frame_lines (&src, task->src, slice->slice_start,
+      slice->slice_end);
+  slice->convert (slice, &dest, &src);
 }
 
 void
 badvideoconvert_convert_convert (VideoConvert * convert,
     GstVideoFrame * dest, const GstVideoFrame * src)
 {
-  convert->convert (convert, dest, src);
+  VideoConvertSliceTask *tasks;
+  gpointer *task_data;
+  guint i;
+
+  if (convert->n_slices == 0) {
+    convert->convert (convert, dest, src);
+    return;
+  }
+
+  tasks = g_newa (VideoConvertSliceTask, convert->n_slices);
+  task_data = g_newa (gpointer, convert->n_slices);
+  for (i = 0; i < convert->n_slices; i++) {
+    tasks[i].slice = convert->slices[i];
+    tasks[i].dest = dest;
+    tasks[i].src = src;
+    task_data[i] = &tasks[i];
+  }
+
+  gst_parallelized_task_runner_run (convert->task_runner,
+      (GstParallelizedTaskFunc) videoconvert_convert_slice_task, task_data,
+      convert->n_slices);
 }
 
 #define SCALE    (8)
@@ -391,12 +601,14 @@ alloc_tmplines (VideoConvert * convert, guint lines, gint width)
     convert->tmplines[i] = g_malloc (sizeof (guint16) * (width + 8) * 4);
 }
 
+/* Creates the chroma resamplers between the input and output, or with
+ * @scale between them and full resolution chroma, which the scaling works
+ * on */
 static gboolean
-videoconvert_convert_compute_resample (VideoConvert * convert)
+videoconvert_convert_compute_resample (VideoConvert * convert, gboolean scale)
 {
   GstVideoInfo *in_info, *out_info;
   const GstVideoFormatInfo *sfinfo, *dfinfo;
-  gint width;
 
   in_info = &convert->in_info;
   out_info = &convert->out_info;
@@ -404,9 +616,16 @@ videoconvert_convert_compute_resample (VideoConvert * convert)
   sfinfo = in_info->finfo;
   dfinfo = out_info->finfo;
 
-  width = convert->width;
-
-  if (sfinfo->w_sub[2] != dfinfo->w_sub[2] ||
+  if (scale) {
+    if (sfinfo->w_sub[2] || sfinfo->h_sub[2])
+      convert->upsample = gst_video_chroma_resample_new (0,
+          in_info->chroma_site, 0, sfinfo->unpack_format, sfinfo->w_sub[2],
+          sfinfo->h_sub[2]);
+    if (dfinfo->w_sub[2] || dfinfo->h_sub[2])
+      convert->downsample = gst_video_chroma_resample_new (0,
+          out_info->chroma_site, 0, dfinfo->unpack_format, -dfinfo->w_sub[2],
+          -dfinfo->h_sub[2]);
+  } else if (sfinfo->w_sub[2] != dfinfo->w_sub[2] ||
       sfinfo->h_sub[2] != dfinfo->h_sub[2] ||
       in_info->chroma_site != out_info->chroma_site) {
     convert->upsample = gst_video_chroma_resample_new (0,
@@ -443,11 +662,90 @@ videoconvert_convert_compute_resample (VideoConvert * convert)
       convert->downsample, out_info->chroma_site, convert->down_offset,
       convert->down_n_lines);
 
-  alloc_tmplines (convert, convert->down_n_lines + convert->up_n_lines, width);
-
   return TRUE;
 }
 
+/* Tent filter taps to scale @in_size pixels to @out_size, as wide as an
+ * output pixel when downscaling. For each output pixel @offsets has the
+ * first input pixel and @weights the weights, in 1/TAP_ONE, of the returned
+ * number of taps from there. The taps past the edges go to the edge pixels. */
+static gint
+compute_scale_table (gint in_size, gint out_size, gint ** offsets,
+    guint16 ** weights)
+{
+  gdouble scale, radius, *tmp;
+  gint i, j, n, taps;
+
+  scale = (gdouble) in_size / out_size;
+  radius = MAX (scale, 1.0);
+  n = ceil (2 * radius);
+  taps = MIN (n, in_size);
+
+  *offsets = g_new (gint, out_size);
+  *weights = g_new (guint16, out_size * taps);
+  tmp = g_new (gdouble, taps);
+
+  for (i = 0; i < out_size; i++) {
+    guint16 *w = *weights + i * taps;
+    gdouble center, sum;
+    gint first, start, total, max;
+
+    center = (i + 0.5) * scale - 0.5;
+    first = floor (center - radius) + 1;
+    start = CLAMP (first, 0, in_size - taps);
+
+    for (j = 0; j < taps; j++)
+      tmp[j] = 0.0;
+
+    sum = 0.0;
+    for (j = first; j < first + n; j++) {
+      gdouble t = 1.0 - fabs (j - center) / radius;
+
+      if (t <= 0.0)
+        continue;
+
+      tmp[CLAMP (j, 0, in_size - 1) - start] += t;
+      sum += t;
+    }
+
+    /* the rounding error goes to the largest tap */
+    total = max = 0;
+    for (j = 0; j < taps; j++) {
+      w[j] = floor (tmp[j] * TAP_ONE / sum + 0.5);
+      total += w[j];
+      if (w[j] > w[max])
+        max = j;
+    }
+    w[max] += TAP_ONE - total;
+
+    (*offsets)[i] = start;
+  }
+  g_free (tmp);
+
+  return taps;
+}
+
+static void
+videoconvert_convert_compute_scale (VideoConvert * convert)
+{
+  convert->x_taps = compute_scale_table (convert->in_width, convert->width,
+      &convert->x_offsets, &convert->x_weights);
+  convert->y_taps = compute_scale_table (convert->in_height, convert->height,
+      &convert->y_offsets, &convert->y_weights);
+
+  convert->scale_line_idx = g_new (gint, convert->y_taps);
+  convert->scale_lines = g_new (gpointer, convert->y_taps);
+
+  GST_DEBUG ("scaling from %dx%d to %dx%d with %dx%d taps", convert->in_width,
+      convert->in_height, convert->width, convert->height, convert->x_taps,
+      convert->y_taps);
+
+  /* the upsampled input lines, the ring of horizontally scaled lines and the
+   * output lines for the downsampling */
+  alloc_tmplines (convert, convert->up_n_lines + convert->y_taps +
+      convert->down_n_lines, MAX (convert->in_width, convert->width));
+}
+
 #define TO_16(x) (((x)<<8) | (x))
 
 static void
@@ -501,20 +799,23 @@ videoconvert_convert_generic (VideoConvert * convert, GstVideoFrame * dest,
   gint in_lines, out_lines;
   gint up_line, down_line;
   gint start_offset, stop_offset;
+  gint slice_start, slice_end;
   gpointer in_tmplines[8];
   gpointer out_tmplines[8];
 
   height = convert->height;
   width = convert->width;
+  slice_start = convert->slice_start;
+  slice_end = convert->slice_end;
 
   in_bits = convert->in_bits;
   out_bits = convert->out_bits;
 
   lines = convert->lines;
   up_n_lines = convert->up_n_lines;
-  up_offset = convert->up_offset;
+  up_offset = convert->up_offset + slice_start;
   down_n_lines = convert->down_n_lines;
-  down_offset = convert->down_offset;
+  down_offset = convert->down_offset + slice_start;
   max_lines = convert->n_tmplines;
 
   in_lines = 0;
@@ -522,16 +823,19 @@ videoconvert_convert_generic (VideoConvert * convert, GstVideoFrame * dest,
 
   GST_DEBUG ("up_offset %d, up_n_lines %u", up_offset, up_n_lines);
 
+  /* a slice starts like a frame, on a multiple of the resampled lines, and
+   * also converts the lines around it that the resampling needs */
   start_offset = MIN (up_offset, down_offset);
-  stop_offset = height + start_offset + MAX (up_n_lines, down_n_lines);
+  stop_offset = slice_end + MIN (convert->up_offset, convert->down_offset) +
+      MAX (up_n_lines, down_n_lines);
 
   for (; start_offset < stop_offset; start_offset++) {
-    guint idx, start;
+    gint idx, start;
 
     idx = CLAMP (start_offset, 0, height);
     in_tmplines[in_lines] = convert->tmplines[idx % max_lines];
     out_tmplines[out_lines] = in_tmplines[in_lines];
-    GST_DEBUG ("start_offset %d/%d, %d, idx %u, in %d, out %d", start_offset,
+    GST_DEBUG ("start_offset %d/%d, %d, idx %d, in %d, out %d", start_offset,
         stop_offset, up_offset, idx, in_lines, out_lines);
 
     up_line = up_offset + in_lines;
@@ -599,7 +903,7 @@ videoconvert_convert_generic (VideoConvert * convert, GstVideoFrame * dest,
       for (j = 0; j < down_n_lines; j += lines) {
         idx = down_offset + j;
 
-        if (idx < height) {
+        if (idx >= slice_start && idx < slice_end) {
           GST_DEBUG ("packing line %d %d %d", j + start, down_offset, idx);
           /* FIXME, not correct if lines > 1 */
           PACK_FRAME (dest, out_tmplines[j + start], idx, width);
@@ -617,7 +921,197 @@ videoconvert_convert_generic (VideoConvert * convert, GstVideoFrame * dest,
 
     up_offset += up_n_lines;
   }
-  if ((pal =
+  if (slice_start == 0 && (pal =
+          gst_video_format_get_palette (GST_VIDEO_FRAME_FORMAT (dest),
+              &palsize))) {
+    memcpy (GST_VIDEO_FRAME_PLANE_DATA (dest, 1), pal, palsize);
+  }
+}
+
+#define SCALE_LINES(bits)                                               \
+static void                                                             \
+scale_h_##bits (VideoConvert * convert, guint##bits * dest,             \
+    const guint##bits * src)                                            \
+{                                                                       \
+  gint i, j, c, taps = convert->x_taps;                                 \
+  const guint16 *w = convert->x_weights;                                \
+                                                                        \
+  for (i = 0; i < convert->width; i++, w += taps) {                     \
+    const guint##bits *s = src + convert->x_offsets[i] * 4;             \
+                                                                        \
+    for (c = 0; c < 4; c++) {                                           \
+      guint sum = 1 << (TAP_SHIFT - 1);                                 \
+                                                                        \
+      for (j = 0; j < taps; j++)                                        \
+        sum += s[j * 4 + c] * w[j];                                     \
+      dest[i * 4 + c] = sum >> TAP_SHIFT;                               \
+    }                                                                   \
+  }                                                                     \
+}                                                                       \
+                                                                        \
+static void                                                             \
+scale_v_##bits (VideoConvert * convert, guint##bits * dest,             \
+    guint##bits ** src, const guint16 * w)                              \
+{                                                                       \
+  gint i, j, taps = convert->y_taps;                                    \
+                                                                        \
+  for (i = 0; i < convert->width * 4; i++) {                            \
+    guint sum = 1 << (TAP_SHIFT - 1);                                   \
+                                                                        \
+    for (j = 0; j < taps; j++)                                          \
+      sum += src[j][i] * w[j];                                          \
+    dest[i] = sum >> TAP_SHIFT;                                         \
+  }                                                                     \
+}
+
+SCALE_LINES (8)
+SCALE_LINES (16)
+
+/* Returns the input @line unpacked, with the chroma upsampled, and scaled
+ * horizontally, from the ring of the last y_taps lines when it is there */
+static gpointer
+videoconvert_get_scaled_line (VideoConvert * convert,
+    const GstVideoFrame * src, gint line)
+{
+  gint slot, in_width;
+  gpointer dest, in, *up_lines;
+
+  slot = line % convert->y_taps;
+  dest = convert->tmplines[convert->up_n_lines + slot];
+  if (convert->scale_line_idx[slot] == line)
+    return dest;
+
+  in_width = convert->in_width;
+  up_lines = convert->tmplines;
+
+  if (convert->upsample) {
+    gint i, n = convert->up_n_lines, start;
+
+    /* the groups of upsampled lines start like in the frame */
+    start = line - (((line - convert->up_offset) % n) + n) % n;
+    if (convert->up_start != start) {
+      for (i = 0; i < n; i++)
+        UNPACK_FRAME (src, up_lines[i], CLAMP (start + i, 0,
+                convert->in_height - 1), in_width);
+      gst_video_chroma_resample (convert->upsample, up_lines, in_width);
+      convert->up_start = start;
+    }
+    in = up_lines[line - start];
+  } else if (in_width == convert->width) {
+    UNPACK_FRAME (src, dest, line, in_width);
+    in = dest;
+  } else {
+    UNPACK_FRAME (src, up_lines[0], line, in_width);
+    in = up_lines[0];
+  }
+
+  if (in_width != convert->width) {
+    if (convert->in_bits == 16)
+      scale_h_16 (convert, dest, in);
+    else
+      scale_h_8 (convert, dest, in);
+  } else if (in != dest) {
+    memcpy (dest, in, in_width * 4 * (convert->in_bits / 8));
+  }
+  convert->scale_line_idx[slot] = line;
+
+  return dest;
+}
+
+/* Scaling of the unpacked lines with full resolution chroma by a tent
+ * filter, followed by the same color conversion as the generic path. The
+ * output lines are computed in the groups the chroma is downsampled in. */
+static void
+videoconvert_convert_scale (VideoConvert * convert, GstVideoFrame * dest,
+    const GstVideoFrame * src)
+{
+  gint i, j, n, width, height, start;
+  guint in_bits, out_bits;
+  gconstpointer pal;
+  gsize palsize;
+  gpointer *lines;
+
+  width = convert->width;
+  height = convert->height;
+
+  in_bits = convert->in_bits;
+  out_bits = convert->out_bits;
+
+  lines = convert->tmplines + convert->up_n_lines + convert->y_taps;
+  n = convert->down_n_lines;
+
+  for (i = 0; i < convert->y_taps; i++)
+    convert->scale_line_idx[i] = -1;
+  convert->up_start = G_MININT;
+
+  /* the groups start like in the frame, the lines of a group outside of the
+   * slice are computed for the downsampling but not packed */
+  start = convert->slice_start -
+      (((convert->slice_start - convert->down_offset) % n) + n) % n;
+
+  for (; start < convert->slice_end; start += n) {
+    for (j = 0; j < n; j++) {
+      gint line = start + j, y;
+      const guint16 *w;
+      gpointer l = lines[j];
+
+      if (line < 0 || line >= height)
+        continue;
+
+      y = convert->y_offsets[line];
+      w = convert->y_weights + line * convert->y_taps;
+
+      /* the scaled lines are cached, always work on a copy */
+      if (w[0] == TAP_ONE) {
+        memcpy (l, videoconvert_get_scaled_line (convert, src, y),
+            width * 4 * (in_bits / 8));
+      } else {
+        for (i = 0; i < convert->y_taps; i++)
+          convert->scale_lines[i] =
+              videoconvert_get_scaled_line (convert, src, y + i);
+        if (in_bits == 16)
+          scale_v_16 (convert, l, (guint16 **) convert->scale_lines, w);
+        else
+          scale_v_8 (convert, l, (guint8 **) convert->scale_lines, w);
+      }
+
+      if (out_bits == 16 || in_bits == 16) {
+        if (in_bits == 8)
+          convert_to16 (l, width);
+
+        if (convert->matrix)
+          convert->matrix (convert, l);
+        if (convert->dither16)
+          convert->dither16 (convert, l, line);
+
+        if (out_bits == 8)
+          convert_to8 (l, width);
+      } else {
+        if (convert->matrix)
+          convert->matrix (convert, l);
+      }
+    }
+
+    if (convert->downsample) {
+      /* repeat the edge lines for the groups that cross the edges */
+      for (j = 0; j < n; j++) {
+        gint line = CLAMP (start + j, 0, height - 1);
+
+        if (line != start + j)
+          memcpy (lines[j], lines[line - start], width * 4 * (out_bits / 8));
+      }
+      gst_video_chroma_resample (convert->downsample, lines, width);
+    }
+
+    for (j = 0; j < n; j += convert->lines) {
+      gint line = start + j;
+
+      if (line >= convert->slice_start && line < convert->slice_end)
+        PACK_FRAME (dest, lines[j], line, width);
+    }
+  }
+
+  if (convert->slice_start == 0 && (pal =
           gst_video_format_get_palette (GST_VIDEO_FRAME_FORMAT (dest),
               &palsize))) {
     memcpy (GST_VIDEO_FRAME_PLANE_DATA (dest, 1), pal, palsize);
@@ -667,7 +1161,7 @@ convert_I420_YUY2 (VideoConvert * convert, GstVideoFrame * dest,
 {
   int i;
   gint width = convert->width;
-  gint height = convert->height;
+  gint height = GST_VIDEO_FRAME_HEIGHT (dest);
   gboolean interlaced = GST_VIDEO_FRAME_IS_INTERLACED (src);
   gint l1, l2;
 
@@ -695,7 +1189,7 @@ convert_I420_UYVY (VideoConvert * convert, GstVideoFrame * dest,
 {
   int i;
   gint width = convert->width;
-  gint height = convert->height;
+  gint height = GST_VIDEO_FRAME_HEIGHT (dest);
   gboolean interlaced = GST_VIDEO_FRAME_IS_INTERLACED (src);
   gint l1, l2;
 
@@ -723,7 +1217,7 @@ convert_I420_AYUV (VideoConvert * convert, GstVideoFrame * dest,
 {
   int i;
   gint width = convert->width;
-  gint height = convert->height;
+  gint height = GST_VIDEO_FRAME_HEIGHT (dest);
   gboolean interlaced = GST_VIDEO_FRAME_IS_INTERLACED (src);
   gint l1, l2;
 
@@ -749,7 +1243,7 @@ convert_I420_Y42B (VideoConvert * convert, GstVideoFrame * dest,
     const GstVideoFrame * src)
 {
   gint width = convert->width;
-  gint height = convert->height;
+  gint height = GST_VIDEO_FRAME_HEIGHT (dest);
 
   bad_video_convert_orc_memcpy_2d (FRAME_GET_Y_LINE (dest, 0),
       FRAME_GET_Y_STRIDE (dest), FRAME_GET_Y_LINE (src, 0),
@@ -771,7 +1265,7 @@ convert_I420_Y444 (VideoConvert * convert, GstVideoFrame * dest,
     const GstVideoFrame * src)
 {
   gint width = convert->width;
-  gint height = convert->height;
+  gint height = GST_VIDEO_FRAME_HEIGHT (dest);
 
   bad_video_convert_orc_memcpy_2d (FRAME_GET_Y_LINE (dest, 0),
       FRAME_GET_Y_STRIDE (dest), FRAME_GET_Y_LINE (src, 0),
@@ -800,7 +1294,7 @@ convert_YUY2_I420 (VideoConvert * convert, GstVideoFrame * dest,
 {
   int i;
   gint width = convert->width;
-  gint height = convert->height;
+  gint height = GST_VIDEO_FRAME_HEIGHT (dest);
   gboolean interlaced = GST_VIDEO_FRAME_IS_INTERLACED (src);
   gint l1, l2;
 
@@ -826,7 +1320,7 @@ convert_YUY2_AYUV (VideoConvert * convert, GstVideoFrame * dest,
     const GstVideoFrame * src)
 {
   gint width = convert->width;
-  gint height = convert->height;
+  gint height = GST_VIDEO_FRAME_HEIGHT (dest);
 
   bad_video_convert_orc_convert_YUY2_AYUV (FRAME_GET_LINE (dest, 0),
       FRAME_GET_STRIDE (dest), FRAME_GET_LINE (src, 0),
@@ -838,7 +1332,7 @@ convert_YUY2_Y42B (VideoConvert * convert, GstVideoFrame * dest,
     const GstVideoFrame * src)
 {
   gint width = convert->width;
-  gint height = convert->height;
+  gint height = GST_VIDEO_FRAME_HEIGHT (dest);
 
   bad_video_convert_orc_convert_YUY2_Y42B (FRAME_GET_Y_LINE (dest, 0),
       FRAME_GET_Y_STRIDE (dest), FRAME_GET_U_LINE (dest, 0),
@@ -852,7 +1346,7 @@ convert_YUY2_Y444 (VideoConvert * convert, GstVideoFrame * dest,
     const GstVideoFrame * src)
 {
   gint width = convert->width;
-  gint height = convert->height;
+  gint height = GST_VIDEO_FRAME_HEIGHT (dest);
 
   bad_video_convert_orc_convert_YUY2_Y444 (FRAME_GET_COMP_LINE (dest, 0, 0),
       FRAME_GET_COMP_STRIDE (dest, 0), FRAME_GET_COMP_LINE (dest, 1, 0),
@@ -868,7 +1362,7 @@ convert_UYVY_I420 (VideoConvert * convert, GstVideoFrame * dest,
 {
   int i;
   gint width = convert->width;
-  gint height = convert->height;
+  gint height = GST_VIDEO_FRAME_HEIGHT (dest);
   gboolean interlaced = GST_VIDEO_FRAME_IS_INTERLACED (src);
   gint l1, l2;
 
@@ -894,7 +1388,7 @@ convert_UYVY_AYUV (VideoConvert * convert, GstVideoFrame * dest,
     const GstVideoFrame * src)
 {
   gint width = convert->width;
-  gint height = convert->height;
+  gint height = GST_VIDEO_FRAME_HEIGHT (dest);
 
   bad_video_convert_orc_convert_UYVY_AYUV (FRAME_GET_LINE (dest, 0),
       FRAME_GET_STRIDE (dest), FRAME_GET_LINE (src, 0),
@@ -906,7 +1400,7 @@ convert_UYVY_YUY2 (VideoConvert * convert, GstVideoFrame * dest,
     const GstVideoFrame * src)
 {
   gint width = convert->width;
-  gint height = convert->height;
+  gint height = GST_VIDEO_FRAME_HEIGHT (dest);
 
   bad_video_convert_orc_convert_UYVY_YUY2 (FRAME_GET_LINE (dest, 0),
       FRAME_GET_STRIDE (dest), FRAME_GET_LINE (src, 0),
@@ -918,7 +1412,7 @@ convert_UYVY_Y42B (VideoConvert * convert, GstVideoFrame * dest,
     const GstVideoFrame * src)
 {
   gint width = convert->width;
-  gint height = convert->height;
+  gint height = GST_VIDEO_FRAME_HEIGHT (dest);
 
   bad_video_convert_orc_convert_UYVY_Y42B (FRAME_GET_Y_LINE (dest, 0),
       FRAME_GET_Y_STRIDE (dest), FRAME_GET_U_LINE (dest, 0),
@@ -932,7 +1426,7 @@ convert_UYVY_Y444 (VideoConvert * convert, GstVideoFrame * dest,
     const GstVideoFrame * src)
 {
   gint width = convert->width;
-  gint height = convert->height;
+  gint height = GST_VIDEO_FRAME_HEIGHT (dest);
 
   bad_video_convert_orc_convert_UYVY_Y444 (FRAME_GET_Y_LINE (dest, 0),
       FRAME_GET_Y_STRIDE (dest), FRAME_GET_U_LINE (dest, 0),
@@ -946,7 +1440,7 @@ convert_AYUV_I420 (VideoConvert * convert, GstVideoFrame * dest,
     const GstVideoFrame * src)
 {
   gint width = convert->width;
-  gint height = convert->height;
+  gint height = GST_VIDEO_FRAME_HEIGHT (dest);
 
   /* only for even width/height */
   bad_video_convert_orc_convert_AYUV_I420 (FRAME_GET_Y_LINE (dest, 0),
@@ -963,7 +1457,7 @@ convert_AYUV_YUY2 (VideoConvert * convert, GstVideoFrame * dest,
     const GstVideoFrame * src)
 {
   gint width = convert->width;
-  gint height = convert->height;
+  gint height = GST_VIDEO_FRAME_HEIGHT (dest);
 
   /* only for even width */
   bad_video_convert_orc_convert_AYUV_YUY2 (FRAME_GET_LINE (dest, 0),
@@ -976,7 +1470,7 @@ convert_AYUV_UYVY (VideoConvert * convert, GstVideoFrame * dest,
     const GstVideoFrame * src)
 {
   gint width = convert->width;
-  gint height = convert->height;
+  gint height = GST_VIDEO_FRAME_HEIGHT (dest);
 
   /* only for even width */
   bad_video_convert_orc_convert_AYUV_UYVY (FRAME_GET_LINE (dest, 0),
@@ -989,7 +1483,7 @@ convert_AYUV_Y42B (VideoConvert * convert, GstVideoFrame * dest,
     const GstVideoFrame * src)
 {
   gint width = convert->width;
-  gint height = convert->height;
+  gint height = GST_VIDEO_FRAME_HEIGHT (dest);
 
   /* only works for even width */
   bad_video_convert_orc_convert_AYUV_Y42B (FRAME_GET_Y_LINE (dest, 0),
@@ -1004,7 +1498,7 @@ convert_AYUV_Y444 (VideoConvert * convert, GstVideoFrame * dest,
     const GstVideoFrame * src)
 {
   gint width = convert->width;
-  gint height = convert->height;
+  gint height = GST_VIDEO_FRAME_HEIGHT (dest);
 
   bad_video_convert_orc_convert_AYUV_Y444 (FRAME_GET_Y_LINE (dest, 0),
       FRAME_GET_Y_STRIDE (dest), FRAME_GET_U_LINE (dest, 0),
@@ -1018,7 +1512,7 @@ convert_Y42B_I420 (VideoConvert * convert, GstVideoFrame * dest,
     const GstVideoFrame * src)
 {
   gint width = convert->width;
-  gint height = convert->height;
+  gint height = GST_VIDEO_FRAME_HEIGHT (dest);
 
   bad_video_convert_orc_memcpy_2d (FRAME_GET_Y_LINE (dest, 0),
       FRAME_GET_Y_STRIDE (dest), FRAME_GET_Y_LINE (src, 0),
@@ -1046,7 +1540,7 @@ convert_Y42B_Y444 (VideoConvert * convert, GstVideoFrame * dest,
     const GstVideoFrame * src)
 {
   gint width = convert->width;
-  gint height = convert->height;
+  gint height = GST_VIDEO_FRAME_HEIGHT (dest);
 
   bad_video_convert_orc_memcpy_2d (FRAME_GET_Y_LINE (dest, 0),
       FRAME_GET_Y_STRIDE (dest), FRAME_GET_Y_LINE (src, 0),
@@ -1066,7 +1560,7 @@ convert_Y42B_YUY2 (VideoConvert * convert, GstVideoFrame * dest,
     const GstVideoFrame * src)
 {
   gint width = convert->width;
-  gint height = convert->height;
+  gint height = GST_VIDEO_FRAME_HEIGHT (dest);
 
   bad_video_convert_orc_convert_Y42B_YUY2 (FRAME_GET_LINE (dest, 0),
       FRAME_GET_STRIDE (dest), FRAME_GET_Y_LINE (src, 0),
@@ -1080,7 +1574,7 @@ convert_Y42B_UYVY (VideoConvert * convert, GstVideoFrame * dest,
     const GstVideoFrame * src)
 {
   gint width = convert->width;
-  gint height = convert->height;
+  gint height = GST_VIDEO_FRAME_HEIGHT (dest);
 
   bad_video_convert_orc_convert_Y42B_UYVY (FRAME_GET_LINE (dest, 0),
       FRAME_GET_STRIDE (dest), FRAME_GET_Y_LINE (src, 0),
@@ -1094,7 +1588,7 @@ convert_Y42B_AYUV (VideoConvert * convert, GstVideoFrame * dest,
     const GstVideoFrame * src)
 {
   gint width = convert->width;
-  gint height = convert->height;
+  gint height = GST_VIDEO_FRAME_HEIGHT (dest);
 
   /* only for even width */
   bad_video_convert_orc_convert_Y42B_AYUV (FRAME_GET_LINE (dest, 0),
@@ -1109,7 +1603,7 @@ convert_Y444_I420 (VideoConvert * convert, GstVideoFrame * dest,
     const GstVideoFrame * src)
 {
   gint width = convert->width;
-  gint height = convert->height;
+  gint height = GST_VIDEO_FRAME_HEIGHT (dest);
 
   bad_video_convert_orc_memcpy_2d (FRAME_GET_Y_LINE (dest, 0),
       FRAME_GET_Y_STRIDE (dest), FRAME_GET_Y_LINE (src, 0),
@@ -1137,7 +1631,7 @@ convert_Y444_Y42B (VideoConvert * convert, GstVideoFrame * dest,
     const GstVideoFrame * src)
 {
   gint width = convert->width;
-  gint height = convert->height;
+  gint height = GST_VIDEO_FRAME_HEIGHT (dest);
 
   bad_video_convert_orc_memcpy_2d (FRAME_GET_Y_LINE (dest, 0),
       FRAME_GET_Y_STRIDE (dest), FRAME_GET_Y_LINE (src, 0),
@@ -1157,7 +1651,7 @@ convert_Y444_YUY2 (VideoConvert * convert, GstVideoFrame * dest,
     const GstVideoFrame * src)
 {
   gint width = convert->width;
-  gint height = convert->height;
+  gint height = GST_VIDEO_FRAME_HEIGHT (dest);
 
   bad_video_convert_orc_convert_Y444_YUY2 (FRAME_GET_LINE (dest, 0),
       FRAME_GET_STRIDE (dest), FRAME_GET_Y_LINE (src, 0),
@@ -1171,7 +1665,7 @@ convert_Y444_UYVY (VideoConvert * convert, GstVideoFrame * dest,
     const GstVideoFrame * src)
 {
   gint width = convert->width;
-  gint height = convert->height;
+  gint height = GST_VIDEO_FRAME_HEIGHT (dest);
 
   bad_video_convert_orc_convert_Y444_UYVY (FRAME_GET_LINE (dest, 0),
       FRAME_GET_STRIDE (dest), FRAME_GET_Y_LINE (src, 0),
@@ -1185,7 +1679,7 @@ convert_Y444_AYUV (VideoConvert * convert, GstVideoFrame * dest,
     const GstVideoFrame * src)
 {
   gint width = convert->width;
-  gint height = convert->height;
+  gint height = GST_VIDEO_FRAME_HEIGHT (dest);
 
   bad_video_convert_orc_convert_Y444_AYUV (FRAME_GET_LINE (dest, 0),
       FRAME_GET_STRIDE (dest), FRAME_GET_Y_LINE (src, 0),
@@ -1194,13 +1688,90 @@ convert_Y444_AYUV (VideoConvert * convert, GstVideoFrame * dest,
       FRAME_GET_V_STRIDE (src), width, height);
 }
 
+static void
+convert_I420_NV12 (VideoConvert * convert, GstVideoFrame * dest,
+    const GstVideoFrame * src)
+{
+  gint width = convert->width;
+  gint height = GST_VIDEO_FRAME_HEIGHT (dest);
+
+  bad_video_convert_orc_memcpy_2d (FRAME_GET_Y_LINE (dest, 0),
+      FRAME_GET_Y_STRIDE (dest), FRAME_GET_Y_LINE (src, 0),
+      FRAME_GET_Y_STRIDE (src), width, height);
+
+  bad_video_convert_orc_merge_uv (FRAME_GET_U_LINE (dest, 0),
+      FRAME_GET_U_STRIDE (dest), FRAME_GET_U_LINE (src, 0),
+      FRAME_GET_U_STRIDE (src), FRAME_GET_V_LINE (src, 0),
+      FRAME_GET_V_STRIDE (src), (width + 1) / 2, (height + 1) / 2);
+}
+
+static void
+convert_NV12_I420 (VideoConvert * convert, GstVideoFrame * dest,
+    const GstVideoFrame * src)
+{
+  gint width = convert->width;
+  gint height = GST_VIDEO_FRAME_HEIGHT (dest);
+
+  bad_video_convert_orc_memcpy_2d (FRAME_GET_Y_LINE (dest, 0),
+      FRAME_GET_Y_STRIDE (dest), FRAME_GET_Y_LINE (src, 0),
+      FRAME_GET_Y_STRIDE (src), width, height);
+
+  bad_video_convert_orc_split_uv (FRAME_GET_U_LINE (dest, 0),
+      FRAME_GET_U_STRIDE (dest), FRAME_GET_V_LINE (dest, 0),
+      FRAME_GET_V_STRIDE (dest), FRAME_GET_U_LINE (src, 0),
+      FRAME_GET_U_STRIDE (src), (width + 1) / 2, (height + 1) / 2);
+}
+
+static void
+convert_NV12_AYUV (VideoConvert * convert, GstVideoFrame * dest,
+    const GstVideoFrame * src)
+{
+  int i;
+  gint width = convert->width;
+  gint height = GST_VIDEO_FRAME_HEIGHT (dest);
+  gboolean interlaced = GST_VIDEO_FRAME_IS_INTERLACED (src);
+  gint l1, l2;
+
+  /* only for even width */
+  for (i = 0; i < GST_ROUND_DOWN_2 (height); i += 2) {
+    GET_LINE_OFFSETS (interlaced, i, l1, l2);
+
+    bad_video_convert_orc_convert_NV12_AYUV (FRAME_GET_LINE (dest, l1),
+        FRAME_GET_LINE (dest, l2),
+        FRAME_GET_Y_LINE (src, l1),
+        FRAME_GET_Y_LINE (src, l2), FRAME_GET_U_LINE (src, i >> 1), width / 2);
+  }
+
+  /* now handle last line */
+  if (height & 1) {
+    UNPACK_FRAME (src, convert->tmplines[0], height - 1, width);
+    PACK_FRAME (dest, convert->tmplines[0], height - 1, width);
+  }
+}
+
+static void
+convert_AYUV_NV12 (VideoConvert * convert, GstVideoFrame * dest,
+    const GstVideoFrame * src)
+{
+  gint width = convert->width;
+  gint height = GST_VIDEO_FRAME_HEIGHT (dest);
+
+  /* only for even width/height */
+  bad_video_convert_orc_convert_AYUV_NV12 (FRAME_GET_Y_LINE (dest, 0),
+      2 * FRAME_GET_Y_STRIDE (dest), FRAME_GET_Y_LINE (dest, 1),
+      2 * FRAME_GET_Y_STRIDE (dest), FRAME_GET_U_LINE (dest, 0),
+      FRAME_GET_U_STRIDE (dest), FRAME_GET_LINE (src, 0),
+      2 * FRAME_GET_STRIDE (src), FRAME_GET_LINE (src, 1),
+      2 * FRAME_GET_STRIDE (src), width / 2, height / 2);
+}
+
 #if G_BYTE_ORDER == G_LITTLE_ENDIAN
 static void
 convert_AYUV_ARGB (VideoConvert * convert, GstVideoFrame * dest,
     const GstVideoFrame * src)
 {
   gint width = convert->width;
-  gint height = convert->height;
+  gint height = GST_VIDEO_FRAME_HEIGHT (dest);
 
   bad_video_convert_orc_convert_AYUV_ARGB (FRAME_GET_LINE (dest, 0),
       FRAME_GET_STRIDE (dest), FRAME_GET_LINE (src, 0),
@@ -1214,7 +1785,7 @@ convert_AYUV_BGRA (VideoConvert * convert, GstVideoFrame * dest,
     const GstVideoFrame * src)
 {
   gint width = convert->width;
-  gint height = convert->height;
+  gint height = GST_VIDEO_FRAME_HEIGHT (dest);
 
   bad_video_convert_orc_convert_AYUV_BGRA (FRAME_GET_LINE (dest, 0),
       FRAME_GET_STRIDE (dest), FRAME_GET_LINE (src, 0),
@@ -1228,7 +1799,7 @@ convert_AYUV_ABGR (VideoConvert * convert, GstVideoFrame * dest,
     const GstVideoFrame * src)
 {
   gint width = convert->width;
-  gint height = convert->height;
+  gint height = GST_VIDEO_FRAME_HEIGHT (dest);
 
   bad_video_convert_orc_convert_AYUV_ABGR (FRAME_GET_LINE (dest, 0),
       FRAME_GET_STRIDE (dest), FRAME_GET_LINE (src, 0),
@@ -1242,7 +1813,7 @@ convert_AYUV_RGBA (VideoConvert * convert, GstVideoFrame * dest,
     const GstVideoFrame * src)
 {
   gint width = convert->width;
-  gint height = convert->height;
+  gint height = GST_VIDEO_FRAME_HEIGHT (dest);
 
   bad_video_convert_orc_convert_AYUV_RGBA (FRAME_GET_LINE (dest, 0),
       FRAME_GET_STRIDE (dest), FRAME_GET_LINE (src, 0),
@@ -1257,7 +1828,7 @@ convert_I420_BGRA (VideoConvert * convert, GstVideoFrame * dest,
 {
   int i;
   gint width = convert->width;
-  gint height = convert->height;
+  gint height = GST_VIDEO_FRAME_HEIGHT (dest);
 
   for (i = 0; i < height; i++) {
     bad_video_convert_orc_convert_I420_BGRA (FRAME_GET_LINE (dest, i),
@@ -1268,6 +1839,30 @@ convert_I420_BGRA (VideoConvert * convert, GstVideoFrame * dest,
         width);
   }
 }
+
+static void
+convert_NV12_BGRA (VideoConvert * convert, GstVideoFrame * dest,
+    const GstVideoFrame * src)
+{
+  int i;
+  gint width = convert->width;
+  gint height = GST_VIDEO_FRAME_HEIGHT (dest);
+  guint8 *u = convert->tmplines[0];
+  guint8 *v = u + GST_ROUND_UP_4 ((width + 1) / 2);
+
+  for (i = 0; i < height; i++) {
+    /* split each chroma line once, for the two lines using it */
+    if ((i & 1) == 0)
+      bad_video_convert_orc_split_uv (u, 0, v, 0, FRAME_GET_U_LINE (src,
+              i >> 1), 0, (width + 1) / 2, 1);
+
+    bad_video_convert_orc_convert_I420_BGRA (FRAME_GET_LINE (dest, i),
+        FRAME_GET_Y_LINE (src, i), u, v,
+        convert->cmatrix[0][0], convert->cmatrix[0][2],
+        convert->cmatrix[2][1], convert->cmatrix[1][1], convert->cmatrix[1][2],
+        width);
+  }
+}
 #endif
 
 
@@ -1415,6 +2010,25 @@ static const VideoTransform transforms[] = {
         GST_VIDEO_COLOR_MATRIX_UNKNOWN, TRUE, TRUE, FALSE, 1, 0,
       convert_Y444_Y42B},
 
+  {GST_VIDEO_FORMAT_I420, GST_VIDEO_COLOR_MATRIX_UNKNOWN, GST_VIDEO_FORMAT_NV12,
+        GST_VIDEO_COLOR_MATRIX_UNKNOWN, TRUE, TRUE, FALSE, 0, 0,
+      convert_I420_NV12},
+  {GST_VIDEO_FORMAT_YV12, GST_VIDEO_COLOR_MATRIX_UNKNOWN, GST_VIDEO_FORMAT_NV12,
+        GST_VIDEO_COLOR_MATRIX_UNKNOWN, TRUE, TRUE, FALSE, 0, 0,
+      convert_I420_NV12},
+  {GST_VIDEO_FORMAT_NV12, GST_VIDEO_COLOR_MATRIX_UNKNOWN, GST_VIDEO_FORMAT_I420,
+        GST_VIDEO_COLOR_MATRIX_UNKNOWN, TRUE, TRUE, FALSE, 0, 0,
+      convert_NV12_I420},
+  {GST_VIDEO_FORMAT_NV12, GST_VIDEO_COLOR_MATRIX_UNKNOWN, GST_VIDEO_FORMAT_YV12,
+        GST_VIDEO_COLOR_MATRIX_UNKNOWN, TRUE, TRUE, FALSE, 0, 0,
+      convert_NV12_I420},
+  {GST_VIDEO_FORMAT_NV12, GST_VIDEO_COLOR_MATRIX_UNKNOWN, GST_VIDEO_FORMAT_AYUV,
+        GST_VIDEO_COLOR_MATRIX_UNKNOWN, TRUE, TRUE, FALSE, 1, 0,
+      convert_NV12_AYUV},
+  {GST_VIDEO_FORMAT_AYUV, GST_VIDEO_COLOR_MATRIX_UNKNOWN, GST_VIDEO_FORMAT_NV12,
+        GST_VIDEO_COLOR_MATRIX_UNKNOWN, TRUE, FALSE, FALSE, 1, 1,
+      convert_AYUV_NV12},
+
 #if G_BYTE_ORDER == G_LITTLE_ENDIAN
   {GST_VIDEO_FORMAT_AYUV, GST_VIDEO_COLOR_MATRIX_UNKNOWN, GST_VIDEO_FORMAT_ARGB,
         GST_VIDEO_COLOR_MATRIX_UNKNOWN, TRUE, TRUE, TRUE, 0, 0,
@@ -1449,6 +2063,15 @@ static const VideoTransform transforms[] = {
   {GST_VIDEO_FORMAT_YV12, GST_VIDEO_COLOR_MATRIX_UNKNOWN, GST_VIDEO_FORMAT_BGRx,
         GST_VIDEO_COLOR_MATRIX_UNKNOWN, TRUE, FALSE, TRUE, 0, 0,
       convert_I420_BGRA},
+  {GST_VIDEO_FORMAT_NV12, GST_VIDEO_COLOR_MATRIX_UNKNOWN, GST_VIDEO_FORMAT_BGRA,
+        GST_VIDEO_COLOR_MATRIX_UNKNOWN, TRUE, FALSE, TRUE, 0, 0,
+      convert_NV12_BGRA},
+  {GST_VIDEO_FORMAT_NV12, GST_VIDEO_COLOR_MATRIX_UNKNOWN, GST_VIDEO_FORMAT_BGRx,
+        GST_VIDEO_COLOR_MATRIX_UNKNOWN, TRUE, FALSE, TRUE, 0, 0,
+      convert_NV12_BGRA},
+  /* No fast path from BGRA: the kernels above only take the 5 coefficients
+   * of a YUV to RGB matrix that are not 0 or 1, the other way round needs
+   * all 9 of them and the offsets. The generic path does it in slices. */
 #endif
 };
 
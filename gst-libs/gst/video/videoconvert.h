@@ -24,6 +24,7 @@ typedef struct _VideoConvert VideoConvert;
 
 #include <gst/video/video.h>
 #include "gstcms.h"
+#include "gstparallelizedtaskrunner.h"
 
 G_BEGIN_DECLS
 
@@ -37,6 +38,7 @@ struct _VideoConvert {
   GstVideoInfo in_info;
   GstVideoInfo out_info;
 
+  /* size of the output, the input has the same size unless scaling */
   gint width;
   gint height;
 
@@ -59,6 +61,36 @@ struct _VideoConvert {
   guint down_n_lines;
   gint down_offset;
 
+  /* scaling, the first input pixel and line and the weights of the taps
+   * from there for each output pixel and line. The last y_taps horizontally
+   * scaled lines are kept in a ring, with their input line in scale_line_idx,
+   * and the group of upsampled input lines starting at up_start. */
+  gint in_width;
+  gint in_height;
+  gint x_taps;
+  gint *x_offsets;
+  guint16 *x_weights;
+  gint y_taps;
+  gint *y_offsets;
+  guint16 *y_weights;
+  gint *scale_line_idx;
+  gpointer *scale_lines;
+  gint up_start;
+
+  /* lines of the output converted by this converter, all of them unless it
+   * is one of the slices of a threaded converter */
+  gint slice_start;
+  gint slice_end;
+
+  /* converters of the slices of the frame, which share the tables of this
+   * one but have their own temporary lines, run on task_runner. The frames
+   * are not sliced with the error diffusion dither, whose error is carried
+   * from line to line. */
+  guint n_threads;
+  guint n_slices;
+  VideoConvert **slices;
+  GstParallelizedTaskRunner *task_runner;
+
   void (*convert)      (VideoConvert *convert, GstVideoFrame *dest, const GstVideoFrame *src);
   void (*matrix)       (VideoConvert *convert, gpointer pixels);
   void (*dither16)     (VideoConvert *convert, guint16 * pixels, int j);
@@ -70,6 +102,7 @@ VideoConvert *   badvideoconvert_convert_new            (GstVideoInfo *in_info,
 void             badvideoconvert_convert_free           (VideoConvert * convert);
 
 void             badvideoconvert_convert_set_dither     (VideoConvert * convert, int type);
+void             badvideoconvert_convert_set_n_threads  (VideoConvert * convert, guint n_threads);
 
 void             badvideoconvert_convert_convert        (VideoConvert * convert,
                                                       GstVideoFrame *dest, const GstVideoFrame *src);
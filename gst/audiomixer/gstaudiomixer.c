@@ -27,8 +27,24 @@
  * The audiomixer allows to mix several streams into one by adding the data.
  * Mixed data is clamped to the min/max values of the data format.
  *
- * The audiomixer currently mixes all data received on the sinkpads as soon as
- * possible without trying to synchronize the streams.
+ * The audiomixer synchronizes the streams on their running time and outputs
+ * buffers of #GstAudioMixer:blocksize samples. Each sink pad queues incoming
+ * buffers up to its "max-buffers" and "max-time" limits, so that every
+ * upstream thread can run ahead of the mixing by that much.
+ *
+ * When upstream is live, a buffer is output once the clock reaches its
+ * running time plus the latency, whether all sink pads have data for it or
+ * not. Pads without data at that point are mixed as silence, and data that
+ * arrives on them later than that is dropped. The duration of a block is
+ * added to the latency reported upstream, the "latency" property allows to
+ * give slow inputs more time.
+ *
+ * Only the first input decides the format and rate of the output, the other
+ * inputs can have any number of channels. They are remixed to the output
+ * channels with the #GstAudioMixerPad:mix-matrix of their pad, or a default
+ * matrix that maps them by position. Changes of the volume of a pad,
+ * including muting and unmuting it, are ramped at 10ms per unit of volume
+ * to avoid clicks.
  *
  * <refsect2>
  * <title>Example launch line</title>
@@ -39,38 +55,31 @@
  *
  */
 
+/* FIXME: suppress warnings for deprecated API such as GValueArray
+ * with newer GLib versions (>= 2.31.0)
+ *
+ * It is just not possible to switch to GArray yet because the python API in
+ * 1.2.0 still passes iterable properties as GValueArray */
+#define GLIB_DISABLE_DEPRECATION_WARNINGS
+
 #ifdef HAVE_CONFIG_H
 #include "config.h"
 #endif
 
 #include "gstaudiomixer.h"
 #include <gst/audio/audio.h>
+#include <math.h>
 #include <string.h>             /* strcmp */
 #include "gstaudiomixerorc.h"
 
 #define GST_CAT_DEFAULT gst_audiomixer_debug
 GST_DEBUG_CATEGORY_STATIC (GST_CAT_DEFAULT);
 
-typedef struct _GstAudioMixerCollect GstAudioMixerCollect;
-struct _GstAudioMixerCollect
-{
-  GstCollectData collect;       /* we extend the CollectData */
-
-  GstBuffer *buffer;            /* current buffer we're mixing,
-                                   for comparison with collect.buffer
-                                   to see if we need to update our
-                                   cached values. */
-  guint position, size;
-
-  guint64 output_offset;        /* Offset in output segment that
-                                   collect.pos refers to in the
-                                   current buffer. */
-
-  guint64 next_offset;          /* Next expected offset in the input segment */
-};
-
 #define DEFAULT_PAD_VOLUME (1.0)
 #define DEFAULT_PAD_MUTE (FALSE)
+/* queue up to 100ms of data on each pad, whatever the buffer size */
+#define DEFAULT_PAD_MAX_BUFFERS (0)
+#define DEFAULT_PAD_MAX_TIME (100 * GST_MSECOND)
 
 /* some defines for audio processing */
 /* the volume factor is a range from 0.0 to (arbitrary) VOLUME_MAX_DOUBLE = 10.0
@@ -85,14 +94,19 @@ struct _GstAudioMixerCollect
 #define VOLUME_UNITY_INT32           134217728  /* internal int for unity 2^(32-5) */
 #define VOLUME_UNITY_INT32_BIT_SHIFT 27
 
+/* volume changes, including muting and unmuting, are ramped over this time
+ * per unit of volume instead of being applied at once, to avoid clicks */
+#define VOLUME_RAMP_TIME (10 * GST_MSECOND)
+
 enum
 {
   PROP_PAD_0,
   PROP_PAD_VOLUME,
-  PROP_PAD_MUTE
+  PROP_PAD_MUTE,
+  PROP_PAD_MIX_MATRIX
 };
 
-G_DEFINE_TYPE (GstAudioMixerPad, gst_audiomixer_pad, GST_TYPE_PAD);
+G_DEFINE_TYPE (GstAudioMixerPad, gst_audiomixer_pad, GST_TYPE_AGGREGATOR_PAD);
 
 static void
 gst_audiomixer_pad_get_property (GObject * object, guint prop_id,
@@ -107,6 +121,23 @@ gst_audiomixer_pad_get_property (GObject * object, guint prop_id,
     case PROP_PAD_MUTE:
       g_value_set_boolean (value, pad->mute);
       break;
+    case PROP_PAD_MIX_MATRIX:{
+      GValueArray *array;
+      GValue v = { 0, };
+      guint i;
+
+      array = g_value_array_new (pad->mix_matrix_size);
+      g_value_init (&v, G_TYPE_FLOAT);
+      GST_OBJECT_LOCK (pad);
+      for (i = 0; i < pad->mix_matrix_size; i++) {
+        g_value_set_float (&v, pad->mix_matrix[i]);
+        g_value_array_append (array, &v);
+      }
+      GST_OBJECT_UNLOCK (pad);
+      g_value_unset (&v);
+      g_value_take_boxed (value, array);
+      break;
+    }
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -133,19 +164,72 @@ gst_audiomixer_pad_set_property (GObject * object, guint prop_id,
       pad->mute = g_value_get_boolean (value);
       GST_OBJECT_UNLOCK (pad);
       break;
+    case PROP_PAD_MIX_MATRIX:{
+      GValueArray *array = g_value_get_boxed (value);
+      guint i;
+
+      GST_OBJECT_LOCK (pad);
+      g_free (pad->mix_matrix);
+      pad->mix_matrix = NULL;
+      pad->mix_matrix_size = 0;
+      if (array && array->n_values > 0) {
+        pad->mix_matrix = g_new (gfloat, array->n_values);
+        pad->mix_matrix_size = array->n_values;
+        for (i = 0; i < array->n_values; i++)
+          pad->mix_matrix[i] =
+              g_value_get_float (g_value_array_get_nth (array, i));
+      }
+      pad->remix_dirty = TRUE;
+      GST_OBJECT_UNLOCK (pad);
+      break;
+    }
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
   }
 }
 
+static GstFlowReturn
+gst_audiomixer_pad_flush_pad (GstAggregatorPad * aggpad,
+    GstAggregator * aggregator)
+{
+  GstAudioMixerPad *pad = GST_AUDIO_MIXER_PAD (aggpad);
+
+  GST_OBJECT_LOCK (aggpad);
+  pad->position = pad->size = 0;
+  pad->output_offset = pad->next_offset = -1;
+  pad->ramp_volume = -1.0;
+  gst_buffer_replace (&pad->buffer, NULL);
+  GST_OBJECT_UNLOCK (aggpad);
+
+  return GST_FLOW_OK;
+}
+
+static void
+gst_audiomixer_pad_finalize (GObject * object)
+{
+  GstAudioMixerPad *pad = GST_AUDIO_MIXER_PAD (object);
+
+  gst_buffer_replace (&pad->buffer, NULL);
+  g_free (pad->mix_matrix);
+  g_free (pad->remix);
+  g_free (pad->remix_data);
+  g_free (pad->ramp_data);
+
+  G_OBJECT_CLASS (gst_audiomixer_pad_parent_class)->finalize (object);
+}
+
 static void
 gst_audiomixer_pad_class_init (GstAudioMixerPadClass * klass)
 {
   GObjectClass *gobject_class = (GObjectClass *) klass;
+  GstAggregatorPadClass *aggpadclass = (GstAggregatorPadClass *) klass;
 
   gobject_class->set_property = gst_audiomixer_pad_set_property;
   gobject_class->get_property = gst_audiomixer_pad_get_property;
+  gobject_class->finalize = gst_audiomixer_pad_finalize;
+
+  aggpadclass->flush = GST_DEBUG_FUNCPTR (gst_audiomixer_pad_flush_pad);
 
   g_object_class_install_property (gobject_class, PROP_PAD_VOLUME,
       g_param_spec_double ("volume", "Volume", "Volume of this pad",
@@ -155,6 +239,22 @@ gst_audiomixer_pad_class_init (GstAudioMixerPadClass * klass)
       g_param_spec_boolean ("mute", "Mute", "Mute this pad",
           DEFAULT_PAD_MUTE,
           G_PARAM_READWRITE | GST_PARAM_CONTROLLABLE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstAudioMixerPad:mix-matrix:
+   *
+   * Gains of the input channels in each output channel, as a flat array of
+   * output channels rows of input channels values. Empty for the default
+   * matrix, which maps matching positions, spreads mono to the front
+   * channels and downmixes to stereo or mono.
+   */
+  g_object_class_install_property (gobject_class, PROP_PAD_MIX_MATRIX,
+      g_param_spec_value_array ("mix-matrix", "Mix matrix",
+          "Row-major matrix of the gains of the input channels in the "
+          "output channels, empty for the default",
+          g_param_spec_float ("gain", "Gain",
+              "Gain of an input channel in an output channel", -10.0, 10.0,
+              0.0, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS),
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 }
 
 static void
@@ -162,6 +262,19 @@ gst_audiomixer_pad_init (GstAudioMixerPad * pad)
 {
   pad->volume = DEFAULT_PAD_VOLUME;
   pad->mute = DEFAULT_PAD_MUTE;
+
+  pad->buffer = NULL;
+  pad->position = 0;
+  pad->size = 0;
+  pad->output_offset = -1;
+  pad->next_offset = -1;
+
+  gst_audio_info_init (&pad->info);
+  pad->remix_dirty = TRUE;
+  pad->ramp_volume = -1.0;
+
+  g_object_set (pad, "max-buffers", DEFAULT_PAD_MAX_BUFFERS, "max-time",
+      DEFAULT_PAD_MAX_TIME, NULL);
 }
 
 #define DEFAULT_ALIGNMENT_THRESHOLD   (40 * GST_MSECOND)
@@ -207,7 +320,7 @@ static void gst_audiomixer_child_proxy_init (gpointer g_iface,
     gpointer iface_data);
 
 #define gst_audiomixer_parent_class parent_class
-G_DEFINE_TYPE_WITH_CODE (GstAudioMixer, gst_audiomixer, GST_TYPE_ELEMENT,
+G_DEFINE_TYPE_WITH_CODE (GstAudioMixer, gst_audiomixer, GST_TYPE_AGGREGATOR,
     G_IMPLEMENT_INTERFACE (GST_TYPE_CHILD_PROXY,
         gst_audiomixer_child_proxy_init));
 
@@ -219,27 +332,26 @@ static void gst_audiomixer_get_property (GObject * object, guint prop_id,
 
 static gboolean gst_audiomixer_setcaps (GstAudioMixer * audiomixer,
     GstPad * pad, GstCaps * caps);
-static gboolean gst_audiomixer_src_query (GstPad * pad, GstObject * parent,
+static gboolean gst_audiomixer_src_query (GstAggregator * agg,
     GstQuery * query);
-static gboolean gst_audiomixer_sink_query (GstCollectPads * pads,
-    GstCollectData * pad, GstQuery * query, gpointer user_data);
-static gboolean gst_audiomixer_src_event (GstPad * pad, GstObject * parent,
+static gboolean gst_audiomixer_sink_query (GstAggregator * agg,
+    GstAggregatorPad * aggpad, GstQuery * query);
+static gboolean gst_audiomixer_src_event (GstAggregator * agg,
     GstEvent * event);
-static gboolean gst_audiomixer_sink_event (GstCollectPads * pads,
-    GstCollectData * pad, GstEvent * event, gpointer user_data);
+static gboolean gst_audiomixer_sink_event (GstAggregator * agg,
+    GstAggregatorPad * aggpad, GstEvent * event);
 
 static GstPad *gst_audiomixer_request_new_pad (GstElement * element,
-    GstPadTemplate * temp, const gchar * unused, const GstCaps * caps);
+    GstPadTemplate * temp, const gchar * req_name, const GstCaps * caps);
 static void gst_audiomixer_release_pad (GstElement * element, GstPad * pad);
 
-static GstStateChangeReturn gst_audiomixer_change_state (GstElement * element,
-    GstStateChange transition);
+static gboolean gst_audiomixer_start (GstAggregator * agg);
+static gboolean gst_audiomixer_stop (GstAggregator * agg);
+static GstFlowReturn gst_audiomixer_flush (GstAggregator * agg);
 
-static GstFlowReturn gst_audiomixer_do_clip (GstCollectPads * pads,
-    GstCollectData * data, GstBuffer * buffer, GstBuffer ** out,
-    gpointer user_data);
-static GstFlowReturn gst_audiomixer_collected (GstCollectPads * pads,
-    gpointer user_data);
+static GstFlowReturn gst_audiomixer_do_clip (GstAggregator * agg,
+    GstAggregatorPad * bpad, GstBuffer * buffer, GstBuffer ** outbuf);
+static GstFlowReturn gst_audiomixer_aggregate (GstAggregator * agg);
 
 /* we can only accept caps that we and downstream can handle.
  * if we have filtercaps set, use those to constrain the target caps.
@@ -248,7 +360,7 @@ static GstCaps *
 gst_audiomixer_sink_getcaps (GstPad * pad, GstCaps * filter)
 {
   GstAudioMixer *audiomixer;
-  GstCaps *result, *peercaps, *current_caps, *filter_caps;
+  GstCaps *result, *peercaps, *current_caps, *filter_caps, *unpositioned;
   GstStructure *s;
   gint i, n;
 
@@ -274,7 +386,9 @@ gst_audiomixer_sink_getcaps (GstPad * pad, GstCaps * filter)
   }
 
   /* get the downstream possible caps */
-  peercaps = gst_pad_peer_query_caps (audiomixer->srcpad, filter_caps);
+  peercaps =
+      gst_pad_peer_query_caps (GST_AGGREGATOR (audiomixer)->srcpad,
+      filter_caps);
 
   /* get the allowed caps on this sinkpad */
   GST_OBJECT_LOCK (audiomixer);
@@ -327,6 +441,22 @@ gst_audiomixer_sink_getcaps (GstPad * pad, GstCaps * filter)
     gst_structure_free (sref);
   }
 
+  /* the inputs are remixed to the output channels, prefer the current ones
+   * but accept any */
+  unpositioned = gst_caps_copy (result);
+  n = gst_caps_get_size (unpositioned);
+  for (i = 0; i < n; i++)
+    gst_structure_remove_fields (gst_caps_get_structure (unpositioned, i),
+        "channels", "channel-mask", NULL);
+  if (filter) {
+    GstCaps *tmp = gst_caps_intersect_full (filter, unpositioned,
+        GST_CAPS_INTERSECT_FIRST);
+
+    gst_caps_unref (unpositioned);
+    unpositioned = tmp;
+  }
+  result = gst_caps_merge (result, unpositioned);
+
   if (filter_caps)
     gst_caps_unref (filter_caps);
 
@@ -337,8 +467,8 @@ gst_audiomixer_sink_getcaps (GstPad * pad, GstCaps * filter)
 }
 
 static gboolean
-gst_audiomixer_sink_query (GstCollectPads * pads, GstCollectData * pad,
-    GstQuery * query, gpointer user_data)
+gst_audiomixer_sink_query (GstAggregator * agg, GstAggregatorPad * aggpad,
+    GstQuery * query)
 {
   gboolean res = FALSE;
 
@@ -348,31 +478,113 @@ gst_audiomixer_sink_query (GstCollectPads * pads, GstCollectData * pad,
       GstCaps *filter, *caps;
 
       gst_query_parse_caps (query, &filter);
-      caps = gst_audiomixer_sink_getcaps (pad->pad, filter);
+      caps = gst_audiomixer_sink_getcaps (GST_PAD (aggpad), filter);
       gst_query_set_caps_result (query, caps);
       gst_caps_unref (caps);
       res = TRUE;
       break;
     }
     default:
-      res = gst_collect_pads_query_default (pads, pad, query, FALSE);
+      res =
+          GST_AGGREGATOR_CLASS (parent_class)->sink_query (agg, aggpad, query);
       break;
   }
 
   return res;
 }
 
+/* the output buffers can only be produced once all the data of their
+ * duration arrived, which adds a block of latency */
+static void
+gst_audiomixer_update_latency (GstAudioMixer * audiomixer)
+{
+  GstClockTime latency = 0;
+  gint rate;
+
+  GST_OBJECT_LOCK (audiomixer);
+  rate = GST_AUDIO_INFO_RATE (&audiomixer->info);
+  if (rate > 0)
+    latency =
+        gst_util_uint64_scale_int_ceil (audiomixer->blocksize, GST_SECOND,
+        rate);
+  GST_OBJECT_UNLOCK (audiomixer);
+
+  GST_DEBUG_OBJECT (audiomixer, "Latency of a block: %" GST_TIME_FORMAT,
+      GST_TIME_ARGS (latency));
+  gst_aggregator_set_latency (GST_AGGREGATOR (audiomixer), latency, latency);
+}
+
+/* Returns the output caps for the first input caps: those when downstream
+ * accepts their channels, or otherwise the input caps with the channels
+ * downstream prefers */
+static GstCaps *
+gst_audiomixer_get_src_caps (GstAudioMixer * audiomixer, GstCaps * caps)
+{
+  GstCaps *filter_caps, *peercaps, *result;
+  GstStructure *s;
+  gint channels;
+
+  GST_OBJECT_LOCK (audiomixer);
+  filter_caps =
+      audiomixer->filter_caps ? gst_caps_ref (audiomixer->filter_caps) : NULL;
+  GST_OBJECT_UNLOCK (audiomixer);
+
+  peercaps =
+      gst_pad_peer_query_caps (GST_AGGREGATOR (audiomixer)->srcpad,
+      filter_caps);
+  if (filter_caps)
+    gst_caps_unref (filter_caps);
+
+  if (peercaps == NULL || gst_caps_can_intersect (peercaps, caps)) {
+    if (peercaps)
+      gst_caps_unref (peercaps);
+    return gst_caps_ref (caps);
+  }
+
+  result = gst_caps_copy (caps);
+  gst_structure_remove_fields (gst_caps_get_structure (result, 0),
+      "channels", "channel-mask", NULL);
+  caps = gst_caps_intersect_full (peercaps, result, GST_CAPS_INTERSECT_FIRST);
+  gst_caps_unref (peercaps);
+  gst_caps_unref (result);
+  result = caps;
+
+  if (gst_caps_is_empty (result)) {
+    gst_caps_unref (result);
+    return NULL;
+  }
+
+  result = gst_caps_fixate (result);
+  s = gst_caps_get_structure (result, 0);
+  if (gst_structure_get_int (s, "channels", &channels)) {
+    if (channels <= 2)
+      gst_structure_remove_field (s, "channel-mask");
+    else if (!gst_structure_has_field (s, "channel-mask"))
+      gst_structure_set (s, "channel-mask", GST_TYPE_BITMASK, (guint64) 0,
+          NULL);
+  }
+
+  GST_DEBUG_OBJECT (audiomixer, "downstream does not accept the input "
+      "channels, remixing to %" GST_PTR_FORMAT, result);
+
+  return result;
+}
+
 /* the first caps we receive on any of the sinkpads will define the caps for all
- * the other sinkpads because we can only mix streams with the same caps.
+ * the other sinkpads because we can only mix streams with the same caps. Only
+ * the channels of the inputs can differ from the output, the inputs are
+ * remixed to them.
  */
 static gboolean
 gst_audiomixer_setcaps (GstAudioMixer * audiomixer, GstPad * pad,
     GstCaps * orig_caps)
 {
-  GstCaps *caps;
-  GstAudioInfo info;
+  GstAudioMixerPad *mixpad = GST_AUDIO_MIXER_PAD (pad);
+  GstCaps *caps, *src_caps;
+  GstAudioInfo info, src_info;
   GstStructure *s;
   gint channels;
+  gboolean changed = FALSE;
 
   caps = gst_caps_copy (orig_caps);
 
@@ -385,37 +597,60 @@ gst_audiomixer_setcaps (GstAudioMixer * audiomixer, GstPad * pad,
     goto invalid_format;
 
   GST_OBJECT_LOCK (audiomixer);
+  if (audiomixer->current_caps == NULL) {
+    GST_OBJECT_UNLOCK (audiomixer);
+
+    src_caps = gst_audiomixer_get_src_caps (audiomixer, caps);
+    if (src_caps == NULL || !gst_audio_info_from_caps (&src_info, src_caps)) {
+      if (src_caps)
+        gst_caps_unref (src_caps);
+      goto invalid_format;
+    }
+
+    GST_OBJECT_LOCK (audiomixer);
+    /* another sinkpad may have set them meanwhile */
+    if (audiomixer->current_caps == NULL) {
+      GST_INFO_OBJECT (pad, "setting caps to %" GST_PTR_FORMAT, src_caps);
+      gst_caps_replace (&audiomixer->current_caps, src_caps);
+      memcpy (&audiomixer->info, &src_info, sizeof (src_info));
+      audiomixer->send_caps = TRUE;
+      changed = TRUE;
+      /* send caps event later, after stream-start event */
+    }
+    gst_caps_unref (src_caps);
+  }
+
   /* don't allow reconfiguration for now; there's still a race between the
    * different upstream threads doing query_caps + accept_caps + sending
    * (possibly different) CAPS events, but there's not much we can do about
-   * that, upstream needs to deal with it. */
-  if (audiomixer->current_caps != NULL) {
-    if (gst_audio_info_is_equal (&info, &audiomixer->info)) {
-      GST_OBJECT_UNLOCK (audiomixer);
-      gst_caps_unref (caps);
-      return TRUE;
-    } else {
-      GST_DEBUG_OBJECT (pad, "got input caps %" GST_PTR_FORMAT ", but "
-          "current caps are %" GST_PTR_FORMAT, caps, audiomixer->current_caps);
-      GST_OBJECT_UNLOCK (audiomixer);
-      gst_pad_push_event (pad, gst_event_new_reconfigure ());
-      gst_caps_unref (caps);
-      return FALSE;
-    }
+   * that, upstream needs to deal with it. Non-interleaved inputs can't be
+   * remixed. */
+  if (GST_AUDIO_INFO_FORMAT (&info) != GST_AUDIO_INFO_FORMAT (&audiomixer->info)
+      || GST_AUDIO_INFO_RATE (&info) != GST_AUDIO_INFO_RATE (&audiomixer->info)
+      || info.layout != audiomixer->info.layout
+      || (info.layout == GST_AUDIO_LAYOUT_NON_INTERLEAVED
+          && !gst_audio_info_is_equal (&info, &audiomixer->info))) {
+    GST_DEBUG_OBJECT (pad, "got input caps %" GST_PTR_FORMAT ", but "
+        "current caps are %" GST_PTR_FORMAT, caps, audiomixer->current_caps);
+    GST_OBJECT_UNLOCK (audiomixer);
+    gst_pad_push_event (pad, gst_event_new_reconfigure ());
+    gst_caps_unref (caps);
+    return FALSE;
   }
-
-  GST_INFO_OBJECT (pad, "setting caps to %" GST_PTR_FORMAT, caps);
-  gst_caps_replace (&audiomixer->current_caps, caps);
-
-  memcpy (&audiomixer->info, &info, sizeof (info));
-  audiomixer->send_caps = TRUE;
   GST_OBJECT_UNLOCK (audiomixer);
-  /* send caps event later, after stream-start event */
 
   GST_INFO_OBJECT (pad, "handle caps change to %" GST_PTR_FORMAT, caps);
 
+  GST_OBJECT_LOCK (pad);
+  memcpy (&mixpad->info, &info, sizeof (info));
+  mixpad->remix_dirty = TRUE;
+  GST_OBJECT_UNLOCK (pad);
+
   gst_caps_unref (caps);
 
+  if (changed)
+    gst_audiomixer_update_latency (audiomixer);
+
   return TRUE;
 
   /* ERRORS */
@@ -515,94 +750,9 @@ gst_audiomixer_query_duration (GstAudioMixer * audiomixer, GstQuery * query)
 }
 
 static gboolean
-gst_audiomixer_query_latency (GstAudioMixer * audiomixer, GstQuery * query)
-{
-  GstClockTime min, max;
-  gboolean live;
-  gboolean res;
-  GstIterator *it;
-  gboolean done;
-  GValue item = { 0, };
-
-  res = TRUE;
-  done = FALSE;
-
-  live = FALSE;
-  min = 0;
-  max = GST_CLOCK_TIME_NONE;
-
-  /* Take maximum of all latency values */
-  it = gst_element_iterate_sink_pads (GST_ELEMENT_CAST (audiomixer));
-  while (!done) {
-    GstIteratorResult ires;
-
-    ires = gst_iterator_next (it, &item);
-    switch (ires) {
-      case GST_ITERATOR_DONE:
-        done = TRUE;
-        break;
-      case GST_ITERATOR_OK:
-      {
-        GstPad *pad = g_value_get_object (&item);
-        GstQuery *peerquery;
-        GstClockTime min_cur, max_cur;
-        gboolean live_cur;
-
-        peerquery = gst_query_new_latency ();
-
-        /* Ask peer for latency */
-        res &= gst_pad_peer_query (pad, peerquery);
-
-        /* take max from all valid return values */
-        if (res) {
-          gst_query_parse_latency (peerquery, &live_cur, &min_cur, &max_cur);
-
-          if (min_cur > min)
-            min = min_cur;
-
-          if (max_cur != GST_CLOCK_TIME_NONE &&
-              ((max != GST_CLOCK_TIME_NONE && max_cur > max) ||
-                  (max == GST_CLOCK_TIME_NONE)))
-            max = max_cur;
-
-          live = live || live_cur;
-        }
-
-        gst_query_unref (peerquery);
-        g_value_reset (&item);
-        break;
-      }
-      case GST_ITERATOR_RESYNC:
-        live = FALSE;
-        min = 0;
-        max = GST_CLOCK_TIME_NONE;
-        res = TRUE;
-        gst_iterator_resync (it);
-        break;
-      default:
-        res = FALSE;
-        done = TRUE;
-        break;
-    }
-  }
-  g_value_unset (&item);
-  gst_iterator_free (it);
-
-  if (res) {
-    /* store the results */
-    GST_DEBUG_OBJECT (audiomixer, "Calculated total latency: live %s, min %"
-        GST_TIME_FORMAT ", max %" GST_TIME_FORMAT,
-        (live ? "yes" : "no"), GST_TIME_ARGS (min), GST_TIME_ARGS (max));
-    gst_query_set_latency (query, live, min, max);
-  }
-
-  return res;
-}
-
-static gboolean
-gst_audiomixer_src_query (GstPad * pad, GstObject * parent, GstQuery * query)
+gst_audiomixer_src_query (GstAggregator * agg, GstQuery * query)
 {
-  GstAudioMixer *audiomixer = GST_AUDIO_MIXER (parent);
+  GstAudioMixer *audiomixer = GST_AUDIO_MIXER (agg);
   gboolean res = FALSE;
 
   switch (GST_QUERY_TYPE (query)) {
@@ -614,8 +764,9 @@ gst_audiomixer_src_query (GstPad * pad, GstObject * parent, GstQuery * query)
 
       switch (format) {
         case GST_FORMAT_TIME:
-          /* FIXME, bring to stream time, might be tricky */
-          gst_query_set_position (query, format, audiomixer->segment.position);
+          gst_query_set_position (query, format,
+              gst_segment_to_stream_time (&agg->segment, GST_FORMAT_TIME,
+                  agg->segment.position));
           res = TRUE;
           break;
         case GST_FORMAT_DEFAULT:
@@ -630,13 +781,10 @@ gst_audiomixer_src_query (GstPad * pad, GstObject * parent, GstQuery * query)
     case GST_QUERY_DURATION:
       res = gst_audiomixer_query_duration (audiomixer, query);
       break;
-    case GST_QUERY_LATENCY:
-      res = gst_audiomixer_query_latency (audiomixer, query);
-      break;
     default:
-      /* FIXME, needs a custom query handler because we have multiple
-       * sinkpads */
-      res = gst_pad_query_default (pad, parent, query);
+      /* latency is taken care of by the base class, which adds the duration
+       * of a block to the upstream latency */
+      res = GST_AGGREGATOR_CLASS (parent_class)->src_query (agg, query);
       break;
   }
 
@@ -645,247 +793,65 @@ gst_audiomixer_src_query (GstPad * pad, GstObject * parent, GstQuery * query)
 
 /* event handling */
 
-typedef struct
-{
-  GstEvent *event;
-  gboolean flush;
-} EventData;
-
-/* FIXME: What is this supposed to solve? */
-static gboolean
-forward_event_func (const GValue * val, GValue * ret, EventData * data)
-{
-  GstPad *pad = g_value_get_object (val);
-  GstEvent *event = data->event;
-  GstPad *peer;
-
-  gst_event_ref (event);
-  GST_LOG_OBJECT (pad, "About to send event %s", GST_EVENT_TYPE_NAME (event));
-  peer = gst_pad_get_peer (pad);
-  /* collect pad might have been set flushing,
-   * so bypass core checking that and send directly to peer */
-  if (!peer || !gst_pad_send_event (peer, event)) {
-    if (!peer)
-      gst_event_unref (event);
-    GST_WARNING_OBJECT (pad, "Sending event  %p (%s) failed.",
-        event, GST_EVENT_TYPE_NAME (event));
-    /* quick hack to unflush the pads, ideally we need a way to just unflush
-     * this single collect pad */
-    if (data->flush)
-      gst_pad_send_event (pad, gst_event_new_flush_stop (TRUE));
-  } else {
-    g_value_set_boolean (ret, TRUE);
-    GST_LOG_OBJECT (pad, "Sent event  %p (%s).",
-        event, GST_EVENT_TYPE_NAME (event));
-  }
-  if (peer)
-    gst_object_unref (peer);
-
-  /* continue on other pads, even if one failed */
-  return TRUE;
-}
-
-/* forwards the event to all sinkpads, takes ownership of the
- * event
- *
- * Returns: TRUE if the event could be forwarded on all
- * sinkpads.
- */
-static gboolean
-forward_event (GstAudioMixer * audiomixer, GstEvent * event, gboolean flush)
-{
-  gboolean ret;
-  GstIterator *it;
-  GstIteratorResult ires;
-  GValue vret = { 0 };
-  EventData data;
-
-  GST_LOG_OBJECT (audiomixer, "Forwarding event %p (%s)", event,
-      GST_EVENT_TYPE_NAME (event));
-
-  data.event = event;
-  data.flush = flush;
-
-  g_value_init (&vret, G_TYPE_BOOLEAN);
-  g_value_set_boolean (&vret, FALSE);
-  it = gst_element_iterate_sink_pads (GST_ELEMENT_CAST (audiomixer));
-  while (TRUE) {
-    ires =
-        gst_iterator_fold (it, (GstIteratorFoldFunction) forward_event_func,
-        &vret, &data);
-    switch (ires) {
-      case GST_ITERATOR_RESYNC:
-        GST_WARNING ("resync");
-        gst_iterator_resync (it);
-        g_value_set_boolean (&vret, TRUE);
-        break;
-      case GST_ITERATOR_OK:
-      case GST_ITERATOR_DONE:
-        ret = g_value_get_boolean (&vret);
-        goto done;
-      default:
-        ret = FALSE;
-        goto done;
-    }
-  }
-done:
-  gst_iterator_free (it);
-  GST_LOG_OBJECT (audiomixer, "Forwarded event %p (%s), ret=%d", event,
-      GST_EVENT_TYPE_NAME (event), ret);
-  gst_event_unref (event);
-
-  return ret;
-}
-
 static gboolean
-gst_audiomixer_src_event (GstPad * pad, GstObject * parent, GstEvent * event)
+gst_audiomixer_src_event (GstAggregator * agg, GstEvent * event)
 {
-  GstAudioMixer *audiomixer;
-  gboolean result;
-
-  audiomixer = GST_AUDIO_MIXER (parent);
+  GstAudioMixer *audiomixer = GST_AUDIO_MIXER (agg);
 
-  GST_DEBUG_OBJECT (pad, "Got %s event on src pad",
+  GST_DEBUG_OBJECT (agg->srcpad, "Got %s event on src pad",
       GST_EVENT_TYPE_NAME (event));
 
   switch (GST_EVENT_TYPE (event)) {
-      /* TODO: Update from videomixer */
     case GST_EVENT_SEEK:
     {
-      GstSeekFlags flags;
-      gdouble rate;
       GstSeekType start_type, stop_type;
-      gint64 start, stop;
-      GstFormat seek_format, dest_format;
-      gboolean flush;
+      GstFormat seek_format;
 
       /* parse the seek parameters */
-      gst_event_parse_seek (event, &rate, &seek_format, &flags, &start_type,
-          &start, &stop_type, &stop);
+      gst_event_parse_seek (event, NULL, &seek_format, NULL, &start_type,
+          NULL, &stop_type, NULL);
 
       if ((start_type != GST_SEEK_TYPE_NONE)
           && (start_type != GST_SEEK_TYPE_SET)) {
-        result = FALSE;
         GST_DEBUG_OBJECT (audiomixer,
             "seeking failed, unhandled seek type for start: %d", start_type);
-        goto done;
+        gst_event_unref (event);
+        return FALSE;
       }
       if ((stop_type != GST_SEEK_TYPE_NONE) && (stop_type != GST_SEEK_TYPE_SET)) {
-        result = FALSE;
         GST_DEBUG_OBJECT (audiomixer,
             "seeking failed, unhandled seek type for end: %d", stop_type);
-        goto done;
+        gst_event_unref (event);
+        return FALSE;
       }
 
-      dest_format = audiomixer->segment.format;
-      if (seek_format != dest_format) {
-        result = FALSE;
+      if (seek_format != agg->segment.format) {
         GST_DEBUG_OBJECT (audiomixer,
             "seeking failed, unhandled seek format: %d", seek_format);
-        goto done;
-      }
-
-      flush = (flags & GST_SEEK_FLAG_FLUSH) == GST_SEEK_FLAG_FLUSH;
-
-      /* check if we are flushing */
-      if (flush) {
-        /* flushing seek, start flush downstream, the flush will be done
-         * when all pads received a FLUSH_STOP.
-         * Make sure we accept nothing anymore and return WRONG_STATE.
-         * We send a flush-start before, to ensure no streaming is done
-         * as we need to take the stream lock.
-         */
-        gst_pad_push_event (audiomixer->srcpad, gst_event_new_flush_start ());
-        gst_collect_pads_set_flushing (audiomixer->collect, TRUE);
-
-        /* We can't send FLUSH_STOP here since upstream could start pushing data
-         * after we unlock audiomixer->collect.
-         * We set flush_stop_pending to TRUE instead and send FLUSH_STOP after
-         * forwarding the seek upstream or from gst_audiomixer_collected,
-         * whichever happens first.
-         */
-        GST_COLLECT_PADS_STREAM_LOCK (audiomixer->collect);
-        audiomixer->flush_stop_pending = TRUE;
-        GST_COLLECT_PADS_STREAM_UNLOCK (audiomixer->collect);
-        GST_DEBUG_OBJECT (audiomixer, "mark pending flush stop event");
-      }
-      GST_DEBUG_OBJECT (audiomixer, "handling seek event: %" GST_PTR_FORMAT,
-          event);
-
-      /* now wait for the collected to be finished and mark a new
-       * segment. After we have the lock, no collect function is running and no
-       * new collect function will be called for as long as we're flushing. */
-      GST_COLLECT_PADS_STREAM_LOCK (audiomixer->collect);
-      /* clip position and update our segment */
-      if (audiomixer->segment.stop != -1) {
-        audiomixer->segment.position = audiomixer->segment.stop;
-      }
-      gst_segment_do_seek (&audiomixer->segment, rate, seek_format, flags,
-          start_type, start, stop_type, stop, NULL);
-
-      if (flush) {
-        /* Yes, we need to call _set_flushing again *WHEN* the streaming threads
-         * have stopped so that the cookie gets properly updated. */
-        gst_collect_pads_set_flushing (audiomixer->collect, TRUE);
-      }
-      GST_COLLECT_PADS_STREAM_UNLOCK (audiomixer->collect);
-      GST_DEBUG_OBJECT (audiomixer, "forwarding seek event: %" GST_PTR_FORMAT,
-          event);
-      GST_DEBUG_OBJECT (audiomixer, "updated segment: %" GST_SEGMENT_FORMAT,
-          &audiomixer->segment);
-
-      /* we're forwarding seek to all upstream peers and wait for one to reply
-       * with a newsegment-event before we send a newsegment-event downstream */
-      g_atomic_int_set (&audiomixer->segment_pending, TRUE);
-      result = forward_event (audiomixer, event, flush);
-      /* FIXME: We should use the seek segment and forward that downstream next time
-       * not any upstream segment event */
-      if (!result) {
-        /* seek failed. maybe source is a live source. */
-        GST_DEBUG_OBJECT (audiomixer, "seeking failed");
-      }
-      if (g_atomic_int_compare_and_exchange (&audiomixer->flush_stop_pending,
-              TRUE, FALSE)) {
-        GST_DEBUG_OBJECT (audiomixer, "pending flush stop");
-        if (!gst_pad_push_event (audiomixer->srcpad,
-                gst_event_new_flush_stop (TRUE))) {
-          GST_WARNING_OBJECT (audiomixer, "Sending flush stop event failed");
-        }
+        gst_event_unref (event);
+        return FALSE;
       }
       break;
     }
     case GST_EVENT_QOS:
       /* QoS might be tricky */
-      result = FALSE;
       gst_event_unref (event);
-      break;
-    case GST_EVENT_NAVIGATION:
-      /* navigation is rather pointless. */
-      result = FALSE;
-      gst_event_unref (event);
-      break;
+      return FALSE;
     default:
-      /* just forward the rest for now */
-      GST_DEBUG_OBJECT (audiomixer, "forward unhandled event: %s",
-          GST_EVENT_TYPE_NAME (event));
-      result = forward_event (audiomixer, event, FALSE);
       break;
   }
 
-done:
-
-  return result;
+  return GST_AGGREGATOR_CLASS (parent_class)->src_event (agg, event);
 }
 
 static gboolean
-gst_audiomixer_sink_event (GstCollectPads * pads, GstCollectData * pad,
-    GstEvent * event, gpointer user_data)
+gst_audiomixer_sink_event (GstAggregator * agg, GstAggregatorPad * aggpad,
+    GstEvent * event)
 {
-  GstAudioMixer *audiomixer = GST_AUDIO_MIXER (user_data);
-  GstAudioMixerCollect *adata = (GstAudioMixerCollect *) pad;
-  gboolean res = TRUE, discard = FALSE;
+  GstAudioMixer *audiomixer = GST_AUDIO_MIXER (agg);
+  gboolean res = TRUE;
 
-  GST_DEBUG_OBJECT (pad->pad, "Got %s event on sink pad",
+  GST_DEBUG_OBJECT (aggpad, "Got %s event on sink pad",
       GST_EVENT_TYPE_NAME (event));
 
   switch (GST_EVENT_TYPE (event)) {
@@ -894,83 +860,38 @@ gst_audiomixer_sink_event (GstCollectPads * pads, GstCollectData * pad,
       GstCaps *caps;
 
       gst_event_parse_caps (event, &caps);
-      res = gst_audiomixer_setcaps (audiomixer, pad->pad, caps);
+      res = gst_audiomixer_setcaps (audiomixer, GST_PAD_CAST (aggpad), caps);
       gst_event_unref (event);
       event = NULL;
       break;
     }
-      /* FIXME: Who cares about flushes from upstream? We should
-       * not forward them at all */
-    case GST_EVENT_FLUSH_START:
-      /* ensure that we will send a flush stop */
-      GST_COLLECT_PADS_STREAM_LOCK (audiomixer->collect);
-      audiomixer->flush_stop_pending = TRUE;
-      res = gst_collect_pads_event_default (pads, pad, event, discard);
-      event = NULL;
-      GST_COLLECT_PADS_STREAM_UNLOCK (audiomixer->collect);
-      break;
-    case GST_EVENT_FLUSH_STOP:
-      /* we received a flush-stop. We will only forward it when
-       * flush_stop_pending is set, and we will unset it then.
-       */
-      g_atomic_int_set (&audiomixer->segment_pending, TRUE);
-      GST_COLLECT_PADS_STREAM_LOCK (audiomixer->collect);
-      if (audiomixer->flush_stop_pending) {
-        GST_DEBUG_OBJECT (pad->pad, "forwarding flush stop");
-        res = gst_collect_pads_event_default (pads, pad, event, discard);
-        audiomixer->flush_stop_pending = FALSE;
-        event = NULL;
-        gst_buffer_replace (&audiomixer->current_buffer, NULL);
-        audiomixer->discont_time = GST_CLOCK_TIME_NONE;
-      } else {
-        discard = TRUE;
-        GST_DEBUG_OBJECT (pad->pad, "eating flush stop");
-      }
-      GST_COLLECT_PADS_STREAM_UNLOCK (audiomixer->collect);
-      /* Clear pending tags */
-      if (audiomixer->pending_events) {
-        g_list_foreach (audiomixer->pending_events, (GFunc) gst_event_unref,
-            NULL);
-        g_list_free (audiomixer->pending_events);
-        audiomixer->pending_events = NULL;
-      }
-      adata->position = adata->size = 0;
-      adata->output_offset = adata->next_offset = -1;
-      gst_buffer_replace (&adata->buffer, NULL);
-      break;
-    case GST_EVENT_TAG:
-      /* collect tags here so we can push them out when we collect data */
-      audiomixer->pending_events =
-          g_list_append (audiomixer->pending_events, event);
-      event = NULL;
-      break;
     case GST_EVENT_SEGMENT:{
       const GstSegment *segment;
       gst_event_parse_segment (event, &segment);
-      if (segment->rate != audiomixer->segment.rate) {
-        GST_ERROR_OBJECT (pad->pad,
+      if (segment->rate != agg->segment.rate) {
+        GST_ERROR_OBJECT (aggpad,
             "Got segment event with wrong rate %lf, expected %lf",
-            segment->rate, audiomixer->segment.rate);
+            segment->rate, agg->segment.rate);
         res = FALSE;
         gst_event_unref (event);
         event = NULL;
       } else if (segment->rate < 0.0) {
-        GST_ERROR_OBJECT (pad->pad, "Negative rates not supported yet");
+        GST_ERROR_OBJECT (aggpad, "Negative rates not supported yet");
         res = FALSE;
         gst_event_unref (event);
         event = NULL;
       }
-      discard = TRUE;
       break;
     }
     default:
       break;
   }
 
-  if (G_LIKELY (event))
-    return gst_collect_pads_event_default (pads, pad, event, discard);
-  else
-    return res;
+  if (event != NULL)
+    return GST_AGGREGATOR_CLASS (parent_class)->sink_event (agg, aggpad,
+        event);
+
+  return res;
 }
 
 static void
@@ -978,6 +899,7 @@ gst_audiomixer_class_init (GstAudioMixerClass * klass)
 {
   GObjectClass *gobject_class = (GObjectClass *) klass;
   GstElementClass *gstelement_class = (GstElementClass *) klass;
+  GstAggregatorClass *agg_class = (GstAggregatorClass *) klass;
 
   gobject_class->set_property = gst_audiomixer_set_property;
   gobject_class->get_property = gst_audiomixer_get_property;
@@ -1021,45 +943,31 @@ gst_audiomixer_class_init (GstAudioMixerClass * klass)
       GST_DEBUG_FUNCPTR (gst_audiomixer_request_new_pad);
   gstelement_class->release_pad =
       GST_DEBUG_FUNCPTR (gst_audiomixer_release_pad);
-  gstelement_class->change_state =
-      GST_DEBUG_FUNCPTR (gst_audiomixer_change_state);
+
+  agg_class->sinkpads_type = GST_TYPE_AUDIO_MIXER_PAD;
+  agg_class->start = gst_audiomixer_start;
+  agg_class->stop = gst_audiomixer_stop;
+  agg_class->flush = gst_audiomixer_flush;
+  agg_class->clip = gst_audiomixer_do_clip;
+  agg_class->aggregate = GST_DEBUG_FUNCPTR (gst_audiomixer_aggregate);
+  agg_class->sink_event = GST_DEBUG_FUNCPTR (gst_audiomixer_sink_event);
+  agg_class->sink_query = GST_DEBUG_FUNCPTR (gst_audiomixer_sink_query);
+  agg_class->src_event = GST_DEBUG_FUNCPTR (gst_audiomixer_src_event);
+  agg_class->src_query = GST_DEBUG_FUNCPTR (gst_audiomixer_src_query);
 }
 
 static void
 gst_audiomixer_init (GstAudioMixer * audiomixer)
 {
-  GstPadTemplate *template;
-
-  template = gst_static_pad_template_get (&gst_audiomixer_src_template);
-  audiomixer->srcpad = gst_pad_new_from_template (template, "src");
-  gst_object_unref (template);
-
-  gst_pad_set_query_function (audiomixer->srcpad,
-      GST_DEBUG_FUNCPTR (gst_audiomixer_src_query));
-  gst_pad_set_event_function (audiomixer->srcpad,
-      GST_DEBUG_FUNCPTR (gst_audiomixer_src_event));
-  GST_PAD_SET_PROXY_CAPS (audiomixer->srcpad);
-  gst_element_add_pad (GST_ELEMENT (audiomixer), audiomixer->srcpad);
+  GST_PAD_SET_PROXY_CAPS (GST_AGGREGATOR (audiomixer)->srcpad);
 
   audiomixer->current_caps = NULL;
   gst_audio_info_init (&audiomixer->info);
-  audiomixer->padcount = 0;
 
   audiomixer->filter_caps = NULL;
   audiomixer->alignment_threshold = DEFAULT_ALIGNMENT_THRESHOLD;
   audiomixer->discont_wait = DEFAULT_DISCONT_WAIT;
   audiomixer->blocksize = DEFAULT_BLOCKSIZE;
-
-  /* keep track of the sinkpads requested */
-  audiomixer->collect = gst_collect_pads_new ();
-  gst_collect_pads_set_function (audiomixer->collect,
-      GST_DEBUG_FUNCPTR (gst_audiomixer_collected), audiomixer);
-  gst_collect_pads_set_clip_function (audiomixer->collect,
-      GST_DEBUG_FUNCPTR (gst_audiomixer_do_clip), audiomixer);
-  gst_collect_pads_set_event_function (audiomixer->collect,
-      GST_DEBUG_FUNCPTR (gst_audiomixer_sink_event), audiomixer);
-  gst_collect_pads_set_query_function (audiomixer->collect,
-      GST_DEBUG_FUNCPTR (gst_audiomixer_sink_query), audiomixer);
 }
 
 static void
@@ -1067,19 +975,9 @@ gst_audiomixer_dispose (GObject * object)
 {
   GstAudioMixer *audiomixer = GST_AUDIO_MIXER (object);
 
-  if (audiomixer->collect) {
-    gst_object_unref (audiomixer->collect);
-    audiomixer->collect = NULL;
-  }
   gst_caps_replace (&audiomixer->filter_caps, NULL);
   gst_caps_replace (&audiomixer->current_caps, NULL);
 
-  if (audiomixer->pending_events) {
-    g_list_foreach (audiomixer->pending_events, (GFunc) gst_event_unref, NULL);
-    g_list_free (audiomixer->pending_events);
-    audiomixer->pending_events = NULL;
-  }
-
   G_OBJECT_CLASS (parent_class)->dispose (object);
 }
 
@@ -1119,6 +1017,7 @@ gst_audiomixer_set_property (GObject * object, guint prop_id,
       break;
     case PROP_BLOCKSIZE:
       audiomixer->blocksize = g_value_get_uint (value);
+      gst_audiomixer_update_latency (audiomixer);
       break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
@@ -1153,154 +1052,118 @@ gst_audiomixer_get_property (GObject * object, guint prop_id, GValue * value,
   }
 }
 
-static void
-free_pad (GstCollectData * data)
-{
-  GstAudioMixerCollect *adata = (GstAudioMixerCollect *) data;
-
-  gst_buffer_replace (&adata->buffer, NULL);
-}
-
 static GstPad *
 gst_audiomixer_request_new_pad (GstElement * element, GstPadTemplate * templ,
-    const gchar * unused, const GstCaps * caps)
+    const gchar * req_name, const GstCaps * caps)
 {
-  gchar *name;
-  GstAudioMixer *audiomixer;
   GstPad *newpad;
-  gint padcount;
-  GstCollectData *cdata;
-  GstAudioMixerCollect *adata;
-
-  if (templ->direction != GST_PAD_SINK)
-    goto not_sink;
-
-  audiomixer = GST_AUDIO_MIXER (element);
-
-  /* increment pad counter */
-  padcount = g_atomic_int_add (&audiomixer->padcount, 1);
-
-  name = g_strdup_printf ("sink_%u", padcount);
-  newpad = g_object_new (GST_TYPE_AUDIO_MIXER_PAD, "name", name, "direction",
-      templ->direction, "template", templ, NULL);
-  GST_DEBUG_OBJECT (audiomixer, "request new pad %s", name);
-  g_free (name);
-
-  cdata =
-      gst_collect_pads_add_pad (audiomixer->collect, newpad,
-      sizeof (GstAudioMixerCollect), free_pad, TRUE);
-  adata = (GstAudioMixerCollect *) cdata;
-  adata->buffer = NULL;
-  adata->position = 0;
-  adata->size = 0;
-  adata->output_offset = -1;
-  adata->next_offset = -1;
-
-  /* takes ownership of the pad */
-  if (!gst_element_add_pad (GST_ELEMENT (audiomixer), newpad))
-    goto could_not_add;
-
-  gst_child_proxy_child_added (GST_CHILD_PROXY (audiomixer), G_OBJECT (newpad),
+
+  newpad =
+      GST_ELEMENT_CLASS (parent_class)->request_new_pad (element, templ,
+      req_name, caps);
+  if (newpad == NULL)
+    return NULL;
+
+  GST_DEBUG_OBJECT (element, "request new pad %s", GST_OBJECT_NAME (newpad));
+  gst_child_proxy_child_added (GST_CHILD_PROXY (element), G_OBJECT (newpad),
       GST_OBJECT_NAME (newpad));
 
   return newpad;
-
-  /* errors */
-not_sink:
-  {
-    g_warning ("gstaudiomixer: request new pad that is not a SINK pad\n");
-    return NULL;
-  }
-could_not_add:
-  {
-    GST_DEBUG_OBJECT (audiomixer, "could not add pad");
-    gst_collect_pads_remove_pad (audiomixer->collect, newpad);
-    gst_object_unref (newpad);
-    return NULL;
-  }
 }
 
 static void
 gst_audiomixer_release_pad (GstElement * element, GstPad * pad)
 {
-  GstAudioMixer *audiomixer;
+  GST_DEBUG_OBJECT (element, "release pad %s:%s", GST_DEBUG_PAD_NAME (pad));
 
-  audiomixer = GST_AUDIO_MIXER (element);
+  gst_child_proxy_child_removed (GST_CHILD_PROXY (element), G_OBJECT (pad),
+      GST_OBJECT_NAME (pad));
 
-  GST_DEBUG_OBJECT (audiomixer, "release pad %s:%s", GST_DEBUG_PAD_NAME (pad));
-
-  gst_child_proxy_child_removed (GST_CHILD_PROXY (audiomixer), G_OBJECT (pad),
-      GST_OBJECT_NAME (pad));
-  if (audiomixer->collect)
-    gst_collect_pads_remove_pad (audiomixer->collect, pad);
-  gst_element_remove_pad (element, pad);
-}
+  GST_ELEMENT_CLASS (parent_class)->release_pad (element, pad);
+}
 
 static GstFlowReturn
-gst_audiomixer_do_clip (GstCollectPads * pads, GstCollectData * data,
-    GstBuffer * buffer, GstBuffer ** out, gpointer user_data)
+gst_audiomixer_do_clip (GstAggregator * agg, GstAggregatorPad * bpad,
+    GstBuffer * buffer, GstBuffer ** outbuf)
 {
-  GstAudioMixer *audiomixer = GST_AUDIO_MIXER (user_data);
+  GstAudioMixerPad *pad = GST_AUDIO_MIXER_PAD (bpad);
   gint rate, bpf;
 
-  rate = GST_AUDIO_INFO_RATE (&audiomixer->info);
-  bpf = GST_AUDIO_INFO_BPF (&audiomixer->info);
+  GST_OBJECT_LOCK (pad);
+  rate = GST_AUDIO_INFO_RATE (&pad->info);
+  bpf = GST_AUDIO_INFO_BPF (&pad->info);
+  GST_OBJECT_UNLOCK (pad);
 
-  buffer = gst_audio_buffer_clip (buffer, &data->segment, rate, bpf);
+  buffer = gst_audio_buffer_clip (buffer, &bpad->segment, rate, bpf);
 
-  *out = buffer;
+  *outbuf = buffer;
   return GST_FLOW_OK;
 }
 
+/* Forgets the buffer being mixed and removes it from the queue of the pad,
+ * once it was mixed completely or when it is before the current offset */
+static void
+gst_audio_mixer_pad_drop_buffer (GstAudioMixerPad * pad)
+{
+  GstBuffer *buffer;
+
+  gst_buffer_replace (&pad->buffer, NULL);
+
+  buffer = gst_aggregator_pad_steal_buffer (GST_AGGREGATOR_PAD (pad));
+  if (buffer)
+    gst_buffer_unref (buffer);
+}
+
 static gboolean
-gst_audio_mixer_fill_buffer (GstAudioMixer * audiomixer, GstCollectPads * pads,
-    GstCollectData * collect_data, GstAudioMixerCollect * adata,
+gst_audio_mixer_fill_buffer (GstAudioMixer * audiomixer, GstAudioMixerPad * pad,
     GstBuffer * inbuf)
 {
+  GstAggregatorPad *aggpad = GST_AGGREGATOR_PAD (pad);
   GstClockTime start_time, end_time;
   gboolean discont = FALSE;
   guint64 start_offset, end_offset;
   GstClockTime timestamp, stream_time;
   gint rate, bpf;
 
-  g_assert (adata->buffer == NULL);
+  g_assert (pad->buffer == NULL);
 
+  /* positions are in frames of the input, which has the output rate */
   rate = GST_AUDIO_INFO_RATE (&audiomixer->info);
-  bpf = GST_AUDIO_INFO_BPF (&audiomixer->info);
+  bpf = GST_AUDIO_INFO_BPF (&pad->info);
 
   timestamp = GST_BUFFER_TIMESTAMP (inbuf);
   stream_time =
-      gst_segment_to_stream_time (&collect_data->segment, GST_FORMAT_TIME,
+      gst_segment_to_stream_time (&aggpad->segment, GST_FORMAT_TIME,
       timestamp);
 
   /* sync object properties on stream time */
   /* TODO: Ideally we would want to do that on every sample */
   if (GST_CLOCK_TIME_IS_VALID (stream_time))
-    gst_object_sync_values (GST_OBJECT (collect_data->pad), stream_time);
+    gst_object_sync_values (GST_OBJECT (pad), stream_time);
 
-  adata->position = 0;
-  adata->size = gst_buffer_get_size (inbuf);
+  pad->position = 0;
+  pad->size = gst_buffer_get_size (inbuf);
 
   start_time = GST_BUFFER_TIMESTAMP (inbuf);
   end_time =
-      start_time + gst_util_uint64_scale_ceil (adata->size / bpf,
+      start_time + gst_util_uint64_scale_ceil (pad->size / bpf,
       GST_SECOND, rate);
 
   start_offset = gst_util_uint64_scale (start_time, rate, GST_SECOND);
-  end_offset = start_offset + adata->size / bpf;
+  end_offset = start_offset + pad->size / bpf;
 
   if (GST_BUFFER_IS_DISCONT (inbuf)
       || GST_BUFFER_FLAG_IS_SET (inbuf, GST_BUFFER_FLAG_RESYNC)
-      || adata->next_offset == -1) {
+      || pad->next_offset == -1) {
     discont = TRUE;
   } else {
     guint64 diff, max_sample_diff;
 
     /* Check discont, based on audiobasesink */
-    if (start_offset <= adata->next_offset)
-      diff = adata->next_offset - start_offset;
+    if (start_offset <= pad->next_offset)
+      diff = pad->next_offset - start_offset;
     else
-      diff = start_offset - adata->next_offset;
+      diff = start_offset - pad->next_offset;
 
     max_sample_diff =
         gst_util_uint64_scale_int (audiomixer->alignment_threshold, rate,
@@ -1327,43 +1190,50 @@ gst_audio_mixer_fill_buffer (GstAudioMixer * audiomixer, GstCollectPads * pads,
 
   if (discont) {
     /* Have discont, need resync */
-    if (adata->next_offset != -1)
-      GST_INFO_OBJECT (collect_data->pad, "Have discont. Expected %"
+    if (pad->next_offset != -1)
+      GST_INFO_OBJECT (pad, "Have discont. Expected %"
           G_GUINT64_FORMAT ", got %" G_GUINT64_FORMAT,
-          adata->next_offset, start_offset);
-    adata->output_offset = -1;
+          pad->next_offset, start_offset);
+    pad->output_offset = -1;
   } else {
     audiomixer->discont_time = GST_CLOCK_TIME_NONE;
   }
 
-  adata->next_offset = end_offset;
+  pad->next_offset = end_offset;
 
-  if (adata->output_offset == -1) {
+  if (pad->output_offset != -1 && pad->output_offset < audiomixer->offset) {
+    /* The pad was left silent in blocks that were already pushed when it
+     * missed their deadline, resync to drop what belonged to them */
+    GST_DEBUG_OBJECT (pad, "Pad fell behind, resyncing");
+    pad->output_offset = -1;
+  }
+
+  if (pad->output_offset == -1) {
     GstClockTime start_running_time;
     GstClockTime end_running_time;
     guint64 start_running_time_offset;
     guint64 end_running_time_offset;
 
     start_running_time =
-        gst_segment_to_running_time (&collect_data->segment,
+        gst_segment_to_running_time (&aggpad->segment,
         GST_FORMAT_TIME, start_time);
     end_running_time =
-        gst_segment_to_running_time (&collect_data->segment,
+        gst_segment_to_running_time (&aggpad->segment,
         GST_FORMAT_TIME, end_time);
     start_running_time_offset =
         gst_util_uint64_scale (start_running_time, rate, GST_SECOND);
     end_running_time_offset =
         gst_util_uint64_scale (end_running_time, rate, GST_SECOND);
 
+    /* Also drops what arrives too late for the block it belongs to, which
+     * was already pushed with silence for this pad in live mode */
     if (end_running_time_offset < audiomixer->offset) {
       /* Before output segment, drop */
-      gst_buffer_unref (inbuf);
-      adata->buffer = NULL;
-      gst_buffer_unref (gst_collect_pads_pop (pads, collect_data));
-      adata->position = 0;
-      adata->size = 0;
-      adata->output_offset = -1;
-      GST_DEBUG_OBJECT (collect_data->pad,
+      gst_audio_mixer_pad_drop_buffer (pad);
+      pad->position = 0;
+      pad->size = 0;
+      pad->output_offset = -1;
+      GST_DEBUG_OBJECT (pad,
           "Buffer before segment or current position: %" G_GUINT64_FORMAT " < %"
           G_GUINT64_FORMAT, end_running_time_offset, audiomixer->offset);
       return FALSE;
@@ -1371,18 +1241,16 @@ gst_audio_mixer_fill_buffer (GstAudioMixer * audiomixer, GstCollectPads * pads,
 
     if (start_running_time_offset < audiomixer->offset) {
       guint diff = (audiomixer->offset - start_running_time_offset) * bpf;
-      adata->position += diff;
-      adata->size -= diff;
+      pad->position += diff;
+      pad->size -= diff;
       /* FIXME: This could only happen due to rounding errors */
-      if (adata->size == 0) {
+      if (pad->size == 0) {
         /* Empty buffer, drop */
-        gst_buffer_unref (inbuf);
-        adata->buffer = NULL;
-        gst_buffer_unref (gst_collect_pads_pop (pads, collect_data));
-        adata->position = 0;
-        adata->size = 0;
-        adata->output_offset = -1;
-        GST_DEBUG_OBJECT (collect_data->pad,
+        gst_audio_mixer_pad_drop_buffer (pad);
+        pad->position = 0;
+        pad->size = 0;
+        pad->output_offset = -1;
+        GST_DEBUG_OBJECT (pad,
             "Buffer before segment or current position: %" G_GUINT64_FORMAT
             " < %" G_GUINT64_FORMAT, end_running_time_offset,
             audiomixer->offset);
@@ -1390,119 +1258,475 @@ gst_audio_mixer_fill_buffer (GstAudioMixer * audiomixer, GstCollectPads * pads,
       }
     }
 
-    adata->output_offset = MAX (start_running_time_offset, audiomixer->offset);
-    GST_DEBUG_OBJECT (collect_data->pad,
+    pad->output_offset = MAX (start_running_time_offset, audiomixer->offset);
+    GST_DEBUG_OBJECT (pad,
         "Buffer resynced: Pad offset %" G_GUINT64_FORMAT
-        ", current mixer offset %" G_GUINT64_FORMAT, adata->output_offset,
+        ", current mixer offset %" G_GUINT64_FORMAT, pad->output_offset,
         audiomixer->offset);
   }
 
-  GST_LOG_OBJECT (collect_data->pad,
-      "Queued new buffer at offset %" G_GUINT64_FORMAT, adata->output_offset);
-  adata->buffer = inbuf;
+  GST_LOG_OBJECT (pad,
+      "Queued new buffer at offset %" G_GUINT64_FORMAT, pad->output_offset);
+  gst_buffer_replace (&pad->buffer, inbuf);
 
   return TRUE;
 }
 
+static gint
+gst_audio_mixer_find_position (const GstAudioInfo * info,
+    GstAudioChannelPosition position)
+{
+  gint i;
+
+  for (i = 0; i < GST_AUDIO_INFO_CHANNELS (info); i++)
+    if (info->position[i] == position)
+      return i;
+
+  return -1;
+}
+
+/* gain of the channels folded into the front ones by the default matrix */
+#define MINUS_3DB (1.0 / G_SQRT2)
+
+/* -1 for the channels on the left, 1 for those on the right and 0 for the
+ * centered ones */
+static gint
+gst_audio_mixer_position_side (GstAudioChannelPosition position)
+{
+  switch (position) {
+    case GST_AUDIO_CHANNEL_POSITION_FRONT_LEFT:
+    case GST_AUDIO_CHANNEL_POSITION_REAR_LEFT:
+    case GST_AUDIO_CHANNEL_POSITION_FRONT_LEFT_OF_CENTER:
+    case GST_AUDIO_CHANNEL_POSITION_SIDE_LEFT:
+    case GST_AUDIO_CHANNEL_POSITION_TOP_FRONT_LEFT:
+    case GST_AUDIO_CHANNEL_POSITION_TOP_REAR_LEFT:
+    case GST_AUDIO_CHANNEL_POSITION_TOP_SIDE_LEFT:
+    case GST_AUDIO_CHANNEL_POSITION_BOTTOM_FRONT_LEFT:
+    case GST_AUDIO_CHANNEL_POSITION_WIDE_LEFT:
+    case GST_AUDIO_CHANNEL_POSITION_SURROUND_LEFT:
+      return -1;
+    case GST_AUDIO_CHANNEL_POSITION_FRONT_RIGHT:
+    case GST_AUDIO_CHANNEL_POSITION_REAR_RIGHT:
+    case GST_AUDIO_CHANNEL_POSITION_FRONT_RIGHT_OF_CENTER:
+    case GST_AUDIO_CHANNEL_POSITION_SIDE_RIGHT:
+    case GST_AUDIO_CHANNEL_POSITION_TOP_FRONT_RIGHT:
+    case GST_AUDIO_CHANNEL_POSITION_TOP_REAR_RIGHT:
+    case GST_AUDIO_CHANNEL_POSITION_TOP_SIDE_RIGHT:
+    case GST_AUDIO_CHANNEL_POSITION_BOTTOM_FRONT_RIGHT:
+    case GST_AUDIO_CHANNEL_POSITION_WIDE_RIGHT:
+    case GST_AUDIO_CHANNEL_POSITION_SURROUND_RIGHT:
+      return 1;
+    default:
+      return 0;
+  }
+}
+
+/* Fills the zeroed row-major out_channels x in_channels @matrix: mono is
+ * played on the front center, or front left and right, everything is
+ * averaged into mono, and otherwise each input channel goes to the output
+ * channel at the same position, or is folded into the front channels of its
+ * side at -3dB. LFE channels are only kept if the output has them. */
 static void
-gst_audio_mixer_mix_buffer (GstAudioMixer * audiomixer, GstCollectPads * pads,
-    GstCollectData * collect_data, GstAudioMixerCollect * adata,
-    GstMapInfo * outmap)
+gst_audio_mixer_get_default_matrix (const GstAudioInfo * in_info,
+    const GstAudioInfo * out_info, gfloat * matrix)
 {
-  GstAudioMixerPad *pad = GST_AUDIO_MIXER_PAD (adata->collect.pad);
-  guint overlap;
-  guint out_start;
-  GstBuffer *inbuf;
-  GstMapInfo inmap;
-  gint bpf;
+  gint in_channels = GST_AUDIO_INFO_CHANNELS (in_info);
+  gint out_channels = GST_AUDIO_INFO_CHANNELS (out_info);
+  gint fl, fr, fc, i, o;
+
+  fl = gst_audio_mixer_find_position (out_info,
+      GST_AUDIO_CHANNEL_POSITION_FRONT_LEFT);
+  fr = gst_audio_mixer_find_position (out_info,
+      GST_AUDIO_CHANNEL_POSITION_FRONT_RIGHT);
+  fc = gst_audio_mixer_find_position (out_info,
+      GST_AUDIO_CHANNEL_POSITION_FRONT_CENTER);
+
+  if (in_channels == 1) {
+    if (fc != -1) {
+      matrix[fc] = 1.0;
+    } else if (fl != -1 && fr != -1) {
+      matrix[fl] = matrix[fr] = 1.0;
+    } else {
+      for (o = 0; o < out_channels; o++)
+        matrix[o] = 1.0;
+    }
+    return;
+  }
 
-  bpf = GST_AUDIO_INFO_BPF (&audiomixer->info);
+  if (out_channels == 1) {
+    for (i = 0; i < in_channels; i++)
+      matrix[i] = 1.0 / in_channels;
+    return;
+  }
 
-  /* Overlap => mix */
-  if (audiomixer->offset < adata->output_offset)
-    out_start = adata->output_offset - audiomixer->offset;
-  else
-    out_start = 0;
+  if (GST_AUDIO_INFO_IS_UNPOSITIONED (in_info)
+      || GST_AUDIO_INFO_IS_UNPOSITIONED (out_info)) {
+    for (i = 0; i < MIN (in_channels, out_channels); i++)
+      matrix[i * in_channels + i] = 1.0;
+    return;
+  }
 
-  overlap = adata->size / bpf - adata->position / bpf;
-  if (overlap > audiomixer->blocksize - out_start)
-    overlap = audiomixer->blocksize - out_start;
+  for (i = 0; i < in_channels; i++) {
+    GstAudioChannelPosition position = in_info->position[i];
+    gint side;
 
-  inbuf = gst_collect_pads_peek (pads, collect_data);
-  g_assert (inbuf != NULL && inbuf == adata->buffer);
+    o = gst_audio_mixer_find_position (out_info, position);
+    if (o != -1) {
+      matrix[o * in_channels + i] = 1.0;
+      continue;
+    }
 
-  GST_OBJECT_LOCK (pad);
-  if (pad->mute || pad->volume < G_MINDOUBLE) {
-    GST_DEBUG_OBJECT (pad, "Skipping muted pad");
-    gst_buffer_unref (inbuf);
-    adata->position += overlap * bpf;
-    adata->output_offset += overlap;
-    if (adata->position >= adata->size) {
-      /* Buffer done, drop it */
-      gst_buffer_replace (&adata->buffer, NULL);
-      gst_buffer_unref (gst_collect_pads_pop (pads, collect_data));
+    if (position == GST_AUDIO_CHANNEL_POSITION_LFE1
+        || position == GST_AUDIO_CHANNEL_POSITION_LFE2)
+      continue;
+
+    side = gst_audio_mixer_position_side (position);
+    if (side < 0 && fl != -1) {
+      matrix[fl * in_channels + i] = MINUS_3DB;
+    } else if (side > 0 && fr != -1) {
+      matrix[fr * in_channels + i] = MINUS_3DB;
+    } else if (side == 0 && fl != -1 && fr != -1) {
+      matrix[fl * in_channels + i] = MINUS_3DB;
+      matrix[fr * in_channels + i] = MINUS_3DB;
+    } else if (fc != -1) {
+      matrix[fc * in_channels + i] = MINUS_3DB;
     }
-    GST_OBJECT_UNLOCK (pad);
+  }
+}
+
+/* Must be called with the pad lock */
+static void
+gst_audio_mixer_pad_update_remix (GstAudioMixerPad * pad,
+    const GstAudioInfo * out_info)
+{
+  gint in_channels = GST_AUDIO_INFO_CHANNELS (&pad->info);
+  gint out_channels = GST_AUDIO_INFO_CHANNELS (out_info);
+
+  g_free (pad->remix);
+  pad->remix = NULL;
+  pad->remix_dirty = FALSE;
+
+  /* the caps of non-interleaved inputs always match the output */
+  if (pad->info.layout == GST_AUDIO_LAYOUT_NON_INTERLEAVED) {
+    if (pad->mix_matrix)
+      GST_WARNING_OBJECT (pad, "Can't remix non-interleaved audio");
     return;
   }
 
-  if (GST_BUFFER_FLAG_IS_SET (inbuf, GST_BUFFER_FLAG_GAP)) {
-    /* skip gap buffer */
-    GST_LOG_OBJECT (pad, "skipping GAP buffer");
-    gst_buffer_unref (inbuf);
-    adata->output_offset += adata->size / bpf;
-    /* Buffer done, drop it */
-    gst_buffer_replace (&adata->buffer, NULL);
-    gst_buffer_unref (gst_collect_pads_pop (pads, collect_data));
-    GST_OBJECT_UNLOCK (pad);
+  if (pad->mix_matrix) {
+    if (pad->mix_matrix_size == in_channels * out_channels) {
+      pad->remix = g_memdup (pad->mix_matrix,
+          pad->mix_matrix_size * sizeof (gfloat));
+      return;
+    }
+    GST_WARNING_OBJECT (pad, "mix-matrix has %u gains instead of %d x %d, "
+        "using the default one", pad->mix_matrix_size, out_channels,
+        in_channels);
+  }
+
+  if (in_channels == out_channels && memcmp (pad->info.position,
+          out_info->position,
+          in_channels * sizeof (GstAudioChannelPosition)) == 0)
     return;
+
+  pad->remix = g_new0 (gfloat, in_channels * out_channels);
+  gst_audio_mixer_get_default_matrix (&pad->info, out_info, pad->remix);
+}
+
+/* there are no strided or gather instructions in ORC to multiply frames of
+ * any number of channels by a matrix, so apart from the common cases below
+ * this is done in C */
+#define MAKE_REMIX_FUNC(name, type, acc_type, bias, min, max)               \
+static void                                                                 \
+gst_audio_mixer_remix_##name (const gfloat * matrix, gint in_channels,      \
+    gint out_channels, const type * in, type * out, guint n_frames)         \
+{                                                                           \
+  guint n;                                                                  \
+  gint i, o;                                                                \
+                                                                            \
+  for (n = 0; n < n_frames; n++) {                                          \
+    for (o = 0; o < out_channels; o++) {                                    \
+      const gfloat *gains = matrix + o * in_channels;                       \
+      acc_type acc = 0;                                                     \
+                                                                            \
+      for (i = 0; i < in_channels; i++)                                     \
+        acc += gains[i] * ((acc_type) in[i] - (bias));                      \
+      acc += (bias);                                                        \
+      out[o] = (type) CLAMP (acc, min, max);                                \
+    }                                                                       \
+    in += in_channels;                                                      \
+    out += out_channels;                                                    \
+  }                                                                         \
+}
+
+MAKE_REMIX_FUNC (u8, guint8, gfloat, 128, 0, G_MAXUINT8)
+MAKE_REMIX_FUNC (s8, gint8, gfloat, 0, G_MININT8, G_MAXINT8)
+MAKE_REMIX_FUNC (u16, guint16, gfloat, 32768, 0, G_MAXUINT16)
+MAKE_REMIX_FUNC (s16, gint16, gfloat, 0, G_MININT16, G_MAXINT16)
+MAKE_REMIX_FUNC (u32, guint32, gdouble, 2147483648.0, 0, G_MAXUINT32)
+MAKE_REMIX_FUNC (s32, gint32, gdouble, 0, G_MININT32, G_MAXINT32)
+MAKE_REMIX_FUNC (f32, gfloat, gfloat, 0, -G_MAXFLOAT, G_MAXFLOAT)
+MAKE_REMIX_FUNC (f64, gdouble, gdouble, 0, -G_MAXDOUBLE, G_MAXDOUBLE)
+
+/* Remixes mono to stereo, stereo to mono and 5.1 to stereo S16 and F32 with
+ * ORC. The 5.1 matrix has to treat both sides the same, like the default one
+ * does. Returns FALSE if the C functions have to be used. */
+static gboolean
+gst_audio_mixer_remix_orc (const gfloat * m, gint in_channels,
+    gint out_channels, GstAudioFormat format, const guint8 * in,
+    gpointer out, guint n_frames)
+{
+  if (format == GST_AUDIO_FORMAT_S16) {
+    if (in_channels == 1 && out_channels == 2) {
+      audiomixer_orc_remix_mono_stereo_s16 (out, (const gint16 *) in, m[0],
+          m[1], n_frames);
+      return TRUE;
+    }
+    if (in_channels == 2 && out_channels == 1) {
+      audiomixer_orc_remix_stereo_mono_s16 (out, (const gint16 *) in, m[0],
+          m[1], n_frames);
+      return TRUE;
+    }
+  } else if (format == GST_AUDIO_FORMAT_F32) {
+    if (in_channels == 1 && out_channels == 2) {
+      audiomixer_orc_remix_mono_stereo_f32 (out, (const gfloat *) in, m[0],
+          m[1], n_frames);
+      return TRUE;
+    }
+    if (in_channels == 2 && out_channels == 1) {
+      audiomixer_orc_remix_stereo_mono_f32 (out, (const gfloat *) in, m[0],
+          m[1], n_frames);
+      return TRUE;
+    }
+  } else {
+    return FALSE;
   }
 
-  gst_buffer_map (inbuf, &inmap, GST_MAP_READ);
-  GST_LOG_OBJECT (pad, "mixing %u bytes at offset %u from offset %u",
-      overlap * bpf, out_start * bpf, adata->position);
-  /* further buffers, need to add them */
+  /* the left output row is FL, 0, FC, LFE, RL, 0 and the right one
+   * 0, FR, FC, LFE, 0, RR with the same gains */
+  if (in_channels != 6 || out_channels != 2 || m[1] != 0.0 || m[5] != 0.0
+      || m[6] != 0.0 || m[10] != 0.0 || m[7] != m[0] || m[8] != m[2]
+      || m[9] != m[3] || m[11] != m[4])
+    return FALSE;
+
+  /* each frame is a line of the 2D programs, the sources are the channel
+   * pairs of the frame */
+  if (format == GST_AUDIO_FORMAT_S16) {
+    const gint16 *s = (const gint16 *) in;
+
+    audiomixer_orc_remix_5p1_stereo_s16 (out, 2 * sizeof (gint16), s,
+        6 * sizeof (gint16), s + 2, 6 * sizeof (gint16), s + 4,
+        6 * sizeof (gint16), m[0], m[2], m[3], m[4], 1, n_frames);
+  } else {
+    const gfloat *s = (const gfloat *) in;
+
+    audiomixer_orc_remix_5p1_stereo_f32 (out, 2 * sizeof (gfloat), s,
+        6 * sizeof (gfloat), s + 2, 6 * sizeof (gfloat), s + 4,
+        6 * sizeof (gfloat), m[0], m[2], m[3], m[4], 1, n_frames);
+  }
+  return TRUE;
+}
+
+/* Remixes @n_frames of the input to the output channels into remix_data,
+ * which is returned. Must be called with the pad lock. */
+static const guint8 *
+gst_audio_mixer_pad_remix (GstAudioMixer * audiomixer, GstAudioMixerPad * pad,
+    const guint8 * in, guint n_frames)
+{
+  gint in_channels = GST_AUDIO_INFO_CHANNELS (&pad->info);
+  gint out_channels = GST_AUDIO_INFO_CHANNELS (&audiomixer->info);
+  gsize size = n_frames * GST_AUDIO_INFO_BPF (&audiomixer->info);
+
+  if (pad->remix_data_size < size) {
+    g_free (pad->remix_data);
+    pad->remix_data = g_malloc (size);
+    pad->remix_data_size = size;
+  }
+
+  if (gst_audio_mixer_remix_orc (pad->remix, in_channels, out_channels,
+          GST_AUDIO_INFO_FORMAT (&audiomixer->info), in, pad->remix_data,
+          n_frames))
+    return pad->remix_data;
+
+  switch (GST_AUDIO_INFO_FORMAT (&audiomixer->info)) {
+    case GST_AUDIO_FORMAT_U8:
+      gst_audio_mixer_remix_u8 (pad->remix, in_channels, out_channels,
+          (const guint8 *) in, pad->remix_data, n_frames);
+      break;
+    case GST_AUDIO_FORMAT_S8:
+      gst_audio_mixer_remix_s8 (pad->remix, in_channels, out_channels,
+          (const gint8 *) in, pad->remix_data, n_frames);
+      break;
+    case GST_AUDIO_FORMAT_U16:
+      gst_audio_mixer_remix_u16 (pad->remix, in_channels, out_channels,
+          (const guint16 *) in, pad->remix_data, n_frames);
+      break;
+    case GST_AUDIO_FORMAT_S16:
+      gst_audio_mixer_remix_s16 (pad->remix, in_channels, out_channels,
+          (const gint16 *) in, pad->remix_data, n_frames);
+      break;
+    case GST_AUDIO_FORMAT_U32:
+      gst_audio_mixer_remix_u32 (pad->remix, in_channels, out_channels,
+          (const guint32 *) in, pad->remix_data, n_frames);
+      break;
+    case GST_AUDIO_FORMAT_S32:
+      gst_audio_mixer_remix_s32 (pad->remix, in_channels, out_channels,
+          (const gint32 *) in, pad->remix_data, n_frames);
+      break;
+    case GST_AUDIO_FORMAT_F32:
+      gst_audio_mixer_remix_f32 (pad->remix, in_channels, out_channels,
+          (const gfloat *) in, pad->remix_data, n_frames);
+      break;
+    case GST_AUDIO_FORMAT_F64:
+      gst_audio_mixer_remix_f64 (pad->remix, in_channels, out_channels,
+          (const gdouble *) in, pad->remix_data, n_frames);
+      break;
+    default:
+      g_assert_not_reached ();
+      break;
+  }
+
+  return pad->remix_data;
+}
+
+/* Gain of the @i-th frame of a ramp from @start towards @end */
+static inline gdouble
+gst_audio_mixer_ramp_gain (gdouble start, gdouble step, gdouble end, guint i)
+{
+  gdouble gain = start + step * i;
+
+  return step > 0 ? MIN (gain, end) : MAX (gain, end);
+}
+
+#define FILL_RAMP(type, unity) G_STMT_START {                               \
+  type *gains = pad->ramp_data;                                             \
+                                                                            \
+  for (i = 0; i < n; i++) {                                                 \
+    type gain = (type) (gst_audio_mixer_ramp_gain (start, step, volume,     \
+            i + 1) * (unity));                                              \
+                                                                            \
+    for (c = 0; c < channels; c++)                                          \
+      *gains++ = gain;                                                      \
+  }                                                                         \
+} G_STMT_END
+
+/* Mixes up to @n_frames frames while ramping the volume of the pad from
+ * where the last ramp stopped towards @volume, and returns the number of
+ * frames mixed. Must be called with the pad lock. */
+static guint
+gst_audio_mixer_add_ramp (GstAudioMixer * audiomixer, GstAudioMixerPad * pad,
+    guint8 * out, const guint8 * in, guint n_frames, gdouble volume)
+{
+  gint channels = GST_AUDIO_INFO_CHANNELS (&audiomixer->info);
+  gint width = GST_AUDIO_INFO_WIDTH (&audiomixer->info) / 8;
+  gdouble start = pad->ramp_volume;
+  gdouble step;
+  guint i, n, n_samples;
+  gint c;
+
+  step = (gdouble) GST_SECOND / ((gdouble) VOLUME_RAMP_TIME *
+      GST_AUDIO_INFO_RATE (&audiomixer->info));
+  n = (guint) ceil (fabs (volume - start) / step);
+  n = MIN (n, n_frames);
+  if (volume < start)
+    step = -step;
+  n_samples = n * channels;
+
+  if (pad->ramp_data_size < n_samples * width) {
+    g_free (pad->ramp_data);
+    pad->ramp_data_size = n_samples * width;
+    pad->ramp_data = g_malloc (pad->ramp_data_size);
+  }
+
+  GST_LOG_OBJECT (pad, "ramping volume from %f towards %f over %u frames",
+      start, volume, n);
+
+  switch (GST_AUDIO_INFO_FORMAT (&audiomixer->info)) {
+    case GST_AUDIO_FORMAT_U8:
+      FILL_RAMP (gint8, VOLUME_UNITY_INT8);
+      audiomixer_orc_add_volume_ramp_u8 ((gpointer) out, (gpointer) in,
+          pad->ramp_data, n_samples);
+      break;
+    case GST_AUDIO_FORMAT_S8:
+      FILL_RAMP (gint8, VOLUME_UNITY_INT8);
+      audiomixer_orc_add_volume_ramp_s8 ((gpointer) out, (gpointer) in,
+          pad->ramp_data, n_samples);
+      break;
+    case GST_AUDIO_FORMAT_U16:
+      FILL_RAMP (gint16, VOLUME_UNITY_INT16);
+      audiomixer_orc_add_volume_ramp_u16 ((gpointer) out, (gpointer) in,
+          pad->ramp_data, n_samples);
+      break;
+    case GST_AUDIO_FORMAT_S16:
+      FILL_RAMP (gint16, VOLUME_UNITY_INT16);
+      audiomixer_orc_add_volume_ramp_s16 ((gpointer) out, (gpointer) in,
+          pad->ramp_data, n_samples);
+      break;
+    case GST_AUDIO_FORMAT_U32:
+      FILL_RAMP (gint32, VOLUME_UNITY_INT32);
+      audiomixer_orc_add_volume_ramp_u32 ((gpointer) out, (gpointer) in,
+          pad->ramp_data, n_samples);
+      break;
+    case GST_AUDIO_FORMAT_S32:
+      FILL_RAMP (gint32, VOLUME_UNITY_INT32);
+      audiomixer_orc_add_volume_ramp_s32 ((gpointer) out, (gpointer) in,
+          pad->ramp_data, n_samples);
+      break;
+    case GST_AUDIO_FORMAT_F32:
+      FILL_RAMP (gfloat, 1.0);
+      audiomixer_orc_add_volume_ramp_f32 ((gpointer) out, (gpointer) in,
+          pad->ramp_data, n_samples);
+      break;
+    case GST_AUDIO_FORMAT_F64:
+      FILL_RAMP (gdouble, 1.0);
+      audiomixer_orc_add_volume_ramp_f64 ((gpointer) out, (gpointer) in,
+          pad->ramp_data, n_samples);
+      break;
+    default:
+      g_assert_not_reached ();
+      break;
+  }
+
+  pad->ramp_volume = gst_audio_mixer_ramp_gain (start, step, volume, n);
+
+  return n;
+}
+
+#undef FILL_RAMP
+
+/* Mixes @n_frames frames at the volume of the pad. Must be called with the
+ * pad lock. */
+static void
+gst_audio_mixer_add (GstAudioMixer * audiomixer, GstAudioMixerPad * pad,
+    guint8 * out, const guint8 * in, guint n_frames)
+{
+  guint n_samples = n_frames * GST_AUDIO_INFO_CHANNELS (&audiomixer->info);
+
   if (pad->volume == 1.0) {
     switch (audiomixer->info.finfo->format) {
       case GST_AUDIO_FORMAT_U8:
-        audiomixer_orc_add_u8 ((gpointer) (outmap->data + out_start * bpf),
-            (gpointer) (inmap.data + adata->position),
-            overlap * audiomixer->info.channels);
+        audiomixer_orc_add_u8 ((gpointer) out, (gpointer) in, n_samples);
         break;
       case GST_AUDIO_FORMAT_S8:
-        audiomixer_orc_add_s8 ((gpointer) (outmap->data + out_start * bpf),
-            (gpointer) (inmap.data + adata->position),
-            overlap * audiomixer->info.channels);
+        audiomixer_orc_add_s8 ((gpointer) out, (gpointer) in, n_samples);
         break;
       case GST_AUDIO_FORMAT_U16:
-        audiomixer_orc_add_u16 ((gpointer) (outmap->data + out_start * bpf),
-            (gpointer) (inmap.data + adata->position),
-            overlap * audiomixer->info.channels);
+        audiomixer_orc_add_u16 ((gpointer) out, (gpointer) in, n_samples);
         break;
       case GST_AUDIO_FORMAT_S16:
-        audiomixer_orc_add_s16 ((gpointer) (outmap->data + out_start * bpf),
-            (gpointer) (inmap.data + adata->position),
-            overlap * audiomixer->info.channels);
+        audiomixer_orc_add_s16 ((gpointer) out, (gpointer) in, n_samples);
         break;
       case GST_AUDIO_FORMAT_U32:
-        audiomixer_orc_add_u32 ((gpointer) (outmap->data + out_start * bpf),
-            (gpointer) (inmap.data + adata->position),
-            overlap * audiomixer->info.channels);
+        audiomixer_orc_add_u32 ((gpointer) out, (gpointer) in, n_samples);
         break;
       case GST_AUDIO_FORMAT_S32:
-        audiomixer_orc_add_s32 ((gpointer) (outmap->data + out_start * bpf),
-            (gpointer) (inmap.data + adata->position),
-            overlap * audiomixer->info.channels);
+        audiomixer_orc_add_s32 ((gpointer) out, (gpointer) in, n_samples);
         break;
       case GST_AUDIO_FORMAT_F32:
-        audiomixer_orc_add_f32 ((gpointer) (outmap->data + out_start * bpf),
-            (gpointer) (inmap.data + adata->position),
-            overlap * audiomixer->info.channels);
+        audiomixer_orc_add_f32 ((gpointer) out, (gpointer) in, n_samples);
         break;
       case GST_AUDIO_FORMAT_F64:
-        audiomixer_orc_add_f64 ((gpointer) (outmap->data + out_start * bpf),
-            (gpointer) (inmap.data + adata->position),
-            overlap * audiomixer->info.channels);
+        audiomixer_orc_add_f64 ((gpointer) out, (gpointer) in, n_samples);
         break;
       default:
         g_assert_not_reached ();
@@ -1511,60 +1735,130 @@ gst_audio_mixer_mix_buffer (GstAudioMixer * audiomixer, GstCollectPads * pads,
   } else {
     switch (audiomixer->info.finfo->format) {
       case GST_AUDIO_FORMAT_U8:
-        audiomixer_orc_add_volume_u8 ((gpointer) (outmap->data +
-                out_start * bpf), (gpointer) (inmap.data + adata->position),
-            pad->volume_i8, overlap * audiomixer->info.channels);
+        audiomixer_orc_add_volume_u8 ((gpointer) out, (gpointer) in,
+            pad->volume_i8, n_samples);
         break;
       case GST_AUDIO_FORMAT_S8:
-        audiomixer_orc_add_volume_s8 ((gpointer) (outmap->data +
-                out_start * bpf), (gpointer) (inmap.data + adata->position),
-            pad->volume_i8, overlap * audiomixer->info.channels);
+        audiomixer_orc_add_volume_s8 ((gpointer) out, (gpointer) in,
+            pad->volume_i8, n_samples);
         break;
       case GST_AUDIO_FORMAT_U16:
-        audiomixer_orc_add_volume_u16 ((gpointer) (outmap->data +
-                out_start * bpf), (gpointer) (inmap.data + adata->position),
-            pad->volume_i16, overlap * audiomixer->info.channels);
+        audiomixer_orc_add_volume_u16 ((gpointer) out, (gpointer) in,
+            pad->volume_i16, n_samples);
         break;
       case GST_AUDIO_FORMAT_S16:
-        audiomixer_orc_add_volume_s16 ((gpointer) (outmap->data +
-                out_start * bpf), (gpointer) (inmap.data + adata->position),
-            pad->volume_i16, overlap * audiomixer->info.channels);
+        audiomixer_orc_add_volume_s16 ((gpointer) out, (gpointer) in,
+            pad->volume_i16, n_samples);
         break;
       case GST_AUDIO_FORMAT_U32:
-        audiomixer_orc_add_volume_u32 ((gpointer) (outmap->data +
-                out_start * bpf), (gpointer) (inmap.data + adata->position),
-            pad->volume_i32, overlap * audiomixer->info.channels);
+        audiomixer_orc_add_volume_u32 ((gpointer) out, (gpointer) in,
+            pad->volume_i32, n_samples);
         break;
       case GST_AUDIO_FORMAT_S32:
-        audiomixer_orc_add_volume_s32 ((gpointer) (outmap->data +
-                out_start * bpf), (gpointer) (inmap.data + adata->position),
-            pad->volume_i32, overlap * audiomixer->info.channels);
+        audiomixer_orc_add_volume_s32 ((gpointer) out, (gpointer) in,
+            pad->volume_i32, n_samples);
         break;
       case GST_AUDIO_FORMAT_F32:
-        audiomixer_orc_add_volume_f32 ((gpointer) (outmap->data +
-                out_start * bpf), (gpointer) (inmap.data + adata->position),
-            pad->volume, overlap * audiomixer->info.channels);
+        audiomixer_orc_add_volume_f32 ((gpointer) out, (gpointer) in,
+            pad->volume, n_samples);
         break;
       case GST_AUDIO_FORMAT_F64:
-        audiomixer_orc_add_volume_f64 ((gpointer) (outmap->data +
-                out_start * bpf), (gpointer) (inmap.data + adata->position),
-            pad->volume, overlap * audiomixer->info.channels);
+        audiomixer_orc_add_volume_f64 ((gpointer) out, (gpointer) in,
+            pad->volume, n_samples);
         break;
       default:
         g_assert_not_reached ();
         break;
     }
   }
+}
+
+static void
+gst_audio_mixer_mix_buffer (GstAudioMixer * audiomixer, GstAudioMixerPad * pad,
+    GstMapInfo * outmap)
+{
+  guint overlap;
+  guint out_start;
+  GstBuffer *inbuf;
+  GstMapInfo inmap;
+  const guint8 *in;
+  guint8 *out;
+  gdouble volume;
+  guint n_ramp = 0;
+  gint bpf, in_bpf;
+
+  bpf = GST_AUDIO_INFO_BPF (&audiomixer->info);
+
+  GST_OBJECT_LOCK (pad);
+  in_bpf = GST_AUDIO_INFO_BPF (&pad->info);
+
+  /* Overlap => mix */
+  if (audiomixer->offset < pad->output_offset)
+    out_start = pad->output_offset - audiomixer->offset;
+  else
+    out_start = 0;
+
+  overlap = pad->size / in_bpf - pad->position / in_bpf;
+  if (overlap > audiomixer->blocksize - out_start)
+    overlap = audiomixer->blocksize - out_start;
+
+  inbuf = pad->buffer;
+  g_assert (inbuf != NULL);
+
+  volume = pad->mute ? 0.0 : pad->volume;
+  if (pad->ramp_volume < 0.0)
+    pad->ramp_volume = volume;
+
+  if (volume < G_MINDOUBLE && pad->ramp_volume < G_MINDOUBLE) {
+    GST_DEBUG_OBJECT (pad, "Skipping muted pad");
+    pad->position += overlap * in_bpf;
+    pad->output_offset += overlap;
+    if (pad->position >= pad->size) {
+      /* Buffer done, drop it */
+      gst_audio_mixer_pad_drop_buffer (pad);
+    }
+    GST_OBJECT_UNLOCK (pad);
+    return;
+  }
+
+  if (GST_BUFFER_FLAG_IS_SET (inbuf, GST_BUFFER_FLAG_GAP)) {
+    /* skip gap buffer, there is nothing to ramp from or to in it */
+    GST_LOG_OBJECT (pad, "skipping GAP buffer");
+    pad->ramp_volume = volume;
+    pad->output_offset += pad->size / in_bpf;
+    /* Buffer done, drop it */
+    gst_audio_mixer_pad_drop_buffer (pad);
+    GST_OBJECT_UNLOCK (pad);
+    return;
+  }
+
+  if (pad->remix_dirty)
+    gst_audio_mixer_pad_update_remix (pad, &audiomixer->info);
+
+  gst_buffer_map (inbuf, &inmap, GST_MAP_READ);
+  GST_LOG_OBJECT (pad, "mixing %u bytes at offset %u from offset %u",
+      overlap * bpf, out_start * bpf, pad->position);
+  in = inmap.data + pad->position;
+  out = outmap->data + out_start * bpf;
+
+  if (pad->remix)
+    in = gst_audio_mixer_pad_remix (audiomixer, pad, in, overlap);
+
+  /* further buffers, need to add them */
+  if (pad->ramp_volume != volume)
+    n_ramp = gst_audio_mixer_add_ramp (audiomixer, pad, out, in, overlap,
+        volume);
+  if (n_ramp < overlap && volume >= G_MINDOUBLE)
+    gst_audio_mixer_add (audiomixer, pad, out + n_ramp * bpf,
+        in + n_ramp * bpf, overlap - n_ramp);
   gst_buffer_unmap (inbuf, &inmap);
-  gst_buffer_unref (inbuf);
 
-  adata->position += overlap * bpf;
-  adata->output_offset += overlap;
+  pad->position += overlap * in_bpf;
+  pad->output_offset += overlap;
 
-  if (adata->position == adata->size) {
+  if (pad->position == pad->size) {
     /* Buffer done, drop it */
-    gst_buffer_replace (&adata->buffer, NULL);
-    gst_buffer_unref (gst_collect_pads_pop (pads, collect_data));
+    gst_audio_mixer_pad_drop_buffer (pad);
     GST_DEBUG_OBJECT (pad, "Finished mixing buffer, waiting for next");
   }
 
@@ -1572,16 +1866,13 @@ gst_audio_mixer_mix_buffer (GstAudioMixer * audiomixer, GstCollectPads * pads,
 }
 
 static GstFlowReturn
-gst_audiomixer_collected (GstCollectPads * pads, gpointer user_data)
+gst_audiomixer_aggregate (GstAggregator * agg)
 {
-  /* Get all pads that have data for us and store them in a
-   * new list.
-   *
-   * Calculate the current output offset/timestamp and
+  /* Calculate the current output offset/timestamp and
    * offset_end/timestamp_end. Allocate a silence buffer
    * for this and store it.
    *
-   * For all pads:
+   * For all pads, and all the buffers queued on them:
    * 1) Once per input buffer (cached)
    *   1) Check discont (flag and timestamp with tolerance)
    *   2) If discont or new, resync. That means:
@@ -1599,133 +1890,80 @@ gst_audiomixer_collected (GstCollectPads * pads, gpointer user_data)
    * 3) If we had no pad with a buffer, go EOS.
    *
    * 4) If we had at least one pad that did not advance behind output
-   *    offset_end, let collected be called again for the current
-   *    output offset/offset_end.
+   *    offset_end, let aggregate be called again for the current
+   *    output offset/offset_end, unless that pad missed the deadline of
+   *    the block in live mode, in which case it is left silent.
    */
   GstAudioMixer *audiomixer;
-  GSList *collected;
+  GList *l;
   GstFlowReturn ret;
   GstBuffer *outbuf = NULL;
   GstMapInfo outmap;
   gint64 next_offset;
   gint64 next_timestamp;
   gint rate, bpf;
-  gboolean dropped = FALSE;
   gboolean is_eos = TRUE;
   gboolean is_done = TRUE;
+  gboolean timeout = FALSE;
 
-  audiomixer = GST_AUDIO_MIXER (user_data);
-
-  /* this is fatal */
-  if (G_UNLIKELY (audiomixer->info.finfo->format == GST_AUDIO_FORMAT_UNKNOWN))
-    goto not_negotiated;
+  audiomixer = GST_AUDIO_MIXER (agg);
 
-  if (audiomixer->flush_stop_pending == TRUE) {
-    GST_INFO_OBJECT (audiomixer->srcpad, "send pending flush stop event");
-    if (!gst_pad_push_event (audiomixer->srcpad,
-            gst_event_new_flush_stop (TRUE))) {
-      GST_WARNING_OBJECT (audiomixer->srcpad,
-          "Sending flush stop event failed");
-    }
+  if (G_UNLIKELY (audiomixer->info.finfo->format == GST_AUDIO_FORMAT_UNKNOWN)) {
+    gboolean have_data = FALSE;
 
-    audiomixer->flush_stop_pending = FALSE;
-    gst_buffer_replace (&audiomixer->current_buffer, NULL);
-    audiomixer->discont_time = GST_CLOCK_TIME_NONE;
-  }
+    /* Only fatal if data arrived without caps, this is also called when all
+     * pads went EOS or on the live deadline before anything was received */
+    GST_OBJECT_LOCK (agg);
+    for (l = GST_ELEMENT (agg)->sinkpads; l; l = l->next) {
+      GstAggregatorPad *aggpad = l->data;
 
-  if (audiomixer->send_stream_start) {
-    gchar s_id[32];
-    GstEvent *event;
+      if (aggpad->buffer)
+        have_data = TRUE;
+      if (!aggpad->eos)
+        is_eos = FALSE;
+    }
+    GST_OBJECT_UNLOCK (agg);
 
-    GST_INFO_OBJECT (audiomixer->srcpad, "send pending stream start event");
-    /* FIXME: create id based on input ids, we can't use 
-     * gst_pad_create_stream_id() though as that only handles 0..1 sink-pad
-     */
-    g_snprintf (s_id, sizeof (s_id), "audiomixer-%08x", g_random_int ());
-    event = gst_event_new_stream_start (s_id);
-    gst_event_set_group_id (event, gst_util_group_id_next ());
+    if (have_data)
+      goto not_negotiated;
 
-    if (!gst_pad_push_event (audiomixer->srcpad, event)) {
-      GST_WARNING_OBJECT (audiomixer->srcpad,
-          "Sending stream start event failed");
-    }
-    audiomixer->send_stream_start = FALSE;
+    return is_eos ? GST_FLOW_EOS : GST_FLOW_OK;
   }
 
   if (audiomixer->send_caps) {
-    GstEvent *caps_event;
-
-    caps_event = gst_event_new_caps (audiomixer->current_caps);
-    GST_INFO_OBJECT (audiomixer->srcpad,
-        "send pending caps event %" GST_PTR_FORMAT, caps_event);
-    if (!gst_pad_push_event (audiomixer->srcpad, caps_event)) {
-      GST_WARNING_OBJECT (audiomixer->srcpad, "Sending caps event failed");
-    }
+    gst_aggregator_set_src_caps (agg, audiomixer->current_caps);
     audiomixer->send_caps = FALSE;
   }
 
   rate = GST_AUDIO_INFO_RATE (&audiomixer->info);
   bpf = GST_AUDIO_INFO_BPF (&audiomixer->info);
 
-  if (g_atomic_int_compare_and_exchange (&audiomixer->segment_pending, TRUE,
-          FALSE)) {
-    GstEvent *event;
-
+  if (audiomixer->offset == -1) {
     /* 
-     * When seeking we set the start and stop positions as given in the seek
-     * event. We also adjust offset & timestamp accordingly.
-     * This basically ignores all newsegments sent by upstream.
+     * After a seek the output starts at the start position given in the
+     * seek event, as set on our segment by the base class.
      *
      * FIXME: We require that all inputs have the same rate currently
      * as we do no rate conversion!
      */
-    event = gst_event_new_segment (&audiomixer->segment);
-    if (audiomixer->segment.rate > 0.0) {
-      audiomixer->segment.position = audiomixer->segment.start;
-    } else {
-      audiomixer->segment.position = audiomixer->segment.stop;
-    }
-    audiomixer->offset = gst_util_uint64_scale (audiomixer->segment.position,
-        rate, GST_SECOND);
-
-    GST_INFO_OBJECT (audiomixer->srcpad, "sending pending new segment event %"
-        GST_SEGMENT_FORMAT, &audiomixer->segment);
-    if (event) {
-      if (!gst_pad_push_event (audiomixer->srcpad, event)) {
-        GST_WARNING_OBJECT (audiomixer->srcpad,
-            "Sending new segment event failed");
-      }
-    } else {
-      GST_WARNING_OBJECT (audiomixer->srcpad, "Creating new segment event for "
-          "start:%" G_GINT64_FORMAT "  end:%" G_GINT64_FORMAT " failed",
-          audiomixer->segment.start, audiomixer->segment.stop);
-    }
-  }
+    if (!GST_CLOCK_TIME_IS_VALID (agg->segment.position)
+        || agg->segment.position < agg->segment.start)
+      agg->segment.position = agg->segment.start;
 
-  if (G_UNLIKELY (audiomixer->pending_events)) {
-    GList *tmp = audiomixer->pending_events;
+    audiomixer->offset =
+        gst_util_uint64_scale (gst_segment_to_running_time (&agg->segment,
+            GST_FORMAT_TIME, agg->segment.position), rate, GST_SECOND);
 
-    while (tmp) {
-      GstEvent *ev = (GstEvent *) tmp->data;
-
-      gst_pad_push_event (audiomixer->srcpad, ev);
-      tmp = g_list_next (tmp);
-    }
-    g_list_free (audiomixer->pending_events);
-    audiomixer->pending_events = NULL;
+    GST_DEBUG_OBJECT (audiomixer, "Starting at offset %" G_GINT64_FORMAT,
+        audiomixer->offset);
   }
 
   /* for the next timestamp, use the sample counter, which will
    * never accumulate rounding errors */
-
-  /* FIXME: Reverse mixing does not work at all yet */
-  if (audiomixer->segment.rate > 0.0) {
-    next_offset = audiomixer->offset + audiomixer->blocksize;
-  } else {
-    next_offset = audiomixer->offset - audiomixer->blocksize;
-  }
-
-  next_timestamp = gst_util_uint64_scale (next_offset, GST_SECOND, rate);
+  next_offset = audiomixer->offset + audiomixer->blocksize;
+  next_timestamp =
+      gst_segment_to_position (&agg->segment, GST_FORMAT_TIME,
+      gst_util_uint64_scale (next_offset, GST_SECOND, rate));
 
   if (audiomixer->current_buffer) {
     outbuf = audiomixer->current_buffer;
@@ -1741,69 +1979,58 @@ gst_audiomixer_collected (GstCollectPads * pads, gpointer user_data)
   GST_LOG_OBJECT (audiomixer,
       "Starting to mix %u samples for offset %" G_GUINT64_FORMAT
       " with timestamp %" GST_TIME_FORMAT, audiomixer->blocksize,
-      audiomixer->offset, GST_TIME_ARGS (audiomixer->segment.position));
+      audiomixer->offset, GST_TIME_ARGS (agg->segment.position));
 
   gst_buffer_map (outbuf, &outmap, GST_MAP_READWRITE);
 
-  for (collected = pads->data; collected; collected = collected->next) {
-    GstCollectData *collect_data;
-    GstAudioMixerCollect *adata;
+  GST_OBJECT_LOCK (agg);
+  for (l = GST_ELEMENT (agg)->sinkpads; l; l = l->next) {
+    GstAggregatorPad *aggpad = l->data;
+    GstAudioMixerPad *pad = l->data;
     GstBuffer *inbuf;
 
-    collect_data = (GstCollectData *) collected->data;
-    adata = (GstAudioMixerCollect *) collect_data;
-
-    inbuf = gst_collect_pads_peek (pads, collect_data);
-    if (!inbuf)
-      continue;
-
-    /* New buffer? */
-    if (!adata->buffer || adata->buffer != inbuf) {
-      /* Takes ownership of buffer */
-      if (!gst_audio_mixer_fill_buffer (audiomixer, pads, collect_data, adata,
-              inbuf)) {
-        dropped = TRUE;
+    /* Mix everything queued on the pad up to the end of the block */
+    while ((inbuf = gst_aggregator_pad_get_buffer (aggpad))) {
+      /* New buffer? */
+      if (pad->buffer != inbuf
+          && !gst_audio_mixer_fill_buffer (audiomixer, pad, inbuf)) {
+        /* Dropped, try the next one */
+        gst_buffer_unref (inbuf);
         continue;
       }
-    } else {
       gst_buffer_unref (inbuf);
+
+      /* At this point pad->output_offset >= audiomixer->offset */
+      if (pad->output_offset >= next_offset)
+        break;
+
+      GST_LOG_OBJECT (pad, "Mixing buffer for current offset");
+      gst_audio_mixer_mix_buffer (audiomixer, pad, &outmap);
+      if (pad->output_offset >= next_offset)
+        break;
     }
 
-    if (!adata->buffer && !dropped
-        && GST_COLLECT_PADS_STATE_IS_SET (&adata->collect,
-            GST_COLLECT_PADS_STATE_EOS)) {
-      GST_DEBUG_OBJECT (collect_data->pad, "Pad is in EOS state");
+    if (pad->buffer) {
+      GST_DEBUG_OBJECT (pad,
+          "Pad is after current offset: %" G_GUINT64_FORMAT " >= %"
+          G_GUINT64_FORMAT, pad->output_offset, next_offset);
+      is_eos = FALSE;
+    } else if (aggpad->eos) {
+      GST_DEBUG_OBJECT (pad, "Pad is in EOS state");
+    } else if (gst_aggregator_pad_is_late (aggpad)) {
+      GST_DEBUG_OBJECT (pad, "Pad missed the deadline, leaving it silent");
+      timeout = TRUE;
+      is_eos = FALSE;
     } else {
+      is_done = FALSE;
       is_eos = FALSE;
     }
-
-    /* At this point adata->output_offset >= audiomixer->offset or we have no buffer anymore */
-    if (adata->output_offset >= audiomixer->offset
-        && adata->output_offset <
-        audiomixer->offset + audiomixer->blocksize && adata->buffer) {
-      GST_LOG_OBJECT (collect_data->pad, "Mixing buffer for current offset");
-      gst_audio_mixer_mix_buffer (audiomixer, pads, collect_data, adata,
-          &outmap);
-      if (adata->output_offset >= next_offset) {
-        GST_DEBUG_OBJECT (collect_data->pad,
-            "Pad is after current offset: %" G_GUINT64_FORMAT " >= %"
-            G_GUINT64_FORMAT, adata->output_offset, next_offset);
-      } else {
-        is_done = FALSE;
-      }
-    }
   }
+  GST_OBJECT_UNLOCK (agg);
 
   gst_buffer_unmap (outbuf, &outmap);
 
-  if (dropped) {
-    /* We dropped a buffer, retry */
-    GST_DEBUG_OBJECT (audiomixer,
-        "A pad dropped a buffer, wait for the next one");
-    return GST_FLOW_OK;
-  }
-
-  if (!is_done && !is_eos) {
+  if (!is_done && !is_eos && !timeout) {
     /* Get more buffers */
     GST_DEBUG_OBJECT (audiomixer,
         "We're not done yet for the current offset," " waiting for more data");
@@ -1816,23 +2043,23 @@ gst_audiomixer_collected (GstCollectPads * pads, gpointer user_data)
 
     GST_DEBUG_OBJECT (audiomixer, "We're EOS");
 
+    GST_OBJECT_LOCK (agg);
+    for (l = GST_ELEMENT (agg)->sinkpads; l; l = l->next) {
+      GstAudioMixerPad *pad = l->data;
 
-    for (collected = pads->data; collected; collected = collected->next) {
-      GstCollectData *collect_data;
-      GstAudioMixerCollect *adata;
-
-      collect_data = (GstCollectData *) collected->data;
-      adata = (GstAudioMixerCollect *) collect_data;
+      if (pad->output_offset == -1)
+        continue;
 
-      max_offset = MAX (max_offset, adata->output_offset);
-      if (adata->output_offset > audiomixer->offset)
+      max_offset = MAX (max_offset, pad->output_offset);
+      if (pad->output_offset > audiomixer->offset)
         empty_buffer = FALSE;
     }
+    GST_OBJECT_UNLOCK (agg);
 
     /* This means EOS or no pads at all */
     if (empty_buffer) {
       gst_buffer_replace (&audiomixer->current_buffer, NULL);
-      goto eos;
+      return GST_FLOW_EOS;
     }
 
     if (max_offset <= next_offset) {
@@ -1842,27 +2069,20 @@ gst_audiomixer_collected (GstCollectPads * pads, gpointer user_data)
       next_offset = max_offset;
 
       gst_buffer_resize (outbuf, 0, (next_offset - audiomixer->offset) * bpf);
-      next_timestamp = gst_util_uint64_scale (next_offset, GST_SECOND, rate);
+      next_timestamp =
+          gst_segment_to_position (&agg->segment, GST_FORMAT_TIME,
+          gst_util_uint64_scale (next_offset, GST_SECOND, rate));
     }
   }
 
   /* set timestamps on the output buffer */
-  if (audiomixer->segment.rate > 0.0) {
-    GST_BUFFER_TIMESTAMP (outbuf) = audiomixer->segment.position;
-    GST_BUFFER_OFFSET (outbuf) = audiomixer->offset;
-    GST_BUFFER_OFFSET_END (outbuf) = next_offset;
-    GST_BUFFER_DURATION (outbuf) =
-        next_timestamp - audiomixer->segment.position;
-  } else {
-    GST_BUFFER_TIMESTAMP (outbuf) = next_timestamp;
-    GST_BUFFER_OFFSET (outbuf) = next_offset;
-    GST_BUFFER_OFFSET_END (outbuf) = audiomixer->offset;
-    GST_BUFFER_DURATION (outbuf) =
-        audiomixer->segment.position - next_timestamp;
-  }
+  GST_BUFFER_TIMESTAMP (outbuf) = agg->segment.position;
+  GST_BUFFER_OFFSET (outbuf) = audiomixer->offset;
+  GST_BUFFER_OFFSET_END (outbuf) = next_offset;
+  GST_BUFFER_DURATION (outbuf) = next_timestamp - agg->segment.position;
 
   audiomixer->offset = next_offset;
-  audiomixer->segment.position = next_timestamp;
+  agg->segment.position = next_timestamp;
 
   /* send it out */
   GST_LOG_OBJECT (audiomixer,
@@ -1870,14 +2090,14 @@ gst_audiomixer_collected (GstCollectPads * pads, gpointer user_data)
       G_GINT64_FORMAT, outbuf, GST_TIME_ARGS (GST_BUFFER_TIMESTAMP (outbuf)),
       GST_BUFFER_OFFSET (outbuf));
 
-  ret = gst_pad_push (audiomixer->srcpad, outbuf);
   audiomixer->current_buffer = NULL;
+  ret = gst_aggregator_finish_buffer (agg, outbuf);
 
   GST_LOG_OBJECT (audiomixer, "pushed outbuf, result = %s",
       gst_flow_get_name (ret));
 
   if (ret == GST_FLOW_OK && is_eos)
-    goto eos;
+    return GST_FLOW_EOS;
 
   return ret;
   /* ERRORS */
@@ -1887,59 +2107,47 @@ not_negotiated:
         ("Unknown data received, not negotiated"));
     return GST_FLOW_NOT_NEGOTIATED;
   }
+}
 
-eos:
-  {
-    GST_DEBUG_OBJECT (audiomixer, "EOS");
-    gst_pad_push_event (audiomixer->srcpad, gst_event_new_eos ());
-    return GST_FLOW_EOS;
-  }
+static gboolean
+gst_audiomixer_start (GstAggregator * agg)
+{
+  GstAudioMixer *audiomixer = GST_AUDIO_MIXER (agg);
+
+  if (!GST_AGGREGATOR_CLASS (parent_class)->start (agg))
+    return FALSE;
+
+  audiomixer->offset = -1;
+  audiomixer->send_caps = TRUE;
+  gst_caps_replace (&audiomixer->current_caps, NULL);
+  audiomixer->discont_time = GST_CLOCK_TIME_NONE;
+
+  return TRUE;
 }
 
-static GstStateChangeReturn
-gst_audiomixer_change_state (GstElement * element, GstStateChange transition)
+static gboolean
+gst_audiomixer_stop (GstAggregator * agg)
 {
-  GstAudioMixer *audiomixer;
-  GstStateChangeReturn ret;
+  GstAudioMixer *audiomixer = GST_AUDIO_MIXER (agg);
 
-  audiomixer = GST_AUDIO_MIXER (element);
+  if (!GST_AGGREGATOR_CLASS (parent_class)->stop (agg))
+    return FALSE;
 
-  switch (transition) {
-    case GST_STATE_CHANGE_NULL_TO_READY:
-      break;
-    case GST_STATE_CHANGE_READY_TO_PAUSED:
-      audiomixer->offset = 0;
-      audiomixer->flush_stop_pending = FALSE;
-      audiomixer->segment_pending = TRUE;
-      audiomixer->send_stream_start = TRUE;
-      audiomixer->send_caps = TRUE;
-      gst_caps_replace (&audiomixer->current_caps, NULL);
-      gst_segment_init (&audiomixer->segment, GST_FORMAT_TIME);
-      gst_collect_pads_start (audiomixer->collect);
-      audiomixer->discont_time = GST_CLOCK_TIME_NONE;
-      break;
-    case GST_STATE_CHANGE_PAUSED_TO_PLAYING:
-      break;
-    case GST_STATE_CHANGE_PAUSED_TO_READY:
-      /* need to unblock the collectpads before calling the
-       * parent change_state so that streaming can finish */
-      gst_collect_pads_stop (audiomixer->collect);
-      break;
-    default:
-      break;
-  }
+  gst_buffer_replace (&audiomixer->current_buffer, NULL);
 
-  ret = GST_ELEMENT_CLASS (parent_class)->change_state (element, transition);
+  return TRUE;
+}
 
-  switch (transition) {
-    case GST_STATE_CHANGE_PAUSED_TO_READY:
-      gst_buffer_replace (&audiomixer->current_buffer, NULL);
-      break;
-    default:
-      break;
-  }
+static GstFlowReturn
+gst_audiomixer_flush (GstAggregator * agg)
+{
+  GstAudioMixer *audiomixer = GST_AUDIO_MIXER (agg);
 
-  return ret;
+  audiomixer->offset = -1;
+  audiomixer->discont_time = GST_CLOCK_TIME_NONE;
+  gst_buffer_replace (&audiomixer->current_buffer, NULL);
+
+  return GST_FLOW_OK;
 }
 
 /* GstChildProxy implementation */
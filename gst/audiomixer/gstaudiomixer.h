@@ -25,7 +25,7 @@
 #define __GST_AUDIO_MIXER_H__
 
 #include <gst/gst.h>
-#include <gst/base/gstcollectpads.h>
+#include <gst/base/gstaggregator.h>
 #include <gst/audio/audio.h>
 
 G_BEGIN_DECLS
@@ -49,26 +49,17 @@ typedef struct _GstAudioMixerPadClass GstAudioMixerPadClass;
  * The audiomixer object structure.
  */
 struct _GstAudioMixer {
-  GstElement      element;
-
-  GstPad         *srcpad;
-  GstCollectPads *collect;
-  /* pad counter, used for creating unique request pads */
-  gint            padcount;
+  GstAggregator   element;
 
   /* the next are valid for both int and float */
   GstAudioInfo    info;
 
-  /* counters to keep track of timestamps */
+  /* counters to keep track of timestamps, in samples of running time,
+   * -1 until the first buffer of the segment is mixed */
   gint64          offset;
   /* Buffer starting at offset containing block_size samples */
   GstBuffer      *current_buffer;
 
-  /* sink event handling */
-  GstSegment      segment;
-  volatile gboolean segment_pending;
-  volatile gboolean flush_stop_pending;
-
   /* current caps */
   GstCaps *current_caps;
 
@@ -84,15 +75,11 @@ struct _GstAudioMixer {
   /* Size in samples that is output per buffer */
   guint blocksize;
 
-  /* Pending inline events */
-  GList *pending_events;
-  
-  gboolean send_stream_start;
   gboolean send_caps;
 };
 
 struct _GstAudioMixerClass {
-  GstElementClass parent_class;
+  GstAggregatorClass parent_class;
 };
 
 GType    gst_audiomixer_get_type (void);
@@ -105,17 +92,49 @@ GType    gst_audiomixer_get_type (void);
 #define GST_AUDIO_MIXER_PAD_GET_CLASS(obj)  (G_TYPE_INSTANCE_GET_CLASS((obj) ,GST_TYPE_AUDIO_MIXER_PAD,GstAudioMixerPadClass))
 
 struct _GstAudioMixerPad {
-  GstPad parent;
+  GstAggregatorPad parent;
 
   gdouble volume;
   gint volume_i32;
   gint volume_i16;
   gint volume_i8;
   gboolean mute;
+
+  /* row-major out_channels x in_channels gains set with the mix-matrix
+   * property, NULL for the default one */
+  gfloat *mix_matrix;
+  guint mix_matrix_size;
+
+  /* < private > */
+  GstAudioInfo info;            /* format of the input, which can only
+                                   differ from the output in its channels */
+  gfloat *remix;                /* matrix in use, NULL if the input is
+                                   mixed as is */
+  gboolean remix_dirty;         /* remix needs to be recalculated */
+  gpointer remix_data;          /* input remixed to the output channels */
+  gsize remix_data_size;
+
+  gdouble ramp_volume;          /* volume reached by the last ramp towards
+                                   volume or silence on mute, -1 before
+                                   the first buffer */
+  gpointer ramp_data;           /* per sample gains of the current ramp */
+  gsize ramp_data_size;
+
+  GstBuffer *buffer;            /* current buffer we're mixing,
+                                   for comparison with the buffer at the
+                                   head of the queue to see if we need to
+                                   update our cached values. */
+  guint position, size;
+
+  guint64 output_offset;        /* Offset in output segment that
+                                   position refers to in the
+                                   current buffer. */
+
+  guint64 next_offset;          /* Next expected offset in the input segment */
 };
 
 struct _GstAudioMixerPadClass {
-  GstPadClass parent_class;
+  GstAggregatorPadClass parent_class;
 };
 
 GType gst_audiomixer_pad_get_type (void);
@@ -128,6 +128,39 @@ void audiomixer_orc_add_volume_f32 (float *ORC_RESTRICT d1,
     const float *ORC_RESTRICT s1, float p1, int n);
 void audiomixer_orc_add_volume_f64 (double *ORC_RESTRICT d1,
     const double *ORC_RESTRICT s1, double p1, int n);
+void audiomixer_orc_add_volume_ramp_u8 (guint8 * ORC_RESTRICT d1,
+    const guint8 * ORC_RESTRICT s1, const gint8 * ORC_RESTRICT s2, int n);
+void audiomixer_orc_add_volume_ramp_s8 (gint8 * ORC_RESTRICT d1,
+    const gint8 * ORC_RESTRICT s1, const gint8 * ORC_RESTRICT s2, int n);
+void audiomixer_orc_add_volume_ramp_u16 (guint16 * ORC_RESTRICT d1,
+    const guint16 * ORC_RESTRICT s1, const gint16 * ORC_RESTRICT s2, int n);
+void audiomixer_orc_add_volume_ramp_s16 (gint16 * ORC_RESTRICT d1,
+    const gint16 * ORC_RESTRICT s1, const gint16 * ORC_RESTRICT s2, int n);
+void audiomixer_orc_add_volume_ramp_u32 (guint32 * ORC_RESTRICT d1,
+    const guint32 * ORC_RESTRICT s1, const gint32 * ORC_RESTRICT s2, int n);
+void audiomixer_orc_add_volume_ramp_s32 (gint32 * ORC_RESTRICT d1,
+    const gint32 * ORC_RESTRICT s1, const gint32 * ORC_RESTRICT s2, int n);
+void audiomixer_orc_add_volume_ramp_f32 (float *ORC_RESTRICT d1,
+    const float *ORC_RESTRICT s1, const float *ORC_RESTRICT s2, int n);
+void audiomixer_orc_add_volume_ramp_f64 (double *ORC_RESTRICT d1,
+    const double *ORC_RESTRICT s1, const double *ORC_RESTRICT s2, int n);
+void audiomixer_orc_remix_mono_stereo_s16 (gint16 * ORC_RESTRICT d1,
+    const gint16 * ORC_RESTRICT s1, float p1, float p2, int n);
+void audiomixer_orc_remix_stereo_mono_s16 (gint16 * ORC_RESTRICT d1,
+    const gint16 * ORC_RESTRICT s1, float p1, float p2, int n);
+void audiomixer_orc_remix_mono_stereo_f32 (float *ORC_RESTRICT d1,
+    const float *ORC_RESTRICT s1, float p1, float p2, int n);
+void audiomixer_orc_remix_stereo_mono_f32 (float *ORC_RESTRICT d1,
+    const float *ORC_RESTRICT s1, float p1, float p2, int n);
+void audiomixer_orc_remix_5p1_stereo_s16 (gint16 * ORC_RESTRICT d1,
+    int d1_stride, const gint16 * ORC_RESTRICT s1, int s1_stride,
+    const gint16 * ORC_RESTRICT s2, int s2_stride,
+    const gint16 * ORC_RESTRICT s3, int s3_stride, float p1, float p2, float p3,
+    float p4, int n, int m);
+void audiomixer_orc_remix_5p1_stereo_f32 (float *ORC_RESTRICT d1, int d1_stride,
+    const float *ORC_RESTRICT s1, int s1_stride, const float *ORC_RESTRICT s2,
+    int s2_stride, const float *ORC_RESTRICT s3, int s3_stride, float p1,
+    float p2, float p3, float p4, int n, int m);
 
 
 /* begin Orc C target preamble */
@@ -2659,3 +2692,3709 @@ audiomixer_orc_add_volume_f64 (double *ORC_RESTRICT d1,
   func (ex);
 }
 #endif
+
+/* audiomixer_orc_add_volume_ramp_u8 */
+#ifdef DISABLE_ORC
+void
+audiomixer_orc_add_volume_ramp_u8 (guint8 * ORC_RESTRICT d1,
+    const guint8 * ORC_RESTRICT s1, const gint8 * ORC_RESTRICT s2, int n)
+{
+  int i;
+  orc_int8 *ORC_RESTRICT ptr0;
+  const orc_int8 *ORC_RESTRICT ptr4;
+  const orc_int8 *ORC_RESTRICT ptr5;
+  orc_int8 var34;
+#if defined(__APPLE__) && __GNUC__ == 4 && __GNUC_MINOR__ == 2 && defined (__i386__)
+  volatile orc_int8 var35;
+#else
+  orc_int8 var35;
+#endif
+  orc_int8 var36;
+#if defined(__APPLE__) && __GNUC__ == 4 && __GNUC_MINOR__ == 2 && defined (__i386__)
+  volatile orc_int8 var37;
+#else
+  orc_int8 var37;
+#endif
+  orc_int8 var38;
+  orc_int8 var39;
+  orc_int8 var40;
+  orc_union16 var41;
+  orc_union16 var42;
+  orc_int8 var43;
+  orc_int8 var44;
+
+  ptr0 = (orc_int8 *) d1;
+  ptr4 = (orc_int8 *) s1;
+  ptr5 = (orc_int8 *) s2;
+
+  /* 1: loadpb */
+  var35 = (int) 0x00000080;     /* 128 or 6.32404e-322f */
+  /* 7: loadpb */
+  var37 = (int) 0x00000080;     /* 128 or 6.32404e-322f */
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadb */
+    var34 = ptr4[i];
+    /* 2: xorb */
+    var40 = var34 ^ var35;
+    /* 3: loadb */
+    var36 = ptr5[i];
+    /* 4: mulsbw */
+    var41.i = var40 * var36;
+    /* 5: shrsw */
+    var42.i = var41.i >> 3;
+    /* 6: convssswb */
+    var43 = ORC_CLAMP_SB (var42.i);
+    /* 8: xorb */
+    var44 = var43 ^ var37;
+    /* 9: loadb */
+    var38 = ptr0[i];
+    /* 10: addusb */
+    var39 = ORC_CLAMP_UB ((orc_uint8) var38 + (orc_uint8) var44);
+    /* 11: storeb */
+    ptr0[i] = var39;
+  }
+
+}
+
+#else
+static void
+_backup_audiomixer_orc_add_volume_ramp_u8 (OrcExecutor * ORC_RESTRICT ex)
+{
+  int i;
+  int n = ex->n;
+  orc_int8 *ORC_RESTRICT ptr0;
+  const orc_int8 *ORC_RESTRICT ptr4;
+  const orc_int8 *ORC_RESTRICT ptr5;
+  orc_int8 var34;
+#if defined(__APPLE__) && __GNUC__ == 4 && __GNUC_MINOR__ == 2 && defined (__i386__)
+  volatile orc_int8 var35;
+#else
+  orc_int8 var35;
+#endif
+  orc_int8 var36;
+#if defined(__APPLE__) && __GNUC__ == 4 && __GNUC_MINOR__ == 2 && defined (__i386__)
+  volatile orc_int8 var37;
+#else
+  orc_int8 var37;
+#endif
+  orc_int8 var38;
+  orc_int8 var39;
+  orc_int8 var40;
+  orc_union16 var41;
+  orc_union16 var42;
+  orc_int8 var43;
+  orc_int8 var44;
+
+  ptr0 = (orc_int8 *) ex->arrays[0];
+  ptr4 = (orc_int8 *) ex->arrays[4];
+  ptr5 = (orc_int8 *) ex->arrays[5];
+
+  /* 1: loadpb */
+  var35 = (int) 0x00000080;     /* 128 or 6.32404e-322f */
+  /* 7: loadpb */
+  var37 = (int) 0x00000080;     /* 128 or 6.32404e-322f */
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadb */
+    var34 = ptr4[i];
+    /* 2: xorb */
+    var40 = var34 ^ var35;
+    /* 3: loadb */
+    var36 = ptr5[i];
+    /* 4: mulsbw */
+    var41.i = var40 * var36;
+    /* 5: shrsw */
+    var42.i = var41.i >> 3;
+    /* 6: convssswb */
+    var43 = ORC_CLAMP_SB (var42.i);
+    /* 8: xorb */
+    var44 = var43 ^ var37;
+    /* 9: loadb */
+    var38 = ptr0[i];
+    /* 10: addusb */
+    var39 = ORC_CLAMP_UB ((orc_uint8) var38 + (orc_uint8) var44);
+    /* 11: storeb */
+    ptr0[i] = var39;
+  }
+
+}
+
+void
+audiomixer_orc_add_volume_ramp_u8 (guint8 * ORC_RESTRICT d1,
+    const guint8 * ORC_RESTRICT s1, const gint8 * ORC_RESTRICT s2, int n)
+{
+  OrcExecutor _ex, *ex = &_ex;
+  static volatile int p_inited = 0;
+  static OrcCode *c = 0;
+  void (*func) (OrcExecutor *);
+
+  if (!p_inited) {
+    orc_once_mutex_lock ();
+    if (!p_inited) {
+      OrcProgram *p;
+
+#if 1
+      static const orc_uint8 bc[] = {
+        1, 9, 33, 97, 117, 100, 105, 111, 109, 105, 120, 101, 114, 95, 111, 114,
+        99, 95, 97, 100, 100, 95, 118, 111, 108, 117, 109, 101, 95, 114, 97,
+        109,
+        112, 95, 117, 56, 11, 1, 1, 12, 1, 1, 12, 1, 1, 14, 1, 128,
+        0, 0, 0, 14, 4, 3, 0, 0, 0, 20, 2, 20, 1, 68, 33, 4,
+        16, 174, 32, 33, 5, 94, 32, 32, 17, 159, 33, 32, 68, 33, 33, 16,
+        35, 0, 0, 33, 2, 0,
+      };
+      p = orc_program_new_from_static_bytecode (bc);
+      orc_program_set_backup_function (p,
+          _backup_audiomixer_orc_add_volume_ramp_u8);
+#else
+      p = orc_program_new ();
+      orc_program_set_name (p, "audiomixer_orc_add_volume_ramp_u8");
+      orc_program_set_backup_function (p,
+          _backup_audiomixer_orc_add_volume_ramp_u8);
+      orc_program_add_destination (p, 1, "d1");
+      orc_program_add_source (p, 1, "s1");
+      orc_program_add_source (p, 1, "s2");
+      orc_program_add_constant (p, 1, 0x00000080, "c1");
+      orc_program_add_constant (p, 4, 0x00000003, "c2");
+      orc_program_add_temporary (p, 2, "t1");
+      orc_program_add_temporary (p, 1, "t2");
+
+      orc_program_append_2 (p, "xorb", 0, ORC_VAR_T2, ORC_VAR_S1, ORC_VAR_C1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "mulsbw", 0, ORC_VAR_T1, ORC_VAR_T2, ORC_VAR_S2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "shrsw", 0, ORC_VAR_T1, ORC_VAR_T1, ORC_VAR_C2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convssswb", 0, ORC_VAR_T2, ORC_VAR_T1,
+          ORC_VAR_D1, ORC_VAR_D1);
+      orc_program_append_2 (p, "xorb", 0, ORC_VAR_T2, ORC_VAR_T2, ORC_VAR_C1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "addusb", 0, ORC_VAR_D1, ORC_VAR_D1, ORC_VAR_T2,
+          ORC_VAR_D1);
+#endif
+
+      orc_program_compile (p);
+      c = orc_program_take_code (p);
+      orc_program_free (p);
+    }
+    p_inited = TRUE;
+    orc_once_mutex_unlock ();
+  }
+  ex->arrays[ORC_VAR_A2] = c;
+  ex->program = 0;
+
+  ex->n = n;
+  ex->arrays[ORC_VAR_D1] = d1;
+  ex->arrays[ORC_VAR_S1] = (void *) s1;
+  ex->arrays[ORC_VAR_S2] = (void *) s2;
+
+  func = c->exec;
+  func (ex);
+}
+#endif
+
+/* audiomixer_orc_add_volume_ramp_s8 */
+#ifdef DISABLE_ORC
+void
+audiomixer_orc_add_volume_ramp_s8 (gint8 * ORC_RESTRICT d1,
+    const gint8 * ORC_RESTRICT s1, const gint8 * ORC_RESTRICT s2, int n)
+{
+  int i;
+  orc_int8 *ORC_RESTRICT ptr0;
+  const orc_int8 *ORC_RESTRICT ptr4;
+  const orc_int8 *ORC_RESTRICT ptr5;
+  orc_int8 var34;
+  orc_int8 var35;
+  orc_int8 var36;
+  orc_int8 var37;
+  orc_union16 var38;
+  orc_union16 var39;
+  orc_int8 var40;
+
+  ptr0 = (orc_int8 *) d1;
+  ptr4 = (orc_int8 *) s1;
+  ptr5 = (orc_int8 *) s2;
+
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadb */
+    var34 = ptr4[i];
+    /* 1: loadb */
+    var35 = ptr5[i];
+    /* 2: mulsbw */
+    var38.i = var34 * var35;
+    /* 3: shrsw */
+    var39.i = var38.i >> 3;
+    /* 4: convssswb */
+    var40 = ORC_CLAMP_SB (var39.i);
+    /* 5: loadb */
+    var36 = ptr0[i];
+    /* 6: addssb */
+    var37 = ORC_CLAMP_SB (var36 + var40);
+    /* 7: storeb */
+    ptr0[i] = var37;
+  }
+
+}
+
+#else
+static void
+_backup_audiomixer_orc_add_volume_ramp_s8 (OrcExecutor * ORC_RESTRICT ex)
+{
+  int i;
+  int n = ex->n;
+  orc_int8 *ORC_RESTRICT ptr0;
+  const orc_int8 *ORC_RESTRICT ptr4;
+  const orc_int8 *ORC_RESTRICT ptr5;
+  orc_int8 var34;
+  orc_int8 var35;
+  orc_int8 var36;
+  orc_int8 var37;
+  orc_union16 var38;
+  orc_union16 var39;
+  orc_int8 var40;
+
+  ptr0 = (orc_int8 *) ex->arrays[0];
+  ptr4 = (orc_int8 *) ex->arrays[4];
+  ptr5 = (orc_int8 *) ex->arrays[5];
+
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadb */
+    var34 = ptr4[i];
+    /* 1: loadb */
+    var35 = ptr5[i];
+    /* 2: mulsbw */
+    var38.i = var34 * var35;
+    /* 3: shrsw */
+    var39.i = var38.i >> 3;
+    /* 4: convssswb */
+    var40 = ORC_CLAMP_SB (var39.i);
+    /* 5: loadb */
+    var36 = ptr0[i];
+    /* 6: addssb */
+    var37 = ORC_CLAMP_SB (var36 + var40);
+    /* 7: storeb */
+    ptr0[i] = var37;
+  }
+
+}
+
+void
+audiomixer_orc_add_volume_ramp_s8 (gint8 * ORC_RESTRICT d1,
+    const gint8 * ORC_RESTRICT s1, const gint8 * ORC_RESTRICT s2, int n)
+{
+  OrcExecutor _ex, *ex = &_ex;
+  static volatile int p_inited = 0;
+  static OrcCode *c = 0;
+  void (*func) (OrcExecutor *);
+
+  if (!p_inited) {
+    orc_once_mutex_lock ();
+    if (!p_inited) {
+      OrcProgram *p;
+
+#if 1
+      static const orc_uint8 bc[] = {
+        1, 9, 33, 97, 117, 100, 105, 111, 109, 105, 120, 101, 114, 95, 111, 114,
+        99, 95, 97, 100, 100, 95, 118, 111, 108, 117, 109, 101, 95, 114, 97,
+        109,
+        112, 95, 115, 56, 11, 1, 1, 12, 1, 1, 12, 1, 1, 14, 4, 3,
+        0, 0, 0, 20, 2, 20, 1, 174, 32, 4, 5, 94, 32, 32, 16, 159,
+        33, 32, 34, 0, 0, 33, 2, 0,
+      };
+      p = orc_program_new_from_static_bytecode (bc);
+      orc_program_set_backup_function (p,
+          _backup_audiomixer_orc_add_volume_ramp_s8);
+#else
+      p = orc_program_new ();
+      orc_program_set_name (p, "audiomixer_orc_add_volume_ramp_s8");
+      orc_program_set_backup_function (p,
+          _backup_audiomixer_orc_add_volume_ramp_s8);
+      orc_program_add_destination (p, 1, "d1");
+      orc_program_add_source (p, 1, "s1");
+      orc_program_add_source (p, 1, "s2");
+      orc_program_add_constant (p, 4, 0x00000003, "c1");
+      orc_program_add_temporary (p, 2, "t1");
+      orc_program_add_temporary (p, 1, "t2");
+
+      orc_program_append_2 (p, "mulsbw", 0, ORC_VAR_T1, ORC_VAR_S1, ORC_VAR_S2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "shrsw", 0, ORC_VAR_T1, ORC_VAR_T1, ORC_VAR_C1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convssswb", 0, ORC_VAR_T2, ORC_VAR_T1,
+          ORC_VAR_D1, ORC_VAR_D1);
+      orc_program_append_2 (p, "addssb", 0, ORC_VAR_D1, ORC_VAR_D1, ORC_VAR_T2,
+          ORC_VAR_D1);
+#endif
+
+      orc_program_compile (p);
+      c = orc_program_take_code (p);
+      orc_program_free (p);
+    }
+    p_inited = TRUE;
+    orc_once_mutex_unlock ();
+  }
+  ex->arrays[ORC_VAR_A2] = c;
+  ex->program = 0;
+
+  ex->n = n;
+  ex->arrays[ORC_VAR_D1] = d1;
+  ex->arrays[ORC_VAR_S1] = (void *) s1;
+  ex->arrays[ORC_VAR_S2] = (void *) s2;
+
+  func = c->exec;
+  func (ex);
+}
+#endif
+
+/* audiomixer_orc_add_volume_ramp_u16 */
+#ifdef DISABLE_ORC
+void
+audiomixer_orc_add_volume_ramp_u16 (guint16 * ORC_RESTRICT d1,
+    const guint16 * ORC_RESTRICT s1, const gint16 * ORC_RESTRICT s2, int n)
+{
+  int i;
+  orc_union16 *ORC_RESTRICT ptr0;
+  const orc_union16 *ORC_RESTRICT ptr4;
+  const orc_union16 *ORC_RESTRICT ptr5;
+  orc_union16 var34;
+#if defined(__APPLE__) && __GNUC__ == 4 && __GNUC_MINOR__ == 2 && defined (__i386__)
+  volatile orc_union16 var35;
+#else
+  orc_union16 var35;
+#endif
+  orc_union16 var36;
+#if defined(__APPLE__) && __GNUC__ == 4 && __GNUC_MINOR__ == 2 && defined (__i386__)
+  volatile orc_union16 var37;
+#else
+  orc_union16 var37;
+#endif
+  orc_union16 var38;
+  orc_union16 var39;
+  orc_union16 var40;
+  orc_union32 var41;
+  orc_union32 var42;
+  orc_union16 var43;
+  orc_union16 var44;
+
+  ptr0 = (orc_union16 *) d1;
+  ptr4 = (orc_union16 *) s1;
+  ptr5 = (orc_union16 *) s2;
+
+  /* 1: loadpw */
+  var35.i = (int) 0x00008000;   /* 32768 or 1.61895e-319f */
+  /* 7: loadpw */
+  var37.i = (int) 0x00008000;   /* 32768 or 1.61895e-319f */
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadw */
+    var34 = ptr4[i];
+    /* 2: xorw */
+    var40.i = var34.i ^ var35.i;
+    /* 3: loadw */
+    var36 = ptr5[i];
+    /* 4: mulswl */
+    var41.i = var40.i * var36.i;
+    /* 5: shrsl */
+    var42.i = var41.i >> 11;
+    /* 6: convssslw */
+    var43.i = ORC_CLAMP_SW (var42.i);
+    /* 8: xorw */
+    var44.i = var43.i ^ var37.i;
+    /* 9: loadw */
+    var38 = ptr0[i];
+    /* 10: addusw */
+    var39.i = ORC_CLAMP_UW ((orc_uint16) var38.i + (orc_uint16) var44.i);
+    /* 11: storew */
+    ptr0[i] = var39;
+  }
+
+}
+
+#else
+static void
+_backup_audiomixer_orc_add_volume_ramp_u16 (OrcExecutor * ORC_RESTRICT ex)
+{
+  int i;
+  int n = ex->n;
+  orc_union16 *ORC_RESTRICT ptr0;
+  const orc_union16 *ORC_RESTRICT ptr4;
+  const orc_union16 *ORC_RESTRICT ptr5;
+  orc_union16 var34;
+#if defined(__APPLE__) && __GNUC__ == 4 && __GNUC_MINOR__ == 2 && defined (__i386__)
+  volatile orc_union16 var35;
+#else
+  orc_union16 var35;
+#endif
+  orc_union16 var36;
+#if defined(__APPLE__) && __GNUC__ == 4 && __GNUC_MINOR__ == 2 && defined (__i386__)
+  volatile orc_union16 var37;
+#else
+  orc_union16 var37;
+#endif
+  orc_union16 var38;
+  orc_union16 var39;
+  orc_union16 var40;
+  orc_union32 var41;
+  orc_union32 var42;
+  orc_union16 var43;
+  orc_union16 var44;
+
+  ptr0 = (orc_union16 *) ex->arrays[0];
+  ptr4 = (orc_union16 *) ex->arrays[4];
+  ptr5 = (orc_union16 *) ex->arrays[5];
+
+  /* 1: loadpw */
+  var35.i = (int) 0x00008000;   /* 32768 or 1.61895e-319f */
+  /* 7: loadpw */
+  var37.i = (int) 0x00008000;   /* 32768 or 1.61895e-319f */
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadw */
+    var34 = ptr4[i];
+    /* 2: xorw */
+    var40.i = var34.i ^ var35.i;
+    /* 3: loadw */
+    var36 = ptr5[i];
+    /* 4: mulswl */
+    var41.i = var40.i * var36.i;
+    /* 5: shrsl */
+    var42.i = var41.i >> 11;
+    /* 6: convssslw */
+    var43.i = ORC_CLAMP_SW (var42.i);
+    /* 8: xorw */
+    var44.i = var43.i ^ var37.i;
+    /* 9: loadw */
+    var38 = ptr0[i];
+    /* 10: addusw */
+    var39.i = ORC_CLAMP_UW ((orc_uint16) var38.i + (orc_uint16) var44.i);
+    /* 11: storew */
+    ptr0[i] = var39;
+  }
+
+}
+
+void
+audiomixer_orc_add_volume_ramp_u16 (guint16 * ORC_RESTRICT d1,
+    const guint16 * ORC_RESTRICT s1, const gint16 * ORC_RESTRICT s2, int n)
+{
+  OrcExecutor _ex, *ex = &_ex;
+  static volatile int p_inited = 0;
+  static OrcCode *c = 0;
+  void (*func) (OrcExecutor *);
+
+  if (!p_inited) {
+    orc_once_mutex_lock ();
+    if (!p_inited) {
+      OrcProgram *p;
+
+#if 1
+      static const orc_uint8 bc[] = {
+        1, 9, 34, 97, 117, 100, 105, 111, 109, 105, 120, 101, 114, 95, 111, 114,
+        99, 95, 97, 100, 100, 95, 118, 111, 108, 117, 109, 101, 95, 114, 97,
+        109,
+        112, 95, 117, 49, 54, 11, 2, 2, 12, 2, 2, 12, 2, 2, 14, 2,
+        0, 128, 0, 0, 14, 4, 11, 0, 0, 0, 20, 4, 20, 2, 101, 33,
+        4, 16, 176, 32, 33, 5, 125, 32, 32, 17, 165, 33, 32, 101, 33, 33,
+        16, 72, 0, 0, 33, 2, 0,
+      };
+      p = orc_program_new_from_static_bytecode (bc);
+      orc_program_set_backup_function (p,
+          _backup_audiomixer_orc_add_volume_ramp_u16);
+#else
+      p = orc_program_new ();
+      orc_program_set_name (p, "audiomixer_orc_add_volume_ramp_u16");
+      orc_program_set_backup_function (p,
+          _backup_audiomixer_orc_add_volume_ramp_u16);
+      orc_program_add_destination (p, 2, "d1");
+      orc_program_add_source (p, 2, "s1");
+      orc_program_add_source (p, 2, "s2");
+      orc_program_add_constant (p, 2, 0x00008000, "c1");
+      orc_program_add_constant (p, 4, 0x0000000b, "c2");
+      orc_program_add_temporary (p, 4, "t1");
+      orc_program_add_temporary (p, 2, "t2");
+
+      orc_program_append_2 (p, "xorw", 0, ORC_VAR_T2, ORC_VAR_S1, ORC_VAR_C1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "mulswl", 0, ORC_VAR_T1, ORC_VAR_T2, ORC_VAR_S2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "shrsl", 0, ORC_VAR_T1, ORC_VAR_T1, ORC_VAR_C2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convssslw", 0, ORC_VAR_T2, ORC_VAR_T1,
+          ORC_VAR_D1, ORC_VAR_D1);
+      orc_program_append_2 (p, "xorw", 0, ORC_VAR_T2, ORC_VAR_T2, ORC_VAR_C1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "addusw", 0, ORC_VAR_D1, ORC_VAR_D1, ORC_VAR_T2,
+          ORC_VAR_D1);
+#endif
+
+      orc_program_compile (p);
+      c = orc_program_take_code (p);
+      orc_program_free (p);
+    }
+    p_inited = TRUE;
+    orc_once_mutex_unlock ();
+  }
+  ex->arrays[ORC_VAR_A2] = c;
+  ex->program = 0;
+
+  ex->n = n;
+  ex->arrays[ORC_VAR_D1] = d1;
+  ex->arrays[ORC_VAR_S1] = (void *) s1;
+  ex->arrays[ORC_VAR_S2] = (void *) s2;
+
+  func = c->exec;
+  func (ex);
+}
+#endif
+
+/* audiomixer_orc_add_volume_ramp_s16 */
+#ifdef DISABLE_ORC
+void
+audiomixer_orc_add_volume_ramp_s16 (gint16 * ORC_RESTRICT d1,
+    const gint16 * ORC_RESTRICT s1, const gint16 * ORC_RESTRICT s2, int n)
+{
+  int i;
+  orc_union16 *ORC_RESTRICT ptr0;
+  const orc_union16 *ORC_RESTRICT ptr4;
+  const orc_union16 *ORC_RESTRICT ptr5;
+  orc_union16 var34;
+  orc_union16 var35;
+  orc_union16 var36;
+  orc_union16 var37;
+  orc_union32 var38;
+  orc_union32 var39;
+  orc_union16 var40;
+
+  ptr0 = (orc_union16 *) d1;
+  ptr4 = (orc_union16 *) s1;
+  ptr5 = (orc_union16 *) s2;
+
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadw */
+    var34 = ptr4[i];
+    /* 1: loadw */
+    var35 = ptr5[i];
+    /* 2: mulswl */
+    var38.i = var34.i * var35.i;
+    /* 3: shrsl */
+    var39.i = var38.i >> 11;
+    /* 4: convssslw */
+    var40.i = ORC_CLAMP_SW (var39.i);
+    /* 5: loadw */
+    var36 = ptr0[i];
+    /* 6: addssw */
+    var37.i = ORC_CLAMP_SW (var36.i + var40.i);
+    /* 7: storew */
+    ptr0[i] = var37;
+  }
+
+}
+
+#else
+static void
+_backup_audiomixer_orc_add_volume_ramp_s16 (OrcExecutor * ORC_RESTRICT ex)
+{
+  int i;
+  int n = ex->n;
+  orc_union16 *ORC_RESTRICT ptr0;
+  const orc_union16 *ORC_RESTRICT ptr4;
+  const orc_union16 *ORC_RESTRICT ptr5;
+  orc_union16 var34;
+  orc_union16 var35;
+  orc_union16 var36;
+  orc_union16 var37;
+  orc_union32 var38;
+  orc_union32 var39;
+  orc_union16 var40;
+
+  ptr0 = (orc_union16 *) ex->arrays[0];
+  ptr4 = (orc_union16 *) ex->arrays[4];
+  ptr5 = (orc_union16 *) ex->arrays[5];
+
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadw */
+    var34 = ptr4[i];
+    /* 1: loadw */
+    var35 = ptr5[i];
+    /* 2: mulswl */
+    var38.i = var34.i * var35.i;
+    /* 3: shrsl */
+    var39.i = var38.i >> 11;
+    /* 4: convssslw */
+    var40.i = ORC_CLAMP_SW (var39.i);
+    /* 5: loadw */
+    var36 = ptr0[i];
+    /* 6: addssw */
+    var37.i = ORC_CLAMP_SW (var36.i + var40.i);
+    /* 7: storew */
+    ptr0[i] = var37;
+  }
+
+}
+
+void
+audiomixer_orc_add_volume_ramp_s16 (gint16 * ORC_RESTRICT d1,
+    const gint16 * ORC_RESTRICT s1, const gint16 * ORC_RESTRICT s2, int n)
+{
+  OrcExecutor _ex, *ex = &_ex;
+  static volatile int p_inited = 0;
+  static OrcCode *c = 0;
+  void (*func) (OrcExecutor *);
+
+  if (!p_inited) {
+    orc_once_mutex_lock ();
+    if (!p_inited) {
+      OrcProgram *p;
+
+#if 1
+      static const orc_uint8 bc[] = {
+        1, 9, 34, 97, 117, 100, 105, 111, 109, 105, 120, 101, 114, 95, 111, 114,
+        99, 95, 97, 100, 100, 95, 118, 111, 108, 117, 109, 101, 95, 114, 97,
+        109,
+        112, 95, 115, 49, 54, 11, 2, 2, 12, 2, 2, 12, 2, 2, 14, 4,
+        11, 0, 0, 0, 20, 4, 20, 2, 176, 32, 4, 5, 125, 32, 32, 16,
+        165, 33, 32, 71, 0, 0, 33, 2, 0,
+      };
+      p = orc_program_new_from_static_bytecode (bc);
+      orc_program_set_backup_function (p,
+          _backup_audiomixer_orc_add_volume_ramp_s16);
+#else
+      p = orc_program_new ();
+      orc_program_set_name (p, "audiomixer_orc_add_volume_ramp_s16");
+      orc_program_set_backup_function (p,
+          _backup_audiomixer_orc_add_volume_ramp_s16);
+      orc_program_add_destination (p, 2, "d1");
+      orc_program_add_source (p, 2, "s1");
+      orc_program_add_source (p, 2, "s2");
+      orc_program_add_constant (p, 4, 0x0000000b, "c1");
+      orc_program_add_temporary (p, 4, "t1");
+      orc_program_add_temporary (p, 2, "t2");
+
+      orc_program_append_2 (p, "mulswl", 0, ORC_VAR_T1, ORC_VAR_S1, ORC_VAR_S2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "shrsl", 0, ORC_VAR_T1, ORC_VAR_T1, ORC_VAR_C1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convssslw", 0, ORC_VAR_T2, ORC_VAR_T1,
+          ORC_VAR_D1, ORC_VAR_D1);
+      orc_program_append_2 (p, "addssw", 0, ORC_VAR_D1, ORC_VAR_D1, ORC_VAR_T2,
+          ORC_VAR_D1);
+#endif
+
+      orc_program_compile (p);
+      c = orc_program_take_code (p);
+      orc_program_free (p);
+    }
+    p_inited = TRUE;
+    orc_once_mutex_unlock ();
+  }
+  ex->arrays[ORC_VAR_A2] = c;
+  ex->program = 0;
+
+  ex->n = n;
+  ex->arrays[ORC_VAR_D1] = d1;
+  ex->arrays[ORC_VAR_S1] = (void *) s1;
+  ex->arrays[ORC_VAR_S2] = (void *) s2;
+
+  func = c->exec;
+  func (ex);
+}
+#endif
+
+/* audiomixer_orc_add_volume_ramp_u32 */
+#ifdef DISABLE_ORC
+void
+audiomixer_orc_add_volume_ramp_u32 (guint32 * ORC_RESTRICT d1,
+    const guint32 * ORC_RESTRICT s1, const gint32 * ORC_RESTRICT s2, int n)
+{
+  int i;
+  orc_union32 *ORC_RESTRICT ptr0;
+  const orc_union32 *ORC_RESTRICT ptr4;
+  const orc_union32 *ORC_RESTRICT ptr5;
+  orc_union32 var34;
+#if defined(__APPLE__) && __GNUC__ == 4 && __GNUC_MINOR__ == 2 && defined (__i386__)
+  volatile orc_union32 var35;
+#else
+  orc_union32 var35;
+#endif
+  orc_union32 var36;
+#if defined(__APPLE__) && __GNUC__ == 4 && __GNUC_MINOR__ == 2 && defined (__i386__)
+  volatile orc_union32 var37;
+#else
+  orc_union32 var37;
+#endif
+  orc_union32 var38;
+  orc_union32 var39;
+  orc_union32 var40;
+  orc_union64 var41;
+  orc_union64 var42;
+  orc_union32 var43;
+  orc_union32 var44;
+
+  ptr0 = (orc_union32 *) d1;
+  ptr4 = (orc_union32 *) s1;
+  ptr5 = (orc_union32 *) s2;
+
+  /* 1: loadpl */
+  var35.i = (int) 0x80000000;   /* -2147483648 or 1.061e-314f */
+  /* 7: loadpl */
+  var37.i = (int) 0x80000000;   /* -2147483648 or 1.061e-314f */
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadl */
+    var34 = ptr4[i];
+    /* 2: xorl */
+    var40.i = var34.i ^ var35.i;
+    /* 3: loadl */
+    var36 = ptr5[i];
+    /* 4: mulslq */
+    var41.i = ((orc_int64) var40.i) * ((orc_int64) var36.i);
+    /* 5: shrsq */
+    var42.i = var41.i >> 27;
+    /* 6: convsssql */
+    var43.i = ORC_CLAMP_SL (var42.i);
+    /* 8: xorl */
+    var44.i = var43.i ^ var37.i;
+    /* 9: loadl */
+    var38 = ptr0[i];
+    /* 10: addusl */
+    var39.i =
+        ORC_CLAMP_UL ((orc_int64) (orc_uint32) var38.i +
+        (orc_int64) (orc_uint32) var44.i);
+    /* 11: storel */
+    ptr0[i] = var39;
+  }
+
+}
+
+#else
+static void
+_backup_audiomixer_orc_add_volume_ramp_u32 (OrcExecutor * ORC_RESTRICT ex)
+{
+  int i;
+  int n = ex->n;
+  orc_union32 *ORC_RESTRICT ptr0;
+  const orc_union32 *ORC_RESTRICT ptr4;
+  const orc_union32 *ORC_RESTRICT ptr5;
+  orc_union32 var34;
+#if defined(__APPLE__) && __GNUC__ == 4 && __GNUC_MINOR__ == 2 && defined (__i386__)
+  volatile orc_union32 var35;
+#else
+  orc_union32 var35;
+#endif
+  orc_union32 var36;
+#if defined(__APPLE__) && __GNUC__ == 4 && __GNUC_MINOR__ == 2 && defined (__i386__)
+  volatile orc_union32 var37;
+#else
+  orc_union32 var37;
+#endif
+  orc_union32 var38;
+  orc_union32 var39;
+  orc_union32 var40;
+  orc_union64 var41;
+  orc_union64 var42;
+  orc_union32 var43;
+  orc_union32 var44;
+
+  ptr0 = (orc_union32 *) ex->arrays[0];
+  ptr4 = (orc_union32 *) ex->arrays[4];
+  ptr5 = (orc_union32 *) ex->arrays[5];
+
+  /* 1: loadpl */
+  var35.i = (int) 0x80000000;   /* -2147483648 or 1.061e-314f */
+  /* 7: loadpl */
+  var37.i = (int) 0x80000000;   /* -2147483648 or 1.061e-314f */
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadl */
+    var34 = ptr4[i];
+    /* 2: xorl */
+    var40.i = var34.i ^ var35.i;
+    /* 3: loadl */
+    var36 = ptr5[i];
+    /* 4: mulslq */
+    var41.i = ((orc_int64) var40.i) * ((orc_int64) var36.i);
+    /* 5: shrsq */
+    var42.i = var41.i >> 27;
+    /* 6: convsssql */
+    var43.i = ORC_CLAMP_SL (var42.i);
+    /* 8: xorl */
+    var44.i = var43.i ^ var37.i;
+    /* 9: loadl */
+    var38 = ptr0[i];
+    /* 10: addusl */
+    var39.i =
+        ORC_CLAMP_UL ((orc_int64) (orc_uint32) var38.i +
+        (orc_int64) (orc_uint32) var44.i);
+    /* 11: storel */
+    ptr0[i] = var39;
+  }
+
+}
+
+void
+audiomixer_orc_add_volume_ramp_u32 (guint32 * ORC_RESTRICT d1,
+    const guint32 * ORC_RESTRICT s1, const gint32 * ORC_RESTRICT s2, int n)
+{
+  OrcExecutor _ex, *ex = &_ex;
+  static volatile int p_inited = 0;
+  static OrcCode *c = 0;
+  void (*func) (OrcExecutor *);
+
+  if (!p_inited) {
+    orc_once_mutex_lock ();
+    if (!p_inited) {
+      OrcProgram *p;
+
+#if 1
+      static const orc_uint8 bc[] = {
+        1, 9, 34, 97, 117, 100, 105, 111, 109, 105, 120, 101, 114, 95, 111, 114,
+        99, 95, 97, 100, 100, 95, 118, 111, 108, 117, 109, 101, 95, 114, 97,
+        109,
+        112, 95, 117, 51, 50, 11, 4, 4, 12, 4, 4, 12, 4, 4, 14, 4,
+        0, 0, 0, 128, 14, 4, 27, 0, 0, 0, 20, 8, 20, 4, 132, 33,
+        4, 16, 178, 32, 33, 5, 147, 32, 32, 17, 170, 33, 32, 132, 33, 33,
+        16, 105, 0, 0, 33, 2, 0,
+      };
+      p = orc_program_new_from_static_bytecode (bc);
+      orc_program_set_backup_function (p,
+          _backup_audiomixer_orc_add_volume_ramp_u32);
+#else
+      p = orc_program_new ();
+      orc_program_set_name (p, "audiomixer_orc_add_volume_ramp_u32");
+      orc_program_set_backup_function (p,
+          _backup_audiomixer_orc_add_volume_ramp_u32);
+      orc_program_add_destination (p, 4, "d1");
+      orc_program_add_source (p, 4, "s1");
+      orc_program_add_source (p, 4, "s2");
+      orc_program_add_constant (p, 4, 0x80000000, "c1");
+      orc_program_add_constant (p, 4, 0x0000001b, "c2");
+      orc_program_add_temporary (p, 8, "t1");
+      orc_program_add_temporary (p, 4, "t2");
+
+      orc_program_append_2 (p, "xorl", 0, ORC_VAR_T2, ORC_VAR_S1, ORC_VAR_C1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "mulslq", 0, ORC_VAR_T1, ORC_VAR_T2, ORC_VAR_S2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "shrsq", 0, ORC_VAR_T1, ORC_VAR_T1, ORC_VAR_C2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convsssql", 0, ORC_VAR_T2, ORC_VAR_T1,
+          ORC_VAR_D1, ORC_VAR_D1);
+      orc_program_append_2 (p, "xorl", 0, ORC_VAR_T2, ORC_VAR_T2, ORC_VAR_C1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "addusl", 0, ORC_VAR_D1, ORC_VAR_D1, ORC_VAR_T2,
+          ORC_VAR_D1);
+#endif
+
+      orc_program_compile (p);
+      c = orc_program_take_code (p);
+      orc_program_free (p);
+    }
+    p_inited = TRUE;
+    orc_once_mutex_unlock ();
+  }
+  ex->arrays[ORC_VAR_A2] = c;
+  ex->program = 0;
+
+  ex->n = n;
+  ex->arrays[ORC_VAR_D1] = d1;
+  ex->arrays[ORC_VAR_S1] = (void *) s1;
+  ex->arrays[ORC_VAR_S2] = (void *) s2;
+
+  func = c->exec;
+  func (ex);
+}
+#endif
+
+/* audiomixer_orc_add_volume_ramp_s32 */
+#ifdef DISABLE_ORC
+void
+audiomixer_orc_add_volume_ramp_s32 (gint32 * ORC_RESTRICT d1,
+    const gint32 * ORC_RESTRICT s1, const gint32 * ORC_RESTRICT s2, int n)
+{
+  int i;
+  orc_union32 *ORC_RESTRICT ptr0;
+  const orc_union32 *ORC_RESTRICT ptr4;
+  const orc_union32 *ORC_RESTRICT ptr5;
+  orc_union32 var34;
+  orc_union32 var35;
+  orc_union32 var36;
+  orc_union32 var37;
+  orc_union64 var38;
+  orc_union64 var39;
+  orc_union32 var40;
+
+  ptr0 = (orc_union32 *) d1;
+  ptr4 = (orc_union32 *) s1;
+  ptr5 = (orc_union32 *) s2;
+
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadl */
+    var34 = ptr4[i];
+    /* 1: loadl */
+    var35 = ptr5[i];
+    /* 2: mulslq */
+    var38.i = ((orc_int64) var34.i) * ((orc_int64) var35.i);
+    /* 3: shrsq */
+    var39.i = var38.i >> 27;
+    /* 4: convsssql */
+    var40.i = ORC_CLAMP_SL (var39.i);
+    /* 5: loadl */
+    var36 = ptr0[i];
+    /* 6: addssl */
+    var37.i = ORC_CLAMP_SL ((orc_int64) var36.i + (orc_int64) var40.i);
+    /* 7: storel */
+    ptr0[i] = var37;
+  }
+
+}
+
+#else
+static void
+_backup_audiomixer_orc_add_volume_ramp_s32 (OrcExecutor * ORC_RESTRICT ex)
+{
+  int i;
+  int n = ex->n;
+  orc_union32 *ORC_RESTRICT ptr0;
+  const orc_union32 *ORC_RESTRICT ptr4;
+  const orc_union32 *ORC_RESTRICT ptr5;
+  orc_union32 var34;
+  orc_union32 var35;
+  orc_union32 var36;
+  orc_union32 var37;
+  orc_union64 var38;
+  orc_union64 var39;
+  orc_union32 var40;
+
+  ptr0 = (orc_union32 *) ex->arrays[0];
+  ptr4 = (orc_union32 *) ex->arrays[4];
+  ptr5 = (orc_union32 *) ex->arrays[5];
+
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadl */
+    var34 = ptr4[i];
+    /* 1: loadl */
+    var35 = ptr5[i];
+    /* 2: mulslq */
+    var38.i = ((orc_int64) var34.i) * ((orc_int64) var35.i);
+    /* 3: shrsq */
+    var39.i = var38.i >> 27;
+    /* 4: convsssql */
+    var40.i = ORC_CLAMP_SL (var39.i);
+    /* 5: loadl */
+    var36 = ptr0[i];
+    /* 6: addssl */
+    var37.i = ORC_CLAMP_SL ((orc_int64) var36.i + (orc_int64) var40.i);
+    /* 7: storel */
+    ptr0[i] = var37;
+  }
+
+}
+
+void
+audiomixer_orc_add_volume_ramp_s32 (gint32 * ORC_RESTRICT d1,
+    const gint32 * ORC_RESTRICT s1, const gint32 * ORC_RESTRICT s2, int n)
+{
+  OrcExecutor _ex, *ex = &_ex;
+  static volatile int p_inited = 0;
+  static OrcCode *c = 0;
+  void (*func) (OrcExecutor *);
+
+  if (!p_inited) {
+    orc_once_mutex_lock ();
+    if (!p_inited) {
+      OrcProgram *p;
+
+#if 1
+      static const orc_uint8 bc[] = {
+        1, 9, 34, 97, 117, 100, 105, 111, 109, 105, 120, 101, 114, 95, 111, 114,
+        99, 95, 97, 100, 100, 95, 118, 111, 108, 117, 109, 101, 95, 114, 97,
+        109,
+        112, 95, 115, 51, 50, 11, 4, 4, 12, 4, 4, 12, 4, 4, 14, 4,
+        27, 0, 0, 0, 20, 8, 20, 4, 178, 32, 4, 5, 147, 32, 32, 16,
+        170, 33, 32, 104, 0, 0, 33, 2, 0,
+      };
+      p = orc_program_new_from_static_bytecode (bc);
+      orc_program_set_backup_function (p,
+          _backup_audiomixer_orc_add_volume_ramp_s32);
+#else
+      p = orc_program_new ();
+      orc_program_set_name (p, "audiomixer_orc_add_volume_ramp_s32");
+      orc_program_set_backup_function (p,
+          _backup_audiomixer_orc_add_volume_ramp_s32);
+      orc_program_add_destination (p, 4, "d1");
+      orc_program_add_source (p, 4, "s1");
+      orc_program_add_source (p, 4, "s2");
+      orc_program_add_constant (p, 4, 0x0000001b, "c1");
+      orc_program_add_temporary (p, 8, "t1");
+      orc_program_add_temporary (p, 4, "t2");
+
+      orc_program_append_2 (p, "mulslq", 0, ORC_VAR_T1, ORC_VAR_S1, ORC_VAR_S2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "shrsq", 0, ORC_VAR_T1, ORC_VAR_T1, ORC_VAR_C1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convsssql", 0, ORC_VAR_T2, ORC_VAR_T1,
+          ORC_VAR_D1, ORC_VAR_D1);
+      orc_program_append_2 (p, "addssl", 0, ORC_VAR_D1, ORC_VAR_D1, ORC_VAR_T2,
+          ORC_VAR_D1);
+#endif
+
+      orc_program_compile (p);
+      c = orc_program_take_code (p);
+      orc_program_free (p);
+    }
+    p_inited = TRUE;
+    orc_once_mutex_unlock ();
+  }
+  ex->arrays[ORC_VAR_A2] = c;
+  ex->program = 0;
+
+  ex->n = n;
+  ex->arrays[ORC_VAR_D1] = d1;
+  ex->arrays[ORC_VAR_S1] = (void *) s1;
+  ex->arrays[ORC_VAR_S2] = (void *) s2;
+
+  func = c->exec;
+  func (ex);
+}
+#endif
+
+/* audiomixer_orc_add_volume_ramp_f32 */
+#ifdef DISABLE_ORC
+void
+audiomixer_orc_add_volume_ramp_f32 (float *ORC_RESTRICT d1,
+    const float *ORC_RESTRICT s1, const float *ORC_RESTRICT s2, int n)
+{
+  int i;
+  orc_union32 *ORC_RESTRICT ptr0;
+  const orc_union32 *ORC_RESTRICT ptr4;
+  const orc_union32 *ORC_RESTRICT ptr5;
+  orc_union32 var33;
+  orc_union32 var34;
+  orc_union32 var35;
+  orc_union32 var36;
+  orc_union32 var37;
+
+  ptr0 = (orc_union32 *) d1;
+  ptr4 = (orc_union32 *) s1;
+  ptr5 = (orc_union32 *) s2;
+
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadl */
+    var33 = ptr4[i];
+    /* 1: loadl */
+    var34 = ptr5[i];
+    /* 2: mulf */
+    {
+      orc_union32 _src1;
+      orc_union32 _src2;
+      orc_union32 _dest1;
+      _src1.i = ORC_DENORMAL (var33.i);
+      _src2.i = ORC_DENORMAL (var34.i);
+      _dest1.f = _src1.f * _src2.f;
+      var37.i = ORC_DENORMAL (_dest1.i);
+    }
+    /* 3: loadl */
+    var35 = ptr0[i];
+    /* 4: addf */
+    {
+      orc_union32 _src1;
+      orc_union32 _src2;
+      orc_union32 _dest1;
+      _src1.i = ORC_DENORMAL (var35.i);
+      _src2.i = ORC_DENORMAL (var37.i);
+      _dest1.f = _src1.f + _src2.f;
+      var36.i = ORC_DENORMAL (_dest1.i);
+    }
+    /* 5: storel */
+    ptr0[i] = var36;
+  }
+
+}
+
+#else
+static void
+_backup_audiomixer_orc_add_volume_ramp_f32 (OrcExecutor * ORC_RESTRICT ex)
+{
+  int i;
+  int n = ex->n;
+  orc_union32 *ORC_RESTRICT ptr0;
+  const orc_union32 *ORC_RESTRICT ptr4;
+  const orc_union32 *ORC_RESTRICT ptr5;
+  orc_union32 var33;
+  orc_union32 var34;
+  orc_union32 var35;
+  orc_union32 var36;
+  orc_union32 var37;
+
+  ptr0 = (orc_union32 *) ex->arrays[0];
+  ptr4 = (orc_union32 *) ex->arrays[4];
+  ptr5 = (orc_union32 *) ex->arrays[5];
+
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadl */
+    var33 = ptr4[i];
+    /* 1: loadl */
+    var34 = ptr5[i];
+    /* 2: mulf */
+    {
+      orc_union32 _src1;
+      orc_union32 _src2;
+      orc_union32 _dest1;
+      _src1.i = ORC_DENORMAL (var33.i);
+      _src2.i = ORC_DENORMAL (var34.i);
+      _dest1.f = _src1.f * _src2.f;
+      var37.i = ORC_DENORMAL (_dest1.i);
+    }
+    /* 3: loadl */
+    var35 = ptr0[i];
+    /* 4: addf */
+    {
+      orc_union32 _src1;
+      orc_union32 _src2;
+      orc_union32 _dest1;
+      _src1.i = ORC_DENORMAL (var35.i);
+      _src2.i = ORC_DENORMAL (var37.i);
+      _dest1.f = _src1.f + _src2.f;
+      var36.i = ORC_DENORMAL (_dest1.i);
+    }
+    /* 5: storel */
+    ptr0[i] = var36;
+  }
+
+}
+
+void
+audiomixer_orc_add_volume_ramp_f32 (float *ORC_RESTRICT d1,
+    const float *ORC_RESTRICT s1, const float *ORC_RESTRICT s2, int n)
+{
+  OrcExecutor _ex, *ex = &_ex;
+  static volatile int p_inited = 0;
+  static OrcCode *c = 0;
+  void (*func) (OrcExecutor *);
+
+  if (!p_inited) {
+    orc_once_mutex_lock ();
+    if (!p_inited) {
+      OrcProgram *p;
+
+#if 1
+      static const orc_uint8 bc[] = {
+        1, 9, 34, 97, 117, 100, 105, 111, 109, 105, 120, 101, 114, 95, 111, 114,
+        99, 95, 97, 100, 100, 95, 118, 111, 108, 117, 109, 101, 95, 114, 97,
+        109,
+        112, 95, 102, 51, 50, 11, 4, 4, 12, 4, 4, 12, 4, 4, 20, 4,
+        202, 32, 4, 5, 200, 0, 0, 32, 2, 0,
+      };
+      p = orc_program_new_from_static_bytecode (bc);
+      orc_program_set_backup_function (p,
+          _backup_audiomixer_orc_add_volume_ramp_f32);
+#else
+      p = orc_program_new ();
+      orc_program_set_name (p, "audiomixer_orc_add_volume_ramp_f32");
+      orc_program_set_backup_function (p,
+          _backup_audiomixer_orc_add_volume_ramp_f32);
+      orc_program_add_destination (p, 4, "d1");
+      orc_program_add_source (p, 4, "s1");
+      orc_program_add_source (p, 4, "s2");
+      orc_program_add_temporary (p, 4, "t1");
+
+      orc_program_append_2 (p, "mulf", 0, ORC_VAR_T1, ORC_VAR_S1, ORC_VAR_S2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "addf", 0, ORC_VAR_D1, ORC_VAR_D1, ORC_VAR_T1,
+          ORC_VAR_D1);
+#endif
+
+      orc_program_compile (p);
+      c = orc_program_take_code (p);
+      orc_program_free (p);
+    }
+    p_inited = TRUE;
+    orc_once_mutex_unlock ();
+  }
+  ex->arrays[ORC_VAR_A2] = c;
+  ex->program = 0;
+
+  ex->n = n;
+  ex->arrays[ORC_VAR_D1] = d1;
+  ex->arrays[ORC_VAR_S1] = (void *) s1;
+  ex->arrays[ORC_VAR_S2] = (void *) s2;
+
+  func = c->exec;
+  func (ex);
+}
+#endif
+
+/* audiomixer_orc_add_volume_ramp_f64 */
+#ifdef DISABLE_ORC
+void
+audiomixer_orc_add_volume_ramp_f64 (double *ORC_RESTRICT d1,
+    const double *ORC_RESTRICT s1, const double *ORC_RESTRICT s2, int n)
+{
+  int i;
+  orc_union64 *ORC_RESTRICT ptr0;
+  const orc_union64 *ORC_RESTRICT ptr4;
+  const orc_union64 *ORC_RESTRICT ptr5;
+  orc_union64 var33;
+  orc_union64 var34;
+  orc_union64 var35;
+  orc_union64 var36;
+  orc_union64 var37;
+
+  ptr0 = (orc_union64 *) d1;
+  ptr4 = (orc_union64 *) s1;
+  ptr5 = (orc_union64 *) s2;
+
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadq */
+    var33 = ptr4[i];
+    /* 1: loadq */
+    var34 = ptr5[i];
+    /* 2: muld */
+    {
+      orc_union64 _src1;
+      orc_union64 _src2;
+      orc_union64 _dest1;
+      _src1.i = ORC_DENORMAL_DOUBLE (var33.i);
+      _src2.i = ORC_DENORMAL_DOUBLE (var34.i);
+      _dest1.f = _src1.f * _src2.f;
+      var37.i = ORC_DENORMAL_DOUBLE (_dest1.i);
+    }
+    /* 3: loadq */
+    var35 = ptr0[i];
+    /* 4: addd */
+    {
+      orc_union64 _src1;
+      orc_union64 _src2;
+      orc_union64 _dest1;
+      _src1.i = ORC_DENORMAL_DOUBLE (var35.i);
+      _src2.i = ORC_DENORMAL_DOUBLE (var37.i);
+      _dest1.f = _src1.f + _src2.f;
+      var36.i = ORC_DENORMAL_DOUBLE (_dest1.i);
+    }
+    /* 5: storeq */
+    ptr0[i] = var36;
+  }
+
+}
+
+#else
+static void
+_backup_audiomixer_orc_add_volume_ramp_f64 (OrcExecutor * ORC_RESTRICT ex)
+{
+  int i;
+  int n = ex->n;
+  orc_union64 *ORC_RESTRICT ptr0;
+  const orc_union64 *ORC_RESTRICT ptr4;
+  const orc_union64 *ORC_RESTRICT ptr5;
+  orc_union64 var33;
+  orc_union64 var34;
+  orc_union64 var35;
+  orc_union64 var36;
+  orc_union64 var37;
+
+  ptr0 = (orc_union64 *) ex->arrays[0];
+  ptr4 = (orc_union64 *) ex->arrays[4];
+  ptr5 = (orc_union64 *) ex->arrays[5];
+
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadq */
+    var33 = ptr4[i];
+    /* 1: loadq */
+    var34 = ptr5[i];
+    /* 2: muld */
+    {
+      orc_union64 _src1;
+      orc_union64 _src2;
+      orc_union64 _dest1;
+      _src1.i = ORC_DENORMAL_DOUBLE (var33.i);
+      _src2.i = ORC_DENORMAL_DOUBLE (var34.i);
+      _dest1.f = _src1.f * _src2.f;
+      var37.i = ORC_DENORMAL_DOUBLE (_dest1.i);
+    }
+    /* 3: loadq */
+    var35 = ptr0[i];
+    /* 4: addd */
+    {
+      orc_union64 _src1;
+      orc_union64 _src2;
+      orc_union64 _dest1;
+      _src1.i = ORC_DENORMAL_DOUBLE (var35.i);
+      _src2.i = ORC_DENORMAL_DOUBLE (var37.i);
+      _dest1.f = _src1.f + _src2.f;
+      var36.i = ORC_DENORMAL_DOUBLE (_dest1.i);
+    }
+    /* 5: storeq */
+    ptr0[i] = var36;
+  }
+
+}
+
+void
+audiomixer_orc_add_volume_ramp_f64 (double *ORC_RESTRICT d1,
+    const double *ORC_RESTRICT s1, const double *ORC_RESTRICT s2, int n)
+{
+  OrcExecutor _ex, *ex = &_ex;
+  static volatile int p_inited = 0;
+  static OrcCode *c = 0;
+  void (*func) (OrcExecutor *);
+
+  if (!p_inited) {
+    orc_once_mutex_lock ();
+    if (!p_inited) {
+      OrcProgram *p;
+
+#if 1
+      static const orc_uint8 bc[] = {
+        1, 9, 34, 97, 117, 100, 105, 111, 109, 105, 120, 101, 114, 95, 111, 114,
+        99, 95, 97, 100, 100, 95, 118, 111, 108, 117, 109, 101, 95, 114, 97,
+        109,
+        112, 95, 102, 54, 52, 11, 8, 8, 12, 8, 8, 12, 8, 8, 20, 8,
+        214, 32, 4, 5, 212, 0, 0, 32, 2, 0,
+      };
+      p = orc_program_new_from_static_bytecode (bc);
+      orc_program_set_backup_function (p,
+          _backup_audiomixer_orc_add_volume_ramp_f64);
+#else
+      p = orc_program_new ();
+      orc_program_set_name (p, "audiomixer_orc_add_volume_ramp_f64");
+      orc_program_set_backup_function (p,
+          _backup_audiomixer_orc_add_volume_ramp_f64);
+      orc_program_add_destination (p, 8, "d1");
+      orc_program_add_source (p, 8, "s1");
+      orc_program_add_source (p, 8, "s2");
+      orc_program_add_temporary (p, 8, "t1");
+
+      orc_program_append_2 (p, "muld", 0, ORC_VAR_T1, ORC_VAR_S1, ORC_VAR_S2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "addd", 0, ORC_VAR_D1, ORC_VAR_D1, ORC_VAR_T1,
+          ORC_VAR_D1);
+#endif
+
+      orc_program_compile (p);
+      c = orc_program_take_code (p);
+      orc_program_free (p);
+    }
+    p_inited = TRUE;
+    orc_once_mutex_unlock ();
+  }
+  ex->arrays[ORC_VAR_A2] = c;
+  ex->program = 0;
+
+  ex->n = n;
+  ex->arrays[ORC_VAR_D1] = d1;
+  ex->arrays[ORC_VAR_S1] = (void *) s1;
+  ex->arrays[ORC_VAR_S2] = (void *) s2;
+
+  func = c->exec;
+  func (ex);
+}
+#endif
+
+
+/* audiomixer_orc_remix_mono_stereo_s16 */
+#ifdef DISABLE_ORC
+void
+audiomixer_orc_remix_mono_stereo_s16 (gint16 * ORC_RESTRICT d1,
+    const gint16 * ORC_RESTRICT s1, float p1, float p2, int n)
+{
+  int i;
+  orc_union32 *ORC_RESTRICT ptr0;
+  const orc_union16 *ORC_RESTRICT ptr4;
+  orc_union16 var36;
+  orc_union32 var37;
+  orc_union32 var38;
+  orc_union32 var39;
+  orc_union32 var40;
+  orc_union32 var41;
+  orc_union32 var42;
+  orc_union32 var43;
+  orc_union16 var44;
+  orc_union32 var45;
+  orc_union32 var46;
+  orc_union16 var47;
+
+  ptr0 = (orc_union32 *) d1;
+  ptr4 = (orc_union16 *) s1;
+
+  /* 3: loadpl */
+  var37.f = p1;
+  /* 7: loadpl */
+  var38.f = p2;
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadw */
+    var36 = ptr4[i];
+    /* 1: convswl */
+    var40.i = var36.i;
+    /* 2: convlf */
+    var41.f = var40.i;
+    /* 4: mulf */
+    {
+      orc_union32 _src1;
+      orc_union32 _src2;
+      orc_union32 _dest1;
+      _src1.i = ORC_DENORMAL (var41.i);
+      _src2.i = ORC_DENORMAL (var37.i);
+      _dest1.f = _src1.f * _src2.f;
+      var42.i = ORC_DENORMAL (_dest1.i);
+    }
+    /* 5: convfl */
+    {
+      int tmp;
+      tmp = (int) var42.f;
+      if (tmp == 0x80000000 && !(var42.i & 0x80000000))
+        tmp = 0x7fffffff;
+      var43.i = tmp;
+    }
+    /* 6: convssslw */
+    var44.i = ORC_CLAMP_SW (var43.i);
+    /* 8: mulf */
+    {
+      orc_union32 _src1;
+      orc_union32 _src2;
+      orc_union32 _dest1;
+      _src1.i = ORC_DENORMAL (var41.i);
+      _src2.i = ORC_DENORMAL (var38.i);
+      _dest1.f = _src1.f * _src2.f;
+      var45.i = ORC_DENORMAL (_dest1.i);
+    }
+    /* 9: convfl */
+    {
+      int tmp;
+      tmp = (int) var45.f;
+      if (tmp == 0x80000000 && !(var45.i & 0x80000000))
+        tmp = 0x7fffffff;
+      var46.i = tmp;
+    }
+    /* 10: convssslw */
+    var47.i = ORC_CLAMP_SW (var46.i);
+    /* 11: mergewl */
+    {
+      orc_union32 _dest;
+      _dest.x2[0] = var44.i;
+      _dest.x2[1] = var47.i;
+      var39.i = _dest.i;
+    }
+    /* 12: storel */
+    ptr0[i] = var39;
+  }
+
+}
+
+#else
+static void
+_backup_audiomixer_orc_remix_mono_stereo_s16 (OrcExecutor * ORC_RESTRICT ex)
+{
+  int i;
+  int n = ex->n;
+  orc_union32 *ORC_RESTRICT ptr0;
+  const orc_union16 *ORC_RESTRICT ptr4;
+  orc_union16 var36;
+  orc_union32 var37;
+  orc_union32 var38;
+  orc_union32 var39;
+  orc_union32 var40;
+  orc_union32 var41;
+  orc_union32 var42;
+  orc_union32 var43;
+  orc_union16 var44;
+  orc_union32 var45;
+  orc_union32 var46;
+  orc_union16 var47;
+
+  ptr0 = (orc_union32 *) ex->arrays[0];
+  ptr4 = (orc_union16 *) ex->arrays[4];
+
+  /* 3: loadpl */
+  var37.i = ex->params[24];
+  /* 7: loadpl */
+  var38.i = ex->params[25];
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadw */
+    var36 = ptr4[i];
+    /* 1: convswl */
+    var40.i = var36.i;
+    /* 2: convlf */
+    var41.f = var40.i;
+    /* 4: mulf */
+    {
+      orc_union32 _src1;
+      orc_union32 _src2;
+      orc_union32 _dest1;
+      _src1.i = ORC_DENORMAL (var41.i);
+      _src2.i = ORC_DENORMAL (var37.i);
+      _dest1.f = _src1.f * _src2.f;
+      var42.i = ORC_DENORMAL (_dest1.i);
+    }
+    /* 5: convfl */
+    {
+      int tmp;
+      tmp = (int) var42.f;
+      if (tmp == 0x80000000 && !(var42.i & 0x80000000))
+        tmp = 0x7fffffff;
+      var43.i = tmp;
+    }
+    /* 6: convssslw */
+    var44.i = ORC_CLAMP_SW (var43.i);
+    /* 8: mulf */
+    {
+      orc_union32 _src1;
+      orc_union32 _src2;
+      orc_union32 _dest1;
+      _src1.i = ORC_DENORMAL (var41.i);
+      _src2.i = ORC_DENORMAL (var38.i);
+      _dest1.f = _src1.f * _src2.f;
+      var45.i = ORC_DENORMAL (_dest1.i);
+    }
+    /* 9: convfl */
+    {
+      int tmp;
+      tmp = (int) var45.f;
+      if (tmp == 0x80000000 && !(var45.i & 0x80000000))
+        tmp = 0x7fffffff;
+      var46.i = tmp;
+    }
+    /* 10: convssslw */
+    var47.i = ORC_CLAMP_SW (var46.i);
+    /* 11: mergewl */
+    {
+      orc_union32 _dest;
+      _dest.x2[0] = var44.i;
+      _dest.x2[1] = var47.i;
+      var39.i = _dest.i;
+    }
+    /* 12: storel */
+    ptr0[i] = var39;
+  }
+
+}
+
+void
+audiomixer_orc_remix_mono_stereo_s16 (gint16 * ORC_RESTRICT d1,
+    const gint16 * ORC_RESTRICT s1, float p1, float p2, int n)
+{
+  OrcExecutor _ex, *ex = &_ex;
+  static volatile int p_inited = 0;
+  static OrcCode *c = 0;
+  void (*func) (OrcExecutor *);
+
+  if (!p_inited) {
+    orc_once_mutex_lock ();
+    if (!p_inited) {
+      OrcProgram *p;
+
+#if 1
+      static const orc_uint8 bc[] = {
+        1, 9, 36, 97, 117, 100, 105, 111, 109, 105, 120, 101, 114, 95, 111, 114,
+        99, 95, 114, 101, 109, 105, 120, 95, 109, 111, 110, 111, 95, 115, 116,
+        101,
+        114, 101, 111, 95, 115, 49, 54, 11, 4, 4, 12, 2, 2, 17, 4, 17,
+        4, 20, 4, 20, 4, 20, 2, 20, 2, 153, 32, 4, 211, 32, 32, 202,
+        33, 32, 24, 210, 33, 33, 165, 34, 33, 202, 33, 32, 25, 210, 33, 33,
+        165, 35, 33, 195, 0, 34, 35, 2, 0,
+      };
+      p = orc_program_new_from_static_bytecode (bc);
+      orc_program_set_backup_function (p,
+          _backup_audiomixer_orc_remix_mono_stereo_s16);
+#else
+      p = orc_program_new ();
+      orc_program_set_name (p, "audiomixer_orc_remix_mono_stereo_s16");
+      orc_program_set_backup_function (p,
+          _backup_audiomixer_orc_remix_mono_stereo_s16);
+      orc_program_add_destination (p, 4, "d1");
+      orc_program_add_source (p, 2, "s1");
+      orc_program_add_parameter_float (p, 4, "p1");
+      orc_program_add_parameter_float (p, 4, "p2");
+      orc_program_add_temporary (p, 4, "t1");
+      orc_program_add_temporary (p, 4, "t2");
+      orc_program_add_temporary (p, 2, "t3");
+      orc_program_add_temporary (p, 2, "t4");
+
+      orc_program_append_2 (p, "convswl", 0, ORC_VAR_T1, ORC_VAR_S1, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convlf", 0, ORC_VAR_T1, ORC_VAR_T1, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "mulf", 0, ORC_VAR_T2, ORC_VAR_T1, ORC_VAR_P1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convfl", 0, ORC_VAR_T2, ORC_VAR_T2, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convssslw", 0, ORC_VAR_T3, ORC_VAR_T2,
+          ORC_VAR_D1, ORC_VAR_D1);
+      orc_program_append_2 (p, "mulf", 0, ORC_VAR_T2, ORC_VAR_T1, ORC_VAR_P2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convfl", 0, ORC_VAR_T2, ORC_VAR_T2, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convssslw", 0, ORC_VAR_T4, ORC_VAR_T2,
+          ORC_VAR_D1, ORC_VAR_D1);
+      orc_program_append_2 (p, "mergewl", 0, ORC_VAR_D1, ORC_VAR_T3, ORC_VAR_T4,
+          ORC_VAR_D1);
+#endif
+
+      orc_program_compile (p);
+      c = orc_program_take_code (p);
+      orc_program_free (p);
+    }
+    p_inited = TRUE;
+    orc_once_mutex_unlock ();
+  }
+  ex->arrays[ORC_VAR_A2] = c;
+  ex->program = 0;
+
+  ex->n = n;
+  ex->arrays[ORC_VAR_D1] = d1;
+  ex->arrays[ORC_VAR_S1] = (void *) s1;
+  {
+    orc_union32 tmp;
+    tmp.f = p1;
+    ex->params[ORC_VAR_P1] = tmp.i;
+  }
+  {
+    orc_union32 tmp;
+    tmp.f = p2;
+    ex->params[ORC_VAR_P2] = tmp.i;
+  }
+
+  func = c->exec;
+  func (ex);
+}
+#endif
+
+
+/* audiomixer_orc_remix_stereo_mono_s16 */
+#ifdef DISABLE_ORC
+void
+audiomixer_orc_remix_stereo_mono_s16 (gint16 * ORC_RESTRICT d1,
+    const gint16 * ORC_RESTRICT s1, float p1, float p2, int n)
+{
+  int i;
+  orc_union16 *ORC_RESTRICT ptr0;
+  const orc_union32 *ORC_RESTRICT ptr4;
+  orc_union32 var36;
+  orc_union32 var37;
+  orc_union32 var38;
+  orc_union16 var39;
+  orc_union16 var40;
+  orc_union16 var41;
+  orc_union32 var42;
+  orc_union32 var43;
+  orc_union32 var44;
+  orc_union32 var45;
+  orc_union32 var46;
+  orc_union32 var47;
+  orc_union32 var48;
+  orc_union32 var49;
+
+  ptr0 = (orc_union16 *) d1;
+  ptr4 = (orc_union32 *) s1;
+
+  /* 4: loadpl */
+  var37.f = p1;
+  /* 8: loadpl */
+  var38.f = p2;
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadl */
+    var36 = ptr4[i];
+    /* 1: splitlw */
+    {
+      orc_union32 _src;
+      _src.i = var36.i;
+      var40.i = _src.x2[1];
+      var41.i = _src.x2[0];
+    }
+    /* 2: convswl */
+    var42.i = var41.i;
+    /* 3: convlf */
+    var43.f = var42.i;
+    /* 5: mulf */
+    {
+      orc_union32 _src1;
+      orc_union32 _src2;
+      orc_union32 _dest1;
+      _src1.i = ORC_DENORMAL (var43.i);
+      _src2.i = ORC_DENORMAL (var37.i);
+      _dest1.f = _src1.f * _src2.f;
+      var44.i = ORC_DENORMAL (_dest1.i);
+    }
+    /* 6: convswl */
+    var45.i = var40.i;
+    /* 7: convlf */
+    var46.f = var45.i;
+    /* 9: mulf */
+    {
+      orc_union32 _src1;
+      orc_union32 _src2;
+      orc_union32 _dest1;
+      _src1.i = ORC_DENORMAL (var46.i);
+      _src2.i = ORC_DENORMAL (var38.i);
+      _dest1.f = _src1.f * _src2.f;
+      var47.i = ORC_DENORMAL (_dest1.i);
+    }
+    /* 10: addf */
+    {
+      orc_union32 _src1;
+      orc_union32 _src2;
+      orc_union32 _dest1;
+      _src1.i = ORC_DENORMAL (var44.i);
+      _src2.i = ORC_DENORMAL (var47.i);
+      _dest1.f = _src1.f + _src2.f;
+      var48.i = ORC_DENORMAL (_dest1.i);
+    }
+    /* 11: convfl */
+    {
+      int tmp;
+      tmp = (int) var48.f;
+      if (tmp == 0x80000000 && !(var48.i & 0x80000000))
+        tmp = 0x7fffffff;
+      var49.i = tmp;
+    }
+    /* 12: convssslw */
+    var39.i = ORC_CLAMP_SW (var49.i);
+    /* 13: storew */
+    ptr0[i] = var39;
+  }
+
+}
+
+#else
+static void
+_backup_audiomixer_orc_remix_stereo_mono_s16 (OrcExecutor * ORC_RESTRICT ex)
+{
+  int i;
+  int n = ex->n;
+  orc_union16 *ORC_RESTRICT ptr0;
+  const orc_union32 *ORC_RESTRICT ptr4;
+  orc_union32 var36;
+  orc_union32 var37;
+  orc_union32 var38;
+  orc_union16 var39;
+  orc_union16 var40;
+  orc_union16 var41;
+  orc_union32 var42;
+  orc_union32 var43;
+  orc_union32 var44;
+  orc_union32 var45;
+  orc_union32 var46;
+  orc_union32 var47;
+  orc_union32 var48;
+  orc_union32 var49;
+
+  ptr0 = (orc_union16 *) ex->arrays[0];
+  ptr4 = (orc_union32 *) ex->arrays[4];
+
+  /* 4: loadpl */
+  var37.i = ex->params[24];
+  /* 8: loadpl */
+  var38.i = ex->params[25];
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadl */
+    var36 = ptr4[i];
+    /* 1: splitlw */
+    {
+      orc_union32 _src;
+      _src.i = var36.i;
+      var40.i = _src.x2[1];
+      var41.i = _src.x2[0];
+    }
+    /* 2: convswl */
+    var42.i = var41.i;
+    /* 3: convlf */
+    var43.f = var42.i;
+    /* 5: mulf */
+    {
+      orc_union32 _src1;
+      orc_union32 _src2;
+      orc_union32 _dest1;
+      _src1.i = ORC_DENORMAL (var43.i);
+      _src2.i = ORC_DENORMAL (var37.i);
+      _dest1.f = _src1.f * _src2.f;
+      var44.i = ORC_DENORMAL (_dest1.i);
+    }
+    /* 6: convswl */
+    var45.i = var40.i;
+    /* 7: convlf */
+    var46.f = var45.i;
+    /* 9: mulf */
+    {
+      orc_union32 _src1;
+      orc_union32 _src2;
+      orc_union32 _dest1;
+      _src1.i = ORC_DENORMAL (var46.i);
+      _src2.i = ORC_DENORMAL (var38.i);
+      _dest1.f = _src1.f * _src2.f;
+      var47.i = ORC_DENORMAL (_dest1.i);
+    }
+    /* 10: addf */
+    {
+      orc_union32 _src1;
+      orc_union32 _src2;
+      orc_union32 _dest1;
+      _src1.i = ORC_DENORMAL (var44.i);
+      _src2.i = ORC_DENORMAL (var47.i);
+      _dest1.f = _src1.f + _src2.f;
+      var48.i = ORC_DENORMAL (_dest1.i);
+    }
+    /* 11: convfl */
+    {
+      int tmp;
+      tmp = (int) var48.f;
+      if (tmp == 0x80000000 && !(var48.i & 0x80000000))
+        tmp = 0x7fffffff;
+      var49.i = tmp;
+    }
+    /* 12: convssslw */
+    var39.i = ORC_CLAMP_SW (var49.i);
+    /* 13: storew */
+    ptr0[i] = var39;
+  }
+
+}
+
+void
+audiomixer_orc_remix_stereo_mono_s16 (gint16 * ORC_RESTRICT d1,
+    const gint16 * ORC_RESTRICT s1, float p1, float p2, int n)
+{
+  OrcExecutor _ex, *ex = &_ex;
+  static volatile int p_inited = 0;
+  static OrcCode *c = 0;
+  void (*func) (OrcExecutor *);
+
+  if (!p_inited) {
+    orc_once_mutex_lock ();
+    if (!p_inited) {
+      OrcProgram *p;
+
+#if 1
+      static const orc_uint8 bc[] = {
+        1, 9, 36, 97, 117, 100, 105, 111, 109, 105, 120, 101, 114, 95, 111, 114,
+        99, 95, 114, 101, 109, 105, 120, 95, 115, 116, 101, 114, 101, 111, 95,
+        109,
+        111, 110, 111, 95, 115, 49, 54, 11, 2, 2, 12, 4, 4, 17, 4, 17,
+        4, 20, 2, 20, 2, 20, 4, 20, 4, 198, 33, 32, 4, 153, 34, 32,
+        211, 34, 34, 202, 34, 34, 24, 153, 35, 33, 211, 35, 35, 202, 35, 35,
+        25, 200, 34, 34, 35, 210, 34, 34, 165, 0, 34, 2, 0,
+      };
+      p = orc_program_new_from_static_bytecode (bc);
+      orc_program_set_backup_function (p,
+          _backup_audiomixer_orc_remix_stereo_mono_s16);
+#else
+      p = orc_program_new ();
+      orc_program_set_name (p, "audiomixer_orc_remix_stereo_mono_s16");
+      orc_program_set_backup_function (p,
+          _backup_audiomixer_orc_remix_stereo_mono_s16);
+      orc_program_add_destination (p, 2, "d1");
+      orc_program_add_source (p, 4, "s1");
+      orc_program_add_parameter_float (p, 4, "p1");
+      orc_program_add_parameter_float (p, 4, "p2");
+      orc_program_add_temporary (p, 2, "t1");
+      orc_program_add_temporary (p, 2, "t2");
+      orc_program_add_temporary (p, 4, "t3");
+      orc_program_add_temporary (p, 4, "t4");
+
+      orc_program_append_2 (p, "splitlw", 0, ORC_VAR_T2, ORC_VAR_T1, ORC_VAR_S1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convswl", 0, ORC_VAR_T3, ORC_VAR_T1, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convlf", 0, ORC_VAR_T3, ORC_VAR_T3, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "mulf", 0, ORC_VAR_T3, ORC_VAR_T3, ORC_VAR_P1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convswl", 0, ORC_VAR_T4, ORC_VAR_T2, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convlf", 0, ORC_VAR_T4, ORC_VAR_T4, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "mulf", 0, ORC_VAR_T4, ORC_VAR_T4, ORC_VAR_P2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "addf", 0, ORC_VAR_T3, ORC_VAR_T3, ORC_VAR_T4,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convfl", 0, ORC_VAR_T3, ORC_VAR_T3, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convssslw", 0, ORC_VAR_D1, ORC_VAR_T3,
+          ORC_VAR_D1, ORC_VAR_D1);
+#endif
+
+      orc_program_compile (p);
+      c = orc_program_take_code (p);
+      orc_program_free (p);
+    }
+    p_inited = TRUE;
+    orc_once_mutex_unlock ();
+  }
+  ex->arrays[ORC_VAR_A2] = c;
+  ex->program = 0;
+
+  ex->n = n;
+  ex->arrays[ORC_VAR_D1] = d1;
+  ex->arrays[ORC_VAR_S1] = (void *) s1;
+  {
+    orc_union32 tmp;
+    tmp.f = p1;
+    ex->params[ORC_VAR_P1] = tmp.i;
+  }
+  {
+    orc_union32 tmp;
+    tmp.f = p2;
+    ex->params[ORC_VAR_P2] = tmp.i;
+  }
+
+  func = c->exec;
+  func (ex);
+}
+#endif
+
+
+/* audiomixer_orc_remix_mono_stereo_f32 */
+#ifdef DISABLE_ORC
+void
+audiomixer_orc_remix_mono_stereo_f32 (float *ORC_RESTRICT d1,
+    const float *ORC_RESTRICT s1, float p1, float p2, int n)
+{
+  int i;
+  orc_union64 *ORC_RESTRICT ptr0;
+  const orc_union32 *ORC_RESTRICT ptr4;
+  orc_union32 var35;
+  orc_union32 var36;
+  orc_union64 var37;
+  orc_union32 var38;
+  orc_union32 var39;
+  orc_union32 var40;
+
+  ptr0 = (orc_union64 *) d1;
+  ptr4 = (orc_union32 *) s1;
+
+  /* 1: loadpl */
+  var35.f = p1;
+  /* 3: loadpl */
+  var36.f = p2;
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadl */
+    var38 = ptr4[i];
+    /* 2: mulf */
+    {
+      orc_union32 _src1;
+      orc_union32 _src2;
+      orc_union32 _dest1;
+      _src1.i = ORC_DENORMAL (var38.i);
+      _src2.i = ORC_DENORMAL (var35.i);
+      _dest1.f = _src1.f * _src2.f;
+      var39.i = ORC_DENORMAL (_dest1.i);
+    }
+    /* 4: mulf */
+    {
+      orc_union32 _src1;
+      orc_union32 _src2;
+      orc_union32 _dest1;
+      _src1.i = ORC_DENORMAL (var38.i);
+      _src2.i = ORC_DENORMAL (var36.i);
+      _dest1.f = _src1.f * _src2.f;
+      var40.i = ORC_DENORMAL (_dest1.i);
+    }
+    /* 5: mergelq */
+    {
+      orc_union64 _dest;
+      _dest.x2[0] = var39.i;
+      _dest.x2[1] = var40.i;
+      var37.i = _dest.i;
+    }
+    /* 6: storeq */
+    ptr0[i] = var37;
+  }
+
+}
+
+#else
+static void
+_backup_audiomixer_orc_remix_mono_stereo_f32 (OrcExecutor * ORC_RESTRICT ex)
+{
+  int i;
+  int n = ex->n;
+  orc_union64 *ORC_RESTRICT ptr0;
+  const orc_union32 *ORC_RESTRICT ptr4;
+  orc_union32 var35;
+  orc_union32 var36;
+  orc_union64 var37;
+  orc_union32 var38;
+  orc_union32 var39;
+  orc_union32 var40;
+
+  ptr0 = (orc_union64 *) ex->arrays[0];
+  ptr4 = (orc_union32 *) ex->arrays[4];
+
+  /* 1: loadpl */
+  var35.i = ex->params[24];
+  /* 3: loadpl */
+  var36.i = ex->params[25];
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadl */
+    var38 = ptr4[i];
+    /* 2: mulf */
+    {
+      orc_union32 _src1;
+      orc_union32 _src2;
+      orc_union32 _dest1;
+      _src1.i = ORC_DENORMAL (var38.i);
+      _src2.i = ORC_DENORMAL (var35.i);
+      _dest1.f = _src1.f * _src2.f;
+      var39.i = ORC_DENORMAL (_dest1.i);
+    }
+    /* 4: mulf */
+    {
+      orc_union32 _src1;
+      orc_union32 _src2;
+      orc_union32 _dest1;
+      _src1.i = ORC_DENORMAL (var38.i);
+      _src2.i = ORC_DENORMAL (var36.i);
+      _dest1.f = _src1.f * _src2.f;
+      var40.i = ORC_DENORMAL (_dest1.i);
+    }
+    /* 5: mergelq */
+    {
+      orc_union64 _dest;
+      _dest.x2[0] = var39.i;
+      _dest.x2[1] = var40.i;
+      var37.i = _dest.i;
+    }
+    /* 6: storeq */
+    ptr0[i] = var37;
+  }
+
+}
+
+void
+audiomixer_orc_remix_mono_stereo_f32 (float *ORC_RESTRICT d1,
+    const float *ORC_RESTRICT s1, float p1, float p2, int n)
+{
+  OrcExecutor _ex, *ex = &_ex;
+  static volatile int p_inited = 0;
+  static OrcCode *c = 0;
+  void (*func) (OrcExecutor *);
+
+  if (!p_inited) {
+    orc_once_mutex_lock ();
+    if (!p_inited) {
+      OrcProgram *p;
+
+#if 1
+      static const orc_uint8 bc[] = {
+        1, 9, 36, 97, 117, 100, 105, 111, 109, 105, 120, 101, 114, 95, 111, 114,
+        99, 95, 114, 101, 109, 105, 120, 95, 109, 111, 110, 111, 95, 115, 116,
+        101,
+        114, 101, 111, 95, 102, 51, 50, 11, 8, 8, 12, 4, 4, 17, 4, 17,
+        4, 20, 4, 20, 4, 20, 4, 113, 32, 4, 202, 33, 32, 24, 202, 34,
+        32, 25, 194, 0, 33, 34, 2, 0,
+      };
+      p = orc_program_new_from_static_bytecode (bc);
+      orc_program_set_backup_function (p,
+          _backup_audiomixer_orc_remix_mono_stereo_f32);
+#else
+      p = orc_program_new ();
+      orc_program_set_name (p, "audiomixer_orc_remix_mono_stereo_f32");
+      orc_program_set_backup_function (p,
+          _backup_audiomixer_orc_remix_mono_stereo_f32);
+      orc_program_add_destination (p, 8, "d1");
+      orc_program_add_source (p, 4, "s1");
+      orc_program_add_parameter_float (p, 4, "p1");
+      orc_program_add_parameter_float (p, 4, "p2");
+      orc_program_add_temporary (p, 4, "t1");
+      orc_program_add_temporary (p, 4, "t2");
+      orc_program_add_temporary (p, 4, "t3");
+
+      orc_program_append_2 (p, "loadl", 0, ORC_VAR_T1, ORC_VAR_S1, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "mulf", 0, ORC_VAR_T2, ORC_VAR_T1, ORC_VAR_P1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "mulf", 0, ORC_VAR_T3, ORC_VAR_T1, ORC_VAR_P2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "mergelq", 0, ORC_VAR_D1, ORC_VAR_T2, ORC_VAR_T3,
+          ORC_VAR_D1);
+#endif
+
+      orc_program_compile (p);
+      c = orc_program_take_code (p);
+      orc_program_free (p);
+    }
+    p_inited = TRUE;
+    orc_once_mutex_unlock ();
+  }
+  ex->arrays[ORC_VAR_A2] = c;
+  ex->program = 0;
+
+  ex->n = n;
+  ex->arrays[ORC_VAR_D1] = d1;
+  ex->arrays[ORC_VAR_S1] = (void *) s1;
+  {
+    orc_union32 tmp;
+    tmp.f = p1;
+    ex->params[ORC_VAR_P1] = tmp.i;
+  }
+  {
+    orc_union32 tmp;
+    tmp.f = p2;
+    ex->params[ORC_VAR_P2] = tmp.i;
+  }
+
+  func = c->exec;
+  func (ex);
+}
+#endif
+
+
+/* audiomixer_orc_remix_stereo_mono_f32 */
+#ifdef DISABLE_ORC
+void
+audiomixer_orc_remix_stereo_mono_f32 (float *ORC_RESTRICT d1,
+    const float *ORC_RESTRICT s1, float p1, float p2, int n)
+{
+  int i;
+  orc_union32 *ORC_RESTRICT ptr0;
+  const orc_union64 *ORC_RESTRICT ptr4;
+  orc_union64 var34;
+  orc_union32 var35;
+  orc_union32 var36;
+  orc_union32 var37;
+  orc_union32 var38;
+  orc_union32 var39;
+  orc_union32 var40;
+  orc_union32 var41;
+
+  ptr0 = (orc_union32 *) d1;
+  ptr4 = (orc_union64 *) s1;
+
+  /* 2: loadpl */
+  var35.f = p1;
+  /* 4: loadpl */
+  var36.f = p2;
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadq */
+    var34 = ptr4[i];
+    /* 1: splitql */
+    {
+      orc_union64 _src;
+      _src.i = var34.i;
+      var38.i = _src.x2[1];
+      var39.i = _src.x2[0];
+    }
+    /* 3: mulf */
+    {
+      orc_union32 _src1;
+      orc_union32 _src2;
+      orc_union32 _dest1;
+      _src1.i = ORC_DENORMAL (var39.i);
+      _src2.i = ORC_DENORMAL (var35.i);
+      _dest1.f = _src1.f * _src2.f;
+      var40.i = ORC_DENORMAL (_dest1.i);
+    }
+    /* 5: mulf */
+    {
+      orc_union32 _src1;
+      orc_union32 _src2;
+      orc_union32 _dest1;
+      _src1.i = ORC_DENORMAL (var38.i);
+      _src2.i = ORC_DENORMAL (var36.i);
+      _dest1.f = _src1.f * _src2.f;
+      var41.i = ORC_DENORMAL (_dest1.i);
+    }
+    /* 6: addf */
+    {
+      orc_union32 _src1;
+      orc_union32 _src2;
+      orc_union32 _dest1;
+      _src1.i = ORC_DENORMAL (var40.i);
+      _src2.i = ORC_DENORMAL (var41.i);
+      _dest1.f = _src1.f + _src2.f;
+      var37.i = ORC_DENORMAL (_dest1.i);
+    }
+    /* 7: storel */
+    ptr0[i] = var37;
+  }
+
+}
+
+#else
+static void
+_backup_audiomixer_orc_remix_stereo_mono_f32 (OrcExecutor * ORC_RESTRICT ex)
+{
+  int i;
+  int n = ex->n;
+  orc_union32 *ORC_RESTRICT ptr0;
+  const orc_union64 *ORC_RESTRICT ptr4;
+  orc_union64 var34;
+  orc_union32 var35;
+  orc_union32 var36;
+  orc_union32 var37;
+  orc_union32 var38;
+  orc_union32 var39;
+  orc_union32 var40;
+  orc_union32 var41;
+
+  ptr0 = (orc_union32 *) ex->arrays[0];
+  ptr4 = (orc_union64 *) ex->arrays[4];
+
+  /* 2: loadpl */
+  var35.i = ex->params[24];
+  /* 4: loadpl */
+  var36.i = ex->params[25];
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadq */
+    var34 = ptr4[i];
+    /* 1: splitql */
+    {
+      orc_union64 _src;
+      _src.i = var34.i;
+      var38.i = _src.x2[1];
+      var39.i = _src.x2[0];
+    }
+    /* 3: mulf */
+    {
+      orc_union32 _src1;
+      orc_union32 _src2;
+      orc_union32 _dest1;
+      _src1.i = ORC_DENORMAL (var39.i);
+      _src2.i = ORC_DENORMAL (var35.i);
+      _dest1.f = _src1.f * _src2.f;
+      var40.i = ORC_DENORMAL (_dest1.i);
+    }
+    /* 5: mulf */
+    {
+      orc_union32 _src1;
+      orc_union32 _src2;
+      orc_union32 _dest1;
+      _src1.i = ORC_DENORMAL (var38.i);
+      _src2.i = ORC_DENORMAL (var36.i);
+      _dest1.f = _src1.f * _src2.f;
+      var41.i = ORC_DENORMAL (_dest1.i);
+    }
+    /* 6: addf */
+    {
+      orc_union32 _src1;
+      orc_union32 _src2;
+      orc_union32 _dest1;
+      _src1.i = ORC_DENORMAL (var40.i);
+      _src2.i = ORC_DENORMAL (var41.i);
+      _dest1.f = _src1.f + _src2.f;
+      var37.i = ORC_DENORMAL (_dest1.i);
+    }
+    /* 7: storel */
+    ptr0[i] = var37;
+  }
+
+}
+
+void
+audiomixer_orc_remix_stereo_mono_f32 (float *ORC_RESTRICT d1,
+    const float *ORC_RESTRICT s1, float p1, float p2, int n)
+{
+  OrcExecutor _ex, *ex = &_ex;
+  static volatile int p_inited = 0;
+  static OrcCode *c = 0;
+  void (*func) (OrcExecutor *);
+
+  if (!p_inited) {
+    orc_once_mutex_lock ();
+    if (!p_inited) {
+      OrcProgram *p;
+
+#if 1
+      static const orc_uint8 bc[] = {
+        1, 9, 36, 97, 117, 100, 105, 111, 109, 105, 120, 101, 114, 95, 111, 114,
+        99, 95, 114, 101, 109, 105, 120, 95, 115, 116, 101, 114, 101, 111, 95,
+        109,
+        111, 110, 111, 95, 102, 51, 50, 11, 4, 4, 12, 8, 8, 17, 4, 17,
+        4, 20, 4, 20, 4, 197, 33, 32, 4, 202, 32, 32, 24, 202, 33, 33,
+        25, 200, 0, 32, 33, 2, 0,
+      };
+      p = orc_program_new_from_static_bytecode (bc);
+      orc_program_set_backup_function (p,
+          _backup_audiomixer_orc_remix_stereo_mono_f32);
+#else
+      p = orc_program_new ();
+      orc_program_set_name (p, "audiomixer_orc_remix_stereo_mono_f32");
+      orc_program_set_backup_function (p,
+          _backup_audiomixer_orc_remix_stereo_mono_f32);
+      orc_program_add_destination (p, 4, "d1");
+      orc_program_add_source (p, 8, "s1");
+      orc_program_add_parameter_float (p, 4, "p1");
+      orc_program_add_parameter_float (p, 4, "p2");
+      orc_program_add_temporary (p, 4, "t1");
+      orc_program_add_temporary (p, 4, "t2");
+
+      orc_program_append_2 (p, "splitql", 0, ORC_VAR_T2, ORC_VAR_T1, ORC_VAR_S1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "mulf", 0, ORC_VAR_T1, ORC_VAR_T1, ORC_VAR_P1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "mulf", 0, ORC_VAR_T2, ORC_VAR_T2, ORC_VAR_P2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "addf", 0, ORC_VAR_D1, ORC_VAR_T1, ORC_VAR_T2,
+          ORC_VAR_D1);
+#endif
+
+      orc_program_compile (p);
+      c = orc_program_take_code (p);
+      orc_program_free (p);
+    }
+    p_inited = TRUE;
+    orc_once_mutex_unlock ();
+  }
+  ex->arrays[ORC_VAR_A2] = c;
+  ex->program = 0;
+
+  ex->n = n;
+  ex->arrays[ORC_VAR_D1] = d1;
+  ex->arrays[ORC_VAR_S1] = (void *) s1;
+  {
+    orc_union32 tmp;
+    tmp.f = p1;
+    ex->params[ORC_VAR_P1] = tmp.i;
+  }
+  {
+    orc_union32 tmp;
+    tmp.f = p2;
+    ex->params[ORC_VAR_P2] = tmp.i;
+  }
+
+  func = c->exec;
+  func (ex);
+}
+#endif
+
+
+/* audiomixer_orc_remix_5p1_stereo_s16 */
+#ifdef DISABLE_ORC
+void
+audiomixer_orc_remix_5p1_stereo_s16 (gint16 * ORC_RESTRICT d1, int d1_stride,
+    const gint16 * ORC_RESTRICT s1, int s1_stride,
+    const gint16 * ORC_RESTRICT s2, int s2_stride,
+    const gint16 * ORC_RESTRICT s3, int s3_stride, float p1, float p2, float p3,
+    float p4, int n, int m)
+{
+  int i;
+  int j;
+  orc_union32 *ORC_RESTRICT ptr0;
+  const orc_union32 *ORC_RESTRICT ptr4;
+  const orc_union32 *ORC_RESTRICT ptr5;
+  const orc_union32 *ORC_RESTRICT ptr6;
+  orc_union32 var43;
+  orc_union32 var44;
+  orc_union32 var45;
+  orc_union32 var46;
+  orc_union32 var47;
+  orc_union32 var48;
+  orc_union32 var49;
+  orc_union32 var50;
+  orc_union32 var51;
+  orc_union32 var52;
+  orc_union16 var53;
+  orc_union16 var54;
+  orc_union32 var55;
+  orc_union32 var56;
+  orc_union32 var57;
+  orc_union32 var58;
+  orc_union16 var59;
+  orc_union16 var60;
+  orc_union32 var61;
+  orc_union32 var62;
+  orc_union32 var63;
+  orc_union32 var64;
+  orc_union16 var65;
+  orc_union16 var66;
+  orc_union32 var67;
+  orc_union32 var68;
+  orc_union32 var69;
+  orc_union32 var70;
+  orc_union32 var71;
+  orc_union32 var72;
+  orc_union32 var73;
+  orc_union32 var74;
+  orc_union32 var75;
+  orc_union32 var76;
+  orc_union32 var77;
+  orc_union32 var78;
+  orc_union16 var79;
+  orc_union32 var80;
+  orc_union32 var81;
+  orc_union32 var82;
+  orc_union32 var83;
+  orc_union32 var84;
+  orc_union32 var85;
+  orc_union16 var86;
+
+  for (j = 0; j < m; j++) {
+    ptr0 = ORC_PTR_OFFSET (d1, d1_stride * j);
+    ptr4 = ORC_PTR_OFFSET (s1, s1_stride * j);
+    ptr5 = ORC_PTR_OFFSET (s2, s2_stride * j);
+    ptr6 = ORC_PTR_OFFSET (s3, s3_stride * j);
+
+    /* 18: loadpl */
+    var46.f = p2;
+    /* 20: loadpl */
+    var47.f = p3;
+    /* 22: loadpl */
+    var48.f = p1;
+    /* 26: loadpl */
+    var49.f = p4;
+    /* 31: loadpl */
+    var50.f = p1;
+    /* 35: loadpl */
+    var51.f = p4;
+
+    for (i = 0; i < n; i++) {
+      /* 0: loadl */
+      var43 = ptr4[i];
+      /* 1: splitlw */
+      {
+        orc_union32 _src;
+        _src.i = var43.i;
+        var53.i = _src.x2[1];
+        var54.i = _src.x2[0];
+      }
+      /* 2: convswl */
+      var55.i = var54.i;
+      /* 3: convlf */
+      var56.f = var55.i;
+      /* 4: convswl */
+      var57.i = var53.i;
+      /* 5: convlf */
+      var58.f = var57.i;
+      /* 6: loadl */
+      var44 = ptr5[i];
+      /* 7: splitlw */
+      {
+        orc_union32 _src;
+        _src.i = var44.i;
+        var59.i = _src.x2[1];
+        var60.i = _src.x2[0];
+      }
+      /* 8: convswl */
+      var61.i = var60.i;
+      /* 9: convlf */
+      var62.f = var61.i;
+      /* 10: convswl */
+      var63.i = var59.i;
+      /* 11: convlf */
+      var64.f = var63.i;
+      /* 12: loadl */
+      var45 = ptr6[i];
+      /* 13: splitlw */
+      {
+        orc_union32 _src;
+        _src.i = var45.i;
+        var65.i = _src.x2[1];
+        var66.i = _src.x2[0];
+      }
+      /* 14: convswl */
+      var67.i = var66.i;
+      /* 15: convlf */
+      var68.f = var67.i;
+      /* 16: convswl */
+      var69.i = var65.i;
+      /* 17: convlf */
+      var70.f = var69.i;
+      /* 19: mulf */
+      {
+        orc_union32 _src1;
+        orc_union32 _src2;
+        orc_union32 _dest1;
+        _src1.i = ORC_DENORMAL (var62.i);
+        _src2.i = ORC_DENORMAL (var46.i);
+        _dest1.f = _src1.f * _src2.f;
+        var71.i = ORC_DENORMAL (_dest1.i);
+      }
+      /* 21: mulf */
+      {
+        orc_union32 _src1;
+        orc_union32 _src2;
+        orc_union32 _dest1;
+        _src1.i = ORC_DENORMAL (var64.i);
+        _src2.i = ORC_DENORMAL (var47.i);
+        _dest1.f = _src1.f * _src2.f;
+        var72.i = ORC_DENORMAL (_dest1.i);
+      }
+      /* 23: mulf */
+      {
+        orc_union32 _src1;
+        orc_union32 _src2;
+        orc_union32 _dest1;
+        _src1.i = ORC_DENORMAL (var56.i);
+        _src2.i = ORC_DENORMAL (var48.i);
+        _dest1.f = _src1.f * _src2.f;
+        var73.i = ORC_DENORMAL (_dest1.i);
+      }
+      /* 24: addf */
+      {
+        orc_union32 _src1;
+        orc_union32 _src2;
+        orc_union32 _dest1;
+        _src1.i = ORC_DENORMAL (var73.i);
+        _src2.i = ORC_DENORMAL (var71.i);
+        _dest1.f = _src1.f + _src2.f;
+        var74.i = ORC_DENORMAL (_dest1.i);
+      }
+      /* 25: addf */
+      {
+        orc_union32 _src1;
+        orc_union32 _src2;
+        orc_union32 _dest1;
+        _src1.i = ORC_DENORMAL (var74.i);
+        _src2.i = ORC_DENORMAL (var72.i);
+        _dest1.f = _src1.f + _src2.f;
+        var75.i = ORC_DENORMAL (_dest1.i);
+      }
+      /* 27: mulf */
+      {
+        orc_union32 _src1;
+        orc_union32 _src2;
+        orc_union32 _dest1;
+        _src1.i = ORC_DENORMAL (var68.i);
+        _src2.i = ORC_DENORMAL (var49.i);
+        _dest1.f = _src1.f * _src2.f;
+        var76.i = ORC_DENORMAL (_dest1.i);
+      }
+      /* 28: addf */
+      {
+        orc_union32 _src1;
+        orc_union32 _src2;
+        orc_union32 _dest1;
+        _src1.i = ORC_DENORMAL (var75.i);
+        _src2.i = ORC_DENORMAL (var76.i);
+        _dest1.f = _src1.f + _src2.f;
+        var77.i = ORC_DENORMAL (_dest1.i);
+      }
+      /* 29: convfl */
+      {
+        int tmp;
+        tmp = (int) var77.f;
+        if (tmp == 0x80000000 && !(var77.i & 0x80000000))
+          tmp = 0x7fffffff;
+        var78.i = tmp;
+      }
+      /* 30: convssslw */
+      var79.i = ORC_CLAMP_SW (var78.i);
+      /* 32: mulf */
+      {
+        orc_union32 _src1;
+        orc_union32 _src2;
+        orc_union32 _dest1;
+        _src1.i = ORC_DENORMAL (var58.i);
+        _src2.i = ORC_DENORMAL (var50.i);
+        _dest1.f = _src1.f * _src2.f;
+        var80.i = ORC_DENORMAL (_dest1.i);
+      }
+      /* 33: addf */
+      {
+        orc_union32 _src1;
+        orc_union32 _src2;
+        orc_union32 _dest1;
+        _src1.i = ORC_DENORMAL (var80.i);
+        _src2.i = ORC_DENORMAL (var71.i);
+        _dest1.f = _src1.f + _src2.f;
+        var81.i = ORC_DENORMAL (_dest1.i);
+      }
+      /* 34: addf */
+      {
+        orc_union32 _src1;
+        orc_union32 _src2;
+        orc_union32 _dest1;
+        _src1.i = ORC_DENORMAL (var81.i);
+        _src2.i = ORC_DENORMAL (var72.i);
+        _dest1.f = _src1.f + _src2.f;
+        var82.i = ORC_DENORMAL (_dest1.i);
+      }
+      /* 36: mulf */
+      {
+        orc_union32 _src1;
+        orc_union32 _src2;
+        orc_union32 _dest1;
+        _src1.i = ORC_DENORMAL (var70.i);
+        _src2.i = ORC_DENORMAL (var51.i);
+        _dest1.f = _src1.f * _src2.f;
+        var83.i = ORC_DENORMAL (_dest1.i);
+      }
+      /* 37: addf */
+      {
+        orc_union32 _src1;
+        orc_union32 _src2;
+        orc_union32 _dest1;
+        _src1.i = ORC_DENORMAL (var82.i);
+        _src2.i = ORC_DENORMAL (var83.i);
+        _dest1.f = _src1.f + _src2.f;
+        var84.i = ORC_DENORMAL (_dest1.i);
+      }
+      /* 38: convfl */
+      {
+        int tmp;
+        tmp = (int) var84.f;
+        if (tmp == 0x80000000 && !(var84.i & 0x80000000))
+          tmp = 0x7fffffff;
+        var85.i = tmp;
+      }
+      /* 39: convssslw */
+      var86.i = ORC_CLAMP_SW (var85.i);
+      /* 40: mergewl */
+      {
+        orc_union32 _dest;
+        _dest.x2[0] = var79.i;
+        _dest.x2[1] = var86.i;
+        var52.i = _dest.i;
+      }
+      /* 41: storel */
+      ptr0[i] = var52;
+    }
+  }
+
+}
+
+#else
+static void
+_backup_audiomixer_orc_remix_5p1_stereo_s16 (OrcExecutor * ORC_RESTRICT ex)
+{
+  int i;
+  int j;
+  int n = ex->n;
+  int m = ex->params[ORC_VAR_A1];
+  orc_union32 *ORC_RESTRICT ptr0;
+  const orc_union32 *ORC_RESTRICT ptr4;
+  const orc_union32 *ORC_RESTRICT ptr5;
+  const orc_union32 *ORC_RESTRICT ptr6;
+  orc_union32 var43;
+  orc_union32 var44;
+  orc_union32 var45;
+  orc_union32 var46;
+  orc_union32 var47;
+  orc_union32 var48;
+  orc_union32 var49;
+  orc_union32 var50;
+  orc_union32 var51;
+  orc_union32 var52;
+  orc_union16 var53;
+  orc_union16 var54;
+  orc_union32 var55;
+  orc_union32 var56;
+  orc_union32 var57;
+  orc_union32 var58;
+  orc_union16 var59;
+  orc_union16 var60;
+  orc_union32 var61;
+  orc_union32 var62;
+  orc_union32 var63;
+  orc_union32 var64;
+  orc_union16 var65;
+  orc_union16 var66;
+  orc_union32 var67;
+  orc_union32 var68;
+  orc_union32 var69;
+  orc_union32 var70;
+  orc_union32 var71;
+  orc_union32 var72;
+  orc_union32 var73;
+  orc_union32 var74;
+  orc_union32 var75;
+  orc_union32 var76;
+  orc_union32 var77;
+  orc_union32 var78;
+  orc_union16 var79;
+  orc_union32 var80;
+  orc_union32 var81;
+  orc_union32 var82;
+  orc_union32 var83;
+  orc_union32 var84;
+  orc_union32 var85;
+  orc_union16 var86;
+
+  for (j = 0; j < m; j++) {
+    ptr0 = ORC_PTR_OFFSET (ex->arrays[0], ex->params[0] * j);
+    ptr4 = ORC_PTR_OFFSET (ex->arrays[4], ex->params[4] * j);
+    ptr5 = ORC_PTR_OFFSET (ex->arrays[5], ex->params[5] * j);
+    ptr6 = ORC_PTR_OFFSET (ex->arrays[6], ex->params[6] * j);
+
+    /* 18: loadpl */
+    var46.i = ex->params[25];
+    /* 20: loadpl */
+    var47.i = ex->params[26];
+    /* 22: loadpl */
+    var48.i = ex->params[24];
+    /* 26: loadpl */
+    var49.i = ex->params[27];
+    /* 31: loadpl */
+    var50.i = ex->params[24];
+    /* 35: loadpl */
+    var51.i = ex->params[27];
+
+    for (i = 0; i < n; i++) {
+      /* 0: loadl */
+      var43 = ptr4[i];
+      /* 1: splitlw */
+      {
+        orc_union32 _src;
+        _src.i = var43.i;
+        var53.i = _src.x2[1];
+        var54.i = _src.x2[0];
+      }
+      /* 2: convswl */
+      var55.i = var54.i;
+      /* 3: convlf */
+      var56.f = var55.i;
+      /* 4: convswl */
+      var57.i = var53.i;
+      /* 5: convlf */
+      var58.f = var57.i;
+      /* 6: loadl */
+      var44 = ptr5[i];
+      /* 7: splitlw */
+      {
+        orc_union32 _src;
+        _src.i = var44.i;
+        var59.i = _src.x2[1];
+        var60.i = _src.x2[0];
+      }
+      /* 8: convswl */
+      var61.i = var60.i;
+      /* 9: convlf */
+      var62.f = var61.i;
+      /* 10: convswl */
+      var63.i = var59.i;
+      /* 11: convlf */
+      var64.f = var63.i;
+      /* 12: loadl */
+      var45 = ptr6[i];
+      /* 13: splitlw */
+      {
+        orc_union32 _src;
+        _src.i = var45.i;
+        var65.i = _src.x2[1];
+        var66.i = _src.x2[0];
+      }
+      /* 14: convswl */
+      var67.i = var66.i;
+      /* 15: convlf */
+      var68.f = var67.i;
+      /* 16: convswl */
+      var69.i = var65.i;
+      /* 17: convlf */
+      var70.f = var69.i;
+      /* 19: mulf */
+      {
+        orc_union32 _src1;
+        orc_union32 _src2;
+        orc_union32 _dest1;
+        _src1.i = ORC_DENORMAL (var62.i);
+        _src2.i = ORC_DENORMAL (var46.i);
+        _dest1.f = _src1.f * _src2.f;
+        var71.i = ORC_DENORMAL (_dest1.i);
+      }
+      /* 21: mulf */
+      {
+        orc_union32 _src1;
+        orc_union32 _src2;
+        orc_union32 _dest1;
+        _src1.i = ORC_DENORMAL (var64.i);
+        _src2.i = ORC_DENORMAL (var47.i);
+        _dest1.f = _src1.f * _src2.f;
+        var72.i = ORC_DENORMAL (_dest1.i);
+      }
+      /* 23: mulf */
+      {
+        orc_union32 _src1;
+        orc_union32 _src2;
+        orc_union32 _dest1;
+        _src1.i = ORC_DENORMAL (var56.i);
+        _src2.i = ORC_DENORMAL (var48.i);
+        _dest1.f = _src1.f * _src2.f;
+        var73.i = ORC_DENORMAL (_dest1.i);
+      }
+      /* 24: addf */
+      {
+        orc_union32 _src1;
+        orc_union32 _src2;
+        orc_union32 _dest1;
+        _src1.i = ORC_DENORMAL (var73.i);
+        _src2.i = ORC_DENORMAL (var71.i);
+        _dest1.f = _src1.f + _src2.f;
+        var74.i = ORC_DENORMAL (_dest1.i);
+      }
+      /* 25: addf */
+      {
+        orc_union32 _src1;
+        orc_union32 _src2;
+        orc_union32 _dest1;
+        _src1.i = ORC_DENORMAL (var74.i);
+        _src2.i = ORC_DENORMAL (var72.i);
+        _dest1.f = _src1.f + _src2.f;
+        var75.i = ORC_DENORMAL (_dest1.i);
+      }
+      /* 27: mulf */
+      {
+        orc_union32 _src1;
+        orc_union32 _src2;
+        orc_union32 _dest1;
+        _src1.i = ORC_DENORMAL (var68.i);
+        _src2.i = ORC_DENORMAL (var49.i);
+        _dest1.f = _src1.f * _src2.f;
+        var76.i = ORC_DENORMAL (_dest1.i);
+      }
+      /* 28: addf */
+      {
+        orc_union32 _src1;
+        orc_union32 _src2;
+        orc_union32 _dest1;
+        _src1.i = ORC_DENORMAL (var75.i);
+        _src2.i = ORC_DENORMAL (var76.i);
+        _dest1.f = _src1.f + _src2.f;
+        var77.i = ORC_DENORMAL (_dest1.i);
+      }
+      /* 29: convfl */
+      {
+        int tmp;
+        tmp = (int) var77.f;
+        if (tmp == 0x80000000 && !(var77.i & 0x80000000))
+          tmp = 0x7fffffff;
+        var78.i = tmp;
+      }
+      /* 30: convssslw */
+      var79.i = ORC_CLAMP_SW (var78.i);
+      /* 32: mulf */
+      {
+        orc_union32 _src1;
+        orc_union32 _src2;
+        orc_union32 _dest1;
+        _src1.i = ORC_DENORMAL (var58.i);
+        _src2.i = ORC_DENORMAL (var50.i);
+        _dest1.f = _src1.f * _src2.f;
+        var80.i = ORC_DENORMAL (_dest1.i);
+      }
+      /* 33: addf */
+      {
+        orc_union32 _src1;
+        orc_union32 _src2;
+        orc_union32 _dest1;
+        _src1.i = ORC_DENORMAL (var80.i);
+        _src2.i = ORC_DENORMAL (var71.i);
+        _dest1.f = _src1.f + _src2.f;
+        var81.i = ORC_DENORMAL (_dest1.i);
+      }
+      /* 34: addf */
+      {
+        orc_union32 _src1;
+        orc_union32 _src2;
+        orc_union32 _dest1;
+        _src1.i = ORC_DENORMAL (var81.i);
+        _src2.i = ORC_DENORMAL (var72.i);
+        _dest1.f = _src1.f + _src2.f;
+        var82.i = ORC_DENORMAL (_dest1.i);
+      }
+      /* 36: mulf */
+      {
+        orc_union32 _src1;
+        orc_union32 _src2;
+        orc_union32 _dest1;
+        _src1.i = ORC_DENORMAL (var70.i);
+        _src2.i = ORC_DENORMAL (var51.i);
+        _dest1.f = _src1.f * _src2.f;
+        var83.i = ORC_DENORMAL (_dest1.i);
+      }
+      /* 37: addf */
+      {
+        orc_union32 _src1;
+        orc_union32 _src2;
+        orc_union32 _dest1;
+        _src1.i = ORC_DENORMAL (var82.i);
+        _src2.i = ORC_DENORMAL (var83.i);
+        _dest1.f = _src1.f + _src2.f;
+        var84.i = ORC_DENORMAL (_dest1.i);
+      }
+      /* 38: convfl */
+      {
+        int tmp;
+        tmp = (int) var84.f;
+        if (tmp == 0x80000000 && !(var84.i & 0x80000000))
+          tmp = 0x7fffffff;
+        var85.i = tmp;
+      }
+      /* 39: convssslw */
+      var86.i = ORC_CLAMP_SW (var85.i);
+      /* 40: mergewl */
+      {
+        orc_union32 _dest;
+        _dest.x2[0] = var79.i;
+        _dest.x2[1] = var86.i;
+        var52.i = _dest.i;
+      }
+      /* 41: storel */
+      ptr0[i] = var52;
+    }
+  }
+
+}
+
+void
+audiomixer_orc_remix_5p1_stereo_s16 (gint16 * ORC_RESTRICT d1, int d1_stride,
+    const gint16 * ORC_RESTRICT s1, int s1_stride,
+    const gint16 * ORC_RESTRICT s2, int s2_stride,
+    const gint16 * ORC_RESTRICT s3, int s3_stride, float p1, float p2, float p3,
+    float p4, int n, int m)
+{
+  OrcExecutor _ex, *ex = &_ex;
+  static volatile int p_inited = 0;
+  static OrcCode *c = 0;
+  void (*func) (OrcExecutor *);
+
+  if (!p_inited) {
+    orc_once_mutex_lock ();
+    if (!p_inited) {
+      OrcProgram *p;
+
+#if 1
+      static const orc_uint8 bc[] = {
+        1, 7, 9, 35, 97, 117, 100, 105, 111, 109, 105, 120, 101, 114, 95, 111,
+        114, 99, 95, 114, 101, 109, 105, 120, 95, 53, 112, 49, 95, 115, 116,
+        101,
+        114, 101, 111, 95, 115, 49, 54, 11, 4, 4, 12, 4, 4, 12, 4, 4,
+        12, 4, 4, 17, 4, 17, 4, 17, 4, 17, 4, 20, 2, 20, 2, 20,
+        4, 20, 4, 20, 4, 20, 4, 20, 4, 20, 4, 20, 4, 20, 2, 20,
+        2, 198, 33, 32, 4, 153, 34, 32, 211, 34, 34, 153, 35, 33, 211, 35,
+        35, 198, 33, 32, 5, 153, 36, 32, 211, 36, 36, 153, 37, 33, 211, 37,
+        37, 198, 33, 32, 6, 153, 38, 32, 211, 38, 38, 153, 39, 33, 211, 39,
+        39, 202, 36, 36, 25, 202, 37, 37, 26, 202, 40, 34, 24, 200, 40, 40,
+        36, 200, 40, 40, 37, 202, 38, 38, 27, 200, 40, 40, 38, 210, 40, 40,
+        165, 41, 40, 202, 40, 35, 24, 200, 40, 40, 36, 200, 40, 40, 37, 202,
+        39, 39, 27, 200, 40, 40, 39, 210, 40, 40, 165, 42, 40, 195, 0, 41,
+        42, 2, 0,
+      };
+      p = orc_program_new_from_static_bytecode (bc);
+      orc_program_set_backup_function (p,
+          _backup_audiomixer_orc_remix_5p1_stereo_s16);
+#else
+      p = orc_program_new ();
+      orc_program_set_2d (p);
+      orc_program_set_name (p, "audiomixer_orc_remix_5p1_stereo_s16");
+      orc_program_set_backup_function (p,
+          _backup_audiomixer_orc_remix_5p1_stereo_s16);
+      orc_program_add_destination (p, 4, "d1");
+      orc_program_add_source (p, 4, "s1");
+      orc_program_add_source (p, 4, "s2");
+      orc_program_add_source (p, 4, "s3");
+      orc_program_add_parameter_float (p, 4, "p1");
+      orc_program_add_parameter_float (p, 4, "p2");
+      orc_program_add_parameter_float (p, 4, "p3");
+      orc_program_add_parameter_float (p, 4, "p4");
+      orc_program_add_temporary (p, 2, "t1");
+      orc_program_add_temporary (p, 2, "t2");
+      orc_program_add_temporary (p, 4, "t3");
+      orc_program_add_temporary (p, 4, "t4");
+      orc_program_add_temporary (p, 4, "t5");
+      orc_program_add_temporary (p, 4, "t6");
+      orc_program_add_temporary (p, 4, "t7");
+      orc_program_add_temporary (p, 4, "t8");
+      orc_program_add_temporary (p, 4, "t9");
+      orc_program_add_temporary (p, 2, "t10");
+      orc_program_add_temporary (p, 2, "t11");
+
+      orc_program_append_2 (p, "splitlw", 0, ORC_VAR_T2, ORC_VAR_T1, ORC_VAR_S1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convswl", 0, ORC_VAR_T3, ORC_VAR_T1, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convlf", 0, ORC_VAR_T3, ORC_VAR_T3, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convswl", 0, ORC_VAR_T4, ORC_VAR_T2, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convlf", 0, ORC_VAR_T4, ORC_VAR_T4, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "splitlw", 0, ORC_VAR_T2, ORC_VAR_T1, ORC_VAR_S2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convswl", 0, ORC_VAR_T5, ORC_VAR_T1, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convlf", 0, ORC_VAR_T5, ORC_VAR_T5, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convswl", 0, ORC_VAR_T6, ORC_VAR_T2, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convlf", 0, ORC_VAR_T6, ORC_VAR_T6, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "splitlw", 0, ORC_VAR_T2, ORC_VAR_T1, ORC_VAR_S3,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convswl", 0, ORC_VAR_T7, ORC_VAR_T1, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convlf", 0, ORC_VAR_T7, ORC_VAR_T7, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convswl", 0, ORC_VAR_T8, ORC_VAR_T2, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convlf", 0, ORC_VAR_T8, ORC_VAR_T8, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "mulf", 0, ORC_VAR_T5, ORC_VAR_T5, ORC_VAR_P2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "mulf", 0, ORC_VAR_T6, ORC_VAR_T6, ORC_VAR_P3,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "mulf", 0, ORC_VAR_T9, ORC_VAR_T3, ORC_VAR_P1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "addf", 0, ORC_VAR_T9, ORC_VAR_T9, ORC_VAR_T5,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "addf", 0, ORC_VAR_T9, ORC_VAR_T9, ORC_VAR_T6,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "mulf", 0, ORC_VAR_T7, ORC_VAR_T7, ORC_VAR_P4,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "addf", 0, ORC_VAR_T9, ORC_VAR_T9, ORC_VAR_T7,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convfl", 0, ORC_VAR_T9, ORC_VAR_T9, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convssslw", 0, ORC_VAR_T10, ORC_VAR_T9,
+          ORC_VAR_D1, ORC_VAR_D1);
+      orc_program_append_2 (p, "mulf", 0, ORC_VAR_T9, ORC_VAR_T4, ORC_VAR_P1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "addf", 0, ORC_VAR_T9, ORC_VAR_T9, ORC_VAR_T5,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "addf", 0, ORC_VAR_T9, ORC_VAR_T9, ORC_VAR_T6,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "mulf", 0, ORC_VAR_T8, ORC_VAR_T8, ORC_VAR_P4,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "addf", 0, ORC_VAR_T9, ORC_VAR_T9, ORC_VAR_T8,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convfl", 0, ORC_VAR_T9, ORC_VAR_T9, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convssslw", 0, ORC_VAR_T11, ORC_VAR_T9,
+          ORC_VAR_D1, ORC_VAR_D1);
+      orc_program_append_2 (p, "mergewl", 0, ORC_VAR_D1, ORC_VAR_T10,
+          ORC_VAR_T11, ORC_VAR_D1);
+#endif
+
+      orc_program_compile (p);
+      c = orc_program_take_code (p);
+      orc_program_free (p);
+    }
+    p_inited = TRUE;
+    orc_once_mutex_unlock ();
+  }
+  ex->arrays[ORC_VAR_A2] = c;
+  ex->program = 0;
+
+  ex->n = n;
+  ORC_EXECUTOR_M (ex) = m;
+  ex->arrays[ORC_VAR_D1] = d1;
+  ex->params[ORC_VAR_D1] = d1_stride;
+  ex->arrays[ORC_VAR_S1] = (void *) s1;
+  ex->params[ORC_VAR_S1] = s1_stride;
+  ex->arrays[ORC_VAR_S2] = (void *) s2;
+  ex->params[ORC_VAR_S2] = s2_stride;
+  ex->arrays[ORC_VAR_S3] = (void *) s3;
+  ex->params[ORC_VAR_S3] = s3_stride;
+  {
+    orc_union32 tmp;
+    tmp.f = p1;
+    ex->params[ORC_VAR_P1] = tmp.i;
+  }
+  {
+    orc_union32 tmp;
+    tmp.f = p2;
+    ex->params[ORC_VAR_P2] = tmp.i;
+  }
+  {
+    orc_union32 tmp;
+    tmp.f = p3;
+    ex->params[ORC_VAR_P3] = tmp.i;
+  }
+  {
+    orc_union32 tmp;
+    tmp.f = p4;
+    ex->params[ORC_VAR_P4] = tmp.i;
+  }
+
+  func = c->exec;
+  func (ex);
+}
+#endif
+
+
+/* audiomixer_orc_remix_5p1_stereo_f32 */
+#ifdef DISABLE_ORC
+void
+audiomixer_orc_remix_5p1_stereo_f32 (float *ORC_RESTRICT d1, int d1_stride,
+    const float *ORC_RESTRICT s1, int s1_stride, const float *ORC_RESTRICT s2,
+    int s2_stride, const float *ORC_RESTRICT s3, int s3_stride, float p1,
+    float p2, float p3, float p4, int n, int m)
+{
+  int i;
+  int j;
+  orc_union64 *ORC_RESTRICT ptr0;
+  const orc_union64 *ORC_RESTRICT ptr4;
+  const orc_union64 *ORC_RESTRICT ptr5;
+  const orc_union64 *ORC_RESTRICT ptr6;
+  orc_union64 var40;
+  orc_union64 var41;
+  orc_union64 var42;
+  orc_union32 var43;
+  orc_union32 var44;
+  orc_union32 var45;
+  orc_union32 var46;
+  orc_union32 var47;
+  orc_union32 var48;
+  orc_union64 var49;
+  orc_union32 var50;
+  orc_union32 var51;
+  orc_union32 var52;
+  orc_union32 var53;
+  orc_union32 var54;
+  orc_union32 var55;
+  orc_union32 var56;
+  orc_union32 var57;
+  orc_union32 var58;
+  orc_union32 var59;
+  orc_union32 var60;
+  orc_union32 var61;
+  orc_union32 var62;
+  orc_union32 var63;
+  orc_union32 var64;
+  orc_union32 var65;
+  orc_union32 var66;
+  orc_union32 var67;
+
+  for (j = 0; j < m; j++) {
+    ptr0 = ORC_PTR_OFFSET (d1, d1_stride * j);
+    ptr4 = ORC_PTR_OFFSET (s1, s1_stride * j);
+    ptr5 = ORC_PTR_OFFSET (s2, s2_stride * j);
+    ptr6 = ORC_PTR_OFFSET (s3, s3_stride * j);
+
+    /* 6: loadpl */
+    var43.f = p2;
+    /* 8: loadpl */
+    var44.f = p3;
+    /* 10: loadpl */
+    var45.f = p1;
+    /* 14: loadpl */
+    var46.f = p4;
+    /* 17: loadpl */
+    var47.f = p1;
+    /* 21: loadpl */
+    var48.f = p4;
+
+    for (i = 0; i < n; i++) {
+      /* 0: loadq */
+      var40 = ptr4[i];
+      /* 1: splitql */
+      {
+        orc_union64 _src;
+        _src.i = var40.i;
+        var50.i = _src.x2[1];
+        var51.i = _src.x2[0];
+      }
+      /* 2: loadq */
+      var41 = ptr5[i];
+      /* 3: splitql */
+      {
+        orc_union64 _src;
+        _src.i = var41.i;
+        var52.i = _src.x2[1];
+        var53.i = _src.x2[0];
+      }
+      /* 4: loadq */
+      var42 = ptr6[i];
+      /* 5: splitql */
+      {
+        orc_union64 _src;
+        _src.i = var42.i;
+        var54.i = _src.x2[1];
+        var55.i = _src.x2[0];
+      }
+      /* 7: mulf */
+      {
+        orc_union32 _src1;
+        orc_union32 _src2;
+        orc_union32 _dest1;
+        _src1.i = ORC_DENORMAL (var53.i);
+        _src2.i = ORC_DENORMAL (var43.i);
+        _dest1.f = _src1.f * _src2.f;
+        var56.i = ORC_DENORMAL (_dest1.i);
+      }
+      /* 9: mulf */
+      {
+        orc_union32 _src1;
+        orc_union32 _src2;
+        orc_union32 _dest1;
+        _src1.i = ORC_DENORMAL (var52.i);
+        _src2.i = ORC_DENORMAL (var44.i);
+        _dest1.f = _src1.f * _src2.f;
+        var57.i = ORC_DENORMAL (_dest1.i);
+      }
+      /* 11: mulf */
+      {
+        orc_union32 _src1;
+        orc_union32 _src2;
+        orc_union32 _dest1;
+        _src1.i = ORC_DENORMAL (var51.i);
+        _src2.i = ORC_DENORMAL (var45.i);
+        _dest1.f = _src1.f * _src2.f;
+        var58.i = ORC_DENORMAL (_dest1.i);
+      }
+      /* 12: addf */
+      {
+        orc_union32 _src1;
+        orc_union32 _src2;
+        orc_union32 _dest1;
+        _src1.i = ORC_DENORMAL (var58.i);
+        _src2.i = ORC_DENORMAL (var56.i);
+        _dest1.f = _src1.f + _src2.f;
+        var59.i = ORC_DENORMAL (_dest1.i);
+      }
+      /* 13: addf */
+      {
+        orc_union32 _src1;
+        orc_union32 _src2;
+        orc_union32 _dest1;
+        _src1.i = ORC_DENORMAL (var59.i);
+        _src2.i = ORC_DENORMAL (var57.i);
+        _dest1.f = _src1.f + _src2.f;
+        var60.i = ORC_DENORMAL (_dest1.i);
+      }
+      /* 15: mulf */
+      {
+        orc_union32 _src1;
+        orc_union32 _src2;
+        orc_union32 _dest1;
+        _src1.i = ORC_DENORMAL (var55.i);
+        _src2.i = ORC_DENORMAL (var46.i);
+        _dest1.f = _src1.f * _src2.f;
+        var61.i = ORC_DENORMAL (_dest1.i);
+      }
+      /* 16: addf */
+      {
+        orc_union32 _src1;
+        orc_union32 _src2;
+        orc_union32 _dest1;
+        _src1.i = ORC_DENORMAL (var60.i);
+        _src2.i = ORC_DENORMAL (var61.i);
+        _dest1.f = _src1.f + _src2.f;
+        var62.i = ORC_DENORMAL (_dest1.i);
+      }
+      /* 18: mulf */
+      {
+        orc_union32 _src1;
+        orc_union32 _src2;
+        orc_union32 _dest1;
+        _src1.i = ORC_DENORMAL (var50.i);
+        _src2.i = ORC_DENORMAL (var47.i);
+        _dest1.f = _src1.f * _src2.f;
+        var63.i = ORC_DENORMAL (_dest1.i);
+      }
+      /* 19: addf */
+      {
+        orc_union32 _src1;
+        orc_union32 _src2;
+        orc_union32 _dest1;
+        _src1.i = ORC_DENORMAL (var63.i);
+        _src2.i = ORC_DENORMAL (var56.i);
+        _dest1.f = _src1.f + _src2.f;
+        var64.i = ORC_DENORMAL (_dest1.i);
+      }
+      /* 20: addf */
+      {
+        orc_union32 _src1;
+        orc_union32 _src2;
+        orc_union32 _dest1;
+        _src1.i = ORC_DENORMAL (var64.i);
+        _src2.i = ORC_DENORMAL (var57.i);
+        _dest1.f = _src1.f + _src2.f;
+        var65.i = ORC_DENORMAL (_dest1.i);
+      }
+      /* 22: mulf */
+      {
+        orc_union32 _src1;
+        orc_union32 _src2;
+        orc_union32 _dest1;
+        _src1.i = ORC_DENORMAL (var54.i);
+        _src2.i = ORC_DENORMAL (var48.i);
+        _dest1.f = _src1.f * _src2.f;
+        var66.i = ORC_DENORMAL (_dest1.i);
+      }
+      /* 23: addf */
+      {
+        orc_union32 _src1;
+        orc_union32 _src2;
+        orc_union32 _dest1;
+        _src1.i = ORC_DENORMAL (var65.i);
+        _src2.i = ORC_DENORMAL (var66.i);
+        _dest1.f = _src1.f + _src2.f;
+        var67.i = ORC_DENORMAL (_dest1.i);
+      }
+      /* 24: mergelq */
+      {
+        orc_union64 _dest;
+        _dest.x2[0] = var62.i;
+        _dest.x2[1] = var67.i;
+        var49.i = _dest.i;
+      }
+      /* 25: storeq */
+      ptr0[i] = var49;
+    }
+  }
+
+}
+
+#else
+static void
+_backup_audiomixer_orc_remix_5p1_stereo_f32 (OrcExecutor * ORC_RESTRICT ex)
+{
+  int i;
+  int j;
+  int n = ex->n;
+  int m = ex->params[ORC_VAR_A1];
+  orc_union64 *ORC_RESTRICT ptr0;
+  const orc_union64 *ORC_RESTRICT ptr4;
+  const orc_union64 *ORC_RESTRICT ptr5;
+  const orc_union64 *ORC_RESTRICT ptr6;
+  orc_union64 var40;
+  orc_union64 var41;
+  orc_union64 var42;
+  orc_union32 var43;
+  orc_union32 var44;
+  orc_union32 var45;
+  orc_union32 var46;
+  orc_union32 var47;
+  orc_union32 var48;
+  orc_union64 var49;
+  orc_union32 var50;
+  orc_union32 var51;
+  orc_union32 var52;
+  orc_union32 var53;
+  orc_union32 var54;
+  orc_union32 var55;
+  orc_union32 var56;
+  orc_union32 var57;
+  orc_union32 var58;
+  orc_union32 var59;
+  orc_union32 var60;
+  orc_union32 var61;
+  orc_union32 var62;
+  orc_union32 var63;
+  orc_union32 var64;
+  orc_union32 var65;
+  orc_union32 var66;
+  orc_union32 var67;
+
+  for (j = 0; j < m; j++) {
+    ptr0 = ORC_PTR_OFFSET (ex->arrays[0], ex->params[0] * j);
+    ptr4 = ORC_PTR_OFFSET (ex->arrays[4], ex->params[4] * j);
+    ptr5 = ORC_PTR_OFFSET (ex->arrays[5], ex->params[5] * j);
+    ptr6 = ORC_PTR_OFFSET (ex->arrays[6], ex->params[6] * j);
+
+    /* 6: loadpl */
+    var43.i = ex->params[25];
+    /* 8: loadpl */
+    var44.i = ex->params[26];
+    /* 10: loadpl */
+    var45.i = ex->params[24];
+    /* 14: loadpl */
+    var46.i = ex->params[27];
+    /* 17: loadpl */
+    var47.i = ex->params[24];
+    /* 21: loadpl */
+    var48.i = ex->params[27];
+
+    for (i = 0; i < n; i++) {
+      /* 0: loadq */
+      var40 = ptr4[i];
+      /* 1: splitql */
+      {
+        orc_union64 _src;
+        _src.i = var40.i;
+        var50.i = _src.x2[1];
+        var51.i = _src.x2[0];
+      }
+      /* 2: loadq */
+      var41 = ptr5[i];
+      /* 3: splitql */
+      {
+        orc_union64 _src;
+        _src.i = var41.i;
+        var52.i = _src.x2[1];
+        var53.i = _src.x2[0];
+      }
+      /* 4: loadq */
+      var42 = ptr6[i];
+      /* 5: splitql */
+      {
+        orc_union64 _src;
+        _src.i = var42.i;
+        var54.i = _src.x2[1];
+        var55.i = _src.x2[0];
+      }
+      /* 7: mulf */
+      {
+        orc_union32 _src1;
+        orc_union32 _src2;
+        orc_union32 _dest1;
+        _src1.i = ORC_DENORMAL (var53.i);
+        _src2.i = ORC_DENORMAL (var43.i);
+        _dest1.f = _src1.f * _src2.f;
+        var56.i = ORC_DENORMAL (_dest1.i);
+      }
+      /* 9: mulf */
+      {
+        orc_union32 _src1;
+        orc_union32 _src2;
+        orc_union32 _dest1;
+        _src1.i = ORC_DENORMAL (var52.i);
+        _src2.i = ORC_DENORMAL (var44.i);
+        _dest1.f = _src1.f * _src2.f;
+        var57.i = ORC_DENORMAL (_dest1.i);
+      }
+      /* 11: mulf */
+      {
+        orc_union32 _src1;
+        orc_union32 _src2;
+        orc_union32 _dest1;
+        _src1.i = ORC_DENORMAL (var51.i);
+        _src2.i = ORC_DENORMAL (var45.i);
+        _dest1.f = _src1.f * _src2.f;
+        var58.i = ORC_DENORMAL (_dest1.i);
+      }
+      /* 12: addf */
+      {
+        orc_union32 _src1;
+        orc_union32 _src2;
+        orc_union32 _dest1;
+        _src1.i = ORC_DENORMAL (var58.i);
+        _src2.i = ORC_DENORMAL (var56.i);
+        _dest1.f = _src1.f + _src2.f;
+        var59.i = ORC_DENORMAL (_dest1.i);
+      }
+      /* 13: addf */
+      {
+        orc_union32 _src1;
+        orc_union32 _src2;
+        orc_union32 _dest1;
+        _src1.i = ORC_DENORMAL (var59.i);
+        _src2.i = ORC_DENORMAL (var57.i);
+        _dest1.f = _src1.f + _src2.f;
+        var60.i = ORC_DENORMAL (_dest1.i);
+      }
+      /* 15: mulf */
+      {
+        orc_union32 _src1;
+        orc_union32 _src2;
+        orc_union32 _dest1;
+        _src1.i = ORC_DENORMAL (var55.i);
+        _src2.i = ORC_DENORMAL (var46.i);
+        _dest1.f = _src1.f * _src2.f;
+        var61.i = ORC_DENORMAL (_dest1.i);
+      }
+      /* 16: addf */
+      {
+        orc_union32 _src1;
+        orc_union32 _src2;
+        orc_union32 _dest1;
+        _src1.i = ORC_DENORMAL (var60.i);
+        _src2.i = ORC_DENORMAL (var61.i);
+        _dest1.f = _src1.f + _src2.f;
+        var62.i = ORC_DENORMAL (_dest1.i);
+      }
+      /* 18: mulf */
+      {
+        orc_union32 _src1;
+        orc_union32 _src2;
+        orc_union32 _dest1;
+        _src1.i = ORC_DENORMAL (var50.i);
+        _src2.i = ORC_DENORMAL (var47.i);
+        _dest1.f = _src1.f * _src2.f;
+        var63.i = ORC_DENORMAL (_dest1.i);
+      }
+      /* 19: addf */
+      {
+        orc_union32 _src1;
+        orc_union32 _src2;
+        orc_union32 _dest1;
+        _src1.i = ORC_DENORMAL (var63.i);
+        _src2.i = ORC_DENORMAL (var56.i);
+        _dest1.f = _src1.f + _src2.f;
+        var64.i = ORC_DENORMAL (_dest1.i);
+      }
+      /* 20: addf */
+      {
+        orc_union32 _src1;
+        orc_union32 _src2;
+        orc_union32 _dest1;
+        _src1.i = ORC_DENORMAL (var64.i);
+        _src2.i = ORC_DENORMAL (var57.i);
+        _dest1.f = _src1.f + _src2.f;
+        var65.i = ORC_DENORMAL (_dest1.i);
+      }
+      /* 22: mulf */
+      {
+        orc_union32 _src1;
+        orc_union32 _src2;
+        orc_union32 _dest1;
+        _src1.i = ORC_DENORMAL (var54.i);
+        _src2.i = ORC_DENORMAL (var48.i);
+        _dest1.f = _src1.f * _src2.f;
+        var66.i = ORC_DENORMAL (_dest1.i);
+      }
+      /* 23: addf */
+      {
+        orc_union32 _src1;
+        orc_union32 _src2;
+        orc_union32 _dest1;
+        _src1.i = ORC_DENORMAL (var65.i);
+        _src2.i = ORC_DENORMAL (var66.i);
+        _dest1.f = _src1.f + _src2.f;
+        var67.i = ORC_DENORMAL (_dest1.i);
+      }
+      /* 24: mergelq */
+      {
+        orc_union64 _dest;
+        _dest.x2[0] = var62.i;
+        _dest.x2[1] = var67.i;
+        var49.i = _dest.i;
+      }
+      /* 25: storeq */
+      ptr0[i] = var49;
+    }
+  }
+
+}
+
+void
+audiomixer_orc_remix_5p1_stereo_f32 (float *ORC_RESTRICT d1, int d1_stride,
+    const float *ORC_RESTRICT s1, int s1_stride, const float *ORC_RESTRICT s2,
+    int s2_stride, const float *ORC_RESTRICT s3, int s3_stride, float p1,
+    float p2, float p3, float p4, int n, int m)
+{
+  OrcExecutor _ex, *ex = &_ex;
+  static volatile int p_inited = 0;
+  static OrcCode *c = 0;
+  void (*func) (OrcExecutor *);
+
+  if (!p_inited) {
+    orc_once_mutex_lock ();
+    if (!p_inited) {
+      OrcProgram *p;
+
+#if 1
+      static const orc_uint8 bc[] = {
+        1, 7, 9, 35, 97, 117, 100, 105, 111, 109, 105, 120, 101, 114, 95, 111,
+        114, 99, 95, 114, 101, 109, 105, 120, 95, 53, 112, 49, 95, 115, 116,
+        101,
+        114, 101, 111, 95, 102, 51, 50, 11, 8, 8, 12, 8, 8, 12, 8, 8,
+        12, 8, 8, 17, 4, 17, 4, 17, 4, 17, 4, 20, 4, 20, 4, 20,
+        4, 20, 4, 20, 4, 20, 4, 20, 4, 20, 4, 197, 33, 32, 4, 197,
+        35, 34, 5, 197, 37, 36, 6, 202, 34, 34, 25, 202, 35, 35, 26, 202,
+        38, 32, 24, 200, 38, 38, 34, 200, 38, 38, 35, 202, 36, 36, 27, 200,
+        38, 38, 36, 202, 39, 33, 24, 200, 39, 39, 34, 200, 39, 39, 35, 202,
+        37, 37, 27, 200, 39, 39, 37, 194, 0, 38, 39, 2, 0,
+      };
+      p = orc_program_new_from_static_bytecode (bc);
+      orc_program_set_backup_function (p,
+          _backup_audiomixer_orc_remix_5p1_stereo_f32);
+#else
+      p = orc_program_new ();
+      orc_program_set_2d (p);
+      orc_program_set_name (p, "audiomixer_orc_remix_5p1_stereo_f32");
+      orc_program_set_backup_function (p,
+          _backup_audiomixer_orc_remix_5p1_stereo_f32);
+      orc_program_add_destination (p, 8, "d1");
+      orc_program_add_source (p, 8, "s1");
+      orc_program_add_source (p, 8, "s2");
+      orc_program_add_source (p, 8, "s3");
+      orc_program_add_parameter_float (p, 4, "p1");
+      orc_program_add_parameter_float (p, 4, "p2");
+      orc_program_add_parameter_float (p, 4, "p3");
+      orc_program_add_parameter_float (p, 4, "p4");
+      orc_program_add_temporary (p, 4, "t1");
+      orc_program_add_temporary (p, 4, "t2");
+      orc_program_add_temporary (p, 4, "t3");
+      orc_program_add_temporary (p, 4, "t4");
+      orc_program_add_temporary (p, 4, "t5");
+      orc_program_add_temporary (p, 4, "t6");
+      orc_program_add_temporary (p, 4, "t7");
+      orc_program_add_temporary (p, 4, "t8");
+
+      orc_program_append_2 (p, "splitql", 0, ORC_VAR_T2, ORC_VAR_T1, ORC_VAR_S1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "splitql", 0, ORC_VAR_T4, ORC_VAR_T3, ORC_VAR_S2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "splitql", 0, ORC_VAR_T6, ORC_VAR_T5, ORC_VAR_S3,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "mulf", 0, ORC_VAR_T3, ORC_VAR_T3, ORC_VAR_P2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "mulf", 0, ORC_VAR_T4, ORC_VAR_T4, ORC_VAR_P3,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "mulf", 0, ORC_VAR_T7, ORC_VAR_T1, ORC_VAR_P1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "addf", 0, ORC_VAR_T7, ORC_VAR_T7, ORC_VAR_T3,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "addf", 0, ORC_VAR_T7, ORC_VAR_T7, ORC_VAR_T4,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "mulf", 0, ORC_VAR_T5, ORC_VAR_T5, ORC_VAR_P4,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "addf", 0, ORC_VAR_T7, ORC_VAR_T7, ORC_VAR_T5,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "mulf", 0, ORC_VAR_T8, ORC_VAR_T2, ORC_VAR_P1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "addf", 0, ORC_VAR_T8, ORC_VAR_T8, ORC_VAR_T3,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "addf", 0, ORC_VAR_T8, ORC_VAR_T8, ORC_VAR_T4,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "mulf", 0, ORC_VAR_T6, ORC_VAR_T6, ORC_VAR_P4,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "addf", 0, ORC_VAR_T8, ORC_VAR_T8, ORC_VAR_T6,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "mergelq", 0, ORC_VAR_D1, ORC_VAR_T7, ORC_VAR_T8,
+          ORC_VAR_D1);
+#endif
+
+      orc_program_compile (p);
+      c = orc_program_take_code (p);
+      orc_program_free (p);
+    }
+    p_inited = TRUE;
+    orc_once_mutex_unlock ();
+  }
+  ex->arrays[ORC_VAR_A2] = c;
+  ex->program = 0;
+
+  ex->n = n;
+  ORC_EXECUTOR_M (ex) = m;
+  ex->arrays[ORC_VAR_D1] = d1;
+  ex->params[ORC_VAR_D1] = d1_stride;
+  ex->arrays[ORC_VAR_S1] = (void *) s1;
+  ex->params[ORC_VAR_S1] = s1_stride;
+  ex->arrays[ORC_VAR_S2] = (void *) s2;
+  ex->params[ORC_VAR_S2] = s2_stride;
+  ex->arrays[ORC_VAR_S3] = (void *) s3;
+  ex->params[ORC_VAR_S3] = s3_stride;
+  {
+    orc_union32 tmp;
+    tmp.f = p1;
+    ex->params[ORC_VAR_P1] = tmp.i;
+  }
+  {
+    orc_union32 tmp;
+    tmp.f = p2;
+    ex->params[ORC_VAR_P2] = tmp.i;
+  }
+  {
+    orc_union32 tmp;
+    tmp.f = p3;
+    ex->params[ORC_VAR_P3] = tmp.i;
+  }
+  {
+    orc_union32 tmp;
+    tmp.f = p4;
+    ex->params[ORC_VAR_P4] = tmp.i;
+  }
+
+  func = c->exec;
+  func (ex);
+}
+#endif
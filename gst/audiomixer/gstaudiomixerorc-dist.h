@@ -97,6 +97,20 @@ void audiomixer_orc_add_volume_u32 (guint32 * ORC_RESTRICT d1, const guint32 * O
 void audiomixer_orc_add_volume_s32 (gint32 * ORC_RESTRICT d1, const gint32 * ORC_RESTRICT s1, int p1, int n);
 void audiomixer_orc_add_volume_f32 (float * ORC_RESTRICT d1, const float * ORC_RESTRICT s1, float p1, int n);
 void audiomixer_orc_add_volume_f64 (double * ORC_RESTRICT d1, const double * ORC_RESTRICT s1, double p1, int n);
+void audiomixer_orc_add_volume_ramp_u8 (guint8 * ORC_RESTRICT d1, const guint8 * ORC_RESTRICT s1, const gint8 * ORC_RESTRICT s2, int n);
+void audiomixer_orc_add_volume_ramp_s8 (gint8 * ORC_RESTRICT d1, const gint8 * ORC_RESTRICT s1, const gint8 * ORC_RESTRICT s2, int n);
+void audiomixer_orc_add_volume_ramp_u16 (guint16 * ORC_RESTRICT d1, const guint16 * ORC_RESTRICT s1, const gint16 * ORC_RESTRICT s2, int n);
+void audiomixer_orc_add_volume_ramp_s16 (gint16 * ORC_RESTRICT d1, const gint16 * ORC_RESTRICT s1, const gint16 * ORC_RESTRICT s2, int n);
+void audiomixer_orc_add_volume_ramp_u32 (guint32 * ORC_RESTRICT d1, const guint32 * ORC_RESTRICT s1, const gint32 * ORC_RESTRICT s2, int n);
+void audiomixer_orc_add_volume_ramp_s32 (gint32 * ORC_RESTRICT d1, const gint32 * ORC_RESTRICT s1, const gint32 * ORC_RESTRICT s2, int n);
+void audiomixer_orc_add_volume_ramp_f32 (float * ORC_RESTRICT d1, const float * ORC_RESTRICT s1, const float * ORC_RESTRICT s2, int n);
+void audiomixer_orc_add_volume_ramp_f64 (double * ORC_RESTRICT d1, const double * ORC_RESTRICT s1, const double * ORC_RESTRICT s2, int n);
+void audiomixer_orc_remix_mono_stereo_s16 (gint16 * ORC_RESTRICT d1, const gint16 * ORC_RESTRICT s1, float p1, float p2, int n);
+void audiomixer_orc_remix_stereo_mono_s16 (gint16 * ORC_RESTRICT d1, const gint16 * ORC_RESTRICT s1, float p1, float p2, int n);
+void audiomixer_orc_remix_mono_stereo_f32 (float * ORC_RESTRICT d1, const float * ORC_RESTRICT s1, float p1, float p2, int n);
+void audiomixer_orc_remix_stereo_mono_f32 (float * ORC_RESTRICT d1, const float * ORC_RESTRICT s1, float p1, float p2, int n);
+void audiomixer_orc_remix_5p1_stereo_s16 (gint16 * ORC_RESTRICT d1, int d1_stride, const gint16 * ORC_RESTRICT s1, int s1_stride, const gint16 * ORC_RESTRICT s2, int s2_stride, const gint16 * ORC_RESTRICT s3, int s3_stride, float p1, float p2, float p3, float p4, int n, int m);
+void audiomixer_orc_remix_5p1_stereo_f32 (float * ORC_RESTRICT d1, int d1_stride, const float * ORC_RESTRICT s1, int s1_stride, const float * ORC_RESTRICT s2, int s2_stride, const float * ORC_RESTRICT s3, int s3_stride, float p1, float p2, float p3, float p4, int n, int m);
 
 #ifdef __cplusplus
 }
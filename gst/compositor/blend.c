@@ -118,6 +118,57 @@ BLEND_A32 (argb, overlay, _overlay_loop_bgra);
 BLEND_A32 (bgra, overlay, _overlay_loop_argb);
 #endif
 
+/* Opaque pixels do not need to be blended, only copied */
+static void
+copy_argb (GstVideoFrame * srcframe, gint xpos, gint ypos,
+    gdouble src_alpha, GstVideoFrame * destframe)
+{
+  gint src_stride, dest_stride;
+  gint dest_width, dest_height;
+  guint8 *src, *dest;
+  gint src_width, src_height;
+  gint i;
+
+  src_width = GST_VIDEO_FRAME_WIDTH (srcframe);
+  src_height = GST_VIDEO_FRAME_HEIGHT (srcframe);
+  src = GST_VIDEO_FRAME_PLANE_DATA (srcframe, 0);
+  src_stride = GST_VIDEO_FRAME_COMP_STRIDE (srcframe, 0);
+  dest = GST_VIDEO_FRAME_PLANE_DATA (destframe, 0);
+  dest_stride = GST_VIDEO_FRAME_COMP_STRIDE (destframe, 0);
+  dest_width = GST_VIDEO_FRAME_COMP_WIDTH (destframe, 0);
+  dest_height = GST_VIDEO_FRAME_COMP_HEIGHT (destframe, 0);
+
+  /* adjust src pointers for negative sizes */
+  if (xpos < 0) {
+    src += -xpos * 4;
+    src_width -= -xpos;
+    xpos = 0;
+  }
+  if (ypos < 0) {
+    src += -ypos * src_stride;
+    src_height -= -ypos;
+    ypos = 0;
+  }
+  /* adjust width/height if the src is bigger than dest */
+  if (xpos + src_width > dest_width) {
+    src_width = dest_width - xpos;
+  }
+  if (ypos + src_height > dest_height) {
+    src_height = dest_height - ypos;
+  }
+
+  if (src_width <= 0 || src_height <= 0)
+    return;
+
+  dest = dest + 4 * xpos + (ypos * dest_stride);
+
+  for (i = 0; i < src_height; i++) {
+    memcpy (dest, src, 4 * src_width);
+    src += src_stride;
+    dest += dest_stride;
+  }
+}
+
 #define A32_CHECKER_C(name, RGB, A, C1, C2, C3) \
 static void \
 fill_checker_##name##_c (GstVideoFrame * frame) \
@@ -278,10 +329,10 @@ blend_##format_name (GstVideoFrame * srcframe, gint xpos, gint ypos, \
   } \
   \
   /* adjust width/height if the src is bigger than dest */ \
-  if (xpos + src_width > dest_width) { \
+  if (xpos + b_src_width > dest_width) { \
     b_src_width = dest_width - xpos; \
   } \
-  if (ypos + src_height > dest_height) { \
+  if (ypos + b_src_height > dest_height) { \
     b_src_height = dest_height - ypos; \
   } \
   if (b_src_width < 0 || b_src_height < 0) { \
@@ -523,10 +574,10 @@ blend_##format_name (GstVideoFrame * srcframe, gint xpos, gint ypos, \
   } \
   \
   /* adjust width/height if the src is bigger than dest */ \
-  if (xpos + src_width > dest_width) { \
+  if (xpos + b_src_width > dest_width) { \
     b_src_width = dest_width - xpos; \
   } \
-  if (ypos + src_height > dest_height) { \
+  if (ypos + b_src_height > dest_height) { \
     b_src_height = dest_height - ypos; \
   } \
   if (b_src_width < 0 || b_src_height < 0) { \
@@ -961,6 +1012,9 @@ BlendFunction gst_compositor_blend_rgbx;
 BlendFunction gst_compositor_blend_yuy2;
 /* YVYU and UYVY are equal to YUY2 */
 
+BlendFunction gst_compositor_copy_argb;
+/* AYUV, BGRA, ABGR and RGBA are equal to ARGB */
+
 FillCheckerFunction gst_compositor_fill_checker_argb;
 FillCheckerFunction gst_compositor_fill_checker_bgra;
 /* ABGR is equal to ARGB, RGBA is equal to BGRA */
@@ -1022,6 +1076,8 @@ gst_compositor_init_blend (void)
   gst_compositor_blend_xrgb = blend_xrgb;
   gst_compositor_blend_yuy2 = blend_yuy2;
 
+  gst_compositor_copy_argb = copy_argb;
+
   gst_compositor_fill_checker_argb = fill_checker_argb_c;
   gst_compositor_fill_checker_bgra = fill_checker_bgra_c;
   gst_compositor_fill_checker_ayuv = fill_checker_ayuv_c;
@@ -37,6 +37,11 @@ extern BlendFunction gst_compositor_overlay_bgra;
 #define gst_compositor_overlay_ayuv gst_compositor_overlay_argb
 #define gst_compositor_overlay_abgr gst_compositor_overlay_argb
 #define gst_compositor_overlay_rgba gst_compositor_overlay_bgra
+extern BlendFunction gst_compositor_copy_argb;
+#define gst_compositor_copy_ayuv gst_compositor_copy_argb
+#define gst_compositor_copy_bgra gst_compositor_copy_argb
+#define gst_compositor_copy_abgr gst_compositor_copy_argb
+#define gst_compositor_copy_rgba gst_compositor_copy_argb
 extern BlendFunction gst_compositor_blend_i420;
 #define gst_compositor_blend_yv12 gst_compositor_blend_i420
 extern BlendFunction gst_compositor_blend_nv12;
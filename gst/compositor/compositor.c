@@ -28,7 +28,9 @@
  * output parameters. Indeed output video frames will have the geometry of the
  * biggest incoming video stream and the framerate of the fastest incoming one.
  *
- * Compositor will do colorspace conversion.
+ * Compositor will do colorspace conversion, and scale the input streams to
+ * the #GstCompositorPad:width and #GstCompositorPad:height of their pad if
+ * those are set.
  * 
  * Individual parameters for each input stream can be configured on the
  * #GstCompositorPad.
@@ -75,6 +77,13 @@
  *   "video/x-raw,format=AYUV,width=800,height=600,framerate=(fraction)10/1" ! \
  *   timeoverlay ! queue2 ! comp.
  * ]| A pipeline to demonstrate synchronized compositing (the second stream starts after 3 seconds)
+ * |[
+ * gst-launch-1.0 compositor name=comp sink_1::xpos=480 sink_1::ypos=360 \
+ *   sink_1::width=160 sink_1::height=120 ! videoconvert ! ximagesink \
+ *   videotestsrc ! video/x-raw,width=640,height=480 ! comp. \
+ *   videotestsrc pattern=ball ! video/x-raw,width=640,height=480 ! comp.
+ * ]| A pipeline to demonstrate picture-in-picture, the second stream being
+ * scaled down to a quarter of its size in the bottom right corner
  * </refsect2>
  */
 
@@ -115,6 +124,8 @@ static GstStaticPadTemplate sink_factory = GST_STATIC_PAD_TEMPLATE ("sink_%u",
 #define DEFAULT_PAD_ZORDER 0
 #define DEFAULT_PAD_XPOS   0
 #define DEFAULT_PAD_YPOS   0
+#define DEFAULT_PAD_WIDTH  0
+#define DEFAULT_PAD_HEIGHT 0
 #define DEFAULT_PAD_ALPHA  1.0
 enum
 {
@@ -122,6 +133,8 @@ enum
   PROP_PAD_ZORDER,
   PROP_PAD_XPOS,
   PROP_PAD_YPOS,
+  PROP_PAD_WIDTH,
+  PROP_PAD_HEIGHT,
   PROP_PAD_ALPHA
 };
 
@@ -144,6 +157,12 @@ gst_compositor_pad_get_property (GObject * object, guint prop_id,
     case PROP_PAD_YPOS:
       g_value_set_int (value, pad->ypos);
       break;
+    case PROP_PAD_WIDTH:
+      g_value_set_int (value, pad->width);
+      break;
+    case PROP_PAD_HEIGHT:
+      g_value_set_int (value, pad->height);
+      break;
     case PROP_PAD_ALPHA:
       g_value_set_double (value, pad->alpha);
       break;
@@ -166,6 +185,26 @@ gst_compositor_pad_set_property (GObject * object, guint prop_id,
     case PROP_PAD_YPOS:
       pad->ypos = g_value_get_int (value);
       break;
+    case PROP_PAD_WIDTH:
+    case PROP_PAD_HEIGHT:{
+      gint *size = prop_id == PROP_PAD_WIDTH ? &pad->width : &pad->height;
+      GstObject *vagg = gst_object_get_parent (GST_OBJECT (pad));
+
+      /* the converter is only rebuilt when the size changes, this can be
+       * set by a controller for every frame. The conversion is updated
+       * under the object lock of the aggregator. */
+      if (vagg)
+        GST_OBJECT_LOCK (vagg);
+      if (*size != g_value_get_int (value)) {
+        *size = g_value_get_int (value);
+        GST_VIDEO_AGGREGATOR_PAD (pad)->need_conversion_update = TRUE;
+      }
+      if (vagg) {
+        GST_OBJECT_UNLOCK (vagg);
+        gst_object_unref (vagg);
+      }
+      break;
+    }
     case PROP_PAD_ALPHA:
       pad->alpha = g_value_get_double (value);
       break;
@@ -175,14 +214,162 @@ gst_compositor_pad_set_property (GObject * object, guint prop_id,
   }
 }
 
+/* Size of the frames of @pad in the output, the input size unless the width
+ * or height properties are set */
+static void
+_pad_get_output_size (GstCompositorPad * pad, gint * width, gint * height)
+{
+  GstVideoAggregatorPad *vaggpad = GST_VIDEO_AGGREGATOR_PAD (pad);
+
+  *width = pad->width > 0 ? pad->width : GST_VIDEO_INFO_WIDTH (&vaggpad->info);
+  *height =
+      pad->height > 0 ? pad->height : GST_VIDEO_INFO_HEIGHT (&vaggpad->info);
+}
+
+/* Area of the output frame, in pixels */
+typedef struct
+{
+  gint x, y, w, h;
+} CompositorRect;
+
+/* Gets the area of the output frame described by @out_info that the frame of
+ * @pad covers, positioned the same way as the blend functions do. Returns
+ * FALSE if the frame is completely outside of the output. */
+static gboolean
+_pad_get_rect (GstCompositorPad * pad, const GstVideoInfo * out_info,
+    CompositorRect * rect)
+{
+  const GstVideoFormatInfo *finfo = out_info->finfo;
+  gint x, y, x2, y2, width, height, w_sub = 0, h_sub = 0;
+  guint c;
+
+  /* the blend functions round the position up to the chroma subsampling */
+  for (c = 0; c < GST_VIDEO_FORMAT_INFO_N_COMPONENTS (finfo); c++) {
+    w_sub = MAX (w_sub, GST_VIDEO_FORMAT_INFO_W_SUB (finfo, c));
+    h_sub = MAX (h_sub, GST_VIDEO_FORMAT_INFO_H_SUB (finfo, c));
+  }
+  x = GST_ROUND_UP_N (pad->xpos, 1 << w_sub);
+  y = GST_ROUND_UP_N (pad->ypos, 1 << h_sub);
+
+  _pad_get_output_size (pad, &width, &height);
+  x2 = MIN (x + width, GST_VIDEO_INFO_WIDTH (out_info));
+  y2 = MIN (y + height, GST_VIDEO_INFO_HEIGHT (out_info));
+
+  rect->x = MAX (x, 0);
+  rect->y = MAX (y, 0);
+  rect->w = x2 - rect->x;
+  rect->h = y2 - rect->y;
+
+  return rect->w > 0 && rect->h > 0;
+}
+
+static gboolean
+_rect_contains (const CompositorRect * rect, const CompositorRect * other)
+{
+  return other->x >= rect->x && other->y >= rect->y &&
+      other->x + other->w <= rect->x + rect->w &&
+      other->y + other->h <= rect->y + rect->h;
+}
+
+/* Whether the frame of @pad completely replaces what is below it */
+static gboolean
+_pad_is_opaque (GstCompositorPad * pad, const GstVideoInfo * out_info)
+{
+  GstVideoAggregatorPad *vaggpad = GST_VIDEO_AGGREGATOR_PAD (pad);
+
+  if (vaggpad->buffer == NULL || pad->alpha < 1.0)
+    return FALSE;
+
+  /* the alpha channel of the input is only used when blending into an output
+   * that has one */
+  return !GST_VIDEO_INFO_HAS_ALPHA (&vaggpad->buffer_vinfo) ||
+      !GST_VIDEO_INFO_HAS_ALPHA (out_info);
+}
+
+/* Scales the frames to the width and height properties along with the
+ * format conversion */
+static gboolean
+gst_compositor_pad_set_info (GstVideoAggregatorPad * pad,
+    GstVideoAggregator * vagg, GstVideoInfo * current_info,
+    GstVideoInfo * wanted_info)
+{
+  GstVideoInfo scaled_info;
+  gint width, height;
+
+  _pad_get_output_size (GST_COMPOSITOR_PAD (pad), &width, &height);
+
+  scaled_info = *wanted_info;
+  gst_video_info_set_format (&scaled_info, GST_VIDEO_INFO_FORMAT (wanted_info),
+      width, height);
+  scaled_info.colorimetry = wanted_info->colorimetry;
+  scaled_info.chroma_site = wanted_info->chroma_site;
+  scaled_info.interlace_mode = wanted_info->interlace_mode;
+  scaled_info.par_n = wanted_info->par_n;
+  scaled_info.par_d = wanted_info->par_d;
+  scaled_info.fps_n = wanted_info->fps_n;
+  scaled_info.fps_d = wanted_info->fps_d;
+
+  return GST_VIDEO_AGGREGATOR_PAD_CLASS (gst_compositor_pad_parent_class)->
+      set_info (pad, vagg, current_info, &scaled_info);
+}
+
+/* Pads that are fully transparent, outside of the output or hidden by an
+ * opaque pad above them are not mapped nor converted, leaving their
+ * aggregated_frame unset so that they are not blended either. */
+static gboolean
+gst_compositor_pad_prepare_frame (GstVideoAggregatorPad * pad,
+    GstVideoAggregator * vagg)
+{
+  GstCompositorPad *compo_pad = GST_COMPOSITOR_PAD (pad);
+  CompositorRect rect, other_rect;
+  gboolean visible = TRUE;
+  GList *l;
+
+  if (pad->buffer == NULL)
+    return TRUE;
+
+  GST_OBJECT_LOCK (vagg);
+  if (compo_pad->alpha == 0.0 || !_pad_get_rect (compo_pad, &vagg->info,
+          &rect)) {
+    visible = FALSE;
+  } else {
+    /* sink pads are sorted by zorder, the pads after this one are above it */
+    l = g_list_find (GST_ELEMENT (vagg)->sinkpads, pad);
+    for (l = l ? l->next : NULL; l && visible; l = l->next) {
+      GstCompositorPad *other = l->data;
+
+      if (_pad_is_opaque (other, &vagg->info) &&
+          _pad_get_rect (other, &vagg->info, &other_rect) &&
+          _rect_contains (&other_rect, &rect))
+        visible = FALSE;
+    }
+  }
+  GST_OBJECT_UNLOCK (vagg);
+
+  if (!visible) {
+    GST_LOG_OBJECT (pad, "Not visible, skipping frame");
+    return TRUE;
+  }
+
+  return
+      GST_VIDEO_AGGREGATOR_PAD_CLASS (gst_compositor_pad_parent_class)->
+      prepare_frame (pad, vagg);
+}
+
 static void
 gst_compositor_pad_class_init (GstCompositorPadClass * klass)
 {
   GObjectClass *gobject_class = (GObjectClass *) klass;
+  GstVideoAggregatorPadClass *vaggpadclass =
+      (GstVideoAggregatorPadClass *) klass;
 
   gobject_class->set_property = gst_compositor_pad_set_property;
   gobject_class->get_property = gst_compositor_pad_get_property;
 
+  vaggpadclass->set_info = GST_DEBUG_FUNCPTR (gst_compositor_pad_set_info);
+  vaggpadclass->prepare_frame =
+      GST_DEBUG_FUNCPTR (gst_compositor_pad_prepare_frame);
+
   g_object_class_install_property (gobject_class, PROP_PAD_XPOS,
       g_param_spec_int ("xpos", "X Position", "X Position of the picture",
           G_MININT, G_MAXINT, DEFAULT_PAD_XPOS,
@@ -191,6 +378,16 @@ gst_compositor_pad_class_init (GstCompositorPadClass * klass)
       g_param_spec_int ("ypos", "Y Position", "Y Position of the picture",
           G_MININT, G_MAXINT, DEFAULT_PAD_YPOS,
           G_PARAM_READWRITE | GST_PARAM_CONTROLLABLE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (gobject_class, PROP_PAD_WIDTH,
+      g_param_spec_int ("width", "Width",
+          "Width of the picture, 0 for the input width", 0, G_MAXINT,
+          DEFAULT_PAD_WIDTH,
+          G_PARAM_READWRITE | GST_PARAM_CONTROLLABLE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (gobject_class, PROP_PAD_HEIGHT,
+      g_param_spec_int ("height", "Height",
+          "Height of the picture, 0 for the input height", 0, G_MAXINT,
+          DEFAULT_PAD_HEIGHT,
+          G_PARAM_READWRITE | GST_PARAM_CONTROLLABLE | G_PARAM_STATIC_STRINGS));
   g_object_class_install_property (gobject_class, PROP_PAD_ALPHA,
       g_param_spec_double ("alpha", "Alpha", "Alpha of the picture", 0.0, 1.0,
           DEFAULT_PAD_ALPHA,
@@ -202,18 +399,26 @@ gst_compositor_pad_init (GstCompositorPad * compo_pad)
 {
   compo_pad->xpos = DEFAULT_PAD_XPOS;
   compo_pad->ypos = DEFAULT_PAD_YPOS;
+  compo_pad->width = DEFAULT_PAD_WIDTH;
+  compo_pad->height = DEFAULT_PAD_HEIGHT;
   compo_pad->alpha = DEFAULT_PAD_ALPHA;
 }
 
 
 /* GstCompositor */
 #define DEFAULT_BACKGROUND COMPOSITOR_BACKGROUND_CHECKER
+#define DEFAULT_N_THREADS 0
 enum
 {
   PROP_0,
-  PROP_BACKGROUND
+  PROP_BACKGROUND,
+  PROP_N_THREADS
 };
 
+/* Height of the output bands blended in parallel is a multiple of this, which
+ * keeps them aligned on the chroma subsampling and on the checker pattern */
+#define BAND_ALIGN 16
+
 #define GST_TYPE_COMPOSITOR_BACKGROUND (gst_compositor_background_get_type())
 static GType
 gst_compositor_background_get_type (void)
@@ -247,6 +452,11 @@ gst_compositor_get_property (GObject * object,
     case PROP_BACKGROUND:
       g_value_set_enum (value, self->background);
       break;
+    case PROP_N_THREADS:
+      GST_OBJECT_LOCK (self);
+      g_value_set_uint (value, self->n_threads);
+      GST_OBJECT_UNLOCK (self);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -263,6 +473,11 @@ gst_compositor_set_property (GObject * object,
     case PROP_BACKGROUND:
       self->background = g_value_get_enum (value);
       break;
+    case PROP_N_THREADS:
+      GST_OBJECT_LOCK (self);
+      self->n_threads = g_value_get_uint (value);
+      GST_OBJECT_UNLOCK (self);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -279,6 +494,7 @@ set_functions (GstCompositor * self, GstVideoInfo * info)
 
   self->blend = NULL;
   self->overlay = NULL;
+  self->copy = NULL;
   self->fill_checker = NULL;
   self->fill_color = NULL;
 
@@ -286,6 +502,7 @@ set_functions (GstCompositor * self, GstVideoInfo * info)
     case GST_VIDEO_FORMAT_AYUV:
       self->blend = gst_compositor_blend_ayuv;
       self->overlay = gst_compositor_overlay_ayuv;
+      self->copy = gst_compositor_copy_ayuv;
       self->fill_checker = gst_compositor_fill_checker_ayuv;
       self->fill_color = gst_compositor_fill_color_ayuv;
       ret = TRUE;
@@ -293,6 +510,7 @@ set_functions (GstCompositor * self, GstVideoInfo * info)
     case GST_VIDEO_FORMAT_ARGB:
       self->blend = gst_compositor_blend_argb;
       self->overlay = gst_compositor_overlay_argb;
+      self->copy = gst_compositor_copy_argb;
       self->fill_checker = gst_compositor_fill_checker_argb;
       self->fill_color = gst_compositor_fill_color_argb;
       ret = TRUE;
@@ -300,6 +518,7 @@ set_functions (GstCompositor * self, GstVideoInfo * info)
     case GST_VIDEO_FORMAT_BGRA:
       self->blend = gst_compositor_blend_bgra;
       self->overlay = gst_compositor_overlay_bgra;
+      self->copy = gst_compositor_copy_bgra;
       self->fill_checker = gst_compositor_fill_checker_bgra;
       self->fill_color = gst_compositor_fill_color_bgra;
       ret = TRUE;
@@ -307,6 +526,7 @@ set_functions (GstCompositor * self, GstVideoInfo * info)
     case GST_VIDEO_FORMAT_ABGR:
       self->blend = gst_compositor_blend_abgr;
       self->overlay = gst_compositor_overlay_abgr;
+      self->copy = gst_compositor_copy_abgr;
       self->fill_checker = gst_compositor_fill_checker_abgr;
       self->fill_color = gst_compositor_fill_color_abgr;
       ret = TRUE;
@@ -314,6 +534,7 @@ set_functions (GstCompositor * self, GstVideoInfo * info)
     case GST_VIDEO_FORMAT_RGBA:
       self->blend = gst_compositor_blend_rgba;
       self->overlay = gst_compositor_overlay_rgba;
+      self->copy = gst_compositor_copy_rgba;
       self->fill_checker = gst_compositor_fill_checker_rgba;
       self->fill_color = gst_compositor_fill_color_rgba;
       ret = TRUE;
@@ -434,6 +655,10 @@ set_functions (GstCompositor * self, GstVideoInfo * info)
       break;
   }
 
+  /* the other formats are copied by blending with an alpha of 1.0 */
+  if (self->copy == NULL)
+    self->copy = self->blend;
+
   return ret;
 }
 
@@ -451,12 +676,12 @@ _update_info (GstVideoAggregator * vagg, GstVideoInfo * info)
     gint this_width, this_height;
     gint width, height;
 
-    width = GST_VIDEO_INFO_WIDTH (&vaggpad->info);
-    height = GST_VIDEO_INFO_HEIGHT (&vaggpad->info);
-
-    if (width == 0 || height == 0)
+    if (GST_VIDEO_INFO_WIDTH (&vaggpad->info) == 0 ||
+        GST_VIDEO_INFO_HEIGHT (&vaggpad->info) == 0)
       continue;
 
+    _pad_get_output_size (compositor_pad, &width, &height);
+
     this_width = width + MAX (compositor_pad->xpos, 0);
     this_height = height + MAX (compositor_pad->ypos, 0);
 
@@ -476,75 +701,285 @@ _update_info (GstVideoAggregator * vagg, GstVideoInfo * info)
   return ret;
 }
 
-static GstFlowReturn
-gst_compositor_aggregate_frames (GstVideoAggregator * vagg, GstBuffer * outbuf)
+typedef struct
 {
-  GList *l;
-  GstCompositor *self = GST_COMPOSITOR (vagg);
-  BlendFunction composite;
-  GstVideoFrame out_frame, *outframe;
+  GstCompositor *self;
+  GstVideoFrame *outframe;
+  gint y_start, y_end;
+} CompositorBand;
 
-  if (!gst_video_frame_map (&out_frame, &vagg->info, outbuf, GST_MAP_WRITE)) {
+/* Makes @view a view of the area @rect of @frame, the position of @rect has
+ * to be aligned on the subsampling */
+static void
+_video_frame_rect (GstVideoFrame * view, const GstVideoFrame * frame,
+    const CompositorRect * rect)
+{
+  const GstVideoFormatInfo *finfo = frame->info.finfo;
+  guint c;
 
-    return GST_FLOW_ERROR;
+  *view = *frame;
+  GST_VIDEO_INFO_WIDTH (&view->info) = rect->w;
+  GST_VIDEO_INFO_HEIGHT (&view->info) = rect->h;
+
+  for (c = 0; c < GST_VIDEO_FORMAT_INFO_N_COMPONENTS (finfo); c++) {
+    guint plane = GST_VIDEO_FORMAT_INFO_PLANE (finfo, c);
+
+    view->data[plane] = (guint8 *) frame->data[plane] +
+        GST_VIDEO_FORMAT_INFO_SCALE_HEIGHT (finfo, c, rect->y) *
+        GST_VIDEO_FRAME_PLANE_STRIDE (frame, plane) +
+        GST_VIDEO_FORMAT_INFO_SCALE_WIDTH (finfo, c, rect->x) *
+        GST_VIDEO_FRAME_COMP_PSTRIDE (frame, c);
   }
+}
+
+/* Replaces the rectangles of @rects by the parts of them that are outside of
+ * @hole, which takes up to 4 rectangles for each of them */
+static GArray *
+_rects_subtract (GArray * rects, const CompositorRect * hole)
+{
+  GArray *result;
+  guint i;
+
+  result = g_array_sized_new (FALSE, FALSE, sizeof (CompositorRect),
+      rects->len + 4);
+
+  for (i = 0; i < rects->len; i++) {
+    CompositorRect *r = &g_array_index (rects, CompositorRect, i);
+    CompositorRect part;
+    gint x1, y1, x2, y2;
 
-  outframe = &out_frame;
-  /* default to blending */
-  composite = self->blend;
+    x1 = MAX (r->x, hole->x);
+    y1 = MAX (r->y, hole->y);
+    x2 = MIN (r->x + r->w, hole->x + hole->w);
+    y2 = MIN (r->y + r->h, hole->y + hole->h);
+
+    if (x1 >= x2 || y1 >= y2) {
+      g_array_append_val (result, *r);
+      continue;
+    }
+
+    /* above and below the hole, full width */
+    if (y1 > r->y) {
+      part.x = r->x;
+      part.y = r->y;
+      part.w = r->w;
+      part.h = y1 - r->y;
+      g_array_append_val (result, part);
+    }
+    if (y2 < r->y + r->h) {
+      part.x = r->x;
+      part.y = y2;
+      part.w = r->w;
+      part.h = r->y + r->h - y2;
+      g_array_append_val (result, part);
+    }
+    /* left and right of the hole */
+    if (x1 > r->x) {
+      part.x = r->x;
+      part.y = y1;
+      part.w = x1 - r->x;
+      part.h = y2 - y1;
+      g_array_append_val (result, part);
+    }
+    if (x2 < r->x + r->w) {
+      part.x = x2;
+      part.y = y1;
+      part.w = r->x + r->w - x2;
+      part.h = y2 - y1;
+      g_array_append_val (result, part);
+    }
+  }
+
+  g_array_free (rects, TRUE);
+
+  return result;
+}
+
+static void
+_fill_transparent (GstVideoFrame * frame)
+{
+  guint i, plane, num_planes, height;
+
+  num_planes = GST_VIDEO_FRAME_N_PLANES (frame);
+  for (plane = 0; plane < num_planes; ++plane) {
+    guint8 *pdata;
+    gsize rowsize, plane_stride;
+
+    pdata = GST_VIDEO_FRAME_PLANE_DATA (frame, plane);
+    plane_stride = GST_VIDEO_FRAME_PLANE_STRIDE (frame, plane);
+    rowsize = GST_VIDEO_FRAME_COMP_WIDTH (frame, plane)
+        * GST_VIDEO_FRAME_COMP_PSTRIDE (frame, plane);
+    height = GST_VIDEO_FRAME_COMP_HEIGHT (frame, plane);
+    for (i = 0; i < height; ++i) {
+      memset (pdata, 0, rowsize);
+      pdata += plane_stride;
+    }
+  }
+}
+
+static void
+gst_compositor_fill_background (GstCompositor * self, GstVideoFrame * frame)
+{
   switch (self->background) {
     case COMPOSITOR_BACKGROUND_CHECKER:
-      self->fill_checker (outframe);
+      self->fill_checker (frame);
       break;
     case COMPOSITOR_BACKGROUND_BLACK:
-      self->fill_color (outframe, 16, 128, 128);
+      self->fill_color (frame, 16, 128, 128);
       break;
     case COMPOSITOR_BACKGROUND_WHITE:
-      self->fill_color (outframe, 240, 128, 128);
+      self->fill_color (frame, 240, 128, 128);
       break;
     case COMPOSITOR_BACKGROUND_TRANSPARENT:
-    {
-      guint i, plane, num_planes, height;
-
-      num_planes = GST_VIDEO_FRAME_N_PLANES (outframe);
-      for (plane = 0; plane < num_planes; ++plane) {
-        guint8 *pdata;
-        gsize rowsize, plane_stride;
-
-        pdata = GST_VIDEO_FRAME_PLANE_DATA (outframe, plane);
-        plane_stride = GST_VIDEO_FRAME_PLANE_STRIDE (outframe, plane);
-        rowsize = GST_VIDEO_FRAME_COMP_WIDTH (outframe, plane)
-            * GST_VIDEO_FRAME_COMP_PSTRIDE (outframe, plane);
-        height = GST_VIDEO_FRAME_COMP_HEIGHT (outframe, plane);
-        for (i = 0; i < height; ++i) {
-          memset (pdata, 0, rowsize);
-          pdata += plane_stride;
-        }
-      }
-
-      /* use overlay to keep background transparent */
-      composite = self->overlay;
+      _fill_transparent (frame);
       break;
-    }
   }
+}
+
+/* Fills the background of a band of the output frame where no opaque pad
+ * covers it and blends the lines of every pad overlapping it, copying the
+ * opaque ones. Called with the OBJECT_LOCK. */
+static void
+gst_compositor_blend_band (CompositorBand * band)
+{
+  GstCompositor *self = band->self;
+  GstVideoAggregator *vagg = GST_VIDEO_AGGREGATOR (self);
+  BlendFunction composite;
+  GstVideoFrame band_frame, view;
+  CompositorRect rect;
+  GArray *uncovered;
+  gint width, height;
+  GList *l;
+  guint i;
+
+  if (band->y_start >= band->y_end)
+    return;
+
+  width = GST_VIDEO_FRAME_WIDTH (band->outframe);
+  height = band->y_end - band->y_start;
+  rect.x = 0;
+  rect.y = band->y_start;
+  rect.w = width;
+  rect.h = height;
+  _video_frame_rect (&band_frame, band->outframe, &rect);
+
+  /* Only fill the parts of the band that no opaque pad covers */
+  uncovered = g_array_new (FALSE, FALSE, sizeof (CompositorRect));
+  rect.y = 0;
+  g_array_append_val (uncovered, rect);
+
+  for (l = GST_ELEMENT (vagg)->sinkpads; l && uncovered->len; l = l->next) {
+    GstVideoAggregatorPad *pad = l->data;
+    GstCompositorPad *compo_pad = GST_COMPOSITOR_PAD (pad);
+
+    if (pad->aggregated_frame == NULL ||
+        !_pad_is_opaque (compo_pad, &vagg->info) ||
+        !_pad_get_rect (compo_pad, &vagg->info, &rect))
+      continue;
+
+    rect.y -= band->y_start;
+    uncovered = _rects_subtract (uncovered, &rect);
+  }
+
+  for (i = 0; i < uncovered->len; i++) {
+    CompositorRect *r = &g_array_index (uncovered, CompositorRect, i);
+
+    /* Grow the area to fill to keep it aligned on the chroma subsampling and
+     * the checker pattern, the pads are drawn over it anyway */
+    rect.x = GST_ROUND_DOWN_N (r->x, BAND_ALIGN);
+    rect.y = GST_ROUND_DOWN_N (r->y, BAND_ALIGN);
+    rect.w = MIN (GST_ROUND_UP_N (r->x + r->w, BAND_ALIGN), width) - rect.x;
+    rect.h = MIN (GST_ROUND_UP_N (r->y + r->h, BAND_ALIGN), height) - rect.y;
+
+    _video_frame_rect (&view, &band_frame, &rect);
+    gst_compositor_fill_background (self, &view);
+  }
+  g_array_free (uncovered, TRUE);
+
+  /* use overlay to keep background transparent, default to blending */
+  if (self->background == COMPOSITOR_BACKGROUND_TRANSPARENT)
+    composite = self->overlay;
+  else
+    composite = self->blend;
 
-  GST_OBJECT_LOCK (vagg);
   for (l = GST_ELEMENT (vagg)->sinkpads; l; l = l->next) {
     GstVideoAggregatorPad *pad = l->data;
     GstCompositorPad *compo_pad = GST_COMPOSITOR_PAD (pad);
+    BlendFunction func;
+    gint pad_height;
 
-    if (pad->aggregated_frame != NULL) {
-      composite (pad->aggregated_frame, compo_pad->xpos, compo_pad->ypos,
-          compo_pad->alpha, outframe);
-    }
+    if (pad->aggregated_frame == NULL)
+      continue;
+
+    pad_height = GST_VIDEO_FRAME_HEIGHT (pad->aggregated_frame);
+    if (compo_pad->ypos >= band->y_end ||
+        compo_pad->ypos + pad_height <= band->y_start)
+      continue;
+
+    func = _pad_is_opaque (compo_pad, &vagg->info) ? self->copy : composite;
+
+    /* the blend functions crop what is outside of the band */
+    func (pad->aggregated_frame, compo_pad->xpos,
+        compo_pad->ypos - band->y_start, compo_pad->alpha, &band_frame);
+  }
+}
+
+static GstFlowReturn
+gst_compositor_aggregate_frames (GstVideoAggregator * vagg, GstBuffer * outbuf)
+{
+  GstCompositor *self = GST_COMPOSITOR (vagg);
+  GstVideoFrame out_frame;
+  CompositorBand *bands;
+  gpointer *tasks;
+  guint n_bands, band_height, height, i;
+
+  if (!gst_video_frame_map (&out_frame, &vagg->info, outbuf, GST_MAP_WRITE)) {
+
+    return GST_FLOW_ERROR;
+  }
+
+  GST_OBJECT_LOCK (vagg);
+  if (gst_parallelized_task_runner_update (&self->task_runner,
+          self->n_threads)) {
+    GST_DEBUG_OBJECT (self, "Blending with %u threads",
+        gst_parallelized_task_runner_get_n_threads (self->task_runner));
+  }
+
+  height = GST_VIDEO_FRAME_HEIGHT (&out_frame);
+  n_bands = gst_parallelized_task_runner_get_n_threads (self->task_runner);
+  band_height = GST_ROUND_UP_N ((height + n_bands - 1) / n_bands, BAND_ALIGN);
+
+  bands = g_newa (CompositorBand, n_bands);
+  tasks = g_newa (gpointer, n_bands);
+  for (i = 0; i < n_bands; i++) {
+    bands[i].self = self;
+    bands[i].outframe = &out_frame;
+    bands[i].y_start = MIN (i * band_height, height);
+    bands[i].y_end = MIN ((i + 1) * band_height, height);
+    tasks[i] = &bands[i];
   }
+
+  gst_parallelized_task_runner_run (self->task_runner,
+      (GstParallelizedTaskFunc) gst_compositor_blend_band, tasks, n_bands);
   GST_OBJECT_UNLOCK (vagg);
 
-  gst_video_frame_unmap (outframe);
+  gst_video_frame_unmap (&out_frame);
 
   return GST_FLOW_OK;
 }
 
+static void
+gst_compositor_finalize (GObject * object)
+{
+  GstCompositor *self = GST_COMPOSITOR (object);
+
+  if (self->task_runner)
+    gst_parallelized_task_runner_free (self->task_runner);
+  self->task_runner = NULL;
+
+  G_OBJECT_CLASS (parent_class)->finalize (object);
+}
+
 /* GObject boilerplate */
 static void
 gst_compositor_class_init (GstCompositorClass * klass)
@@ -557,6 +992,7 @@ gst_compositor_class_init (GstCompositorClass * klass)
 
   gobject_class->get_property = gst_compositor_get_property;
   gobject_class->set_property = gst_compositor_set_property;
+  gobject_class->finalize = gst_compositor_finalize;
 
   agg_class->sinkpads_type = GST_TYPE_COMPOSITOR_PAD;
   videoaggregator_class->update_info = _update_info;
@@ -567,6 +1003,12 @@ gst_compositor_class_init (GstCompositorClass * klass)
           GST_TYPE_COMPOSITOR_BACKGROUND,
           DEFAULT_BACKGROUND, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  g_object_class_install_property (gobject_class, PROP_N_THREADS,
+      g_param_spec_uint ("n-threads", "Number of threads",
+          "Number of threads blending bands of the output frame "
+          "(0 = number of processors)", 0, G_MAXUINT, DEFAULT_N_THREADS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gst_element_class_add_pad_template (gstelement_class,
       gst_static_pad_template_get (&src_factory));
   gst_element_class_add_pad_template (gstelement_class,
@@ -582,6 +1024,7 @@ static void
 gst_compositor_init (GstCompositor * self)
 {
   self->background = DEFAULT_BACKGROUND;
+  self->n_threads = DEFAULT_N_THREADS;
   /* initialize variables */
 }
 
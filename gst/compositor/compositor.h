@@ -24,6 +24,7 @@
 #include <gst/gst.h>
 #include <gst/video/video.h>
 #include <gst/video/gstvideoaggregator.h>
+#include <gst/video/gstparallelizedtaskrunner.h>
 
 #include "blend.h"
 
@@ -70,9 +71,16 @@ struct _GstCompositor
   GstVideoAggregator videoaggregator;
   GstCompositorBackground background;
 
+  guint n_threads;
+
   BlendFunction blend, overlay;
+  /* for opaque pads */
+  BlendFunction copy;
   FillCheckerFunction fill_checker;
   FillColorFunction fill_color;
+
+  /* blends horizontal bands of the output frame in parallel */
+  GstParallelizedTaskRunner *task_runner;
 };
 
 struct _GstCompositorClass
@@ -50,6 +50,7 @@ struct _GstCompositorPad
 
   /* properties */
   gint xpos, ypos;
+  gint width, height;
   guint zorder;
   gdouble alpha;
 };
@@ -26,10 +26,10 @@
 #include <string.h>
 
 #include <gst/gst.h>
-#include <gst/base/gstcollectpads.h>
 #include <gst/video/video.h>
 
 #include "gstcompare.h"
+#include "gstcomparemetrics.h"
 
 GST_DEBUG_CATEGORY_STATIC (compare_debug);
 #define GST_CAT_DEFAULT   compare_debug
@@ -55,7 +55,9 @@ enum GstCompareMethod
 {
   GST_COMPARE_METHOD_MEM,
   GST_COMPARE_METHOD_MAX,
-  GST_COMPARE_METHOD_SSIM
+  GST_COMPARE_METHOD_SSIM,
+  GST_COMPARE_METHOD_PSNR,
+  GST_COMPARE_METHOD_MS_SSIM
 };
 
 #define GST_COMPARE_METHOD_TYPE (gst_compare_method_get_type())
@@ -68,6 +70,8 @@ gst_compare_method_get_type (void)
     {GST_COMPARE_METHOD_MEM, "Memory", "mem"},
     {GST_COMPARE_METHOD_MAX, "Maximum metric", "max"},
     {GST_COMPARE_METHOD_SSIM, "SSIM (raw video)", "ssim"},
+    {GST_COMPARE_METHOD_PSNR, "PSNR in dB (raw video)", "psnr"},
+    {GST_COMPARE_METHOD_MS_SSIM, "MS-SSIM (raw video)", "ms-ssim"},
     {0, NULL, NULL}
   };
 
@@ -92,6 +96,8 @@ enum
   PROP_METHOD,
   PROP_THRESHOLD,
   PROP_UPPER,
+  PROP_POST_MESSAGES,
+  PROP_N_THREADS,
   PROP_LAST
 };
 
@@ -100,31 +106,34 @@ enum
 #define DEFAULT_METHOD           GST_COMPARE_METHOD_MEM
 #define DEFAULT_THRESHOLD        0
 #define DEFAULT_UPPER            TRUE
+#define DEFAULT_POST_MESSAGES    FALSE
+#define DEFAULT_N_THREADS        0
 
 static void gst_compare_set_property (GObject * object,
     guint prop_id, const GValue * value, GParamSpec * pspec);
 static void gst_compare_get_property (GObject * object,
     guint prop_id, GValue * value, GParamSpec * pspec);
 
-static void gst_compare_reset (GstCompare * overlay);
-
-static gboolean gst_compare_query (GstPad * pad, GstObject * parent,
-    GstQuery * query);
-static GstFlowReturn gst_compare_collect_pads (GstCollectPads * cpads,
-    GstCompare * comp);
-
-static GstStateChangeReturn gst_compare_change_state (GstElement * element,
-    GstStateChange transition);
+static gboolean gst_compare_start (GstAggregator * agg);
+static GstFlowReturn gst_compare_flush (GstAggregator * agg);
+static gboolean gst_compare_sink_event (GstAggregator * agg,
+    GstAggregatorPad * aggpad, GstEvent * event);
+static gboolean gst_compare_src_query (GstAggregator * agg, GstQuery * query);
+static GstFlowReturn gst_compare_aggregate (GstAggregator * agg);
 
 #define gst_compare_parent_class parent_class
-G_DEFINE_TYPE (GstCompare, gst_compare, GST_TYPE_ELEMENT);
+G_DEFINE_TYPE (GstCompare, gst_compare, GST_TYPE_AGGREGATOR);
 
 static void
 gst_compare_finalize (GObject * object)
 {
   GstCompare *comp = GST_COMPARE (object);
 
-  gst_object_unref (comp->cpads);
+  if (comp->task_runner)
+    gst_parallelized_task_runner_free (comp->task_runner);
+  comp->task_runner = NULL;
+  gst_caps_replace (&comp->sink_caps, NULL);
+  gst_caps_replace (&comp->check_caps, NULL);
 
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
@@ -134,13 +143,19 @@ gst_compare_class_init (GstCompareClass * klass)
 {
   GObjectClass *gobject_class;
   GstElementClass *gstelement_class;
+  GstAggregatorClass *agg_class;
 
   gobject_class = (GObjectClass *) klass;
   gstelement_class = (GstElementClass *) klass;
+  agg_class = (GstAggregatorClass *) klass;
 
   GST_DEBUG_CATEGORY_INIT (compare_debug, "compare", 0, "Compare buffers");
 
-  gstelement_class->change_state = GST_DEBUG_FUNCPTR (gst_compare_change_state);
+  agg_class->start = GST_DEBUG_FUNCPTR (gst_compare_start);
+  agg_class->flush = GST_DEBUG_FUNCPTR (gst_compare_flush);
+  agg_class->sink_event = GST_DEBUG_FUNCPTR (gst_compare_sink_event);
+  agg_class->src_query = GST_DEBUG_FUNCPTR (gst_compare_src_query);
+  agg_class->aggregate = GST_DEBUG_FUNCPTR (gst_compare_aggregate);
 
   gobject_class->set_property = gst_compare_set_property;
   gobject_class->get_property = gst_compare_get_property;
@@ -169,6 +184,16 @@ gst_compare_class_init (GstCompareClass * klass)
       g_param_spec_boolean ("upper", "Threshold Upper Bound",
           "Whether threshold value is upper bound or lower bound for difference measure",
           DEFAULT_UPPER, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (gobject_class, PROP_POST_MESSAGES,
+      g_param_spec_boolean ("post-messages", "Post Messages",
+          "Post a compare element message with the difference measure of "
+          "every pair of buffers", DEFAULT_POST_MESSAGES,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (gobject_class, PROP_N_THREADS,
+      g_param_spec_uint ("n-threads", "Number of threads",
+          "Number of threads comparing raw video frames "
+          "(0 = number of processors)", 0, G_MAXUINT, DEFAULT_N_THREADS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
   gst_element_class_add_pad_template (gstelement_class,
       gst_static_pad_template_get (&src_factory));
@@ -181,31 +206,30 @@ gst_compare_class_init (GstCompareClass * klass)
       "Mark Nauwelaerts <mark.nauwelaerts@collabora.co.uk>");
 }
 
-static void
-gst_compare_init (GstCompare * comp)
+static GstPad *
+gst_compare_add_sink_pad (GstCompare * comp, const gchar * name)
 {
-  comp->cpads = gst_collect_pads_new ();
-  gst_collect_pads_set_function (comp->cpads,
-      (GstCollectPadsFunction) GST_DEBUG_FUNCPTR (gst_compare_collect_pads),
-      comp);
+  GstPadTemplate *templ;
+  GstPad *pad;
 
-  comp->sinkpad = gst_pad_new_from_static_template (&sink_factory, "sink");
-  GST_PAD_SET_PROXY_CAPS (comp->sinkpad);
-  gst_element_add_pad (GST_ELEMENT (comp), comp->sinkpad);
+  templ = gst_element_class_get_pad_template (GST_ELEMENT_GET_CLASS (comp),
+      name);
+  pad = g_object_new (GST_TYPE_AGGREGATOR_PAD, "name", name, "direction",
+      GST_PAD_SINK, "template", templ, NULL);
+  gst_element_add_pad (GST_ELEMENT (comp), pad);
 
-  comp->checkpad =
-      gst_pad_new_from_static_template (&check_sink_factory, "check");
-  gst_pad_set_query_function (comp->checkpad, gst_compare_query);
-  gst_element_add_pad (GST_ELEMENT (comp), comp->checkpad);
+  return pad;
+}
 
-  gst_collect_pads_add_pad (comp->cpads, comp->sinkpad,
-      sizeof (GstCollectData), NULL, TRUE);
-  gst_collect_pads_add_pad (comp->cpads, comp->checkpad,
-      sizeof (GstCollectData), NULL, TRUE);
+static void
+gst_compare_init (GstCompare * comp)
+{
+  comp->sinkpad = gst_compare_add_sink_pad (comp, "sink");
+  GST_PAD_SET_PROXY_CAPS (comp->sinkpad);
+  comp->checkpad = gst_compare_add_sink_pad (comp, "check");
 
-  comp->srcpad = gst_pad_new_from_static_template (&src_factory, "src");
-  gst_pad_set_query_function (comp->srcpad, gst_compare_query);
-  gst_element_add_pad (GST_ELEMENT (comp), comp->srcpad);
+  comp->sink_skip_end = GST_CLOCK_TIME_NONE;
+  comp->check_skip_end = GST_CLOCK_TIME_NONE;
 
   /* init properties */
   comp->meta = DEFAULT_META;
@@ -213,25 +237,73 @@ gst_compare_init (GstCompare * comp)
   comp->method = DEFAULT_METHOD;
   comp->threshold = DEFAULT_THRESHOLD;
   comp->upper = DEFAULT_UPPER;
+  comp->post_messages = DEFAULT_POST_MESSAGES;
+  comp->n_threads = DEFAULT_N_THREADS;
+}
 
-  gst_compare_reset (comp);
+static gboolean
+gst_compare_start (GstAggregator * agg)
+{
+  GstCompare *comp = GST_COMPARE (agg);
+
+  comp->count = 0;
+  comp->sink_skip_end = GST_CLOCK_TIME_NONE;
+  comp->check_skip_end = GST_CLOCK_TIME_NONE;
+
+  return TRUE;
 }
 
-static void
-gst_compare_reset (GstCompare * comp)
+static GstFlowReturn
+gst_compare_flush (GstAggregator * agg)
 {
+  GstCompare *comp = GST_COMPARE (agg);
+
+  comp->sink_skip_end = GST_CLOCK_TIME_NONE;
+  comp->check_skip_end = GST_CLOCK_TIME_NONE;
+
+  return GST_FLOW_OK;
 }
 
 static gboolean
-gst_compare_query (GstPad * pad, GstObject * parent, GstQuery * query)
+gst_compare_sink_event (GstAggregator * agg, GstAggregatorPad * aggpad,
+    GstEvent * event)
 {
-  GstCompare *comp;
-  GstPad *otherpad;
+  GstCompare *comp = GST_COMPARE (agg);
+
+  /* the output has the caps of the sink pad, those of the check pad are only
+   * used for comparing. The event comes after the buffers queued before it,
+   * the current caps of the pads can be newer than the queued buffers. */
+  if (GST_EVENT_TYPE (event) == GST_EVENT_CAPS) {
+    GstCaps *caps;
+
+    gst_event_parse_caps (event, &caps);
+    GST_OBJECT_LOCK (comp);
+    if (GST_PAD_CAST (aggpad) == comp->sinkpad)
+      gst_caps_replace (&comp->sink_caps, caps);
+    else
+      gst_caps_replace (&comp->check_caps, caps);
+    GST_OBJECT_UNLOCK (comp);
+
+    if (GST_PAD_CAST (aggpad) == comp->sinkpad)
+      gst_aggregator_set_src_caps (agg, caps);
+    gst_event_unref (event);
+    return TRUE;
+  }
 
-  comp = GST_COMPARE (parent);
-  otherpad = (pad == comp->srcpad ? comp->sinkpad : comp->srcpad);
+  return GST_AGGREGATOR_CLASS (parent_class)->sink_event (agg, aggpad, event);
+}
 
-  return gst_pad_peer_query (otherpad, query);
+static gboolean
+gst_compare_src_query (GstAggregator * agg, GstQuery * query)
+{
+  switch (GST_QUERY_TYPE (query)) {
+    case GST_QUERY_LATENCY:
+    case GST_QUERY_SEEKING:
+      return GST_AGGREGATOR_CLASS (parent_class)->src_query (agg, query);
+    default:
+      /* the output is the stream of the sink pad */
+      return gst_pad_peer_query (GST_COMPARE (agg)->sinkpad, query);
+  }
 }
 
 static void
@@ -349,90 +421,19 @@ gst_compare_max (GstCompare * comp, GstBuffer * buf1, GstCaps * caps1,
   return delta;
 }
 
-static double
-gst_compare_ssim_window (GstCompare * comp, guint8 * data1, guint8 * data2,
-    gint width, gint height, gint step, gint stride)
-{
-  gint count = 0, i, j;
-  gint sum1 = 0, sum2 = 0, ssum1 = 0, ssum2 = 0, acov = 0;
-  gdouble avg1, avg2, var1, var2, cov;
-
-  const gdouble k1 = 0.01;
-  const gdouble k2 = 0.03;
-  const gdouble L = 255.0;
-  const gdouble c1 = (k1 * L) * (k1 * L);
-  const gdouble c2 = (k2 * L) * (k2 * L);
-
-  /* For empty images, return maximum similarity */
-  if (height <= 0 || width <= 0)
-    return 1.0;
-
-  /* plain and simple; no fancy optimizations */
-  for (i = 0; i < height; i++) {
-    for (j = 0; j < width; j++) {
-      sum1 += *data1;
-      sum2 += *data2;
-      ssum1 += *data1 * *data1;
-      ssum2 += *data2 * *data2;
-      acov += *data1 * *data2;
-      count++;
-      data1 += step;
-      data2 += step;
-    }
-    data1 -= j * step;
-    data2 -= j * step;
-    data1 += stride;
-    data2 += stride;
-  }
-
-  avg1 = sum1 / count;
-  avg2 = sum2 / count;
-  var1 = ssum1 / count - avg1 * avg1;
-  var2 = ssum2 / count - avg2 * avg2;
-  cov = acov / count - avg1 * avg2;
-
-  return (2 * avg1 * avg2 + c1) * (2 * cov + c2) /
-      ((avg1 * avg1 + avg2 * avg2 + c1) * (var1 + var2 + c2));
-}
-
-/* @width etc are for the particular component */
+/* The weighted sum of the metric of the components, or the PSNR of all
+ * samples. The metric of each component is appended to @components. */
 static gdouble
-gst_compare_ssim_component (GstCompare * comp, guint8 * data1, guint8 * data2,
-    gint width, gint height, gint step, gint stride)
-{
-  const gint window = 16;
-  gdouble ssim_sum = 0;
-  gint count = 0, i, j;
-
-  for (j = 0; j + (window / 2) < height; j += (window / 2)) {
-    for (i = 0; i + (window / 2) < width; i += (window / 2)) {
-      gdouble ssim;
-
-      ssim = gst_compare_ssim_window (comp, data1 + step * i + j * stride,
-          data2 + step * i + j * stride,
-          MIN (window, width - i), MIN (window, height - j), step, stride);
-      GST_LOG_OBJECT (comp, "ssim for %dx%d at (%d, %d) = %f", window, window,
-          i, j, ssim);
-      ssim_sum += ssim;
-      count++;
-    }
-  }
-
-  /* For empty images, return maximum similarity */
-  if (count == 0)
-    return 1.0;
-
-  return (ssim_sum / count);
-}
-
-static gdouble
-gst_compare_ssim (GstCompare * comp, GstBuffer * buf1, GstCaps * caps1,
-    GstBuffer * buf2, GstCaps * caps2)
+gst_compare_video (GstCompare * comp, GstBuffer * buf1, GstCaps * caps1,
+    GstBuffer * buf2, GstCaps * caps2, GstCompareMetric metric,
+    GValue * components)
 {
   GstVideoInfo info1, info2;
   GstVideoFrame frame1, frame2;
   gint i, comps;
-  gdouble cssim[4], ssim, c[4] = { 1.0, 0.0, 0.0, 0.0 };
+  gdouble cvalue[4], value, c[4] = { 1.0, 0.0, 0.0, 0.0 };
+  guint64 sse = 0, n_samples = 0;
+  guint n_threads;
 
   if (!caps1)
     goto invalid_input;
@@ -443,7 +444,7 @@ gst_compare_ssim (GstCompare * comp, GstBuffer * buf1, GstCaps * caps1,
   if (!caps2)
     goto invalid_input;
 
-  if (!gst_video_info_from_caps (&info2, caps1))
+  if (!gst_video_info_from_caps (&info2, caps2))
     goto invalid_input;
 
   if (GST_VIDEO_INFO_FORMAT (&info1) != GST_VIDEO_INFO_FORMAT (&info2) ||
@@ -452,6 +453,12 @@ gst_compare_ssim (GstCompare * comp, GstBuffer * buf1, GstCaps * caps1,
     return comp->threshold + 1;
 
   comps = GST_VIDEO_INFO_N_COMPONENTS (&info1);
+  for (i = 0; i < comps; i++) {
+    /* only support most common formats */
+    if (GST_VIDEO_INFO_COMP_DEPTH (&info1, i) != 8)
+      goto unsupported_input;
+  }
+
   /* note that some are reported both yuv and gray */
   for (i = 0; i < comps; ++i)
     c[i] = 1.0;
@@ -462,44 +469,70 @@ gst_compare_ssim (GstCompare * comp, GstBuffer * buf1, GstCaps * caps1,
     c[i] /= (GST_VIDEO_INFO_IS_YUV (&info1) && (comps > 1)) ?
         2 * (comps - 1) : comps;
 
-  gst_video_frame_map (&frame1, &info1, buf1, GST_MAP_READ);
-  gst_video_frame_map (&frame2, &info2, buf2, GST_MAP_READ);
+  if (!gst_video_frame_map (&frame1, &info1, buf1, GST_MAP_READ))
+    goto invalid_input;
+  if (!gst_video_frame_map (&frame2, &info2, buf2, GST_MAP_READ)) {
+    gst_video_frame_unmap (&frame1);
+    goto invalid_input;
+  }
+
+  GST_OBJECT_LOCK (comp);
+  n_threads = comp->n_threads;
+  GST_OBJECT_UNLOCK (comp);
+
+  /* the task runner is only used from the aggregation thread */
+  if (gst_parallelized_task_runner_update (&comp->task_runner, n_threads)) {
+    GST_DEBUG_OBJECT (comp, "Comparing with %u threads",
+        gst_parallelized_task_runner_get_n_threads (comp->task_runner));
+  }
 
   for (i = 0; i < comps; i++) {
-    gint cw, ch, step, stride;
+    gint cw, ch;
+    guint64 csse;
 
-    /* only support most common formats */
-    if (GST_VIDEO_INFO_COMP_DEPTH (&info1, i) != 8)
-      goto unsupported_input;
     cw = GST_VIDEO_FRAME_COMP_WIDTH (&frame1, i);
     ch = GST_VIDEO_FRAME_COMP_HEIGHT (&frame1, i);
-    step = GST_VIDEO_FRAME_COMP_PSTRIDE (&frame1, i);
-    stride = GST_VIDEO_FRAME_COMP_STRIDE (&frame1, i);
 
-    GST_LOG_OBJECT (comp, "component %d", i);
-    cssim[i] = gst_compare_ssim_component (comp,
+    cvalue[i] = gst_compare_metrics_component (metric, comp->task_runner,
         GST_VIDEO_FRAME_COMP_DATA (&frame1, i),
-        GST_VIDEO_FRAME_COMP_DATA (&frame2, i), cw, ch, step, stride);
-    GST_LOG_OBJECT (comp, "ssim[%d] = %f", i, cssim[i]);
+        GST_VIDEO_FRAME_COMP_STRIDE (&frame1, i),
+        GST_VIDEO_FRAME_COMP_DATA (&frame2, i),
+        GST_VIDEO_FRAME_COMP_STRIDE (&frame2, i),
+        GST_VIDEO_FRAME_COMP_PSTRIDE (&frame1, i), cw, ch, &csse);
+    sse += csse;
+    n_samples += (guint64) cw * ch;
+
+    GST_LOG_OBJECT (comp, "component %d = %f", i, cvalue[i]);
   }
 
   gst_video_frame_unmap (&frame1);
   gst_video_frame_unmap (&frame2);
 
-#ifndef GST_DISABLE_GST_DEBUG
-  for (i = 0; i < 4; i++) {
-    GST_DEBUG_OBJECT (comp, "ssim[%d] = %f, c[%d] = %f", i, cssim[i], i, c[i]);
+  for (i = 0; i < comps; i++) {
+    GValue v = G_VALUE_INIT;
+
+    GST_DEBUG_OBJECT (comp, "value[%d] = %f, c[%d] = %f", i, cvalue[i], i,
+        c[i]);
+    g_value_init (&v, G_TYPE_DOUBLE);
+    g_value_set_double (&v, cvalue[i]);
+    gst_value_array_append_value (components, &v);
+    g_value_unset (&v);
   }
-#endif
 
-  ssim = cssim[0] * c[0] + cssim[1] * c[1] + cssim[2] * c[2] + cssim[3] * c[3];
+  if (metric == GST_COMPARE_METRIC_PSNR) {
+    value = gst_compare_metrics_psnr (sse, n_samples);
+  } else {
+    value = 0;
+    for (i = 0; i < comps; i++)
+      value += cvalue[i] * c[i];
+  }
 
-  return ssim;
+  return value;
 
   /* ERRORS */
 invalid_input:
   {
-    GST_ERROR_OBJECT (comp, "ssim method needs raw video input");
+    GST_ERROR_OBJECT (comp, "video methods need raw video input");
     return 0;
   }
 unsupported_input:
@@ -512,27 +545,35 @@ unsupported_input:
 
 static void
 gst_compare_buffers (GstCompare * comp, GstBuffer * buf1, GstCaps * caps1,
-    GstBuffer * buf2, GstCaps * caps2)
+    GstBuffer * buf2, GstCaps * caps2, GstClockTime running_time)
 {
+  GValue components = G_VALUE_INIT;
   gdouble delta = 0;
   gsize size1, size2;
+  gboolean video;
 
   /* first check metadata */
   gst_compare_meta (comp, buf1, caps1, buf2, caps2);
 
   size1 = gst_buffer_get_size (buf1);
-  size2 = gst_buffer_get_size (buf1);
+  size2 = gst_buffer_get_size (buf2);
+
+  /* video frames may have different strides, their caps are compared */
+  video = comp->method != GST_COMPARE_METHOD_MEM &&
+      comp->method != GST_COMPARE_METHOD_MAX;
+  if (video)
+    g_value_init (&components, GST_TYPE_ARRAY);
 
   /* check content according to method */
   /* but at least size should match */
-  if (size1 != size2) {
+  if (size1 != size2 && !video) {
     delta = comp->threshold + 1;
   } else {
     GstMapInfo map1, map2;
 
     gst_buffer_map (buf1, &map1, GST_MAP_READ);
     gst_buffer_map (buf2, &map2, GST_MAP_READ);
-    GST_MEMDUMP_OBJECT (comp, "buffer 1", map1.data, map2.size);
+    GST_MEMDUMP_OBJECT (comp, "buffer 1", map1.data, map1.size);
     GST_MEMDUMP_OBJECT (comp, "buffer 2", map2.data, map2.size);
     gst_buffer_unmap (buf1, &map1);
     gst_buffer_unmap (buf2, &map2);
@@ -544,7 +585,16 @@ gst_compare_buffers (GstCompare * comp, GstBuffer * buf1, GstCaps * caps1,
         delta = gst_compare_max (comp, buf1, caps1, buf2, caps2);
         break;
       case GST_COMPARE_METHOD_SSIM:
-        delta = gst_compare_ssim (comp, buf1, caps1, buf2, caps2);
+        delta = gst_compare_video (comp, buf1, caps1, buf2, caps2,
+            GST_COMPARE_METRIC_SSIM, &components);
+        break;
+      case GST_COMPARE_METHOD_PSNR:
+        delta = gst_compare_video (comp, buf1, caps1, buf2, caps2,
+            GST_COMPARE_METRIC_PSNR, &components);
+        break;
+      case GST_COMPARE_METHOD_MS_SSIM:
+        delta = gst_compare_video (comp, buf1, caps1, buf2, caps2,
+            GST_COMPARE_METRIC_MS_SSIM, &components);
         break;
       default:
         g_assert_not_reached ();
@@ -554,58 +604,196 @@ gst_compare_buffers (GstCompare * comp, GstBuffer * buf1, GstCaps * caps1,
 
   if ((comp->upper && delta > comp->threshold) ||
       (!comp->upper && delta < comp->threshold)) {
+    GstStructure *s;
+
     GST_WARNING_OBJECT (comp, "buffers %p and %p failed content match %f",
         buf1, buf2, delta);
 
+    s = gst_structure_new ("delta", "content", G_TYPE_DOUBLE, delta, NULL);
+    if (video)
+      gst_structure_set_value (s, "components", &components);
     gst_element_post_message (GST_ELEMENT (comp),
-        gst_message_new_element (GST_OBJECT (comp),
-            gst_structure_new ("delta", "content", G_TYPE_DOUBLE, delta,
-                NULL)));
+        gst_message_new_element (GST_OBJECT (comp), s));
+  }
+
+  if (comp->post_messages) {
+    GstStructure *s;
+
+    s = gst_structure_new ("compare", "running-time", G_TYPE_UINT64,
+        running_time, "content", G_TYPE_DOUBLE, delta, NULL);
+    if (video)
+      gst_structure_set_value (s, "components", &components);
+    gst_element_post_message (GST_ELEMENT (comp),
+        gst_message_new_element (GST_OBJECT (comp), s));
+  }
+
+  if (video)
+    g_value_unset (&components);
+}
+
+static void
+gst_compare_count_missing (GstCompare * comp, GstBuffer * buf)
+{
+  GST_WARNING_OBJECT (comp, "buffer %p != NULL", buf);
+
+  comp->count++;
+  gst_element_post_message (GST_ELEMENT (comp),
+      gst_message_new_element (GST_OBJECT (comp),
+          gst_structure_new ("delta", "count", G_TYPE_INT, comp->count,
+              NULL)));
+}
+
+static GstClockTime
+gst_compare_running_time (GstAggregatorPad * pad, GstClockTime ts)
+{
+  if (pad->segment.format != GST_FORMAT_TIME || !GST_CLOCK_TIME_IS_VALID (ts))
+    return GST_CLOCK_TIME_NONE;
+
+  return gst_segment_to_running_time (&pad->segment, GST_FORMAT_TIME, ts);
+}
+
+static GstClockTime
+gst_compare_running_time_end (GstAggregatorPad * pad, GstBuffer * buf)
+{
+  GstClockTime end = GST_BUFFER_PTS (buf);
+
+  if (GST_CLOCK_TIME_IS_VALID (end) && GST_BUFFER_DURATION_IS_VALID (buf))
+    end += GST_BUFFER_DURATION (buf);
+
+  return gst_compare_running_time (pad, end);
+}
+
+/* Steals the buffer of @pad if it ends before @skip_end */
+static GstBuffer *
+gst_compare_steal_skipped (GstAggregatorPad * pad, GstClockTime skip_end)
+{
+  GstBuffer *buf;
+  GstClockTime end;
+
+  if (!GST_CLOCK_TIME_IS_VALID (skip_end))
+    return NULL;
+
+  buf = gst_aggregator_pad_get_buffer (pad);
+  if (buf == NULL)
+    return NULL;
+  end = gst_compare_running_time_end (pad, buf);
+  gst_buffer_unref (buf);
+
+  if (!GST_CLOCK_TIME_IS_VALID (end) || end > skip_end)
+    return NULL;
+
+  return gst_aggregator_pad_steal_buffer (pad);
+}
+
+/* Whether @pad has a buffer, or will not have one in time */
+static gboolean
+gst_compare_pad_is_ready (GstAggregatorPad * pad)
+{
+  GstBuffer *buf;
+
+  buf = gst_aggregator_pad_get_buffer (pad);
+  if (buf) {
+    gst_buffer_unref (buf);
+    return TRUE;
+  }
+
+  return pad->eos || gst_aggregator_pad_is_late (pad);
+}
+
+/* Pushes the buffer of the sink pad with its timestamps in running time, the
+ * time base of the output segment */
+static GstFlowReturn
+gst_compare_finish_buffer (GstCompare * comp, GstBuffer * buf)
+{
+  GstAggregator *agg = GST_AGGREGATOR (comp);
+  GstAggregatorPad *sinkpad = GST_AGGREGATOR_PAD (comp->sinkpad);
+  GstClockTime end;
+
+  end = gst_compare_running_time_end (sinkpad, buf);
+  if (GST_CLOCK_TIME_IS_VALID (end))
+    agg->segment.position = MAX (agg->segment.position, end);
+
+  if (sinkpad->segment.format == GST_FORMAT_TIME) {
+    buf = gst_buffer_make_writable (buf);
+    GST_BUFFER_PTS (buf) = gst_compare_running_time (sinkpad,
+        GST_BUFFER_PTS (buf));
+    GST_BUFFER_DTS (buf) = gst_compare_running_time (sinkpad,
+        GST_BUFFER_DTS (buf));
   }
+
+  return gst_aggregator_finish_buffer (agg, buf);
 }
 
+/* Pairs the buffers of the sink and check pads in order. In live pipelines,
+ * a buffer whose counterpart missed the deadline is handled alone, and the
+ * late buffers of the other pad that end before it are then not compared. */
 static GstFlowReturn
-gst_compare_collect_pads (GstCollectPads * cpads, GstCompare * comp)
+gst_compare_aggregate (GstAggregator * agg)
 {
+  GstCompare *comp = GST_COMPARE (agg);
+  GstAggregatorPad *sinkpad = GST_AGGREGATOR_PAD (comp->sinkpad);
+  GstAggregatorPad *checkpad = GST_AGGREGATOR_PAD (comp->checkpad);
   GstBuffer *buf1, *buf2;
   GstCaps *caps1, *caps2;
+  GstClockTime end;
+  GstFlowReturn ret = GST_FLOW_OK;
+
+  while ((buf2 = gst_compare_steal_skipped (checkpad, comp->check_skip_end))) {
+    gst_compare_count_missing (comp, buf2);
+    gst_buffer_unref (buf2);
+  }
+  while (ret == GST_FLOW_OK &&
+      (buf1 = gst_compare_steal_skipped (sinkpad, comp->sink_skip_end))) {
+    gst_compare_count_missing (comp, buf1);
+    ret = gst_compare_finish_buffer (comp, buf1);
+  }
+
+  if (ret != GST_FLOW_OK || !gst_compare_pad_is_ready (sinkpad) ||
+      !gst_compare_pad_is_ready (checkpad))
+    return ret;
 
-  buf1 = gst_collect_pads_pop (comp->cpads,
-      gst_pad_get_element_private (comp->sinkpad));
-  caps1 = gst_pad_get_current_caps (comp->sinkpad);
+  /* taken before the buffers, a caps event coming after them can only be
+   * handled once they are stolen */
+  GST_OBJECT_LOCK (comp);
+  caps1 = comp->sink_caps ? gst_caps_ref (comp->sink_caps) : NULL;
+  caps2 = comp->check_caps ? gst_caps_ref (comp->check_caps) : NULL;
+  GST_OBJECT_UNLOCK (comp);
 
-  buf2 = gst_collect_pads_pop (comp->cpads,
-      gst_pad_get_element_private (comp->checkpad));
-  caps2 = gst_pad_get_current_caps (comp->checkpad);
+  buf1 = gst_aggregator_pad_steal_buffer (sinkpad);
+  buf2 = gst_aggregator_pad_steal_buffer (checkpad);
 
   if (!buf1 && !buf2) {
-    gst_pad_push_event (comp->srcpad, gst_event_new_eos ());
-    return GST_FLOW_EOS;
+    if (sinkpad->eos && checkpad->eos)
+      ret = GST_FLOW_EOS;
   } else if (buf1 && buf2) {
-    gst_compare_buffers (comp, buf1, caps1, buf2, caps2);
+    gst_compare_buffers (comp, buf1, caps1, buf2, caps2,
+        gst_compare_running_time (sinkpad, GST_BUFFER_PTS (buf1)));
+  } else if (buf1) {
+    gst_compare_count_missing (comp, buf1);
+    end = gst_compare_running_time_end (sinkpad, buf1);
+    if (GST_CLOCK_TIME_IS_VALID (end) && !checkpad->eos)
+      comp->check_skip_end = end;
   } else {
-    GST_WARNING_OBJECT (comp, "buffer %p != NULL", buf1 ? buf1 : buf2);
-
-    comp->count++;
-    gst_element_post_message (GST_ELEMENT (comp),
-        gst_message_new_element (GST_OBJECT (comp),
-            gst_structure_new ("delta", "count", G_TYPE_INT, comp->count,
-                NULL)));
+    gst_compare_count_missing (comp, buf2);
+    end = gst_compare_running_time_end (checkpad, buf2);
+    if (GST_CLOCK_TIME_IS_VALID (end)) {
+      if (!sinkpad->eos)
+        comp->sink_skip_end = end;
+      agg->segment.position = MAX (agg->segment.position, end);
+    }
   }
 
   if (buf1)
-    gst_pad_push (comp->srcpad, buf1);
+    ret = gst_compare_finish_buffer (comp, buf1);
 
   if (buf2)
     gst_buffer_unref (buf2);
-
   if (caps1)
     gst_caps_unref (caps1);
-
   if (caps2)
     gst_caps_unref (caps2);
 
-  return GST_FLOW_OK;
+  return ret;
 }
 
 static void
@@ -630,6 +818,14 @@ gst_compare_set_property (GObject * object, guint prop_id,
     case PROP_UPPER:
       comp->upper = g_value_get_boolean (value);
       break;
+    case PROP_POST_MESSAGES:
+      comp->post_messages = g_value_get_boolean (value);
+      break;
+    case PROP_N_THREADS:
+      GST_OBJECT_LOCK (comp);
+      comp->n_threads = g_value_get_uint (value);
+      GST_OBJECT_UNLOCK (comp);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -658,42 +854,16 @@ gst_compare_get_property (GObject * object, guint prop_id, GValue * value,
     case PROP_UPPER:
       g_value_set_boolean (value, comp->upper);
       break;
-    default:
-      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+    case PROP_POST_MESSAGES:
+      g_value_set_boolean (value, comp->post_messages);
       break;
-  }
-}
-
-static GstStateChangeReturn
-gst_compare_change_state (GstElement * element, GstStateChange transition)
-{
-  GstCompare *comp = GST_COMPARE (element);
-  GstStateChangeReturn ret;
-
-  switch (transition) {
-    case GST_STATE_CHANGE_NULL_TO_READY:
-    case GST_STATE_CHANGE_READY_TO_PAUSED:
-      gst_collect_pads_start (comp->cpads);
-      break;
-    case GST_STATE_CHANGE_PAUSED_TO_READY:
-      gst_collect_pads_stop (comp->cpads);
-      break;
-    default:
-      break;
-  }
-
-  ret = GST_CALL_PARENT_WITH_DEFAULT (GST_ELEMENT_CLASS, change_state,
-      (element, transition), GST_STATE_CHANGE_SUCCESS);
-  if (ret != GST_STATE_CHANGE_SUCCESS)
-    return ret;
-
-  switch (transition) {
-    case GST_STATE_CHANGE_PAUSED_TO_READY:
-      gst_compare_reset (comp);
+    case PROP_N_THREADS:
+      GST_OBJECT_LOCK (comp);
+      g_value_set_uint (value, comp->n_threads);
+      GST_OBJECT_UNLOCK (comp);
       break;
     default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
   }
-
-  return GST_STATE_CHANGE_SUCCESS;
 }
@@ -26,6 +26,8 @@
 
 
 #include <gst/gst.h>
+#include <gst/base/gstaggregator.h>
+#include <gst/video/gstparallelizedtaskrunner.h>
 
 G_BEGIN_DECLS
 
@@ -46,26 +48,37 @@ typedef struct _GstCompare GstCompare;
 typedef struct _GstCompareClass GstCompareClass;
 
 struct _GstCompare {
-  GstElement element;
+  GstAggregator aggregator;
 
-  GstPad *srcpad;
   GstPad *sinkpad;
   GstPad *checkpad;
 
-  GstCollectPads *cpads;
-
   gint count;
 
+  /* running times up to which the buffers of a pad are not compared, as
+   * the other pad missed their live deadline */
+  GstClockTime sink_skip_end;
+  GstClockTime check_skip_end;
+
+  /* caps of the buffers at the head of the pads, set when their caps event
+   * is dequeued, protected by the object lock */
+  GstCaps *sink_caps;
+  GstCaps *check_caps;
+
+  GstParallelizedTaskRunner *task_runner;
+
   /* properties */
   GstBufferCopyFlags meta;
   gboolean offset_ts;
   gint method;
   gdouble threshold;
   gboolean upper;
+  gboolean post_messages;
+  guint n_threads;
 };
 
 struct _GstCompareClass {
-  GstElementClass parent_class;
+  GstAggregatorClass parent_class;
 };
 
 GType gst_compare_get_type(void);
@@ -0,0 +1,421 @@
+/* GStreamer
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* PSNR, SSIM and MS-SSIM of 8 bit video components.
+ *
+ * The SSIM windows are 16x16 samples and overlap by 8 samples, so each of
+ * them is made of 2x2 blocks of 8x8 samples (fewer on the right and bottom
+ * edges). The sums, sums of squares and cross products of the samples of
+ * both images are computed once per block, in bands of block rows run on a
+ * GstParallelizedTaskRunner, and those of a window are the sums of those of
+ * its 4 blocks. The squared error of the component follows from the same
+ * sums. MS-SSIM repeats this on images halved in size at each scale. */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <math.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "gstcomparemetrics.h"
+
+#define BLOCK_SIZE 8
+
+#define MS_SSIM_SCALES 5
+static const gdouble ms_ssim_weights[MS_SSIM_SCALES] = {
+  0.0448, 0.2856, 0.3001, 0.2363, 0.1333
+};
+
+typedef struct
+{
+  guint32 sum1, sum2;
+  guint32 ssum1, ssum2;
+  guint32 cross;
+  guint32 count;
+} CompareBlock;
+
+typedef struct
+{
+  const guint8 *data1, *data2;
+  gint stride1, stride2;
+  gint step, width, height;
+
+  /* block rows by_start to by_end of blocks, n_bx blocks per row */
+  CompareBlock *blocks;
+  gint n_bx;
+  gint by_start, by_end;
+} CompareBand;
+
+static void
+compare_block_c (const guint8 * data1, gint stride1, const guint8 * data2,
+    gint stride2, gint step, gint width, gint height, CompareBlock * block)
+{
+  guint32 sum1 = 0, sum2 = 0, ssum1 = 0, ssum2 = 0, cross = 0;
+  gint x, y;
+
+  for (y = 0; y < height; y++) {
+    for (x = 0; x < width; x++) {
+      guint32 a = data1[x * step], b = data2[x * step];
+
+      sum1 += a;
+      sum2 += b;
+      ssum1 += a * a;
+      ssum2 += b * b;
+      cross += a * b;
+    }
+    data1 += stride1;
+    data2 += stride2;
+  }
+
+  block->sum1 = sum1;
+  block->sum2 = sum2;
+  block->ssum1 = ssum1;
+  block->ssum2 = ssum2;
+  block->cross = cross;
+  block->count = width * height;
+}
+
+#ifdef __SSE2__
+static inline guint32
+compare_hsum_sse2 (__m128i v)
+{
+  v = _mm_add_epi32 (v, _mm_shuffle_epi32 (v, _MM_SHUFFLE (1, 0, 3, 2)));
+  v = _mm_add_epi32 (v, _mm_shuffle_epi32 (v, _MM_SHUFFLE (2, 3, 0, 1)));
+
+  return _mm_cvtsi128_si32 (v);
+}
+
+/* 2 consecutive blocks of BLOCK_SIZE samples wide with a step of 1. The
+ * samples are widened to 16 bits, the sums of 8 rows fit in 16 bits and the
+ * products are added pairwise to 32 bits by pmaddwd. */
+static void
+compare_blocks_sse2 (const guint8 * data1, gint stride1, const guint8 * data2,
+    gint stride2, gint height, CompareBlock * blocks)
+{
+  const __m128i zero = _mm_setzero_si128 ();
+  const __m128i one = _mm_set1_epi16 (1);
+  __m128i sum1[2], sum2[2], ssum1[2], ssum2[2], cross[2];
+  gint i, y;
+
+  for (i = 0; i < 2; i++)
+    sum1[i] = sum2[i] = ssum1[i] = ssum2[i] = cross[i] = zero;
+
+  for (y = 0; y < height; y++) {
+    __m128i a = _mm_loadu_si128 ((const __m128i *) data1);
+    __m128i b = _mm_loadu_si128 ((const __m128i *) data2);
+    __m128i a16[2], b16[2];
+
+    a16[0] = _mm_unpacklo_epi8 (a, zero);
+    a16[1] = _mm_unpackhi_epi8 (a, zero);
+    b16[0] = _mm_unpacklo_epi8 (b, zero);
+    b16[1] = _mm_unpackhi_epi8 (b, zero);
+
+    for (i = 0; i < 2; i++) {
+      sum1[i] = _mm_add_epi16 (sum1[i], a16[i]);
+      sum2[i] = _mm_add_epi16 (sum2[i], b16[i]);
+      ssum1[i] = _mm_add_epi32 (ssum1[i], _mm_madd_epi16 (a16[i], a16[i]));
+      ssum2[i] = _mm_add_epi32 (ssum2[i], _mm_madd_epi16 (b16[i], b16[i]));
+      cross[i] = _mm_add_epi32 (cross[i], _mm_madd_epi16 (a16[i], b16[i]));
+    }
+
+    data1 += stride1;
+    data2 += stride2;
+  }
+
+  for (i = 0; i < 2; i++) {
+    blocks[i].sum1 = compare_hsum_sse2 (_mm_madd_epi16 (sum1[i], one));
+    blocks[i].sum2 = compare_hsum_sse2 (_mm_madd_epi16 (sum2[i], one));
+    blocks[i].ssum1 = compare_hsum_sse2 (ssum1[i]);
+    blocks[i].ssum2 = compare_hsum_sse2 (ssum2[i]);
+    blocks[i].cross = compare_hsum_sse2 (cross[i]);
+    blocks[i].count = BLOCK_SIZE * height;
+  }
+}
+#endif
+
+static void
+compare_band (CompareBand * band)
+{
+  gint bx, by;
+
+  for (by = band->by_start; by < band->by_end; by++) {
+    const guint8 *row1 = band->data1 + by * BLOCK_SIZE * band->stride1;
+    const guint8 *row2 = band->data2 + by * BLOCK_SIZE * band->stride2;
+    CompareBlock *blocks = band->blocks + by * band->n_bx;
+    gint height = MIN (BLOCK_SIZE, band->height - by * BLOCK_SIZE);
+
+    bx = 0;
+#ifdef __SSE2__
+    if (band->step == 1) {
+      for (; (bx + 2) * BLOCK_SIZE <= band->width; bx += 2)
+        compare_blocks_sse2 (row1 + bx * BLOCK_SIZE, band->stride1,
+            row2 + bx * BLOCK_SIZE, band->stride2, height, &blocks[bx]);
+    }
+#endif
+    for (; bx < band->n_bx; bx++) {
+      gint x = bx * BLOCK_SIZE;
+
+      compare_block_c (row1 + x * band->step, band->stride1,
+          row2 + x * band->step, band->stride2, band->step,
+          MIN (BLOCK_SIZE, band->width - x), height, &blocks[bx]);
+    }
+  }
+}
+
+/* Returns the n_bx x n_by blocks of the images, free with g_free() */
+static CompareBlock *
+compare_blocks (GstParallelizedTaskRunner * runner, const guint8 * data1,
+    gint stride1, const guint8 * data2, gint stride2, gint step, gint width,
+    gint height, gint * n_bx, gint * n_by)
+{
+  CompareBlock *blocks;
+  CompareBand *bands;
+  gpointer *tasks;
+  gint n_bands, band_rows, i;
+
+  *n_bx = (width + BLOCK_SIZE - 1) / BLOCK_SIZE;
+  *n_by = (height + BLOCK_SIZE - 1) / BLOCK_SIZE;
+  blocks = g_new (CompareBlock, *n_bx * *n_by);
+
+  n_bands = gst_parallelized_task_runner_get_n_threads (runner);
+  band_rows = (*n_by + n_bands - 1) / n_bands;
+
+  bands = g_newa (CompareBand, n_bands);
+  tasks = g_newa (gpointer, n_bands);
+  for (i = 0; i < n_bands; i++) {
+    bands[i].data1 = data1;
+    bands[i].data2 = data2;
+    bands[i].stride1 = stride1;
+    bands[i].stride2 = stride2;
+    bands[i].step = step;
+    bands[i].width = width;
+    bands[i].height = height;
+    bands[i].blocks = blocks;
+    bands[i].n_bx = *n_bx;
+    bands[i].by_start = MIN (i * band_rows, *n_by);
+    bands[i].by_end = MIN ((i + 1) * band_rows, *n_by);
+    tasks[i] = &bands[i];
+  }
+
+  gst_parallelized_task_runner_run (runner,
+      (GstParallelizedTaskFunc) compare_band, tasks, n_bands);
+
+  return blocks;
+}
+
+/* Mean SSIM and mean contrast-structure term of the windows */
+static void
+compare_windows (const CompareBlock * blocks, gint n_bx, gint n_by,
+    gdouble * ssim, gdouble * cs)
+{
+  const gdouble c1 = (0.01 * 255) * (0.01 * 255);
+  const gdouble c2 = (0.03 * 255) * (0.03 * 255);
+  gdouble ssim_sum = 0, cs_sum = 0;
+  gint bx, by, count = 0;
+
+  for (by = 0; by + 1 < n_by; by++) {
+    const CompareBlock *top = blocks + by * n_bx;
+    const CompareBlock *bottom = top + n_bx;
+
+    for (bx = 0; bx + 1 < n_bx; bx++) {
+      gdouble n, avg1, avg2, var1, var2, cov, l, c;
+
+#define WINDOW_SUM(f) \
+    (top[bx].f + top[bx + 1].f + bottom[bx].f + bottom[bx + 1].f)
+      n = WINDOW_SUM (count);
+      avg1 = WINDOW_SUM (sum1) / n;
+      avg2 = WINDOW_SUM (sum2) / n;
+      var1 = WINDOW_SUM (ssum1) / n - avg1 * avg1;
+      var2 = WINDOW_SUM (ssum2) / n - avg2 * avg2;
+      cov = WINDOW_SUM (cross) / n - avg1 * avg2;
+#undef WINDOW_SUM
+
+      l = (2 * avg1 * avg2 + c1) / (avg1 * avg1 + avg2 * avg2 + c1);
+      c = (2 * cov + c2) / (var1 + var2 + c2);
+      ssim_sum += l * c;
+      cs_sum += c;
+      count++;
+    }
+  }
+
+  /* For empty images, return maximum similarity */
+  if (count == 0) {
+    *ssim = *cs = 1.0;
+  } else {
+    *ssim = ssim_sum / count;
+    *cs = cs_sum / count;
+  }
+}
+
+static guint64
+compare_sse (const CompareBlock * blocks, gint n_blocks)
+{
+  guint64 sse = 0;
+  gint i;
+
+  for (i = 0; i < n_blocks; i++)
+    sse += (guint64) blocks[i].ssum1 + blocks[i].ssum2 - 2 *
+        (guint64) blocks[i].cross;
+
+  return sse;
+}
+
+/* Halves @width and @height by averaging 2x2 samples, free with g_free() */
+static guint8 *
+compare_downsample (const guint8 * data, gint stride, gint step, gint width,
+    gint height)
+{
+  guint8 *scaled, *out;
+  gint x, y;
+
+  width /= 2;
+  height /= 2;
+  out = scaled = g_malloc (width * height);
+
+  for (y = 0; y < height; y++) {
+    const guint8 *p0 = data + 2 * y * stride;
+    const guint8 *p1 = p0 + stride;
+
+    for (x = 0; x < width; x++) {
+      *out++ = (p0[2 * x * step] + p0[(2 * x + 1) * step] +
+          p1[2 * x * step] + p1[(2 * x + 1) * step] + 2) >> 2;
+    }
+  }
+
+  return scaled;
+}
+
+static gdouble
+compare_ms_ssim (GstParallelizedTaskRunner * runner, const guint8 * data1,
+    gint stride1, const guint8 * data2, gint stride2, gint step, gint width,
+    gint height, gdouble ssim, gdouble cs)
+{
+  guint8 *scaled1 = NULL, *scaled2 = NULL;
+  gdouble ms_ssim = 1.0, weights = 0;
+  gint scale;
+
+  /* negative terms are clamped, the weights of the scales left out for small
+   * images are spread over the others */
+  for (scale = 0;; scale++) {
+    CompareBlock *blocks;
+    guint8 *tmp1, *tmp2;
+    gint n_bx, n_by;
+
+    if (scale == MS_SSIM_SCALES - 1 || width / 2 <= BLOCK_SIZE ||
+        height / 2 <= BLOCK_SIZE) {
+      ms_ssim *= pow (MAX (ssim, 0), ms_ssim_weights[scale]);
+      weights += ms_ssim_weights[scale];
+      break;
+    }
+    ms_ssim *= pow (MAX (cs, 0), ms_ssim_weights[scale]);
+    weights += ms_ssim_weights[scale];
+
+    tmp1 = compare_downsample (data1, stride1, step, width, height);
+    tmp2 = compare_downsample (data2, stride2, step, width, height);
+    g_free (scaled1);
+    g_free (scaled2);
+    data1 = scaled1 = tmp1;
+    data2 = scaled2 = tmp2;
+    width /= 2;
+    height /= 2;
+    stride1 = stride2 = width;
+    step = 1;
+
+    blocks = compare_blocks (runner, data1, stride1, data2, stride2, step,
+        width, height, &n_bx, &n_by);
+    compare_windows (blocks, n_bx, n_by, &ssim, &cs);
+    g_free (blocks);
+  }
+
+  g_free (scaled1);
+  g_free (scaled2);
+
+  return pow (ms_ssim, 1.0 / weights);
+}
+
+/**
+ * gst_compare_metrics_component:
+ * @metric: the metric to compute
+ * @runner: runs the bands of the images
+ * @data1: the first sample of the component of the first image
+ * @stride1: the stride of @data1
+ * @data2: the first sample of the component of the second image
+ * @stride2: the stride of @data2
+ * @step: the distance between 2 samples of a row of both images
+ * @width: the width of the component
+ * @height: the height of the component
+ * @sse: returns the sum of the squared errors
+ *
+ * Returns: @metric of the component, in dB for PSNR
+ */
+gdouble
+gst_compare_metrics_component (GstCompareMetric metric,
+    GstParallelizedTaskRunner * runner, const guint8 * data1, gint stride1,
+    const guint8 * data2, gint stride2, gint step, gint width, gint height,
+    guint64 * sse)
+{
+  CompareBlock *blocks;
+  gdouble result, ssim, cs;
+  gint n_bx, n_by;
+
+  blocks = compare_blocks (runner, data1, stride1, data2, stride2, step,
+      width, height, &n_bx, &n_by);
+  *sse = compare_sse (blocks, n_bx * n_by);
+
+  switch (metric) {
+    case GST_COMPARE_METRIC_PSNR:
+      result = gst_compare_metrics_psnr (*sse, (guint64) width * height);
+      break;
+    case GST_COMPARE_METRIC_SSIM:
+      compare_windows (blocks, n_bx, n_by, &result, &cs);
+      break;
+    case GST_COMPARE_METRIC_MS_SSIM:
+      compare_windows (blocks, n_bx, n_by, &ssim, &cs);
+      result = compare_ms_ssim (runner, data1, stride1, data2, stride2, step,
+          width, height, ssim, cs);
+      break;
+    default:
+      g_assert_not_reached ();
+      result = 0;
+      break;
+  }
+
+  g_free (blocks);
+
+  return result;
+}
+
+/**
+ * gst_compare_metrics_psnr:
+ * @sse: the sum of the squared errors of 8 bit samples
+ * @n_samples: the number of samples
+ *
+ * Returns: the PSNR in dB, infinite for identical samples
+ */
+gdouble
+gst_compare_metrics_psnr (guint64 sse, guint64 n_samples)
+{
+  if (sse == 0)
+    return INFINITY;
+
+  return 10 * log10 (255.0 * 255.0 * n_samples / sse);
+}
@@ -0,0 +1,45 @@
+/* GStreamer
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __GST_COMPARE_METRICS_H__
+#define __GST_COMPARE_METRICS_H__
+
+#include <gst/gst.h>
+#include <gst/video/gstparallelizedtaskrunner.h>
+
+G_BEGIN_DECLS
+
+typedef enum
+{
+  GST_COMPARE_METRIC_PSNR,
+  GST_COMPARE_METRIC_SSIM,
+  GST_COMPARE_METRIC_MS_SSIM
+} GstCompareMetric;
+
+gdouble gst_compare_metrics_component (GstCompareMetric metric,
+                                       GstParallelizedTaskRunner * runner,
+                                       const guint8 * data1, gint stride1,
+                                       const guint8 * data2, gint stride2,
+                                       gint step, gint width, gint height,
+                                       guint64 * sse);
+
+gdouble gst_compare_metrics_psnr      (guint64 sse, guint64 n_samples);
+
+G_END_DECLS
+
+#endif /* __GST_COMPARE_METRICS_H__ */
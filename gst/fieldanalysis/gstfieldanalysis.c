@@ -54,6 +54,8 @@
  * gst-launch -v uridecodebin uri=/path/to/foo.bar ! fieldanalysis ! deinterlace ! videoconvert ! autovideosink
  * ]| This pipeline will analyse a video stream with default metrics and thresholds and output progressive frames.
  * </refsect2>
+ *
+ * The metrics are computed on #GstFieldAnalysis:n-threads threads.
  */
 
 #ifdef HAVE_CONFIG_H
@@ -62,6 +64,7 @@
 
 #include <gst/gst.h>
 #include <gst/video/video.h>
+#include <gst/video/gstparallelizedtaskrunner.h>
 #include <string.h>
 #include <stdlib.h>             /* for abs() */
 
@@ -82,6 +85,7 @@ GST_DEBUG_CATEGORY_STATIC (gst_field_analysis_debug);
 #define DEFAULT_BLOCK_HEIGHT 16
 #define DEFAULT_BLOCK_THRESH 80
 #define DEFAULT_IGNORED_LINES 2
+#define DEFAULT_N_THREADS 0
 
 enum
 {
@@ -96,7 +100,8 @@ enum
   PROP_BLOCK_WIDTH,
   PROP_BLOCK_HEIGHT,
   PROP_BLOCK_THRESH,
-  PROP_IGNORED_LINES
+  PROP_IGNORED_LINES,
+  PROP_N_THREADS
 };
 
 static GstStaticPadTemplate sink_factory =
@@ -171,7 +176,7 @@ gst_fieldanalysis_frame_metric_get_type (void)
     static const GEnumValue fieldanalyis_frame_metrics[] = {
       {GST_FIELDANALYSIS_5_TAP, "5-tap [1,-3,4,-3,1] Vertical Filter", "5-tap"},
       {GST_FIELDANALYSIS_WINDOWED_COMB,
-            "Windowed Comb Detection (not optimised)",
+            "Windowed Comb Detection",
           "windowed-comb"},
       {0, NULL, NULL},
     };
@@ -274,6 +279,11 @@ gst_field_analysis_class_init (GstFieldAnalysisClass * klass)
           "Ignore this many lines from the top and bottom for windowed comb detection",
           2, G_MAXUINT64, DEFAULT_IGNORED_LINES,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (gobject_class, PROP_N_THREADS,
+      g_param_spec_uint ("n-threads", "Number of threads",
+          "Number of threads computing the metrics on bands of the frames "
+          "(0 = number of processors)", 0, G_MAXUINT, DEFAULT_N_THREADS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
   gstelement_class->change_state =
       GST_DEBUG_FUNCPTR (gst_field_analysis_change_state);
@@ -299,12 +309,15 @@ static gfloat same_parity_3_tap (GstFieldAnalysis * filter,
     FieldAnalysisFields (*history)[2]);
 static gfloat opposite_parity_5_tap (GstFieldAnalysis * filter,
     FieldAnalysisFields (*history)[2]);
-static guint64 block_score_for_row_32detect (GstFieldAnalysis * filter,
-    FieldAnalysisFields (*history)[2], guint8 * base_fj, guint8 * base_fjp1);
-static guint64 block_score_for_row_iscombed (GstFieldAnalysis * filter,
-    FieldAnalysisFields (*history)[2], guint8 * base_fj, guint8 * base_fjp1);
-static guint64 block_score_for_row_5_tap (GstFieldAnalysis * filter,
-    FieldAnalysisFields (*history)[2], guint8 * base_fj, guint8 * base_fjp1);
+static void comb_mask_32detect (guint8 * comb_mask, const guint8 * fjm2,
+    const guint8 * fjm1, const guint8 * fj, const guint8 * fjp1,
+    const guint8 * fjp2, gint64 spatial_thresh, gint incr, gint width);
+static void comb_mask_iscombed (guint8 * comb_mask, const guint8 * fjm2,
+    const guint8 * fjm1, const guint8 * fj, const guint8 * fjp1,
+    const guint8 * fjp2, gint64 spatial_thresh, gint incr, gint width);
+static void comb_mask_5_tap (guint8 * comb_mask, const guint8 * fjm2,
+    const guint8 * fjm1, const guint8 * fj, const guint8 * fjp1,
+    const guint8 * fjp2, gint64 spatial_thresh, gint incr, gint width);
 static gfloat opposite_parity_windowed_comb (GstFieldAnalysis * filter,
     FieldAnalysisFields (*history)[2]);
 
@@ -327,10 +340,6 @@ gst_field_analysis_reset (GstFieldAnalysis * filter)
   filter->is_telecine = FALSE;
   filter->first_buffer = TRUE;
   gst_video_info_init (&filter->vinfo);
-  g_free (filter->comb_mask);
-  filter->comb_mask = NULL;
-  g_free (filter->block_scores);
-  filter->block_scores = NULL;
 }
 
 static void
@@ -354,12 +363,13 @@ gst_field_analysis_init (GstFieldAnalysis * filter)
   filter->same_frame = &opposite_parity_5_tap;
   filter->frame_thresh = DEFAULT_FRAME_THRESH;
   filter->noise_floor = DEFAULT_NOISE_FLOOR;
-  filter->block_score_for_row = &block_score_for_row_5_tap;
+  filter->comb_mask_for_line = &comb_mask_5_tap;
   filter->spatial_thresh = DEFAULT_SPATIAL_THRESH;
   filter->block_width = DEFAULT_BLOCK_WIDTH;
   filter->block_height = DEFAULT_BLOCK_HEIGHT;
   filter->block_thresh = DEFAULT_BLOCK_THRESH;
   filter->ignored_lines = DEFAULT_IGNORED_LINES;
+  filter->n_threads = DEFAULT_N_THREADS;
 }
 
 static void
@@ -408,13 +418,13 @@ gst_field_analysis_set_property (GObject * object, guint prop_id,
     case PROP_COMB_METHOD:
       switch (g_value_get_enum (value)) {
         case METHOD_32DETECT:
-          filter->block_score_for_row = &block_score_for_row_32detect;
+          filter->comb_mask_for_line = &comb_mask_32detect;
           break;
         case METHOD_IS_COMBED:
-          filter->block_score_for_row = &block_score_for_row_iscombed;
+          filter->comb_mask_for_line = &comb_mask_iscombed;
           break;
         case METHOD_5_TAP:
-          filter->block_score_for_row = &block_score_for_row_5_tap;
+          filter->comb_mask_for_line = &comb_mask_5_tap;
           break;
         default:
           break;
@@ -425,18 +435,6 @@ gst_field_analysis_set_property (GObject * object, guint prop_id,
       break;
     case PROP_BLOCK_WIDTH:
       filter->block_width = g_value_get_uint64 (value);
-      if (GST_VIDEO_FRAME_WIDTH (&filter->frames[0].frame)) {
-        const gint frame_width =
-            GST_VIDEO_FRAME_WIDTH (&filter->frames[0].frame);
-        if (filter->block_scores) {
-          gsize nbytes = (frame_width / filter->block_width) * sizeof (guint);
-          filter->block_scores = g_realloc (filter->block_scores, nbytes);
-          memset (filter->block_scores, 0, nbytes);
-        } else {
-          filter->block_scores =
-              g_malloc0 ((frame_width / filter->block_width) * sizeof (guint));
-        }
-      }
       break;
     case PROP_BLOCK_HEIGHT:
       filter->block_height = g_value_get_uint64 (value);
@@ -447,6 +445,11 @@ gst_field_analysis_set_property (GObject * object, guint prop_id,
     case PROP_IGNORED_LINES:
       filter->ignored_lines = g_value_get_uint64 (value);
       break;
+    case PROP_N_THREADS:
+      GST_OBJECT_LOCK (filter);
+      filter->n_threads = g_value_get_uint (value);
+      GST_OBJECT_UNLOCK (filter);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -496,11 +499,11 @@ gst_field_analysis_get_property (GObject * object, guint prop_id,
     case PROP_COMB_METHOD:
     {
       FieldAnalysisCombMethod method = DEFAULT_COMB_METHOD;
-      if (filter->block_score_for_row == &block_score_for_row_32detect) {
+      if (filter->comb_mask_for_line == &comb_mask_32detect) {
         method = METHOD_32DETECT;
-      } else if (filter->block_score_for_row == &block_score_for_row_iscombed) {
+      } else if (filter->comb_mask_for_line == &comb_mask_iscombed) {
         method = METHOD_IS_COMBED;
-      } else if (filter->block_score_for_row == &block_score_for_row_5_tap) {
+      } else if (filter->comb_mask_for_line == &comb_mask_5_tap) {
         method = METHOD_5_TAP;
       }
       g_value_set_enum (value, method);
@@ -521,6 +524,11 @@ gst_field_analysis_get_property (GObject * object, guint prop_id,
     case PROP_IGNORED_LINES:
       g_value_set_uint64 (value, filter->ignored_lines);
       break;
+    case PROP_N_THREADS:
+      GST_OBJECT_LOCK (filter);
+      g_value_set_uint (value, filter->n_threads);
+      GST_OBJECT_UNLOCK (filter);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -530,7 +538,6 @@ gst_field_analysis_get_property (GObject * object, guint prop_id,
 static void
 gst_field_analysis_update_format (GstFieldAnalysis * filter, GstCaps * caps)
 {
-  gint width;
   GQueue *outbufs;
   GstVideoInfo vinfo;
 
@@ -565,25 +572,7 @@ gst_field_analysis_update_format (GstFieldAnalysis * filter, GstCaps * caps)
 
   GST_OBJECT_LOCK (filter);
   filter->flushing = FALSE;
-
   filter->vinfo = vinfo;
-  width = GST_VIDEO_INFO_WIDTH (&filter->vinfo);
-
-  /* update allocations for metric scores */
-  if (filter->comb_mask) {
-    filter->comb_mask = g_realloc (filter->comb_mask, width);
-  } else {
-    filter->comb_mask = g_malloc (width);
-  }
-  if (filter->block_scores) {
-    gsize nbytes = (width / filter->block_width) * sizeof (guint);
-    filter->block_scores = g_realloc (filter->block_scores, nbytes);
-    memset (filter->block_scores, 0, nbytes);
-  } else {
-    filter->block_scores =
-        g_malloc0 ((width / filter->block_width) * sizeof (guint));
-  }
-
   GST_OBJECT_UNLOCK (filter);
   return;
 }
@@ -804,454 +793,398 @@ gst_field_analysis_sink_event (GstPad * pad, GstObject * parent,
 }
 
 
+/* the metrics are computed on bands of lines, or of rows of blocks, on the
+ * threads of the task runner. the result of each line or row is kept and they
+ * are only combined once all bands are done, in the same order as when
+ * computed on a single thread, so that the scores do not depend on the number
+ * of threads */
+typedef struct
+{
+  GstFieldAnalysis *filter;
+  FieldAnalysisFields (*history)[2];
+  guint start, end;
+  gpointer results;
+} FieldAnalysisBand;
+
+typedef void (*FieldAnalysisBandFunc) (FieldAnalysisBand * band);
+
+static void
+gst_field_analysis_run_bands (GstFieldAnalysis * filter,
+    FieldAnalysisFields (*history)[2], FieldAnalysisBandFunc func,
+    guint n_lines, gpointer results)
+{
+  FieldAnalysisBand *bands;
+  gpointer *tasks;
+  guint n_bands, band_lines, i;
+
+  n_bands = gst_parallelized_task_runner_get_n_threads (filter->task_runner);
+  band_lines = (n_lines + n_bands - 1) / n_bands;
+
+  bands = g_newa (FieldAnalysisBand, n_bands);
+  tasks = g_newa (gpointer, n_bands);
+  for (i = 0; i < n_bands; i++) {
+    bands[i].filter = filter;
+    bands[i].history = history;
+    bands[i].start = MIN (i * band_lines, n_lines);
+    bands[i].end = MIN ((i + 1) * band_lines, n_lines);
+    bands[i].results = results;
+    tasks[i] = &bands[i];
+  }
+
+  gst_parallelized_task_runner_run (filter->task_runner,
+      (GstParallelizedTaskFunc) func, tasks, n_bands);
+}
+
+/* line j of the field of the given parity of the frame */
+static inline guint8 *
+field_line (GstVideoFrame * frame, gint parity, gint j)
+{
+  return GST_VIDEO_FRAME_COMP_DATA (frame, 0) +
+      GST_VIDEO_FRAME_COMP_OFFSET (frame, 0) +
+      (2 * j + parity) * GST_VIDEO_FRAME_COMP_STRIDE (frame, 0);
+}
+
+/* adds up the results of the lines in order */
 static gfloat
-same_parity_sad (GstFieldAnalysis * filter, FieldAnalysisFields (*history)[2])
+sum_lines (const guint32 * line_sums, guint n_lines)
 {
-  gint j;
-  gfloat sum;
-  guint8 *f1j, *f2j;
+  gfloat sum = 0.0f;
+  guint j;
+
+  for (j = 0; j < n_lines; j++)
+    sum += line_sums[j];
+
+  return sum;
+}
+
+static void
+same_parity_sad_band (FieldAnalysisBand * band)
+{
+  FieldAnalysisFields (*history)[2] = band->history;
+  guint32 *line_sums = band->results;
+  guint j;
 
   const gint width = GST_VIDEO_FRAME_WIDTH (&(*history)[0].frame);
-  const gint height = GST_VIDEO_FRAME_HEIGHT (&(*history)[0].frame);
-  const gint stride0x2 =
-      GST_VIDEO_FRAME_COMP_STRIDE (&(*history)[0].frame, 0) << 1;
-  const gint stride1x2 =
-      GST_VIDEO_FRAME_COMP_STRIDE (&(*history)[1].frame, 0) << 1;
-  const guint32 noise_floor = filter->noise_floor;
-
-  f1j =
-      GST_VIDEO_FRAME_COMP_DATA (&(*history)[0].frame,
-      0) + GST_VIDEO_FRAME_COMP_OFFSET (&(*history)[0].frame,
-      0) +
-      (*history)[0].parity * GST_VIDEO_FRAME_COMP_STRIDE (&(*history)[0].frame,
-      0);
-  f2j =
-      GST_VIDEO_FRAME_COMP_DATA (&(*history)[1].frame,
-      0) + GST_VIDEO_FRAME_COMP_OFFSET (&(*history)[1].frame,
-      0) +
-      (*history)[1].parity * GST_VIDEO_FRAME_COMP_STRIDE (&(*history)[1].frame,
-      0);
-
-  sum = 0.0f;
-  for (j = 0; j < (height >> 1); j++) {
-    guint32 tempsum = 0;
-    fieldanalysis_orc_same_parity_sad_planar_yuv (&tempsum, f1j, f2j,
+  const guint32 noise_floor = band->filter->noise_floor;
+
+  for (j = band->start; j < band->end; j++) {
+    line_sums[j] = 0;
+    fieldanalysis_orc_same_parity_sad_planar_yuv (&line_sums[j],
+        field_line (&(*history)[0].frame, (*history)[0].parity, j),
+        field_line (&(*history)[1].frame, (*history)[1].parity, j),
         noise_floor, width);
-    sum += tempsum;
-    f1j += stride0x2;
-    f2j += stride1x2;
   }
-
-  return sum / (0.5f * width * height);
 }
 
 static gfloat
-same_parity_ssd (GstFieldAnalysis * filter, FieldAnalysisFields (*history)[2])
+same_parity_sad (GstFieldAnalysis * filter, FieldAnalysisFields (*history)[2])
 {
-  gint j;
   gfloat sum;
-  guint8 *f1j, *f2j;
+  guint32 *line_sums;
 
   const gint width = GST_VIDEO_FRAME_WIDTH (&(*history)[0].frame);
   const gint height = GST_VIDEO_FRAME_HEIGHT (&(*history)[0].frame);
-  const gint stride0x2 =
-      GST_VIDEO_FRAME_COMP_STRIDE (&(*history)[0].frame, 0) << 1;
-  const gint stride1x2 =
-      GST_VIDEO_FRAME_COMP_STRIDE (&(*history)[1].frame, 0) << 1;
+
+  line_sums = g_new (guint32, height >> 1);
+  gst_field_analysis_run_bands (filter, history, same_parity_sad_band,
+      height >> 1, line_sums);
+  sum = sum_lines (line_sums, height >> 1);
+  g_free (line_sums);
+
+  return sum / (0.5f * width * height);
+}
+
+static void
+same_parity_ssd_band (FieldAnalysisBand * band)
+{
+  FieldAnalysisFields (*history)[2] = band->history;
+  guint32 *line_sums = band->results;
+  guint j;
+
+  const gint width = GST_VIDEO_FRAME_WIDTH (&(*history)[0].frame);
   /* noise floor needs to be squared for SSD */
-  const guint32 noise_floor = filter->noise_floor * filter->noise_floor;
-
-  f1j =
-      GST_VIDEO_FRAME_COMP_DATA (&(*history)[0].frame,
-      0) + GST_VIDEO_FRAME_COMP_OFFSET (&(*history)[0].frame,
-      0) +
-      (*history)[0].parity * GST_VIDEO_FRAME_COMP_STRIDE (&(*history)[0].frame,
-      0);
-  f2j =
-      GST_VIDEO_FRAME_COMP_DATA (&(*history)[1].frame,
-      0) + GST_VIDEO_FRAME_COMP_OFFSET (&(*history)[1].frame,
-      0) +
-      (*history)[1].parity * GST_VIDEO_FRAME_COMP_STRIDE (&(*history)[1].frame,
-      0);
-
-  sum = 0.0f;
-  for (j = 0; j < (height >> 1); j++) {
-    guint32 tempsum = 0;
-    fieldanalysis_orc_same_parity_ssd_planar_yuv (&tempsum, f1j, f2j,
+  const guint32 noise_floor =
+      band->filter->noise_floor * band->filter->noise_floor;
+
+  for (j = band->start; j < band->end; j++) {
+    line_sums[j] = 0;
+    fieldanalysis_orc_same_parity_ssd_planar_yuv (&line_sums[j],
+        field_line (&(*history)[0].frame, (*history)[0].parity, j),
+        field_line (&(*history)[1].frame, (*history)[1].parity, j),
         noise_floor, width);
-    sum += tempsum;
-    f1j += stride0x2;
-    f2j += stride1x2;
   }
-
-  return sum / (0.5f * width * height); /* field is half height */
 }
 
-/* horizontal [1,4,1] diff between fields - is this a good idea or should the
- * current sample be emphasised more or less? */
 static gfloat
-same_parity_3_tap (GstFieldAnalysis * filter, FieldAnalysisFields (*history)[2])
+same_parity_ssd (GstFieldAnalysis * filter, FieldAnalysisFields (*history)[2])
 {
-  gint i, j;
   gfloat sum;
-  guint8 *f1j, *f2j;
+  guint32 *line_sums;
 
   const gint width = GST_VIDEO_FRAME_WIDTH (&(*history)[0].frame);
   const gint height = GST_VIDEO_FRAME_HEIGHT (&(*history)[0].frame);
-  const gint stride0x2 =
-      GST_VIDEO_FRAME_COMP_STRIDE (&(*history)[0].frame, 0) << 1;
-  const gint stride1x2 =
-      GST_VIDEO_FRAME_COMP_STRIDE (&(*history)[1].frame, 0) << 1;
+
+  line_sums = g_new (guint32, height >> 1);
+  gst_field_analysis_run_bands (filter, history, same_parity_ssd_band,
+      height >> 1, line_sums);
+  sum = sum_lines (line_sums, height >> 1);
+  g_free (line_sums);
+
+  return sum / (0.5f * width * height); /* field is half height */
+}
+
+/* each line has three results: the first sample, the samples in between and
+ * the last sample */
+static void
+same_parity_3_tap_band (FieldAnalysisBand * band)
+{
+  FieldAnalysisFields (*history)[2] = band->history;
+  guint32 *line_sums = band->results;
+  guint j;
+
+  const gint width = GST_VIDEO_FRAME_WIDTH (&(*history)[0].frame);
   const gint incr = GST_VIDEO_FRAME_COMP_PSTRIDE (&(*history)[0].frame, 0);
   /* noise floor needs to be *6 for [1,4,1] */
-  const guint32 noise_floor = filter->noise_floor * 6;
-
-  f1j = GST_VIDEO_FRAME_COMP_DATA (&(*history)[0].frame, 0) +
-      GST_VIDEO_FRAME_COMP_OFFSET (&(*history)[0].frame, 0) +
-      (*history)[0].parity * GST_VIDEO_FRAME_COMP_STRIDE (&(*history)[0].frame,
-      0);
-  f2j =
-      GST_VIDEO_FRAME_COMP_DATA (&(*history)[1].frame,
-      0) + GST_VIDEO_FRAME_COMP_OFFSET (&(*history)[1].frame,
-      0) +
-      (*history)[1].parity * GST_VIDEO_FRAME_COMP_STRIDE (&(*history)[1].frame,
-      0);
-
-  sum = 0.0f;
-  for (j = 0; j < (height >> 1); j++) {
-    guint32 tempsum = 0;
+  const guint32 noise_floor = band->filter->noise_floor * 6;
+
+  for (j = band->start; j < band->end; j++) {
+    const guint8 *f1j =
+        field_line (&(*history)[0].frame, (*history)[0].parity, j);
+    const guint8 *f2j =
+        field_line (&(*history)[1].frame, (*history)[1].parity, j);
+    guint32 *sums = &line_sums[3 * j];
     guint32 diff;
+    gint i;
 
     /* unroll first as it is a special case */
     diff = abs (((f1j[0] << 2) + (f1j[incr] << 1))
         - ((f2j[0] << 2) + (f2j[incr] << 1)));
-    if (diff > noise_floor)
-      sum += diff;
+    sums[0] = diff > noise_floor ? diff : 0;
 
-    fieldanalysis_orc_same_parity_3_tap_planar_yuv (&tempsum, f1j, &f1j[incr],
+    sums[1] = 0;
+    fieldanalysis_orc_same_parity_3_tap_planar_yuv (&sums[1], f1j, &f1j[incr],
         &f1j[incr << 1], f2j, &f2j[incr], &f2j[incr << 1], noise_floor,
         width - 1);
-    sum += tempsum;
 
     /* unroll last as it is a special case */
     i = width - 1;
     diff = abs (((f1j[i - incr] << 1) + (f1j[i] << 2))
         - ((f2j[i - incr] << 1) + (f2j[i] << 2)));
-    if (diff > noise_floor)
-      sum += diff;
-
-    f1j += stride0x2;
-    f2j += stride1x2;
+    sums[2] = diff > noise_floor ? diff : 0;
   }
-
-  return sum / ((6.0f / 2.0f) * width * height);        /* 1 + 4 + 1 = 6; field is half height */
 }
 
-/* vertical [1,-3,4,-3,1] - same as is used in FieldDiff from TIVTC,
- * tritical's AVISynth IVTC filter */
-/* 0th field's parity defines operation */
+/* horizontal [1,4,1] diff between fields - is this a good idea or should the
+ * current sample be emphasised more or less? */
 static gfloat
-opposite_parity_5_tap (GstFieldAnalysis * filter,
-    FieldAnalysisFields (*history)[2])
+same_parity_3_tap (GstFieldAnalysis * filter, FieldAnalysisFields (*history)[2])
 {
-  gint j;
   gfloat sum;
-  guint8 *fjm2, *fjm1, *fj, *fjp1, *fjp2;
-  guint32 tempsum;
+  guint32 *line_sums;
 
   const gint width = GST_VIDEO_FRAME_WIDTH (&(*history)[0].frame);
   const gint height = GST_VIDEO_FRAME_HEIGHT (&(*history)[0].frame);
-  const gint stride0x2 =
-      GST_VIDEO_FRAME_COMP_STRIDE (&(*history)[0].frame, 0) << 1;
-  const gint stride1x2 =
-      GST_VIDEO_FRAME_COMP_STRIDE (&(*history)[1].frame, 0) << 1;
-  /* noise floor needs to be *6 for [1,-3,4,-3,1] */
-  const guint32 noise_floor = filter->noise_floor * 6;
 
-  sum = 0.0f;
+  line_sums = g_new (guint32, 3 * (height >> 1));
+  gst_field_analysis_run_bands (filter, history, same_parity_3_tap_band,
+      height >> 1, line_sums);
+  sum = sum_lines (line_sums, 3 * (height >> 1));
+  g_free (line_sums);
 
-  /* fj is line j of the combined frame made from the top field even lines of
-   *   field 0 and the bottom field odd lines from field 1
-   * fjp1 is one line down from fj
-   * fjm2 is two lines up from fj
-   * fj with j == 0 is the 0th line of the top field
-   * fj with j == 1 is the 0th line of the bottom field or the 1st field of
-   *   the frame*/
+  return sum / ((6.0f / 2.0f) * width * height);        /* 1 + 4 + 1 = 6; field is half height */
+}
 
-  /* unroll first line as it is a special case */
+/* fj is line j of the combined frame made from the top field even lines of
+ *   field 0 and the bottom field odd lines from field 1
+ * fjp1 is one line down from fj
+ * fjm2 is two lines up from fj
+ * fj with j == 0 is the 0th line of the top field
+ * fj with j == 1 is the 0th line of the bottom field or the 1st field of
+ *   the frame
+ * the top field is taken from the frame of the 0th field if it is the top
+ * field, and from the other frame otherwise */
+static void
+opposite_parity_frames (FieldAnalysisFields (*history)[2],
+    GstVideoFrame ** top, GstVideoFrame ** bottom)
+{
   if ((*history)[0].parity == TOP_FIELD) {
-    fj = GST_VIDEO_FRAME_COMP_DATA (&(*history)[0].frame,
-        0) + GST_VIDEO_FRAME_COMP_OFFSET (&(*history)[0].frame, 0);
-    fjp1 =
-        GST_VIDEO_FRAME_COMP_DATA (&(*history)[1].frame,
-        0) + GST_VIDEO_FRAME_COMP_OFFSET (&(*history)[1].frame,
-        0) + GST_VIDEO_FRAME_COMP_STRIDE (&(*history)[1].frame, 0);
-    fjp2 = fj + stride0x2;
+    *top = &(*history)[0].frame;
+    *bottom = &(*history)[1].frame;
   } else {
-    fj = GST_VIDEO_FRAME_COMP_DATA (&(*history)[1].frame,
-        0) + GST_VIDEO_FRAME_COMP_OFFSET (&(*history)[1].frame, 0);
-    fjp1 =
-        GST_VIDEO_FRAME_COMP_DATA (&(*history)[0].frame,
-        0) + GST_VIDEO_FRAME_COMP_OFFSET (&(*history)[0].frame,
-        0) + GST_VIDEO_FRAME_COMP_STRIDE (&(*history)[0].frame, 0);
-    fjp2 = fj + stride1x2;
+    *top = &(*history)[1].frame;
+    *bottom = &(*history)[0].frame;
   }
+}
 
-  tempsum = 0;
-  fieldanalysis_orc_opposite_parity_5_tap_planar_yuv (&tempsum, fjp2, fjp1, fj,
-      fjp1, fjp2, noise_floor, width);
-  sum += tempsum;
-
-  for (j = 1; j < (height >> 1) - 1; j++) {
-    /* shift everything down a line in the field of interest (means += stridex2) */
-    fjm2 = fj;
-    fjm1 = fjp1;
-    fj = fjp2;
-    if ((*history)[0].parity == TOP_FIELD) {
-      fjp1 += stride1x2;
-      fjp2 += stride0x2;
+static void
+opposite_parity_5_tap_band (FieldAnalysisBand * band)
+{
+  FieldAnalysisFields (*history)[2] = band->history;
+  guint32 *line_sums = band->results;
+  GstVideoFrame *top, *bottom;
+  guint j;
+
+  const gint width = GST_VIDEO_FRAME_WIDTH (&(*history)[0].frame);
+  const gint height = GST_VIDEO_FRAME_HEIGHT (&(*history)[0].frame);
+  const guint n_lines = MAX (height >> 1, 2);
+  /* noise floor needs to be *6 for [1,-3,4,-3,1] */
+  const guint32 noise_floor = band->filter->noise_floor * 6;
+
+  opposite_parity_frames (history, &top, &bottom);
+
+  for (j = band->start; j < band->end; j++) {
+    guint8 *fjm2, *fjm1, *fj, *fjp1, *fjp2;
+
+    fj = field_line (top, TOP_FIELD, j);
+    if (j == 0) {
+      /* the first line is a special case */
+      fjp1 = field_line (bottom, BOTTOM_FIELD, j);
+      fjp2 = field_line (top, TOP_FIELD, j + 1);
+      fjm1 = fjp1;
+      fjm2 = fjp2;
+    } else if (j == n_lines - 1) {
+      /* the last line is a special case */
+      fjm2 = field_line (top, TOP_FIELD, j - 1);
+      fjm1 = field_line (bottom, BOTTOM_FIELD, j - 1);
+      fjp1 = fjm1;
+      fjp2 = fjm2;
     } else {
-      fjp1 += stride0x2;
-      fjp2 += stride1x2;
+      fjm2 = field_line (top, TOP_FIELD, j - 1);
+      fjm1 = field_line (bottom, BOTTOM_FIELD, j - 1);
+      fjp1 = field_line (bottom, BOTTOM_FIELD, j);
+      fjp2 = field_line (top, TOP_FIELD, j + 1);
     }
 
-    tempsum = 0;
-    fieldanalysis_orc_opposite_parity_5_tap_planar_yuv (&tempsum, fjm2, fjm1,
-        fj, fjp1, fjp2, noise_floor, width);
-    sum += tempsum;
+    line_sums[j] = 0;
+    fieldanalysis_orc_opposite_parity_5_tap_planar_yuv (&line_sums[j], fjm2,
+        fjm1, fj, fjp1, fjp2, noise_floor, width);
   }
+}
+
+/* vertical [1,-3,4,-3,1] - same as is used in FieldDiff from TIVTC,
+ * tritical's AVISynth IVTC filter */
+/* 0th field's parity defines operation */
+static gfloat
+opposite_parity_5_tap (GstFieldAnalysis * filter,
+    FieldAnalysisFields (*history)[2])
+{
+  gfloat sum;
+  guint32 *line_sums;
 
-  /* unroll the last line as it is a special case */
-  /* shift everything down a line in the field of interest (means += stridex2) */
-  fjm2 = fj;
-  fjm1 = fjp1;
-  fj = fjp2;
+  const gint width = GST_VIDEO_FRAME_WIDTH (&(*history)[0].frame);
+  const gint height = GST_VIDEO_FRAME_HEIGHT (&(*history)[0].frame);
+  const guint n_lines = MAX (height >> 1, 2);
 
-  tempsum = 0;
-  fieldanalysis_orc_opposite_parity_5_tap_planar_yuv (&tempsum, fjm2, fjm1, fj,
-      fjm1, fjm2, noise_floor, width);
-  sum += tempsum;
+  line_sums = g_new (guint32, n_lines);
+  gst_field_analysis_run_bands (filter, history, opposite_parity_5_tap_band,
+      n_lines, line_sums);
+  sum = sum_lines (line_sums, n_lines);
+  g_free (line_sums);
 
   return sum / ((6.0f / 2.0f) * width * height);        /* 1 + 4 + 1 == 3 + 3 == 6; field is half height */
 }
 
-/* this metric was sourced from HandBrake but originally from transcode
- * the return value is the highest block score for the row of blocks */
-static inline guint64
-block_score_for_row_32detect (GstFieldAnalysis * filter,
-    FieldAnalysisFields (*history)[2], guint8 * base_fj, guint8 * base_fjp1)
+/* the comb masks mark the samples of line fj that are combed. the ORC
+ * functions only handle planar formats, and take 16-bit thresholds. 8-bit
+ * samples can never differ by more than 255 so larger spatial thresholds are
+ * all the same */
+
+/* this metric was sourced from HandBrake but originally from transcode */
+static void
+comb_mask_32detect (guint8 * comb_mask, const guint8 * fjm2,
+    const guint8 * fjm1, const guint8 * fj, const guint8 * fjp1,
+    const guint8 * fjp2, gint64 spatial_thresh, gint incr, gint width)
 {
-  guint64 i, j;
-  guint8 *comb_mask = filter->comb_mask;
-  guint *block_scores = filter->block_scores;
-  guint64 block_score;
-  guint8 *fjm2, *fjm1, *fj, *fjp1;
-  const gint incr = GST_VIDEO_FRAME_COMP_PSTRIDE (&(*history)[0].frame, 0);
-  const gint stridex2 =
-      GST_VIDEO_FRAME_COMP_STRIDE (&(*history)[0].frame, 0) << 1;
-  const guint64 block_width = filter->block_width;
-  const guint64 block_height = filter->block_height;
-  const gint64 spatial_thresh = filter->spatial_thresh;
-  const gint width =
-      GST_VIDEO_FRAME_WIDTH (&(*history)[0].frame) -
-      (GST_VIDEO_FRAME_WIDTH (&(*history)[0].frame) % block_width);
+  gint i;
 
-  fjm2 = base_fj - stridex2;
-  fjm1 = base_fjp1 - stridex2;
-  fj = base_fj;
-  fjp1 = base_fjp1;
+  if (incr == 1) {
+    const gint thresh = MIN (spatial_thresh, 255);
 
-  for (j = 0; j < block_height; j++) {
-    /* we have to work one result ahead of ourselves which results in some small
-     * peculiarities below */
-    gint diff1, diff2;
+    fieldanalysis_orc_comb_mask_32detect (comb_mask, fjm2, fjm1, fj, fjp1,
+        thresh, -thresh, width);
+    return;
+  }
+
+  for (i = 0; i < width; i++) {
+    const gint idx = i * incr;
+    const gint diff1 = fj[idx] - fjm1[idx];
+    const gint diff2 = fj[idx] - fjp1[idx];
 
-    diff1 = fj[0] - fjm1[0];
-    diff2 = fj[0] - fjp1[0];
     /* change in the same direction */
     if ((diff1 > spatial_thresh && diff2 > spatial_thresh)
         || (diff1 < -spatial_thresh && diff2 < -spatial_thresh)) {
-      comb_mask[0] = abs (fj[0] - fjm2[0]) < 10 && abs (fj[0] - fjm1[0]) > 15;
+      comb_mask[i] = abs (fj[idx] - fjm2[idx]) < 10
+          && abs (fj[idx] - fjm1[idx]) > 15;
     } else {
-      comb_mask[0] = FALSE;
-    }
-
-    for (i = 1; i < width; i++) {
-      const guint64 idx = i * incr;
-      const guint64 res_idx = (i - 1) / block_width;
-
-      diff1 = fj[idx] - fjm1[idx];
-      diff2 = fj[idx] - fjp1[idx];
-      if ((diff1 > spatial_thresh && diff2 > spatial_thresh)
-          || (diff1 < -spatial_thresh && diff2 < -spatial_thresh)) {
-        comb_mask[i] = abs (fj[idx] - fjm2[idx]) < 10
-            && abs (fj[idx] - fjm1[idx]) > 15;
-      } else {
-        comb_mask[i] = FALSE;
-      }
-
-      if (i == 1 && comb_mask[i - 1] && comb_mask[i]) {
-        /* left edge */
-        block_scores[res_idx]++;
-      } else if (i == width - 1) {
-        /* right edge */
-        if (comb_mask[i - 2] && comb_mask[i - 1] && comb_mask[i])
-          block_scores[res_idx]++;
-        if (comb_mask[i - 1] && comb_mask[i])
-          block_scores[i / block_width]++;
-      } else if (comb_mask[i - 2] && comb_mask[i - 1] && comb_mask[i]) {
-        block_scores[res_idx]++;
-      }
+      comb_mask[i] = FALSE;
     }
-    /* advance down a line */
-    fjm2 = fjm1;
-    fjm1 = fj;
-    fj = fjp1;
-    fjp1 = fjm1 + stridex2;
   }
-
-  block_score = 0;
-  for (i = 0; i < width / block_width; i++) {
-    if (block_scores[i] > block_score)
-      block_score = block_scores[i];
-  }
-
-  g_free (block_scores);
-  g_free (comb_mask);
-  return block_score;
 }
 
 /* this metric was sourced from HandBrake but originally from
- * tritical's isCombedT Avisynth function
- * the return value is the highest block score for the row of blocks */
-static inline guint64
-block_score_for_row_iscombed (GstFieldAnalysis * filter,
-    FieldAnalysisFields (*history)[2], guint8 * base_fj, guint8 * base_fjp1)
+ * tritical's isCombedT Avisynth function */
+static void
+comb_mask_iscombed (guint8 * comb_mask, const guint8 * fjm2,
+    const guint8 * fjm1, const guint8 * fj, const guint8 * fjp1,
+    const guint8 * fjp2, gint64 spatial_thresh, gint incr, gint width)
 {
-  guint64 i, j;
-  guint8 *comb_mask = filter->comb_mask;
-  guint *block_scores = filter->block_scores;
-  guint64 block_score;
-  guint8 *fjm1, *fj, *fjp1;
-  const gint incr = GST_VIDEO_FRAME_COMP_PSTRIDE (&(*history)[0].frame, 0);
-  const gint stridex2 =
-      GST_VIDEO_FRAME_COMP_STRIDE (&(*history)[0].frame, 0) << 1;
-  const guint64 block_width = filter->block_width;
-  const guint64 block_height = filter->block_height;
-  const gint64 spatial_thresh = filter->spatial_thresh;
+  gint i;
   const gint64 spatial_thresh_squared = spatial_thresh * spatial_thresh;
-  const gint width =
-      GST_VIDEO_FRAME_WIDTH (&(*history)[0].frame) -
-      (GST_VIDEO_FRAME_WIDTH (&(*history)[0].frame) % block_width);
 
-  fjm1 = base_fjp1 - stridex2;
-  fj = base_fj;
-  fjp1 = base_fjp1;
+  if (incr == 1) {
+    const gint thresh = MIN (spatial_thresh, 255);
 
-  for (j = 0; j < block_height; j++) {
-    /* we have to work one result ahead of ourselves which results in some small
-     * peculiarities below */
-    gint diff1, diff2;
+    fieldanalysis_orc_comb_mask_iscombed (comb_mask, fjm1, fj, fjp1, thresh,
+        -thresh, thresh * thresh, width);
+    return;
+  }
+
+  for (i = 0; i < width; i++) {
+    const gint idx = i * incr;
+    const gint diff1 = fj[idx] - fjm1[idx];
+    const gint diff2 = fj[idx] - fjp1[idx];
 
-    diff1 = fj[0] - fjm1[0];
-    diff2 = fj[0] - fjp1[0];
     /* change in the same direction */
     if ((diff1 > spatial_thresh && diff2 > spatial_thresh)
         || (diff1 < -spatial_thresh && diff2 < -spatial_thresh)) {
-      comb_mask[0] =
-          (fjm1[0] - fj[0]) * (fjp1[0] - fj[0]) > spatial_thresh_squared;
+      comb_mask[i] =
+          (fjm1[idx] - fj[idx]) * (fjp1[idx] - fj[idx]) >
+          spatial_thresh_squared;
     } else {
-      comb_mask[0] = FALSE;
+      comb_mask[i] = FALSE;
     }
-
-    for (i = 1; i < width; i++) {
-      const guint64 idx = i * incr;
-      const guint64 res_idx = (i - 1) / block_width;
-
-      diff1 = fj[idx] - fjm1[idx];
-      diff2 = fj[idx] - fjp1[idx];
-      if ((diff1 > spatial_thresh && diff2 > spatial_thresh)
-          || (diff1 < -spatial_thresh && diff2 < -spatial_thresh)) {
-        comb_mask[i] =
-            (fjm1[idx] - fj[idx]) * (fjp1[idx] - fj[idx]) >
-            spatial_thresh_squared;
-      } else {
-        comb_mask[i] = FALSE;
-      }
-
-      if (i == 1 && comb_mask[i - 1] && comb_mask[i]) {
-        /* left edge */
-        block_scores[res_idx]++;
-      } else if (i == width - 1) {
-        /* right edge */
-        if (comb_mask[i - 2] && comb_mask[i - 1] && comb_mask[i])
-          block_scores[res_idx]++;
-        if (comb_mask[i - 1] && comb_mask[i])
-          block_scores[i / block_width]++;
-      } else if (comb_mask[i - 2] && comb_mask[i - 1] && comb_mask[i]) {
-        block_scores[res_idx]++;
-      }
-    }
-    /* advance down a line */
-    fjm1 = fj;
-    fj = fjp1;
-    fjp1 = fjm1 + stridex2;
   }
-
-  block_score = 0;
-  for (i = 0; i < width / block_width; i++) {
-    if (block_scores[i] > block_score)
-      block_score = block_scores[i];
-  }
-
-  g_free (block_scores);
-  g_free (comb_mask);
-  return block_score;
 }
 
 /* this metric was sourced from HandBrake but originally from
- * tritical's isCombedT Avisynth function
- * the return value is the highest block score for the row of blocks */
-static inline guint64
-block_score_for_row_5_tap (GstFieldAnalysis * filter,
-    FieldAnalysisFields (*history)[2], guint8 * base_fj, guint8 * base_fjp1)
+ * tritical's isCombedT Avisynth function */
+static void
+comb_mask_5_tap (guint8 * comb_mask, const guint8 * fjm2,
+    const guint8 * fjm1, const guint8 * fj, const guint8 * fjp1,
+    const guint8 * fjp2, gint64 spatial_thresh, gint incr, gint width)
 {
-  guint64 i, j;
-  guint8 *comb_mask = filter->comb_mask;
-  guint *block_scores = filter->block_scores;
-  guint64 block_score;
-  guint8 *fjm2, *fjm1, *fj, *fjp1, *fjp2;
-  const gint incr = GST_VIDEO_FRAME_COMP_PSTRIDE (&(*history)[0].frame, 0);
-  const gint stridex2 =
-      GST_VIDEO_FRAME_COMP_STRIDE (&(*history)[0].frame, 0) << 1;
-  const guint64 block_width = filter->block_width;
-  const guint64 block_height = filter->block_height;
-  const gint64 spatial_thresh = filter->spatial_thresh;
+  gint i;
   const gint64 spatial_threshx6 = 6 * spatial_thresh;
-  const gint width =
-      GST_VIDEO_FRAME_WIDTH (&(*history)[0].frame) -
-      (GST_VIDEO_FRAME_WIDTH (&(*history)[0].frame) % block_width);
 
+  if (incr == 1) {
+    const gint thresh = MIN (spatial_thresh, 255);
 
-  fjm2 = base_fj - stridex2;
-  fjm1 = base_fjp1 - stridex2;
-  fj = base_fj;
-  fjp1 = base_fjp1;
-  fjp2 = fj + stridex2;
+    fieldanalysis_orc_comb_mask_5_tap (comb_mask, fjm2, fjm1, fj, fjp1, fjp2,
+        thresh, -thresh, 6 * thresh, width);
+    return;
+  }
 
-  for (j = 0; j < block_height; j++) {
-    /* we have to work one result ahead of ourselves which results in some small
-     * peculiarities below */
-    gint diff1, diff2;
+  for (i = 0; i < width; i++) {
+    const gint idx = i * incr;
+    const gint diff1 = fj[idx] - fjm1[idx];
+    const gint diff2 = fj[idx] - fjp1[idx];
 
-    diff1 = fj[0] - fjm1[0];
-    diff2 = fj[0] - fjp1[0];
     /* change in the same direction */
     if ((diff1 > spatial_thresh && diff2 > spatial_thresh)
         || (diff1 < -spatial_thresh && diff2 < -spatial_thresh)) {
-      comb_mask[0] =
-          abs (fjm2[0] + (fj[0] << 2) + fjp2[0] - 3 * (fjm1[0] + fjp1[0])) >
-          spatial_threshx6;
+      comb_mask[i] =
+          abs (fjm2[idx] + (fj[idx] << 2) + fjp2[idx] - 3 * (fjm1[idx] +
+              fjp1[idx])) > spatial_threshx6;
 
       /* motion detection that needs previous and next frames
          this isn't really necessary, but acts as an optimisation if the
@@ -1270,42 +1203,72 @@ block_score_for_row_5_tap (GstFieldAnalysis * filter,
          }
        */
     } else {
-      comb_mask[0] = FALSE;
+      comb_mask[i] = FALSE;
     }
+  }
+}
 
-    for (i = 1; i < width; i++) {
-      const guint64 idx = i * incr;
-      const guint64 res_idx = (i - 1) / block_width;
-
-      diff1 = fj[idx] - fjm1[idx];
-      diff2 = fj[idx] - fjp1[idx];
-      if ((diff1 > spatial_thresh && diff2 > spatial_thresh)
-          || (diff1 < -spatial_thresh && diff2 < -spatial_thresh)) {
-        comb_mask[i] =
-            abs (fjm2[idx] + (fj[idx] << 2) + fjp2[idx] - 3 * (fjm1[idx] +
-                fjp1[idx])) > spatial_threshx6;
-      } else {
-        comb_mask[i] = FALSE;
-      }
+/* the comb mask of each line of the row of blocks is computed with the comb
+ * method. a combed sample counts towards the score of its block if the
+ * samples to its left and right are combed too, or the one next to it for
+ * the samples at the edges. comb_mask and counts hold width samples and
+ * block_scores one score per block.
+ * the return value is the highest block score for the row of blocks */
+static guint64
+block_score_for_row (GstFieldAnalysis * filter,
+    FieldAnalysisFields (*history)[2], guint8 * base_fj, guint8 * base_fjp1,
+    guint8 * comb_mask, guint16 * counts, guint64 * block_scores)
+{
+  guint64 i, j;
+  guint64 block_score;
+  guint8 *fjm2, *fjm1, *fj, *fjp1, *fjp2;
+  const gint incr = GST_VIDEO_FRAME_COMP_PSTRIDE (&(*history)[0].frame, 0);
+  const gint stridex2 =
+      GST_VIDEO_FRAME_COMP_STRIDE (&(*history)[0].frame, 0) << 1;
+  const guint64 block_width = filter->block_width;
+  const guint64 block_height = filter->block_height;
+  const gint64 spatial_thresh = filter->spatial_thresh;
+  const gint width =
+      GST_VIDEO_FRAME_WIDTH (&(*history)[0].frame) -
+      (GST_VIDEO_FRAME_WIDTH (&(*history)[0].frame) % block_width);
 
-      if (i == 1 && comb_mask[i - 1] && comb_mask[i]) {
-        /* left edge */
-        block_scores[res_idx]++;
-      } else if (i == width - 1) {
-        /* right edge */
-        if (comb_mask[i - 2] && comb_mask[i - 1] && comb_mask[i])
-          block_scores[res_idx]++;
-        if (comb_mask[i - 1] && comb_mask[i])
-          block_scores[i / block_width]++;
-      } else if (comb_mask[i - 2] && comb_mask[i - 1] && comb_mask[i]) {
-        block_scores[res_idx]++;
-      }
+  if (width < 2)
+    return 0;
+
+  memset (counts, 0, width * sizeof (guint16));
+  memset (block_scores, 0, (width / block_width) * sizeof (guint64));
+
+  fjm2 = base_fj - stridex2;
+  fjm1 = base_fjp1 - stridex2;
+  fj = base_fj;
+  fjp1 = base_fjp1;
+  fjp2 = fj + stridex2;
+
+  for (j = 0; j < block_height; j++) {
+    filter->comb_mask_for_line (comb_mask, fjm2, fjm1, fj, fjp1, fjp2,
+        spatial_thresh, incr, width);
+
+    /* left edge */
+    counts[0] += comb_mask[0] & comb_mask[1];
+    if (width > 2) {
+      fieldanalysis_orc_comb_mask_count (counts + 1, comb_mask, comb_mask + 1,
+          comb_mask + 2, width - 2);
+      /* right edge */
+      counts[width - 1] += comb_mask[width - 2] & comb_mask[width - 1];
+    }
+
+    /* add the counts to the blocks before they can overflow */
+    if ((j + 1) % G_MAXUINT16 == 0 || j + 1 == block_height) {
+      for (i = 0; i < width; i++)
+        block_scores[i / block_width] += counts[i];
+      memset (counts, 0, width * sizeof (guint16));
     }
+
     /* advance down a line */
     fjm2 = fjm1;
     fjm1 = fj;
     fj = fjp1;
-    fjp1 = fjp2;
+    fjp1 = fjm1 + stridex2;
     fjp2 = fj + stridex2;
   }
 
@@ -1315,11 +1278,57 @@ block_score_for_row_5_tap (GstFieldAnalysis * filter,
       block_score = block_scores[i];
   }
 
-  g_free (block_scores);
-  g_free (comb_mask);
   return block_score;
 }
 
+static void
+opposite_parity_windowed_comb_band (FieldAnalysisBand * band)
+{
+  GstFieldAnalysis *filter = band->filter;
+  FieldAnalysisFields (*history)[2] = band->history;
+  guint *row_scores = band->results;
+  GstVideoFrame *top, *bottom;
+  guint8 *base_fj, *base_fjp1, *comb_mask;
+  guint16 *counts;
+  guint64 *block_scores;
+  guint j;
+
+  const gint stride = GST_VIDEO_FRAME_COMP_STRIDE (&(*history)[0].frame, 0);
+  const guint64 block_thresh = filter->block_thresh;
+  const guint64 block_width = filter->block_width;
+  const guint64 block_height = filter->block_height;
+  const gint width =
+      GST_VIDEO_FRAME_WIDTH (&(*history)[0].frame) -
+      (GST_VIDEO_FRAME_WIDTH (&(*history)[0].frame) % block_width);
+
+  if (band->start == band->end)
+    return;
+
+  opposite_parity_frames (history, &top, &bottom);
+  base_fj = field_line (top, TOP_FIELD, 0);
+  base_fjp1 = field_line (bottom, BOTTOM_FIELD, 0);
+
+  comb_mask = g_malloc (width);
+  counts = g_new (guint16, width);
+  block_scores = g_new (guint64, width / block_width);
+
+  for (j = band->start; j < band->end; j++) {
+    guint64 line_offset = (filter->ignored_lines + j * block_height) * stride;
+
+    row_scores[j] =
+        block_score_for_row (filter, history, base_fj + line_offset,
+        base_fjp1 + line_offset, comb_mask, counts, block_scores);
+
+    /* the rows below are not looked at once a row is combed */
+    if (row_scores[j] > block_thresh)
+      break;
+  }
+
+  g_free (comb_mask);
+  g_free (counts);
+  g_free (block_scores);
+}
+
 /* a pass is made over the field using one of three comb-detection metrics
    and the results are then analysed block-wise. if the samples to the left
    and right are combed, they contribute to the block score. if the block
@@ -1327,63 +1336,58 @@ block_score_for_row_5_tap (GstFieldAnalysis * filter,
    score is between half the threshold and the threshold, the block is
    slightly combed. if when analysis is complete, slight combing is detected
    that is returned. if any results are observed that are above the threshold,
-   the function returns immediately */
+   the rows below are ignored */
 /* 0th field's parity defines operation */
 static gfloat
 opposite_parity_windowed_comb (GstFieldAnalysis * filter,
     FieldAnalysisFields (*history)[2])
 {
-  gint j;
+  guint j, n_rows;
+  guint *row_scores;
   gboolean slightly_combed;
+  gfloat ret;
 
   const gint height = GST_VIDEO_FRAME_HEIGHT (&(*history)[0].frame);
-  const gint stride = GST_VIDEO_FRAME_COMP_STRIDE (&(*history)[0].frame, 0);
   const guint64 block_thresh = filter->block_thresh;
   const guint64 block_height = filter->block_height;
-  guint8 *base_fj, *base_fjp1;
 
-  if ((*history)[0].parity == TOP_FIELD) {
-    base_fj =
-        GST_VIDEO_FRAME_COMP_DATA (&(*history)[0].frame,
-        0) + GST_VIDEO_FRAME_COMP_OFFSET (&(*history)[0].frame, 0);
-    base_fjp1 =
-        GST_VIDEO_FRAME_COMP_DATA (&(*history)[1].frame,
-        0) + GST_VIDEO_FRAME_COMP_OFFSET (&(*history)[1].frame,
-        0) + GST_VIDEO_FRAME_COMP_STRIDE (&(*history)[1].frame, 0);
-  } else {
-    base_fj =
-        GST_VIDEO_FRAME_COMP_DATA (&(*history)[1].frame,
-        0) + GST_VIDEO_FRAME_COMP_OFFSET (&(*history)[1].frame, 0);
-    base_fjp1 =
-        GST_VIDEO_FRAME_COMP_DATA (&(*history)[0].frame,
-        0) + GST_VIDEO_FRAME_COMP_OFFSET (&(*history)[0].frame,
-        0) + GST_VIDEO_FRAME_COMP_STRIDE (&(*history)[0].frame, 0);
-  }
+  /* we operate on rows of blocks of height block_height that fit between the
+   * ignored lines and the bottom of the frame */
+  if (filter->block_width == 0 || block_height == 0
+      || height < filter->ignored_lines + block_height)
+    return 0.0f;
+  n_rows = (height - filter->ignored_lines - block_height) / block_height + 1;
+
+  row_scores = g_new (guint, n_rows);
+  gst_field_analysis_run_bands (filter, history,
+      opposite_parity_windowed_comb_band, n_rows, row_scores);
 
-  /* we operate on a row of blocks of height block_height through each iteration */
   slightly_combed = FALSE;
-  for (j = 0; j <= height - filter->ignored_lines - block_height;
-      j += block_height) {
-    guint64 line_offset = (filter->ignored_lines + j) * stride;
-    guint block_score =
-        filter->block_score_for_row (filter, history, base_fj + line_offset,
-        base_fjp1 + line_offset);
+  for (j = 0; j < n_rows; j++) {
+    const guint block_score = row_scores[j];
 
     if (block_score > (block_thresh >> 1)
         && block_score <= block_thresh) {
       /* blend if nothing more combed comes along */
       slightly_combed = TRUE;
     } else if (block_score > block_thresh) {
-      if (GST_VIDEO_INFO_INTERLACE_MODE (&(*history)[0].frame.info) ==
-          GST_VIDEO_INTERLACE_MODE_INTERLEAVED) {
-        return 1.0f;            /* blend */
-      } else {
-        return 2.0f;            /* deinterlace */
-      }
+      break;
     }
   }
+  g_free (row_scores);
 
-  return (gfloat) slightly_combed;      /* TRUE means blend, else don't */
+  if (j < n_rows) {
+    if (GST_VIDEO_INFO_INTERLACE_MODE (&(*history)[0].frame.info) ==
+        GST_VIDEO_INTERLACE_MODE_INTERLEAVED) {
+      ret = 1.0f;               /* blend */
+    } else {
+      ret = 2.0f;               /* deinterlace */
+    }
+  } else {
+    ret = (gfloat) slightly_combed;     /* TRUE means blend, else don't */
+  }
+
+  return ret;
 }
 
 /* this is where the magic happens
@@ -1418,6 +1422,13 @@ gst_field_analysis_process_buffer (GstFieldAnalysis * filter,
   FieldAnalysisFields history[2];
   GstBuffer *outbuf = NULL;
 
+  /* the metrics are computed on the threads of the task runner */
+  if (gst_parallelized_task_runner_update (&filter->task_runner,
+          filter->n_threads)) {
+    GST_DEBUG_OBJECT (filter, "Analysing with %u threads",
+        gst_parallelized_task_runner_get_n_threads (filter->task_runner));
+  }
+
   /* move previous result to index 1 */
   filter->frames[1] = filter->frames[0];
 
@@ -1833,6 +1844,9 @@ gst_field_analysis_finalize (GObject * object)
   GstFieldAnalysis *filter = GST_FIELDANALYSIS (object);
 
   gst_field_analysis_reset (filter);
+  if (filter->task_runner)
+    gst_parallelized_task_runner_free (filter->task_runner);
+  filter->task_runner = NULL;
 
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
@@ -45,6 +45,7 @@
 #define __GST_FIELDANALYSIS_H__
 
 #include <gst/gst.h>
+#include <gst/video/gstparallelizedtaskrunner.h>
 
 G_BEGIN_DECLS
 #define GST_TYPE_FIELDANALYSIS \
@@ -119,12 +120,10 @@ struct _GstFieldAnalysis
   GstVideoInfo vinfo;
   gfloat (*same_field) (GstFieldAnalysis *, FieldAnalysisFields (*)[2]);
   gfloat (*same_frame) (GstFieldAnalysis *, FieldAnalysisFields (*)[2]);
-  guint64 (*block_score_for_row) (GstFieldAnalysis *, FieldAnalysisFields (*)[2], guint8 *, guint8 *);
+  void (*comb_mask_for_line) (guint8 *, const guint8 *, const guint8 *, const guint8 *, const guint8 *, const guint8 *, gint64, gint, gint);
   gboolean is_telecine;
   gboolean first_buffer; /* indicates the first buffer for which a buffer will be output
                           * after a discont or flushing seek */
-  guint8 *comb_mask;
-  guint *block_scores;
   gboolean flushing;     /* indicates whether we are flushing or not */
 
   /* properties */
@@ -135,6 +134,9 @@ struct _GstFieldAnalysis
   guint64 block_width, block_height; /* width/height of window used for comb clusted detection */
   guint64 block_thresh;
   guint64 ignored_lines;
+  guint n_threads;
+
+  GstParallelizedTaskRunner *task_runner;
 };
 
 struct _GstFieldAnalysisClass
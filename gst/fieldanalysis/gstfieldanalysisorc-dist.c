@@ -111,6 +111,20 @@ void fieldanalysis_orc_opposite_parity_5_tap_planar_yuv (guint32 *
     const orc_uint8 * ORC_RESTRICT s2, const orc_uint8 * ORC_RESTRICT s3,
     const orc_uint8 * ORC_RESTRICT s4, const orc_uint8 * ORC_RESTRICT s5,
     int p1, int n);
+void fieldanalysis_orc_comb_mask_32detect (guint8 * ORC_RESTRICT d1,
+    const orc_uint8 * ORC_RESTRICT s1, const orc_uint8 * ORC_RESTRICT s2,
+    const orc_uint8 * ORC_RESTRICT s3, const orc_uint8 * ORC_RESTRICT s4,
+    int p1, int p2, int n);
+void fieldanalysis_orc_comb_mask_iscombed (guint8 * ORC_RESTRICT d1,
+    const orc_uint8 * ORC_RESTRICT s1, const orc_uint8 * ORC_RESTRICT s2,
+    const orc_uint8 * ORC_RESTRICT s3, int p1, int p2, int p3, int n);
+void fieldanalysis_orc_comb_mask_5_tap (guint8 * ORC_RESTRICT d1,
+    const orc_uint8 * ORC_RESTRICT s1, const orc_uint8 * ORC_RESTRICT s2,
+    const orc_uint8 * ORC_RESTRICT s3, const orc_uint8 * ORC_RESTRICT s4,
+    const orc_uint8 * ORC_RESTRICT s5, int p1, int p2, int p3, int n);
+void fieldanalysis_orc_comb_mask_count (guint16 * ORC_RESTRICT d1,
+    const orc_uint8 * ORC_RESTRICT s1, const orc_uint8 * ORC_RESTRICT s2,
+    const orc_uint8 * ORC_RESTRICT s3, int n);
 
 
 /* begin Orc C target preamble */
@@ -1195,3 +1209,1256 @@ fieldanalysis_orc_opposite_parity_5_tap_planar_yuv (guint32 * ORC_RESTRICT a1,
   *a1 = orc_executor_get_accumulator (ex, ORC_VAR_A1);
 }
 #endif
+
+
+/* fieldanalysis_orc_comb_mask_32detect */
+#ifdef DISABLE_ORC
+void
+fieldanalysis_orc_comb_mask_32detect (guint8 * ORC_RESTRICT d1,
+    const orc_uint8 * ORC_RESTRICT s1, const orc_uint8 * ORC_RESTRICT s2,
+    const orc_uint8 * ORC_RESTRICT s3, const orc_uint8 * ORC_RESTRICT s4,
+    int p1, int p2, int n)
+{
+  int i;
+  orc_int8 *ORC_RESTRICT ptr0;
+  const orc_int8 *ORC_RESTRICT ptr4;
+  const orc_int8 *ORC_RESTRICT ptr5;
+  const orc_int8 *ORC_RESTRICT ptr6;
+  const orc_int8 *ORC_RESTRICT ptr7;
+  orc_int8 var37;
+  orc_int8 var38;
+  orc_int8 var39;
+  orc_union16 var40;
+  orc_union16 var41;
+#if defined(__APPLE__) && __GNUC__ == 4 && __GNUC_MINOR__ == 2 && defined (__i386__)
+  volatile orc_union16 var42;
+#else
+  orc_union16 var42;
+#endif
+  orc_int8 var43;
+#if defined(__APPLE__) && __GNUC__ == 4 && __GNUC_MINOR__ == 2 && defined (__i386__)
+  volatile orc_union16 var44;
+#else
+  orc_union16 var44;
+#endif
+#if defined(__APPLE__) && __GNUC__ == 4 && __GNUC_MINOR__ == 2 && defined (__i386__)
+  volatile orc_union16 var45;
+#else
+  orc_union16 var45;
+#endif
+  orc_int8 var46;
+  orc_union16 var47;
+  orc_union16 var48;
+  orc_union16 var49;
+  orc_union16 var50;
+  orc_union16 var51;
+  orc_union16 var52;
+  orc_union16 var53;
+  orc_union16 var54;
+  orc_union16 var55;
+  orc_union16 var56;
+  orc_union16 var57;
+  orc_union16 var58;
+  orc_union16 var59;
+  orc_union16 var60;
+  orc_union16 var61;
+  orc_union16 var62;
+  orc_union16 var63;
+  orc_union16 var64;
+  orc_union16 var65;
+
+  ptr0 = (orc_int8 *) d1;
+  ptr4 = (orc_int8 *) s1;
+  ptr5 = (orc_int8 *) s2;
+  ptr6 = (orc_int8 *) s3;
+  ptr7 = (orc_int8 *) s4;
+
+  /* 9: loadpw */
+  var40.i = p1;
+  /* 12: loadpw */
+  var41.i = p2;
+  /* 16: loadpw */
+  var42.i = (int) 0x0000000f;   /* 15 or 7.41098e-323f */
+  /* 23: loadpw */
+  var44.i = (int) 0x0000000a;   /* 10 or 4.94066e-323f */
+  /* 26: loadpw */
+  var45.i = (int) 0x00000001;   /* 1 or 4.94066e-324f */
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadb */
+    var37 = ptr6[i];
+    /* 1: convubw */
+    var47.i = (orc_uint8) var37;
+    /* 2: loadb */
+    var38 = ptr5[i];
+    /* 3: convubw */
+    var48.i = (orc_uint8) var38;
+    /* 4: subw */
+    var49.i = var47.i - var48.i;
+    /* 5: loadb */
+    var39 = ptr7[i];
+    /* 6: convubw */
+    var50.i = (orc_uint8) var39;
+    /* 7: subw */
+    var51.i = var47.i - var50.i;
+    /* 8: minsw */
+    var52.i = ORC_MIN (var49.i, var51.i);
+    /* 10: cmpgtsw */
+    var53.i = (var52.i > var40.i) ? (~0) : 0;
+    /* 11: maxsw */
+    var54.i = ORC_MAX (var49.i, var51.i);
+    /* 13: cmpgtsw */
+    var55.i = (var41.i > var54.i) ? (~0) : 0;
+    /* 14: orw */
+    var56.i = var53.i | var55.i;
+    /* 15: absw */
+    var57.i = ORC_ABS (var49.i);
+    /* 17: cmpgtsw */
+    var58.i = (var57.i > var42.i) ? (~0) : 0;
+    /* 18: andw */
+    var59.i = var56.i & var58.i;
+    /* 19: loadb */
+    var43 = ptr4[i];
+    /* 20: convubw */
+    var60.i = (orc_uint8) var43;
+    /* 21: subw */
+    var61.i = var47.i - var60.i;
+    /* 22: absw */
+    var62.i = ORC_ABS (var61.i);
+    /* 24: cmpgtsw */
+    var63.i = (var44.i > var62.i) ? (~0) : 0;
+    /* 25: andw */
+    var64.i = var59.i & var63.i;
+    /* 27: andw */
+    var65.i = var64.i & var45.i;
+    /* 28: convwb */
+    var46 = var65.i;
+    /* 29: storeb */
+    ptr0[i] = var46;
+  }
+
+}
+
+#else
+static void
+_backup_fieldanalysis_orc_comb_mask_32detect (OrcExecutor * ORC_RESTRICT ex)
+{
+  int i;
+  int n = ex->n;
+  orc_int8 *ORC_RESTRICT ptr0;
+  const orc_int8 *ORC_RESTRICT ptr4;
+  const orc_int8 *ORC_RESTRICT ptr5;
+  const orc_int8 *ORC_RESTRICT ptr6;
+  const orc_int8 *ORC_RESTRICT ptr7;
+  orc_int8 var37;
+  orc_int8 var38;
+  orc_int8 var39;
+  orc_union16 var40;
+  orc_union16 var41;
+#if defined(__APPLE__) && __GNUC__ == 4 && __GNUC_MINOR__ == 2 && defined (__i386__)
+  volatile orc_union16 var42;
+#else
+  orc_union16 var42;
+#endif
+  orc_int8 var43;
+#if defined(__APPLE__) && __GNUC__ == 4 && __GNUC_MINOR__ == 2 && defined (__i386__)
+  volatile orc_union16 var44;
+#else
+  orc_union16 var44;
+#endif
+#if defined(__APPLE__) && __GNUC__ == 4 && __GNUC_MINOR__ == 2 && defined (__i386__)
+  volatile orc_union16 var45;
+#else
+  orc_union16 var45;
+#endif
+  orc_int8 var46;
+  orc_union16 var47;
+  orc_union16 var48;
+  orc_union16 var49;
+  orc_union16 var50;
+  orc_union16 var51;
+  orc_union16 var52;
+  orc_union16 var53;
+  orc_union16 var54;
+  orc_union16 var55;
+  orc_union16 var56;
+  orc_union16 var57;
+  orc_union16 var58;
+  orc_union16 var59;
+  orc_union16 var60;
+  orc_union16 var61;
+  orc_union16 var62;
+  orc_union16 var63;
+  orc_union16 var64;
+  orc_union16 var65;
+
+  ptr0 = (orc_int8 *) ex->arrays[0];
+  ptr4 = (orc_int8 *) ex->arrays[4];
+  ptr5 = (orc_int8 *) ex->arrays[5];
+  ptr6 = (orc_int8 *) ex->arrays[6];
+  ptr7 = (orc_int8 *) ex->arrays[7];
+
+  /* 9: loadpw */
+  var40.i = ex->params[24];
+  /* 12: loadpw */
+  var41.i = ex->params[25];
+  /* 16: loadpw */
+  var42.i = (int) 0x0000000f;   /* 15 or 7.41098e-323f */
+  /* 23: loadpw */
+  var44.i = (int) 0x0000000a;   /* 10 or 4.94066e-323f */
+  /* 26: loadpw */
+  var45.i = (int) 0x00000001;   /* 1 or 4.94066e-324f */
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadb */
+    var37 = ptr6[i];
+    /* 1: convubw */
+    var47.i = (orc_uint8) var37;
+    /* 2: loadb */
+    var38 = ptr5[i];
+    /* 3: convubw */
+    var48.i = (orc_uint8) var38;
+    /* 4: subw */
+    var49.i = var47.i - var48.i;
+    /* 5: loadb */
+    var39 = ptr7[i];
+    /* 6: convubw */
+    var50.i = (orc_uint8) var39;
+    /* 7: subw */
+    var51.i = var47.i - var50.i;
+    /* 8: minsw */
+    var52.i = ORC_MIN (var49.i, var51.i);
+    /* 10: cmpgtsw */
+    var53.i = (var52.i > var40.i) ? (~0) : 0;
+    /* 11: maxsw */
+    var54.i = ORC_MAX (var49.i, var51.i);
+    /* 13: cmpgtsw */
+    var55.i = (var41.i > var54.i) ? (~0) : 0;
+    /* 14: orw */
+    var56.i = var53.i | var55.i;
+    /* 15: absw */
+    var57.i = ORC_ABS (var49.i);
+    /* 17: cmpgtsw */
+    var58.i = (var57.i > var42.i) ? (~0) : 0;
+    /* 18: andw */
+    var59.i = var56.i & var58.i;
+    /* 19: loadb */
+    var43 = ptr4[i];
+    /* 20: convubw */
+    var60.i = (orc_uint8) var43;
+    /* 21: subw */
+    var61.i = var47.i - var60.i;
+    /* 22: absw */
+    var62.i = ORC_ABS (var61.i);
+    /* 24: cmpgtsw */
+    var63.i = (var44.i > var62.i) ? (~0) : 0;
+    /* 25: andw */
+    var64.i = var59.i & var63.i;
+    /* 27: andw */
+    var65.i = var64.i & var45.i;
+    /* 28: convwb */
+    var46 = var65.i;
+    /* 29: storeb */
+    ptr0[i] = var46;
+  }
+
+}
+
+void
+fieldanalysis_orc_comb_mask_32detect (guint8 * ORC_RESTRICT d1,
+    const orc_uint8 * ORC_RESTRICT s1, const orc_uint8 * ORC_RESTRICT s2,
+    const orc_uint8 * ORC_RESTRICT s3, const orc_uint8 * ORC_RESTRICT s4,
+    int p1, int p2, int n)
+{
+  OrcExecutor _ex, *ex = &_ex;
+  static volatile int p_inited = 0;
+  static OrcCode *c = 0;
+  void (*func) (OrcExecutor *);
+
+  if (!p_inited) {
+    orc_once_mutex_lock ();
+    if (!p_inited) {
+      OrcProgram *p;
+
+#if 1
+      static const orc_uint8 bc[] = {
+        1, 9, 36, 102, 105, 101, 108, 100, 97, 110, 97, 108, 121, 115, 105, 115,
+        95, 111, 114, 99, 95, 99, 111, 109, 98, 95, 109, 97, 115, 107, 95, 51,
+        50, 100, 101, 116, 101, 99, 116, 11, 1, 1, 12, 1, 1, 12, 1, 1,
+        12, 1, 1, 12, 1, 1, 14, 4, 15, 0, 0, 0, 14, 4, 10, 0,
+        0, 0, 14, 4, 1, 0, 0, 0, 16, 2, 16, 2, 20, 2, 20, 2,
+        20, 2, 20, 2, 20, 2, 150, 32, 6, 150, 33, 5, 98, 33, 32, 33,
+        150, 34, 7, 98, 34, 32, 34, 87, 35, 33, 34, 78, 35, 35, 24, 85,
+        36, 33, 34, 78, 36, 25, 36, 92, 35, 35, 36, 69, 33, 33, 78, 33,
+        33, 16, 73, 35, 35, 33, 150, 34, 4, 98, 34, 32, 34, 69, 34, 34,
+        78, 34, 17, 34, 73, 35, 35, 34, 73, 35, 35, 18, 157, 0, 35, 2,
+        0,
+      };
+      p = orc_program_new_from_static_bytecode (bc);
+      orc_program_set_backup_function (p,
+          _backup_fieldanalysis_orc_comb_mask_32detect);
+#else
+      p = orc_program_new ();
+      orc_program_set_name (p, "fieldanalysis_orc_comb_mask_32detect");
+      orc_program_set_backup_function (p,
+          _backup_fieldanalysis_orc_comb_mask_32detect);
+      orc_program_add_destination (p, 1, "d1");
+      orc_program_add_source (p, 1, "s1");
+      orc_program_add_source (p, 1, "s2");
+      orc_program_add_source (p, 1, "s3");
+      orc_program_add_source (p, 1, "s4");
+      orc_program_add_constant (p, 4, 0x0000000f, "c1");
+      orc_program_add_constant (p, 4, 0x0000000a, "c2");
+      orc_program_add_constant (p, 4, 0x00000001, "c3");
+      orc_program_add_parameter (p, 2, "p1");
+      orc_program_add_parameter (p, 2, "p2");
+      orc_program_add_temporary (p, 2, "t1");
+      orc_program_add_temporary (p, 2, "t2");
+      orc_program_add_temporary (p, 2, "t3");
+      orc_program_add_temporary (p, 2, "t4");
+      orc_program_add_temporary (p, 2, "t5");
+
+      orc_program_append_2 (p, "convubw", 0, ORC_VAR_T1, ORC_VAR_S3, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convubw", 0, ORC_VAR_T2, ORC_VAR_S2, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "subw", 0, ORC_VAR_T2, ORC_VAR_T1, ORC_VAR_T2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convubw", 0, ORC_VAR_T3, ORC_VAR_S4, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "subw", 0, ORC_VAR_T3, ORC_VAR_T1, ORC_VAR_T3,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "minsw", 0, ORC_VAR_T4, ORC_VAR_T2, ORC_VAR_T3,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "cmpgtsw", 0, ORC_VAR_T4, ORC_VAR_T4, ORC_VAR_P1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "maxsw", 0, ORC_VAR_T5, ORC_VAR_T2, ORC_VAR_T3,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "cmpgtsw", 0, ORC_VAR_T5, ORC_VAR_P2, ORC_VAR_T5,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "orw", 0, ORC_VAR_T4, ORC_VAR_T4, ORC_VAR_T5,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "absw", 0, ORC_VAR_T2, ORC_VAR_T2, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "cmpgtsw", 0, ORC_VAR_T2, ORC_VAR_T2, ORC_VAR_C1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "andw", 0, ORC_VAR_T4, ORC_VAR_T4, ORC_VAR_T2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convubw", 0, ORC_VAR_T3, ORC_VAR_S1, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "subw", 0, ORC_VAR_T3, ORC_VAR_T1, ORC_VAR_T3,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "absw", 0, ORC_VAR_T3, ORC_VAR_T3, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "cmpgtsw", 0, ORC_VAR_T3, ORC_VAR_C2, ORC_VAR_T3,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "andw", 0, ORC_VAR_T4, ORC_VAR_T4, ORC_VAR_T3,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "andw", 0, ORC_VAR_T4, ORC_VAR_T4, ORC_VAR_C3,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convwb", 0, ORC_VAR_D1, ORC_VAR_T4, ORC_VAR_D1,
+          ORC_VAR_D1);
+#endif
+
+      orc_program_compile (p);
+      c = orc_program_take_code (p);
+      orc_program_free (p);
+    }
+    p_inited = TRUE;
+    orc_once_mutex_unlock ();
+  }
+  ex->arrays[ORC_VAR_A2] = c;
+  ex->program = 0;
+
+  ex->n = n;
+  ex->arrays[ORC_VAR_D1] = d1;
+  ex->arrays[ORC_VAR_S1] = (void *) s1;
+  ex->arrays[ORC_VAR_S2] = (void *) s2;
+  ex->arrays[ORC_VAR_S3] = (void *) s3;
+  ex->arrays[ORC_VAR_S4] = (void *) s4;
+  ex->params[ORC_VAR_P1] = p1;
+  ex->params[ORC_VAR_P2] = p2;
+
+  func = c->exec;
+  func (ex);
+}
+#endif
+
+
+/* fieldanalysis_orc_comb_mask_iscombed */
+#ifdef DISABLE_ORC
+void
+fieldanalysis_orc_comb_mask_iscombed (guint8 * ORC_RESTRICT d1,
+    const orc_uint8 * ORC_RESTRICT s1, const orc_uint8 * ORC_RESTRICT s2,
+    const orc_uint8 * ORC_RESTRICT s3, int p1, int p2, int p3, int n)
+{
+  int i;
+  orc_int8 *ORC_RESTRICT ptr0;
+  const orc_int8 *ORC_RESTRICT ptr4;
+  const orc_int8 *ORC_RESTRICT ptr5;
+  const orc_int8 *ORC_RESTRICT ptr6;
+  orc_int8 var38;
+  orc_int8 var39;
+  orc_int8 var40;
+  orc_union16 var41;
+  orc_union16 var42;
+  orc_union32 var43;
+#if defined(__APPLE__) && __GNUC__ == 4 && __GNUC_MINOR__ == 2 && defined (__i386__)
+  volatile orc_union16 var44;
+#else
+  orc_union16 var44;
+#endif
+  orc_int8 var45;
+  orc_union16 var46;
+  orc_union16 var47;
+  orc_union16 var48;
+  orc_union16 var49;
+  orc_union16 var50;
+  orc_union16 var51;
+  orc_union16 var52;
+  orc_union16 var53;
+  orc_union16 var54;
+  orc_union16 var55;
+  orc_union32 var56;
+  orc_union32 var57;
+  orc_union16 var58;
+  orc_union16 var59;
+  orc_union16 var60;
+
+  ptr0 = (orc_int8 *) d1;
+  ptr4 = (orc_int8 *) s1;
+  ptr5 = (orc_int8 *) s2;
+  ptr6 = (orc_int8 *) s3;
+
+  /* 9: loadpw */
+  var41.i = p1;
+  /* 12: loadpw */
+  var42.i = p2;
+  /* 16: loadpl */
+  var43.i = p3;
+  /* 20: loadpw */
+  var44.i = (int) 0x00000001;   /* 1 or 4.94066e-324f */
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadb */
+    var38 = ptr5[i];
+    /* 1: convubw */
+    var46.i = (orc_uint8) var38;
+    /* 2: loadb */
+    var39 = ptr4[i];
+    /* 3: convubw */
+    var47.i = (orc_uint8) var39;
+    /* 4: subw */
+    var48.i = var46.i - var47.i;
+    /* 5: loadb */
+    var40 = ptr6[i];
+    /* 6: convubw */
+    var49.i = (orc_uint8) var40;
+    /* 7: subw */
+    var50.i = var46.i - var49.i;
+    /* 8: minsw */
+    var51.i = ORC_MIN (var48.i, var50.i);
+    /* 10: cmpgtsw */
+    var52.i = (var51.i > var41.i) ? (~0) : 0;
+    /* 11: maxsw */
+    var53.i = ORC_MAX (var48.i, var50.i);
+    /* 13: cmpgtsw */
+    var54.i = (var42.i > var53.i) ? (~0) : 0;
+    /* 14: orw */
+    var55.i = var52.i | var54.i;
+    /* 15: mulswl */
+    var56.i = var48.i * var50.i;
+    /* 17: cmpgtsl */
+    var57.i = (var56.i > var43.i) ? (~0) : 0;
+    /* 18: convlw */
+    var58.i = var57.i;
+    /* 19: andw */
+    var59.i = var55.i & var58.i;
+    /* 21: andw */
+    var60.i = var59.i & var44.i;
+    /* 22: convwb */
+    var45 = var60.i;
+    /* 23: storeb */
+    ptr0[i] = var45;
+  }
+
+}
+
+#else
+static void
+_backup_fieldanalysis_orc_comb_mask_iscombed (OrcExecutor * ORC_RESTRICT ex)
+{
+  int i;
+  int n = ex->n;
+  orc_int8 *ORC_RESTRICT ptr0;
+  const orc_int8 *ORC_RESTRICT ptr4;
+  const orc_int8 *ORC_RESTRICT ptr5;
+  const orc_int8 *ORC_RESTRICT ptr6;
+  orc_int8 var38;
+  orc_int8 var39;
+  orc_int8 var40;
+  orc_union16 var41;
+  orc_union16 var42;
+  orc_union32 var43;
+#if defined(__APPLE__) && __GNUC__ == 4 && __GNUC_MINOR__ == 2 && defined (__i386__)
+  volatile orc_union16 var44;
+#else
+  orc_union16 var44;
+#endif
+  orc_int8 var45;
+  orc_union16 var46;
+  orc_union16 var47;
+  orc_union16 var48;
+  orc_union16 var49;
+  orc_union16 var50;
+  orc_union16 var51;
+  orc_union16 var52;
+  orc_union16 var53;
+  orc_union16 var54;
+  orc_union16 var55;
+  orc_union32 var56;
+  orc_union32 var57;
+  orc_union16 var58;
+  orc_union16 var59;
+  orc_union16 var60;
+
+  ptr0 = (orc_int8 *) ex->arrays[0];
+  ptr4 = (orc_int8 *) ex->arrays[4];
+  ptr5 = (orc_int8 *) ex->arrays[5];
+  ptr6 = (orc_int8 *) ex->arrays[6];
+
+  /* 9: loadpw */
+  var41.i = ex->params[24];
+  /* 12: loadpw */
+  var42.i = ex->params[25];
+  /* 16: loadpl */
+  var43.i = ex->params[26];
+  /* 20: loadpw */
+  var44.i = (int) 0x00000001;   /* 1 or 4.94066e-324f */
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadb */
+    var38 = ptr5[i];
+    /* 1: convubw */
+    var46.i = (orc_uint8) var38;
+    /* 2: loadb */
+    var39 = ptr4[i];
+    /* 3: convubw */
+    var47.i = (orc_uint8) var39;
+    /* 4: subw */
+    var48.i = var46.i - var47.i;
+    /* 5: loadb */
+    var40 = ptr6[i];
+    /* 6: convubw */
+    var49.i = (orc_uint8) var40;
+    /* 7: subw */
+    var50.i = var46.i - var49.i;
+    /* 8: minsw */
+    var51.i = ORC_MIN (var48.i, var50.i);
+    /* 10: cmpgtsw */
+    var52.i = (var51.i > var41.i) ? (~0) : 0;
+    /* 11: maxsw */
+    var53.i = ORC_MAX (var48.i, var50.i);
+    /* 13: cmpgtsw */
+    var54.i = (var42.i > var53.i) ? (~0) : 0;
+    /* 14: orw */
+    var55.i = var52.i | var54.i;
+    /* 15: mulswl */
+    var56.i = var48.i * var50.i;
+    /* 17: cmpgtsl */
+    var57.i = (var56.i > var43.i) ? (~0) : 0;
+    /* 18: convlw */
+    var58.i = var57.i;
+    /* 19: andw */
+    var59.i = var55.i & var58.i;
+    /* 21: andw */
+    var60.i = var59.i & var44.i;
+    /* 22: convwb */
+    var45 = var60.i;
+    /* 23: storeb */
+    ptr0[i] = var45;
+  }
+
+}
+
+void
+fieldanalysis_orc_comb_mask_iscombed (guint8 * ORC_RESTRICT d1,
+    const orc_uint8 * ORC_RESTRICT s1, const orc_uint8 * ORC_RESTRICT s2,
+    const orc_uint8 * ORC_RESTRICT s3, int p1, int p2, int p3, int n)
+{
+  OrcExecutor _ex, *ex = &_ex;
+  static volatile int p_inited = 0;
+  static OrcCode *c = 0;
+  void (*func) (OrcExecutor *);
+
+  if (!p_inited) {
+    orc_once_mutex_lock ();
+    if (!p_inited) {
+      OrcProgram *p;
+
+#if 1
+      static const orc_uint8 bc[] = {
+        1, 9, 36, 102, 105, 101, 108, 100, 97, 110, 97, 108, 121, 115, 105, 115,
+        95, 111, 114, 99, 95, 99, 111, 109, 98, 95, 109, 97, 115, 107, 95, 105,
+        115, 99, 111, 109, 98, 101, 100, 11, 1, 1, 12, 1, 1, 12, 1, 1,
+        12, 1, 1, 14, 4, 1, 0, 0, 0, 16, 2, 16, 2, 16, 4, 20,
+        2, 20, 2, 20, 2, 20, 2, 20, 2, 20, 4, 150, 32, 5, 150, 33,
+        4, 98, 33, 32, 33, 150, 34, 6, 98, 34, 32, 34, 87, 35, 33, 34,
+        78, 35, 35, 24, 85, 36, 33, 34, 78, 36, 25, 36, 92, 35, 35, 36,
+        176, 37, 33, 34, 111, 37, 37, 26, 163, 36, 37, 73, 35, 35, 36, 73,
+        35, 35, 16, 157, 0, 35, 2, 0,
+      };
+      p = orc_program_new_from_static_bytecode (bc);
+      orc_program_set_backup_function (p,
+          _backup_fieldanalysis_orc_comb_mask_iscombed);
+#else
+      p = orc_program_new ();
+      orc_program_set_name (p, "fieldanalysis_orc_comb_mask_iscombed");
+      orc_program_set_backup_function (p,
+          _backup_fieldanalysis_orc_comb_mask_iscombed);
+      orc_program_add_destination (p, 1, "d1");
+      orc_program_add_source (p, 1, "s1");
+      orc_program_add_source (p, 1, "s2");
+      orc_program_add_source (p, 1, "s3");
+      orc_program_add_constant (p, 4, 0x00000001, "c1");
+      orc_program_add_parameter (p, 2, "p1");
+      orc_program_add_parameter (p, 2, "p2");
+      orc_program_add_parameter (p, 4, "p3");
+      orc_program_add_temporary (p, 2, "t1");
+      orc_program_add_temporary (p, 2, "t2");
+      orc_program_add_temporary (p, 2, "t3");
+      orc_program_add_temporary (p, 2, "t4");
+      orc_program_add_temporary (p, 2, "t5");
+      orc_program_add_temporary (p, 4, "t6");
+
+      orc_program_append_2 (p, "convubw", 0, ORC_VAR_T1, ORC_VAR_S2, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convubw", 0, ORC_VAR_T2, ORC_VAR_S1, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "subw", 0, ORC_VAR_T2, ORC_VAR_T1, ORC_VAR_T2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convubw", 0, ORC_VAR_T3, ORC_VAR_S3, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "subw", 0, ORC_VAR_T3, ORC_VAR_T1, ORC_VAR_T3,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "minsw", 0, ORC_VAR_T4, ORC_VAR_T2, ORC_VAR_T3,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "cmpgtsw", 0, ORC_VAR_T4, ORC_VAR_T4, ORC_VAR_P1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "maxsw", 0, ORC_VAR_T5, ORC_VAR_T2, ORC_VAR_T3,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "cmpgtsw", 0, ORC_VAR_T5, ORC_VAR_P2, ORC_VAR_T5,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "orw", 0, ORC_VAR_T4, ORC_VAR_T4, ORC_VAR_T5,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "mulswl", 0, ORC_VAR_T6, ORC_VAR_T2, ORC_VAR_T3,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "cmpgtsl", 0, ORC_VAR_T6, ORC_VAR_T6, ORC_VAR_P3,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convlw", 0, ORC_VAR_T5, ORC_VAR_T6, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "andw", 0, ORC_VAR_T4, ORC_VAR_T4, ORC_VAR_T5,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "andw", 0, ORC_VAR_T4, ORC_VAR_T4, ORC_VAR_C1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convwb", 0, ORC_VAR_D1, ORC_VAR_T4, ORC_VAR_D1,
+          ORC_VAR_D1);
+#endif
+
+      orc_program_compile (p);
+      c = orc_program_take_code (p);
+      orc_program_free (p);
+    }
+    p_inited = TRUE;
+    orc_once_mutex_unlock ();
+  }
+  ex->arrays[ORC_VAR_A2] = c;
+  ex->program = 0;
+
+  ex->n = n;
+  ex->arrays[ORC_VAR_D1] = d1;
+  ex->arrays[ORC_VAR_S1] = (void *) s1;
+  ex->arrays[ORC_VAR_S2] = (void *) s2;
+  ex->arrays[ORC_VAR_S3] = (void *) s3;
+  ex->params[ORC_VAR_P1] = p1;
+  ex->params[ORC_VAR_P2] = p2;
+  ex->params[ORC_VAR_P3] = p3;
+
+  func = c->exec;
+  func (ex);
+}
+#endif
+
+
+/* fieldanalysis_orc_comb_mask_5_tap */
+#ifdef DISABLE_ORC
+void
+fieldanalysis_orc_comb_mask_5_tap (guint8 * ORC_RESTRICT d1,
+    const orc_uint8 * ORC_RESTRICT s1, const orc_uint8 * ORC_RESTRICT s2,
+    const orc_uint8 * ORC_RESTRICT s3, const orc_uint8 * ORC_RESTRICT s4,
+    const orc_uint8 * ORC_RESTRICT s5, int p1, int p2, int p3, int n)
+{
+  int i;
+  orc_int8 *ORC_RESTRICT ptr0;
+  const orc_int8 *ORC_RESTRICT ptr4;
+  const orc_int8 *ORC_RESTRICT ptr5;
+  const orc_int8 *ORC_RESTRICT ptr6;
+  const orc_int8 *ORC_RESTRICT ptr7;
+  const orc_int8 *ORC_RESTRICT ptr8;
+  orc_int8 var38;
+  orc_int8 var39;
+  orc_int8 var40;
+  orc_union16 var41;
+  orc_union16 var42;
+#if defined(__APPLE__) && __GNUC__ == 4 && __GNUC_MINOR__ == 2 && defined (__i386__)
+  volatile orc_union16 var43;
+#else
+  orc_union16 var43;
+#endif
+  orc_int8 var44;
+  orc_int8 var45;
+  orc_union16 var46;
+#if defined(__APPLE__) && __GNUC__ == 4 && __GNUC_MINOR__ == 2 && defined (__i386__)
+  volatile orc_union16 var47;
+#else
+  orc_union16 var47;
+#endif
+  orc_int8 var48;
+  orc_union16 var49;
+  orc_union16 var50;
+  orc_union16 var51;
+  orc_union16 var52;
+  orc_union16 var53;
+  orc_union16 var54;
+  orc_union16 var55;
+  orc_union16 var56;
+  orc_union16 var57;
+  orc_union16 var58;
+  orc_union16 var59;
+  orc_union16 var60;
+  orc_union16 var61;
+  orc_union16 var62;
+  orc_union16 var63;
+  orc_union16 var64;
+  orc_union16 var65;
+  orc_union16 var66;
+  orc_union16 var67;
+  orc_union16 var68;
+  orc_union16 var69;
+  orc_union16 var70;
+
+  ptr0 = (orc_int8 *) d1;
+  ptr4 = (orc_int8 *) s1;
+  ptr5 = (orc_int8 *) s2;
+  ptr6 = (orc_int8 *) s3;
+  ptr7 = (orc_int8 *) s4;
+  ptr8 = (orc_int8 *) s5;
+
+  /* 9: loadpw */
+  var41.i = p1;
+  /* 12: loadpw */
+  var42.i = p2;
+  /* 16: loadpw */
+  var43.i = (int) 0x00000003;   /* 3 or 1.4822e-323f */
+  /* 27: loadpw */
+  var46.i = p3;
+  /* 30: loadpw */
+  var47.i = (int) 0x00000001;   /* 1 or 4.94066e-324f */
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadb */
+    var38 = ptr6[i];
+    /* 1: convubw */
+    var49.i = (orc_uint8) var38;
+    /* 2: loadb */
+    var39 = ptr5[i];
+    /* 3: convubw */
+    var50.i = (orc_uint8) var39;
+    /* 4: loadb */
+    var40 = ptr7[i];
+    /* 5: convubw */
+    var51.i = (orc_uint8) var40;
+    /* 6: subw */
+    var52.i = var49.i - var50.i;
+    /* 7: subw */
+    var53.i = var49.i - var51.i;
+    /* 8: minsw */
+    var54.i = ORC_MIN (var52.i, var53.i);
+    /* 10: cmpgtsw */
+    var55.i = (var54.i > var41.i) ? (~0) : 0;
+    /* 11: maxsw */
+    var56.i = ORC_MAX (var52.i, var53.i);
+    /* 13: cmpgtsw */
+    var57.i = (var42.i > var56.i) ? (~0) : 0;
+    /* 14: orw */
+    var58.i = var55.i | var57.i;
+    /* 15: addw */
+    var59.i = var50.i + var51.i;
+    /* 17: mullw */
+    var60.i = (var59.i * var43.i) & 0xffff;
+    /* 18: shlw */
+    var61.i = var49.i << 2;
+    /* 19: loadb */
+    var44 = ptr4[i];
+    /* 20: convubw */
+    var62.i = (orc_uint8) var44;
+    /* 21: addw */
+    var63.i = var61.i + var62.i;
+    /* 22: loadb */
+    var45 = ptr8[i];
+    /* 23: convubw */
+    var64.i = (orc_uint8) var45;
+    /* 24: addw */
+    var65.i = var63.i + var64.i;
+    /* 25: subw */
+    var66.i = var65.i - var60.i;
+    /* 26: absw */
+    var67.i = ORC_ABS (var66.i);
+    /* 28: cmpgtsw */
+    var68.i = (var67.i > var46.i) ? (~0) : 0;
+    /* 29: andw */
+    var69.i = var58.i & var68.i;
+    /* 31: andw */
+    var70.i = var69.i & var47.i;
+    /* 32: convwb */
+    var48 = var70.i;
+    /* 33: storeb */
+    ptr0[i] = var48;
+  }
+
+}
+
+#else
+static void
+_backup_fieldanalysis_orc_comb_mask_5_tap (OrcExecutor * ORC_RESTRICT ex)
+{
+  int i;
+  int n = ex->n;
+  orc_int8 *ORC_RESTRICT ptr0;
+  const orc_int8 *ORC_RESTRICT ptr4;
+  const orc_int8 *ORC_RESTRICT ptr5;
+  const orc_int8 *ORC_RESTRICT ptr6;
+  const orc_int8 *ORC_RESTRICT ptr7;
+  const orc_int8 *ORC_RESTRICT ptr8;
+  orc_int8 var38;
+  orc_int8 var39;
+  orc_int8 var40;
+  orc_union16 var41;
+  orc_union16 var42;
+#if defined(__APPLE__) && __GNUC__ == 4 && __GNUC_MINOR__ == 2 && defined (__i386__)
+  volatile orc_union16 var43;
+#else
+  orc_union16 var43;
+#endif
+  orc_int8 var44;
+  orc_int8 var45;
+  orc_union16 var46;
+#if defined(__APPLE__) && __GNUC__ == 4 && __GNUC_MINOR__ == 2 && defined (__i386__)
+  volatile orc_union16 var47;
+#else
+  orc_union16 var47;
+#endif
+  orc_int8 var48;
+  orc_union16 var49;
+  orc_union16 var50;
+  orc_union16 var51;
+  orc_union16 var52;
+  orc_union16 var53;
+  orc_union16 var54;
+  orc_union16 var55;
+  orc_union16 var56;
+  orc_union16 var57;
+  orc_union16 var58;
+  orc_union16 var59;
+  orc_union16 var60;
+  orc_union16 var61;
+  orc_union16 var62;
+  orc_union16 var63;
+  orc_union16 var64;
+  orc_union16 var65;
+  orc_union16 var66;
+  orc_union16 var67;
+  orc_union16 var68;
+  orc_union16 var69;
+  orc_union16 var70;
+
+  ptr0 = (orc_int8 *) ex->arrays[0];
+  ptr4 = (orc_int8 *) ex->arrays[4];
+  ptr5 = (orc_int8 *) ex->arrays[5];
+  ptr6 = (orc_int8 *) ex->arrays[6];
+  ptr7 = (orc_int8 *) ex->arrays[7];
+  ptr8 = (orc_int8 *) ex->arrays[8];
+
+  /* 9: loadpw */
+  var41.i = ex->params[24];
+  /* 12: loadpw */
+  var42.i = ex->params[25];
+  /* 16: loadpw */
+  var43.i = (int) 0x00000003;   /* 3 or 1.4822e-323f */
+  /* 27: loadpw */
+  var46.i = ex->params[26];
+  /* 30: loadpw */
+  var47.i = (int) 0x00000001;   /* 1 or 4.94066e-324f */
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadb */
+    var38 = ptr6[i];
+    /* 1: convubw */
+    var49.i = (orc_uint8) var38;
+    /* 2: loadb */
+    var39 = ptr5[i];
+    /* 3: convubw */
+    var50.i = (orc_uint8) var39;
+    /* 4: loadb */
+    var40 = ptr7[i];
+    /* 5: convubw */
+    var51.i = (orc_uint8) var40;
+    /* 6: subw */
+    var52.i = var49.i - var50.i;
+    /* 7: subw */
+    var53.i = var49.i - var51.i;
+    /* 8: minsw */
+    var54.i = ORC_MIN (var52.i, var53.i);
+    /* 10: cmpgtsw */
+    var55.i = (var54.i > var41.i) ? (~0) : 0;
+    /* 11: maxsw */
+    var56.i = ORC_MAX (var52.i, var53.i);
+    /* 13: cmpgtsw */
+    var57.i = (var42.i > var56.i) ? (~0) : 0;
+    /* 14: orw */
+    var58.i = var55.i | var57.i;
+    /* 15: addw */
+    var59.i = var50.i + var51.i;
+    /* 17: mullw */
+    var60.i = (var59.i * var43.i) & 0xffff;
+    /* 18: shlw */
+    var61.i = var49.i << 2;
+    /* 19: loadb */
+    var44 = ptr4[i];
+    /* 20: convubw */
+    var62.i = (orc_uint8) var44;
+    /* 21: addw */
+    var63.i = var61.i + var62.i;
+    /* 22: loadb */
+    var45 = ptr8[i];
+    /* 23: convubw */
+    var64.i = (orc_uint8) var45;
+    /* 24: addw */
+    var65.i = var63.i + var64.i;
+    /* 25: subw */
+    var66.i = var65.i - var60.i;
+    /* 26: absw */
+    var67.i = ORC_ABS (var66.i);
+    /* 28: cmpgtsw */
+    var68.i = (var67.i > var46.i) ? (~0) : 0;
+    /* 29: andw */
+    var69.i = var58.i & var68.i;
+    /* 31: andw */
+    var70.i = var69.i & var47.i;
+    /* 32: convwb */
+    var48 = var70.i;
+    /* 33: storeb */
+    ptr0[i] = var48;
+  }
+
+}
+
+void
+fieldanalysis_orc_comb_mask_5_tap (guint8 * ORC_RESTRICT d1,
+    const orc_uint8 * ORC_RESTRICT s1, const orc_uint8 * ORC_RESTRICT s2,
+    const orc_uint8 * ORC_RESTRICT s3, const orc_uint8 * ORC_RESTRICT s4,
+    const orc_uint8 * ORC_RESTRICT s5, int p1, int p2, int p3, int n)
+{
+  OrcExecutor _ex, *ex = &_ex;
+  static volatile int p_inited = 0;
+  static OrcCode *c = 0;
+  void (*func) (OrcExecutor *);
+
+  if (!p_inited) {
+    orc_once_mutex_lock ();
+    if (!p_inited) {
+      OrcProgram *p;
+
+#if 1
+      static const orc_uint8 bc[] = {
+        1, 9, 33, 102, 105, 101, 108, 100, 97, 110, 97, 108, 121, 115, 105, 115,
+        95, 111, 114, 99, 95, 99, 111, 109, 98, 95, 109, 97, 115, 107, 95, 53,
+        95, 116, 97, 112, 11, 1, 1, 12, 1, 1, 12, 1, 1, 12, 1, 1,
+        12, 1, 1, 12, 1, 1, 14, 4, 3, 0, 0, 0, 14, 4, 2, 0,
+        0, 0, 14, 4, 1, 0, 0, 0, 16, 2, 16, 2, 16, 2, 20, 2,
+        20, 2, 20, 2, 20, 2, 20, 2, 20, 2, 150, 32, 6, 150, 33, 5,
+        150, 34, 7, 98, 35, 32, 33, 98, 36, 32, 34, 87, 37, 35, 36, 78,
+        37, 37, 24, 85, 35, 35, 36, 78, 35, 25, 35, 92, 37, 37, 35, 70,
+        33, 33, 34, 89, 33, 33, 16, 93, 32, 32, 17, 150, 35, 4, 70, 32,
+        32, 35, 150, 36, 8, 70, 32, 32, 36, 98, 32, 32, 33, 69, 32, 32,
+        78, 32, 32, 26, 73, 37, 37, 32, 73, 37, 37, 18, 157, 0, 37, 2,
+        0,
+      };
+      p = orc_program_new_from_static_bytecode (bc);
+      orc_program_set_backup_function (p,
+          _backup_fieldanalysis_orc_comb_mask_5_tap);
+#else
+      p = orc_program_new ();
+      orc_program_set_name (p, "fieldanalysis_orc_comb_mask_5_tap");
+      orc_program_set_backup_function (p,
+          _backup_fieldanalysis_orc_comb_mask_5_tap);
+      orc_program_add_destination (p, 1, "d1");
+      orc_program_add_source (p, 1, "s1");
+      orc_program_add_source (p, 1, "s2");
+      orc_program_add_source (p, 1, "s3");
+      orc_program_add_source (p, 1, "s4");
+      orc_program_add_source (p, 1, "s5");
+      orc_program_add_constant (p, 4, 0x00000003, "c1");
+      orc_program_add_constant (p, 4, 0x00000002, "c2");
+      orc_program_add_constant (p, 4, 0x00000001, "c3");
+      orc_program_add_parameter (p, 2, "p1");
+      orc_program_add_parameter (p, 2, "p2");
+      orc_program_add_parameter (p, 2, "p3");
+      orc_program_add_temporary (p, 2, "t1");
+      orc_program_add_temporary (p, 2, "t2");
+      orc_program_add_temporary (p, 2, "t3");
+      orc_program_add_temporary (p, 2, "t4");
+      orc_program_add_temporary (p, 2, "t5");
+      orc_program_add_temporary (p, 2, "t6");
+
+      orc_program_append_2 (p, "convubw", 0, ORC_VAR_T1, ORC_VAR_S3, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convubw", 0, ORC_VAR_T2, ORC_VAR_S2, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convubw", 0, ORC_VAR_T3, ORC_VAR_S4, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "subw", 0, ORC_VAR_T4, ORC_VAR_T1, ORC_VAR_T2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "subw", 0, ORC_VAR_T5, ORC_VAR_T1, ORC_VAR_T3,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "minsw", 0, ORC_VAR_T6, ORC_VAR_T4, ORC_VAR_T5,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "cmpgtsw", 0, ORC_VAR_T6, ORC_VAR_T6, ORC_VAR_P1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "maxsw", 0, ORC_VAR_T4, ORC_VAR_T4, ORC_VAR_T5,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "cmpgtsw", 0, ORC_VAR_T4, ORC_VAR_P2, ORC_VAR_T4,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "orw", 0, ORC_VAR_T6, ORC_VAR_T6, ORC_VAR_T4,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "addw", 0, ORC_VAR_T2, ORC_VAR_T2, ORC_VAR_T3,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "mullw", 0, ORC_VAR_T2, ORC_VAR_T2, ORC_VAR_C1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "shlw", 0, ORC_VAR_T1, ORC_VAR_T1, ORC_VAR_C2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convubw", 0, ORC_VAR_T4, ORC_VAR_S1, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "addw", 0, ORC_VAR_T1, ORC_VAR_T1, ORC_VAR_T4,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convubw", 0, ORC_VAR_T5, ORC_VAR_S5, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "addw", 0, ORC_VAR_T1, ORC_VAR_T1, ORC_VAR_T5,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "subw", 0, ORC_VAR_T1, ORC_VAR_T1, ORC_VAR_T2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "absw", 0, ORC_VAR_T1, ORC_VAR_T1, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "cmpgtsw", 0, ORC_VAR_T1, ORC_VAR_T1, ORC_VAR_P3,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "andw", 0, ORC_VAR_T6, ORC_VAR_T6, ORC_VAR_T1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "andw", 0, ORC_VAR_T6, ORC_VAR_T6, ORC_VAR_C3,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convwb", 0, ORC_VAR_D1, ORC_VAR_T6, ORC_VAR_D1,
+          ORC_VAR_D1);
+#endif
+
+      orc_program_compile (p);
+      c = orc_program_take_code (p);
+      orc_program_free (p);
+    }
+    p_inited = TRUE;
+    orc_once_mutex_unlock ();
+  }
+  ex->arrays[ORC_VAR_A2] = c;
+  ex->program = 0;
+
+  ex->n = n;
+  ex->arrays[ORC_VAR_D1] = d1;
+  ex->arrays[ORC_VAR_S1] = (void *) s1;
+  ex->arrays[ORC_VAR_S2] = (void *) s2;
+  ex->arrays[ORC_VAR_S3] = (void *) s3;
+  ex->arrays[ORC_VAR_S4] = (void *) s4;
+  ex->arrays[ORC_VAR_S5] = (void *) s5;
+  ex->params[ORC_VAR_P1] = p1;
+  ex->params[ORC_VAR_P2] = p2;
+  ex->params[ORC_VAR_P3] = p3;
+
+  func = c->exec;
+  func (ex);
+}
+#endif
+
+
+/* fieldanalysis_orc_comb_mask_count */
+#ifdef DISABLE_ORC
+void
+fieldanalysis_orc_comb_mask_count (guint16 * ORC_RESTRICT d1,
+    const orc_uint8 * ORC_RESTRICT s1, const orc_uint8 * ORC_RESTRICT s2,
+    const orc_uint8 * ORC_RESTRICT s3, int n)
+{
+  int i;
+  orc_union16 *ORC_RESTRICT ptr0;
+  const orc_int8 *ORC_RESTRICT ptr4;
+  const orc_int8 *ORC_RESTRICT ptr5;
+  const orc_int8 *ORC_RESTRICT ptr6;
+  orc_int8 var34;
+  orc_int8 var35;
+  orc_int8 var36;
+  orc_union16 var37;
+  orc_union16 var38;
+  orc_int8 var39;
+  orc_int8 var40;
+  orc_union16 var41;
+
+  ptr0 = (orc_union16 *) d1;
+  ptr4 = (orc_int8 *) s1;
+  ptr5 = (orc_int8 *) s2;
+  ptr6 = (orc_int8 *) s3;
+
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadb */
+    var34 = ptr4[i];
+    /* 1: loadb */
+    var35 = ptr5[i];
+    /* 2: andb */
+    var39 = var34 & var35;
+    /* 3: loadb */
+    var36 = ptr6[i];
+    /* 4: andb */
+    var40 = var39 & var36;
+    /* 5: convubw */
+    var41.i = (orc_uint8) var40;
+    /* 6: loadw */
+    var37 = ptr0[i];
+    /* 7: addw */
+    var38.i = var37.i + var41.i;
+    /* 8: storew */
+    ptr0[i] = var38;
+  }
+
+}
+
+#else
+static void
+_backup_fieldanalysis_orc_comb_mask_count (OrcExecutor * ORC_RESTRICT ex)
+{
+  int i;
+  int n = ex->n;
+  orc_union16 *ORC_RESTRICT ptr0;
+  const orc_int8 *ORC_RESTRICT ptr4;
+  const orc_int8 *ORC_RESTRICT ptr5;
+  const orc_int8 *ORC_RESTRICT ptr6;
+  orc_int8 var34;
+  orc_int8 var35;
+  orc_int8 var36;
+  orc_union16 var37;
+  orc_union16 var38;
+  orc_int8 var39;
+  orc_int8 var40;
+  orc_union16 var41;
+
+  ptr0 = (orc_union16 *) ex->arrays[0];
+  ptr4 = (orc_int8 *) ex->arrays[4];
+  ptr5 = (orc_int8 *) ex->arrays[5];
+  ptr6 = (orc_int8 *) ex->arrays[6];
+
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadb */
+    var34 = ptr4[i];
+    /* 1: loadb */
+    var35 = ptr5[i];
+    /* 2: andb */
+    var39 = var34 & var35;
+    /* 3: loadb */
+    var36 = ptr6[i];
+    /* 4: andb */
+    var40 = var39 & var36;
+    /* 5: convubw */
+    var41.i = (orc_uint8) var40;
+    /* 6: loadw */
+    var37 = ptr0[i];
+    /* 7: addw */
+    var38.i = var37.i + var41.i;
+    /* 8: storew */
+    ptr0[i] = var38;
+  }
+
+}
+
+void
+fieldanalysis_orc_comb_mask_count (guint16 * ORC_RESTRICT d1,
+    const orc_uint8 * ORC_RESTRICT s1, const orc_uint8 * ORC_RESTRICT s2,
+    const orc_uint8 * ORC_RESTRICT s3, int n)
+{
+  OrcExecutor _ex, *ex = &_ex;
+  static volatile int p_inited = 0;
+  static OrcCode *c = 0;
+  void (*func) (OrcExecutor *);
+
+  if (!p_inited) {
+    orc_once_mutex_lock ();
+    if (!p_inited) {
+      OrcProgram *p;
+
+#if 1
+      static const orc_uint8 bc[] = {
+        1, 9, 33, 102, 105, 101, 108, 100, 97, 110, 97, 108, 121, 115, 105, 115,
+        95, 111, 114, 99, 95, 99, 111, 109, 98, 95, 109, 97, 115, 107, 95, 99,
+        111, 117, 110, 116, 11, 2, 2, 12, 1, 1, 12, 1, 1, 12, 1, 1,
+        20, 1, 20, 2, 36, 32, 4, 5, 36, 32, 32, 6, 150, 33, 32, 70,
+        0, 0, 33, 2, 0,
+      };
+      p = orc_program_new_from_static_bytecode (bc);
+      orc_program_set_backup_function (p,
+          _backup_fieldanalysis_orc_comb_mask_count);
+#else
+      p = orc_program_new ();
+      orc_program_set_name (p, "fieldanalysis_orc_comb_mask_count");
+      orc_program_set_backup_function (p,
+          _backup_fieldanalysis_orc_comb_mask_count);
+      orc_program_add_destination (p, 2, "d1");
+      orc_program_add_source (p, 1, "s1");
+      orc_program_add_source (p, 1, "s2");
+      orc_program_add_source (p, 1, "s3");
+      orc_program_add_temporary (p, 1, "t1");
+      orc_program_add_temporary (p, 2, "t2");
+
+      orc_program_append_2 (p, "andb", 0, ORC_VAR_T1, ORC_VAR_S1, ORC_VAR_S2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "andb", 0, ORC_VAR_T1, ORC_VAR_T1, ORC_VAR_S3,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convubw", 0, ORC_VAR_T2, ORC_VAR_T1, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "addw", 0, ORC_VAR_D1, ORC_VAR_D1, ORC_VAR_T2,
+          ORC_VAR_D1);
+#endif
+
+      orc_program_compile (p);
+      c = orc_program_take_code (p);
+      orc_program_free (p);
+    }
+    p_inited = TRUE;
+    orc_once_mutex_unlock ();
+  }
+  ex->arrays[ORC_VAR_A2] = c;
+  ex->program = 0;
+
+  ex->n = n;
+  ex->arrays[ORC_VAR_D1] = d1;
+  ex->arrays[ORC_VAR_S1] = (void *) s1;
+  ex->arrays[ORC_VAR_S2] = (void *) s2;
+  ex->arrays[ORC_VAR_S3] = (void *) s3;
+
+  func = c->exec;
+  func (ex);
+}
+#endif
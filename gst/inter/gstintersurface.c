@@ -49,6 +49,7 @@ gst_inter_surface_get (const char *name)
   surface->name = g_strdup (name);
   g_mutex_init (&surface->mutex);
   surface->audio_adapter = gst_adapter_new ();
+  surface->n_video_frames = 1;
 
   list = g_list_append (list, surface);
   g_mutex_unlock (&mutex);
@@ -61,3 +62,105 @@ gst_inter_surface_unref (GstInterSurface * surface)
 {
 
 }
+
+static void
+gst_inter_video_frame_free (GstInterVideoFrame * frame)
+{
+  gst_buffer_unref (frame->buffer);
+  g_slice_free (GstInterVideoFrame, frame);
+}
+
+/* Replaces the oldest frame of the ring by a new reference to @buffer */
+void
+gst_inter_surface_push_video_frame (GstInterSurface * surface,
+    GstBuffer * buffer, GstClockTime time)
+{
+  GstInterVideoFrame *frame, *old;
+  guint n_frames;
+
+  frame = g_slice_new (GstInterVideoFrame);
+  frame->buffer = gst_buffer_ref (buffer);
+  frame->time = time;
+
+  g_mutex_lock (&surface->mutex);
+  frame->seq = surface->video_frame_seq++;
+  n_frames = CLAMP (surface->n_video_frames, 1,
+      GST_INTER_SURFACE_MAX_VIDEO_FRAMES);
+  old = surface->video_frames[frame->seq % n_frames];
+  surface->video_frames[frame->seq % n_frames] = frame;
+  g_mutex_unlock (&surface->mutex);
+
+  if (old)
+    gst_inter_video_frame_free (old);
+}
+
+/* Returns a reference to the last frame to be shown at @time, or the oldest
+ * one if they are all later, or the last one if @time or their time is
+ * GST_CLOCK_TIME_NONE. If @have_seq is set, frames before the one numbered
+ * @seq are skipped. The number of the frame is returned in @seq.
+ *
+ * The frames are left in the ring, so that several sources can read the
+ * same channel. The lock is only held to compare them and reference the
+ * best one. */
+GstBuffer *
+gst_inter_surface_pick_video_frame (GstInterSurface * surface,
+    GstClockTime time, gboolean have_seq, guint * seq)
+{
+  GstInterVideoFrame *best = NULL;
+  GstBuffer *buffer = NULL;
+  guint i;
+
+  g_mutex_lock (&surface->mutex);
+  for (i = 0; i < GST_INTER_SURFACE_MAX_VIDEO_FRAMES; i++) {
+    GstInterVideoFrame *frame = surface->video_frames[i];
+    gboolean better;
+
+    if (frame == NULL)
+      continue;
+
+    if (have_seq && (gint) (frame->seq - *seq) < 0) {
+      better = FALSE;
+    } else if (best == NULL) {
+      better = TRUE;
+    } else if (!GST_CLOCK_TIME_IS_VALID (time)
+        || !GST_CLOCK_TIME_IS_VALID (frame->time)
+        || !GST_CLOCK_TIME_IS_VALID (best->time)) {
+      better = (gint) (frame->seq - best->seq) > 0;
+    } else if (frame->time <= time) {
+      better = best->time > time || frame->time > best->time;
+    } else {
+      better = best->time > time && frame->time < best->time;
+    }
+
+    if (better)
+      best = frame;
+  }
+
+  if (best) {
+    buffer = gst_buffer_ref (best->buffer);
+    *seq = best->seq;
+  }
+  g_mutex_unlock (&surface->mutex);
+
+  return buffer;
+}
+
+/* Empties the ring and sets its size to @n_frames */
+void
+gst_inter_surface_reset_video_frames (GstInterSurface * surface,
+    int n_frames)
+{
+  GstInterVideoFrame *frames[GST_INTER_SURFACE_MAX_VIDEO_FRAMES];
+  guint i;
+
+  g_mutex_lock (&surface->mutex);
+  memcpy (frames, surface->video_frames, sizeof (frames));
+  memset (surface->video_frames, 0, sizeof (surface->video_frames));
+  surface->n_video_frames = n_frames;
+  g_mutex_unlock (&surface->mutex);
+
+  for (i = 0; i < GST_INTER_SURFACE_MAX_VIDEO_FRAMES; i++) {
+    if (frames[i])
+      gst_inter_video_frame_free (frames[i]);
+  }
+}
@@ -26,6 +26,18 @@
 G_BEGIN_DECLS
 
 typedef struct _GstInterSurface GstInterSurface;
+typedef struct _GstInterVideoFrame GstInterVideoFrame;
+
+#define GST_INTER_SURFACE_MAX_VIDEO_FRAMES 16
+
+/* A video frame on the surface, with the clock time at which it is to be
+ * shown, or GST_CLOCK_TIME_NONE, and its sequence number */
+struct _GstInterVideoFrame
+{
+  GstBuffer *buffer;
+  GstClockTime time;
+  guint seq;
+};
 
 struct _GstInterSurface
 {
@@ -39,13 +51,16 @@ struct _GstInterSurface
   int width;
   int height;
   int n_frames;
-  int video_buffer_count;
 
   /* audio */
   int sample_rate;
   int n_channels;
 
-  GstBuffer *video_buffer;
+  /* ring of the last n_video_frames frames, protected by mutex */
+  GstInterVideoFrame *video_frames[GST_INTER_SURFACE_MAX_VIDEO_FRAMES];
+  int n_video_frames;
+  guint video_frame_seq;
+
   GstBuffer *sub_buffer;
   GstAdapter *audio_adapter;
 };
@@ -54,6 +69,13 @@ struct _GstInterSurface
 GstInterSurface * gst_inter_surface_get (const char *name);
 void gst_inter_surface_unref (GstInterSurface *surface);
 
+void gst_inter_surface_push_video_frame (GstInterSurface *surface,
+    GstBuffer *buffer, GstClockTime time);
+GstBuffer * gst_inter_surface_pick_video_frame (GstInterSurface *surface,
+    GstClockTime time, gboolean have_seq, guint *seq);
+void gst_inter_surface_reset_video_frames (GstInterSurface *surface,
+    int n_frames);
+
 
 G_END_DECLS
 
@@ -33,6 +33,12 @@
  * as it requires a second pipeline in the application to send video to.
  * See the gstintertest.c example in the gst-plugins-bad source code for
  * more details.
+ *
+ * To absorb the jitter between the two pipelines, the last
+ * #GstInterVideoSink:ring-size frames are kept with the clock time at which
+ * they are rendered, and intervideosrc outputs the one meant to be shown
+ * at the time of each of its frames. Both pipelines need to use the same
+ * clock for this.
  * </refsect2>
  */
 
@@ -61,15 +67,20 @@ static void gst_inter_video_sink_get_times (GstBaseSink * sink,
     GstBuffer * buffer, GstClockTime * start, GstClockTime * end);
 static gboolean gst_inter_video_sink_start (GstBaseSink * sink);
 static gboolean gst_inter_video_sink_stop (GstBaseSink * sink);
+static gboolean gst_inter_video_sink_propose_allocation (GstBaseSink * sink,
+    GstQuery * query);
 static GstFlowReturn gst_inter_video_sink_render (GstBaseSink * sink,
     GstBuffer * buffer);
 
 enum
 {
   PROP_0,
-  PROP_CHANNEL
+  PROP_CHANNEL,
+  PROP_RING_SIZE
 };
 
+#define DEFAULT_RING_SIZE 1
+
 /* pad templates */
 
 static GstStaticPadTemplate gst_inter_video_sink_sink_template =
@@ -110,18 +121,28 @@ gst_inter_video_sink_class_init (GstInterVideoSinkClass * klass)
       GST_DEBUG_FUNCPTR (gst_inter_video_sink_get_times);
   base_sink_class->start = GST_DEBUG_FUNCPTR (gst_inter_video_sink_start);
   base_sink_class->stop = GST_DEBUG_FUNCPTR (gst_inter_video_sink_stop);
+  base_sink_class->propose_allocation =
+      GST_DEBUG_FUNCPTR (gst_inter_video_sink_propose_allocation);
   base_sink_class->render = GST_DEBUG_FUNCPTR (gst_inter_video_sink_render);
 
   g_object_class_install_property (gobject_class, PROP_CHANNEL,
       g_param_spec_string ("channel", "Channel",
           "Channel name to match inter src and sink elements",
           "default", G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_RING_SIZE,
+      g_param_spec_int ("ring-size", "Ring size",
+          "Number of frames kept for intervideosrc to pick from, which are "
+          "not returned to the upstream buffer pool meanwhile",
+          1, GST_INTER_SURFACE_MAX_VIDEO_FRAMES, DEFAULT_RING_SIZE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 }
 
 static void
 gst_inter_video_sink_init (GstInterVideoSink * intervideosink)
 {
   intervideosink->channel = g_strdup ("default");
+  intervideosink->ring_size = DEFAULT_RING_SIZE;
 }
 
 void
@@ -135,6 +156,11 @@ gst_inter_video_sink_set_property (GObject * object, guint property_id,
       g_free (intervideosink->channel);
       intervideosink->channel = g_value_dup_string (value);
       break;
+    case PROP_RING_SIZE:
+      GST_OBJECT_LOCK (intervideosink);
+      intervideosink->ring_size = g_value_get_int (value);
+      GST_OBJECT_UNLOCK (intervideosink);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
       break;
@@ -151,6 +177,11 @@ gst_inter_video_sink_get_property (GObject * object, guint property_id,
     case PROP_CHANNEL:
       g_value_set_string (value, intervideosink->channel);
       break;
+    case PROP_RING_SIZE:
+      GST_OBJECT_LOCK (intervideosink);
+      g_value_set_int (value, intervideosink->ring_size);
+      GST_OBJECT_UNLOCK (intervideosink);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
       break;
@@ -195,8 +226,14 @@ static gboolean
 gst_inter_video_sink_start (GstBaseSink * sink)
 {
   GstInterVideoSink *intervideosink = GST_INTER_VIDEO_SINK (sink);
+  int ring_size;
+
+  GST_OBJECT_LOCK (intervideosink);
+  ring_size = intervideosink->ring_size;
+  GST_OBJECT_UNLOCK (intervideosink);
 
   intervideosink->surface = gst_inter_surface_get (intervideosink->channel);
+  gst_inter_surface_reset_video_frames (intervideosink->surface, ring_size);
 
   return TRUE;
 }
@@ -206,12 +243,7 @@ gst_inter_video_sink_stop (GstBaseSink * sink)
 {
   GstInterVideoSink *intervideosink = GST_INTER_VIDEO_SINK (sink);
 
-  g_mutex_lock (&intervideosink->surface->mutex);
-  if (intervideosink->surface->video_buffer) {
-    gst_buffer_unref (intervideosink->surface->video_buffer);
-  }
-  intervideosink->surface->video_buffer = NULL;
-  g_mutex_unlock (&intervideosink->surface->mutex);
+  gst_inter_surface_reset_video_frames (intervideosink->surface, 1);
 
   gst_inter_surface_unref (intervideosink->surface);
   intervideosink->surface = NULL;
@@ -219,18 +251,45 @@ gst_inter_video_sink_stop (GstBaseSink * sink)
   return TRUE;
 }
 
+/* Ask upstream for enough buffers to fill the ring, on top of the ones it
+ * needs for itself */
+static gboolean
+gst_inter_video_sink_propose_allocation (GstBaseSink * sink, GstQuery * query)
+{
+  GstInterVideoSink *intervideosink = GST_INTER_VIDEO_SINK (sink);
+  GstCaps *caps;
+  GstVideoInfo info;
+  int ring_size;
+
+  gst_query_parse_allocation (query, &caps, NULL);
+  if (caps == NULL || !gst_video_info_from_caps (&info, caps))
+    return FALSE;
+
+  GST_OBJECT_LOCK (intervideosink);
+  ring_size = intervideosink->ring_size;
+  GST_OBJECT_UNLOCK (intervideosink);
+
+  gst_query_add_allocation_pool (query, NULL, info.size, ring_size + 1, 0);
+
+  return TRUE;
+}
+
 static GstFlowReturn
 gst_inter_video_sink_render (GstBaseSink * sink, GstBuffer * buffer)
 {
   GstInterVideoSink *intervideosink = GST_INTER_VIDEO_SINK (sink);
-
-  g_mutex_lock (&intervideosink->surface->mutex);
-  if (intervideosink->surface->video_buffer) {
-    gst_buffer_unref (intervideosink->surface->video_buffer);
+  GstClockTime time = GST_CLOCK_TIME_NONE;
+
+  /* the clock time of the frame, for intervideosrc to compare with the
+   * clock time of its own frames */
+  if (GST_BUFFER_PTS_IS_VALID (buffer) && GST_ELEMENT_CLOCK (sink)) {
+    time = gst_segment_to_running_time (&sink->segment, GST_FORMAT_TIME,
+        GST_BUFFER_PTS (buffer));
+    if (GST_CLOCK_TIME_IS_VALID (time))
+      time += gst_element_get_base_time (GST_ELEMENT (sink));
   }
-  intervideosink->surface->video_buffer = gst_buffer_ref (buffer);
-  intervideosink->surface->video_buffer_count = 0;
-  g_mutex_unlock (&intervideosink->surface->mutex);
+
+  gst_inter_surface_push_video_frame (intervideosink->surface, buffer, time);
 
   return GST_FLOW_OK;
 }
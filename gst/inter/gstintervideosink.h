@@ -40,6 +40,7 @@ struct _GstInterVideoSink
 
   GstInterSurface *surface;
   char *channel;
+  int ring_size;
 
   int fps_n;
   int fps_d;
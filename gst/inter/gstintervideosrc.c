@@ -31,6 +31,13 @@
  * 
  * The intersubsrc element cannot be used effectively with gst-launch,
  * as it requires a second pipeline in the application to send subtitles.
+ *
+ * Each output frame is the last frame rendered by intervideosink before the
+ * middle of the output frame, as told by their clocks, so that the jitter
+ * between the pipelines does not drop or duplicate frames as long as it fits
+ * in the #GstInterVideoSink:ring-size frames of intervideosink. The frames
+ * that are skipped or repeated anyway are counted in the
+ * #GstInterVideoSrc:drop and #GstInterVideoSrc:duplicate properties.
  * </refsect2>
  */
 
@@ -70,9 +77,14 @@ static GstCaps *gst_inter_video_src_fixate (GstBaseSrc * src, GstCaps * caps);
 enum
 {
   PROP_0,
-  PROP_CHANNEL
+  PROP_CHANNEL,
+  PROP_DROP,
+  PROP_DUPLICATE
 };
 
+/* number of times the last frame is repeated before black is output */
+#define MAX_REPEATS 30
+
 /* pad templates */
 
 static GstStaticPadTemplate gst_inter_video_src_src_template =
@@ -121,6 +133,15 @@ gst_inter_video_src_class_init (GstInterVideoSrcClass * klass)
           "Channel name to match inter src and sink elements",
           "default", G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  g_object_class_install_property (gobject_class, PROP_DROP,
+      g_param_spec_uint64 ("drop", "Drop",
+          "Number of frames of intervideosink that were not output", 0,
+          G_MAXUINT64, 0, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_DUPLICATE,
+      g_param_spec_uint64 ("duplicate", "Duplicate",
+          "Number of frames of intervideosink that were output again", 0,
+          G_MAXUINT64, 0, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
 }
 
 static void
@@ -159,6 +180,16 @@ gst_inter_video_src_get_property (GObject * object, guint property_id,
     case PROP_CHANNEL:
       g_value_set_string (value, intervideosrc->channel);
       break;
+    case PROP_DROP:
+      GST_OBJECT_LOCK (intervideosrc);
+      g_value_set_uint64 (value, intervideosrc->dropped);
+      GST_OBJECT_UNLOCK (intervideosrc);
+      break;
+    case PROP_DUPLICATE:
+      GST_OBJECT_LOCK (intervideosrc);
+      g_value_set_uint64 (value, intervideosrc->duplicated);
+      GST_OBJECT_UNLOCK (intervideosrc);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
       break;
@@ -200,6 +231,13 @@ gst_inter_video_src_start (GstBaseSrc * src)
   GST_DEBUG_OBJECT (intervideosrc, "start");
 
   intervideosrc->surface = gst_inter_surface_get (intervideosrc->channel);
+  intervideosrc->have_seq = FALSE;
+  intervideosrc->n_repeats = 0;
+
+  GST_OBJECT_LOCK (intervideosrc);
+  intervideosrc->dropped = 0;
+  intervideosrc->duplicated = 0;
+  GST_OBJECT_UNLOCK (intervideosrc);
 
   return TRUE;
 }
@@ -249,21 +287,48 @@ gst_inter_video_src_create (GstBaseSrc * src, guint64 offset, guint size,
 {
   GstInterVideoSrc *intervideosrc = GST_INTER_VIDEO_SRC (src);
   GstBuffer *buffer;
+  GstClockTime time = GST_CLOCK_TIME_NONE;
+  guint seq = intervideosrc->seq;
 
   GST_DEBUG_OBJECT (intervideosrc, "create");
 
-  buffer = NULL;
+  /* the clock time of the middle of the frame we are about to output */
+  if (GST_ELEMENT_CLOCK (src) && GST_VIDEO_INFO_FPS_N (&intervideosrc->info)) {
+    time = gst_element_get_base_time (GST_ELEMENT (src)) +
+        gst_util_uint64_scale_int (GST_SECOND * (2 * intervideosrc->n_frames +
+            1), GST_VIDEO_INFO_FPS_D (&intervideosrc->info),
+        2 * GST_VIDEO_INFO_FPS_N (&intervideosrc->info));
+  }
+
+  buffer = gst_inter_surface_pick_video_frame (intervideosrc->surface, time,
+      intervideosrc->have_seq, &seq);
+
+  if (buffer) {
+    if (intervideosrc->have_seq && seq == intervideosrc->seq) {
+      intervideosrc->n_repeats++;
+    } else {
+      intervideosrc->n_repeats = 0;
+    }
+
+    GST_OBJECT_LOCK (intervideosrc);
+    if (!intervideosrc->have_seq) {
+      /* nothing to compare with */
+    } else if (seq != intervideosrc->seq) {
+      intervideosrc->dropped += seq - intervideosrc->seq - 1;
+    } else if (intervideosrc->n_repeats < MAX_REPEATS) {
+      intervideosrc->duplicated++;
+    }
+    GST_OBJECT_UNLOCK (intervideosrc);
+
+    intervideosrc->have_seq = TRUE;
+    intervideosrc->seq = seq;
 
-  g_mutex_lock (&intervideosrc->surface->mutex);
-  if (intervideosrc->surface->video_buffer) {
-    buffer = gst_buffer_ref (intervideosrc->surface->video_buffer);
-    intervideosrc->surface->video_buffer_count++;
-    if (intervideosrc->surface->video_buffer_count >= 30) {
-      gst_buffer_unref (intervideosrc->surface->video_buffer);
-      intervideosrc->surface->video_buffer = NULL;
+    if (intervideosrc->n_repeats >= MAX_REPEATS) {
+      GST_DEBUG_OBJECT (intervideosrc, "no new frame for too long");
+      gst_buffer_unref (buffer);
+      buffer = NULL;
     }
   }
-  g_mutex_unlock (&intervideosrc->surface->mutex);
 
   if (buffer == NULL) {
     GstMapInfo map;
@@ -282,6 +347,7 @@ gst_inter_video_src_create (GstBaseSrc * src, guint64 offset, guint size,
     gst_buffer_unmap (buffer, &map);
   }
 
+  /* only copies the metadata, the memory of the frame is shared */
   buffer = gst_buffer_make_writable (buffer);
 
   GST_BUFFER_PTS (buffer) =
@@ -45,6 +45,14 @@ struct _GstInterVideoSrc
 
   GstVideoInfo info;
   int n_frames;
+
+  /* last frame taken from the surface and how often it was repeated */
+  gboolean have_seq;
+  guint seq;
+  int n_repeats;
+
+  guint64 dropped;
+  guint64 duplicated;
 };
 
 struct _GstInterVideoSrcClass
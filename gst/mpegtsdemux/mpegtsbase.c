@@ -66,6 +66,7 @@ enum
 {
   PROP_0,
   PROP_PARSE_PRIVATE_SECTIONS,
+  PROP_PID_STATS,
   /* FILL ME */
 };
 
@@ -131,6 +132,11 @@ mpegts_base_class_init (MpegTSBaseClass * klass)
           "Parse private sections", FALSE,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  g_object_class_install_property (gobject_class, PROP_PID_STATS,
+      g_param_spec_boxed ("pid-stats", "PID statistics",
+          "Number of packets dropped on PIDs nobody is interested in",
+          GST_TYPE_STRUCTURE, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
 }
 
 static void
@@ -148,6 +154,30 @@ mpegts_base_set_property (GObject * object, guint prop_id,
   }
 }
 
+static GstStructure *
+mpegts_base_get_pid_stats (MpegTSBase * base)
+{
+  GstStructure *stats;
+  guint64 dropped = 0;
+  gchar name[16];
+  guint i;
+
+  stats = gst_structure_new_empty ("pid-stats");
+
+  for (i = 0; i < 0x2000; i++) {
+    guint64 drops = (guint) g_atomic_int_get (&base->pid_drops[i]);
+
+    if (drops == 0)
+      continue;
+    g_snprintf (name, sizeof (name), "pid-0x%04x", i);
+    gst_structure_set (stats, name, G_TYPE_UINT64, drops, NULL);
+    dropped += drops;
+  }
+  gst_structure_set (stats, "dropped", G_TYPE_UINT64, dropped, NULL);
+
+  return stats;
+}
+
 static void
 mpegts_base_get_property (GObject * object, guint prop_id,
     GValue * value, GParamSpec * pspec)
@@ -158,6 +188,9 @@ mpegts_base_get_property (GObject * object, guint prop_id,
     case PROP_PARSE_PRIVATE_SECTIONS:
       g_value_set_boolean (value, base->parse_private_sections);
       break;
+    case PROP_PID_STATS:
+      g_value_take_boxed (value, mpegts_base_get_pid_stats (base));
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
   }
@@ -168,6 +201,7 @@ static void
 mpegts_base_reset (MpegTSBase * base)
 {
   MpegTSBaseClass *klass = GST_MPEGTS_BASE_GET_CLASS (base);
+  guint i;
 
   mpegts_packetizer_clear (base->packetizer);
   memset (base->is_pes, 0, 1024);
@@ -193,6 +227,10 @@ mpegts_base_reset (MpegTSBase * base)
     base->pat = NULL;
   }
 
+  for (i = 0; i < 0x2000; i++)
+    g_atomic_int_set (&base->pid_drops[i], 0);
+  mpegts_base_invalidate_pid_filter (base);
+
   gst_segment_init (&base->segment, GST_FORMAT_UNDEFINED);
   base->last_seek_seqnum = (guint32) - 1;
 
@@ -229,6 +267,10 @@ mpegts_base_init (MpegTSBase * base)
   base->parse_private_sections = FALSE;
   base->is_pes = g_new0 (guint8, 1024);
   base->known_psi = g_new0 (guint8, 1024);
+  base->batch = g_slice_new0 (MpegTSPacketizerBatch);
+  base->pid_filter = g_new0 (guint8, 1024);
+  base->pid_drops = g_new0 (gint, 0x2000);
+  base->packetizer->pid_filter = base->pid_filter;
   base->program_size = sizeof (MpegTSBaseProgram);
   base->stream_size = sizeof (MpegTSBaseStream);
 
@@ -248,6 +290,9 @@ mpegts_base_dispose (GObject * object)
     base->disposed = TRUE;
     g_free (base->known_psi);
     g_free (base->is_pes);
+    g_slice_free (MpegTSPacketizerBatch, base->batch);
+    g_free (base->pid_filter);
+    g_free (base->pid_drops);
   }
 
   if (G_OBJECT_CLASS (parent_class)->dispose)
@@ -313,6 +358,47 @@ mpegts_pid_in_active_programs (MpegTSBase * base, guint16 pid)
   return lookup.res;
 }
 
+static void
+foreach_program_add_pids (gpointer key, MpegTSBaseProgram * program,
+    MpegTSBase * base)
+{
+  MpegTSBaseClass *klass = GST_MPEGTS_BASE_GET_CLASS (base);
+  GList *tmp;
+
+  if (!program->active)
+    return;
+  if (klass->program_wanted && !klass->program_wanted (base, program))
+    return;
+
+  /* This also contains the PCR PID */
+  for (tmp = program->stream_list; tmp; tmp = tmp->next)
+    MPEGTS_BIT_SET (base->pid_filter, ((MpegTSBaseStream *) tmp->data)->pid);
+}
+
+static void
+mpegts_base_update_pid_filter (MpegTSBase * base)
+{
+  g_atomic_int_set (&base->pid_filter_dirty, FALSE);
+
+  /* We always need the PSI PIDs */
+  memcpy (base->pid_filter, base->known_psi, 1024);
+
+  /* And the streams of the wanted programs if we push data */
+  if (base->push_data)
+    g_hash_table_foreach (base->programs, (GHFunc) foreach_program_add_pids,
+        base);
+
+  GST_DEBUG_OBJECT (base, "Updated PID filter");
+}
+
+/* Mark the PID filter as needing to be rebuilt. Can be called from any
+ * thread, the filter is rebuilt from the streaming thread */
+void
+mpegts_base_invalidate_pid_filter (MpegTSBase * base)
+{
+  g_atomic_int_set (&base->pid_filter_dirty, TRUE);
+}
+
 /* returns NULL if no matching descriptor found *
  * otherwise returns a descriptor that needs to *
  * be freed */
@@ -626,6 +712,8 @@ mpegts_base_deactivate_program (MpegTSBase * base, MpegTSBaseProgram * program)
   /* Inform subclasses we're deactivating this program */
   if (klass->program_stopped)
     klass->program_stopped (base, program);
+
+  mpegts_base_invalidate_pid_filter (base);
 }
 
 static void
@@ -714,6 +802,8 @@ mpegts_base_activate_program (MpegTSBase * base, MpegTSBaseProgram * program,
   if (klass->program_started != NULL)
     klass->program_started (base, program);
 
+  mpegts_base_invalidate_pid_filter (base);
+
   GST_DEBUG_OBJECT (base, "new pmt activated");
 }
 
@@ -816,6 +906,9 @@ mpegts_base_apply_pat (MpegTSBase * base, GstMpegtsSection * section)
     g_ptr_array_unref (old_pat);
   }
 
+  /* The PMT PIDs might have changed */
+  mpegts_base_invalidate_pid_filter (base);
+
   return TRUE;
 }
 
@@ -951,6 +1044,7 @@ mpegts_base_parse_atsc_mgt (MpegTSBase * base, GstMpegtsSection * section)
       MPEGTS_BIT_SET (base->known_psi, table->pid);
     }
   }
+  mpegts_base_invalidate_pid_filter (base);
 
   return TRUE;
 }
@@ -1118,6 +1212,43 @@ query_upstream_latency (MpegTSBase * base)
   base->queried_latency = TRUE;
 }
 
+static inline GstFlowReturn
+mpegts_base_handle_packet (MpegTSBase * base, MpegTSBaseClass * klass,
+    MpegTSPacketizerPacket * packet)
+{
+  GstFlowReturn res = GST_FLOW_OK;
+
+  /* If it's a known PES, push it */
+  if (MPEGTS_BIT_IS_SET (base->is_pes, packet->pid)) {
+    /* push the packet downstream */
+    if (base->push_data)
+      res = klass->push (base, packet, NULL);
+  } else if (packet->payload
+      && MPEGTS_BIT_IS_SET (base->known_psi, packet->pid)) {
+    /* base PSI data */
+    GList *others, *tmp;
+    GstMpegtsSection *section;
+
+    section =
+        mpegts_packetizer_push_section (base->packetizer, packet, &others);
+    if (section)
+      mpegts_base_handle_psi (base, section);
+    if (G_UNLIKELY (others)) {
+      for (tmp = others; tmp; tmp = tmp->next)
+        mpegts_base_handle_psi (base, (GstMpegtsSection *) tmp->data);
+      g_list_free (others);
+    }
+
+    /* we need to push section packet downstream */
+    if (base->push_section)
+      res = klass->push (base, packet, section);
+
+  } else if (packet->payload && packet->pid != 0x1fff)
+    GST_LOG ("PID 0x%04x Saw packet on a pid we don't handle", packet->pid);
+
+  return res;
+}
+
 static GstFlowReturn
 mpegts_base_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
 {
@@ -1125,13 +1256,15 @@ mpegts_base_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
   MpegTSBase *base;
   MpegTSPacketizerPacketReturn pret;
   MpegTSPacketizer2 *packetizer;
-  MpegTSPacketizerPacket packet;
+  MpegTSPacketizerBatch *batch;
   MpegTSBaseClass *klass;
+  guint i;
 
   base = GST_MPEGTS_BASE (parent);
   klass = GST_MPEGTS_BASE_GET_CLASS (base);
 
   packetizer = base->packetizer;
+  batch = base->batch;
 
   if (G_UNLIKELY (base->queried_latency == FALSE)) {
     query_upstream_latency (base);
@@ -1153,47 +1286,51 @@ mpegts_base_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
   mpegts_packetizer_push (base->packetizer, buf);
 
   while (res == GST_FLOW_OK) {
-    pret = mpegts_packetizer_next_packet (base->packetizer, &packet);
+    if (G_UNLIKELY (g_atomic_int_get (&base->pid_filter_dirty)))
+      mpegts_base_update_pid_filter (base);
+
+    pret = mpegts_packetizer_next_batch (packetizer, batch);
 
     /* If we don't have enough data, return */
     if (G_UNLIKELY (pret == PACKET_NEED_MORE))
       break;
 
-    if (G_UNLIKELY (pret == PACKET_BAD)) {
-      /* bad header, skip the packet */
-      GST_DEBUG_OBJECT (base, "bad packet, skipping");
-      goto next;
-    }
+    for (i = 0; i < batch->nb_packets;) {
+      MpegTSPacketizerPacket *packet = &batch->packets[i++];
 
-    /* If it's a known PES, push it */
-    if (MPEGTS_BIT_IS_SET (base->is_pes, packet.pid)) {
-      /* push the packet downstream */
-      if (base->push_data)
-        res = klass->push (base, &packet, NULL);
-    } else if (packet.payload
-        && MPEGTS_BIT_IS_SET (base->known_psi, packet.pid)) {
-      /* base PSI data */
-      GList *others, *tmp;
-      GstMpegtsSection *section;
-
-      section = mpegts_packetizer_push_section (packetizer, &packet, &others);
-      if (section)
-        mpegts_base_handle_psi (base, section);
-      if (G_UNLIKELY (others)) {
-        for (tmp = others; tmp; tmp = tmp->next)
-          mpegts_base_handle_psi (base, (GstMpegtsSection *) tmp->data);
-        g_list_free (others);
+      /* Handling a packet might have changed the PIDs we are interested in */
+      if (G_UNLIKELY (g_atomic_int_get (&base->pid_filter_dirty)))
+        mpegts_base_update_pid_filter (base);
+
+      if (packet->data == NULL) {
+        /* Packet was skipped by the PID filter, but the filter might have
+         * been updated since the batch was created */
+        if (G_LIKELY (!MPEGTS_BIT_IS_SET (base->pid_filter, packet->pid))) {
+          g_atomic_int_inc (&base->pid_drops[packet->pid]);
+          continue;
+        }
+        if (mpegts_packetizer_parse_filtered_packet (packetizer,
+                packet) != PACKET_OK) {
+          GST_DEBUG_OBJECT (base, "bad packet, skipping");
+          continue;
+        }
       }
 
-      /* we need to push section packet downstream */
-      if (base->push_section)
-        res = klass->push (base, &packet, section);
+      /* The offset is used to find the PCR group of the timestamps, it
+       * has to be right after the packet being handled */
+      packetizer->offset = packet->offset + packetizer->packet_size;
+      mpegts_packetizer_handle_pcr (packetizer, packet);
 
-    } else if (packet.payload && packet.pid != 0x1fff)
-      GST_LOG ("PID 0x%04x Saw packet on a pid we don't handle", packet.pid);
+      res = mpegts_base_handle_packet (base, klass, packet);
+      if (G_UNLIKELY (res != GST_FLOW_OK))
+        break;
+      /* Subclasses might flush the packetizer (ex: when rewinding to find
+       * a keyframe), in which case the remaining packets are invalid */
+      if (G_UNLIKELY (packetizer->map_data != batch->map_data))
+        break;
+    }
 
-  next:
-    mpegts_packetizer_clear_packet (base->packetizer, &packet);
+    mpegts_packetizer_clear_batch (packetizer, batch, i);
   }
 
   if (klass->input_done) {
@@ -1321,10 +1458,18 @@ mpegts_base_loop (MpegTSBase * base)
 
   switch (base->mode) {
     case BASE_MODE_SCANNING:
-      /* Find first sync point */
-      ret = mpegts_base_scan (base);
-      if (G_UNLIKELY (ret != GST_FLOW_OK))
-        goto error;
+      if (base->packetizer->index_loaded) {
+        /* The index already provides the PCR/offset observations, the
+         * packetizer finds the sync point by itself */
+        GST_DEBUG ("Index loaded, not scanning");
+        base->seek_offset = 0;
+        base->packetsize = base->packetizer->index_packet_size;
+      } else {
+        /* Find first sync point */
+        ret = mpegts_base_scan (base);
+        if (G_UNLIKELY (ret != GST_FLOW_OK))
+          goto error;
+      }
       base->mode = BASE_MODE_STREAMING;
       GST_DEBUG ("Changing to Streaming");
       break;
@@ -123,11 +123,23 @@ struct _MpegTSBase {
   GPtrArray  *pat;
   MpegTSPacketizer2 *packetizer;
 
+  /* Packets currently being handled by the chain function */
+  MpegTSPacketizerBatch *batch;
+
   /* arrays that say whether a pid is a known psi pid or a pes pid */
   /* Use MPEGTS_BIT_* to set/unset/check the values */
   guint8 *known_psi;
   guint8 *is_pes;
 
+  /* PIDs whose packets we are interested in (known PSI and PES/PCR of the
+   * wanted programs). Packets on other PIDs are dropped without being
+   * parsed. Rebuilt by the streaming thread if pid_filter_dirty is set */
+  guint8 *pid_filter;
+  gint pid_filter_dirty;
+  /* Number of packets dropped by the PID filter, per PID. Incremented by
+   * the streaming thread and read by get_property, with g_atomic_int */
+  gint *pid_drops;
+
   gboolean disposed;
 
   /* size of the MpegTSBaseProgram structure, can be overridden
@@ -174,6 +186,12 @@ struct _MpegTSBaseClass {
   /* program_stopped gets called when pat no longer has program's pmt */
   void (*program_stopped) (MpegTSBase *base, MpegTSBaseProgram *program);
 
+  /* program_wanted is called to know if the subclass is interested in the
+   * streams of an active program. If not implemented, all programs are
+   * wanted. Call mpegts_base_invalidate_pid_filter() if the result
+   * changes. */
+  gboolean (*program_wanted) (MpegTSBase *base, MpegTSBaseProgram *program);
+
   /* stream_added is called whenever a new stream has been identified */
   void (*stream_added) (MpegTSBase *base, MpegTSBaseStream *stream, MpegTSBaseProgram *program);
   /* stream_removed is called whenever a stream is no longer referenced */
@@ -224,6 +242,7 @@ G_GNUC_INTERNAL gboolean gst_mpegtsbase_plugin_init (GstPlugin * plugin);
 G_GNUC_INTERNAL void mpegts_base_program_remove_stream (MpegTSBase * base, MpegTSBaseProgram * program, guint16 pid);
 
 G_GNUC_INTERNAL void mpegts_base_remove_program(MpegTSBase *base, gint program_number);
+G_GNUC_INTERNAL void mpegts_base_invalidate_pid_filter (MpegTSBase *base);
 G_END_DECLS
 
 #endif /* GST_MPEG_TS_BASE_H */
@@ -33,6 +33,9 @@
 #define PCR_GST_MAX_VALUE (PCR_MAX_VALUE * GST_MSECOND / (PCR_MSECOND))
 #define PTS_DTS_MAX_VALUE (((guint64)1) << 33)
 
+#include <gst/base/gstbytereader.h>
+#include <gst/base/gstbytewriter.h>
+
 #include "mpegtspacketizer.h"
 #include "gstmpegdesc.h"
 
@@ -55,6 +58,7 @@ static GstClockTime calculate_skew (MpegTSPCR * pcr, guint64 pcrtime,
 static void _close_current_group (MpegTSPCR * pcrtable);
 static void record_pcr (MpegTSPacketizer2 * packetizer, MpegTSPCR * pcrtable,
     guint64 pcr, guint64 offset);
+static void mpegts_packetizer_clear_input (MpegTSPacketizer2 * packetizer);
 
 #define CONTINUITY_UNSET 255
 #define VERSION_NUMBER_UNSET 255
@@ -114,28 +118,27 @@ flush_observations (MpegTSPacketizer2 * packetizer)
         (GDestroyNotify) pcr_offset_group_free);
     if (packetizer->observations[i]->current)
       g_slice_free (PCROffsetCurrent, packetizer->observations[i]->current);
+    if (packetizer->observations[i]->index)
+      g_array_free (packetizer->observations[i]->index, TRUE);
+    if (packetizer->observations[i]->keyframes)
+      g_array_free (packetizer->observations[i]->keyframes, TRUE);
     g_free (packetizer->observations[i]);
     packetizer->observations[i] = NULL;
   }
   memset (packetizer->pcrtablelut, 0xff, 0x2000);
   packetizer->lastobsid = 0;
+  packetizer->index_loaded = FALSE;
 }
 
+#define SUBTABLE_KEY(table_id, subtable_extension) \
+  GUINT_TO_POINTER (((table_id) << 16) | (subtable_extension))
+
 static inline MpegTSPacketizerStreamSubtable *
-find_subtable (GSList * subtables, guint8 table_id, guint16 subtable_extension)
+find_subtable (GHashTable * subtables, guint8 table_id,
+    guint16 subtable_extension)
 {
-  GSList *tmp;
-
-  /* FIXME: Make this an array ! */
-  for (tmp = subtables; tmp; tmp = tmp->next) {
-    MpegTSPacketizerStreamSubtable *sub =
-        (MpegTSPacketizerStreamSubtable *) tmp->data;
-    if (sub->table_id == table_id
-        && sub->subtable_extension == subtable_extension)
-      return sub;
-  }
-
-  return FALSE;
+  return g_hash_table_lookup (subtables, SUBTABLE_KEY (table_id,
+          subtable_extension));
 }
 
 static gboolean
@@ -179,6 +182,13 @@ mpegts_packetizer_stream_subtable_new (guint8 table_id,
   return subtable;
 }
 
+static void
+mpegts_packetizer_stream_subtable_free (MpegTSPacketizerStreamSubtable *
+    subtable)
+{
+  g_free (subtable);
+}
+
 static MpegTSPacketizerStream *
 mpegts_packetizer_stream_new (guint16 pid)
 {
@@ -186,7 +196,8 @@ mpegts_packetizer_stream_new (guint16 pid)
 
   stream = (MpegTSPacketizerStream *) g_new0 (MpegTSPacketizerStream, 1);
   stream->continuity_counter = CONTINUITY_UNSET;
-  stream->subtables = NULL;
+  stream->subtables = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+      NULL, (GDestroyNotify) mpegts_packetizer_stream_subtable_free);
   stream->table_id = TABLE_ID_UNSET;
   stream->pid = pid;
   return stream;
@@ -204,22 +215,13 @@ mpegts_packetizer_clear_section (MpegTSPacketizerStream * stream)
   stream->section_data = NULL;
 }
 
-static void
-mpegts_packetizer_stream_subtable_free (MpegTSPacketizerStreamSubtable *
-    subtable)
-{
-  g_free (subtable);
-}
-
 static void
 mpegts_packetizer_stream_free (MpegTSPacketizerStream * stream)
 {
   mpegts_packetizer_clear_section (stream);
   if (stream->section_data)
     g_free (stream->section_data);
-  g_slist_foreach (stream->subtables,
-      (GFunc) mpegts_packetizer_stream_subtable_free, NULL);
-  g_slist_free (stream->subtables);
+  g_hash_table_destroy (stream->subtables);
   g_free (stream);
 }
 
@@ -252,6 +254,11 @@ mpegts_packetizer_init (MpegTSPacketizer2 * packetizer)
   packetizer->map_offset = 0;
   packetizer->need_sync = FALSE;
 
+  g_queue_init (&packetizer->input_buffers);
+  packetizer->input_skip = 0;
+  packetizer->map_buffer = NULL;
+  packetizer->map_buffer_offset = 0;
+
   memset (packetizer->pcrtablelut, 0xff, 0x2000);
   memset (packetizer->observations, 0x0, sizeof (packetizer->observations));
   packetizer->lastobsid = 0;
@@ -278,7 +285,7 @@ mpegts_packetizer_dispose (GObject * object)
       g_free (packetizer->streams);
     }
 
-    gst_adapter_clear (packetizer->adapter);
+    mpegts_packetizer_clear_input (packetizer);
     g_object_unref (packetizer->adapter);
     packetizer->disposed = TRUE;
     packetizer->offset = 0;
@@ -370,27 +377,14 @@ mpegts_packetizer_parse_adaptation_field_control (MpegTSPacketizer2 *
       afcflags & 0x02 ? "transport_private_data " : "",
       afcflags & 0x01 ? "extension " : "", afcflags == 0x00 ? "<none>" : "");
 
-  /* PCR */
+  /* PCR, only recorded once the packet is handled, see
+   * mpegts_packetizer_handle_pcr() */
   if (afcflags & MPEGTS_AFC_PCR_FLAG) {
-    MpegTSPCR *pcrtable = NULL;
     packet->pcr = mpegts_packetizer_compute_pcr (data);
     data += 6;
     GST_DEBUG ("pcr 0x%04x %" G_GUINT64_FORMAT " (%" GST_TIME_FORMAT
         ") offset:%" G_GUINT64_FORMAT, packet->pid, packet->pcr,
         GST_TIME_ARGS (PCRTIME_TO_GSTTIME (packet->pcr)), packet->offset);
-
-    PACKETIZER_GROUP_LOCK (packetizer);
-    if (packetizer->calculate_skew
-        && GST_CLOCK_TIME_IS_VALID (packetizer->last_in_time)) {
-      pcrtable = get_pcr_table (packetizer, packet->pid);
-      calculate_skew (pcrtable, packet->pcr, packetizer->last_in_time);
-    }
-    if (packetizer->calculate_offset) {
-      if (!pcrtable)
-        pcrtable = get_pcr_table (packetizer, packet->pid);
-      record_pcr (packetizer, pcrtable, packet->pcr, packet->offset);
-    }
-    PACKETIZER_GROUP_UNLOCK (packetizer);
   }
 #ifndef GST_DISABLE_GST_DEBUG
   /* OPCR */
@@ -430,6 +424,33 @@ mpegts_packetizer_parse_adaptation_field_control (MpegTSPacketizer2 *
   return TRUE;
 }
 
+/* Feeds the PCR of a packet, if any, to the skew calculation and the PCR
+ * groups. This has to happen when the packet is handled and not when it
+ * is parsed, the packets before it must have been handled with the state
+ * they had before this PCR */
+void
+mpegts_packetizer_handle_pcr (MpegTSPacketizer2 * packetizer,
+    MpegTSPacketizerPacket * packet)
+{
+  MpegTSPCR *pcrtable = NULL;
+
+  if (packet->pcr == G_MAXUINT64)
+    return;
+
+  PACKETIZER_GROUP_LOCK (packetizer);
+  if (packetizer->calculate_skew
+      && GST_CLOCK_TIME_IS_VALID (packetizer->last_in_time)) {
+    pcrtable = get_pcr_table (packetizer, packet->pid);
+    calculate_skew (pcrtable, packet->pcr, packetizer->last_in_time);
+  }
+  if (packetizer->calculate_offset) {
+    if (!pcrtable)
+      pcrtable = get_pcr_table (packetizer, packet->pid);
+    record_pcr (packetizer, pcrtable, packet->pcr, packet->offset);
+  }
+  PACKETIZER_GROUP_UNLOCK (packetizer);
+}
+
 static MpegTSPacketizerPacketReturn
 mpegts_packetizer_parse_packet (MpegTSPacketizer2 * packetizer,
     MpegTSPacketizerPacket * packet)
@@ -502,7 +523,8 @@ mpegts_packetizer_parse_section_header (MpegTSPacketizer2 * packetizer,
         stream->subtable_extension, stream->last_section_number);
     subtable->version_number = stream->version_number;
 
-    stream->subtables = g_slist_prepend (stream->subtables, subtable);
+    g_hash_table_insert (stream->subtables,
+        SUBTABLE_KEY (stream->table_id, stream->subtable_extension), subtable);
   }
 
   GST_MEMDUMP ("Full section data", stream->section_data,
@@ -557,7 +579,7 @@ mpegts_packetizer_clear (MpegTSPacketizer2 * packetizer)
     memset (packetizer->streams, 0, 8192 * sizeof (MpegTSPacketizerStream *));
   }
 
-  gst_adapter_clear (packetizer->adapter);
+  mpegts_packetizer_clear_input (packetizer);
   packetizer->offset = 0;
   packetizer->empty = TRUE;
   packetizer->need_sync = FALSE;
@@ -591,7 +613,7 @@ mpegts_packetizer_flush (MpegTSPacketizer2 * packetizer, gboolean hard)
       }
     }
   }
-  gst_adapter_clear (packetizer->adapter);
+  mpegts_packetizer_clear_input (packetizer);
 
   packetizer->offset = 0;
   packetizer->empty = TRUE;
@@ -611,9 +633,12 @@ mpegts_packetizer_flush (MpegTSPacketizer2 * packetizer, gboolean hard)
   }
   PACKETIZER_GROUP_UNLOCK (packetizer);
 
-  if (hard) {
-    /* For pull mode seeks in tsdemux the observation must be preserved */
+  /* For pull mode seeks in tsdemux the observation must be preserved, and
+   * those of an index are valid whatever the position in the stream */
+  if (hard && !packetizer->index_loaded) {
+    PACKETIZER_GROUP_LOCK (packetizer);
     flush_observations (packetizer);
+    PACKETIZER_GROUP_UNLOCK (packetizer);
   }
 }
 
@@ -650,29 +675,63 @@ mpegts_packetizer_push (MpegTSPacketizer2 * packetizer, GstBuffer * buffer)
   GST_DEBUG ("Pushing %" G_GSIZE_FORMAT " byte from offset %"
       G_GUINT64_FORMAT, gst_buffer_get_size (buffer),
       GST_BUFFER_OFFSET (buffer));
+  /* The adapter discards empty buffers */
+  if (gst_buffer_get_size (buffer) > 0)
+    g_queue_push_tail (&packetizer->input_buffers, gst_buffer_ref (buffer));
   gst_adapter_push (packetizer->adapter, buffer);
   /* If buffer timestamp is valid, store it */
   if (GST_CLOCK_TIME_IS_VALID (GST_BUFFER_TIMESTAMP (buffer)))
     packetizer->last_in_time = GST_BUFFER_TIMESTAMP (buffer);
 }
 
+static void
+mpegts_packetizer_clear_input (MpegTSPacketizer2 * packetizer)
+{
+  GstBuffer *buffer;
+
+  gst_adapter_clear (packetizer->adapter);
+
+  while ((buffer = g_queue_pop_head (&packetizer->input_buffers)))
+    gst_buffer_unref (buffer);
+  packetizer->input_skip = 0;
+  packetizer->map_buffer = NULL;
+  packetizer->map_buffer_offset = 0;
+}
+
 static void
 mpegts_packetizer_flush_bytes (MpegTSPacketizer2 * packetizer, gsize size)
 {
   if (size > 0) {
     GST_LOG ("flushing %" G_GSIZE_FORMAT " bytes from adapter", size);
     gst_adapter_flush (packetizer->adapter, size);
+
+    /* Keep track of the input buffers still in the adapter */
+    while (size > 0) {
+      GstBuffer *buffer = g_queue_peek_head (&packetizer->input_buffers);
+      gsize bsize = gst_buffer_get_size (buffer) - packetizer->input_skip;
+
+      if (size < bsize) {
+        packetizer->input_skip += size;
+        break;
+      }
+      size -= bsize;
+      packetizer->input_skip = 0;
+      gst_buffer_unref (g_queue_pop_head (&packetizer->input_buffers));
+    }
   }
 
   packetizer->map_data = NULL;
   packetizer->map_size = 0;
   packetizer->map_offset = 0;
+  packetizer->map_buffer = NULL;
+  packetizer->map_buffer_offset = 0;
 }
 
 static gboolean
 mpegts_packetizer_map (MpegTSPacketizer2 * packetizer, gsize size)
 {
-  gsize available;
+  GstBuffer *first;
+  gsize available, map_size;
 
   if (packetizer->map_size - packetizer->map_offset >= size)
     return TRUE;
@@ -683,19 +742,56 @@ mpegts_packetizer_map (MpegTSPacketizer2 * packetizer, gsize size)
   if (available < size)
     return FALSE;
 
+  /* Only map what is contained in the first input buffer, which doesn't
+   * require the adapter to merge (i.e. copy) data. If that's not enough,
+   * only merge what was requested */
+  first = g_queue_peek_head (&packetizer->input_buffers);
+  map_size = gst_buffer_get_size (first) - packetizer->input_skip;
+  if (map_size >= size) {
+    packetizer->map_buffer = first;
+    packetizer->map_buffer_offset = packetizer->input_skip;
+  } else {
+    map_size = size;
+    packetizer->merged_bytes += size;
+  }
+
   packetizer->map_data =
-      (guint8 *) gst_adapter_map (packetizer->adapter, available);
-  if (!packetizer->map_data)
+      (guint8 *) gst_adapter_map (packetizer->adapter, map_size);
+  if (!packetizer->map_data) {
+    packetizer->map_buffer = NULL;
     return FALSE;
+  }
 
-  packetizer->map_size = available;
+  packetizer->map_size = map_size;
   packetizer->map_offset = 0;
 
-  GST_LOG ("mapped %" G_GSIZE_FORMAT " bytes from adapter", available);
+  GST_LOG ("mapped %" G_GSIZE_FORMAT " bytes from adapter (%s)", map_size,
+      packetizer->map_buffer ? "in place" : "merged");
 
   return TRUE;
 }
 
+/* Returns the input buffer (borrowed) containing @data, which must point
+ * in the packets currently being handled, and sets @offset to the location
+ * of @data in that buffer.
+ * Returns NULL if @data isn't directly backed by an input buffer (i.e. the
+ * packet was straddling two input buffers). */
+GstBuffer *
+mpegts_packetizer_get_input_buffer (MpegTSPacketizer2 * packetizer,
+    const guint8 * data, gsize * offset)
+{
+  if (packetizer->map_buffer == NULL)
+    return NULL;
+
+  if (data < packetizer->map_data ||
+      data >= packetizer->map_data + packetizer->map_size)
+    return NULL;
+
+  *offset = packetizer->map_buffer_offset + (data - packetizer->map_data);
+
+  return packetizer->map_buffer;
+}
+
 static gboolean
 mpegts_try_discover_packet_size (MpegTSPacketizer2 * packetizer)
 {
@@ -745,6 +841,15 @@ out:
 
   GST_INFO ("have packetsize detected: %u bytes", packetizer->packet_size);
 
+  if (packetizer->index_loaded &&
+      packetizer->index_packet_size != packetizer->packet_size) {
+    GST_WARNING ("Index was made for %u bytes packets, not using it",
+        packetizer->index_packet_size);
+    PACKETIZER_GROUP_LOCK (packetizer);
+    flush_observations (packetizer);
+    PACKETIZER_GROUP_UNLOCK (packetizer);
+  }
+
   if (packetizer->packet_size == MPEGTS_M2TS_PACKETSIZE &&
       packetizer->map_offset >= 4)
     packetizer->map_offset -= 4;
@@ -838,7 +943,10 @@ mpegts_packetizer_next_packet (MpegTSPacketizer2 * packetizer,
       packetizer->offset += packet_size;
       GST_MEMDUMP ("data_start", packet->data_start, 16);
 
-      return mpegts_packetizer_parse_packet (packetizer, packet);
+      if (mpegts_packetizer_parse_packet (packetizer, packet) != PACKET_OK)
+        return PACKET_BAD;
+      mpegts_packetizer_handle_pcr (packetizer, packet);
+      return PACKET_OK;
     }
   }
 }
@@ -869,6 +977,156 @@ mpegts_packetizer_clear_packet (MpegTSPacketizer2 * packetizer,
   }
 }
 
+/* Parse all consecutive synchronized packets available in the current
+ * adapter mapping (up to MPEGTS_PACKETIZER_BATCH_SIZE) in one go.
+ *
+ * This avoids going through the map/flush/sync logic for each individual
+ * packet. Bad packets are skipped and not stored in the batch.
+ *
+ * Returns PACKET_NEED_MORE if there isn't a complete packet available,
+ * else PACKET_OK (the batch might contain no packets if they were all bad).
+ * The batch must then be released with mpegts_packetizer_clear_batch(). */
+MpegTSPacketizerPacketReturn
+mpegts_packetizer_next_batch (MpegTSPacketizer2 * packetizer,
+    MpegTSPacketizerBatch * batch)
+{
+  guint8 *data, *data_end;
+  guint packet_size;
+  gsize sync_offset;
+  guint64 offset;
+
+  batch->nb_packets = 0;
+  batch->map_data = NULL;
+  batch->size = 0;
+
+  packet_size = packetizer->packet_size;
+  if (G_UNLIKELY (!packet_size)) {
+    if (!mpegts_try_discover_packet_size (packetizer))
+      return PACKET_NEED_MORE;
+    packet_size = packetizer->packet_size;
+  }
+
+  /* M2TS packets don't start with the sync byte, all other variants do */
+  if (packet_size == MPEGTS_M2TS_PACKETSIZE)
+    sync_offset = 4;
+  else
+    sync_offset = 0;
+
+  /* Make sure the first packet is available and synchronized */
+  while (1) {
+    if (packetizer->need_sync) {
+      if (!mpegts_packetizer_sync (packetizer))
+        return PACKET_NEED_MORE;
+      packetizer->need_sync = FALSE;
+    }
+
+    if (!mpegts_packetizer_map (packetizer, packet_size))
+      return PACKET_NEED_MORE;
+
+    if (G_LIKELY (packetizer->map_data[packetizer->map_offset + sync_offset] ==
+            PACKET_SYNC_BYTE))
+      break;
+
+    GST_DEBUG ("lost sync");
+    packetizer->need_sync = TRUE;
+  }
+
+  batch->map_data = packetizer->map_data;
+  data = packetizer->map_data + packetizer->map_offset;
+  data_end = packetizer->map_data + packetizer->map_size;
+  offset = batch->offset = packetizer->offset;
+
+  /* Stop at the first packet which isn't synchronized, it will be handled
+   * by the sync logic on the next call */
+  while (batch->nb_packets < MPEGTS_PACKETIZER_BATCH_SIZE &&
+      data + packet_size <= data_end && data[sync_offset] == PACKET_SYNC_BYTE) {
+    MpegTSPacketizerPacket *packet = &batch->packets[batch->nb_packets];
+
+    /* ALL mpeg-ts variants contain 188 bytes of data. Those with bigger
+     * packet sizes contain either extra data (timesync, FEC, ..) either
+     * before or after the data */
+    packet->data_start = data + sync_offset;
+    packet->data_end = packet->data_start + 188;
+    packet->offset = offset;
+
+    if (packetizer->pid_filter) {
+      /* PID 13 */
+      packet->pid = GST_READ_UINT16_BE (packet->data_start + 1) & 0x1FFF;
+      if (!MPEGTS_BIT_IS_SET (packetizer->pid_filter, packet->pid)) {
+        /* Not interested, don't parse any further */
+        packet->data = NULL;
+        packet->payload = NULL;
+        batch->nb_packets++;
+        data += packet_size;
+        offset += packet_size;
+        continue;
+      }
+    }
+
+    if (G_LIKELY (mpegts_packetizer_parse_packet (packetizer,
+                packet) == PACKET_OK))
+      batch->nb_packets++;
+    else
+      GST_DEBUG ("bad packet at offset %" G_GUINT64_FORMAT ", skipping",
+          offset);
+
+    data += packet_size;
+    offset += packet_size;
+  }
+
+  batch->size = data - (packetizer->map_data + packetizer->map_offset);
+
+  GST_LOG ("batch of %u packets (%" G_GSIZE_FORMAT " bytes)",
+      batch->nb_packets, batch->size);
+
+  return PACKET_OK;
+}
+
+/* Parse a packet from a batch which was skipped because of the pid_filter */
+MpegTSPacketizerPacketReturn
+mpegts_packetizer_parse_filtered_packet (MpegTSPacketizer2 * packetizer,
+    MpegTSPacketizerPacket * packet)
+{
+  g_return_val_if_fail (packet->data == NULL, PACKET_OK);
+
+  return mpegts_packetizer_parse_packet (packetizer, packet);
+}
+
+/* Release the first @nb_handled packets of @batch. If not all packets were
+ * handled, the remaining ones will be returned again by the next call to
+ * mpegts_packetizer_next_batch() */
+void
+mpegts_packetizer_clear_batch (MpegTSPacketizer2 * packetizer,
+    MpegTSPacketizerBatch * batch, guint nb_handled)
+{
+  gsize size = batch->size;
+
+  /* The packetizer might have been flushed while the batch was handled */
+  if (packetizer->map_data && packetizer->map_data == batch->map_data) {
+    if (nb_handled < batch->nb_packets) {
+      MpegTSPacketizerPacket *next = &batch->packets[nb_handled];
+
+      size = next->offset - batch->packets[0].offset;
+      /* Account for bad packets skipped before the first one */
+      size += batch->packets[0].data_start - packetizer->map_data -
+          packetizer->map_offset;
+      if (packetizer->packet_size == MPEGTS_M2TS_PACKETSIZE)
+        size -= 4;
+      packetizer->offset = next->offset;
+    } else {
+      packetizer->offset = batch->offset + size;
+    }
+
+    packetizer->map_offset += size;
+    if (packetizer->map_size - packetizer->map_offset < packetizer->packet_size)
+      mpegts_packetizer_flush_bytes (packetizer, packetizer->map_offset);
+  }
+
+  batch->nb_packets = 0;
+  batch->map_data = NULL;
+  batch->size = 0;
+}
+
 gboolean
 mpegts_packetizer_has_packets (MpegTSPacketizer2 * packetizer)
 {
@@ -2267,6 +2525,69 @@ mpegts_packetizer_pts_to_ts (MpegTSPacketizer2 * packetizer,
   return res;
 }
 
+/* Returns the position of the last index entry whose pcr (or offset if
+ * @by_offset is TRUE) is lower or equal to @value, or -1 if there is none */
+static gint
+_index_find (GArray * index, guint64 value, gboolean by_offset)
+{
+  guint lo = 0, hi = index->len;
+
+  while (lo < hi) {
+    guint mid = (lo + hi) / 2;
+    PCROffsetIndexEntry *entry =
+        &g_array_index (index, PCROffsetIndexEntry, mid);
+
+    if ((by_offset ? entry->offset : entry->pcr) <= value)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+
+  return (gint) lo - 1;
+}
+
+/* Interpolates the offset of @pcr between the surrounding index entries.
+ * The index must contain at least 2 entries */
+static guint64
+_index_pcr_to_offset (GArray * index, guint64 pcr)
+{
+  PCROffsetIndexEntry *prev, *next;
+  gint i;
+
+  i = CLAMP (_index_find (index, pcr, FALSE), 0, (gint) index->len - 2);
+  prev = &g_array_index (index, PCROffsetIndexEntry, i);
+  next = prev + 1;
+
+  if (pcr <= prev->pcr || next->pcr == prev->pcr)
+    return prev->offset;
+  if (pcr >= next->pcr)
+    return next->offset;
+
+  return prev->offset + gst_util_uint64_scale (pcr - prev->pcr,
+      next->offset - prev->offset, next->pcr - prev->pcr);
+}
+
+/* Interpolates the PCR of @offset between the surrounding index entries.
+ * The index must contain at least 2 entries */
+static guint64
+_index_offset_to_pcr (GArray * index, guint64 offset)
+{
+  PCROffsetIndexEntry *prev, *next;
+  gint i;
+
+  i = CLAMP (_index_find (index, offset, TRUE), 0, (gint) index->len - 2);
+  prev = &g_array_index (index, PCROffsetIndexEntry, i);
+  next = prev + 1;
+
+  if (offset <= prev->offset || next->offset == prev->offset)
+    return prev->pcr;
+  if (offset >= next->offset)
+    return next->pcr;
+
+  return prev->pcr + gst_util_uint64_scale (offset - prev->offset,
+      next->pcr - prev->pcr, next->offset - prev->offset);
+}
+
 /* Stream time to offset */
 guint64
 mpegts_packetizer_ts_to_offset (MpegTSPacketizer2 * packetizer,
@@ -2294,6 +2615,18 @@ mpegts_packetizer_ts_to_offset (MpegTSPacketizer2 * packetizer,
 
   GST_DEBUG ("Searching offset for ts %" GST_TIME_FORMAT, GST_TIME_ARGS (ts));
 
+  /* If we have got an index covering that position, use it */
+  if (pcrtable->index && pcrtable->index->len > 1 &&
+      querypcr <= g_array_index (pcrtable->index, PCROffsetIndexEntry,
+          pcrtable->index->len - 1).pcr) {
+    res = _index_pcr_to_offset (pcrtable->index, querypcr);
+    PACKETIZER_GROUP_UNLOCK (packetizer);
+
+    GST_DEBUG ("Returning offset %" G_GUINT64_FORMAT " for ts %"
+        GST_TIME_FORMAT " from index", res, GST_TIME_ARGS (ts));
+    return res;
+  }
+
   /* First check if we're within the current pending group */
   current = pcrtable->current;
   if (current && current->group && (querypcr >= current->group->pcr_offset) &&
@@ -2459,3 +2792,332 @@ mpegts_packetizer_set_current_pcr_offset (MpegTSPacketizer2 * packetizer,
   }
   PACKETIZER_GROUP_UNLOCK (packetizer);
 }
+
+/* Index files
+ *
+ * The PCR/offset observations (and keyframe offsets) of all PCR PIDs can
+ * be saved to a file, and restored from it later on in order to seek in
+ * the same stream without having to bisect it first. All values are
+ * big-endian:
+ *
+ *   "TSIX" | version (u32) | packet size (u16) | number of tables (u16)
+ *   For each table:
+ *     pid (u16) | number of groups (u32) | number of keyframes (u32)
+ *     For each group:
+ *       flags (u32) | first_pcr (u64) | first_offset (u64) |
+ *       pcr_offset (u64) | number of values (u32) |
+ *       values (u32 pcr, u32 offset)...
+ *     keyframe offsets (u64)...
+ *
+ * Since each group stores its pcr_offset, PCR wraparounds and resets
+ * detected while the observations were collected are preserved.
+ */
+#define INDEX_MAGIC "TSIX"
+#define INDEX_VERSION 1
+
+/* Returns the position of the first keyframe offset greater or equal to
+ * @offset */
+static guint
+_keyframes_find (GArray * keyframes, guint64 offset)
+{
+  guint lo = 0, hi = keyframes->len;
+
+  while (lo < hi) {
+    guint mid = (lo + hi) / 2;
+
+    if (g_array_index (keyframes, guint64, mid) < offset)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+
+  return lo;
+}
+
+/* Record that the PES packet starting at @offset contains a keyframe */
+void
+mpegts_packetizer_add_keyframe (MpegTSPacketizer2 * packetizer,
+    guint64 offset, guint16 pcr_pid)
+{
+  MpegTSPCR *pcrtable;
+  guint pos;
+
+  PACKETIZER_GROUP_LOCK (packetizer);
+  pcrtable = get_pcr_table (packetizer, pcr_pid);
+
+  if (pcrtable->keyframes == NULL)
+    pcrtable->keyframes = g_array_new (FALSE, FALSE, sizeof (guint64));
+
+  pos = _keyframes_find (pcrtable->keyframes, offset);
+  if (pos == pcrtable->keyframes->len ||
+      g_array_index (pcrtable->keyframes, guint64, pos) != offset) {
+    GST_LOG ("Keyframe at offset %" G_GUINT64_FORMAT, offset);
+    g_array_insert_val (pcrtable->keyframes, pos, offset);
+  }
+
+  PACKETIZER_GROUP_UNLOCK (packetizer);
+}
+
+/* Returns the offset of the last known keyframe at or before stream time
+ * @ts, or -1 if there is none. Only available with a loaded index, and
+ * within the range it covers, the caller has to scan elsewhere */
+guint64
+mpegts_packetizer_get_keyframe_offset (MpegTSPacketizer2 * packetizer,
+    GstClockTime ts, guint16 pcr_pid)
+{
+  MpegTSPCR *pcrtable;
+  GArray *keyframes;
+  PCROffsetIndexEntry *first, *last;
+  guint64 querypcr, res = -1;
+  guint lo, hi;
+
+  PACKETIZER_GROUP_LOCK (packetizer);
+  pcrtable = get_pcr_table (packetizer, pcr_pid);
+  keyframes = pcrtable->keyframes;
+
+  if (pcrtable->index == NULL || pcrtable->index->len < 2 ||
+      keyframes == NULL)
+    goto done;
+
+  /* Like mpegts_packetizer_ts_to_offset(), only trust the index where it
+   * has observations */
+  querypcr = GSTTIME_TO_PCRTIME (ts);
+  first = &g_array_index (pcrtable->index, PCROffsetIndexEntry, 0);
+  last = &g_array_index (pcrtable->index, PCROffsetIndexEntry,
+      pcrtable->index->len - 1);
+  if (querypcr < first->pcr || querypcr > last->pcr) {
+    GST_DEBUG ("ts %" GST_TIME_FORMAT " is outside of the index",
+        GST_TIME_ARGS (ts));
+    goto done;
+  }
+
+  /* Keyframe offsets and their PCR are both increasing. The keyframes
+   * recorded past the end of the index can't be converted to a PCR */
+  lo = 0;
+  hi = _keyframes_find (keyframes, last->offset + 1);
+  while (lo < hi) {
+    guint mid = (lo + hi) / 2;
+
+    if (_index_offset_to_pcr (pcrtable->index,
+            g_array_index (keyframes, guint64, mid)) <= querypcr)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  if (lo > 0)
+    res = g_array_index (keyframes, guint64, lo - 1);
+
+done:
+  PACKETIZER_GROUP_UNLOCK (packetizer);
+
+  GST_DEBUG ("Keyframe offset for ts %" GST_TIME_FORMAT " : %"
+      G_GUINT64_FORMAT, GST_TIME_ARGS (ts), res);
+
+  return res;
+}
+
+gboolean
+mpegts_packetizer_save_index (MpegTSPacketizer2 * packetizer,
+    const gchar * location, GError ** error)
+{
+  GstByteWriter writer;
+  guint8 *data;
+  gsize size;
+  gboolean res;
+  guint i;
+
+  gst_byte_writer_init (&writer);
+  gst_byte_writer_put_data (&writer, (const guint8 *) INDEX_MAGIC, 4);
+  gst_byte_writer_put_uint32_be (&writer, INDEX_VERSION);
+  gst_byte_writer_put_uint16_be (&writer, packetizer->packet_size);
+
+  PACKETIZER_GROUP_LOCK (packetizer);
+  gst_byte_writer_put_uint16_be (&writer, packetizer->lastobsid);
+
+  for (i = 0; i < packetizer->lastobsid; i++) {
+    MpegTSPCR *pcrtable = packetizer->observations[i];
+    GList *tmp;
+    guint j;
+
+    /* Store pending observations in their group, and make sure all groups
+     * have got their best pcr_offset estimation */
+    _close_current_group (pcrtable);
+    if (pcrtable->groups)
+      _reevaluate_group_pcr_offset (pcrtable,
+          g_list_last (pcrtable->groups)->data);
+
+    gst_byte_writer_put_uint16_be (&writer, pcrtable->pid);
+    gst_byte_writer_put_uint32_be (&writer, g_list_length (pcrtable->groups));
+    gst_byte_writer_put_uint32_be (&writer,
+        pcrtable->keyframes ? pcrtable->keyframes->len : 0);
+
+    for (tmp = pcrtable->groups; tmp; tmp = tmp->next) {
+      PCROffsetGroup *group = tmp->data;
+
+      gst_byte_writer_put_uint32_be (&writer, group->flags);
+      gst_byte_writer_put_uint64_be (&writer, group->first_pcr);
+      gst_byte_writer_put_uint64_be (&writer, group->first_offset);
+      gst_byte_writer_put_uint64_be (&writer, group->pcr_offset);
+      gst_byte_writer_put_uint32_be (&writer, group->last_value + 1);
+      for (j = 0; j <= group->last_value; j++) {
+        gst_byte_writer_put_uint32_be (&writer, group->values[j].pcr);
+        gst_byte_writer_put_uint32_be (&writer, group->values[j].offset);
+      }
+    }
+
+    if (pcrtable->keyframes) {
+      for (j = 0; j < pcrtable->keyframes->len; j++)
+        gst_byte_writer_put_uint64_be (&writer,
+            g_array_index (pcrtable->keyframes, guint64, j));
+    }
+  }
+  PACKETIZER_GROUP_UNLOCK (packetizer);
+
+  size = gst_byte_writer_get_size (&writer);
+  data = gst_byte_writer_reset_and_get_data (&writer);
+
+  res = g_file_set_contents (location, (const gchar *) data, size, error);
+  g_free (data);
+
+  if (res) {
+    GST_INFO ("Saved index of %" G_GSIZE_FORMAT " bytes to %s", size,
+        location);
+    /* The observations now match the index */
+    packetizer->index_loaded = TRUE;
+    packetizer->index_packet_size = packetizer->packet_size;
+  }
+
+  return res;
+}
+
+/* Replaces all PCR/offset observations with the ones from the index stored
+ * in @location */
+gboolean
+mpegts_packetizer_load_index (MpegTSPacketizer2 * packetizer,
+    const gchar * location, GError ** error)
+{
+  GstByteReader reader;
+  gchar *contents;
+  gsize length;
+  guint32 version;
+  guint16 packet_size, nb_tables;
+  guint i;
+
+  if (!g_file_get_contents (location, &contents, &length, error))
+    return FALSE;
+
+  gst_byte_reader_init (&reader, (const guint8 *) contents, length);
+  if (length < 12 || memcmp (contents, INDEX_MAGIC, 4))
+    goto invalid;
+  gst_byte_reader_skip_unchecked (&reader, 4);
+  version = gst_byte_reader_get_uint32_be_unchecked (&reader);
+  packet_size = gst_byte_reader_get_uint16_be_unchecked (&reader);
+  nb_tables = gst_byte_reader_get_uint16_be_unchecked (&reader);
+  if (version != INDEX_VERSION || nb_tables > MAX_PCR_OBS_CHANNELS)
+    goto invalid;
+  /* The packet size is only known once the stream is being parsed, it is
+   * checked again when detected */
+  if (packet_size != MPEGTS_NORMAL_PACKETSIZE &&
+      packet_size != MPEGTS_M2TS_PACKETSIZE &&
+      packet_size != MPEGTS_DVB_ASI_PACKETSIZE &&
+      packet_size != MPEGTS_ATSC_PACKETSIZE)
+    goto invalid;
+  if (packetizer->packet_size && packet_size != packetizer->packet_size)
+    goto invalid;
+
+  PACKETIZER_GROUP_LOCK (packetizer);
+  flush_observations (packetizer);
+
+  for (i = 0; i < nb_tables; i++) {
+    MpegTSPCR *pcrtable;
+    guint16 pid;
+    guint32 nb_groups, nb_keyframes, j, k;
+
+    if (!gst_byte_reader_get_uint16_be (&reader, &pid) ||
+        !gst_byte_reader_get_uint32_be (&reader, &nb_groups) ||
+        !gst_byte_reader_get_uint32_be (&reader, &nb_keyframes))
+      goto corrupted;
+
+    pcrtable = get_pcr_table (packetizer, pid & 0x1fff);
+    if (pcrtable->index)
+      goto corrupted;
+    pcrtable->index = g_array_new (FALSE, FALSE, sizeof (PCROffsetIndexEntry));
+
+    for (j = 0; j < nb_groups; j++) {
+      PCROffsetGroup *group;
+      guint32 flags, nb_values;
+      guint64 first_pcr, first_offset, pcr_offset;
+
+      if (!gst_byte_reader_get_uint32_be (&reader, &flags) ||
+          !gst_byte_reader_get_uint64_be (&reader, &first_pcr) ||
+          !gst_byte_reader_get_uint64_be (&reader, &first_offset) ||
+          !gst_byte_reader_get_uint64_be (&reader, &pcr_offset) ||
+          !gst_byte_reader_get_uint32_be (&reader, &nb_values))
+        goto corrupted;
+      if (nb_values == 0 ||
+          gst_byte_reader_get_remaining (&reader) / 8 < nb_values)
+        goto corrupted;
+
+      group = _new_group (first_pcr, first_offset, pcr_offset, flags);
+      g_free (group->values);
+      group->nb_allocated = nb_values + DEFAULT_ALLOCATED_OFFSET;
+      group->values = g_new0 (PCROffset, group->nb_allocated);
+      group->last_value = nb_values - 1;
+
+      for (k = 0; k < nb_values; k++) {
+        PCROffsetIndexEntry entry;
+
+        group->values[k].pcr =
+            gst_byte_reader_get_uint32_be_unchecked (&reader);
+        group->values[k].offset =
+            gst_byte_reader_get_uint32_be_unchecked (&reader);
+
+        /* Only keep increasing entries for lookups */
+        entry.pcr = pcr_offset + group->values[k].pcr;
+        entry.offset = first_offset + group->values[k].offset;
+        if (pcrtable->index->len == 0 ||
+            (entry.pcr > g_array_index (pcrtable->index, PCROffsetIndexEntry,
+                    pcrtable->index->len - 1).pcr &&
+                entry.offset > g_array_index (pcrtable->index,
+                    PCROffsetIndexEntry, pcrtable->index->len - 1).offset))
+          g_array_append_val (pcrtable->index, entry);
+      }
+
+      pcrtable->groups = g_list_prepend (pcrtable->groups, group);
+    }
+    pcrtable->groups = g_list_reverse (pcrtable->groups);
+
+    if (gst_byte_reader_get_remaining (&reader) / 8 < nb_keyframes)
+      goto corrupted;
+    pcrtable->keyframes =
+        g_array_sized_new (FALSE, FALSE, sizeof (guint64), nb_keyframes);
+    for (j = 0; j < nb_keyframes; j++) {
+      guint64 offset = gst_byte_reader_get_uint64_be_unchecked (&reader);
+
+      if (j && offset <= g_array_index (pcrtable->keyframes, guint64, j - 1))
+        goto corrupted;
+      g_array_append_val (pcrtable->keyframes, offset);
+    }
+
+    GST_DEBUG ("PCR PID 0x%04x: %u groups, %u index entries, %u keyframes",
+        pid, nb_groups, pcrtable->index->len, nb_keyframes);
+  }
+  packetizer->index_loaded = TRUE;
+  packetizer->index_packet_size = packet_size;
+  PACKETIZER_GROUP_UNLOCK (packetizer);
+
+  GST_INFO ("Loaded index from %s (packet size %u, %u PCR PIDs)", location,
+      packet_size, nb_tables);
+
+  g_free (contents);
+  return TRUE;
+
+corrupted:
+  flush_observations (packetizer);
+  PACKETIZER_GROUP_UNLOCK (packetizer);
+invalid:
+  g_set_error (error, G_FILE_ERROR, G_FILE_ERROR_INVAL,
+      "%s is not a valid index file", location);
+  g_free (contents);
+  return FALSE;
+}
@@ -85,7 +85,10 @@ typedef struct
   guint8  section_number;
   guint8  last_section_number;
 
-  GSList *subtables;
+  /* Subtables seen on this PID (MpegTSPacketizerStreamSubtable), indexed
+   * by table_id and subtable_extension. EIT schedules can have hundreds of
+   * them on a single PID */
+  GHashTable *subtables;
 
   /* Upstream offset of the data contained in the section */
   guint64 offset;
@@ -211,6 +214,15 @@ typedef struct _PCROffsetCurrent
   guint64 prev_bitrate;
 } PCROffsetCurrent;
 
+/* PCROffsetIndexEntry: Absolute PCR (i.e. including the group pcr_offset)
+ * and offset of an observation, used for lookups in an index loaded with
+ * mpegts_packetizer_load_index() */
+typedef struct _PCROffsetIndexEntry
+{
+  guint64 pcr;
+  guint64 offset;
+} PCROffsetIndexEntry;
+
 typedef struct _MpegTSPCR
 {
   guint16 pid;
@@ -239,6 +251,13 @@ typedef struct _MpegTSPCR
 
   /* Current PCR/offset observations (used to update pcroffsets) */
   PCROffsetCurrent *current;
+
+  /* Sorted array of PCROffsetIndexEntry covering all groups, only present
+   * if the observations were loaded from an index */
+  GArray *index;
+
+  /* Sorted offsets of PES packets starting with a keyframe (guint64) */
+  GArray *keyframes;
 } MpegTSPCR;
 
 struct _MpegTSPacketizer2 {
@@ -269,6 +288,17 @@ struct _MpegTSPacketizer2 {
   gsize map_size;
   gboolean need_sync;
 
+  /* The buffers currently contained in the adapter, and the number of
+   * bytes already flushed from the first one */
+  GQueue input_buffers;
+  gsize input_skip;
+  /* The input buffer (and offset in it) map_data points to, or NULL if
+   * the mapped data was merged from several input buffers */
+  GstBuffer *map_buffer;
+  gsize map_buffer_offset;
+  /* Number of bytes the adapter had to merge from several input buffers */
+  guint64 merged_bytes;
+
   /* Reference offset */
   guint64 refoffset;
 
@@ -278,6 +308,16 @@ struct _MpegTSPacketizer2 {
   /* Last inputted timestamp */
   GstClockTime last_in_time;
 
+  /* Optional bitmap of PIDs to parse in mpegts_packetizer_next_batch()
+   * (use MPEGTS_BIT_* macros). Not owned by the packetizer. */
+  const guint8 *pid_filter;
+
+  /* Whether the observations come from (or were saved to) an index, in
+   * which case they are kept through hard flushes, and the packet size of
+   * the stream the index was made for */
+  gboolean index_loaded;
+  guint16 index_packet_size;
+
   /* offset to observations table */
   guint8 pcrtablelut[0x2000];
   MpegTSPCR *observations[MAX_PCR_OBS_CHANNELS];
@@ -309,6 +349,37 @@ typedef struct
   guint64 offset;
 } MpegTSPacketizerPacket;
 
+/* Maximum number of packets handed out by mpegts_packetizer_next_batch() */
+#define MPEGTS_PACKETIZER_BATCH_SIZE 128
+
+/* MpegTSPacketizerBatch: A run of consecutive packets, parsed in one go
+ * from the currently mapped adapter data.
+ * The packets are only valid until mpegts_packetizer_clear_batch() is
+ * called or the packetizer is flushed.
+ *
+ * If a pid_filter is set on the packetizer, packets on PIDs which aren't
+ * in the filter are not parsed: only their pid, offset and data_start are
+ * set, and data is NULL. They can still be parsed afterwards with
+ * mpegts_packetizer_parse_filtered_packet().
+ *
+ * The offset of the packetizer is not moved past the batch until it is
+ * cleared, users have to set it past each packet they handle and call
+ * mpegts_packetizer_handle_pcr() on it, as mpegts_packetizer_next_packet()
+ * would have. */
+typedef struct
+{
+  MpegTSPacketizerPacket packets[MPEGTS_PACKETIZER_BATCH_SIZE];
+  /* Number of valid entries in packets[] (bad packets are skipped) */
+  guint nb_packets;
+
+  /* The mapped data the packets point to */
+  guint8 *map_data;
+  /* Number of bytes covered by the batch (including skipped packets) */
+  gsize size;
+  /* Offset of the first byte covered by the batch */
+  guint64 offset;
+} MpegTSPacketizerBatch;
+
 typedef struct
 {
   guint8 table_id;
@@ -347,8 +418,21 @@ G_GNUC_INTERNAL MpegTSPacketizerPacketReturn
 mpegts_packetizer_process_next_packet(MpegTSPacketizer2 * packetizer);
 G_GNUC_INTERNAL void mpegts_packetizer_clear_packet (MpegTSPacketizer2 *packetizer,
 				     MpegTSPacketizerPacket *packet);
+G_GNUC_INTERNAL MpegTSPacketizerPacketReturn
+mpegts_packetizer_next_batch (MpegTSPacketizer2 *packetizer,
+			      MpegTSPacketizerBatch *batch);
+G_GNUC_INTERNAL MpegTSPacketizerPacketReturn
+mpegts_packetizer_parse_filtered_packet (MpegTSPacketizer2 *packetizer,
+					 MpegTSPacketizerPacket *packet);
+G_GNUC_INTERNAL void mpegts_packetizer_handle_pcr (MpegTSPacketizer2 *packetizer,
+				     MpegTSPacketizerPacket *packet);
+G_GNUC_INTERNAL void mpegts_packetizer_clear_batch (MpegTSPacketizer2 *packetizer,
+				     MpegTSPacketizerBatch *batch, guint nb_handled);
 G_GNUC_INTERNAL void mpegts_packetizer_remove_stream(MpegTSPacketizer2 *packetizer,
   gint16 pid);
+G_GNUC_INTERNAL GstBuffer *
+mpegts_packetizer_get_input_buffer (MpegTSPacketizer2 *packetizer,
+				    const guint8 *data, gsize *offset);
 
 G_GNUC_INTERNAL GstMpegtsSection *mpegts_packetizer_push_section (MpegTSPacketizer2 *packetzer,
 								  MpegTSPacketizerPacket *packet, GList **remaining);
@@ -371,6 +455,18 @@ mpegts_packetizer_set_current_pcr_offset (MpegTSPacketizer2 * packetizer,
 G_GNUC_INTERNAL void
 mpegts_packetizer_set_reference_offset (MpegTSPacketizer2 * packetizer,
 					guint64 refoffset);
+G_GNUC_INTERNAL void
+mpegts_packetizer_add_keyframe (MpegTSPacketizer2 * packetizer,
+				guint64 offset, guint16 pcr_pid);
+G_GNUC_INTERNAL guint64
+mpegts_packetizer_get_keyframe_offset (MpegTSPacketizer2 * packetizer,
+				       GstClockTime ts, guint16 pcr_pid);
+G_GNUC_INTERNAL gboolean
+mpegts_packetizer_save_index (MpegTSPacketizer2 * packetizer,
+			      const gchar * location, GError ** error);
+G_GNUC_INTERNAL gboolean
+mpegts_packetizer_load_index (MpegTSPacketizer2 * packetizer,
+			      const gchar * location, GError ** error);
 G_END_DECLS
 
 #endif /* GST_MPEGTS_PACKETIZER_H */
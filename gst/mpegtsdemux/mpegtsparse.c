@@ -317,6 +317,7 @@ mpegts_parse_pad_removed (GstElement * element, GstPad * pad)
   if (parse->srcpads == NULL) {
     base->push_data = FALSE;
     base->push_section = FALSE;
+    mpegts_base_invalidate_pid_filter (base);
   }
 
   if (GST_ELEMENT_CLASS (parent_class)->pad_removed)
@@ -362,6 +363,7 @@ mpegts_parse_request_new_pad (GstElement * element, GstPadTemplate * template,
   parse->srcpads = g_list_append (parse->srcpads, pad);
   base->push_data = TRUE;
   base->push_section = TRUE;
+  mpegts_base_invalidate_pid_filter (base);
 
   gst_pad_set_active (pad, TRUE);
 
@@ -111,7 +111,16 @@ typedef struct
   guint64 pts, dts;
 } PendingBuffer;
 
+/* A range of an input buffer containing PES data */
+typedef struct
+{
+  GstBuffer *buffer;
+  gsize offset;
+  gsize size;
+} PESSlice;
+
 typedef struct _TSDemuxStream TSDemuxStream;
+typedef struct _TSDemuxProgram TSDemuxProgram;
 
 typedef struct _TSDemuxH264ParsingInfos TSDemuxH264ParsingInfos;
 
@@ -135,10 +144,27 @@ struct _TSDemuxH264ParsingInfos
   SimpleBuffer framedata;
 };
 
+struct _TSDemuxProgram
+{
+  MpegTSBaseProgram program;
+
+  /* segments to be sent */
+  GstSegment segment;
+  GstEvent *segment_event;
+
+  /* Set when program change */
+  gboolean calculate_update_segment;
+  /* update segment is */
+  GstEvent *update_segment;
+};
+
 struct _TSDemuxStream
 {
   MpegTSBaseStream stream;
 
+  /* The program this stream belongs to */
+  TSDemuxProgram *program;
+
   GstPad *pad;
 
   /* Whether the pad was added or not */
@@ -153,6 +179,11 @@ struct _TSDemuxStream
   /* Data being reconstructed (allocated) */
   guint8 *data;
 
+  /* As long as possible, the data being reconstructed is referenced from
+   * the input buffers instead of being copied into ->data (PESSlice). That
+   * is, as long as the output buffer can hold one memory per slice */
+  GArray *slices;
+
   /* Size of data being reconstructed (if known, else 0) */
   guint expected_size;
 
@@ -190,6 +221,11 @@ struct _TSDemuxStream
 
   GstClockTime seeked_pts, seeked_dts;
 
+  /* Offset of the first packet of the current PES */
+  guint64 pes_offset;
+  /* Offset of the PES in which the scan function found a keyframe (or -1) */
+  guint64 keyframe_offset;
+
   GstTsDemuxKeyFrameScanFunction scan_function;
   TSDemuxH264ParsingInfos h264infos;
 };
@@ -260,7 +296,9 @@ enum
 {
   ARG_0,
   PROP_PROGRAM_NUMBER,
+  PROP_PROGRAM_NUMBERS,
   PROP_EMIT_STATS,
+  PROP_INDEX_LOCATION,
   /* FILL ME */
 };
 
@@ -272,6 +310,8 @@ static void
 gst_ts_demux_program_started (MpegTSBase * base, MpegTSBaseProgram * program);
 static void
 gst_ts_demux_program_stopped (MpegTSBase * base, MpegTSBaseProgram * program);
+static gboolean
+gst_ts_demux_program_wanted (MpegTSBase * base, MpegTSBaseProgram * program);
 static void gst_ts_demux_reset (MpegTSBase * base);
 static GstFlowReturn
 gst_ts_demux_push (MpegTSBase * base, MpegTSPacketizerPacket * packet,
@@ -289,8 +329,16 @@ static void gst_ts_demux_set_property (GObject * object, guint prop_id,
 static void gst_ts_demux_get_property (GObject * object, guint prop_id,
     GValue * value, GParamSpec * pspec);
 static void gst_ts_demux_flush_streams (GstTSDemux * tsdemux);
+static void gst_ts_demux_set_program_numbers (GstTSDemux * demux,
+    const gchar * str);
+static gchar *gst_ts_demux_get_program_numbers (GstTSDemux * demux);
 static GstFlowReturn
 gst_ts_demux_push_pending_data (GstTSDemux * demux, TSDemuxStream * stream);
+static void gst_ts_demux_stream_clear_data (TSDemuxStream * stream);
+static void gst_ts_demux_stream_merge_slices (GstTSDemux * demux,
+    TSDemuxStream * stream, guint extra);
+static GstBuffer *gst_ts_demux_stream_take_buffer (GstTSDemux * demux,
+    TSDemuxStream * stream);
 static void gst_ts_demux_stream_flush (TSDemuxStream * stream,
     GstTSDemux * demux);
 
@@ -319,6 +367,14 @@ gst_ts_demux_dispose (GObject * object)
 
   gst_flow_combiner_free (demux->flowcombiner);
 
+  g_free (demux->index_location);
+  demux->index_location = NULL;
+
+  if (demux->program_numbers) {
+    g_array_free (demux->program_numbers, TRUE);
+    demux->program_numbers = NULL;
+  }
+
   GST_CALL_PARENT (G_OBJECT_CLASS, dispose, (object));
 }
 
@@ -339,11 +395,38 @@ gst_ts_demux_class_init (GstTSDemuxClass * klass)
           "Program Number to demux for (-1 to ignore)", -1, G_MAXINT,
           -1, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstTSDemux:program-numbers:
+   *
+   * Comma-separated list of program numbers to demux at once, or "all".
+   * Pads are exposed for the streams of all those programs (named after
+   * both the program number and the PID), which each get their own segment
+   * and PCR handling. Takes precedence over #GstTSDemux:program-number.
+   */
+  g_object_class_install_property (gobject_class, PROP_PROGRAM_NUMBERS,
+      g_param_spec_string ("program-numbers", "Program numbers",
+          "Comma-separated list of program numbers to demux in a single pass, "
+          "or \"all\" (NULL to only demux one program)", NULL,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   g_object_class_install_property (gobject_class, PROP_EMIT_STATS,
       g_param_spec_boolean ("emit-stats", "Emit statistics",
           "Emit messages for every pcr/opcr/pts/dts", FALSE,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstTSDemux:index-location:
+   *
+   * Location of a file storing the PCR/offset index of the stream. If the
+   * file is a valid index, it is loaded and used for seeking without having
+   * to scan the stream. Else the index is built while demuxing and written
+   * to that location when reaching EOS.
+   */
+  g_object_class_install_property (gobject_class, PROP_INDEX_LOCATION,
+      g_param_spec_string ("index-location", "Index location",
+          "Location of the PCR/offset index file to use or create", NULL,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   element_class = GST_ELEMENT_CLASS (klass);
   gst_element_class_add_pad_template (element_class,
       gst_static_pad_template_get (&video_template));
@@ -367,6 +450,7 @@ gst_ts_demux_class_init (GstTSDemuxClass * klass)
   ts_class->push_event = GST_DEBUG_FUNCPTR (push_event);
   ts_class->program_started = GST_DEBUG_FUNCPTR (gst_ts_demux_program_started);
   ts_class->program_stopped = GST_DEBUG_FUNCPTR (gst_ts_demux_program_stopped);
+  ts_class->program_wanted = GST_DEBUG_FUNCPTR (gst_ts_demux_program_wanted);
   ts_class->stream_added = gst_ts_demux_stream_added;
   ts_class->stream_removed = gst_ts_demux_stream_removed;
   ts_class->seek = GST_DEBUG_FUNCPTR (gst_ts_demux_do_seek);
@@ -379,8 +463,6 @@ gst_ts_demux_reset (MpegTSBase * base)
 {
   GstTSDemux *demux = (GstTSDemux *) base;
 
-  demux->calculate_update_segment = FALSE;
-
   demux->rate = 1.0;
   gst_segment_init (&demux->segment, GST_FORMAT_UNDEFINED);
   if (demux->segment_event) {
@@ -388,11 +470,6 @@ gst_ts_demux_reset (MpegTSBase * base)
     demux->segment_event = NULL;
   }
 
-  if (demux->update_segment) {
-    gst_event_unref (demux->update_segment);
-    demux->update_segment = NULL;
-  }
-
   if (demux->global_tags) {
     gst_tag_list_unref (demux->global_tags);
     demux->global_tags = NULL;
@@ -402,6 +479,42 @@ gst_ts_demux_reset (MpegTSBase * base)
   demux->group_id = G_MAXUINT;
 
   demux->last_seek_offset = -1;
+
+  if (demux->copied_bytes || demux->shared_bytes ||
+      base->packetizer->merged_bytes)
+    GST_INFO_OBJECT (demux, "PES data: %" G_GUINT64_FORMAT " bytes copied, %"
+        G_GUINT64_FORMAT " bytes shared. Packetizer merged %" G_GUINT64_FORMAT
+        " bytes", demux->copied_bytes, demux->shared_bytes,
+        base->packetizer->merged_bytes);
+  demux->copied_bytes = 0;
+  demux->shared_bytes = 0;
+  base->packetizer->merged_bytes = 0;
+
+  if (demux->index_location && !base->packetizer->index_loaded) {
+    GError *err = NULL;
+
+    if (!mpegts_packetizer_load_index (base->packetizer,
+            demux->index_location, &err)) {
+      GST_DEBUG_OBJECT (demux, "Not using index: %s. Will write it at EOS",
+          err->message);
+      g_clear_error (&err);
+    }
+  }
+}
+
+static void
+gst_ts_demux_save_index (GstTSDemux * demux)
+{
+  MpegTSBase *base = (MpegTSBase *) demux;
+  GError *err = NULL;
+
+  if (!mpegts_packetizer_save_index (base->packetizer, demux->index_location,
+          &err)) {
+    GST_ELEMENT_WARNING (demux, RESOURCE, WRITE, (NULL),
+        ("Could not write index to %s: %s", demux->index_location,
+            err->message));
+    g_clear_error (&err);
+  }
 }
 
 static void
@@ -409,6 +522,7 @@ gst_ts_demux_init (GstTSDemux * demux)
 {
   MpegTSBase *base = (MpegTSBase *) demux;
 
+  base->program_size = sizeof (TSDemuxProgram);
   base->stream_size = sizeof (TSDemuxStream);
   base->parse_private_sections = TRUE;
   /* We are not interested in sections (all handled by mpegtsbase) */
@@ -416,11 +530,63 @@ gst_ts_demux_init (GstTSDemux * demux)
 
   demux->flowcombiner = gst_flow_combiner_new ();
   demux->requested_program_number = -1;
+  demux->seek_pcr_pid = -1;
   demux->program_number = -1;
   gst_ts_demux_reset (base);
 }
 
 
+static void
+gst_ts_demux_set_program_numbers (GstTSDemux * demux, const gchar * str)
+{
+  gchar **numbers;
+  guint i;
+
+  if (demux->program_numbers) {
+    g_array_free (demux->program_numbers, TRUE);
+    demux->program_numbers = NULL;
+  }
+
+  demux->multi_program = str != NULL && *str != '\0';
+  if (!demux->multi_program || !g_strcmp0 (str, "all"))
+    return;
+
+  demux->program_numbers = g_array_new (FALSE, FALSE, sizeof (gint));
+  numbers = g_strsplit (str, ",", -1);
+  for (i = 0; numbers[i]; i++) {
+    gchar *end;
+    gint64 number = g_ascii_strtoll (numbers[i], &end, 0);
+    gint program_number = number;
+
+    if (end == numbers[i] || number < 0 || number > G_MAXUINT16) {
+      GST_WARNING_OBJECT (demux, "Ignoring invalid program number '%s'",
+          numbers[i]);
+      continue;
+    }
+    g_array_append_val (demux->program_numbers, program_number);
+  }
+  g_strfreev (numbers);
+}
+
+static gchar *
+gst_ts_demux_get_program_numbers (GstTSDemux * demux)
+{
+  GString *str;
+  guint i;
+
+  if (!demux->multi_program)
+    return NULL;
+  if (demux->program_numbers == NULL)
+    return g_strdup ("all");
+
+  str = g_string_new (NULL);
+  for (i = 0; i < demux->program_numbers->len; i++)
+    g_string_append_printf (str, "%s%d", i ? "," : "",
+        g_array_index (demux->program_numbers, gint, i));
+
+  return g_string_free (str, FALSE);
+}
+
 static void
 gst_ts_demux_set_property (GObject * object, guint prop_id,
     const GValue * value, GParamSpec * pspec)
@@ -432,10 +598,20 @@ gst_ts_demux_set_property (GObject * object, guint prop_id,
       /* FIXME: do something if program is switched as opposed to set at
        * beginning */
       demux->requested_program_number = g_value_get_int (value);
+      mpegts_base_invalidate_pid_filter (GST_MPEGTS_BASE (demux));
+      break;
+    case PROP_PROGRAM_NUMBERS:
+      gst_ts_demux_set_program_numbers (demux, g_value_get_string (value));
+      mpegts_base_invalidate_pid_filter (GST_MPEGTS_BASE (demux));
       break;
     case PROP_EMIT_STATS:
       demux->emit_statistics = g_value_get_boolean (value);
       break;
+    case PROP_INDEX_LOCATION:
+      g_free (demux->index_location);
+      demux->index_location = g_value_dup_string (value);
+      GST_MPEGTS_BASE (demux)->packetizer->index_loaded = FALSE;
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
   }
@@ -451,14 +627,32 @@ gst_ts_demux_get_property (GObject * object, guint prop_id,
     case PROP_PROGRAM_NUMBER:
       g_value_set_int (value, demux->requested_program_number);
       break;
+    case PROP_PROGRAM_NUMBERS:
+      g_value_take_string (value, gst_ts_demux_get_program_numbers (demux));
+      break;
     case PROP_EMIT_STATS:
       g_value_set_boolean (value, demux->emit_statistics);
       break;
+    case PROP_INDEX_LOCATION:
+      g_value_set_string (value, demux->index_location);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
   }
 }
 
+/* Returns the program whose stream is exposed on @pad */
+static TSDemuxProgram *
+gst_ts_demux_get_pad_program (GstTSDemux * demux, GstPad * pad)
+{
+  TSDemuxStream *stream = gst_pad_get_element_private (pad);
+
+  if (stream)
+    return stream->program;
+
+  return (TSDemuxProgram *) demux->program;
+}
+
 static gboolean
 gst_ts_demux_srcpad_query (GstPad * pad, GstObject * parent, GstQuery * query)
 {
@@ -466,9 +660,11 @@ gst_ts_demux_srcpad_query (GstPad * pad, GstObject * parent, GstQuery * query)
   GstFormat format;
   GstTSDemux *demux;
   MpegTSBase *base;
+  TSDemuxProgram *program;
 
   demux = GST_TS_DEMUX (parent);
   base = GST_MPEGTS_BASE (demux);
+  program = gst_ts_demux_get_pad_program (demux, pad);
 
   switch (GST_QUERY_TYPE (query)) {
     case GST_QUERY_DURATION:
@@ -480,12 +676,13 @@ gst_ts_demux_srcpad_query (GstPad * pad, GstObject * parent, GstQuery * query)
           gint64 val;
 
           format = GST_FORMAT_BYTES;
-          if (!gst_pad_peer_query_duration (base->sinkpad, format, &val))
+          if (program == NULL ||
+              !gst_pad_peer_query_duration (base->sinkpad, format, &val))
             res = FALSE;
           else {
             GstClockTime dur =
                 mpegts_packetizer_offset_to_ts (base->packetizer, val,
-                demux->program->pcr_pid);
+                program->program.pcr_pid);
             if (GST_CLOCK_TIME_IS_VALID (dur))
               gst_query_set_duration (query, GST_FORMAT_TIME, dur);
             else
@@ -536,7 +733,7 @@ gst_ts_demux_srcpad_query (GstPad * pad, GstObject * parent, GstQuery * query)
          * our own values here */
         if (!seekable)
           gst_query_set_seeking (query, GST_FORMAT_TIME, TRUE, 0,
-              demux->segment.duration);
+              program ? program->segment.duration : -1);
       } else {
         GST_DEBUG_OBJECT (demux, "only TIME is supported for query seeking");
         res = FALSE;
@@ -546,18 +743,23 @@ gst_ts_demux_srcpad_query (GstPad * pad, GstObject * parent, GstQuery * query)
     case GST_QUERY_SEGMENT:{
       GstFormat format;
       gint64 start, stop;
+      GstSegment *segment;
+
+      if (program == NULL) {
+        res = FALSE;
+        break;
+      }
+      segment = &program->segment;
 
-      format = demux->segment.format;
+      format = segment->format;
 
-      start =
-          gst_segment_to_stream_time (&demux->segment, format,
-          demux->segment.start);
-      if ((stop = demux->segment.stop) == -1)
-        stop = demux->segment.duration;
+      start = gst_segment_to_stream_time (segment, format, segment->start);
+      if ((stop = segment->stop) == -1)
+        stop = segment->duration;
       else
-        stop = gst_segment_to_stream_time (&demux->segment, format, stop);
+        stop = gst_segment_to_stream_time (segment, format, stop);
 
-      gst_query_set_segment (query, demux->segment.rate, format, start, stop);
+      gst_query_set_segment (query, segment->rate, format, start, stop);
       res = TRUE;
       break;
     }
@@ -671,6 +873,7 @@ scan_keyframe_h264 (TSDemuxStream * stream, const guint8 * data,
             GST_DEBUG_OBJECT (stream->pad, "Found keyframe at: %u",
                 unit.sc_offset);
             frame_unit = unit;
+            stream->keyframe_offset = stream->pes_offset;
           }
         }
 
@@ -783,7 +986,8 @@ gst_ts_demux_do_seek (MpegTSBase * base, GstEvent * event)
   GstSeekFlags flags;
   GstSeekType start_type, stop_type;
   gint64 start, stop;
-  guint64 start_offset;
+  guint64 start_offset, keyframe_offset;
+  gint keyframe_pcr_pid;
 
   gst_event_parse_seek (event, &rate, &format, &flags, &start_type, &start,
       &stop_type, &stop);
@@ -802,9 +1006,18 @@ gst_ts_demux_do_seek (MpegTSBase * base, GstEvent * event)
     goto done;
   }
 
+  if (demux->program == NULL) {
+    GST_WARNING ("No program to seek in");
+    goto done;
+  }
+
   /* configure the segment with the seek variables */
   GST_DEBUG_OBJECT (demux, "configuring seek");
 
+  /* The primary program is used for offset estimation and gives the
+   * segment to start from */
+  demux->segment = ((TSDemuxProgram *) demux->program)->segment;
+
   start_offset =
       mpegts_packetizer_ts_to_offset (base->packetizer, MAX (0,
           start - SEEK_TIMESTAMP_OFFSET), demux->program->pcr_pid);
@@ -814,6 +1027,23 @@ gst_ts_demux_do_seek (MpegTSBase * base, GstEvent * event)
     goto done;
   }
 
+  /* If the index knows about a previous keyframe, start from there instead
+   * of rewinding until we find one */
+  GST_OBJECT_LOCK (demux);
+  keyframe_pcr_pid = demux->seek_pcr_pid;
+  GST_OBJECT_UNLOCK (demux);
+  if (keyframe_pcr_pid == -1)
+    keyframe_pcr_pid = demux->program->pcr_pid;
+  keyframe_offset =
+      mpegts_packetizer_get_keyframe_offset (base->packetizer, MAX (0,
+          start - SEEK_TIMESTAMP_OFFSET), keyframe_pcr_pid);
+  if (keyframe_offset != -1) {
+    GST_DEBUG_OBJECT (demux, "Starting from keyframe at offset %"
+        G_GUINT64_FORMAT " (instead of %" G_GUINT64_FORMAT ")",
+        keyframe_offset, start_offset);
+    start_offset = keyframe_offset;
+  }
+
   /* record offset and rate */
   base->seek_offset = start_offset;
   demux->last_seek_offset = base->seek_offset;
@@ -833,13 +1063,24 @@ gst_ts_demux_do_seek (MpegTSBase * base, GstEvent * event)
     demux->segment_event = NULL;
   }
 
-  for (tmp = demux->program->stream_list; tmp; tmp = tmp->next) {
-    TSDemuxStream *stream = tmp->data;
+  for (tmp = demux->programs; tmp; tmp = tmp->next) {
+    TSDemuxProgram *program = tmp->data;
+    GList *tmp2;
 
-    stream->needs_keyframe = TRUE;
+    program->segment = demux->segment;
+    if (program->segment_event) {
+      gst_event_unref (program->segment_event);
+      program->segment_event = NULL;
+    }
 
-    stream->seeked_pts = GST_CLOCK_TIME_NONE;
-    stream->seeked_dts = GST_CLOCK_TIME_NONE;
+    for (tmp2 = program->program.stream_list; tmp2; tmp2 = tmp2->next) {
+      TSDemuxStream *stream = tmp2->data;
+
+      stream->needs_keyframe = TRUE;
+
+      stream->seeked_pts = GST_CLOCK_TIME_NONE;
+      stream->seeked_dts = GST_CLOCK_TIME_NONE;
+    }
   }
 
 done:
@@ -857,11 +1098,27 @@ gst_ts_demux_srcpad_event (GstPad * pad, GstObject * parent, GstEvent * event)
 
   switch (GST_EVENT_TYPE (event)) {
     case GST_EVENT_SEEK:
+    {
+      TSDemuxStream *stream = gst_pad_get_element_private (pad);
+
+      /* In multi-program mode the keyframes are looked up in the program
+       * of the stream being seeked */
+      GST_OBJECT_LOCK (demux);
+      demux->seek_pcr_pid = (stream && stream->program) ?
+          stream->program->program.pcr_pid : -1;
+      GST_OBJECT_UNLOCK (demux);
+
       res = mpegts_base_handle_seek_event ((MpegTSBase *) demux, pad, event);
+
+      GST_OBJECT_LOCK (demux);
+      demux->seek_pcr_pid = -1;
+      GST_OBJECT_UNLOCK (demux);
+
       if (!res)
         GST_WARNING ("seeking failed");
       gst_event_unref (event);
       break;
+    }
     default:
       res = gst_pad_event_default (pad, parent, event);
   }
@@ -880,7 +1137,7 @@ static gboolean
 push_event (MpegTSBase * base, GstEvent * event)
 {
   GstTSDemux *demux = (GstTSDemux *) base;
-  GList *tmp;
+  GList *tmp, *tmp2;
   gboolean early_ret = FALSE;
 
   if (GST_EVENT_TYPE (event) == GST_EVENT_SEGMENT) {
@@ -912,6 +1169,10 @@ push_event (MpegTSBase * base, GstEvent * event)
     /* tags are stored to be used after if there are no streams yet,
      * so we should never reject */
     early_ret = TRUE;
+  } else if (GST_EVENT_TYPE (event) == GST_EVENT_EOS) {
+    if (demux->index_location &&
+        !GST_MPEGTS_BASE (demux)->packetizer->index_loaded)
+      gst_ts_demux_save_index (demux);
   }
 
   if (G_UNLIKELY (demux->program == NULL)) {
@@ -919,16 +1180,20 @@ push_event (MpegTSBase * base, GstEvent * event)
     return early_ret;
   }
 
-  for (tmp = demux->program->stream_list; tmp; tmp = tmp->next) {
-    TSDemuxStream *stream = (TSDemuxStream *) tmp->data;
-    if (stream->pad) {
-      /* If we are pushing out EOS, flush out pending data first */
-      if (GST_EVENT_TYPE (event) == GST_EVENT_EOS &&
-          gst_pad_is_active (stream->pad))
-        gst_ts_demux_push_pending_data (demux, stream);
-
-      gst_event_ref (event);
-      gst_pad_push_event (stream->pad, event);
+  for (tmp = demux->programs; tmp; tmp = tmp->next) {
+    MpegTSBaseProgram *program = (MpegTSBaseProgram *) tmp->data;
+
+    for (tmp2 = program->stream_list; tmp2; tmp2 = tmp2->next) {
+      TSDemuxStream *stream = (TSDemuxStream *) tmp2->data;
+      if (stream->pad) {
+        /* If we are pushing out EOS, flush out pending data first */
+        if (GST_EVENT_TYPE (event) == GST_EVENT_EOS &&
+            gst_pad_is_active (stream->pad))
+          gst_ts_demux_push_pending_data (demux, stream);
+
+        gst_event_ref (event);
+        gst_pad_push_event (stream->pad, event);
+      }
     }
   }
 
@@ -1325,14 +1590,30 @@ done:
     GstEvent *event;
     gchar *stream_id;
 
+    /* Several programs can have got a stream on the same PID */
+    if (demux->multi_program) {
+      gchar *tmp = name;
+
+      name = g_strdup_printf ("%.*s_%x_%04x",
+          (gint) (strrchr (tmp, '_') - tmp), tmp, program->program_number,
+          bstream->pid);
+      g_free (tmp);
+    }
+
     GST_LOG ("stream:%p creating pad with name %s and caps %" GST_PTR_FORMAT,
         stream, name, caps);
     pad = gst_pad_new_from_template (template, name);
+    gst_pad_set_element_private (pad, stream);
     gst_pad_set_active (pad, TRUE);
     gst_pad_use_fixed_caps (pad);
-    stream_id =
-        gst_pad_create_stream_id_printf (pad, GST_ELEMENT_CAST (base), "%08x",
-        bstream->pid);
+    if (demux->multi_program)
+      stream_id =
+          gst_pad_create_stream_id_printf (pad, GST_ELEMENT_CAST (base),
+          "%08x:%08x", program->program_number, bstream->pid);
+    else
+      stream_id =
+          gst_pad_create_stream_id_printf (pad, GST_ELEMENT_CAST (base),
+          "%08x", bstream->pid);
 
     event = gst_pad_get_sticky_event (base->sinkpad, GST_EVENT_STREAM_START, 0);
     if (event) {
@@ -1377,6 +1658,11 @@ gst_ts_demux_stream_added (MpegTSBase * base, MpegTSBaseStream * bstream,
   GstTSDemux *demux = (GstTSDemux *) base;
   TSDemuxStream *stream = (TSDemuxStream *) bstream;
 
+  stream->program = (TSDemuxProgram *) program;
+
+  if (!stream->slices)
+    stream->slices = g_array_new (FALSE, FALSE, sizeof (PESSlice));
+
   if (!stream->pad) {
     /* Create the pad */
     if (bstream->stream_type != 0xff) {
@@ -1403,6 +1689,7 @@ gst_ts_demux_stream_added (MpegTSBase * base, MpegTSBaseStream * bstream,
     stream->pending_ts = TRUE;
     stream->first_dts = GST_CLOCK_TIME_NONE;
     stream->continuity_counter = CONTINUITY_UNSET;
+    stream->keyframe_offset = -1;
   }
 }
 
@@ -1425,6 +1712,7 @@ gst_ts_demux_stream_removed (MpegTSBase * base, MpegTSBaseStream * bstream)
   TSDemuxStream *stream = (TSDemuxStream *) bstream;
 
   if (stream->pad) {
+    gst_pad_set_element_private (stream->pad, NULL);
     gst_flow_combiner_remove_pad (GST_TS_DEMUX_CAST (base)->flowcombiner,
         stream->pad);
     if (stream->active && gst_pad_is_active (stream->pad)) {
@@ -1443,6 +1731,8 @@ gst_ts_demux_stream_removed (MpegTSBase * base, MpegTSBaseStream * bstream)
   }
 
   gst_ts_demux_stream_flush (stream, GST_TS_DEMUX_CAST (base));
+  g_array_free (stream->slices, TRUE);
+  stream->slices = NULL;
 
   tsdemux_h264_parsing_info_clear (&stream->h264infos);
 }
@@ -1450,7 +1740,7 @@ gst_ts_demux_stream_removed (MpegTSBase * base, MpegTSBaseStream * bstream)
 static void
 activate_pad_for_stream (GstTSDemux * tsdemux, TSDemuxStream * stream)
 {
-  GList *tmp;
+  GList *tmp, *tmp2;
   gboolean alldone = TRUE;
 
   if (stream->pad) {
@@ -1460,11 +1750,16 @@ activate_pad_for_stream (GstTSDemux * tsdemux, TSDemuxStream * stream)
     stream->active = TRUE;
     GST_DEBUG_OBJECT (stream->pad, "done adding pad");
 
-    /* Check if all pads were activated, and if so emit no-more-pads */
-    for (tmp = tsdemux->program->stream_list; tmp; tmp = tmp->next) {
-      stream = (TSDemuxStream *) tmp->data;
-      if (stream->pad && !stream->active)
-        alldone = FALSE;
+    /* Check if all pads (of all selected programs) were activated, and if
+     * so emit no-more-pads */
+    for (tmp = tsdemux->programs; tmp; tmp = tmp->next) {
+      MpegTSBaseProgram *program = (MpegTSBaseProgram *) tmp->data;
+
+      for (tmp2 = program->stream_list; tmp2; tmp2 = tmp2->next) {
+        stream = (TSDemuxStream *) tmp2->data;
+        if (stream->pad && !stream->active)
+          alldone = FALSE;
+      }
     }
     if (alldone) {
       GST_DEBUG_OBJECT (tsdemux, "All pads were activated, emit no-more-pads");
@@ -1482,13 +1777,9 @@ gst_ts_demux_stream_flush (TSDemuxStream * stream, GstTSDemux * tsdemux)
 {
   GST_DEBUG ("flushing stream %p", stream);
 
-  if (stream->data)
-    g_free (stream->data);
-  stream->data = NULL;
+  gst_ts_demux_stream_clear_data (stream);
   stream->state = PENDING_PACKET_EMPTY;
   stream->expected_size = 0;
-  stream->allocated_size = 0;
-  stream->current_size = 0;
   stream->need_newsegment = TRUE;
   stream->discont = TRUE;
   stream->pts = GST_CLOCK_TIME_NONE;
@@ -1503,45 +1794,120 @@ gst_ts_demux_stream_flush (TSDemuxStream * stream, GstTSDemux * tsdemux)
 static void
 gst_ts_demux_flush_streams (GstTSDemux * demux)
 {
-  if (!demux->program)
-    return;
+  GList *tmp;
 
-  g_list_foreach (demux->program->stream_list,
-      (GFunc) gst_ts_demux_stream_flush, demux);
+  for (tmp = demux->programs; tmp; tmp = tmp->next)
+    g_list_foreach (((MpegTSBaseProgram *) tmp->data)->stream_list,
+        (GFunc) gst_ts_demux_stream_flush, demux);
+}
+
+/* Whether the program was selected with the program-number(s) properties */
+static gboolean
+gst_ts_demux_program_selected (GstTSDemux * demux, gint program_number)
+{
+  guint i;
+
+  if (!demux->multi_program)
+    return demux->requested_program_number == program_number ||
+        (demux->requested_program_number == -1 && demux->program_number == -1);
+
+  if (demux->program_numbers == NULL)
+    return TRUE;
+
+  for (i = 0; i < demux->program_numbers->len; i++) {
+    if (g_array_index (demux->program_numbers, gint, i) == program_number)
+      return TRUE;
+  }
+
+  return FALSE;
 }
 
 static void
 gst_ts_demux_program_started (MpegTSBase * base, MpegTSBaseProgram * program)
 {
   GstTSDemux *demux = GST_TS_DEMUX (base);
+  TSDemuxProgram *tsprogram = (TSDemuxProgram *) program;
 
   GST_DEBUG ("Current program %d, new program %d requested program %d",
       (gint) demux->program_number, program->program_number,
       demux->requested_program_number);
 
-  if (demux->requested_program_number == program->program_number ||
-      (demux->requested_program_number == -1 && demux->program_number == -1)) {
+  if (gst_ts_demux_program_selected (demux, program->program_number)) {
 
     GST_LOG ("program %d started", program->program_number);
-    demux->program_number = program->program_number;
-    demux->program = program;
+    if (demux->program == NULL) {
+      demux->program_number = program->program_number;
+      demux->program = program;
+    }
+    demux->programs = g_list_append (demux->programs, program);
+
+    /* Start from the seek segment, or in single-program mode take over the
+     * segment of the program we are replacing */
+    tsprogram->segment = demux->segment;
+    if (!demux->multi_program) {
+      tsprogram->segment_event = demux->segment_event;
+      demux->segment_event = NULL;
+    }
 
     /* If this is not the initial program, we need to calculate
      * an update newsegment */
-    demux->calculate_update_segment = !program->initial_program;
+    tsprogram->calculate_update_segment = !program->initial_program;
 
     /* FIXME : When do we emit no_more_pads ? */
   }
 }
 
+static gboolean
+gst_ts_demux_program_wanted (MpegTSBase * base, MpegTSBaseProgram * program)
+{
+  GstTSDemux *demux = GST_TS_DEMUX (base);
+
+  /* Only the current program once it has been selected */
+  if (demux->program && !demux->multi_program)
+    return demux->program == program;
+
+  if (!demux->multi_program)
+    return demux->requested_program_number == -1 ||
+        demux->requested_program_number == program->program_number;
+
+  return gst_ts_demux_program_selected (demux, program->program_number);
+}
+
 static void
 gst_ts_demux_program_stopped (MpegTSBase * base, MpegTSBaseProgram * program)
 {
   GstTSDemux *demux = GST_TS_DEMUX (base);
+  TSDemuxProgram *tsprogram = (TSDemuxProgram *) program;
+
+  if (!g_list_find (demux->programs, program))
+    return;
+
+  demux->programs = g_list_remove (demux->programs, program);
+
+  /* Hand over the segment to the next program in single-program mode */
+  if (!demux->multi_program) {
+    demux->segment = tsprogram->segment;
+    if (demux->segment_event)
+      gst_event_unref (demux->segment_event);
+    demux->segment_event = tsprogram->segment_event;
+  } else if (tsprogram->segment_event) {
+    gst_event_unref (tsprogram->segment_event);
+  }
+  tsprogram->segment_event = NULL;
+
+  if (tsprogram->update_segment) {
+    gst_event_unref (tsprogram->update_segment);
+    tsprogram->update_segment = NULL;
+  }
 
   if (demux->program == program) {
-    demux->program = NULL;
-    demux->program_number = -1;
+    if (demux->programs) {
+      demux->program = demux->programs->data;
+      demux->program_number = demux->program->program_number;
+    } else {
+      demux->program = NULL;
+      demux->program_number = -1;
+    }
   }
 }
 
@@ -1564,7 +1930,7 @@ gst_ts_demux_record_pts (GstTSDemux * demux, TSDemuxStream * stream,
   /* Compute PTS in GstClockTime */
   stream->pts =
       mpegts_packetizer_pts_to_ts (MPEG_TS_BASE_PACKETIZER (demux),
-      MPEGTIME_TO_GSTTIME (pts), demux->program->pcr_pid);
+      MPEGTIME_TO_GSTTIME (pts), stream->program->program.pcr_pid);
 
   GST_LOG ("pid 0x%04x Stored PTS %" G_GUINT64_FORMAT, bs->pid, stream->pts);
 
@@ -1598,7 +1964,7 @@ gst_ts_demux_record_dts (GstTSDemux * demux, TSDemuxStream * stream,
   /* Compute DTS in GstClockTime */
   stream->dts =
       mpegts_packetizer_pts_to_ts (MPEG_TS_BASE_PACKETIZER (demux),
-      MPEGTIME_TO_GSTTIME (dts), demux->program->pcr_pid);
+      MPEGTIME_TO_GSTTIME (dts), stream->program->program.pcr_pid);
 
   GST_LOG ("pid 0x%04x Stored DTS %" G_GUINT64_FORMAT, bs->pid, stream->dts);
 
@@ -1616,7 +1982,7 @@ gst_ts_demux_record_dts (GstTSDemux * demux, TSDemuxStream * stream,
 
 /* This is called when we haven't got a valid initial PTS/DTS on all streams */
 static gboolean
-check_pending_buffers (GstTSDemux * demux)
+check_pending_buffers (GstTSDemux * demux, MpegTSBaseProgram * program)
 {
   gboolean have_observation = FALSE;
   /* The biggest offset */
@@ -1624,7 +1990,7 @@ check_pending_buffers (GstTSDemux * demux)
   GList *tmp;
 
   /* 1. Go over all streams */
-  for (tmp = demux->program->stream_list; tmp; tmp = tmp->next) {
+  for (tmp = program->stream_list; tmp; tmp = tmp->next) {
     TSDemuxStream *tmpstream = (TSDemuxStream *) tmp->data;
     /* 1.1 check if at least one stream got a valid DTS */
     if ((tmpstream->raw_dts != -1 && tmpstream->dts != GST_CLOCK_TIME_NONE) ||
@@ -1639,7 +2005,7 @@ check_pending_buffers (GstTSDemux * demux)
     return FALSE;
 
   /* 3. Go over all streams that have current/pending data */
-  for (tmp = demux->program->stream_list; tmp; tmp = tmp->next) {
+  for (tmp = program->stream_list; tmp; tmp = tmp->next) {
     TSDemuxStream *tmpstream = (TSDemuxStream *) tmp->data;
     PendingBuffer *pend;
     guint64 firstval, lastval, ts;
@@ -1670,7 +2036,7 @@ check_pending_buffers (GstTSDemux * demux)
     }
     /* 3.2 Add to the offset the report TS for the current DTS */
     ts = mpegts_packetizer_pts_to_ts (MPEG_TS_BASE_PACKETIZER (demux),
-        MPEGTIME_TO_GSTTIME (lastval), demux->program->pcr_pid);
+        MPEGTIME_TO_GSTTIME (lastval), program->pcr_pid);
     if (ts == GST_CLOCK_TIME_NONE) {
       GST_WARNING ("THIS SHOULD NOT HAPPEN !");
       continue;
@@ -1686,10 +2052,10 @@ check_pending_buffers (GstTSDemux * demux)
 
   /* 4. Set the offset on the packetizer */
   mpegts_packetizer_set_current_pcr_offset (MPEG_TS_BASE_PACKETIZER (demux),
-      offset, demux->program->pcr_pid);
+      offset, program->pcr_pid);
 
   /* 4. Go over all streams */
-  for (tmp = demux->program->stream_list; tmp; tmp = tmp->next) {
+  for (tmp = program->stream_list; tmp; tmp = tmp->next) {
     TSDemuxStream *stream = (TSDemuxStream *) tmp->data;
 
     stream->pending_ts = FALSE;
@@ -1703,11 +2069,11 @@ check_pending_buffers (GstTSDemux * demux)
         if (pend->pts != -1)
           GST_BUFFER_PTS (pend->buffer) =
               mpegts_packetizer_pts_to_ts (MPEG_TS_BASE_PACKETIZER (demux),
-              MPEGTIME_TO_GSTTIME (pend->pts), demux->program->pcr_pid);
+              MPEGTIME_TO_GSTTIME (pend->pts), program->pcr_pid);
         if (pend->dts != -1)
           GST_BUFFER_DTS (pend->buffer) =
               mpegts_packetizer_pts_to_ts (MPEG_TS_BASE_PACKETIZER (demux),
-              MPEGTIME_TO_GSTTIME (pend->dts), demux->program->pcr_pid);
+              MPEGTIME_TO_GSTTIME (pend->dts), program->pcr_pid);
         /* 4.2.2 Set first_dts to TS of lowest DTS (for segment) */
         if (stream->first_dts == GST_CLOCK_TIME_NONE) {
           if (GST_BUFFER_DTS (pend->buffer) != GST_CLOCK_TIME_NONE)
@@ -1722,14 +2088,14 @@ check_pending_buffers (GstTSDemux * demux)
       if (stream->raw_dts != -1) {
         stream->dts =
             mpegts_packetizer_pts_to_ts (MPEG_TS_BASE_PACKETIZER (demux),
-            MPEGTIME_TO_GSTTIME (stream->raw_dts), demux->program->pcr_pid);
+            MPEGTIME_TO_GSTTIME (stream->raw_dts), program->pcr_pid);
         if (stream->first_dts == GST_CLOCK_TIME_NONE)
           stream->first_dts = stream->dts;
       }
       if (stream->raw_pts != -1) {
         stream->pts =
             mpegts_packetizer_pts_to_ts (MPEG_TS_BASE_PACKETIZER (demux),
-            MPEGTIME_TO_GSTTIME (stream->raw_pts), demux->program->pcr_pid);
+            MPEGTIME_TO_GSTTIME (stream->raw_pts), program->pcr_pid);
         if (stream->first_dts == GST_CLOCK_TIME_NONE)
           stream->first_dts = stream->pts;
       }
@@ -1739,6 +2105,122 @@ check_pending_buffers (GstTSDemux * demux)
   return TRUE;
 }
 
+/* Free the data being reconstructed */
+static void
+gst_ts_demux_stream_clear_data (TSDemuxStream * stream)
+{
+  guint i;
+
+  g_free (stream->data);
+  stream->data = NULL;
+
+  for (i = 0; i < stream->slices->len; i++)
+    gst_buffer_unref (g_array_index (stream->slices, PESSlice, i).buffer);
+  g_array_set_size (stream->slices, 0);
+
+  stream->allocated_size = 0;
+  stream->current_size = 0;
+}
+
+/* Copy the data referenced by the slices into ->data, with room for at
+ * least @extra additional bytes */
+static void
+gst_ts_demux_stream_merge_slices (GstTSDemux * demux, TSDemuxStream * stream,
+    guint extra)
+{
+  guint i, offset = 0;
+
+  g_assert (stream->data == NULL);
+
+  if (stream->expected_size)
+    stream->allocated_size =
+        MAX (stream->expected_size, stream->current_size + extra);
+  else
+    stream->allocated_size = MAX (8192, stream->current_size + extra);
+  stream->data = g_malloc (stream->allocated_size);
+
+  for (i = 0; i < stream->slices->len; i++) {
+    PESSlice *slice = &g_array_index (stream->slices, PESSlice, i);
+
+    gst_buffer_extract (slice->buffer, slice->offset, stream->data + offset,
+        slice->size);
+    offset += slice->size;
+    gst_buffer_unref (slice->buffer);
+  }
+  g_array_set_size (stream->slices, 0);
+
+  demux->copied_bytes += offset;
+}
+
+static void
+gst_ts_demux_stream_append_data (GstTSDemux * demux, TSDemuxStream * stream,
+    guint8 * data, guint size)
+{
+  if (size == 0)
+    return;
+
+  if (stream->data == NULL) {
+    MpegTSBase *base = (MpegTSBase *) demux;
+    GstBuffer *buffer;
+    PESSlice slice;
+
+    /* Reference the data if it comes straight from an input buffer, and
+     * the output buffer can share one more memory without merging them */
+    buffer = mpegts_packetizer_get_input_buffer (base->packetizer, data,
+        &slice.offset);
+    if (buffer && stream->slices->len < gst_buffer_get_max_memory ()) {
+      slice.buffer = gst_buffer_ref (buffer);
+      slice.size = size;
+      g_array_append_val (stream->slices, slice);
+      stream->current_size += size;
+      return;
+    }
+
+    GST_LOG ("Switching to copying data (%u slices)", stream->slices->len);
+    gst_ts_demux_stream_merge_slices (demux, stream, size);
+  }
+
+  if (G_UNLIKELY (stream->current_size + size > stream->allocated_size)) {
+    GST_LOG ("resizing buffer");
+    do {
+      stream->allocated_size *= 2;
+    } while (stream->current_size + size > stream->allocated_size);
+    stream->data = g_realloc (stream->data, stream->allocated_size);
+  }
+  memcpy (stream->data + stream->current_size, data, size);
+  stream->current_size += size;
+  demux->copied_bytes += size;
+}
+
+/* Create the output buffer from the data being reconstructed */
+static GstBuffer *
+gst_ts_demux_stream_take_buffer (GstTSDemux * demux, TSDemuxStream * stream)
+{
+  GstBuffer *buffer;
+  guint i;
+
+  if (stream->data) {
+    buffer = gst_buffer_new_wrapped (stream->data, stream->current_size);
+    stream->data = NULL;
+    return buffer;
+  }
+
+  buffer = gst_buffer_new ();
+
+  for (i = 0; i < stream->slices->len; i++) {
+    PESSlice *slice = &g_array_index (stream->slices, PESSlice, i);
+
+    gst_buffer_copy_into (buffer, slice->buffer, GST_BUFFER_COPY_MEMORY,
+        slice->offset, slice->size);
+    gst_buffer_unref (slice->buffer);
+  }
+  g_array_set_size (stream->slices, 0);
+
+  demux->shared_bytes += stream->current_size;
+
+  return buffer;
+}
+
 static void
 gst_ts_demux_parse_pes_header (GstTSDemux * demux, TSDemuxStream * stream,
     guint8 * data, guint32 length, guint64 bufferoffset)
@@ -1769,7 +2251,7 @@ gst_ts_demux_parse_pes_header (GstTSDemux * demux, TSDemuxStream * stream,
           (stream->pts != GST_CLOCK_TIME_NONE
               || stream->dts != GST_CLOCK_TIME_NONE))) {
     GST_DEBUG ("Got pts/dts update, rechecking all streams");
-    check_pending_buffers (demux);
+    check_pending_buffers (demux, (MpegTSBaseProgram *) stream->program);
   } else if (stream->first_dts == GST_CLOCK_TIME_NONE) {
     if (GST_CLOCK_TIME_IS_VALID (stream->dts))
       stream->first_dts = stream->dts;
@@ -1797,16 +2279,10 @@ gst_ts_demux_parse_pes_header (GstTSDemux * demux, TSDemuxStream * stream,
   data += header.header_size;
   length -= header.header_size;
 
-  /* Create the output buffer */
-  if (stream->expected_size)
-    stream->allocated_size = MAX (stream->expected_size, length);
-  else
-    stream->allocated_size = MAX (8192, length);
-
-  g_assert (stream->data == NULL);
-  stream->data = g_malloc (stream->allocated_size);
-  memcpy (stream->data, data, length);
-  stream->current_size = length;
+  g_assert (stream->data == NULL && stream->slices->len == 0);
+  stream->pes_offset = bufferoffset;
+  stream->current_size = 0;
+  gst_ts_demux_stream_append_data (demux, stream, data, length);
 
   stream->state = PENDING_PACKET_BUFFER;
 
@@ -1868,24 +2344,13 @@ gst_ts_demux_queue_data (GstTSDemux * demux, TSDemuxStream * stream,
     case PENDING_PACKET_BUFFER:
     {
       GST_LOG ("BUFFER: appending data");
-      if (G_UNLIKELY (stream->current_size + size > stream->allocated_size)) {
-        GST_LOG ("resizing buffer");
-        do {
-          stream->allocated_size *= 2;
-        } while (stream->current_size + size > stream->allocated_size);
-        stream->data = g_realloc (stream->data, stream->allocated_size);
-      }
-      memcpy (stream->data + stream->current_size, data, size);
-      stream->current_size += size;
+      gst_ts_demux_stream_append_data (demux, stream, data, size);
       break;
     }
     case PENDING_PACKET_DISCONT:
     {
       GST_LOG ("DISCONT: not storing/pushing");
-      if (G_UNLIKELY (stream->data)) {
-        g_free (stream->data);
-        stream->data = NULL;
-      }
+      gst_ts_demux_stream_clear_data (stream);
       stream->continuity_counter = CONTINUITY_UNSET;
       break;
     }
@@ -1900,6 +2365,7 @@ static void
 calculate_and_push_newsegment (GstTSDemux * demux, TSDemuxStream * stream)
 {
   MpegTSBase *base = (MpegTSBase *) demux;
+  TSDemuxProgram *program = stream->program;
   GstClockTime lowest_pts = GST_CLOCK_TIME_NONE;
   GstClockTime firstts = 0;
   GList *tmp;
@@ -1912,11 +2378,11 @@ calculate_and_push_newsegment (GstTSDemux * demux, TSDemuxStream * stream)
    * 4) If a newsegment is valid, push it */
 
   /* Speedup : if we don't need to calculate anything, go straight to pushing */
-  if (!demux->calculate_update_segment && demux->segment_event)
+  if (!program->calculate_update_segment && program->segment_event)
     goto push_new_segment;
 
   /* Calculate the 'new_start' value, used for both updates and newsegment */
-  for (tmp = demux->program->stream_list; tmp; tmp = tmp->next) {
+  for (tmp = program->program.stream_list; tmp; tmp = tmp->next) {
     TSDemuxStream *pstream = (TSDemuxStream *) tmp->data;
 
     if (GST_CLOCK_TIME_IS_VALID (pstream->first_dts)) {
@@ -1930,59 +2396,59 @@ calculate_and_push_newsegment (GstTSDemux * demux, TSDemuxStream * stream)
   GST_DEBUG ("lowest_pts %" G_GUINT64_FORMAT " => clocktime %" GST_TIME_FORMAT,
       lowest_pts, GST_TIME_ARGS (firstts));
 
-  if (demux->calculate_update_segment) {
+  if (program->calculate_update_segment) {
     GST_DEBUG ("Calculating update segment");
     /* If we have a valid segment, create an update of that */
-    if (demux->segment.format == GST_FORMAT_TIME) {
+    if (program->segment.format == GST_FORMAT_TIME) {
       GstSegment update_segment;
       GST_DEBUG ("Re-using segment " SEGMENT_FORMAT,
-          SEGMENT_ARGS (demux->segment));
-      gst_segment_copy_into (&demux->segment, &update_segment);
+          SEGMENT_ARGS (program->segment));
+      gst_segment_copy_into (&program->segment, &update_segment);
       update_segment.stop = firstts;
-      demux->update_segment = gst_event_new_segment (&update_segment);
+      program->update_segment = gst_event_new_segment (&update_segment);
     }
-    demux->calculate_update_segment = FALSE;
+    program->calculate_update_segment = FALSE;
   }
 
-  if (demux->segment.format != GST_FORMAT_TIME) {
+  if (program->segment.format != GST_FORMAT_TIME) {
     /* It will happen only if it's first program or after flushes. */
     GST_DEBUG ("Calculating actual segment");
     if (base->segment.format == GST_FORMAT_TIME) {
       /* Try to recover segment info from base if it's in TIME format */
-      demux->segment = base->segment;
+      program->segment = base->segment;
     } else {
       /* Start from the first ts/pts */
-      gst_segment_init (&demux->segment, GST_FORMAT_TIME);
-      demux->segment.start = firstts;
-      demux->segment.stop = GST_CLOCK_TIME_NONE;
-      demux->segment.position = firstts;
-      demux->segment.time = firstts;
-      demux->segment.rate = demux->rate;
+      gst_segment_init (&program->segment, GST_FORMAT_TIME);
+      program->segment.start = firstts;
+      program->segment.stop = GST_CLOCK_TIME_NONE;
+      program->segment.position = firstts;
+      program->segment.time = firstts;
+      program->segment.rate = demux->rate;
     }
-  } else if (demux->segment.start < firstts) {
+  } else if (program->segment.start < firstts) {
     /* Take into account the offset to the first buffer timestamp */
-    if (GST_CLOCK_TIME_IS_VALID (demux->segment.stop))
-      demux->segment.stop += firstts - demux->segment.start;
-    demux->segment.position = firstts;
-    demux->segment.start = firstts;
+    if (GST_CLOCK_TIME_IS_VALID (program->segment.stop))
+      program->segment.stop += firstts - program->segment.start;
+    program->segment.position = firstts;
+    program->segment.start = firstts;
   }
 
-  if (!demux->segment_event) {
-    demux->segment_event = gst_event_new_segment (&demux->segment);
-    GST_EVENT_SEQNUM (demux->segment_event) = base->last_seek_seqnum;
+  if (!program->segment_event) {
+    program->segment_event = gst_event_new_segment (&program->segment);
+    GST_EVENT_SEQNUM (program->segment_event) = base->last_seek_seqnum;
   }
 
 push_new_segment:
-  if (demux->update_segment) {
+  if (program->update_segment) {
     GST_DEBUG_OBJECT (stream->pad, "Pushing update segment");
-    gst_event_ref (demux->update_segment);
-    gst_pad_push_event (stream->pad, demux->update_segment);
+    gst_event_ref (program->update_segment);
+    gst_pad_push_event (stream->pad, program->update_segment);
   }
 
-  if (demux->segment_event) {
+  if (program->segment_event) {
     GST_DEBUG_OBJECT (stream->pad, "Pushing newsegment event");
-    gst_event_ref (demux->segment_event);
-    gst_pad_push_event (stream->pad, demux->segment_event);
+    gst_event_ref (program->segment_event);
+    gst_pad_push_event (stream->pad, program->segment_event);
   }
 
   if (demux->global_tags) {
@@ -2014,7 +2480,7 @@ gst_ts_demux_push_pending_data (GstTSDemux * demux, TSDemuxStream * stream)
       "stream:%p, pid:0x%04x stream_type:%d state:%d", stream, bs->pid,
       bs->stream_type, stream->state);
 
-  if (G_UNLIKELY (stream->data == NULL)) {
+  if (G_UNLIKELY (stream->data == NULL && stream->slices->len == 0)) {
     GST_LOG ("stream->data == NULL");
     goto beach;
   }
@@ -2031,19 +2497,31 @@ gst_ts_demux_push_pending_data (GstTSDemux * demux, TSDemuxStream * stream)
 
   if (G_UNLIKELY (demux->program == NULL)) {
     GST_LOG_OBJECT (demux, "No program");
-    g_free (stream->data);
     goto beach;
   }
 
   if (stream->needs_keyframe) {
     MpegTSBase *base = (MpegTSBase *) demux;
+    gboolean found;
+
+    /* Scanning requires contiguous data */
+    if (stream->data == NULL)
+      gst_ts_demux_stream_merge_slices (demux, stream, 0);
+
+    found = gst_ts_demux_adjust_seek_offset_for_keyframe (stream, stream->data,
+        stream->current_size);
+    if (stream->keyframe_offset != -1) {
+      if (demux->index_location)
+        mpegts_packetizer_add_keyframe (base->packetizer,
+            stream->keyframe_offset, stream->program->program.pcr_pid);
+      stream->keyframe_offset = -1;
+    }
 
-    if ((gst_ts_demux_adjust_seek_offset_for_keyframe (stream, stream->data,
-                stream->current_size)) || demux->last_seek_offset == 0) {
+    if (found || demux->last_seek_offset == 0) {
       GST_DEBUG_OBJECT (stream->pad,
           "Got Keyframe, ready to go at %" GST_TIME_FORMAT,
           GST_TIME_ARGS (stream->pts));
-      buffer = gst_buffer_new_wrapped (stream->data, stream->current_size);
+      buffer = gst_ts_demux_stream_take_buffer (demux, stream);
       stream->seeked_pts = stream->pts;
       stream->seeked_dts = stream->dts;
       stream->needs_keyframe = FALSE;
@@ -2057,13 +2535,14 @@ gst_ts_demux_push_pending_data (GstTSDemux * demux, TSDemuxStream * stream)
 
       stream->continuity_counter = CONTINUITY_UNSET;
       res = GST_FLOW_REWINDING;
-      g_free (stream->data);
       goto beach;
     }
   } else {
-    buffer = gst_buffer_new_wrapped (stream->data, stream->current_size);
+    buffer = gst_ts_demux_stream_take_buffer (demux, stream);
 
-    if (G_UNLIKELY (stream->pending_ts && !check_pending_buffers (demux))) {
+    if (G_UNLIKELY (stream->pending_ts &&
+            !check_pending_buffers (demux,
+                (MpegTSBaseProgram *) stream->program))) {
       PendingBuffer *pend;
       pend = g_slice_new0 (PendingBuffer);
       pend->buffer = buffer;
@@ -2142,9 +2621,8 @@ beach:
   /* Reset everything */
   GST_LOG ("Resetting to EMPTY, returning %s", gst_flow_get_name (res));
   stream->state = PENDING_PACKET_EMPTY;
-  stream->data = NULL;
+  gst_ts_demux_stream_clear_data (stream);
   stream->expected_size = 0;
-  stream->current_size = 0;
 
   return res;
 }
@@ -2164,6 +2642,13 @@ gst_ts_demux_handle_packet (GstTSDemux * demux, TSDemuxStream * stream,
     /* Flush previous data */
     res = gst_ts_demux_push_pending_data (demux, stream);
 
+  /* Remember random access points of video streams for the index */
+  if (G_UNLIKELY (packet->payload_unit_start_indicator &&
+          (packet->afc_flags & MPEGTS_AFC_RANDOM_ACCES_FLAGS) &&
+          stream->scan_function && demux->index_location))
+    mpegts_packetizer_add_keyframe (((MpegTSBase *) demux)->packetizer,
+        packet->offset, stream->program->program.pcr_pid);
+
   if (packet->payload && (res == GST_FLOW_OK || res == GST_FLOW_NOT_LINKED)
       && stream->pad) {
     gst_ts_demux_queue_data (demux, stream, packet);
@@ -2189,14 +2674,26 @@ static void
 gst_ts_demux_flush (MpegTSBase * base, gboolean hard)
 {
   GstTSDemux *demux = GST_TS_DEMUX_CAST (base);
+  GList *tmp;
 
   gst_ts_demux_flush_streams (demux);
 
+  for (tmp = demux->programs; tmp; tmp = tmp->next) {
+    TSDemuxProgram *program = tmp->data;
+
+    if (program->segment_event) {
+      gst_event_unref (program->segment_event);
+      program->segment_event = NULL;
+    }
+    program->calculate_update_segment = FALSE;
+    if (hard)
+      gst_segment_init (&program->segment, GST_FORMAT_UNDEFINED);
+  }
+
   if (demux->segment_event) {
     gst_event_unref (demux->segment_event);
     demux->segment_event = NULL;
   }
-  demux->calculate_update_segment = FALSE;
   if (demux->global_tags) {
     gst_tag_list_unref (demux->global_tags);
     demux->global_tags = NULL;
@@ -2212,18 +2709,19 @@ static GstFlowReturn
 gst_ts_demux_drain (MpegTSBase * base)
 {
   GstTSDemux *demux = GST_TS_DEMUX_CAST (base);
-  GList *tmp;
+  GList *tmp, *tmp2;
   GstFlowReturn res = GST_FLOW_OK;
 
-  if (!demux->program)
-    return res;
+  for (tmp = demux->programs; tmp; tmp = tmp->next) {
+    MpegTSBaseProgram *program = (MpegTSBaseProgram *) tmp->data;
 
-  for (tmp = demux->program->stream_list; tmp; tmp = tmp->next) {
-    TSDemuxStream *stream = (TSDemuxStream *) tmp->data;
-    if (stream->pad) {
-      res = gst_ts_demux_push_pending_data (demux, stream);
-      if (G_UNLIKELY (res != GST_FLOW_OK))
-        break;
+    for (tmp2 = program->stream_list; tmp2; tmp2 = tmp2->next) {
+      TSDemuxStream *stream = (TSDemuxStream *) tmp2->data;
+      if (stream->pad) {
+        res = gst_ts_demux_push_pending_data (demux, stream);
+        if (G_UNLIKELY (res != GST_FLOW_OK))
+          return res;
+      }
     }
   }
 
@@ -2237,12 +2735,21 @@ gst_ts_demux_push (MpegTSBase * base, MpegTSPacketizerPacket * packet,
   GstTSDemux *demux = GST_TS_DEMUX_CAST (base);
   TSDemuxStream *stream = NULL;
   GstFlowReturn res = GST_FLOW_OK;
+  GList *tmp;
 
-  if (G_LIKELY (demux->program)) {
-    stream = (TSDemuxStream *) demux->program->streams[packet->pid];
+  /* A PID can be shared by several programs */
+  for (tmp = demux->programs; tmp; tmp = tmp->next) {
+    MpegTSBaseProgram *program = (MpegTSBaseProgram *) tmp->data;
+
+    stream = (TSDemuxStream *) program->streams[packet->pid];
 
     if (stream) {
       res = gst_ts_demux_handle_packet (demux, stream, packet, section);
+
+      /* Stop on errors, or if the packet is gone because we are rewinding */
+      if (G_UNLIKELY ((res != GST_FLOW_OK && res != GST_FLOW_NOT_LINKED) ||
+              base->packetizer->map_data == NULL))
+        break;
     }
   }
   return res;
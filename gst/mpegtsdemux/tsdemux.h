@@ -62,22 +62,23 @@ struct _GstTSDemux
   gint requested_program_number; /* Required program number (ignore:-1) */
   guint program_number;
   gboolean emit_statistics;
+  /* Multi-program mode: demux all the programs of program_numbers (all of
+   * them if NULL) at once */
+  gboolean multi_program;
+  GArray *program_numbers;
 
   /*< private >*/
-  MpegTSBaseProgram *program;	/* Current program */
+  MpegTSBaseProgram *program;	/* Current (first selected) program */
+  GList *programs;		/* All selected programs */
 
-  /* segments to be sent */
+  /* Segment configured by seeks, and handed over from a stopped program
+   * to the next one in single-program mode */
   GstSegment segment;
   GstEvent *segment_event;
 
   /* global taglist */
   GstTagList *global_tags;
 
-  /* Set when program change */
-  gboolean calculate_update_segment;
-  /* update segment is */
-  GstEvent *update_segment;
-
   /* Full stream duration */
   GstClockTime duration;
 
@@ -88,6 +89,16 @@ struct _GstTSDemux
 
   /* Used when seeking for a keyframe to go backward in the stream */
   guint64 last_seek_offset;
+  /* PCR PID of the program of the pad the seek was sent to, -1 if it is
+   * not known. Protected by the OBJECT_LOCK */
+  gint seek_pcr_pid;
+
+  /* PCR/offset index file */
+  gchar *index_location;
+
+  /* Number of PES bytes copied and shared (referenced) from input buffers */
+  guint64 copied_bytes;
+  guint64 shared_bytes;
 };
 
 struct _GstTSDemuxClass
@@ -112,11 +112,21 @@ enum
   ARG_PAT_INTERVAL,
   ARG_PMT_INTERVAL,
   ARG_ALIGNMENT,
-  ARG_SI_INTERVAL
+  ARG_SI_INTERVAL,
+  ARG_BITRATE,
+  ARG_PCR_INTERVAL,
+  ARG_MUX_DELAY
 };
 
 #define MPEGTSMUX_DEFAULT_ALIGNMENT    -1
 #define MPEGTSMUX_DEFAULT_M2TS         FALSE
+#define MPEGTSMUX_DEFAULT_BITRATE      0
+
+/* Size of the output buffers, in packets, when not aligning */
+#define MPEGTSMUX_UNALIGNED_PACKETS_PER_BUFFER 128
+
+#define MPEGTSMUX_PACKET_SIZE(mux) \
+  ((mux)->m2ts_mode ? M2TS_PACKET_LENGTH : NORMAL_TS_PACKET_LENGTH)
 
 static GstStaticPadTemplate mpegtsmux_sink_factory =
     GST_STATIC_PAD_TEMPLATE ("sink_%d",
@@ -161,14 +171,12 @@ static void gst_mpegtsmux_get_property (GObject * object, guint prop_id,
 
 static void mpegtsmux_reset (MpegTsMux * mux, gboolean alloc);
 static void mpegtsmux_dispose (GObject * object);
-static void alloc_packet_cb (GstBuffer ** _buf, void *user_data);
-static gboolean new_packet_cb (GstBuffer * buf, void *user_data,
+static guint8 *alloc_packet_cb (void *user_data);
+static gboolean new_packet_cb (guint8 * packet, void *user_data,
     gint64 new_pcr);
 static void release_buffer_cb (guint8 * data, void *user_data);
-static GstFlowReturn mpegtsmux_collect_packet (MpegTsMux * mux,
-    GstBuffer * buf);
 static GstFlowReturn mpegtsmux_push_packets (MpegTsMux * mux, gboolean force);
-static gboolean new_packet_m2ts (MpegTsMux * mux, GstBuffer * buf,
+static gboolean new_packet_m2ts (MpegTsMux * mux, guint8 * data,
     gint64 new_pcr);
 
 static void mpegtsdemux_prepare_srcpad (MpegTsMux * mux);
@@ -204,6 +212,15 @@ typedef struct
   GstBuffer *buffer;
 } StreamData;
 
+/* An output buffer being filled with packets, kept mapped until pushed */
+typedef struct
+{
+  GstBuffer *buffer;
+  GstMapInfo map;
+  /* bytes of packets written */
+  gsize size;
+} OutputBuffer;
+
 G_DEFINE_TYPE (MpegTsMux, mpegtsmux, GST_TYPE_ELEMENT)
 
 /* Takes over the ref on the buffer */
@@ -226,6 +243,14 @@ stream_data_free (StreamData * data)
   }
 }
 
+static void
+output_buffer_free (OutputBuffer * out)
+{
+  gst_buffer_unmap (out->buffer, &out->map);
+  gst_buffer_unref (out->buffer);
+  g_free (out);
+}
+
 #define parent_class mpegtsmux_parent_class
 
 static void
@@ -293,6 +318,26 @@ mpegtsmux_class_init (MpegTsMuxClass * klass)
           "Set the interval (in ticks of the 90kHz clock) for writing out the Service"
           "Information tables", 1, G_MAXUINT, TSMUX_DEFAULT_SI_INTERVAL,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (G_OBJECT_CLASS (klass), ARG_BITRATE,
+      g_param_spec_uint64 ("bitrate", "Bitrate",
+          "Set the target bitrate (in bits per second) of a constant bitrate "
+          "output, stuffed with null packets (0 = variable bitrate)",
+          0, G_MAXUINT64, MPEGTSMUX_DEFAULT_BITRATE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (G_OBJECT_CLASS (klass), ARG_PCR_INTERVAL,
+      g_param_spec_uint ("pcr-interval", "PCR interval",
+          "Set the interval (in ticks of the 90kHz clock) for writing out the "
+          "PCR", 1, G_MAXUINT, TSMUX_DEFAULT_PCR_INTERVAL,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (G_OBJECT_CLASS (klass), ARG_MUX_DELAY,
+      g_param_spec_uint ("mux-delay", "Mux delay",
+          "Set how early (in ticks of the 90kHz clock) the data of a stream "
+          "can be output before its DTS in constant bitrate mode",
+          0, TSMUX_CLOCK_FREQ * 10, TSMUX_DEFAULT_MUX_DELAY,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 }
 
 static void
@@ -319,14 +364,17 @@ mpegtsmux_init (MpegTsMux * mux)
   mux->tsmux = tsmux_new ();
   tsmux_set_write_func (mux->tsmux, new_packet_cb, mux);
 
-  mux->adapter = gst_adapter_new ();
-  mux->out_adapter = gst_adapter_new ();
+  mux->m2ts_pending = g_array_new (FALSE, FALSE, sizeof (guint8 *));
+  g_queue_init (&mux->out_buffers);
 
   /* properties */
   mux->m2ts_mode = MPEGTSMUX_DEFAULT_M2TS;
   mux->pat_interval = TSMUX_DEFAULT_PAT_INTERVAL;
   mux->pmt_interval = TSMUX_DEFAULT_PMT_INTERVAL;
   mux->si_interval = TSMUX_DEFAULT_SI_INTERVAL;
+  mux->pcr_interval = TSMUX_DEFAULT_PCR_INTERVAL;
+  mux->mux_delay = TSMUX_DEFAULT_MUX_DELAY;
+  mux->bitrate = MPEGTSMUX_DEFAULT_BITRATE;
   mux->prog_map = NULL;
   mux->alignment = MPEGTSMUX_DEFAULT_ALIGNMENT;
 
@@ -388,10 +436,16 @@ mpegtsmux_reset (MpegTsMux * mux, gboolean alloc)
     mux->element_index = NULL;
   }
 #endif
-  if (mux->adapter)
-    gst_adapter_clear (mux->adapter);
-  if (mux->out_adapter)
-    gst_adapter_clear (mux->out_adapter);
+  if (mux->m2ts_pending)
+    g_array_set_size (mux->m2ts_pending, 0);
+  g_queue_foreach (&mux->out_buffers, (GFunc) output_buffer_free, NULL);
+  g_queue_clear (&mux->out_buffers);
+  if (mux->pool) {
+    gst_buffer_pool_set_active (mux->pool, FALSE);
+    gst_object_unref (mux->pool);
+    mux->pool = NULL;
+  }
+  mux->packets_per_buffer = 0;
 
   if (mux->tsmux) {
     tsmux_free (mux->tsmux);
@@ -414,7 +468,6 @@ mpegtsmux_reset (MpegTsMux * mux, gboolean alloc)
     mux->streamheader = NULL;
   }
   gst_event_replace (&mux->force_key_unit_event, NULL);
-  gst_buffer_replace (&mux->out_buffer, NULL);
 
   if (mux->collect) {
     GST_COLLECT_PADS_STREAM_LOCK (mux->collect);
@@ -427,7 +480,11 @@ mpegtsmux_reset (MpegTsMux * mux, gboolean alloc)
     mux->tsmux = tsmux_new ();
     tsmux_set_write_func (mux->tsmux, new_packet_cb, mux);
     tsmux_set_alloc_func (mux->tsmux, alloc_packet_cb, mux);
+    tsmux_set_pcr_interval (mux->tsmux, mux->pcr_interval);
+    tsmux_set_bitrate (mux->tsmux, mux->bitrate);
+    tsmux_set_mux_delay (mux->tsmux, mux->mux_delay);
   }
+  mux->n_overruns = 0;
 }
 
 static void
@@ -437,13 +494,9 @@ mpegtsmux_dispose (GObject * object)
 
   mpegtsmux_reset (mux, FALSE);
 
-  if (mux->adapter) {
-    g_object_unref (mux->adapter);
-    mux->adapter = NULL;
-  }
-  if (mux->out_adapter) {
-    g_object_unref (mux->out_adapter);
-    mux->out_adapter = NULL;
+  if (mux->m2ts_pending) {
+    g_array_free (mux->m2ts_pending, TRUE);
+    mux->m2ts_pending = NULL;
   }
   if (mux->collect) {
     gst_object_unref (mux->collect);
@@ -503,6 +556,21 @@ gst_mpegtsmux_set_property (GObject * object, guint prop_id,
       mux->si_interval = g_value_get_uint (value);
       tsmux_set_si_interval (mux->tsmux, mux->si_interval);
       break;
+    case ARG_BITRATE:
+      mux->bitrate = g_value_get_uint64 (value);
+      if (mux->tsmux)
+        tsmux_set_bitrate (mux->tsmux, mux->bitrate);
+      break;
+    case ARG_PCR_INTERVAL:
+      mux->pcr_interval = g_value_get_uint (value);
+      if (mux->tsmux)
+        tsmux_set_pcr_interval (mux->tsmux, mux->pcr_interval);
+      break;
+    case ARG_MUX_DELAY:
+      mux->mux_delay = g_value_get_uint (value);
+      if (mux->tsmux)
+        tsmux_set_mux_delay (mux->tsmux, mux->mux_delay);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -534,6 +602,15 @@ gst_mpegtsmux_get_property (GObject * object, guint prop_id,
     case ARG_SI_INTERVAL:
       g_value_set_uint (value, mux->si_interval);
       break;
+    case ARG_BITRATE:
+      g_value_set_uint64 (value, mux->bitrate);
+      break;
+    case ARG_PCR_INTERVAL:
+      g_value_set_uint (value, mux->pcr_interval);
+      break;
+    case ARG_MUX_DELAY:
+      g_value_set_uint (value, mux->mux_delay);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -1231,6 +1308,14 @@ mpegtsmux_collected_buffer (GstCollectPads * pads, GstCollectData * data,
       goto write_fail;
     }
   }
+
+  if (G_UNLIKELY (tsmux_get_n_overruns (mux->tsmux) != mux->n_overruns)) {
+    mux->n_overruns = tsmux_get_n_overruns (mux->tsmux);
+    GST_ELEMENT_WARNING (mux, STREAM, MUX,
+        ("The bitrate is too low, the output is not constant bitrate anymore"),
+        ("Output fell behind the timestamps (%u times)", mux->n_overruns));
+  }
+
   /* flush packet cache */
   return mpegtsmux_push_packets (mux, FALSE);
 
@@ -1323,162 +1408,208 @@ mpegtsmux_release_pad (GstElement * element, GstPad * pad)
   gst_element_remove_pad (element, pad);
 }
 
+/* @data is the whole packet of @len bytes, including any m2ts prefix */
 static void
-new_packet_common_init (MpegTsMux * mux, GstBuffer * buf, guint8 * data,
-    guint len)
+new_packet_common_init (MpegTsMux * mux, guint8 * data, guint len)
 {
-  /* Packets should be at least 188 bytes, but check anyway */
-  g_return_if_fail (len >= 2 || !data);
-
-  if (!mux->streamheader_sent && data) {
-    guint pid = ((data[1] & 0x1f) << 8) | data[2];
+  if (!mux->streamheader_sent) {
+    guint8 *ts = data + len - NORMAL_TS_PACKET_LENGTH;
+    guint pid = ((ts[1] & 0x1f) << 8) | ts[2];
     /* if it's a PAT or a PMT */
     if (pid == 0x00 || (pid >= TSMUX_START_PMT_PID && pid < TSMUX_START_ES_PID)) {
       GstBuffer *hbuf;
 
-      if (!buf) {
-        hbuf = gst_buffer_new_and_alloc (len);
-        gst_buffer_fill (hbuf, 0, data, len);
-      } else {
-        hbuf = gst_buffer_copy (buf);
-      }
+      hbuf = gst_buffer_new_and_alloc (len);
+      gst_buffer_fill (hbuf, 0, data, len);
       mux->streamheader = g_list_append (mux->streamheader, hbuf);
     } else if (mux->streamheader) {
       mpegtsdemux_set_header_on_caps (mux);
       mux->streamheader_sent = TRUE;
     }
   }
+}
 
-  if (buf) {
-    if (mux->is_delta) {
-      GST_LOG_OBJECT (mux, "marking as delta unit");
-      GST_BUFFER_FLAG_SET (buf, GST_BUFFER_FLAG_DELTA_UNIT);
+/* Returns the number of packets the output buffers have to be aligned to,
+ * or 0 if any amount of packets will do */
+static gint
+mpegtsmux_get_alignment (MpegTsMux * mux)
+{
+  if (mux->alignment < 0)
+    return mux->m2ts_mode ? 32 : 0;
+
+  return mux->alignment;
+}
+
+static OutputBuffer *
+mpegtsmux_output_buffer_new (MpegTsMux * mux)
+{
+  OutputBuffer *out = g_new0 (OutputBuffer, 1);
+  gsize size;
+
+  if (G_UNLIKELY (mux->packets_per_buffer == 0)) {
+    gint align = mpegtsmux_get_alignment (mux);
+
+    mux->packets_per_buffer =
+        align ? align : MPEGTSMUX_UNALIGNED_PACKETS_PER_BUFFER;
+  }
+  size = mux->packets_per_buffer * MPEGTSMUX_PACKET_SIZE (mux);
+
+  if (mux->pool == NULL ||
+      gst_buffer_pool_acquire_buffer (mux->pool, &out->buffer,
+          NULL) != GST_FLOW_OK) {
+    GST_LOG_OBJECT (mux, "no pooled buffer, allocating one");
+    out->buffer = gst_buffer_new_allocate (NULL, size, NULL);
+  }
+
+  if (!gst_buffer_map (out->buffer, &out->map, GST_MAP_WRITE))
+    goto map_failed;
+
+  if (G_UNLIKELY (out->map.size < size)) {
+    GST_WARNING_OBJECT (mux, "pooled buffer of %" G_GSIZE_FORMAT " bytes "
+        "too small", out->map.size);
+    gst_buffer_unmap (out->buffer, &out->map);
+    gst_buffer_unref (out->buffer);
+    out->buffer = gst_buffer_new_allocate (NULL, size, NULL);
+    if (!gst_buffer_map (out->buffer, &out->map, GST_MAP_WRITE))
+      goto map_failed;
+  }
+
+  return out;
+
+map_failed:
+  {
+    GST_ELEMENT_ERROR (mux, RESOURCE, FAILED,
+        ("Failed to map output buffer"), (NULL));
+    gst_buffer_unref (out->buffer);
+    g_free (out);
+    return NULL;
+  }
+}
+
+static GstFlowReturn
+mpegtsmux_output_buffer_push (MpegTsMux * mux, OutputBuffer * out)
+{
+  GstBuffer *buf = out->buffer;
+
+  gst_buffer_unmap (buf, &out->map);
+  /* the memory is left untouched, the pool gives pooled buffers their full
+   * size back when they are released */
+  gst_buffer_set_size (buf, out->size);
+  if (mux->bitrate) {
+    guint64 bits = out->size / MPEGTSMUX_PACKET_SIZE (mux) *
+        NORMAL_TS_PACKET_LENGTH * 8;
+
+    GST_BUFFER_DURATION (buf) =
+        gst_util_uint64_scale (bits, GST_SECOND, mux->bitrate);
+  }
+  g_free (out);
+
+  GST_LOG_OBJECT (mux, "pushing %" G_GSIZE_FORMAT " bytes with pts %"
+      GST_TIME_FORMAT, gst_buffer_get_size (buf),
+      GST_TIME_ARGS (GST_BUFFER_PTS (buf)));
+
+  return gst_pad_push (mux->srcpad, buf);
+}
+
+/* Fills up @out with null packets */
+static void
+mpegtsmux_output_buffer_pad (MpegTsMux * mux, OutputBuffer * out,
+    gsize capacity)
+{
+  gint packet_size = MPEGTSMUX_PACKET_SIZE (mux);
+  guint8 *data = out->map.data + out->size;
+  guint32 header;
+
+  GST_LOG_OBJECT (mux, "adding %d null packets",
+      (gint) ((capacity - out->size) / packet_size));
+
+  header = GST_READ_UINT32_BE (data - packet_size);
+
+  for (; out->size < capacity; out->size += packet_size) {
+    gint offset;
+
+    if (packet_size > NORMAL_TS_PACKET_LENGTH) {
+      GST_WRITE_UINT32_BE (data, header);
+      /* simply increase header a bit and never mind too much */
+      header++;
+      offset = 4;
     } else {
-      GST_DEBUG_OBJECT (mux, "marking as non-delta unit");
-      mux->is_delta = TRUE;
+      offset = 0;
     }
+    GST_WRITE_UINT8 (data + offset, TSMUX_SYNC_BYTE);
+    /* null packet PID */
+    GST_WRITE_UINT16_BE (data + offset + 1, 0x1FFF);
+    /* no adaptation field exists | continuity counter undefined */
+    GST_WRITE_UINT8 (data + offset + 3, 0x10);
+    /* payload */
+    memset (data + offset + 4, 0, NORMAL_TS_PACKET_LENGTH - 4);
+    data += packet_size;
   }
 }
 
+/* Pushes the output buffers that can go downstream. That is the complete
+ * ones, and when not aligning (or draining) the partial ones too, as long
+ * as they do not hold m2ts packets still waiting for their timestamp */
 static GstFlowReturn
 mpegtsmux_push_packets (MpegTsMux * mux, gboolean force)
 {
-  gint align = mux->alignment;
-  gint av, packet_size;
-  GstBuffer *buf;
+  gint align = mpegtsmux_get_alignment (mux);
+  gsize capacity;
+  guint8 *pending = NULL;
+  OutputBuffer *out;
   GstFlowReturn ret = GST_FLOW_OK;
-  GstClockTime ts;
 
-  if (mux->m2ts_mode) {
-    packet_size = M2TS_PACKET_LENGTH;
-    if (align < 0)
-      align = 32;
-  } else {
-    packet_size = NORMAL_TS_PACKET_LENGTH;
-    if (align < 0)
-      align = 0;
-  }
+  capacity = mux->packets_per_buffer * MPEGTSMUX_PACKET_SIZE (mux);
+  if (mux->m2ts_pending->len)
+    pending = g_array_index (mux->m2ts_pending, guint8 *, 0);
 
-  av = gst_adapter_available (mux->out_adapter);
-  GST_LOG_OBJECT (mux, "align %d, av %d", align, av);
+  GST_LOG_OBJECT (mux, "align %d, %u output buffers", align,
+      mux->out_buffers.length);
 
-  if (!align)
-    align = av;
-  else
-    align *= packet_size;
-
-  /* FIXME: what about DTS here? */
-  GST_LOG_OBJECT (mux, "aligning to %d bytes", align);
-  if (G_LIKELY ((align <= av) && av)) {
-    GST_LOG_OBJECT (mux, "pushing %d aligned bytes", av - (av % align));
-    ts = gst_adapter_prev_pts (mux->out_adapter, NULL);
-    buf = gst_adapter_take_buffer (mux->out_adapter, av - (av % align));
-    g_assert (buf);
-    GST_BUFFER_PTS (buf) = ts;
-
-    ret = gst_pad_push (mux->srcpad, buf);
-    av = av % align;
-  }
-
-  if (av && force) {
-    guint8 *data;
-    guint32 header;
-    gint dummy;
-    GstMapInfo map;
-
-    GST_LOG_OBJECT (mux, "handling %d leftover bytes", av);
-    buf = gst_buffer_new_and_alloc (align);
-    gst_buffer_map (buf, &map, GST_MAP_READ);
-    data = map.data;
-    ts = gst_adapter_prev_pts (mux->out_adapter, NULL);
-
-    gst_adapter_copy (mux->out_adapter, data, 0, av);
-    gst_adapter_clear (mux->out_adapter);
-    GST_BUFFER_PTS (buf) = ts;
-
-    data += av;
-    header = GST_READ_UINT32_BE (data - packet_size);
-
-    dummy = (map.size - av) / packet_size;
-    GST_LOG_OBJECT (mux, "adding %d null packets", dummy);
-
-    for (; dummy > 0; dummy--) {
-      gint offset;
-
-      if (packet_size > NORMAL_TS_PACKET_LENGTH) {
-        GST_WRITE_UINT32_BE (data, header);
-        /* simply increase header a bit and never mind too much */
-        header++;
-        offset = 4;
-      } else {
-        offset = 0;
+  while ((out = g_queue_peek_head (&mux->out_buffers))) {
+    if (pending && pending >= out->map.data &&
+        pending < out->map.data + out->size)
+      break;
+
+    if (out->size < capacity) {
+      if (align && !force)
+        break;
+      if (out->size == 0) {
+        g_queue_pop_head (&mux->out_buffers);
+        output_buffer_free (out);
+        continue;
       }
-      GST_WRITE_UINT8 (data + offset, TSMUX_SYNC_BYTE);
-      /* null packet PID */
-      GST_WRITE_UINT16_BE (data + offset + 1, 0x1FFF);
-      /* no adaptation field exists | continuity counter undefined */
-      GST_WRITE_UINT8 (data + offset + 3, 0x10);
-      /* payload */
-      memset (data + offset + 4, 0, NORMAL_TS_PACKET_LENGTH - 4);
-      data += packet_size;
+      if (align)
+        mpegtsmux_output_buffer_pad (mux, out, capacity);
     }
 
-    gst_buffer_unmap (buf, &map);
-
-    ret = gst_pad_push (mux->srcpad, buf);
+    g_queue_pop_head (&mux->out_buffers);
+    ret = mpegtsmux_output_buffer_push (mux, out);
+    if (ret != GST_FLOW_OK)
+      break;
   }
 
   return ret;
 }
 
-static GstFlowReturn
-mpegtsmux_collect_packet (MpegTsMux * mux, GstBuffer * buf)
-{
-  GST_LOG_OBJECT (mux, "collecting packet size %" G_GSIZE_FORMAT,
-      gst_buffer_get_size (buf));
-  gst_adapter_push (mux->out_adapter, buf);
-
-  return GST_FLOW_OK;
-}
-
+/* @data points to the 4 byte timestamp header of the packet, which is
+ * written in place once it can be interpolated from the PCR */
 static gboolean
-new_packet_m2ts (MpegTsMux * mux, GstBuffer * buf, gint64 new_pcr)
+new_packet_m2ts (MpegTsMux * mux, guint8 * data, gint64 new_pcr)
 {
-  GstBuffer *out_buf;
-  int chunk_bytes;
-  GstMapInfo map;
+  gint64 chunk_bytes;
 
-  GST_LOG_OBJECT (mux, "Have buffer %p with new_pcr=%" G_GINT64_FORMAT,
-      buf, new_pcr);
+  GST_LOG_OBJECT (mux, "Have packet %p with new_pcr=%" G_GINT64_FORMAT,
+      data, new_pcr);
 
-  chunk_bytes = gst_adapter_available (mux->adapter);
+  chunk_bytes = (gint64) mux->m2ts_pending->len * M2TS_PACKET_LENGTH;
 
-  if (G_LIKELY (buf)) {
+  if (G_LIKELY (data)) {
     if (new_pcr < 0) {
-      /* If there is no pcr in current ts packet then just add the packet
-         to the adapter for later output when we see a PCR */
+      /* If there is no pcr in current ts packet then just keep track of the
+         packet for later timestamping when we see a PCR */
       GST_LOG_OBJECT (mux, "Accumulating non-PCR packet");
-      gst_adapter_push (mux->adapter, buf);
+      g_array_append_val (mux->m2ts_pending, data);
       goto exit;
     }
 
@@ -1488,7 +1619,7 @@ new_packet_m2ts (MpegTsMux * mux, GstBuffer * buf, gint64 new_pcr)
       mux->previous_pcr = new_pcr;
       mux->previous_offset = chunk_bytes;
       GST_LOG_OBJECT (mux, "Accumulating non-PCR packet");
-      gst_adapter_push (mux->adapter, buf);
+      g_array_append_val (mux->m2ts_pending, data);
       goto exit;
     }
   } else {
@@ -1498,6 +1629,7 @@ new_packet_m2ts (MpegTsMux * mux, GstBuffer * buf, gint64 new_pcr)
   /* interpolate if needed, and 2 points available */
   if (chunk_bytes && (new_pcr != mux->previous_pcr)) {
     gint64 offset = 0;
+    guint i;
 
     GST_LOG_OBJECT (mux, "Processing pending packets; "
         "previous pcr %" G_GINT64_FORMAT ", previous offset %d, "
@@ -1512,11 +1644,8 @@ new_packet_m2ts (MpegTsMux * mux, GstBuffer * buf, gint64 new_pcr)
       mux->pcr_rate_den = chunk_bytes - mux->previous_offset;
     }
 
-    while (offset < chunk_bytes) {
-      guint64 cur_pcr, ts;
-
-      /* Loop, pulling packets of the adapter, updating their 4 byte
-       * timestamp header and pushing */
+    for (i = 0; i < mux->m2ts_pending->len; i++) {
+      guint64 cur_pcr;
 
       /* interpolate PCR */
       if (G_LIKELY (offset >= mux->previous_offset))
@@ -1527,42 +1656,32 @@ new_packet_m2ts (MpegTsMux * mux, GstBuffer * buf, gint64 new_pcr)
         cur_pcr = mux->previous_pcr -
             gst_util_uint64_scale (mux->previous_offset - offset,
             mux->pcr_rate_num, mux->pcr_rate_den);
-
-      /* FIXME: what about DTS here? */
-      ts = gst_adapter_prev_pts (mux->adapter, NULL);
-      out_buf = gst_adapter_take_buffer (mux->adapter, M2TS_PACKET_LENGTH);
-      g_assert (out_buf);
       offset += M2TS_PACKET_LENGTH;
 
-      GST_BUFFER_PTS (out_buf) = ts;
-
-      gst_buffer_map (out_buf, &map, GST_MAP_WRITE);
-
       /* The header is the bottom 30 bits of the PCR, apparently not
        * encoded into base + ext as in the packets themselves */
-      GST_WRITE_UINT32_BE (map.data, cur_pcr & 0x3FFFFFFF);
-      gst_buffer_unmap (out_buf, &map);
+      GST_WRITE_UINT32_BE (g_array_index (mux->m2ts_pending, guint8 *, i),
+          cur_pcr & 0x3FFFFFFF);
 
       GST_LOG_OBJECT (mux, "Outputting a packet of length %d PCR %"
           G_GUINT64_FORMAT, M2TS_PACKET_LENGTH, cur_pcr);
-      mpegtsmux_collect_packet (mux, out_buf);
     }
+    g_array_set_size (mux->m2ts_pending, 0);
   }
 
-  if (G_UNLIKELY (!buf))
+  if (G_UNLIKELY (!data)) {
+    /* Draining without ever having seen a PCR; let the packets go out
+     * with a zero timestamp rather than holding them back forever */
+    g_array_set_size (mux->m2ts_pending, 0);
     goto exit;
-
-  gst_buffer_map (buf, &map, GST_MAP_WRITE);
+  }
 
   /* Finally, output the passed in packet */
   /* Only write the bottom 30 bits of the PCR */
-  GST_WRITE_UINT32_BE (map.data, new_pcr & 0x3FFFFFFF);
-
-  gst_buffer_unmap (buf, &map);
+  GST_WRITE_UINT32_BE (data, new_pcr & 0x3FFFFFFF);
 
   GST_LOG_OBJECT (mux, "Outputting a packet of length %d PCR %"
       G_GUINT64_FORMAT, M2TS_PACKET_LENGTH, new_pcr);
-  mpegtsmux_collect_packet (mux, buf);
 
   if (new_pcr != mux->previous_pcr) {
     mux->previous_pcr = new_pcr;
@@ -1576,59 +1695,81 @@ exit:
 /* Called when the TsMux has prepared a packet for output. Return FALSE
  * on error */
 static gboolean
-new_packet_cb (GstBuffer * buf, void *user_data, gint64 new_pcr)
+new_packet_cb (guint8 * packet, void *user_data, gint64 new_pcr)
 {
   MpegTsMux *mux = (MpegTsMux *) user_data;
-  gint offset = 0;
-  GstMapInfo map;
+  gint packet_size = MPEGTSMUX_PACKET_SIZE (mux);
+  OutputBuffer *out;
+  guint8 *data;
 
 #if 0
   GST_LOG_OBJECT (mux, "handling packet %d", mux->spn_count);
   mux->spn_count++;
 #endif
 
-  if (mux->m2ts_mode) {
-    offset = 4;
-    gst_buffer_set_size (buf, NORMAL_TS_PACKET_LENGTH + offset);
-  }
-
-  gst_buffer_map (buf, &map, GST_MAP_READWRITE);
-
-  if (offset) {
-    /* there should be a better way to do this */
-    memmove (map.data + offset, map.data, map.size - offset);
+  /* the packet was handed out by alloc_packet_cb, in the last buffer */
+  out = g_queue_peek_tail (&mux->out_buffers);
+  g_assert (out != NULL);
+  data = out->map.data + out->size;
+  g_assert (packet == data + packet_size - NORMAL_TS_PACKET_LENGTH);
+
+  if (out->size == 0) {
+    gint64 time = tsmux_get_current_time (mux->tsmux);
+
+    /* the first packet determines the buffer metadata; at a constant
+     * bitrate, that is the time the packet is due on the output */
+    if (time >= 0)
+      GST_BUFFER_PTS (out->buffer) = MPEG_SYS_TIME_TO_GSTTIME (time);
+    else
+      GST_BUFFER_PTS (out->buffer) = mux->last_ts;
+    if (mux->is_delta) {
+      GST_LOG_OBJECT (mux, "marking as delta unit");
+      GST_BUFFER_FLAG_SET (out->buffer, GST_BUFFER_FLAG_DELTA_UNIT);
+    } else {
+      GST_DEBUG_OBJECT (mux, "marking as non-delta unit");
+      GST_BUFFER_FLAG_UNSET (out->buffer, GST_BUFFER_FLAG_DELTA_UNIT);
+    }
   }
+  mux->is_delta = TRUE;
 
-  GST_BUFFER_PTS (buf) = mux->last_ts;
-  /* do common init (flags and streamheaders) */
-  new_packet_common_init (mux, buf, map.data + offset, map.size);
+  /* do common init (streamheaders) */
+  new_packet_common_init (mux, data, packet_size);
 
-  gst_buffer_unmap (buf, &map);
+  out->size += packet_size;
 
   /* all is meant for downstream, including any prefix */
-  if (offset)
-    return new_packet_m2ts (mux, buf, new_pcr);
-  else
-    mpegtsmux_collect_packet (mux, buf);
+  if (packet_size > NORMAL_TS_PACKET_LENGTH)
+    return new_packet_m2ts (mux, data, new_pcr);
 
   return TRUE;
 }
 
-/* called when TsMux needs new packet to write into */
-static void
-alloc_packet_cb (GstBuffer ** _buf, void *user_data)
+/* called when TsMux needs room to write a new packet into */
+static guint8 *
+alloc_packet_cb (void *user_data)
 {
   MpegTsMux *mux = (MpegTsMux *) user_data;
-  GstBuffer *buf;
-  gint offset = 0;
-
-  if (mux->m2ts_mode == TRUE)
-    offset = 4;
+  gint packet_size = MPEGTSMUX_PACKET_SIZE (mux);
+  OutputBuffer *out;
+  guint8 *data;
+
+  out = g_queue_peek_tail (&mux->out_buffers);
+  if (out == NULL ||
+      out->size + packet_size > mux->packets_per_buffer * packet_size) {
+    out = mpegtsmux_output_buffer_new (mux);
+    if (G_UNLIKELY (out == NULL))
+      return NULL;
+    g_queue_push_tail (&mux->out_buffers, out);
+  }
 
-  buf = gst_buffer_new_and_alloc (NORMAL_TS_PACKET_LENGTH + offset);
-  gst_buffer_set_size (buf, NORMAL_TS_PACKET_LENGTH);
+  data = out->map.data + out->size;
+  if (packet_size > NORMAL_TS_PACKET_LENGTH) {
+    /* timestamp header, filled in once the packet is complete */
+    memset (data, 0, packet_size - NORMAL_TS_PACKET_LENGTH);
+    data += packet_size - NORMAL_TS_PACKET_LENGTH;
+  }
 
-  *_buf = buf;
+  return data;
 }
 
 static void
@@ -1665,6 +1806,83 @@ mpegtsdemux_set_header_on_caps (MpegTsMux * mux)
   gst_caps_unref (caps);
 }
 
+/* Sets up the pool the output buffers are taken from. The size of the
+ * buffers is ours to decide, but a downstream pool (and allocator) is
+ * preferred, so sinks can get memory that suits them and recycle it */
+static void
+mpegtsmux_decide_allocation (MpegTsMux * mux, GstCaps * caps)
+{
+  GstQuery *query;
+  GstBufferPool *pool = NULL;
+  GstStructure *config;
+  GstAllocator *allocator = NULL;
+  GstAllocationParams params;
+  guint size, min = 0, max = 0;
+  gint align;
+
+  align = mpegtsmux_get_alignment (mux);
+  mux->packets_per_buffer =
+      align ? align : MPEGTSMUX_UNALIGNED_PACKETS_PER_BUFFER;
+  size = mux->packets_per_buffer * MPEGTSMUX_PACKET_SIZE (mux);
+
+  gst_allocation_params_init (&params);
+
+  query = gst_query_new_allocation (caps, TRUE);
+  if (!gst_pad_peer_query (mux->srcpad, query)) {
+    /* not a problem, we use the defaults of query */
+    GST_DEBUG_OBJECT (mux, "could not get downstream ALLOCATION hints");
+  }
+
+  if (gst_query_get_n_allocation_pools (query) > 0) {
+    guint pool_size;
+
+    gst_query_parse_nth_allocation_pool (query, 0, &pool, &pool_size, &min,
+        &max);
+  }
+  if (gst_query_get_n_allocation_params (query) > 0)
+    gst_query_parse_nth_allocation_param (query, 0, &allocator, &params);
+  gst_query_unref (query);
+
+  if (pool) {
+    config = gst_buffer_pool_get_config (pool);
+    /* never block waiting for a buffer, hence no maximum */
+    gst_buffer_pool_config_set_params (config, caps, size, min, 0);
+    gst_buffer_pool_config_set_allocator (config, allocator, &params);
+    if (!gst_buffer_pool_set_config (pool, config)) {
+      GST_DEBUG_OBJECT (mux, "downstream pool refused our configuration");
+      gst_object_unref (pool);
+      pool = NULL;
+    }
+  }
+
+  if (pool == NULL) {
+    /* we did not get a pool, make one ourselves then */
+    pool = gst_buffer_pool_new ();
+    config = gst_buffer_pool_get_config (pool);
+    gst_buffer_pool_config_set_params (config, caps, size, min, 0);
+    gst_buffer_pool_config_set_allocator (config, allocator, &params);
+    gst_buffer_pool_set_config (pool, config);
+  }
+
+  if (allocator)
+    gst_object_unref (allocator);
+
+  if (!gst_buffer_pool_set_active (pool, TRUE)) {
+    GST_WARNING_OBJECT (mux, "failed to activate buffer pool");
+    gst_object_unref (pool);
+    pool = NULL;
+  }
+
+  GST_DEBUG_OBJECT (mux, "output buffers of %u packets, pool %" GST_PTR_FORMAT,
+      mux->packets_per_buffer, pool);
+
+  if (mux->pool) {
+    gst_buffer_pool_set_active (mux->pool, FALSE);
+    gst_object_unref (mux->pool);
+  }
+  mux->pool = pool;
+}
+
 static void
 mpegtsdemux_prepare_srcpad (MpegTsMux * mux)
 {
@@ -1687,6 +1905,7 @@ mpegtsdemux_prepare_srcpad (MpegTsMux * mux)
 
   /* Set caps on src pad from our template and push new segment */
   gst_pad_set_caps (mux->srcpad, caps);
+  mpegtsmux_decide_allocation (mux, caps);
   gst_caps_unref (caps);
 
   if (!gst_pad_push_event (mux->srcpad, new_seg)) {
@@ -85,7 +85,6 @@
 
 #include <gst/gst.h>
 #include <gst/base/gstcollectpads.h>
-#include <gst/base/gstadapter.h>
 
 G_BEGIN_DECLS
 
@@ -141,6 +140,9 @@ struct MpegTsMux {
   guint pmt_interval;
   gint alignment;
   guint si_interval;
+  guint64 bitrate;
+  guint pcr_interval;
+  guint mux_delay;
 
   /* state */
   gboolean first;
@@ -153,17 +155,21 @@ struct MpegTsMux {
   gboolean streamheader_sent;
   gboolean is_delta;
   GstClockTime last_ts;
+  guint n_overruns;
 
   /* m2ts specific */
   gint64 previous_pcr;
   gint64 previous_offset;
   gint64 pcr_rate_num;
   gint64 pcr_rate_den;
-  GstAdapter *adapter;
-
-  /* output buffer aggregation */
-  GstAdapter *out_adapter;
-  GstBuffer *out_buffer;
+  /* packets whose timestamp header still needs to be interpolated */
+  GArray *m2ts_pending;
+
+  /* output buffer aggregation; packets are written straight into
+   * (mapped) buffers of packets_per_buffer packets, from pool if any */
+  GstBufferPool *pool;
+  guint packets_per_buffer;
+  GQueue out_buffers;
 
 #if 0
   /* SPN/PTS index handling */
@@ -106,9 +106,6 @@
  * 1/8 second atm */
 #define TSMUX_PCR_OFFSET (TSMUX_CLOCK_FREQ / 8)
 
-/* Times per second to write PCR */
-#define TSMUX_DEFAULT_PCR_FREQ (25)
-
 /* Base for all written PCR and DTS/PTS,
  * so we have some slack to go backwards */
 #define CLOCK_BASE (TSMUX_CLOCK_FREQ * 10 * 360)
@@ -150,6 +147,11 @@ tsmux_new (void)
   mux->last_si_ts = -1;
   mux->si_interval = TSMUX_DEFAULT_SI_INTERVAL;
 
+  mux->pcr_interval = TSMUX_DEFAULT_PCR_INTERVAL;
+  mux->mux_delay = TSMUX_DEFAULT_MUX_DELAY;
+  mux->first_pcr = -1;
+  mux->last_dts = -1;
+
   mux->si_sections = g_hash_table_new_full (g_direct_hash, g_direct_equal,
       NULL, (GDestroyNotify) tsmux_section_free);
 
@@ -181,7 +183,7 @@ tsmux_set_write_func (TsMux * mux, TsMuxWriteFunc func, void *user_data)
  * @user_data: user data passed to @func
  *
  * Set the callback function and user data to be called when @mux needs
- * a new buffer to write a packet into.
+ * room to write a packet into.
  * @user_data will be passed as user data in @func.
  */
 void
@@ -228,6 +230,127 @@ tsmux_get_pat_interval (TsMux * mux)
   return mux->pat_interval;
 }
 
+/**
+ * tsmux_set_pcr_interval:
+ * @mux: a #TsMux
+ * @freq: a new PCR interval
+ *
+ * Set the interval (in cycles of the 90kHz clock) for writing out the PCR of
+ * the programs.
+ */
+void
+tsmux_set_pcr_interval (TsMux * mux, guint freq)
+{
+  g_return_if_fail (mux != NULL);
+
+  mux->pcr_interval = freq;
+}
+
+/**
+ * tsmux_get_pcr_interval:
+ * @mux: a #TsMux
+ *
+ * Get the configured PCR interval. See also tsmux_set_pcr_interval().
+ *
+ * Returns: the configured PCR interval
+ */
+guint
+tsmux_get_pcr_interval (TsMux * mux)
+{
+  g_return_val_if_fail (mux != NULL, 0);
+
+  return mux->pcr_interval;
+}
+
+/**
+ * tsmux_set_bitrate:
+ * @mux: a #TsMux
+ * @bitrate: the output bitrate in bits per second, or 0
+ *
+ * Set the rate of the output. When not 0, the output is a constant bitrate
+ * stream: the data of each stream is output once the PCR, which follows the
+ * amount of bytes written, reaches its DTS minus the mux delay, and null
+ * packets are inserted while no data is due. See also tsmux_set_mux_delay().
+ */
+void
+tsmux_set_bitrate (TsMux * mux, guint64 bitrate)
+{
+  g_return_if_fail (mux != NULL);
+
+  mux->bitrate = bitrate;
+  mux->first_pcr = -1;
+  mux->last_dts = -1;
+  mux->n_bytes = 0;
+  mux->behind = FALSE;
+}
+
+/**
+ * tsmux_get_bitrate:
+ * @mux: a #TsMux
+ *
+ * Get the configured output bitrate. See also tsmux_set_bitrate().
+ *
+ * Returns: the configured bitrate, 0 for a variable bitrate
+ */
+guint64
+tsmux_get_bitrate (TsMux * mux)
+{
+  g_return_val_if_fail (mux != NULL, 0);
+
+  return mux->bitrate;
+}
+
+/**
+ * tsmux_set_mux_delay:
+ * @mux: a #TsMux
+ * @delay: a new mux delay
+ *
+ * Set how long (in cycles of the 90kHz clock) before its DTS the data of a
+ * stream can be output at a constant bitrate. A longer delay lets large
+ * frames be spread over more of the output, at the cost of latency and of
+ * decoder buffering.
+ */
+void
+tsmux_set_mux_delay (TsMux * mux, guint delay)
+{
+  g_return_if_fail (mux != NULL);
+
+  mux->mux_delay = delay;
+}
+
+/**
+ * tsmux_get_mux_delay:
+ * @mux: a #TsMux
+ *
+ * Get the configured mux delay. See also tsmux_set_mux_delay().
+ *
+ * Returns: the configured mux delay
+ */
+guint
+tsmux_get_mux_delay (TsMux * mux)
+{
+  g_return_val_if_fail (mux != NULL, 0);
+
+  return mux->mux_delay;
+}
+
+/**
+ * tsmux_get_n_overruns:
+ * @mux: a #TsMux
+ *
+ * Get how many times the CBR output fell behind the timestamps of the
+ * streams, which happens when the configured bitrate is too low.
+ *
+ * Returns: the number of overruns since @mux was created
+ */
+guint
+tsmux_get_n_overruns (TsMux * mux)
+{
+  g_return_val_if_fail (mux != NULL, 0);
+
+  return mux->n_overruns;
+}
+
 /**
  * tsmux_set_si_interval:
  * @mux: a #TsMux
@@ -565,33 +688,64 @@ tsmux_find_stream (TsMux * mux, guint16 pid)
   return found;
 }
 
+static guint8 *
+tsmux_get_packet (TsMux * mux)
+{
+  if (G_UNLIKELY (!mux->alloc_func))
+    return NULL;
+
+  return mux->alloc_func (mux->alloc_func_data);
+}
+
 static gboolean
-tsmux_get_buffer (TsMux * mux, GstBuffer ** buf)
+tsmux_packet_out (TsMux * mux, guint8 * packet, gint64 pcr)
 {
-  g_return_val_if_fail (buf, FALSE);
+  gboolean res = TRUE;
 
-  if (G_UNLIKELY (!mux->alloc_func))
-    return FALSE;
+  if (G_LIKELY (mux->write_func != NULL))
+    res = mux->write_func (packet, mux->write_func_data, pcr);
 
-  mux->alloc_func (buf, mux->alloc_func_data);
+  /* only once written, for tsmux_get_current_time() to refer to the start
+   * of the packet while it is */
+  mux->n_bytes += TSMUX_PACKET_LENGTH;
 
-  if (!*buf)
-    return FALSE;
+  return res;
+}
 
-  g_assert (gst_buffer_get_size (*buf) == TSMUX_PACKET_LENGTH);
-  return TRUE;
+/* The PCR matching the current output position in CBR mode, -1 otherwise */
+static gint64
+tsmux_get_current_pcr (TsMux * mux)
+{
+  if (mux->bitrate == 0 || mux->first_pcr == -1)
+    return -1;
+
+  return mux->first_pcr + gst_util_uint64_scale (mux->n_bytes * 8,
+      TSMUX_SYS_CLOCK_FREQ, mux->bitrate);
 }
 
-static gboolean
-tsmux_packet_out (TsMux * mux, GstBuffer * buf, gint64 pcr)
+/**
+ * tsmux_get_current_time:
+ * @mux: a #TsMux
+ *
+ * In CBR mode, get the time at which the packet being written is to be
+ * output, in cycles of the 27MHz clock on the timeline of the stream
+ * timestamps. This is meant to be called from the write function.
+ *
+ * Returns: the output time of the current packet, or -1 if unknown
+ */
+gint64
+tsmux_get_current_time (TsMux * mux)
 {
-  if (G_UNLIKELY (mux->write_func == NULL)) {
-    if (buf)
-      gst_buffer_unref (buf);
-    return TRUE;
-  }
+  gint64 pcr;
+
+  g_return_val_if_fail (mux != NULL, -1);
+
+  pcr = tsmux_get_current_pcr (mux);
+  if (pcr == -1)
+    return -1;
 
-  return mux->write_func (buf, mux->write_func_data, pcr);
+  return pcr - (CLOCK_BASE - mux->mux_delay) *
+      (TSMUX_SYS_CLOCK_FREQ / TSMUX_CLOCK_FREQ);
 }
 
 /*
@@ -845,9 +999,6 @@ static gboolean
 tsmux_section_write_packet (GstMpegtsSectionType * type,
     TsMuxSection * section, TsMux * mux)
 {
-  GstBuffer *section_buffer;
-  GstBuffer *packet_buffer = NULL;
-  GstMemory *mem;
   guint8 *packet;
   guint8 *data;
   gsize data_size = 0;
@@ -871,24 +1022,20 @@ tsmux_section_write_packet (GstMpegtsSectionType * type,
   section->pi.stream_avail = data_size;
   payload_written = 0;
 
-  /* Wrap section data in a buffer without free function.
-     The data will be freed when the GstMpegtsSection is destroyed. */
-  section_buffer = gst_buffer_new_wrapped_full (GST_MEMORY_FLAG_READONLY,
-      data, data_size, 0, data_size, NULL, NULL);
-
-  TS_DEBUG ("Section buffer with size %" G_GSIZE_FORMAT " created",
-      gst_buffer_get_size (section_buffer));
+  TS_DEBUG ("Section data with size %" G_GSIZE_FORMAT " created", data_size);
 
   while (section->pi.stream_avail > 0) {
 
-    packet = g_malloc (TSMUX_PACKET_LENGTH);
+    packet = tsmux_get_packet (mux);
+    if (G_UNLIKELY (packet == NULL))
+      return FALSE;
 
     if (section->pi.packet_start_unit_indicator) {
       /* Wee need room for a pointer byte */
       section->pi.stream_avail++;
 
       if (!tsmux_write_ts_header (packet, &section->pi, &len, &offset))
-        goto fail;
+        return FALSE;
 
       /* Write the pointer byte */
       packet[offset++] = 0x00;
@@ -896,50 +1043,29 @@ tsmux_section_write_packet (GstMpegtsSectionType * type,
 
     } else {
       if (!tsmux_write_ts_header (packet, &section->pi, &len, &offset))
-        goto fail;
+        return FALSE;
       payload_len = len;
     }
 
-    /* Wrap the TS header and adaption field in a GstMemory */
-    mem = gst_memory_new_wrapped (GST_MEMORY_FLAG_READONLY,
-        packet, TSMUX_PACKET_LENGTH, 0, offset, packet, g_free);
-
-    TS_DEBUG ("Creating packet buffer at offset "
+    TS_DEBUG ("Copying section data at offset "
         "%" G_GSIZE_FORMAT " with length %u", payload_written, payload_len);
 
-    packet_buffer = gst_buffer_copy_region (section_buffer, GST_BUFFER_COPY_ALL,
-        payload_written, payload_len);
-
-    /* Prepend the header to the section data */
-    gst_buffer_prepend_memory (packet_buffer, mem);
+    /* The header is followed by the section data */
+    memcpy (packet + offset, data + payload_written, payload_len);
 
     TS_DEBUG ("Writing %d bytes to section. %d bytes remaining",
         len, section->pi.stream_avail - len);
 
     /* Push the packet without PCR */
-    if G_UNLIKELY
-      (!tsmux_packet_out (mux, packet_buffer, -1)) {
-      /* Buffer given away */
-      packet_buffer = NULL;
-      goto fail;
-      }
+    if (G_UNLIKELY (!tsmux_packet_out (mux, packet, -1)))
+      return FALSE;
 
-    packet_buffer = NULL;
     section->pi.stream_avail -= len;
     payload_written += payload_len;
     section->pi.packet_start_unit_indicator = FALSE;
   }
 
-  gst_buffer_unref (section_buffer);
-
   return TRUE;
-
-fail:
-  if (packet)
-    g_free (packet);
-  if (section_buffer)
-    gst_buffer_unref (section_buffer);
-  return FALSE;
 }
 
 static gboolean
@@ -954,6 +1080,146 @@ tsmux_write_si (TsMux * mux)
 
 }
 
+static gboolean
+tsmux_write_null_packet (TsMux * mux)
+{
+  guint8 *packet;
+
+  packet = tsmux_get_packet (mux);
+  if (G_UNLIKELY (packet == NULL))
+    return FALSE;
+
+  packet[0] = TSMUX_SYNC_BYTE;
+  /* null packet PID */
+  packet[1] = 0x1f;
+  packet[2] = 0xff;
+  /* payload only, continuity counter undefined */
+  packet[3] = 0x10;
+  memset (packet + TSMUX_HEADER_LENGTH, 0xff, TSMUX_PAYLOAD_LENGTH);
+
+  return tsmux_packet_out (mux, packet, -1);
+}
+
+/* Writes a packet carrying nothing but @pcr for @stream */
+static gboolean
+tsmux_write_pcr_packet (TsMux * mux, TsMuxStream * stream, gint64 pcr)
+{
+  TsMuxPacketInfo pi = { 0, };
+  guint payload_len, payload_offs;
+  guint8 *packet;
+
+  pi.pid = stream->pi.pid;
+  /* without payload, the continuity counter is the one of the previous
+   * packet */
+  pi.packet_count = stream->pi.packet_count - 1;
+  pi.flags = TSMUX_PACKET_FLAG_ADAPTATION | TSMUX_PACKET_FLAG_WRITE_PCR;
+  if (stream->pcr_discont) {
+    pi.flags |= TSMUX_PACKET_FLAG_DISCONT;
+    stream->pcr_discont = FALSE;
+  }
+  pi.pcr = pcr;
+  pi.stream_avail = 0;
+
+  packet = tsmux_get_packet (mux);
+  if (G_UNLIKELY (packet == NULL))
+    return FALSE;
+
+  if (!tsmux_write_ts_header (packet, &pi, &payload_len, &payload_offs))
+    return FALSE;
+
+  stream->last_pcr = pcr;
+
+  return tsmux_packet_out (mux, packet, pcr);
+}
+
+/* In CBR mode, stuffs the output until the data with @dts is due, mux_delay
+ * before it. Null packets are used, or packets carrying only a PCR when one
+ * is due for a program. The streams are written in timestamp order, so no
+ * other stream has data due while stuffing. */
+static gboolean
+tsmux_pad_stream (TsMux * mux, gint64 dts)
+{
+  gint64 pcr, cur_pcr, last_dts, pcr_interval;
+  GList *cur;
+
+  pcr = (dts + CLOCK_BASE - mux->mux_delay) *
+      (TSMUX_SYS_CLOCK_FREQ / TSMUX_CLOCK_FREQ);
+  last_dts = mux->last_dts;
+  mux->last_dts = dts;
+
+  if (mux->first_pcr == -1) {
+    TS_DEBUG ("Starting CBR output at PCR %" G_GINT64_FORMAT, pcr);
+    mux->first_pcr = pcr;
+    mux->n_bytes = 0;
+    return TRUE;
+  }
+
+  cur_pcr = tsmux_get_current_pcr (mux);
+
+  /* The DTS of the streams interleave closely, unlike their PTS which are
+   * reordered, and unlike the output position when it is ahead or behind */
+  if (last_dts != -1 && ABS (dts - last_dts) > TSMUX_CLOCK_FREQ) {
+    /* Rather than a second or more worth of stuffing, restart from there */
+    TS_DEBUG ("Timestamp jump, restarting CBR output at PCR %"
+        G_GINT64_FORMAT " (was at %" G_GINT64_FORMAT ")", pcr, cur_pcr);
+    mux->first_pcr = pcr;
+    mux->n_bytes = 0;
+    mux->behind = FALSE;
+
+    /* The time base jumps, signal it on the next PCR of each program */
+    for (cur = mux->programs; cur; cur = cur->next) {
+      TsMuxProgram *program = (TsMuxProgram *) cur->data;
+
+      if (program->pcr_stream) {
+        program->pcr_stream->last_pcr = -1;
+        program->pcr_stream->pcr_discont = TRUE;
+      }
+    }
+    return TRUE;
+  }
+
+  /* past the DTS itself */
+  if (cur_pcr - pcr > mux->mux_delay * (TSMUX_SYS_CLOCK_FREQ /
+          TSMUX_CLOCK_FREQ)) {
+    if (!mux->behind) {
+      TS_DEBUG ("Output is %" G_GINT64_FORMAT " behind, bitrate too low",
+          cur_pcr - pcr);
+      mux->behind = TRUE;
+      mux->n_overruns++;
+    }
+  } else {
+    mux->behind = FALSE;
+  }
+
+  pcr_interval = mux->pcr_interval * (TSMUX_SYS_CLOCK_FREQ / TSMUX_CLOCK_FREQ);
+
+  while (cur_pcr < pcr) {
+    TsMuxStream *pcr_stream = NULL;
+
+    for (cur = mux->programs; cur; cur = cur->next) {
+      TsMuxProgram *program = (TsMuxProgram *) cur->data;
+
+      if (program->pcr_stream && program->pcr_stream->last_pcr != -1 &&
+          cur_pcr - program->pcr_stream->last_pcr >= pcr_interval) {
+        pcr_stream = program->pcr_stream;
+        break;
+      }
+    }
+
+    if (pcr_stream) {
+      if (!tsmux_write_pcr_packet (mux, pcr_stream, cur_pcr))
+        return FALSE;
+    } else {
+      if (!tsmux_write_null_packet (mux))
+        return FALSE;
+    }
+
+    cur_pcr = tsmux_get_current_pcr (mux);
+  }
+
+  return TRUE;
+}
+
 /**
  * tsmux_write_stream_packet:
  * @mux: a #TsMux
@@ -970,12 +1236,19 @@ tsmux_write_stream_packet (TsMux * mux, TsMuxStream * stream)
   TsMuxPacketInfo *pi = &stream->pi;
   gboolean res;
   gint64 cur_pcr = -1;
-  GstBuffer *buf = NULL;
-  GstMapInfo map;
+  guint8 *packet;
 
   g_return_val_if_fail (mux != NULL, FALSE);
   g_return_val_if_fail (stream != NULL, FALSE);
 
+  if (mux->bitrate) {
+    gint64 dts = tsmux_stream_get_dts (stream);
+
+    /* Hold the data back until the output catches up with its timestamp */
+    if (dts != -1 && !tsmux_pad_stream (mux, dts))
+      return FALSE;
+  }
+
   if (tsmux_stream_is_pcr (stream)) {
     gint64 cur_pts = tsmux_stream_get_pts (stream);
     gboolean write_pat;
@@ -996,19 +1269,6 @@ tsmux_write_stream_packet (TsMux * mux, TsMuxStream * stream)
           (TSMUX_SYS_CLOCK_FREQ / TSMUX_CLOCK_FREQ);
     }
 
-    /* Need to decide whether to write a new PCR in this packet */
-    if (stream->last_pcr == -1 ||
-        (cur_pcr - stream->last_pcr >
-            (TSMUX_SYS_CLOCK_FREQ / TSMUX_DEFAULT_PCR_FREQ))) {
-
-      stream->pi.flags |=
-          TSMUX_PACKET_FLAG_ADAPTATION | TSMUX_PACKET_FLAG_WRITE_PCR;
-      stream->pi.pcr = cur_pcr;
-      stream->last_pcr = cur_pcr;
-    } else {
-      cur_pcr = -1;
-    }
-
     /* check if we need to rewrite pat */
     if (mux->last_pat_ts == -1 || mux->pat_changed)
       write_pat = TRUE;
@@ -1055,6 +1315,28 @@ tsmux_write_stream_packet (TsMux * mux, TsMuxStream * stream)
           return FALSE;
       }
     }
+
+    /* In CBR mode, the PCR is where the packet lands in the output, which
+     * is only known now that the tables are written */
+    if (mux->bitrate && mux->first_pcr != -1)
+      cur_pcr = tsmux_get_current_pcr (mux);
+
+    /* Need to decide whether to write a new PCR in this packet */
+    if (stream->last_pcr == -1 ||
+        (cur_pcr - stream->last_pcr >
+            mux->pcr_interval * (TSMUX_SYS_CLOCK_FREQ / TSMUX_CLOCK_FREQ))) {
+
+      stream->pi.flags |=
+          TSMUX_PACKET_FLAG_ADAPTATION | TSMUX_PACKET_FLAG_WRITE_PCR;
+      if (stream->pcr_discont) {
+        stream->pi.flags |= TSMUX_PACKET_FLAG_DISCONT;
+        stream->pcr_discont = FALSE;
+      }
+      stream->pi.pcr = cur_pcr;
+      stream->last_pcr = cur_pcr;
+    } else {
+      cur_pcr = -1;
+    }
   }
 
   pi->packet_start_unit_indicator = tsmux_stream_at_pes_start (stream);
@@ -1067,36 +1349,23 @@ tsmux_write_stream_packet (TsMux * mux, TsMuxStream * stream)
   }
   pi->stream_avail = tsmux_stream_bytes_avail (stream);
 
-  /* obtain buffer */
-  if (!tsmux_get_buffer (mux, &buf))
+  /* obtain room for the packet */
+  packet = tsmux_get_packet (mux);
+  if (!packet)
     return FALSE;
 
-  gst_buffer_map (buf, &map, GST_MAP_READ);
-
-  if (!tsmux_write_ts_header (map.data, pi, &payload_len, &payload_offs))
-    goto fail;
-
-
-  if (!tsmux_stream_get_data (stream, map.data + payload_offs, payload_len))
-    goto fail;
+  if (!tsmux_write_ts_header (packet, pi, &payload_len, &payload_offs))
+    return FALSE;
 
-  gst_buffer_unmap (buf, &map);
+  if (!tsmux_stream_get_data (stream, packet + payload_offs, payload_len))
+    return FALSE;
 
-  res = tsmux_packet_out (mux, buf, cur_pcr);
+  res = tsmux_packet_out (mux, packet, cur_pcr);
 
   /* Reset all dynamic flags */
   stream->pi.flags &= TSMUX_PACKET_FLAG_PES_FULL_HEADER;
 
   return res;
-
-  /* ERRORS */
-fail:
-  {
-    gst_buffer_unmap (buf, &map);
-    if (buf)
-      gst_buffer_unref (buf);
-    return FALSE;
-  }
 }
 
 /**
@@ -100,8 +100,11 @@ G_BEGIN_DECLS
 typedef struct TsMuxSection TsMuxSection;
 typedef struct TsMux TsMux;
 
-typedef gboolean (*TsMuxWriteFunc) (GstBuffer * buf, void *user_data, gint64 new_pcr);
-typedef void (*TsMuxAllocFunc) (GstBuffer ** buf, void *user_data);
+/* Packets are written in place: the alloc func returns room for a packet of
+ * TSMUX_PACKET_LENGTH bytes (or NULL on error), and the write func is called
+ * with that same pointer once the packet is complete */
+typedef gboolean (*TsMuxWriteFunc) (guint8 * packet, void *user_data, gint64 new_pcr);
+typedef guint8 * (*TsMuxAllocFunc) (void *user_data);
 
 struct TsMuxSection {
   TsMuxPacketInfo pi;
@@ -169,6 +172,25 @@ struct TsMux {
   /* last time SIT written in MPEG PTS clock time */
   gint64   last_si_ts;
 
+  /* interval between PCRs in MPEG PTS clock time */
+  guint    pcr_interval;
+
+  /* output rate in bits per second, 0 for VBR */
+  guint64  bitrate;
+  /* CBR: PCR of the first byte of the output, -1 if not known yet */
+  gint64   first_pcr;
+  /* CBR: bytes written since first_pcr */
+  guint64  n_bytes;
+  /* CBR: how long before its DTS the data of a stream can be output, in
+   * MPEG PTS clock time */
+  guint    mux_delay;
+  /* CBR: DTS of the last data scheduled, -1 if none */
+  gint64   last_dts;
+  /* CBR: whether the output is behind the timestamps */
+  gboolean behind;
+  /* CBR: number of times the output fell behind the timestamps */
+  guint    n_overruns;
+
   /* callback to write finished packet */
   TsMuxWriteFunc write_func;
   void *write_func_data;
@@ -189,6 +211,13 @@ void 		tsmux_set_write_func 		(TsMux *mux, TsMuxWriteFunc func, void *user_data)
 void 		tsmux_set_alloc_func 		(TsMux *mux, TsMuxAllocFunc func, void *user_data);
 void 		tsmux_set_pat_interval          (TsMux *mux, guint interval);
 guint 		tsmux_get_pat_interval          (TsMux *mux);
+void 		tsmux_set_pcr_interval          (TsMux *mux, guint interval);
+guint 		tsmux_get_pcr_interval          (TsMux *mux);
+void 		tsmux_set_bitrate               (TsMux *mux, guint64 bitrate);
+guint64 	tsmux_get_bitrate               (TsMux *mux);
+void 		tsmux_set_mux_delay             (TsMux *mux, guint delay);
+guint 		tsmux_get_mux_delay             (TsMux *mux);
+guint 		tsmux_get_n_overruns            (TsMux *mux);
 guint16		tsmux_get_new_pid 		(TsMux *mux);
 
 /* pid/program management */
@@ -211,6 +240,7 @@ void 		tsmux_program_set_pcr_stream 	(TsMuxProgram *program, TsMuxStream *stream
 
 /* writing stuff */
 gboolean 	tsmux_write_stream_packet 	(TsMux *mux, TsMuxStream *stream);
+gint64 		tsmux_get_current_time 		(TsMux *mux);
 
 G_END_DECLS
 
@@ -121,6 +121,10 @@ G_BEGIN_DECLS
 #define TSMUX_DEFAULT_PMT_INTERVAL (TSMUX_CLOCK_FREQ / 10)
 /* SI  interval (1/10th sec) */
 #define TSMUX_DEFAULT_SI_INTERVAL  (TSMUX_CLOCK_FREQ / 10)
+/* PCR interval (1/25th sec) */
+#define TSMUX_DEFAULT_PCR_INTERVAL (TSMUX_CLOCK_FREQ / 25)
+/* CBR mux delay (1/8th sec) */
+#define TSMUX_DEFAULT_MUX_DELAY (TSMUX_CLOCK_FREQ / 8)
 
 typedef struct TsMuxPacketInfo TsMuxPacketInfo;
 typedef struct TsMuxProgram TsMuxProgram;
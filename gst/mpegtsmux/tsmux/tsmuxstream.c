@@ -200,6 +200,7 @@ tsmux_stream_new (guint16 pid, TsMuxStreamType stream_type)
 
   stream->pcr_ref = 0;
   stream->last_pcr = -1;
+  stream->pcr_discont = FALSE;
 
   return stream;
 }
@@ -960,3 +961,27 @@ tsmux_stream_get_pts (TsMuxStream * stream)
 
   return stream->last_pts;
 }
+
+/**
+ * tsmux_stream_get_dts:
+ * @stream: a #TsMuxStream
+ *
+ * Return the DTS of the buffer the next bytes of @stream are taken from, or
+ * its PTS when it has no DTS.
+ *
+ * Returns: the DTS of the next buffer in @stream, or -1 if unknown.
+ */
+gint64
+tsmux_stream_get_dts (TsMuxStream * stream)
+{
+  TsMuxStreamBuffer *buf;
+
+  g_return_val_if_fail (stream != NULL, -1);
+
+  if (stream->buffers == NULL)
+    return -1;
+
+  buf = (TsMuxStreamBuffer *) stream->buffers->data;
+
+  return buf->dts != -1 ? buf->dts : buf->pts;
+}
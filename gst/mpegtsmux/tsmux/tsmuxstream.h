@@ -197,6 +197,8 @@ struct TsMuxStream {
   gint   pcr_ref;
   /* last time PCR written */
   gint64 last_pcr;
+  /* next PCR is discontinuous with the previous one */
+  gboolean pcr_discont;
 
   /* audio parameters for stream
    * (used in stream descriptor) */
@@ -236,6 +238,7 @@ gboolean 	tsmux_stream_initialize_pes_packet (TsMuxStream *stream);
 gboolean 	tsmux_stream_get_data 		(TsMuxStream *stream, guint8 *buf, guint len);
 
 guint64 	tsmux_stream_get_pts 		(TsMuxStream *stream);
+gint64 		tsmux_stream_get_dts 		(TsMuxStream *stream);
 
 G_END_DECLS
 
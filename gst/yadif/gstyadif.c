@@ -26,6 +26,12 @@
  * inverse telecine and deinterlace cases that are handled by the
  * deinterlace element.
  *
+ * Each frame is deinterlaced using the previous and the next frames, so it
+ * is output once the next frame arrives, and the field order is taken from
+ * the buffer flags. With #GstYadif:double-rate, one frame is output for each
+ * field, at twice the input frame rate. The lines of the frames are filtered
+ * on #GstYadif:n-threads threads.
+ *
  * <refsect2>
  * <title>Example launch line</title>
  * |[
@@ -66,16 +72,24 @@ static gboolean gst_yadif_get_unit_size (GstBaseTransform * trans,
     GstCaps * caps, gsize * size);
 static gboolean gst_yadif_start (GstBaseTransform * trans);
 static gboolean gst_yadif_stop (GstBaseTransform * trans);
+static gboolean gst_yadif_sink_event (GstBaseTransform * trans,
+    GstEvent * event);
+static gboolean gst_yadif_query (GstBaseTransform * trans,
+    GstPadDirection direction, GstQuery * query);
 static GstFlowReturn gst_yadif_transform (GstBaseTransform * trans,
     GstBuffer * inbuf, GstBuffer * outbuf);
 
 enum
 {
   PROP_0,
-  PROP_MODE
+  PROP_MODE,
+  PROP_DOUBLE_RATE,
+  PROP_N_THREADS
 };
 
 #define DEFAULT_MODE GST_DEINTERLACE_MODE_AUTO
+#define DEFAULT_DOUBLE_RATE FALSE
+#define DEFAULT_N_THREADS 0
 
 /* pad templates */
 
@@ -151,6 +165,8 @@ gst_yadif_class_init (GstYadifClass * klass)
       GST_DEBUG_FUNCPTR (gst_yadif_get_unit_size);
   base_transform_class->start = GST_DEBUG_FUNCPTR (gst_yadif_start);
   base_transform_class->stop = GST_DEBUG_FUNCPTR (gst_yadif_stop);
+  base_transform_class->sink_event = GST_DEBUG_FUNCPTR (gst_yadif_sink_event);
+  base_transform_class->query = GST_DEBUG_FUNCPTR (gst_yadif_query);
   base_transform_class->transform = GST_DEBUG_FUNCPTR (gst_yadif_transform);
 
   g_object_class_install_property (gobject_class, PROP_MODE,
@@ -160,11 +176,24 @@ gst_yadif_class_init (GstYadifClass * klass)
           DEFAULT_MODE,
           G_PARAM_READWRITE | G_PARAM_CONSTRUCT | G_PARAM_STATIC_STRINGS));
 
+  g_object_class_install_property (gobject_class, PROP_DOUBLE_RATE,
+      g_param_spec_boolean ("double-rate", "Double rate",
+          "Output one frame per field, at twice the input frame rate",
+          DEFAULT_DOUBLE_RATE, G_PARAM_READWRITE | GST_PARAM_MUTABLE_READY |
+          G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_N_THREADS,
+      g_param_spec_uint ("n-threads", "Number of threads",
+          "Number of threads filtering bands of the frames "
+          "(0 = number of processors)", 0, G_MAXUINT, DEFAULT_N_THREADS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 }
 
 static void
 gst_yadif_init (GstYadif * yadif)
 {
+  yadif->double_rate = DEFAULT_DOUBLE_RATE;
+  yadif->n_threads = DEFAULT_N_THREADS;
 }
 
 void
@@ -177,6 +206,14 @@ gst_yadif_set_property (GObject * object, guint property_id,
     case PROP_MODE:
       yadif->mode = g_value_get_enum (value);
       break;
+    case PROP_DOUBLE_RATE:
+      yadif->double_rate = g_value_get_boolean (value);
+      break;
+    case PROP_N_THREADS:
+      GST_OBJECT_LOCK (yadif);
+      yadif->n_threads = g_value_get_uint (value);
+      GST_OBJECT_UNLOCK (yadif);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
       break;
@@ -193,6 +230,14 @@ gst_yadif_get_property (GObject * object, guint property_id,
     case PROP_MODE:
       g_value_set_enum (value, yadif->mode);
       break;
+    case PROP_DOUBLE_RATE:
+      g_value_set_boolean (value, yadif->double_rate);
+      break;
+    case PROP_N_THREADS:
+      GST_OBJECT_LOCK (yadif);
+      g_value_set_uint (value, yadif->n_threads);
+      GST_OBJECT_UNLOCK (yadif);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
       break;
@@ -212,22 +257,76 @@ gst_yadif_dispose (GObject * object)
 void
 gst_yadif_finalize (GObject * object)
 {
-  /* GstYadif *yadif = GST_YADIF (object); */
+  GstYadif *yadif = GST_YADIF (object);
 
-  /* clean up object here */
+  if (yadif->task_runner)
+    gst_parallelized_task_runner_free (yadif->task_runner);
+  yadif->task_runner = NULL;
 
   G_OBJECT_CLASS (gst_yadif_parent_class)->finalize (object);
 }
 
 
+/* Doubles the framerate of the sink caps, or halves the one of the src
+ * caps, for the field rate output */
+static void
+gst_yadif_scale_framerate (GstStructure * structure, gboolean up)
+{
+  const GValue *value = gst_structure_get_value (structure, "framerate");
+  gint num = up ? 2 : 1;
+  gint den = up ? 1 : 2;
+  gint n, d, n2, d2;
+
+  if (value == NULL)
+    return;
+
+  if (GST_VALUE_HOLDS_FRACTION (value)) {
+    n = gst_value_get_fraction_numerator (value);
+    d = gst_value_get_fraction_denominator (value);
+    if (!gst_util_fraction_multiply (n, d, num, den, &n, &d)) {
+      n = G_MAXINT;
+      d = 1;
+    }
+    gst_structure_set (structure, "framerate", GST_TYPE_FRACTION, n, d, NULL);
+  } else if (GST_VALUE_HOLDS_FRACTION_RANGE (value)) {
+    const GValue *min = gst_value_get_fraction_range_min (value);
+    const GValue *max = gst_value_get_fraction_range_max (value);
+
+    n = gst_value_get_fraction_numerator (min);
+    d = gst_value_get_fraction_denominator (min);
+    n2 = gst_value_get_fraction_numerator (max);
+    d2 = gst_value_get_fraction_denominator (max);
+    gst_util_fraction_multiply (n, d, num, den, &n, &d);
+    if (!gst_util_fraction_multiply (n2, d2, num, den, &n2, &d2)) {
+      n2 = G_MAXINT;
+      d2 = 1;
+    }
+    gst_structure_set (structure, "framerate", GST_TYPE_FRACTION_RANGE, n, d,
+        n2, d2, NULL);
+  } else {
+    gst_structure_remove_field (structure, "framerate");
+  }
+}
+
 static GstCaps *
 gst_yadif_transform_caps (GstBaseTransform * trans,
     GstPadDirection direction, GstCaps * caps, GstCaps * filter)
 {
+  GstYadif *yadif = GST_YADIF (trans);
   GstCaps *othercaps;
+  guint i;
 
   othercaps = gst_caps_copy (caps);
 
+  if (yadif->mode == GST_DEINTERLACE_MODE_DISABLED)
+    return othercaps;
+
+  if (yadif->double_rate) {
+    for (i = 0; i < gst_caps_get_size (othercaps); i++)
+      gst_yadif_scale_framerate (gst_caps_get_structure (othercaps, i),
+          direction == GST_PAD_SINK);
+  }
+
   if (direction == GST_PAD_SRC) {
     GValue value = G_VALUE_INIT;
     GValue v = G_VALUE_INIT;
@@ -258,8 +357,17 @@ gst_yadif_set_caps (GstBaseTransform * trans, GstCaps * incaps,
     GstCaps * outcaps)
 {
   GstYadif *yadif = GST_YADIF (trans);
+  gboolean passthrough;
+
+  if (!gst_video_info_from_caps (&yadif->video_info, incaps))
+    return FALSE;
 
-  gst_video_info_from_caps (&yadif->video_info, incaps);
+  yadif->fields = yadif->double_rate &&
+      yadif->mode != GST_DEINTERLACE_MODE_DISABLED;
+  passthrough = yadif->mode == GST_DEINTERLACE_MODE_DISABLED ||
+      (yadif->mode == GST_DEINTERLACE_MODE_AUTO && !yadif->fields &&
+      !GST_VIDEO_INFO_IS_INTERLACED (&yadif->video_info));
+  gst_base_transform_set_passthrough (trans, passthrough);
 
   return TRUE;
 }
@@ -277,9 +385,17 @@ gst_yadif_get_unit_size (GstBaseTransform * trans, GstCaps * caps, gsize * size)
   return FALSE;
 }
 
+static void
+gst_yadif_reset (GstYadif * yadif)
+{
+  gst_buffer_replace (&yadif->prev_buf, NULL);
+  gst_buffer_replace (&yadif->cur_buf, NULL);
+}
+
 static gboolean
 gst_yadif_start (GstBaseTransform * trans)
 {
+  gst_yadif_reset (GST_YADIF (trans));
 
   return TRUE;
 }
@@ -287,57 +403,330 @@ gst_yadif_start (GstBaseTransform * trans)
 static gboolean
 gst_yadif_stop (GstBaseTransform * trans)
 {
+  gst_yadif_reset (GST_YADIF (trans));
 
   return TRUE;
 }
 
-void yadif_filter (GstYadif * yadif, int parity, int tff);
+void yadif_init (void);
+void yadif_filter (GstYadif * yadif, int parity, int tff, int y_start,
+    int y_end);
 
-static GstFlowReturn
-gst_yadif_transform (GstBaseTransform * trans, GstBuffer * inbuf,
-    GstBuffer * outbuf)
+typedef struct
 {
-  GstYadif *yadif = GST_YADIF (trans);
+  GstYadif *yadif;
   int parity;
   int tff;
+  int y_start;
+  int y_end;
+} YadifBand;
 
-  parity = 0;
-  tff = 0;
+static void
+gst_yadif_filter_band (YadifBand * band)
+{
+  yadif_filter (band->yadif, band->parity, band->tff, band->y_start,
+      band->y_end);
+}
+
+/* Filters dest_frame in bands of lines on the threads of the task runner */
+static void
+gst_yadif_filter (GstYadif * yadif, int parity, int tff)
+{
+  YadifBand *bands;
+  gpointer *tasks;
+  guint n_threads, n_bands, band_height, height, i;
+
+  GST_OBJECT_LOCK (yadif);
+  n_threads = yadif->n_threads;
+  GST_OBJECT_UNLOCK (yadif);
+
+  /* the task runner is only used from the streaming thread */
+  if (gst_parallelized_task_runner_update (&yadif->task_runner, n_threads)) {
+    GST_DEBUG_OBJECT (yadif, "Filtering with %u threads",
+        gst_parallelized_task_runner_get_n_threads (yadif->task_runner));
+  }
+
+  /* even bands, so that the chroma lines are split the same way */
+  height = GST_VIDEO_INFO_HEIGHT (&yadif->video_info);
+  n_bands = gst_parallelized_task_runner_get_n_threads (yadif->task_runner);
+  band_height = GST_ROUND_UP_2 ((height + n_bands - 1) / n_bands);
+
+  bands = g_newa (YadifBand, n_bands);
+  tasks = g_newa (gpointer, n_bands);
+  for (i = 0; i < n_bands; i++) {
+    bands[i].yadif = yadif;
+    bands[i].parity = parity;
+    bands[i].tff = tff;
+    bands[i].y_start = MIN (i * band_height, height);
+    bands[i].y_end = MIN ((i + 1) * band_height, height);
+    tasks[i] = &bands[i];
+  }
 
+  gst_parallelized_task_runner_run (yadif->task_runner,
+      (GstParallelizedTaskFunc) gst_yadif_filter_band, tasks, n_bands);
+}
+
+/* Outputs the first or second field of the mapped cur_frame into outbuf,
+ * at pts for duration */
+static GstFlowReturn
+gst_yadif_output_field (GstYadif * yadif, GstBuffer * outbuf,
+    gboolean interlaced, gboolean tff, gboolean second, GstClockTime pts,
+    GstClockTime duration)
+{
   if (!gst_video_frame_map (&yadif->dest_frame, &yadif->video_info, outbuf,
-          GST_MAP_WRITE))
-    goto dest_map_failed;
+          GST_MAP_WRITE)) {
+    GST_ERROR_OBJECT (yadif, "failed to map dest");
+    return GST_FLOW_ERROR;
+  }
+
+  /* the lines of the field shown first are kept in the first output frame,
+   * the others in the second one */
+  if (interlaced)
+    gst_yadif_filter (yadif, tff ^ !second, tff);
+  else
+    gst_video_frame_copy (&yadif->dest_frame, &yadif->cur_frame);
+
+  gst_video_frame_unmap (&yadif->dest_frame);
+
+  GST_BUFFER_PTS (outbuf) = pts;
+  GST_BUFFER_DTS (outbuf) = GST_CLOCK_TIME_NONE;
+  GST_BUFFER_DURATION (outbuf) = duration;
+  GST_BUFFER_FLAG_UNSET (outbuf, GST_VIDEO_BUFFER_FLAG_INTERLACED |
+      GST_VIDEO_BUFFER_FLAG_TFF | GST_VIDEO_BUFFER_FLAG_RFF |
+      GST_VIDEO_BUFFER_FLAG_ONEFIELD);
+  if (second || !GST_BUFFER_FLAG_IS_SET (yadif->cur_buf,
+          GST_BUFFER_FLAG_DISCONT))
+    GST_BUFFER_FLAG_UNSET (outbuf, GST_BUFFER_FLAG_DISCONT);
+  else
+    GST_BUFFER_FLAG_SET (outbuf, GST_BUFFER_FLAG_DISCONT);
+
+  return GST_FLOW_OK;
+}
+
+/* Deinterlaces cur_buf into outbuf, using next, or cur_buf itself at the
+ * end of the stream. With double-rate, the first field goes into another
+ * buffer pushed right away. */
+static GstFlowReturn
+gst_yadif_deinterlace (GstYadif * yadif, GstBuffer * next, GstBuffer * outbuf)
+{
+  GstBaseTransform *trans = GST_BASE_TRANSFORM (yadif);
+  GstBuffer *cur = yadif->cur_buf;
+  GstBuffer *prev = yadif->prev_buf ? yadif->prev_buf : cur;
+  GstBuffer *first = NULL;
+  GstClockTime pts, duration;
+  gboolean interlaced, tff;
+  GstFlowReturn ret;
+
+  if (next == NULL)
+    next = cur;
+
+  pts = GST_BUFFER_PTS (cur);
+  duration = GST_BUFFER_DURATION (cur);
+  if (!GST_CLOCK_TIME_IS_VALID (duration)) {
+    if (next != cur && GST_CLOCK_TIME_IS_VALID (pts) &&
+        GST_BUFFER_PTS_IS_VALID (next) && GST_BUFFER_PTS (next) > pts)
+      duration = GST_BUFFER_PTS (next) - pts;
+    else if (GST_VIDEO_INFO_FPS_N (&yadif->video_info) > 0)
+      duration = gst_util_uint64_scale_int (GST_SECOND,
+          GST_VIDEO_INFO_FPS_D (&yadif->video_info),
+          GST_VIDEO_INFO_FPS_N (&yadif->video_info));
+  }
+
+  interlaced = yadif->mode == GST_DEINTERLACE_MODE_INTERLACED ||
+      GST_VIDEO_INFO_INTERLACE_MODE (&yadif->video_info) ==
+      GST_VIDEO_INTERLACE_MODE_INTERLEAVED ||
+      GST_BUFFER_FLAG_IS_SET (cur, GST_VIDEO_BUFFER_FLAG_INTERLACED);
+  tff = GST_BUFFER_FLAG_IS_SET (cur, GST_VIDEO_BUFFER_FLAG_TFF);
+
+  if (yadif->fields) {
+    ret = GST_BASE_TRANSFORM_CLASS (gst_yadif_parent_class)->
+        prepare_output_buffer (trans, cur, &first);
+    if (ret != GST_FLOW_OK)
+      return ret;
+  }
 
-  if (!gst_video_frame_map (&yadif->cur_frame, &yadif->video_info, inbuf,
+  if (!gst_video_frame_map (&yadif->prev_frame, &yadif->video_info, prev,
           GST_MAP_READ))
     goto src_map_failed;
+  if (!gst_video_frame_map (&yadif->cur_frame, &yadif->video_info, cur,
+          GST_MAP_READ)) {
+    gst_video_frame_unmap (&yadif->prev_frame);
+    goto src_map_failed;
+  }
+  if (!gst_video_frame_map (&yadif->next_frame, &yadif->video_info, next,
+          GST_MAP_READ)) {
+    gst_video_frame_unmap (&yadif->prev_frame);
+    gst_video_frame_unmap (&yadif->cur_frame);
+    goto src_map_failed;
+  }
 
-  yadif->next_frame = yadif->cur_frame;
-  yadif->prev_frame = yadif->cur_frame;
-
-  yadif_filter (yadif, parity, tff);
+  if (first) {
+    GstClockTime half = GST_CLOCK_TIME_IS_VALID (duration) ? duration / 2 :
+        GST_CLOCK_TIME_NONE;
+
+    ret = gst_yadif_output_field (yadif, first, interlaced, tff, FALSE, pts,
+        half);
+    if (ret == GST_FLOW_OK)
+      ret = gst_yadif_output_field (yadif, outbuf, interlaced, tff, TRUE,
+          GST_CLOCK_TIME_IS_VALID (pts) && GST_CLOCK_TIME_IS_VALID (half) ?
+          pts + half : GST_CLOCK_TIME_NONE,
+          GST_CLOCK_TIME_IS_VALID (half) ? duration - half :
+          GST_CLOCK_TIME_NONE);
+  } else {
+    ret = gst_yadif_output_field (yadif, outbuf, interlaced, tff, FALSE, pts,
+        duration);
+  }
 
-  gst_video_frame_unmap (&yadif->dest_frame);
+  gst_video_frame_unmap (&yadif->prev_frame);
   gst_video_frame_unmap (&yadif->cur_frame);
-  return GST_FLOW_OK;
+  gst_video_frame_unmap (&yadif->next_frame);
 
-dest_map_failed:
-  {
-    GST_ERROR_OBJECT (yadif, "failed to map dest");
-    return GST_FLOW_ERROR;
+  if (first) {
+    if (ret == GST_FLOW_OK)
+      ret = gst_pad_push (GST_BASE_TRANSFORM_SRC_PAD (trans), first);
+    else
+      gst_buffer_unref (first);
   }
+
+  return ret;
+
 src_map_failed:
   {
     GST_ERROR_OBJECT (yadif, "failed to map src");
-    gst_video_frame_unmap (&yadif->dest_frame);
+    if (first)
+      gst_buffer_unref (first);
     return GST_FLOW_ERROR;
   }
 }
 
+/* Outputs the last frame, with no next frame */
+static GstFlowReturn
+gst_yadif_drain (GstYadif * yadif)
+{
+  GstBaseTransform *trans = GST_BASE_TRANSFORM (yadif);
+  GstBuffer *outbuf = NULL;
+  GstFlowReturn ret = GST_FLOW_OK;
+
+  if (yadif->cur_buf) {
+    ret = GST_BASE_TRANSFORM_CLASS (gst_yadif_parent_class)->
+        prepare_output_buffer (trans, yadif->cur_buf, &outbuf);
+    if (ret == GST_FLOW_OK)
+      ret = gst_yadif_deinterlace (yadif, NULL, outbuf);
+    if (ret == GST_FLOW_OK)
+      ret = gst_pad_push (GST_BASE_TRANSFORM_SRC_PAD (trans), outbuf);
+    else if (outbuf)
+      gst_buffer_unref (outbuf);
+  }
+  gst_yadif_reset (yadif);
+
+  return ret;
+}
+
+static gboolean
+gst_yadif_sink_event (GstBaseTransform * trans, GstEvent * event)
+{
+  GstYadif *yadif = GST_YADIF (trans);
+  GstFlowReturn ret = GST_FLOW_OK;
+
+  switch (GST_EVENT_TYPE (event)) {
+    case GST_EVENT_EOS:
+      ret = gst_yadif_drain (yadif);
+      break;
+    case GST_EVENT_CAPS:{
+      GstCaps *caps, *current;
+
+      /* the last frame is output in the old format */
+      gst_event_parse_caps (event, &caps);
+      current = gst_pad_get_current_caps (GST_BASE_TRANSFORM_SINK_PAD (trans));
+      if (current && !gst_caps_is_equal (caps, current))
+        ret = gst_yadif_drain (yadif);
+      if (current)
+        gst_caps_unref (current);
+      break;
+    }
+    case GST_EVENT_FLUSH_STOP:
+      gst_yadif_reset (yadif);
+      break;
+    default:
+      break;
+  }
+
+  /* the event does not go through when the last frame could not be pushed,
+   * an EOS still does when downstream is done already */
+  if (ret != GST_FLOW_OK && !(ret == GST_FLOW_EOS &&
+          GST_EVENT_TYPE (event) == GST_EVENT_EOS)) {
+    GST_DEBUG_OBJECT (yadif, "Draining failed: %s", gst_flow_get_name (ret));
+    if (ret == GST_FLOW_NOT_LINKED || ret < GST_FLOW_EOS) {
+      GST_ELEMENT_ERROR (yadif, STREAM, FAILED,
+          ("Internal data flow error."),
+          ("Failed to push the last frame, reason %s (%d)",
+              gst_flow_get_name (ret), ret));
+    }
+    gst_event_unref (event);
+    return FALSE;
+  }
+
+  return GST_BASE_TRANSFORM_CLASS (gst_yadif_parent_class)->sink_event (trans,
+      event);
+}
+
+/* Frames are delayed until the next one arrives */
+static gboolean
+gst_yadif_query (GstBaseTransform * trans, GstPadDirection direction,
+    GstQuery * query)
+{
+  GstYadif *yadif = GST_YADIF (trans);
+  gboolean ret;
+
+  ret = GST_BASE_TRANSFORM_CLASS (gst_yadif_parent_class)->query (trans,
+      direction, query);
+
+  if (ret && direction == GST_PAD_SRC &&
+      GST_QUERY_TYPE (query) == GST_QUERY_LATENCY &&
+      !gst_base_transform_is_passthrough (trans) &&
+      GST_VIDEO_INFO_FPS_N (&yadif->video_info) > 0) {
+    GstClockTime min, max, latency;
+    gboolean live;
+
+    latency = gst_util_uint64_scale_int (GST_SECOND,
+        GST_VIDEO_INFO_FPS_D (&yadif->video_info),
+        GST_VIDEO_INFO_FPS_N (&yadif->video_info));
+    gst_query_parse_latency (query, &live, &min, &max);
+    min += latency;
+    if (GST_CLOCK_TIME_IS_VALID (max))
+      max += latency;
+    gst_query_set_latency (query, live, min, max);
+  }
+
+  return ret;
+}
+
+static GstFlowReturn
+gst_yadif_transform (GstBaseTransform * trans, GstBuffer * inbuf,
+    GstBuffer * outbuf)
+{
+  GstYadif *yadif = GST_YADIF (trans);
+  GstFlowReturn ret;
+
+  /* the first frame waits for the next one */
+  if (yadif->cur_buf == NULL) {
+    yadif->cur_buf = gst_buffer_ref (inbuf);
+    return GST_BASE_TRANSFORM_FLOW_DROPPED;
+  }
+
+  ret = gst_yadif_deinterlace (yadif, inbuf, outbuf);
+
+  gst_buffer_replace (&yadif->prev_buf, yadif->cur_buf);
+  gst_buffer_replace (&yadif->cur_buf, inbuf);
+
+  return ret;
+}
+
 
 static gboolean
 plugin_init (GstPlugin * plugin)
 {
+  yadif_init ();
 
   return gst_element_register (plugin, "yadif", GST_RANK_NONE, GST_TYPE_YADIF);
 }
@@ -23,6 +23,7 @@
 
 #include <gst/base/gstbasetransform.h>
 #include <gst/video/video.h>
+#include <gst/video/gstparallelizedtaskrunner.h>
 
 G_BEGIN_DECLS
 
@@ -46,8 +47,19 @@ struct _GstYadif
   GstBaseTransform base_yadif;
 
   GstDeinterlaceMode mode;
+  gboolean double_rate;
+  guint n_threads;
 
   GstVideoInfo video_info;
+  /* output rate of the negotiated caps */
+  gboolean fields;
+
+  /* the frame being deinterlaced once the next one arrives, and the one
+   * before it */
+  GstBuffer *prev_buf;
+  GstBuffer *cur_buf;
+
+  GstParallelizedTaskRunner *task_runner;
 
   GstVideoFrame prev_frame;
   GstVideoFrame cur_frame;
@@ -112,15 +112,73 @@ filter_line_c_16bit (guint16 * dst,
 FILTER}
 #endif
 
-void yadif_filter (GstYadif * yadif, int parity, int tff);
+typedef void (*YadifFilterLineFunc) (guint8 * dst,
+    guint8 * prev, guint8 * cur, guint8 * next,
+    int w, int prefs, int mrefs, int parity, int mode);
+
+void yadif_init (void);
+void yadif_filter (GstYadif * yadif, int parity, int tff, int y_start,
+    int y_end);
 #ifdef HAVE_CPU_X86_64
 void filter_line_x86_64 (guint8 * dst,
     guint8 * prev, guint8 * cur, guint8 * next,
     int w, int prefs, int mrefs, int parity, int mode);
+void filter_line_avx2 (guint8 * dst,
+    guint8 * prev, guint8 * cur, guint8 * next,
+    int w, int prefs, int mrefs, int parity, int mode);
+gboolean yadif_have_avx2 (void);
 #endif
 
+/* The SIMD version of the filter and the number of pixels it does at once,
+ * the rest of the line is done by the C version */
+static YadifFilterLineFunc filter_line_simd;
+static int filter_line_step;
+
+/* Picks the fastest implementation the processor supports. GST_YADIF_IMPL
+ * can be set to "c", "sse2" or "avx2" to force one (for comparing them) */
 void
-yadif_filter (GstYadif * yadif, int parity, int tff)
+yadif_init (void)
+{
+  const gchar *impl = g_getenv ("GST_YADIF_IMPL");
+
+  filter_line_simd = NULL;
+  filter_line_step = 1;
+#ifdef HAVE_CPU_X86_64
+  if (!g_strcmp0 (impl, "c"))
+    return;
+
+  filter_line_simd = filter_line_x86_64;
+  filter_line_step = 8;
+  if (g_strcmp0 (impl, "sse2") && yadif_have_avx2 ()) {
+    filter_line_simd = filter_line_avx2;
+    filter_line_step = 16;
+  }
+#endif
+}
+
+static void
+filter_line (guint8 * dst,
+    guint8 * prev, guint8 * cur, guint8 * next,
+    int w, int prefs, int mrefs, int parity, int mode)
+{
+  int n = 0;
+
+  /* the SIMD versions write whole steps, which must not spill into the
+   * lines done by other threads */
+  if (filter_line_simd) {
+    n = w - w % filter_line_step;
+    if (n > 0)
+      filter_line_simd (dst, prev, cur, next, n, prefs, mrefs, parity, mode);
+  }
+  if (n < w)
+    filter_line_c (dst + n, prev + n, cur + n, next + n, w - n, prefs, mrefs,
+        parity, mode);
+}
+
+/* Filters the lines y_start to y_end of the luma, and the matching lines of
+ * the chroma. y_start and y_end must be even, but for the frame height. */
+void
+yadif_filter (GstYadif * yadif, int parity, int tff, int y_start, int y_end)
 {
   int y, i;
   const GstVideoInfo *vi = &yadif->video_info;
@@ -129,34 +187,29 @@ yadif_filter (GstYadif * yadif, int parity, int tff)
   for (i = 0; i < GST_VIDEO_FORMAT_INFO_N_COMPONENTS (vfi); i++) {
     int w = GST_VIDEO_FORMAT_INFO_SCALE_WIDTH (vfi, i, vi->width);
     int h = GST_VIDEO_FORMAT_INFO_SCALE_HEIGHT (vfi, i, vi->height);
-    int refs = GST_VIDEO_INFO_COMP_STRIDE (vi, i);
+    int start = GST_VIDEO_FORMAT_INFO_SCALE_HEIGHT (vfi, i, y_start);
+    int end = GST_VIDEO_FORMAT_INFO_SCALE_HEIGHT (vfi, i, y_end);
+    int refs = GST_VIDEO_FRAME_COMP_STRIDE (&yadif->cur_frame, i);
     int df = GST_VIDEO_INFO_COMP_PSTRIDE (vi, i);
+    int drefs = GST_VIDEO_FRAME_COMP_STRIDE (&yadif->dest_frame, i);
     guint8 *prev_data = GST_VIDEO_FRAME_COMP_DATA (&yadif->prev_frame, i);
     guint8 *cur_data = GST_VIDEO_FRAME_COMP_DATA (&yadif->cur_frame, i);
     guint8 *next_data = GST_VIDEO_FRAME_COMP_DATA (&yadif->next_frame, i);
     guint8 *dest_data = GST_VIDEO_FRAME_COMP_DATA (&yadif->dest_frame, i);
 
-    for (y = 0; y < h; y++) {
+    for (y = start; y < end; y++) {
       if ((y ^ parity) & 1) {
         guint8 *prev = prev_data + y * refs;
         guint8 *cur = cur_data + y * refs;
         guint8 *next = next_data + y * refs;
-        guint8 *dst = dest_data + y * refs;
-        int mode = ((y == 1) || (y + 2 == h)) ? 2 : yadif->mode;
-#if HAVE_CPU_X86_64
-        if (0) {
-          filter_line_c (dst, prev, cur, next, w,
-              y + 1 < h ? refs : -refs, y ? -refs : refs, parity ^ tff, mode);
-        } else {
-          filter_line_x86_64 (dst, prev, cur, next, w,
-              y + 1 < h ? refs : -refs, y ? -refs : refs, parity ^ tff, mode);
-        }
-#else
-        filter_line_c (dst, prev, cur, next, w,
+        guint8 *dst = dest_data + y * drefs;
+        /* no spatial check next to the edges */
+        int mode = ((y == 1) || (y + 2 == h)) ? 2 : 0;
+
+        filter_line (dst, prev, cur, next, w,
             y + 1 < h ? refs : -refs, y ? -refs : refs, parity ^ tff, mode);
-#endif
       } else {
-        guint8 *dst = dest_data + y * refs;
+        guint8 *dst = dest_data + y * drefs;
         guint8 *cur = cur_data + y * refs;
 
         memcpy (dst, cur, w * df);
@@ -24,6 +24,9 @@
 
 #if HAVE_CPU_X86_64
 
+#include <cpuid.h>
+#include <immintrin.h>
+
 typedef struct xmm_reg
 {
   guint64 a, b;
@@ -81,6 +84,10 @@ DECLARE_ASM_CONST (16, xmm_reg, pw_1) = {
 void filter_line_x86_64 (guint8 * dst,
     guint8 * prev, guint8 * cur, guint8 * next,
     int w, int prefs, int mrefs, int parity, int mode);
+void filter_line_avx2 (guint8 * dst,
+    guint8 * prev, guint8 * cur, guint8 * next,
+    int w, int prefs, int mrefs, int parity, int mode);
+gboolean yadif_have_avx2 (void);
 
 void
 filter_line_x86_64 (guint8 * dst,
@@ -104,4 +111,134 @@ filter_line_x86_64 (guint8 * dst,
   yadif_filter_line_sse2 (dst, prev, cur, next, w, prefs, mrefs, parity, mode);
 }
 
+/* The same filter as the C version, 16 pixels at a time in 16 bit lanes.
+ * w must be a multiple of 16. */
+#define LOAD16(p) _mm256_cvtepu8_epi16 (_mm_loadu_si128 ((const __m128i *) (p)))
+
+/* Score and prediction of the direction j, taken if it beats the score so
+ * far where mask is set */
+#define CHECK_DIR(j, mask) \
+    do { \
+      __m256i score = _mm256_add_epi16 (_mm256_add_epi16 ( \
+              _mm256_abs_epi16 (_mm256_sub_epi16 ( \
+                      LOAD16 (cur + x + mrefs - 1 + (j)), \
+                      LOAD16 (cur + x + prefs - 1 - (j)))), \
+              _mm256_abs_epi16 (_mm256_sub_epi16 ( \
+                      LOAD16 (cur + x + mrefs + (j)), \
+                      LOAD16 (cur + x + prefs - (j))))), \
+          _mm256_abs_epi16 (_mm256_sub_epi16 ( \
+                  LOAD16 (cur + x + mrefs + 1 + (j)), \
+                  LOAD16 (cur + x + prefs + 1 - (j))))); \
+      __m256i pred = _mm256_srli_epi16 (_mm256_add_epi16 ( \
+              LOAD16 (cur + x + mrefs + (j)), \
+              LOAD16 (cur + x + prefs - (j))), 1); \
+      better = _mm256_and_si256 (mask, \
+          _mm256_cmpgt_epi16 (spatial_score, score)); \
+      spatial_score = _mm256_blendv_epi8 (spatial_score, score, better); \
+      spatial_pred = _mm256_blendv_epi8 (spatial_pred, pred, better); \
+    } while (0)
+
+__attribute__ ((target ("avx2")))
+void
+filter_line_avx2 (guint8 * dst,
+    guint8 * prev, guint8 * cur, guint8 * next,
+    int w, int prefs, int mrefs, int parity, int mode)
+{
+  const __m256i all = _mm256_set1_epi16 (-1);
+  const __m256i one = _mm256_set1_epi16 (1);
+  guint8 *prev2 = parity ? prev : cur;
+  guint8 *next2 = parity ? cur : next;
+  int x;
+
+  for (x = 0; x < w; x += 16) {
+    __m256i c = LOAD16 (cur + x + mrefs);
+    __m256i e = LOAD16 (cur + x + prefs);
+    __m256i p2 = LOAD16 (prev2 + x);
+    __m256i n2 = LOAD16 (next2 + x);
+    __m256i d = _mm256_srli_epi16 (_mm256_add_epi16 (p2, n2), 1);
+    __m256i temporal_diff0, temporal_diff1, temporal_diff2, diff;
+    __m256i spatial_pred, spatial_score, better;
+
+    temporal_diff0 = _mm256_abs_epi16 (_mm256_sub_epi16 (p2, n2));
+    temporal_diff1 = _mm256_srli_epi16 (_mm256_add_epi16 (
+            _mm256_abs_epi16 (_mm256_sub_epi16 (LOAD16 (prev + x + mrefs), c)),
+            _mm256_abs_epi16 (_mm256_sub_epi16 (LOAD16 (prev + x + prefs),
+                    e))), 1);
+    temporal_diff2 = _mm256_srli_epi16 (_mm256_add_epi16 (
+            _mm256_abs_epi16 (_mm256_sub_epi16 (LOAD16 (next + x + mrefs), c)),
+            _mm256_abs_epi16 (_mm256_sub_epi16 (LOAD16 (next + x + prefs),
+                    e))), 1);
+    diff = _mm256_max_epi16 (_mm256_srli_epi16 (temporal_diff0, 1),
+        _mm256_max_epi16 (temporal_diff1, temporal_diff2));
+
+    spatial_pred = _mm256_srli_epi16 (_mm256_add_epi16 (c, e), 1);
+    spatial_score = _mm256_sub_epi16 (_mm256_add_epi16 (_mm256_add_epi16 (
+                _mm256_abs_epi16 (_mm256_sub_epi16 (
+                        LOAD16 (cur + x + mrefs - 1),
+                        LOAD16 (cur + x + prefs - 1))),
+                _mm256_abs_epi16 (_mm256_sub_epi16 (c, e))),
+            _mm256_abs_epi16 (_mm256_sub_epi16 (LOAD16 (cur + x + mrefs + 1),
+                    LOAD16 (cur + x + prefs + 1)))), one);
+
+    /* directions 2 are only checked where directions 1 were taken */
+    CHECK_DIR (-1, all);
+    CHECK_DIR (-2, better);
+    CHECK_DIR (1, all);
+    CHECK_DIR (2, better);
+
+    if (mode < 2) {
+      __m256i b = _mm256_srli_epi16 (_mm256_add_epi16 (
+              LOAD16 (prev2 + x + 2 * mrefs), LOAD16 (next2 + x + 2 * mrefs)),
+          1);
+      __m256i f = _mm256_srli_epi16 (_mm256_add_epi16 (
+              LOAD16 (prev2 + x + 2 * prefs), LOAD16 (next2 + x + 2 * prefs)),
+          1);
+      __m256i de = _mm256_sub_epi16 (d, e);
+      __m256i dc = _mm256_sub_epi16 (d, c);
+      __m256i bc = _mm256_sub_epi16 (b, c);
+      __m256i fe = _mm256_sub_epi16 (f, e);
+      __m256i max = _mm256_max_epi16 (_mm256_max_epi16 (de, dc),
+          _mm256_min_epi16 (bc, fe));
+      __m256i min = _mm256_min_epi16 (_mm256_min_epi16 (de, dc),
+          _mm256_max_epi16 (bc, fe));
+
+      diff = _mm256_max_epi16 (_mm256_max_epi16 (diff, min),
+          _mm256_sub_epi16 (_mm256_setzero_si256 (), max));
+    }
+
+    spatial_pred = _mm256_min_epi16 (_mm256_max_epi16 (spatial_pred,
+            _mm256_sub_epi16 (d, diff)), _mm256_add_epi16 (d, diff));
+
+    _mm_storeu_si128 ((__m128i *) (dst + x),
+        _mm_packus_epi16 (_mm256_castsi256_si128 (spatial_pred),
+            _mm256_extracti128_si256 (spatial_pred, 1)));
+  }
+}
+
+#undef CHECK_DIR
+#undef LOAD16
+
+/* AVX2 needs support from the processor and the OS saving the registers */
+gboolean
+yadif_have_avx2 (void)
+{
+  guint eax, ebx, ecx, edx;
+  guint xcr0_lo, xcr0_hi;
+
+  if (__get_cpuid_max (0, NULL) < 7)
+    return FALSE;
+
+  __cpuid (1, eax, ebx, ecx, edx);
+  if (!(ecx & bit_OSXSAVE) || !(ecx & bit_AVX))
+    return FALSE;
+
+  __asm__ volatile ("xgetbv":"=a" (xcr0_lo), "=d" (xcr0_hi):"c" (0));
+  if ((xcr0_lo & 0x6) != 0x6)
+    return FALSE;
+
+  __cpuid_count (7, 0, eax, ebx, ecx, edx);
+
+  return (ebx & bit_AVX2) != 0;
+}
+
 #endif
@@ -28,6 +28,12 @@
  * |[
  * gst-launch -v videotestsrc !  shmsink socket-path=/tmp/blah shm-size=1000000
  * ]| Send video to shm buffers.
+ * |[
+ * gst-launch -v audiotestsrc !  shmsink socket-path=/tmp/blah ring-size=256
+ * ]| Send audio to shm buffers, signalling them through rings in shared
+ * memory instead of the control socket. A client whose ring is full misses
+ * the next buffers, unless ring-blocking is set, which makes the sink wait
+ * for the slowest client instead.
  * </refsect2>
  */
 #ifdef HAVE_CONFIG_H
@@ -56,7 +62,13 @@ enum
   PROP_PERMS,
   PROP_SHM_SIZE,
   PROP_WAIT_FOR_CONNECTION,
-  PROP_BUFFER_TIME
+  PROP_BUFFER_TIME,
+  PROP_RING_SIZE,
+  PROP_RING_BLOCKING,
+  PROP_RING_DROPS,
+  PROP_SHM_USED,
+  PROP_SHM_HIGH_WATER_MARK,
+  PROP_SHM_FRAGMENTATION
 };
 
 struct GstShmClient
@@ -67,6 +79,8 @@ struct GstShmClient
 
 #define DEFAULT_SIZE ( 64 * 1024 * 1024 )
 #define DEFAULT_WAIT_FOR_CONNECTION (TRUE)
+#define DEFAULT_RING_SIZE 0
+#define DEFAULT_RING_BLOCKING (FALSE)
 /* Default is user read/write, group read */
 #define DEFAULT_PERMS ( S_IRUSR | S_IWUSR | S_IRGRP )
 
@@ -349,6 +363,8 @@ gst_shm_sink_init (GstShmSink * self)
   self->size = DEFAULT_SIZE;
   self->wait_for_connection = DEFAULT_WAIT_FOR_CONNECTION;
   self->perms = DEFAULT_PERMS;
+  self->ring_size = DEFAULT_RING_SIZE;
+  self->ring_blocking = DEFAULT_RING_BLOCKING;
 
   gst_allocation_params_init (&self->params);
 }
@@ -411,6 +427,54 @@ gst_shm_sink_class_init (GstShmSinkClass * klass)
           -1, G_MAXINT64, -1,
           G_PARAM_CONSTRUCT | G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  g_object_class_install_property (gobject_class, PROP_RING_SIZE,
+      g_param_spec_uint ("ring-size",
+          "Size of the rings of the clients",
+          "Number of buffers that can be signalled to each client through a "
+          "ring in shared memory instead of the control socket, rounded up to "
+          "a power of 2 (0 to use the socket). This saves syscalls with "
+          "small buffers at high rates, but requires a shmsrc that supports "
+          "it. This may be modified during the NULL->READY transition",
+          0, 65536, DEFAULT_RING_SIZE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_RING_BLOCKING,
+      g_param_spec_boolean ("ring-blocking",
+          "Wait for the rings of all the clients",
+          "Block the stream while the ring of any client is full, instead of "
+          "dropping the buffers for that client only. One stalled client then "
+          "stalls all of them",
+          DEFAULT_RING_BLOCKING, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_RING_DROPS,
+      g_param_spec_uint64 ("ring-drops",
+          "Buffers dropped for full rings",
+          "Number of buffers not sent to a client because its ring was full, "
+          "summed over all the clients since the sink was started",
+          0, G_MAXUINT64, 0, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_SHM_USED,
+      g_param_spec_uint64 ("shm-used",
+          "Used size of the shm area",
+          "Number of bytes of the shared memory area currently allocated, "
+          "including the rounding to the allocation granularity and the "
+          "partly used pages of small buffers",
+          0, G_MAXUINT64, 0, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_SHM_HIGH_WATER_MARK,
+      g_param_spec_uint64 ("shm-high-water-mark",
+          "High water mark of the shm area",
+          "Maximum number of bytes of the shared memory area allocated at "
+          "once since it was created or last resized",
+          0, G_MAXUINT64, 0, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_SHM_FRAGMENTATION,
+      g_param_spec_double ("shm-fragmentation",
+          "Fragmentation of the shm area",
+          "Fraction of the free space of the shared memory area that is not "
+          "part of the largest free chunk (0 if it is all in one piece)",
+          0.0, 1.0, 0.0, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
   signals[SIGNAL_CLIENT_CONNECTED] = g_signal_new ("client-connected",
       GST_TYPE_SHM_SINK, G_SIGNAL_RUN_LAST, 0, NULL, NULL,
       g_cclosure_marshal_VOID__INT, G_TYPE_NONE, 1, G_TYPE_INT);
@@ -500,6 +564,17 @@ gst_shm_sink_set_property (GObject * object, guint prop_id,
       GST_OBJECT_UNLOCK (object);
       g_cond_broadcast (&self->cond);
       break;
+    case PROP_RING_SIZE:
+      GST_OBJECT_LOCK (object);
+      self->ring_size = g_value_get_uint (value);
+      GST_OBJECT_UNLOCK (object);
+      break;
+    case PROP_RING_BLOCKING:
+      GST_OBJECT_LOCK (object);
+      self->ring_blocking = g_value_get_boolean (value);
+      GST_OBJECT_UNLOCK (object);
+      g_cond_broadcast (&self->cond);
+      break;
     default:
       break;
   }
@@ -529,6 +604,38 @@ gst_shm_sink_get_property (GObject * object, guint prop_id,
     case PROP_BUFFER_TIME:
       g_value_set_int64 (value, self->buffer_time);
       break;
+    case PROP_RING_SIZE:
+      g_value_set_uint (value, self->ring_size);
+      break;
+    case PROP_RING_BLOCKING:
+      g_value_set_boolean (value, self->ring_blocking);
+      break;
+    case PROP_RING_DROPS:
+      g_value_set_uint64 (value, self->ring_drops +
+          (self->pipe ? sp_writer_get_drops (self->pipe) : 0));
+      break;
+    case PROP_SHM_USED:
+    case PROP_SHM_HIGH_WATER_MARK:
+    case PROP_SHM_FRAGMENTATION:
+    {
+      size_t size = 0, used = 0, high_water_mark = 0, largest_free = 0;
+
+      /* under the object lock, like the allocations and resizes */
+      if (self->pipe)
+        sp_writer_get_alloc_stats (self->pipe, &size, &used, &high_water_mark,
+            &largest_free);
+
+      if (prop_id == PROP_SHM_USED)
+        g_value_set_uint64 (value, used);
+      else if (prop_id == PROP_SHM_HIGH_WATER_MARK)
+        g_value_set_uint64 (value, high_water_mark);
+      else if (size > used)
+        g_value_set_double (value,
+            1.0 - (gdouble) largest_free / (size - used));
+      else
+        g_value_set_double (value, 0.0);
+      break;
+    }
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -538,11 +645,24 @@ gst_shm_sink_get_property (GObject * object, guint prop_id,
 }
 
 
+/* Keeps the drops of a client that is about to be closed in the total */
+static void
+gst_shm_sink_count_drops_locked (GstShmSink * self, ShmClient * client)
+{
+  guint drops = sp_writer_get_client_drops (client);
+
+  if (drops > 0)
+    GST_INFO_OBJECT (self, "Client %d missed %u buffers because its ring was "
+        "full", sp_writer_get_client_fd (client), drops);
+
+  self->ring_drops += drops;
+}
 
 static gboolean
 gst_shm_sink_start (GstBaseSink * bsink)
 {
   GstShmSink *self = GST_SHM_SINK (bsink);
+  ShmPipe *pipe;
   GError *err = NULL;
 
   self->stop = FALSE;
@@ -556,15 +676,22 @@ gst_shm_sink_start (GstBaseSink * bsink)
   GST_DEBUG_OBJECT (self, "Creating new socket at %s"
       " with shared memory of %d bytes", self->socket_path, self->size);
 
-  self->pipe = sp_writer_create (self->socket_path, self->size, self->perms);
+  pipe = sp_writer_create (self->socket_path, self->size, self->perms);
 
-  if (!self->pipe) {
+  if (!pipe) {
     GST_ELEMENT_ERROR (self, RESOURCE, OPEN_READ_WRITE,
         ("Could not open socket."), (NULL));
     return FALSE;
   }
 
-  sp_set_data (self->pipe, self);
+  sp_set_data (pipe, self);
+
+  /* the properties read the allocation stats of the pipe */
+  GST_OBJECT_LOCK (self);
+  self->pipe = pipe;
+  self->ring_drops = 0;
+  GST_OBJECT_UNLOCK (self);
+
   g_free (self->socket_path);
   self->socket_path = g_strdup (sp_writer_get_path (self->pipe));
 
@@ -576,6 +703,18 @@ gst_shm_sink_start (GstBaseSink * bsink)
   gst_poll_add_fd (self->poll, &self->serverpollfd);
   gst_poll_fd_ctl_read (self->poll, &self->serverpollfd, TRUE);
 
+  gst_poll_fd_init (&self->ackpollfd);
+  if (self->ring_size > 0) {
+    if (sp_writer_set_ring_size (self->pipe, self->ring_size) < 0) {
+      GST_WARNING_OBJECT (self, "Could not set up the rings, using the "
+          "socket for all buffers");
+    } else {
+      self->ackpollfd.fd = sp_writer_get_ack_fd (self->pipe);
+      gst_poll_add_fd (self->poll, &self->ackpollfd);
+      gst_poll_fd_ctl_read (self->poll, &self->ackpollfd, TRUE);
+    }
+  }
+
   self->pollthread =
       g_thread_try_new ("gst-shmsink-poll-thread", pollthread_func, self, &err);
 
@@ -588,8 +727,10 @@ gst_shm_sink_start (GstBaseSink * bsink)
 
 thread_error:
 
-  sp_writer_close (self->pipe, NULL, NULL);
+  GST_OBJECT_LOCK (self);
   self->pipe = NULL;
+  GST_OBJECT_UNLOCK (self);
+  sp_writer_close (pipe, NULL, NULL);
   gst_poll_free (self->poll);
 
   GST_ELEMENT_ERROR (self, CORE, THREAD, ("Could not start thread"),
@@ -603,6 +744,7 @@ static gboolean
 gst_shm_sink_stop (GstBaseSink * bsink)
 {
   GstShmSink *self = GST_SHM_SINK (bsink);
+  ShmPipe *pipe;
 
   self->stop = TRUE;
   gst_poll_set_flushing (self->poll, TRUE);
@@ -619,6 +761,9 @@ gst_shm_sink_stop (GstBaseSink * bsink)
   while (self->clients) {
     struct GstShmClient *client = self->clients->data;
     self->clients = g_list_remove (self->clients, client);
+    GST_OBJECT_LOCK (self);
+    gst_shm_sink_count_drops_locked (self, client->client);
+    GST_OBJECT_UNLOCK (self);
     sp_writer_close_client (self->pipe, client->client,
         (sp_buffer_free_callback) gst_buffer_unref, NULL);
     g_signal_emit (self, signals[SIGNAL_CLIENT_DISCONNECTED], 0,
@@ -629,8 +774,11 @@ gst_shm_sink_stop (GstBaseSink * bsink)
   gst_poll_free (self->poll);
   self->poll = NULL;
 
-  sp_writer_close (self->pipe, NULL, NULL);
+  GST_OBJECT_LOCK (self);
+  pipe = self->pipe;
   self->pipe = NULL;
+  GST_OBJECT_UNLOCK (self);
+  sp_writer_close (pipe, NULL, NULL);
 
   return TRUE;
 }
@@ -677,6 +825,12 @@ gst_shm_sink_render (GstBaseSink * bsink, GstBuffer * buf)
       goto flushing;
   }
 
+  while (self->ring_blocking && !sp_writer_can_send_buf (self->pipe)) {
+    g_cond_wait (&self->cond, GST_OBJECT_GET_LOCK (self));
+    if (self->unlock)
+      goto flushing;
+  }
+
 
   if (gst_buffer_n_memory (buf) > 1) {
     GST_LOG_OBJECT (self, "Buffer %p has %d GstMemory, we only support a single"
@@ -745,7 +899,8 @@ gst_shm_sink_render (GstBaseSink * bsink, GstBuffer * buf)
   GST_OBJECT_UNLOCK (self);
 
   if (rv == 0) {
-    GST_DEBUG_OBJECT (self, "No clients connected, unreffing buffer");
+    GST_DEBUG_OBJECT (self, "No clients connected or all rings full, "
+        "unreffing buffer");
     gst_buffer_unref (sendbuf);
   } else if (rv == -1) {
     GST_ELEMENT_ERROR (self, STREAM, FAILED, ("Invalid allocated buffer"),
@@ -778,6 +933,7 @@ pollthread_func (gpointer data)
   GstShmSink *self = GST_SHM_SINK (data);
   GList *item;
   GstClockTime timeout = GST_CLOCK_TIME_NONE;
+  gboolean have_acks;
 
   while (!self->stop) {
 
@@ -833,6 +989,16 @@ pollthread_func (gpointer data)
       continue;
     }
 
+    /* the acks of all the rings come on the same fd, it only tells us to
+     * look at all of them */
+    have_acks = self->ackpollfd.fd >= 0 &&
+        gst_poll_fd_can_read (self->poll, &self->ackpollfd);
+    if (have_acks) {
+      GST_OBJECT_LOCK (self);
+      sp_writer_clear_ack_fd (self->pipe);
+      GST_OBJECT_UNLOCK (self);
+    }
+
   again:
     for (item = self->clients; item; item = item->next) {
       struct GstShmClient *gclient = item->data;
@@ -866,11 +1032,29 @@ pollthread_func (gpointer data)
         if (rv == 0)
           gst_buffer_unref (tag);
       }
+
+      if (have_acks) {
+        GSList *list = NULL;
+        int rv;
+
+        GST_OBJECT_LOCK (self);
+        rv = sp_writer_recv_acks (self->pipe, gclient->client,
+            (sp_buffer_free_callback) free_buffer_locked, (void **) &list);
+        GST_OBJECT_UNLOCK (self);
+        g_slist_free_full (list, (GDestroyNotify) gst_buffer_unref);
+
+        if (rv < 0) {
+          GST_WARNING_OBJECT (self, "One client sent an invalid ack,"
+              " closing (retval: %d)", rv);
+          goto close_client;
+        }
+      }
       continue;
     close_client:
       {
         GSList *list = NULL;
         GST_OBJECT_LOCK (self);
+        gst_shm_sink_count_drops_locked (self, gclient->client);
         sp_writer_close_client (self->pipe, gclient->client,
             (sp_buffer_free_callback) free_buffer_locked, (void **) &list);
         GST_OBJECT_UNLOCK (self);
@@ -52,12 +52,17 @@ struct _GstShmSink
 
   guint perms;
   guint size;
+  guint ring_size;
+  gboolean ring_blocking;
+  /* buffers dropped for the clients that are gone */
+  guint64 ring_drops;
 
   GList *clients;
 
   GThread *pollthread;
   GstPoll *poll;
   GstPollFD serverpollfd;
+  GstPollFD ackpollfd;
 
   gboolean wait_for_connection;
   gboolean stop;
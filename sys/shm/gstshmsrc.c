@@ -148,6 +148,7 @@ gst_shm_src_init (GstShmSrc * self)
 {
   self->poll = gst_poll_new (TRUE);
   gst_poll_fd_init (&self->pollfd);
+  gst_poll_fd_init (&self->ringpollfd);
 }
 
 static void
@@ -249,6 +250,9 @@ gst_shm_src_start_reading (GstShmSrc * self)
   gst_poll_add_fd (self->poll, &self->pollfd);
   gst_poll_fd_ctl_read (self->poll, &self->pollfd, TRUE);
 
+  /* added once the sink offers a ring */
+  gst_poll_fd_init (&self->ringpollfd);
+
   return TRUE;
 }
 
@@ -265,6 +269,11 @@ gst_shm_src_stop_reading (GstShmSrc * self)
   gst_poll_remove_fd (self->poll, &self->pollfd);
   gst_poll_fd_init (&self->pollfd);
 
+  if (self->ringpollfd.fd >= 0) {
+    gst_poll_remove_fd (self->poll, &self->ringpollfd);
+    gst_poll_fd_init (&self->ringpollfd);
+  }
+
   gst_poll_set_flushing (self->poll, TRUE);
 }
 
@@ -314,6 +323,21 @@ gst_shm_src_create (GstPushSrc * psrc, GstBuffer ** outbuf)
   struct GstShmBuffer *gsb;
 
   do {
+    /* the ring only wakes us up when it was empty, so always look at it
+     * before waiting */
+    if (self->ringpollfd.fd >= 0) {
+      GST_OBJECT_LOCK (self);
+      rv = sp_client_ring_recv (self->pipe->pipe, &buf);
+      GST_OBJECT_UNLOCK (self);
+      if (rv < 0) {
+        GST_ELEMENT_ERROR (self, RESOURCE, READ, ("Failed to read from shmsrc"),
+            ("Error reading from the ring: %d", rv));
+        return GST_FLOW_ERROR;
+      }
+      if (buf)
+        break;
+    }
+
     if (gst_poll_wait (self->poll, GST_CLOCK_TIME_NONE) < 0) {
       if (errno == EBUSY)
         return GST_FLOW_FLUSHING;
@@ -348,6 +372,17 @@ gst_shm_src_create (GstPushSrc * psrc, GstBuffer ** outbuf)
             ("Error reading control data: %d", rv));
         return GST_FLOW_ERROR;
       }
+
+      if (self->ringpollfd.fd < 0) {
+        GST_OBJECT_LOCK (self);
+        self->ringpollfd.fd = sp_client_get_ring_fd (self->pipe->pipe);
+        GST_OBJECT_UNLOCK (self);
+        if (self->ringpollfd.fd >= 0) {
+          GST_DEBUG_OBJECT (self, "Receiving the buffers through a ring");
+          gst_poll_add_fd (self->poll, &self->ringpollfd);
+          gst_poll_fd_ctl_read (self->poll, &self->ringpollfd, TRUE);
+        }
+      }
     }
   } while (buf == NULL);
 
@@ -33,14 +33,89 @@
 #include <string.h>
 #include <assert.h>
 
+/*
+ * The space is split in pages. Blocks up to SHM_ALLOC_MAX_SLAB_SIZE bytes
+ * are taken from slabs of a few pages holding objects of one power of 2
+ * size, bigger blocks get their own run of pages. Free runs of pages are
+ * kept in lists by power of 2 of their length, and each page knows the
+ * block or slab using it, so allocating, freeing and finding the block of
+ * an offset don't depend on the number of blocks.
+ */
+
+#define SHM_ALLOC_PAGE_SHIFT 12
+#define SHM_ALLOC_PAGE_SIZE (1UL << SHM_ALLOC_PAGE_SHIFT)
+#define SHM_ALLOC_PAGE_OFFSET(page) \
+  ((unsigned long) (page) << SHM_ALLOC_PAGE_SHIFT)
+/* pages used by a block of its own, at least one even if empty */
+#define SHM_ALLOC_BLOCK_PAGES(size) \
+  ((size) ? ((size) + SHM_ALLOC_PAGE_SIZE - 1) >> SHM_ALLOC_PAGE_SHIFT : 1)
+
+#define SHM_ALLOC_MIN_SLAB_SHIFT 6
+#define SHM_ALLOC_MAX_SLAB_SHIFT 11
+#define SHM_ALLOC_MAX_SLAB_SIZE (1UL << SHM_ALLOC_MAX_SLAB_SHIFT)
+#define SHM_ALLOC_N_SLAB_CLASSES \
+  (SHM_ALLOC_MAX_SLAB_SHIFT - SHM_ALLOC_MIN_SLAB_SHIFT + 1)
+#define SHM_ALLOC_SLAB_PAGES 4
+
+#define SHM_ALLOC_N_RUN_CLASSES 32
+#define SHM_ALLOC_NO_PAGE ((unsigned int) -1)
+
+typedef struct _ShmAllocPage ShmAllocPage;
+typedef struct _ShmAllocSlab ShmAllocSlab;
+
+struct _ShmAllocPage
+{
+  /* The block or the slab using this page, both NULL if it is free */
+  ShmAllocBlock *block;
+  ShmAllocSlab *slab;
+
+  /* On the first and last page of a free run, the length of the run */
+  unsigned int run_pages;
+  /* On the first page of a free run, the list of runs of the same class */
+  unsigned int prev_run;
+  unsigned int next_run;
+};
+
+/* Pages holding blocks of a single size */
+struct _ShmAllocSlab
+{
+  unsigned int first_page;
+  unsigned int size_class;
+  unsigned long object_size;
+  unsigned int n_objects;
+
+  /* stack of the indexes of the free objects */
+  unsigned int n_free;
+  unsigned short *free_objects;
+  /* the block using each object, NULL if it is free */
+  ShmAllocBlock **blocks;
+
+  /* chained list of the slabs of this size with free objects */
+  ShmAllocSlab *prev;
+  ShmAllocSlab *next;
+};
+
 /* This is the allocated space to hold multiple blocks */
 struct _ShmAllocSpace
 {
   /* The total size of this space */
   size_t size;
 
-  /* chained list of the blocks contained in this space */
-  ShmAllocBlock *blocks;
+  unsigned int n_pages;
+  ShmAllocPage *pages;
+
+  /* first page of the free runs with between 2^i and 2^(i+1) - 1 pages,
+   * and the bit i is set if there is any */
+  unsigned int free_runs[SHM_ALLOC_N_RUN_CLASSES];
+  unsigned int free_runs_mask;
+
+  ShmAllocSlab *partial_slabs[SHM_ALLOC_N_SLAB_CLASSES];
+
+  /* Bytes of pages used by blocks and slabs */
+  size_t used;
+  size_t high_water_mark;
+
+  unsigned int n_blocks;
 };
 
 /* A single block of data */
@@ -56,71 +131,384 @@ struct _ShmAllocBlock
   /* The size of the block */
   unsigned long size;
 
-  /* Pointer to the next block in the chain */
-  ShmAllocBlock *next;
+  /* The slab this block is part of, or NULL if it has its own pages */
+  ShmAllocSlab *slab;
 };
 
 
+static void shm_alloc_run_insert (ShmAllocSpace * self, unsigned int first,
+    unsigned int n_pages);
+
 ShmAllocSpace *
 shm_alloc_space_new (size_t size)
 {
   ShmAllocSpace *self = spalloc_new (ShmAllocSpace);
+  unsigned int i;
 
   memset (self, 0, sizeof (ShmAllocSpace));
 
   self->size = size;
 
+  /* the last page may be shorter */
+  self->n_pages = (size + SHM_ALLOC_PAGE_SIZE - 1) >> SHM_ALLOC_PAGE_SHIFT;
+  self->pages = calloc (self->n_pages ? self->n_pages : 1,
+      sizeof (ShmAllocPage));
+
+  for (i = 0; i < SHM_ALLOC_N_RUN_CLASSES; i++)
+    self->free_runs[i] = SHM_ALLOC_NO_PAGE;
+
+  if (self->n_pages > 0)
+    shm_alloc_run_insert (self, 0, self->n_pages);
+
   return self;
 }
 
-void
-shm_alloc_space_free (ShmAllocSpace * self)
+static unsigned int
+shm_alloc_run_class (unsigned int n_pages)
 {
-  assert (self && self->blocks == NULL);
-  spalloc_free (ShmAllocSpace, self);
+  unsigned int c = 0;
+
+  while (n_pages >>= 1)
+    c++;
+
+  return c;
 }
 
+static size_t
+shm_alloc_pages_bytes (ShmAllocSpace * self, unsigned int first,
+    unsigned int n_pages)
+{
+  size_t end = SHM_ALLOC_PAGE_OFFSET (first + n_pages);
 
-ShmAllocBlock *
-shm_alloc_space_alloc_block (ShmAllocSpace * self, unsigned long size)
+  if (end > self->size)
+    end = self->size;
+
+  return end - SHM_ALLOC_PAGE_OFFSET (first);
+}
+
+static void
+shm_alloc_run_insert (ShmAllocSpace * self, unsigned int first,
+    unsigned int n_pages)
 {
-  ShmAllocBlock *block;
-  ShmAllocBlock *item = NULL;
-  ShmAllocBlock *prev_item = NULL;
-  unsigned long prev_end_offset = 0;
+  unsigned int c = shm_alloc_run_class (n_pages);
+  ShmAllocPage *page = &self->pages[first];
+
+  page->run_pages = n_pages;
+  self->pages[first + n_pages - 1].run_pages = n_pages;
+
+  page->prev_run = SHM_ALLOC_NO_PAGE;
+  page->next_run = self->free_runs[c];
+  if (page->next_run != SHM_ALLOC_NO_PAGE)
+    self->pages[page->next_run].prev_run = first;
+  self->free_runs[c] = first;
+  self->free_runs_mask |= 1U << c;
+}
 
+static void
+shm_alloc_run_remove (ShmAllocSpace * self, unsigned int first)
+{
+  ShmAllocPage *page = &self->pages[first];
+  unsigned int c = shm_alloc_run_class (page->run_pages);
 
-  for (item = self->blocks; item; item = item->next) {
-    unsigned long max_size = 0;
+  if (page->prev_run != SHM_ALLOC_NO_PAGE)
+    self->pages[page->prev_run].next_run = page->next_run;
+  else
+    self->free_runs[c] = page->next_run;
 
-    max_size = item->offset - prev_end_offset;
+  if (page->next_run != SHM_ALLOC_NO_PAGE)
+    self->pages[page->next_run].prev_run = page->prev_run;
 
-    if (max_size >= size)
-      break;
+  if (self->free_runs[c] == SHM_ALLOC_NO_PAGE)
+    self->free_runs_mask &= ~(1U << c);
+}
+
+static int
+shm_alloc_page_is_free (ShmAllocSpace * self, unsigned int page)
+{
+  return !self->pages[page].block && !self->pages[page].slab;
+}
+
+static void
+shm_alloc_pages_set_owner (ShmAllocSpace * self, unsigned int first,
+    unsigned int n_pages, ShmAllocBlock * block, ShmAllocSlab * slab)
+{
+  unsigned int i;
+
+  for (i = first; i < first + n_pages; i++) {
+    self->pages[i].block = block;
+    self->pages[i].slab = slab;
+  }
+}
+
+/* Returns the first free run with at least @n_pages pages holding @size
+ * bytes, looking at the runs of the classes from @from_class to @to_class
+ * excluded */
+static unsigned int
+shm_alloc_runs_find (ShmAllocSpace * self, unsigned int from_class,
+    unsigned int to_class, unsigned int n_pages, unsigned long size)
+{
+  unsigned int c, first;
+
+  for (c = from_class; c < to_class; c++) {
+    if (!(self->free_runs_mask & (1U << c)))
+      continue;
+
+    /* The last page may be short, so the run holding it can be too small
+     * even if it has enough pages */
+    for (first = self->free_runs[c]; first != SHM_ALLOC_NO_PAGE;
+        first = self->pages[first].next_run) {
+      if (self->pages[first].run_pages >= n_pages &&
+          SHM_ALLOC_PAGE_OFFSET (first) + size <= self->size)
+        return first;
+    }
+  }
+
+  return SHM_ALLOC_NO_PAGE;
+}
+
+/* Returns the first page of a run of @n_pages pages holding @size bytes */
+static unsigned int
+shm_alloc_pages_alloc (ShmAllocSpace * self, unsigned int n_pages,
+    unsigned long size)
+{
+  unsigned int c = shm_alloc_run_class (n_pages);
+  unsigned int first;
+  unsigned int run_pages;
+
+  /* All the runs of the next classes have enough pages, only look through
+   * the runs of this class if none of those fit, some of them may be too
+   * short */
+  if (n_pages & (n_pages - 1)) {
+    first = shm_alloc_runs_find (self, c + 1, SHM_ALLOC_N_RUN_CLASSES,
+        n_pages, size);
+    if (first == SHM_ALLOC_NO_PAGE)
+      first = shm_alloc_runs_find (self, c, c + 1, n_pages, size);
+  } else {
+    first = shm_alloc_runs_find (self, c, SHM_ALLOC_N_RUN_CLASSES, n_pages,
+        size);
+  }
 
-    prev_end_offset = item->offset + item->size;
-    prev_item = item;
+  if (first == SHM_ALLOC_NO_PAGE)
+    return SHM_ALLOC_NO_PAGE;
+
+  run_pages = self->pages[first].run_pages;
+  shm_alloc_run_remove (self, first);
+  if (run_pages > n_pages)
+    shm_alloc_run_insert (self, first + n_pages, run_pages - n_pages);
+
+  self->used += shm_alloc_pages_bytes (self, first, n_pages);
+  if (self->used > self->high_water_mark)
+    self->high_water_mark = self->used;
+
+  return first;
+}
+
+static void
+shm_alloc_pages_free (ShmAllocSpace * self, unsigned int first,
+    unsigned int n_pages)
+{
+  self->used -= shm_alloc_pages_bytes (self, first, n_pages);
+
+  shm_alloc_pages_set_owner (self, first, n_pages, NULL, NULL);
+
+  /* Merge with the free runs around */
+  if (first > 0 && shm_alloc_page_is_free (self, first - 1)) {
+    unsigned int prev_pages = self->pages[first - 1].run_pages;
+
+    first -= prev_pages;
+    n_pages += prev_pages;
+    shm_alloc_run_remove (self, first);
   }
 
-  /* Return NULL if there is no big enough space, otherwise, there is space
-   * at the end */
-  assert (prev_end_offset <= self->size);
-  if (!item && self->size - prev_end_offset < size)
+  if (first + n_pages < self->n_pages &&
+      shm_alloc_page_is_free (self, first + n_pages)) {
+    unsigned int next_pages = self->pages[first + n_pages].run_pages;
+
+    shm_alloc_run_remove (self, first + n_pages);
+    n_pages += next_pages;
+  }
+
+  shm_alloc_run_insert (self, first, n_pages);
+}
+
+static ShmAllocSlab *
+shm_alloc_slab_new (ShmAllocSpace * self, unsigned int size_class)
+{
+  ShmAllocSlab *slab;
+  unsigned long object_size = 1UL << (size_class + SHM_ALLOC_MIN_SLAB_SHIFT);
+  unsigned int n_objects =
+      (SHM_ALLOC_SLAB_PAGES * SHM_ALLOC_PAGE_SIZE) / object_size;
+  unsigned int first;
+  unsigned int i;
+
+  first = shm_alloc_pages_alloc (self, SHM_ALLOC_SLAB_PAGES,
+      SHM_ALLOC_SLAB_PAGES * SHM_ALLOC_PAGE_SIZE);
+  if (first == SHM_ALLOC_NO_PAGE)
     return NULL;
 
-  block = spalloc_new (ShmAllocBlock);
+  slab = spalloc_alloc (sizeof (ShmAllocSlab) +
+      n_objects * (sizeof (ShmAllocBlock *) + sizeof (unsigned short)));
+  memset (slab, 0, sizeof (ShmAllocSlab));
+  slab->first_page = first;
+  slab->size_class = size_class;
+  slab->object_size = object_size;
+  slab->n_objects = n_objects;
+  slab->blocks = (ShmAllocBlock **) (slab + 1);
+  slab->free_objects = (unsigned short *) (slab->blocks + n_objects);
+  memset (slab->blocks, 0, n_objects * sizeof (ShmAllocBlock *));
+
+  /* hand out the objects in order */
+  slab->n_free = n_objects;
+  for (i = 0; i < n_objects; i++)
+    slab->free_objects[i] = n_objects - 1 - i;
+
+  shm_alloc_pages_set_owner (self, first, SHM_ALLOC_SLAB_PAGES, NULL, slab);
+
+  slab->next = self->partial_slabs[size_class];
+  if (slab->next)
+    slab->next->prev = slab;
+  self->partial_slabs[size_class] = slab;
+
+  return slab;
+}
+
+static void
+shm_alloc_slab_unlink (ShmAllocSpace * self, ShmAllocSlab * slab)
+{
+  if (slab->prev)
+    slab->prev->next = slab->next;
+  else
+    self->partial_slabs[slab->size_class] = slab->next;
+
+  if (slab->next)
+    slab->next->prev = slab->prev;
+
+  slab->prev = slab->next = NULL;
+}
+
+static void
+shm_alloc_slab_free (ShmAllocSpace * self, ShmAllocSlab * slab)
+{
+  shm_alloc_slab_unlink (self, slab);
+  shm_alloc_pages_free (self, slab->first_page, SHM_ALLOC_SLAB_PAGES);
+  spalloc_free1 (sizeof (ShmAllocSlab) + slab->n_objects *
+      (sizeof (ShmAllocBlock *) + sizeof (unsigned short)), slab);
+}
+
+void
+shm_alloc_space_free (ShmAllocSpace * self)
+{
+  unsigned int i;
+
+  assert (self && self->n_blocks == 0);
+
+  /* only empty slabs can be left */
+  for (i = 0; i < SHM_ALLOC_N_SLAB_CLASSES; i++) {
+    while (self->partial_slabs[i])
+      shm_alloc_slab_free (self, self->partial_slabs[i]);
+  }
+
+  free (self->pages);
+  spalloc_free (ShmAllocSpace, self);
+}
+
+static ShmAllocBlock *
+shm_alloc_block_new (ShmAllocSpace * self, unsigned long offset,
+    unsigned long size, ShmAllocSlab * slab)
+{
+  ShmAllocBlock *block = spalloc_new (ShmAllocBlock);
+
   memset (block, 0, sizeof (ShmAllocBlock));
-  block->offset = prev_end_offset;
+  block->offset = offset;
   block->size = size;
   block->use_count = 1;
   block->space = self;
+  block->slab = slab;
+  self->n_blocks++;
 
-  if (prev_item)
-    prev_item->next = block;
-  else
-    self->blocks = block;
+  return block;
+}
 
-  block->next = item;
+static ShmAllocBlock *
+shm_alloc_slab_alloc_block (ShmAllocSpace * self, unsigned long size)
+{
+  ShmAllocSlab *slab;
+  ShmAllocBlock *block;
+  unsigned int size_class = 0;
+  unsigned int idx;
+
+  while ((1UL << (size_class + SHM_ALLOC_MIN_SLAB_SHIFT)) < size)
+    size_class++;
+
+  slab = self->partial_slabs[size_class];
+  if (!slab)
+    slab = shm_alloc_slab_new (self, size_class);
+  if (!slab)
+    return NULL;
+
+  idx = slab->free_objects[--slab->n_free];
+  block = shm_alloc_block_new (self,
+      SHM_ALLOC_PAGE_OFFSET (slab->first_page) + idx * slab->object_size,
+      size, slab);
+  slab->blocks[idx] = block;
+
+  if (slab->n_free == 0)
+    shm_alloc_slab_unlink (self, slab);
+
+  return block;
+}
+
+/* Returns 1 if there was any empty slab to give back */
+static int
+shm_alloc_space_free_empty_slabs (ShmAllocSpace * self)
+{
+  ShmAllocSlab *slab, *next;
+  unsigned int i;
+  int ret = 0;
+
+  for (i = 0; i < SHM_ALLOC_N_SLAB_CLASSES; i++) {
+    for (slab = self->partial_slabs[i]; slab; slab = next) {
+      next = slab->next;
+      if (slab->n_free == slab->n_objects) {
+        shm_alloc_slab_free (self, slab);
+        ret = 1;
+      }
+    }
+  }
+
+  return ret;
+}
+
+ShmAllocBlock *
+shm_alloc_space_alloc_block (ShmAllocSpace * self, unsigned long size)
+{
+  ShmAllocBlock *block;
+  unsigned long n_pages;
+  unsigned int first;
+
+  if (size <= SHM_ALLOC_MAX_SLAB_SIZE) {
+    block = shm_alloc_slab_alloc_block (self, size);
+    /* if there is no room for a new slab, a page may still be free */
+    if (block)
+      return block;
+  }
+
+  n_pages = SHM_ALLOC_BLOCK_PAGES (size);
+
+  /* Return NULL if there is no big enough space */
+  if (n_pages > self->n_pages)
+    return NULL;
+
+  first = shm_alloc_pages_alloc (self, n_pages, size);
+  /* the empty slabs kept around may be in the way */
+  if (first == SHM_ALLOC_NO_PAGE && shm_alloc_space_free_empty_slabs (self))
+    first = shm_alloc_pages_alloc (self, n_pages, size);
+  if (first == SHM_ALLOC_NO_PAGE)
+    return NULL;
+
+  block = shm_alloc_block_new (self, SHM_ALLOC_PAGE_OFFSET (first), size,
+      NULL);
+  shm_alloc_pages_set_owner (self, first, n_pages, block, NULL);
 
   return block;
 }
@@ -134,34 +522,58 @@ shm_alloc_space_alloc_block_get_offset (ShmAllocBlock * block)
 static void
 shm_alloc_space_free_block (ShmAllocBlock * block)
 {
-  ShmAllocBlock *item = NULL;
-  ShmAllocBlock *prev_item = NULL;
   ShmAllocSpace *self = block->space;
-
-  for (item = self->blocks; item; item = item->next) {
-    if (item == block) {
-      if (prev_item)
-        prev_item->next = item->next;
-      else
-        self->blocks = item->next;
-      break;
+  ShmAllocSlab *slab = block->slab;
+
+  if (slab) {
+    unsigned int idx = (block->offset -
+        SHM_ALLOC_PAGE_OFFSET (slab->first_page)) / slab->object_size;
+
+    slab->blocks[idx] = NULL;
+    slab->free_objects[slab->n_free++] = idx;
+
+    if (slab->n_free == 1) {
+      slab->next = self->partial_slabs[slab->size_class];
+      if (slab->next)
+        slab->next->prev = slab;
+      self->partial_slabs[slab->size_class] = slab;
+    } else if (slab->n_free == slab->n_objects &&
+        (slab->prev || slab->next)) {
+      /* keep the last slab of each size around to avoid churn */
+      shm_alloc_slab_free (self, slab);
     }
-    prev_item = item;
+  } else {
+    shm_alloc_pages_free (self, block->offset >> SHM_ALLOC_PAGE_SHIFT,
+        SHM_ALLOC_BLOCK_PAGES (block->size));
   }
 
+  self->n_blocks--;
   spalloc_free (ShmAllocBlock, block);
 }
 
 ShmAllocBlock *
 shm_alloc_space_block_get (ShmAllocSpace * self, unsigned long offset)
 {
+  ShmAllocPage *page;
   ShmAllocBlock *block = NULL;
 
-  for (block = self->blocks; block; block = block->next) {
-    if (block->offset <= offset && (block->offset + block->size) > offset)
-      return block;
+  if (offset >= self->size)
+    return NULL;
+
+  page = &self->pages[offset >> SHM_ALLOC_PAGE_SHIFT];
+
+  if (page->block) {
+    block = page->block;
+  } else if (page->slab) {
+    ShmAllocSlab *slab = page->slab;
+
+    block = slab->blocks[(offset - SHM_ALLOC_PAGE_OFFSET (slab->first_page)) /
+        slab->object_size];
   }
 
+  if (block && block->offset <= offset && (block->offset + block->size) > offset)
+    return block;
+
   return NULL;
 }
 
@@ -180,3 +592,40 @@ shm_alloc_space_block_dec (ShmAllocBlock * block)
   if (block->use_count <= 0)
     shm_alloc_space_free_block (block);
 }
+
+size_t
+shm_alloc_space_get_used (ShmAllocSpace * self)
+{
+  return self->used;
+}
+
+size_t
+shm_alloc_space_get_high_water_mark (ShmAllocSpace * self)
+{
+  return self->high_water_mark;
+}
+
+size_t
+shm_alloc_space_get_largest_free (ShmAllocSpace * self)
+{
+  unsigned int c, first;
+  size_t largest = 0;
+
+  if (!self->free_runs_mask)
+    return 0;
+
+  /* the longest run is in the highest class */
+  for (c = SHM_ALLOC_N_RUN_CLASSES - 1; !(self->free_runs_mask & (1U << c));
+      c--);
+
+  for (first = self->free_runs[c]; first != SHM_ALLOC_NO_PAGE;
+      first = self->pages[first].next_run) {
+    size_t bytes = shm_alloc_pages_bytes (self, first,
+        self->pages[first].run_pages);
+
+    if (bytes > largest)
+      largest = bytes;
+  }
+
+  return largest;
+}
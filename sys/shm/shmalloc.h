@@ -66,6 +66,10 @@ void shm_alloc_space_block_dec (ShmAllocBlock * block);
 ShmAllocBlock * shm_alloc_space_block_get (ShmAllocSpace * space,
     unsigned long offset);
 
+size_t shm_alloc_space_get_used (ShmAllocSpace * self);
+size_t shm_alloc_space_get_high_water_mark (ShmAllocSpace * self);
+size_t shm_alloc_space_get_largest_free (ShmAllocSpace * self);
+
 
 #ifdef __cplusplus
 }
@@ -47,6 +47,10 @@
 #include <sys/mman.h>
 #include <assert.h>
 
+#ifdef HAVE_SYS_EVENTFD_H
+#include <sys/eventfd.h>
+#endif
+
 #include "shmalloc.h"
 
 /*
@@ -67,9 +71,24 @@
  * type 4: ack buffer
  * offset
  *
+ * type 5: new ring
+ * Ring area length
+ * Size of path (followed by path)
+ * Number of slots
+ * Sent with two eventfds, the reader's wakeup and the writer's wakeup
+ *
  * Type 4 goes from the client to the server
  * The rest are from the server to the client
- * The client should never write in the SHM
+ * The client should never write in the SHM, except in its ring area
+ *
+ * If the writer has a ring size, each client gets its own ring area,
+ * shared read-write between the writer and that client only, with one
+ * queue of buffer descriptors going to the client and one queue of acks
+ * coming back. These replace types 3 and 4, the socket is still used for
+ * the shm areas. Each queue has a single producer and a single consumer,
+ * so they need no lock. The consumer raises a flag before going to sleep
+ * and the producer only writes to the eventfd when it clears that flag, so
+ * a busy reader gets all its buffers without any syscall.
  */
 
 
@@ -80,7 +99,72 @@ enum
   COMMAND_NEW_SHM_AREA = 1,
   COMMAND_CLOSE_SHM_AREA = 2,
   COMMAND_NEW_BUFFER = 3,
-  COMMAND_ACK_BUFFER = 4
+  COMMAND_ACK_BUFFER = 4,
+  COMMAND_NEW_RING = 5
+};
+
+#define SHM_RING_CACHELINE 64
+/* file descriptors that can come with a command */
+#define MAX_COMMAND_FDS 2
+
+typedef struct _ShmRing ShmRing;
+typedef struct _ShmRingArea ShmRingArea;
+typedef struct _ShmRingQueue ShmRingQueue;
+typedef struct _ShmRingDesc ShmRingDesc;
+
+/* Layout of the shared ring area, head is only written by the producer
+ * and tail by the consumer, on separate cache lines. waiting is set by
+ * the consumer and cleared by the producer that wakes it up. */
+struct _ShmRingQueue
+{
+  volatile uint32_t head;
+  char pad0[SHM_RING_CACHELINE - sizeof (uint32_t)];
+  volatile uint32_t tail;
+  volatile uint32_t waiting;
+  char pad1[SHM_RING_CACHELINE - 2 * sizeof (uint32_t)];
+};
+
+struct _ShmRingDesc
+{
+  int32_t area_id;
+  uint32_t reserved;
+  uint64_t offset;
+  uint64_t size;
+};
+
+struct _ShmRingArea
+{
+  uint32_t n_slots;
+  char pad[SHM_RING_CACHELINE - sizeof (uint32_t)];
+
+  ShmRingQueue buffers;
+  ShmRingQueue acks;
+
+  /* n_slots buffer descriptors followed by n_slots acks */
+  ShmRingDesc descs[0];
+};
+
+#define SHM_RING_AREA_SIZE(n_slots) \
+  (sizeof (ShmRingArea) + 2 * (n_slots) * sizeof (ShmRingDesc))
+#define SHM_RING_BUFFER_SLOTS(ring) ((ring)->area->descs)
+#define SHM_RING_ACK_SLOTS(ring) ((ring)->area->descs + (ring)->n_slots)
+
+struct _ShmRing
+{
+  /* only set on the writer side, which unlinks it */
+  char *name;
+  int shm_fd;
+  ShmRingArea *area;
+  size_t size;
+  unsigned int n_slots;
+
+  /* eventfd waking up the reader, and on the reader side the one waking
+   * up the writer, which belongs to the pipe on the writer side */
+  int buffers_fd;
+  int acks_fd;
+
+  /* writer side, buffers sent through the ring and not acked yet */
+  unsigned int pending;
 };
 
 typedef struct _ShmArea ShmArea;
@@ -140,12 +224,24 @@ struct _ShmPipe
   ShmClient *clients;
 
   mode_t perms;
+
+  /* writer: number of slots of the rings of new clients, 0 to send the
+   * buffers over the socket, and the eventfd all the clients ack on */
+  unsigned int ring_size;
+  int ack_fd;
+
+  /* reader: the ring received from the writer, if any */
+  ShmRing *ring;
 };
 
 struct _ShmClient
 {
   int fd;
 
+  ShmRing *ring;
+  /* buffers not sent because the ring was full */
+  unsigned int drops;
+
   ShmClient *next;
 };
 
@@ -178,14 +274,23 @@ struct CommandBuffer
     {
       unsigned long offset;
     } ack_buffer;
+    struct
+    {
+      size_t size;
+      unsigned int path_size;
+      unsigned int n_slots;
+      /* Followed by path */
+    } new_ring;
   } payload;
 };
 
 static ShmArea *sp_open_shm (char *path, int id, mode_t perms, size_t size);
 static void sp_close_shm (ShmArea * area);
+static int sp_shmbuf_has_client (ShmBuffer * buf, ShmClient * client);
 static int sp_shmbuf_dec (ShmPipe * self, ShmBuffer * buf,
     ShmBuffer * prev_buf, ShmClient * client, void **tag);
 static void sp_shm_area_dec (ShmPipe * self, ShmArea * area);
+static void sp_ring_close (ShmRing * ring);
 
 
 
@@ -207,6 +312,7 @@ sp_writer_create (const char *path, size_t size, mode_t perms)
 
   self->main_socket = socket (PF_UNIX, SOCK_STREAM, 0);
   self->use_count = 1;
+  self->ack_fd = -1;
 
   if (self->main_socket < 0)
     RETURN_ERROR ("Could not create socket (%d): %s\n", errno,
@@ -360,6 +466,222 @@ sp_close_shm (ShmArea * area)
   spalloc_free (ShmArea, area);
 }
 
+#ifdef HAVE_SYS_EVENTFD_H
+/* Creates the ring area of a new client on the writer side */
+static ShmRing *
+sp_ring_create (unsigned int n_slots, mode_t perms)
+{
+  ShmRing *ring = spalloc_new (ShmRing);
+  char tmppath[32];
+  int i = 0;
+
+  memset (ring, 0, sizeof (ShmRing));
+  ring->shm_fd = -1;
+  ring->area = MAP_FAILED;
+  ring->n_slots = n_slots;
+  ring->size = SHM_RING_AREA_SIZE (n_slots);
+  ring->buffers_fd = -1;
+  ring->acks_fd = -1;
+
+  do {
+    snprintf (tmppath, sizeof (tmppath), "/shmpipe-ring.%5d.%5d", getpid (),
+        i++);
+    ring->shm_fd = shm_open (tmppath, O_RDWR | O_CREAT | O_EXCL, perms);
+  } while (ring->shm_fd < 0 && errno == EEXIST);
+
+  if (ring->shm_fd < 0) {
+    fprintf (stderr, "shm_open failed on %s (%d): %s\n", tmppath, errno,
+        strerror (errno));
+    goto error;
+  }
+
+  ring->name = strdup (tmppath);
+
+  if (ftruncate (ring->shm_fd, ring->size)) {
+    fprintf (stderr, "Could not resize ring area, ftruncate failed (%d): %s\n",
+        errno, strerror (errno));
+    goto error;
+  }
+
+  ring->area = mmap (NULL, ring->size, PROT_READ | PROT_WRITE, MAP_SHARED,
+      ring->shm_fd, 0);
+  if (ring->area == MAP_FAILED) {
+    fprintf (stderr, "mmap failed (%d): %s\n", errno, strerror (errno));
+    goto error;
+  }
+
+  ring->buffers_fd = eventfd (0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (ring->buffers_fd < 0) {
+    fprintf (stderr, "eventfd failed (%d): %s\n", errno, strerror (errno));
+    goto error;
+  }
+
+  /* ftruncate() zeroed the queues, both consumers start idle */
+  ring->area->n_slots = n_slots;
+  ring->area->buffers.waiting = 1;
+  ring->area->acks.waiting = 1;
+
+  return ring;
+
+error:
+  sp_ring_close (ring);
+  return NULL;
+}
+#endif
+
+/* Maps the ring area received from the writer, takes the eventfds */
+static ShmRing *
+sp_ring_open (const char *path, size_t size, unsigned int n_slots,
+    int buffers_fd, int acks_fd)
+{
+  ShmRing *ring = spalloc_new (ShmRing);
+
+  memset (ring, 0, sizeof (ShmRing));
+  ring->shm_fd = -1;
+  ring->area = MAP_FAILED;
+  ring->n_slots = n_slots;
+  ring->size = size;
+  ring->buffers_fd = buffers_fd;
+  ring->acks_fd = acks_fd;
+
+  if (n_slots == 0 || (n_slots & (n_slots - 1)) != 0 ||
+      size != SHM_RING_AREA_SIZE (n_slots)) {
+    fprintf (stderr, "Invalid ring of %u slots in %lu bytes\n", n_slots,
+        (unsigned long) size);
+    goto error;
+  }
+
+  ring->shm_fd = shm_open (path, O_RDWR, 0);
+  if (ring->shm_fd < 0) {
+    fprintf (stderr, "shm_open failed on %s (%d): %s\n", path, errno,
+        strerror (errno));
+    goto error;
+  }
+
+  ring->area = mmap (NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED,
+      ring->shm_fd, 0);
+  if (ring->area == MAP_FAILED) {
+    fprintf (stderr, "mmap failed (%d): %s\n", errno, strerror (errno));
+    goto error;
+  }
+
+  if (ring->area->n_slots != n_slots) {
+    fprintf (stderr, "Ring area has %u slots instead of %u\n",
+        ring->area->n_slots, n_slots);
+    goto error;
+  }
+
+  return ring;
+
+error:
+  sp_ring_close (ring);
+  return NULL;
+}
+
+static void
+sp_ring_close (ShmRing * ring)
+{
+  if (ring->area != MAP_FAILED)
+    munmap (ring->area, ring->size);
+
+  if (ring->shm_fd >= 0)
+    close (ring->shm_fd);
+
+  if (ring->name) {
+    shm_unlink (ring->name);
+    free (ring->name);
+  }
+
+  if (ring->buffers_fd >= 0)
+    close (ring->buffers_fd);
+  if (ring->acks_fd >= 0)
+    close (ring->acks_fd);
+
+  spalloc_free (ShmRing, ring);
+}
+
+static void
+sp_eventfd_signal (int fd)
+{
+  uint64_t one = 1;
+
+  while (write (fd, &one, sizeof (one)) < 0 && errno == EINTR);
+}
+
+static void
+sp_eventfd_clear (int fd)
+{
+  uint64_t count;
+
+  while (read (fd, &count, sizeof (count)) < 0 && errno == EINTR);
+}
+
+/* Producer side, returns 0 if the queue is full */
+static int
+sp_ring_queue_push (ShmRingQueue * queue, ShmRingDesc * slots,
+    unsigned int n_slots, const ShmRingDesc * desc, int wake_fd)
+{
+  uint32_t head = queue->head;
+
+  if (head - queue->tail >= n_slots)
+    return 0;
+
+  slots[head & (n_slots - 1)] = *desc;
+  /* the descriptor must be visible before the new head */
+  __sync_synchronize ();
+  queue->head = head + 1;
+
+  /* and the new head before we look at the flag, pairs with the barrier
+   * in sp_ring_queue_arm() */
+  __sync_synchronize ();
+  if (queue->waiting && __sync_bool_compare_and_swap (&queue->waiting, 1, 0))
+    sp_eventfd_signal (wake_fd);
+
+  return 1;
+}
+
+/* Consumer side, returns 1 and copies the next descriptor without
+ * consuming it, 0 if the queue is empty and -1 if the other side
+ * corrupted it */
+static int
+sp_ring_queue_peek (ShmRingQueue * queue, ShmRingDesc * slots,
+    unsigned int n_slots, ShmRingDesc * desc)
+{
+  uint32_t tail = queue->tail;
+  uint32_t head = queue->head;
+
+  if (head == tail)
+    return 0;
+
+  if (head - tail > n_slots)
+    return -1;
+
+  /* don't read the descriptor before the head */
+  __sync_synchronize ();
+  *desc = slots[tail & (n_slots - 1)];
+
+  return 1;
+}
+
+static void
+sp_ring_queue_advance (ShmRingQueue * queue)
+{
+  /* we're done with the slot before the producer can reuse it */
+  __sync_synchronize ();
+  queue->tail++;
+}
+
+/* Consumer side, asks for a wakeup on the next push. Returns 1 if
+ * something was pushed meanwhile and the queue must be read again. */
+static int
+sp_ring_queue_arm (ShmRingQueue * queue)
+{
+  queue->waiting = 1;
+  __sync_synchronize ();
+
+  return queue->head != queue->tail;
+}
+
 static void
 sp_shm_area_inc (ShmArea * area)
 {
@@ -441,6 +763,16 @@ sp_writer_close (ShmPipe * self, sp_buffer_free_callback callback,
   while (self->clients)
     sp_writer_close_client (self, self->clients, callback, user_data);
 
+  if (self->ring) {
+    sp_ring_close (self->ring);
+    self->ring = NULL;
+  }
+
+  if (self->ack_fd >= 0) {
+    close (self->ack_fd);
+    self->ack_fd = -1;
+  }
+
   sp_dec (self);
 }
 
@@ -456,11 +788,17 @@ sp_writer_setperms_shm (ShmPipe * self, mode_t perms)
 {
   int ret = 0;
   ShmArea *area;
+  ShmClient *client;
 
   self->perms = perms;
   for (area = self->shm_area; area; area = area->next)
     ret |= fchmod (area->shm_fd, perms);
 
+  for (client = self->clients; client; client = client->next) {
+    if (client->ring)
+      ret |= fchmod (client->ring->shm_fd, perms);
+  }
+
   ret |= chmod (self->socket_path, perms);
 
   return ret;
@@ -480,6 +818,46 @@ send_command (int fd, struct CommandBuffer *cb, unsigned short int type,
   return 1;
 }
 
+#ifdef HAVE_SYS_EVENTFD_H
+static int
+send_command_fds (int fd, struct CommandBuffer *cb, unsigned short int type,
+    int area_id, const int *fds, int n_fds)
+{
+  struct msghdr msg;
+  struct iovec iov;
+  struct cmsghdr *cmsg;
+  union
+  {
+    struct cmsghdr hdr;
+    char buf[CMSG_SPACE (sizeof (int) * MAX_COMMAND_FDS)];
+  } control;
+
+  assert (n_fds > 0 && n_fds <= MAX_COMMAND_FDS);
+
+  cb->type = type;
+  cb->area_id = area_id;
+
+  memset (&msg, 0, sizeof (msg));
+  iov.iov_base = cb;
+  iov.iov_len = sizeof (struct CommandBuffer);
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control.buf;
+  msg.msg_controllen = CMSG_SPACE (sizeof (int) * n_fds);
+
+  cmsg = CMSG_FIRSTHDR (&msg);
+  cmsg->cmsg_level = SOL_SOCKET;
+  cmsg->cmsg_type = SCM_RIGHTS;
+  cmsg->cmsg_len = CMSG_LEN (sizeof (int) * n_fds);
+  memcpy (CMSG_DATA (cmsg), fds, sizeof (int) * n_fds);
+
+  if (sendmsg (fd, &msg, MSG_NOSIGNAL) != sizeof (struct CommandBuffer))
+    return 0;
+
+  return 1;
+}
+#endif
+
 int
 sp_writer_resize (ShmPipe * self, size_t size)
 {
@@ -609,11 +987,35 @@ sp_writer_send_buf (ShmPipe * self, char *buf, size_t size, void *tag)
   sb->tag = tag;
 
   for (client = self->clients; client; client = client->next) {
-    struct CommandBuffer cb = { 0 };
-    cb.payload.buffer.offset = offset;
-    cb.payload.buffer.size = bsize;
-    if (!send_command (client->fd, &cb, COMMAND_NEW_BUFFER, self->shm_area->id))
-      continue;
+    if (client->ring) {
+      ShmRing *ring = client->ring;
+      ShmRingDesc desc = { 0 };
+
+      /* the acks queue has room for all the pending buffers, a client
+       * that does not keep up misses buffers without stalling the others */
+      if (ring->pending >= ring->n_slots) {
+        client->drops++;
+        continue;
+      }
+
+      desc.area_id = area->id;
+      desc.offset = offset;
+      desc.size = bsize;
+      if (!sp_ring_queue_push (&ring->area->buffers,
+              SHM_RING_BUFFER_SLOTS (ring), ring->n_slots, &desc,
+              ring->buffers_fd)) {
+        client->drops++;
+        continue;
+      }
+      ring->pending++;
+    } else {
+      struct CommandBuffer cb = { 0 };
+      cb.payload.buffer.offset = offset;
+      cb.payload.buffer.size = bsize;
+      if (!send_command (client->fd, &cb, COMMAND_NEW_BUFFER,
+              self->shm_area->id))
+        continue;
+    }
     sb->clients[i++] = client->fd;
     c++;
   }
@@ -634,15 +1036,63 @@ sp_writer_send_buf (ShmPipe * self, char *buf, size_t size, void *tag)
   return c;
 }
 
+/* Any file descriptor received with the command is returned in @fds if
+ * it is not NULL and closed otherwise */
 static int
-recv_command (int fd, struct CommandBuffer *cb)
+recv_command (int fd, struct CommandBuffer *cb, int *fds, int *n_fds)
 {
+  struct msghdr msg;
+  struct iovec iov;
+  struct cmsghdr *cmsg;
+  union
+  {
+    struct cmsghdr hdr;
+    char buf[CMSG_SPACE (sizeof (int) * MAX_COMMAND_FDS)];
+  } control;
+  int flags = MSG_DONTWAIT;
   int retval;
+  int n = 0;
+
+#ifdef MSG_CMSG_CLOEXEC
+  flags |= MSG_CMSG_CLOEXEC;
+#endif
+
+  memset (&msg, 0, sizeof (msg));
+  iov.iov_base = cb;
+  iov.iov_len = sizeof (struct CommandBuffer);
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control.buf;
+  msg.msg_controllen = sizeof (control.buf);
+
+  retval = recvmsg (fd, &msg, flags);
+
+  if (retval > 0) {
+    for (cmsg = CMSG_FIRSTHDR (&msg); cmsg; cmsg = CMSG_NXTHDR (&msg, cmsg)) {
+      int *received;
+      int i, count;
+
+      if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS)
+        continue;
+
+      received = (int *) CMSG_DATA (cmsg);
+      count = (cmsg->cmsg_len - CMSG_LEN (0)) / sizeof (int);
+      for (i = 0; i < count; i++) {
+        if (fds && n < MAX_COMMAND_FDS)
+          fds[n++] = received[i];
+        else
+          close (received[i]);
+      }
+    }
+  }
 
-  retval = recv (fd, cb, sizeof (struct CommandBuffer), MSG_DONTWAIT);
   if (retval == sizeof (struct CommandBuffer)) {
+    if (n_fds)
+      *n_fds = n;
     return 1;
   } else {
+    while (n > 0)
+      close (fds[--n]);
     return 0;
   }
 }
@@ -654,11 +1104,18 @@ sp_client_recv (ShmPipe * self, char **buf)
   ShmArea *newarea;
   ShmArea *area;
   struct CommandBuffer cb;
+  int fds[MAX_COMMAND_FDS];
+  int n_fds = 0;
   int retval;
 
-  if (!recv_command (self->main_socket, &cb))
+  if (!recv_command (self->main_socket, &cb, fds, &n_fds))
     return -1;
 
+  if (cb.type != COMMAND_NEW_RING) {
+    while (n_fds > 0)
+      close (fds[--n_fds]);
+  }
+
   switch (cb.type) {
     case COMMAND_NEW_SHM_AREA:
       assert (cb.payload.new_shm_area.path_size > 0);
@@ -702,6 +1159,31 @@ sp_client_recv (ShmPipe * self, char **buf)
       }
       return -23;
 
+    case COMMAND_NEW_RING:
+      if (n_fds != 2 || self->ring || cb.payload.new_ring.path_size == 0) {
+        while (n_fds > 0)
+          close (fds[--n_fds]);
+        return -5;
+      }
+
+      area_name = malloc (cb.payload.new_ring.path_size);
+      retval = recv (self->main_socket, area_name,
+          cb.payload.new_ring.path_size, 0);
+      if (retval != cb.payload.new_ring.path_size) {
+        free (area_name);
+        close (fds[0]);
+        close (fds[1]);
+        return -3;
+      }
+      area_name[retval - 1] = '\0';
+
+      self->ring = sp_ring_open (area_name, cb.payload.new_ring.size,
+          cb.payload.new_ring.n_slots, fds[0], fds[1]);
+      free (area_name);
+      if (!self->ring)
+        return -6;
+      break;
+
     default:
       return -99;
   }
@@ -715,7 +1197,7 @@ sp_writer_recv (ShmPipe * self, ShmClient * client, void **tag)
   ShmBuffer *buf = NULL, *prev_buf = NULL;
   struct CommandBuffer cb;
 
-  if (!recv_command (client->fd, &cb))
+  if (!recv_command (client->fd, &cb, NULL, NULL))
     return -1;
 
   switch (cb.type) {
@@ -723,7 +1205,8 @@ sp_writer_recv (ShmPipe * self, ShmClient * client, void **tag)
 
       for (buf = self->buffers; buf; buf = buf->next) {
         if (buf->shm_area->id == cb.area_id &&
-            buf->offset == cb.payload.ack_buffer.offset) {
+            buf->offset == cb.payload.ack_buffer.offset &&
+            sp_shmbuf_has_client (buf, client)) {
           return sp_shmbuf_dec (self, buf, prev_buf, client, tag);
         }
         prev_buf = buf;
@@ -737,6 +1220,126 @@ sp_writer_recv (ShmPipe * self, ShmClient * client, void **tag)
   return 0;
 }
 
+int
+sp_writer_set_ring_size (ShmPipe * self, unsigned int n_slots)
+{
+#ifdef HAVE_SYS_EVENTFD_H
+  unsigned int size = 1;
+
+  if (n_slots == 0) {
+    self->ring_size = 0;
+    return 0;
+  }
+
+  while (size < n_slots)
+    size <<= 1;
+
+  if (self->ack_fd < 0) {
+    self->ack_fd = eventfd (0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (self->ack_fd < 0)
+      return -1;
+  }
+
+  self->ring_size = size;
+  return 0;
+#else
+  return n_slots ? -1 : 0;
+#endif
+}
+
+int
+sp_writer_get_ack_fd (ShmPipe * self)
+{
+  return self->ack_fd;
+}
+
+void
+sp_writer_clear_ack_fd (ShmPipe * self)
+{
+  if (self->ack_fd >= 0)
+    sp_eventfd_clear (self->ack_fd);
+}
+
+/* Returns the number of acks received, or a negative number if the
+ * client sent an invalid one */
+int
+sp_writer_recv_acks (ShmPipe * self, ShmClient * client,
+    sp_buffer_free_callback callback, void *user_data)
+{
+  ShmRing *ring = client->ring;
+  ShmRingDesc ack;
+  int n = 0;
+  int ret;
+
+  if (!ring)
+    return 0;
+
+  do {
+    while ((ret = sp_ring_queue_peek (&ring->area->acks,
+                SHM_RING_ACK_SLOTS (ring), ring->n_slots, &ack)) > 0) {
+      ShmBuffer *buf = NULL, *prev_buf = NULL;
+      void *tag = NULL;
+
+      sp_ring_queue_advance (&ring->area->acks);
+
+      for (buf = self->buffers; buf; buf = buf->next) {
+        if (buf->shm_area->id == ack.area_id && buf->offset == ack.offset &&
+            sp_shmbuf_has_client (buf, client))
+          break;
+        prev_buf = buf;
+      }
+
+      if (!buf)
+        return -2;
+
+      if (sp_shmbuf_dec (self, buf, prev_buf, client, &tag) == 0 && callback)
+        callback (tag, user_data);
+      n++;
+    }
+
+    if (ret < 0)
+      return -24;
+  } while (sp_ring_queue_arm (&ring->area->acks));
+
+  return n;
+}
+
+/* Returns 0 if the ring of a client is full, the writer must then wait for
+ * acks before sending */
+int
+sp_writer_can_send_buf (ShmPipe * self)
+{
+  ShmClient *client;
+
+  for (client = self->clients; client; client = client->next) {
+    if (client->ring && client->ring->pending >= client->ring->n_slots)
+      return 0;
+  }
+
+  return 1;
+}
+
+/* Returns the number of buffers that were not sent to a client because its
+ * ring was full */
+unsigned int
+sp_writer_get_client_drops (ShmClient * client)
+{
+  return client->drops;
+}
+
+/* Returns the sum of the drops of all the connected clients */
+unsigned long
+sp_writer_get_drops (ShmPipe * self)
+{
+  ShmClient *client;
+  unsigned long drops = 0;
+
+  for (client = self->clients; client; client = client->next)
+    drops += client->drops;
+
+  return drops;
+}
+
 int
 sp_client_recv_finish (ShmPipe * self, char *buf)
 {
@@ -754,6 +1357,24 @@ sp_client_recv_finish (ShmPipe * self, char *buf)
 
   offset = buf - shm_area->shm_area_buf;
 
+  if (self->ring) {
+    ShmRing *ring = self->ring;
+    ShmRingDesc ack = { 0 };
+
+    ack.area_id = shm_area->id;
+    ack.offset = offset;
+    sp_shm_area_dec (self, shm_area);
+
+    if (sp_ring_queue_push (&ring->area->acks, SHM_RING_ACK_SLOTS (ring),
+            ring->n_slots, &ack, ring->acks_fd))
+      return 1;
+
+    /* the writer never has more buffers out than ack slots, so this is
+     * not supposed to happen, but the socket still works */
+    cb.payload.ack_buffer.offset = offset;
+    return send_command (self->main_socket, &cb, COMMAND_ACK_BUFFER, ack.area_id);
+  }
+
   sp_shm_area_dec (self, shm_area);
 
   cb.payload.ack_buffer.offset = offset;
@@ -761,6 +1382,71 @@ sp_client_recv_finish (ShmPipe * self, char *buf)
       self->shm_area->id);
 }
 
+long int
+sp_client_ring_recv (ShmPipe * self, char **buf)
+{
+  ShmRing *ring = self->ring;
+  ShmRingDesc desc;
+  ShmArea *area;
+  int ret;
+
+  *buf = NULL;
+
+  if (!ring)
+    return 0;
+
+  ret = sp_ring_queue_peek (&ring->area->buffers, SHM_RING_BUFFER_SLOTS (ring),
+      ring->n_slots, &desc);
+
+  if (ret == 0) {
+    /* going to sleep, forget the wakeups of the buffers we already got */
+    sp_eventfd_clear (ring->buffers_fd);
+    if (!sp_ring_queue_arm (&ring->area->buffers))
+      return 0;
+    ret = sp_ring_queue_peek (&ring->area->buffers,
+        SHM_RING_BUFFER_SLOTS (ring), ring->n_slots, &desc);
+  }
+
+  if (ret < 0)
+    return -24;
+  if (ret == 0)
+    return 0;
+
+  for (area = self->shm_area; area; area = area->next) {
+    if (area->id == desc.area_id)
+      break;
+  }
+
+  if (!area) {
+    char c;
+
+    /* A new area is announced on the socket before it is used, leave the
+     * buffer in the ring until that is read */
+    if (recv (self->main_socket, &c, 1, MSG_PEEK | MSG_DONTWAIT) == 1)
+      return 0;
+    return -23;
+  }
+
+  if (desc.offset > area->shm_area_len ||
+      desc.size > area->shm_area_len - desc.offset)
+    return -25;
+
+  sp_ring_queue_advance (&ring->area->buffers);
+
+  *buf = area->shm_area_buf + desc.offset;
+  sp_shm_area_inc (area);
+  return desc.size;
+}
+
+int
+sp_client_get_ring_fd (ShmPipe * self)
+{
+  if (!self->ring)
+    return -1;
+
+  return self->ring->buffers_fd;
+}
+
 ShmPipe *
 sp_client_open (const char *path)
 {
@@ -772,6 +1458,7 @@ sp_client_open (const char *path)
 
   self->main_socket = socket (PF_UNIX, SOCK_STREAM, 0);
   self->use_count = 1;
+  self->ack_fd = -1;
 
   if (self->main_socket < 0)
     goto error;
@@ -802,6 +1489,7 @@ ShmClient *
 sp_writer_accept_client (ShmPipe * self)
 {
   ShmClient *client = NULL;
+  ShmRing *ring = NULL;
   int fd;
   struct CommandBuffer cb = { 0 };
   int pathlen = strlen (self->shm_area->shm_area_name) + 1;
@@ -827,8 +1515,36 @@ sp_writer_accept_client (ShmPipe * self)
     goto error;
   }
 
+#ifdef HAVE_SYS_EVENTFD_H
+  if (self->ring_size > 0) {
+    int fds[2];
+
+    ring = sp_ring_create (self->ring_size, self->perms);
+    if (!ring)
+      goto error;
+
+    pathlen = strlen (ring->name) + 1;
+    fds[0] = ring->buffers_fd;
+    fds[1] = self->ack_fd;
+    cb.payload.new_ring.size = ring->size;
+    cb.payload.new_ring.path_size = pathlen;
+    cb.payload.new_ring.n_slots = ring->n_slots;
+    if (!send_command_fds (fd, &cb, COMMAND_NEW_RING, 0, fds, 2)) {
+      fprintf (stderr, "Sending new ring failed: %s", strerror (errno));
+      goto error;
+    }
+
+    if (send (fd, ring->name, pathlen, MSG_NOSIGNAL) != pathlen) {
+      fprintf (stderr, "Sending new ring path failed: %s", strerror (errno));
+      goto error;
+    }
+  }
+#endif
+
   client = spalloc_new (ShmClient);
   client->fd = fd;
+  client->ring = ring;
+  client->drops = 0;
 
   /* Prepend ot linked list */
   client->next = self->clients;
@@ -838,11 +1554,26 @@ sp_writer_accept_client (ShmPipe * self)
   return client;
 
 error:
+  if (ring)
+    sp_ring_close (ring);
   shutdown (fd, SHUT_RDWR);
   close (fd);
   return NULL;
 }
 
+static int
+sp_shmbuf_has_client (ShmBuffer * buf, ShmClient * client)
+{
+  int i;
+
+  for (i = 0; i < buf->num_clients; i++) {
+    if (buf->clients[i] == client->fd)
+      return 1;
+  }
+
+  return 0;
+}
+
 static int
 sp_shmbuf_dec (ShmPipe * self, ShmBuffer * buf, ShmBuffer * prev_buf,
     ShmClient * client, void **tag)
@@ -865,6 +1596,9 @@ sp_shmbuf_dec (ShmPipe * self, ShmBuffer * buf, ShmBuffer * prev_buf,
   }
   assert (had_client);
 
+  if (client->ring)
+    client->ring->pending--;
+
   buf->use_count--;
 
   if (buf->use_count == 0) {
@@ -926,6 +1660,9 @@ again:
 
   self->num_clients--;
 
+  if (client->ring)
+    sp_ring_close (client->ring);
+
   spalloc_free (ShmClient, client);
 }
 
@@ -971,6 +1708,20 @@ sp_writer_buf_get_tag (ShmBuffer * buffer)
   return buffer->tag;
 }
 
+/* Statistics of the allocations in the current shm area, the previous ones
+ * are only kept until their buffers are released */
+void
+sp_writer_get_alloc_stats (ShmPipe * self, size_t * size, size_t * used,
+    size_t * high_water_mark, size_t * largest_free)
+{
+  ShmAllocSpace *space = self->shm_area->allocspace;
+
+  *size = self->shm_area->shm_area_len;
+  *used = shm_alloc_space_get_used (space);
+  *high_water_mark = shm_alloc_space_get_high_water_mark (space);
+  *largest_free = shm_alloc_space_get_largest_free (space);
+}
+
 size_t
 sp_writer_get_max_buf_size (ShmPipe * self)
 {
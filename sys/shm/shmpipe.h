@@ -56,6 +56,20 @@
  * buffers are no longer valid. If was valid buffer was received, the
  * client must release it with sp_client_recv_finish() when it is done
  * reading from it.
+ *
+ * If the writer sets a ring size with sp_writer_set_ring_size() before
+ * accepting clients, the buffers and acks go through a ring in shared
+ * memory instead of the socket. The writer then also select()s on the fd
+ * from sp_writer_get_ack_fd(), and when it is readable calls
+ * sp_writer_clear_ack_fd() then sp_writer_recv_acks() for each client.
+ * A buffer is not sent to the clients whose ring is full, it is counted in
+ * sp_writer_get_client_drops() instead. A writer that would rather wait
+ * for the slowest client must not send while sp_writer_can_send_buf()
+ * returns 0, and wait for acks first. The reader gets the ring after an internal
+ * message, from then on it calls sp_client_ring_recv() before reading the
+ * socket, which returns the size of the next buffer of the ring, or 0 with
+ * a NULL buffer if there is none, and also select()s on the fd from
+ * sp_client_get_ring_fd().
  */
 
 
@@ -99,6 +113,8 @@ int sp_writer_send_buf (ShmPipe * self, char *buf, size_t size, void * tag);
 char *sp_writer_block_get_buf (ShmBlock *block);
 ShmPipe *sp_writer_block_get_pipe (ShmBlock *block);
 size_t sp_writer_get_max_buf_size (ShmPipe * self);
+void sp_writer_get_alloc_stats (ShmPipe * self, size_t * size, size_t * used,
+    size_t * high_water_mark, size_t * largest_free);
 
 ShmClient * sp_writer_accept_client (ShmPipe * self);
 void sp_writer_close_client (ShmPipe *self, ShmClient * client,
@@ -107,6 +123,15 @@ int sp_writer_recv (ShmPipe * self, ShmClient * client, void ** tag);
 
 int sp_writer_pending_writes (ShmPipe * self);
 
+int sp_writer_set_ring_size (ShmPipe * self, unsigned int n_slots);
+int sp_writer_get_ack_fd (ShmPipe * self);
+void sp_writer_clear_ack_fd (ShmPipe * self);
+int sp_writer_recv_acks (ShmPipe * self, ShmClient * client,
+    sp_buffer_free_callback callback, void * user_data);
+int sp_writer_can_send_buf (ShmPipe * self);
+unsigned int sp_writer_get_client_drops (ShmClient * client);
+unsigned long sp_writer_get_drops (ShmPipe * self);
+
 ShmBuffer *sp_writer_get_pending_buffers (ShmPipe * self);
 ShmBuffer *sp_writer_get_next_buffer (ShmBuffer * buffer);
 void *sp_writer_buf_get_tag (ShmBuffer * buffer);
@@ -114,6 +139,8 @@ void *sp_writer_buf_get_tag (ShmBuffer * buffer);
 ShmPipe *sp_client_open (const char *path);
 long int sp_client_recv (ShmPipe * self, char **buf);
 int sp_client_recv_finish (ShmPipe * self, char *buf);
+long int sp_client_ring_recv (ShmPipe * self, char **buf);
+int sp_client_get_ring_fd (ShmPipe * self);
 void sp_client_close (ShmPipe * self);
 
 #ifdef __cplusplus
@@ -0,0 +1,177 @@
+/*
+ * aggregator.c - Benchmark the sink pad queueing of GstAggregator
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Mixes N live videotestsrc with compositor, the sources being delayed by a
+ * random amount (up to --jitter ms) before each buffer. This is run once with
+ * a single buffer queued per sink pad, and once with --queue buffers, and
+ * reports the output frame rate and the latency of the output buffers. */
+
+#include <gst/gst.h>
+
+#define DEFAULT_SOURCES 8
+#define DEFAULT_JITTER 30
+#define DEFAULT_QUEUE 4
+#define DEFAULT_DURATION 10
+
+static gint num_sources = DEFAULT_SOURCES;
+static gint jitter = DEFAULT_JITTER;
+static gint queue_size = DEFAULT_QUEUE;
+static gint duration = DEFAULT_DURATION;
+
+static GOptionEntry entries[] = {
+  {"sources", 's', 0, G_OPTION_ARG_INT, &num_sources,
+      "Number of live sources", NULL},
+  {"jitter", 'j', 0, G_OPTION_ARG_INT, &jitter,
+      "Maximum delay of the sources before each buffer (ms)", NULL},
+  {"queue", 'q', 0, G_OPTION_ARG_INT, &queue_size,
+      "Number of buffers queued on each sink pad", NULL},
+  {"duration", 'd', 0, G_OPTION_ARG_INT, &duration,
+      "Duration of each run (s)", NULL},
+  {NULL}
+};
+
+typedef struct
+{
+  GstElement *pipeline;
+  guint64 frames;
+  GstClockTime total_latency;
+  GstClockTime max_latency;
+} Stats;
+
+static GstPadProbeReturn
+jitter_probe (GstPad * pad, GstPadProbeInfo * info, gpointer user_data)
+{
+  if (jitter > 0)
+    g_usleep (g_random_int_range (0, jitter * 1000));
+
+  return GST_PAD_PROBE_OK;
+}
+
+static GstPadProbeReturn
+output_probe (GstPad * pad, GstPadProbeInfo * info, Stats * stats)
+{
+  GstBuffer *buf = GST_PAD_PROBE_INFO_BUFFER (info);
+  GstClock *clock;
+  GstClockTime now, latency;
+
+  clock = gst_element_get_clock (stats->pipeline);
+  if (clock == NULL || !GST_BUFFER_PTS_IS_VALID (buf)) {
+    if (clock)
+      gst_object_unref (clock);
+    return GST_PAD_PROBE_OK;
+  }
+
+  /* The output segment starts at 0, the PTS is the running time */
+  now = gst_clock_get_time (clock) -
+      gst_element_get_base_time (stats->pipeline);
+  gst_object_unref (clock);
+
+  latency = now > GST_BUFFER_PTS (buf) ? now - GST_BUFFER_PTS (buf) : 0;
+  stats->frames++;
+  stats->total_latency += latency;
+  stats->max_latency = MAX (stats->max_latency, latency);
+
+  return GST_PAD_PROBE_OK;
+}
+
+static void
+run_benchmark (guint max_buffers)
+{
+  GstElement *pipeline, *mixer, *sink;
+  GstPad *pad;
+  Stats stats = { NULL, };
+  gint i;
+
+  pipeline = gst_pipeline_new (NULL);
+  mixer = gst_element_factory_make ("compositor", NULL);
+  sink = gst_element_factory_make ("fakesink", NULL);
+  if (mixer == NULL || sink == NULL) {
+    g_printerr ("compositor or fakesink element not available\n");
+    if (mixer)
+      gst_object_unref (mixer);
+    if (sink)
+      gst_object_unref (sink);
+    gst_object_unref (pipeline);
+    return;
+  }
+
+  g_object_set (sink, "sync", FALSE, NULL);
+  gst_bin_add_many (GST_BIN (pipeline), mixer, sink, NULL);
+  gst_element_link (mixer, sink);
+
+  for (i = 0; i < num_sources; i++) {
+    GstElement *src = gst_element_factory_make ("videotestsrc", NULL);
+    GstPad *srcpad;
+
+    g_object_set (src, "is-live", TRUE, "pattern", i % 20, NULL);
+    gst_bin_add (GST_BIN (pipeline), src);
+
+    pad = gst_element_get_request_pad (mixer, "sink_%u");
+    g_object_set (pad, "max-buffers", max_buffers, NULL);
+    srcpad = gst_element_get_static_pad (src, "src");
+    gst_pad_add_probe (srcpad, GST_PAD_PROBE_TYPE_BUFFER, jitter_probe, NULL,
+        NULL);
+    gst_pad_link (srcpad, pad);
+    gst_object_unref (srcpad);
+    gst_object_unref (pad);
+  }
+
+  stats.pipeline = pipeline;
+  pad = gst_element_get_static_pad (mixer, "src");
+  gst_pad_add_probe (pad, GST_PAD_PROBE_TYPE_BUFFER,
+      (GstPadProbeCallback) output_probe, &stats, NULL);
+  gst_object_unref (pad);
+
+  gst_element_set_state (pipeline, GST_STATE_PLAYING);
+  g_usleep ((gulong) duration * G_USEC_PER_SEC);
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+
+  g_print ("max-buffers %2u: %" G_GUINT64_FORMAT " frames, %.1f fps, "
+      "latency mean %.1f ms, max %.1f ms\n", max_buffers, stats.frames,
+      (gdouble) stats.frames / duration,
+      stats.frames ? (gdouble) stats.total_latency / stats.frames /
+      GST_MSECOND : 0.0, (gdouble) stats.max_latency / GST_MSECOND);
+
+  gst_object_unref (pipeline);
+}
+
+int
+main (int argc, char **argv)
+{
+  GOptionContext *ctx;
+  GError *err = NULL;
+
+  ctx = g_option_context_new ("- aggregator sink pad queueing benchmark");
+  g_option_context_add_main_entries (ctx, entries, NULL);
+  g_option_context_add_group (ctx, gst_init_get_option_group ());
+  if (!g_option_context_parse (ctx, &argc, &argv, &err)) {
+    g_printerr ("Error initializing: %s\n", err->message);
+    g_clear_error (&err);
+    g_option_context_free (ctx);
+    return 1;
+  }
+  g_option_context_free (ctx);
+
+  g_print ("%d live sources, up to %d ms of jitter\n", num_sources, jitter);
+  run_benchmark (1);
+  if (queue_size != 1)
+    run_benchmark (MAX (queue_size, 0));
+
+  return 0;
+}
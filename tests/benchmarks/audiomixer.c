@@ -0,0 +1,133 @@
+/*
+ * audiomixer.c - Benchmark the mixing cost of the audiomixer inputs
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Mixes --blocks queued 10ms blocks of stereo 48kHz audio from 1 up to
+ * --inputs inputs, in S16 and F32, with a volume on every other input. All
+ * the blocks are generated before measuring, and the time spent per output
+ * block and per input and block is reported. */
+
+#include <gst/gst.h>
+
+#include "benchutils.h"
+
+#define DEFAULT_INPUTS 32
+#define DEFAULT_BLOCKS 1000
+#define RATE 48000
+#define BLOCKSIZE 480
+
+static gint num_inputs = DEFAULT_INPUTS;
+static gint num_blocks = DEFAULT_BLOCKS;
+
+static GOptionEntry entries[] = {
+  {"inputs", 'i', 0, G_OPTION_ARG_INT, &num_inputs,
+      "Maximum number of input streams", NULL},
+  {"blocks", 'b', 0, G_OPTION_ARG_INT, &num_blocks,
+      "Number of 10ms blocks to mix", NULL},
+  {NULL}
+};
+
+static const gchar *formats[] = { "S16LE", "F32LE" };
+
+static gchar *
+create_pipeline_description (const gchar * format, gint n_inputs)
+{
+  GString *desc = g_string_new (NULL);
+  gint i;
+
+  g_string_append_printf (desc, "audiomixer name=mix blocksize=%d", BLOCKSIZE);
+  for (i = 1; i < n_inputs; i += 2)
+    g_string_append_printf (desc, " sink_%d::volume=0.5", i);
+  g_string_append (desc, " ! fakesink");
+
+  for (i = 0; i < n_inputs; i++) {
+    g_string_append_printf (desc, " audiotestsrc freq=%d samplesperbuffer=%d"
+        " num-buffers=%d ! audio/x-raw,format=%s,rate=%d,channels=2"
+        " ! queue name=q%d max-size-buffers=0 max-size-bytes=0 max-size-time=0"
+        " ! mix.sink_%d", 220 * (i + 1), BLOCKSIZE, num_blocks, format, RATE,
+        i, i);
+  }
+
+  return g_string_free (desc, FALSE);
+}
+
+/* Returns the time to mix a block, or GST_CLOCK_TIME_NONE on errors */
+static GstClockTime
+run_pipeline (const gchar * format, gint n_inputs)
+{
+  GstClockTime elapsed;
+  gchar *desc, *name;
+
+  desc = create_pipeline_description (format, n_inputs);
+  name = g_strdup_printf ("%s, %d inputs", format, n_inputs);
+  elapsed = bench_run_queued_pipeline (desc, n_inputs, num_blocks, name);
+  g_free (name);
+  g_free (desc);
+
+  return elapsed;
+}
+
+static void
+run_benchmark (const gchar * format)
+{
+  gint n_inputs;
+
+  g_print ("%s, time per block and per input and block\n", format);
+
+  for (n_inputs = 1; n_inputs <= num_inputs; n_inputs *= 2) {
+    GstClockTime time = run_pipeline (format, n_inputs);
+
+    if (time == GST_CLOCK_TIME_NONE)
+      continue;
+
+    g_print ("%3d inputs: %8.2f us %8.2f us\n", n_inputs,
+        (gdouble) time / GST_USECOND,
+        (gdouble) time / n_inputs / GST_USECOND);
+  }
+}
+
+int
+main (int argc, char **argv)
+{
+  GOptionContext *ctx;
+  GError *err = NULL;
+  guint i;
+
+  ctx = g_option_context_new ("- audio mixing benchmark");
+  g_option_context_add_main_entries (ctx, entries, NULL);
+  g_option_context_add_group (ctx, gst_init_get_option_group ());
+  if (!g_option_context_parse (ctx, &argc, &argv, &err)) {
+    g_printerr ("Error initializing: %s\n", err->message);
+    g_clear_error (&err);
+    g_option_context_free (ctx);
+    return 1;
+  }
+  g_option_context_free (ctx);
+
+  if (num_inputs < 1 || num_blocks < 1) {
+    g_printerr ("Invalid parameters\n");
+    return 1;
+  }
+
+  g_print ("%d blocks of %d samples mixed at %d Hz\n", num_blocks, BLOCKSIZE,
+      RATE);
+  for (i = 0; i < G_N_ELEMENTS (formats); i++)
+    run_benchmark (formats[i]);
+
+  return 0;
+}
@@ -0,0 +1,102 @@
+/*
+ * benchutils.c - Helpers shared by the benchmarks
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "benchutils.h"
+
+static GstPadProbeReturn
+eos_probe (GstPad * pad, GstPadProbeInfo * info, gint * n_queued)
+{
+  if (GST_EVENT_TYPE (GST_PAD_PROBE_INFO_EVENT (info)) == GST_EVENT_EOS)
+    g_atomic_int_inc (n_queued);
+
+  return GST_PAD_PROBE_OK;
+}
+
+/* Runs the pipeline described by @desc, whose queues q0 to q<n_queues - 1>
+ * hold all of the input. The time is only measured once all of them got
+ * the end of the stream, so that generating the input is left out, or once
+ * the pipeline prerolled without @n_queues. Returns the time spent in
+ * PLAYING per each of the @n_units buffers, frames, ... or
+ * GST_CLOCK_TIME_NONE on errors, which are printed after @name. */
+GstClockTime
+bench_run_queued_pipeline (const gchar * desc, gint n_queues, gint n_units,
+    const gchar * name)
+{
+  GstElement *pipeline;
+  GstMessage *msg;
+  GstBus *bus;
+  GError *err = NULL;
+  GstClockTime start, elapsed = 0;
+  gint n_queued = 0;
+  gint i;
+
+  pipeline = gst_parse_launch (desc, &err);
+  if (pipeline == NULL) {
+    g_printerr ("Could not create pipeline: %s\n", err->message);
+    g_clear_error (&err);
+    return GST_CLOCK_TIME_NONE;
+  }
+
+  for (i = 0; i < n_queues; i++) {
+    GstElement *queue;
+    GstPad *pad;
+    gchar qname[16];
+
+    g_snprintf (qname, sizeof (qname), "q%d", i);
+    queue = gst_bin_get_by_name (GST_BIN (pipeline), qname);
+    g_assert (queue != NULL);
+    pad = gst_element_get_static_pad (queue, "sink");
+    gst_pad_add_probe (pad, GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM,
+        (GstPadProbeCallback) eos_probe, &n_queued, NULL);
+    gst_object_unref (pad);
+    gst_object_unref (queue);
+  }
+
+  bus = gst_element_get_bus (pipeline);
+  gst_element_set_state (pipeline, GST_STATE_PAUSED);
+  if (n_queues == 0)
+    gst_element_get_state (pipeline, NULL, NULL, GST_CLOCK_TIME_NONE);
+  msg = gst_bus_pop_filtered (bus, GST_MESSAGE_ERROR);
+  while (msg == NULL && g_atomic_int_get (&n_queued) < n_queues)
+    msg = gst_bus_timed_pop_filtered (bus, GST_MSECOND, GST_MESSAGE_ERROR);
+
+  if (msg == NULL) {
+    start = gst_util_get_timestamp ();
+    gst_element_set_state (pipeline, GST_STATE_PLAYING);
+    msg = gst_bus_timed_pop_filtered (bus, GST_CLOCK_TIME_NONE,
+        GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+    elapsed = gst_util_get_timestamp () - start;
+  }
+
+  if (GST_MESSAGE_TYPE (msg) == GST_MESSAGE_ERROR) {
+    gst_message_parse_error (msg, &err, NULL);
+    g_printerr ("%s: %s\n", name, err->message);
+    g_clear_error (&err);
+    elapsed = GST_CLOCK_TIME_NONE;
+  } else {
+    elapsed /= n_units;
+  }
+
+  gst_message_unref (msg);
+  gst_object_unref (bus);
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (pipeline);
+
+  return elapsed;
+}
@@ -0,0 +1,118 @@
+/*
+ * compare.c - Benchmark the video quality metrics of compare
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Compares --frames queued 1080p I420 frames with a brightened copy of them,
+ * with the PSNR, SSIM and MS-SSIM methods, for 1 up to the number of
+ * processors threads, and reports the time spent per frame on top of the
+ * same pipeline comparing the memory of the frames. */
+
+#include <gst/gst.h>
+
+#include "benchutils.h"
+
+#define DEFAULT_FRAMES 100
+
+static gint num_frames = DEFAULT_FRAMES;
+
+static GOptionEntry entries[] = {
+  {"frames", 'f', 0, G_OPTION_ARG_INT, &num_frames,
+      "Number of frames to compare", NULL},
+  {NULL}
+};
+
+static const gchar *methods[] = { "psnr", "ssim", "ms-ssim" };
+
+/* Returns the time to compare a frame, or GST_CLOCK_TIME_NONE on errors */
+static GstClockTime
+run_pipeline (const gchar * method, guint n_threads)
+{
+  GstClockTime elapsed;
+  gchar *desc, *name;
+
+  desc = g_strdup_printf ("compare name=c method=%s n-threads=%u ! fakesink"
+      " videotestsrc pattern=ball num-buffers=%d"
+      " ! video/x-raw,format=I420,width=1920,height=1080,framerate=25/1"
+      " ! tee name=t"
+      " ! queue name=q0 max-size-buffers=0 max-size-bytes=0 max-size-time=0"
+      " ! c.sink t. ! videobalance brightness=0.05"
+      " ! queue name=q1 max-size-buffers=0 max-size-bytes=0 max-size-time=0"
+      " ! c.check", method, n_threads, num_frames);
+  name = g_strdup_printf ("%s, %u threads", method, n_threads);
+  elapsed = bench_run_queued_pipeline (desc, 2, num_frames, name);
+  g_free (name);
+  g_free (desc);
+
+  return elapsed;
+}
+
+static void
+run_benchmark (guint n_threads, GstClockTime baseline)
+{
+  guint i;
+
+  g_print ("%2u threads:", n_threads);
+  for (i = 0; i < G_N_ELEMENTS (methods); i++) {
+    GstClockTime time = run_pipeline (methods[i], n_threads);
+
+    if (time == GST_CLOCK_TIME_NONE)
+      g_print (" %8s", "failed");
+    else
+      g_print (" %6.2f ms", (gdouble) (time > baseline ? time - baseline : 0) /
+          GST_MSECOND);
+  }
+  g_print ("\n");
+}
+
+int
+main (int argc, char **argv)
+{
+  GOptionContext *ctx;
+  GError *err = NULL;
+  GstClockTime baseline;
+  guint n_threads, max_threads;
+
+  ctx = g_option_context_new ("- video comparison benchmark");
+  g_option_context_add_main_entries (ctx, entries, NULL);
+  g_option_context_add_group (ctx, gst_init_get_option_group ());
+  if (!g_option_context_parse (ctx, &argc, &argv, &err)) {
+    g_printerr ("Error initializing: %s\n", err->message);
+    g_clear_error (&err);
+    g_option_context_free (ctx);
+    return 1;
+  }
+  g_option_context_free (ctx);
+
+  if (num_frames < 1) {
+    g_printerr ("Invalid parameters\n");
+    return 1;
+  }
+
+  baseline = run_pipeline ("mem", 1);
+  if (baseline == GST_CLOCK_TIME_NONE)
+    return 1;
+
+  g_print ("%d frames of 1080p, time per frame with psnr, ssim and ms-ssim\n",
+      num_frames);
+  max_threads = g_get_num_processors ();
+  for (n_threads = 1; n_threads < max_threads; n_threads *= 2)
+    run_benchmark (n_threads, baseline);
+  run_benchmark (max_threads, baseline);
+
+  return 0;
+}
@@ -0,0 +1,132 @@
+/*
+ * compositor.c - Benchmark the multithreaded blending of compositor
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Composites a grid of --inputs semi-transparent streams, each queued in its
+ * own thread, into a --width x --height output, for I420, AYUV and BGRA and
+ * for 1 up to the number of processors blending threads. */
+
+#include <math.h>
+#include <gst/gst.h>
+
+#include "benchutils.h"
+
+#define DEFAULT_INPUTS 9
+#define DEFAULT_WIDTH 3840
+#define DEFAULT_HEIGHT 2160
+#define DEFAULT_FRAMES 200
+
+static gint num_inputs = DEFAULT_INPUTS;
+static gint width = DEFAULT_WIDTH;
+static gint height = DEFAULT_HEIGHT;
+static gint num_frames = DEFAULT_FRAMES;
+
+static GOptionEntry entries[] = {
+  {"inputs", 'i', 0, G_OPTION_ARG_INT, &num_inputs,
+      "Number of input streams", NULL},
+  {"width", 'w', 0, G_OPTION_ARG_INT, &width, "Output width", NULL},
+  {"height", 'h', 0, G_OPTION_ARG_INT, &height, "Output height", NULL},
+  {"frames", 'f', 0, G_OPTION_ARG_INT, &num_frames,
+      "Number of frames to composite", NULL},
+  {NULL}
+};
+
+static const gchar *formats[] = { "I420", "AYUV", "BGRA" };
+
+static gchar *
+create_pipeline_description (const gchar * format, guint n_threads)
+{
+  GString *desc = g_string_new (NULL);
+  gint cols, rows, tile_width, tile_height, i;
+
+  cols = (gint) ceil (sqrt (num_inputs));
+  rows = (num_inputs + cols - 1) / cols;
+  tile_width = GST_ROUND_DOWN_2 (width / cols);
+  tile_height = GST_ROUND_DOWN_2 (height / rows);
+
+  g_string_append_printf (desc, "compositor name=comp n-threads=%u", n_threads);
+  /* Slightly overlapping tiles, so that most of the frame gets blended */
+  for (i = 0; i < num_inputs; i++) {
+    g_string_append_printf (desc, " sink_%d::xpos=%d sink_%d::ypos=%d"
+        " sink_%d::alpha=0.8", i, (i % cols) * tile_width - 8 * (i % cols), i,
+        (i / cols) * tile_height - 8 * (i / cols), i);
+  }
+  g_string_append_printf (desc, " ! video/x-raw,format=%s,width=%d,height=%d"
+      " ! fakesink", format, width, height);
+
+  for (i = 0; i < num_inputs; i++) {
+    g_string_append_printf (desc, " videotestsrc pattern=%d num-buffers=%d"
+        " ! video/x-raw,format=%s,width=%d,height=%d,framerate=30/1"
+        " ! queue ! comp.sink_%d", i % 2 ? 2 : 17, num_frames, format,
+        tile_width + 16, tile_height + 16, i);
+  }
+
+  return g_string_free (desc, FALSE);
+}
+
+static void
+run_benchmark (const gchar * format, guint n_threads)
+{
+  GstClockTime time;
+  gchar *desc, *name;
+
+  desc = create_pipeline_description (format, n_threads);
+  name = g_strdup_printf ("%s, %u threads", format, n_threads);
+  /* all the frames would not fit in memory, prerolling fills the queues */
+  time = bench_run_queued_pipeline (desc, 0, num_frames, name);
+  g_free (name);
+  g_free (desc);
+
+  if (time != GST_CLOCK_TIME_NONE)
+    g_print ("%s, %2u threads: %.1f fps\n", format, n_threads,
+        (gdouble) GST_SECOND / MAX (time, 1));
+}
+
+int
+main (int argc, char **argv)
+{
+  GOptionContext *ctx;
+  GError *err = NULL;
+  guint i, n_threads, max_threads;
+
+  ctx = g_option_context_new ("- compositor blending benchmark");
+  g_option_context_add_main_entries (ctx, entries, NULL);
+  g_option_context_add_group (ctx, gst_init_get_option_group ());
+  if (!g_option_context_parse (ctx, &argc, &argv, &err)) {
+    g_printerr ("Error initializing: %s\n", err->message);
+    g_clear_error (&err);
+    g_option_context_free (ctx);
+    return 1;
+  }
+  g_option_context_free (ctx);
+
+  if (num_inputs < 1 || width < 16 || height < 16 || num_frames < 1) {
+    g_printerr ("Invalid parameters\n");
+    return 1;
+  }
+
+  g_print ("%d inputs composited at %dx%d\n", num_inputs, width, height);
+  max_threads = g_get_num_processors ();
+  for (i = 0; i < G_N_ELEMENTS (formats); i++) {
+    for (n_threads = 1; n_threads < max_threads; n_threads *= 2)
+      run_benchmark (formats[i], n_threads);
+    run_benchmark (formats[i], max_threads);
+  }
+
+  return 0;
+}
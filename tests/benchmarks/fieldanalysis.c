@@ -0,0 +1,604 @@
+/*
+ * fieldanalysis.c - Benchmark the metrics of fieldanalysis
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Analyses --frames queued frames of moving bars with noise, that are in
+ * turn progressive, interlaced and 3:2 telecined, in I420 and YUY2 at SD
+ * and HD sizes. For each of them, the scores the metrics of a fieldanalysis
+ * element return for the first frames with all field metrics, frame metrics
+ * and comb methods are first checked to be the same, bit for bit, as those of
+ * scalar versions of the metrics.
+ * Then the time spent per frame with the 5-tap and windowed comb frame
+ * metrics is reported for 1 up to the number of processors threads, on top
+ * of the same pipeline without fieldanalysis. */
+
+#include <gst/gst.h>
+#include <gst/video/video.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "gstfieldanalysis.h"
+
+#define DEFAULT_FRAMES 60
+#define VERIFY_FRAMES 10
+
+/* the thresholds of the element, that the scalar metrics use too */
+#define NOISE_FLOOR 16
+#define SPATIAL_THRESH 9
+#define BLOCK_WIDTH 16
+#define BLOCK_HEIGHT 16
+#define BLOCK_THRESH 80
+#define IGNORED_LINES 2
+
+static gint num_frames = DEFAULT_FRAMES;
+
+static GOptionEntry entries[] = {
+  {"frames", 'f', 0, G_OPTION_ARG_INT, &num_frames,
+      "Number of frames to analyse", NULL},
+  {NULL}
+};
+
+static const gchar *field_metrics[] = { "sad", "ssd", "3-tap" };
+static const gchar *comb_methods[] = { "32-detect", "isCombed", "5-tap" };
+
+typedef struct
+{
+  const gchar *format;
+  gint width, height;
+  gint stride, pstride;         /* of the luma samples */
+  GPtrArray *buffers;
+} Stream;
+
+/* moving bars over a vertical ramp, at time t */
+static gint
+picture (gint x, gint y, gint t)
+{
+  return ((x + 5 * t) & 32 ? 170 : 60) + (y & 255) / 8;
+}
+
+/* the frames are progressive, interlaced and 3:2 telecined in turn for 10
+ * frames each */
+static void
+field_times (gint n, gint * top, gint * bottom)
+{
+  static const gint telecine_top[] = { 0, 1, 1, 2, 3 };
+  static const gint telecine_bottom[] = { 0, 1, 2, 3, 3 };
+
+  switch ((n / 10) % 3) {
+    case 0:
+      *top = *bottom = 2 * n;
+      break;
+    case 1:
+      *top = 2 * n;
+      *bottom = 2 * n + 1;
+      break;
+    default:
+      *top = 2 * (n / 5 * 4 + telecine_top[n % 5]);
+      *bottom = 2 * (n / 5 * 4 + telecine_bottom[n % 5]);
+      break;
+  }
+}
+
+static void
+create_stream (Stream * stream, const gchar * format, gint width, gint height)
+{
+  gsize size;
+  gint n, x, y;
+
+  stream->format = format;
+  stream->width = width;
+  stream->height = height;
+  if (strcmp (format, "YUY2") == 0) {
+    stream->pstride = 2;
+    stream->stride = GST_ROUND_UP_4 (width * 2);
+    size = stream->stride * height;
+  } else {
+    stream->pstride = 1;
+    stream->stride = GST_ROUND_UP_4 (width);
+    size = stream->stride * height +
+        2 * GST_ROUND_UP_4 (width / 2) * (height / 2);
+  }
+  /* the windowed comb reads some lines past the bottom of the frame */
+  size += 2 * BLOCK_HEIGHT * stream->stride;
+
+  stream->buffers = g_ptr_array_new_with_free_func (
+      (GDestroyNotify) gst_buffer_unref);
+  for (n = 0; n < num_frames; n++) {
+    GstBuffer *buf = gst_buffer_new_allocate (NULL, size, NULL);
+    guint32 seed = n + 1;
+    GstMapInfo map;
+    gint top, bottom;
+
+    gst_buffer_map (buf, &map, GST_MAP_WRITE);
+    memset (map.data, 128, size);
+    field_times (n, &top, &bottom);
+    for (y = 0; y < height; y++) {
+      for (x = 0; x < width; x++) {
+        gint noise;
+
+        seed = seed * 1103515245 + 12345;
+        noise = (gint) ((seed >> 28) % 7) - 3;
+        map.data[y * stream->stride + x * stream->pstride] =
+            picture (x, y, y & 1 ? bottom : top) + noise;
+      }
+    }
+    gst_buffer_unmap (buf, &map);
+
+    GST_BUFFER_PTS (buf) = gst_util_uint64_scale_int (n, GST_SECOND, 25);
+    GST_BUFFER_DURATION (buf) = GST_SECOND / 25;
+    g_ptr_array_add (stream->buffers, buf);
+  }
+}
+
+/* scalar versions of the metrics, field1 and field2 point to the first line
+ * of the fields */
+static gfloat
+same_field_score (Stream * stream, gint metric, const guint8 * field1,
+    const guint8 * field2)
+{
+  const gint width = stream->width, height = stream->height;
+  const gint incr = stream->pstride;
+  gfloat sum = 0.0f;
+  gint i, j;
+
+  for (j = 0; j < (height >> 1); j++) {
+    const guint8 *f1j = field1 + 2 * j * stream->stride;
+    const guint8 *f2j = field2 + 2 * j * stream->stride;
+    guint32 linesum = 0, diff;
+
+    switch (metric) {
+      case 0:
+        for (i = 0; i < width; i++) {
+          diff = abs (f1j[i] - f2j[i]);
+          if (diff > NOISE_FLOOR)
+            linesum += diff;
+        }
+        sum += linesum;
+        break;
+      case 1:
+        for (i = 0; i < width; i++) {
+          diff = (f1j[i] - f2j[i]) * (f1j[i] - f2j[i]);
+          if (diff > NOISE_FLOOR * NOISE_FLOOR)
+            linesum += diff;
+        }
+        sum += linesum;
+        break;
+      default:
+        diff = abs (((f1j[0] << 2) + (f1j[incr] << 1))
+            - ((f2j[0] << 2) + (f2j[incr] << 1)));
+        if (diff > NOISE_FLOOR * 6)
+          sum += diff;
+        for (i = 0; i < width - 1; i++) {
+          diff = abs (f1j[i] + (f1j[i + incr] << 2) + f1j[i + 2 * incr]
+              - f2j[i] - (f2j[i + incr] << 2) - f2j[i + 2 * incr]);
+          if (diff > NOISE_FLOOR * 6)
+            linesum += diff;
+        }
+        sum += linesum;
+        i = width - 1;
+        diff = abs (((f1j[i - incr] << 1) + (f1j[i] << 2))
+            - ((f2j[i - incr] << 1) + (f2j[i] << 2)));
+        if (diff > NOISE_FLOOR * 6)
+          sum += diff;
+        break;
+    }
+  }
+
+  if (metric == 2)
+    return sum / ((6.0f / 2.0f) * width * height);
+  return sum / (0.5f * width * height);
+}
+
+static guint32
+five_tap_line (Stream * stream, const guint8 * fjm2, const guint8 * fjm1,
+    const guint8 * fj, const guint8 * fjp1, const guint8 * fjp2)
+{
+  guint32 linesum = 0, diff;
+  gint i;
+
+  for (i = 0; i < stream->width; i++) {
+    diff = abs (fjm2[i] - 3 * fjm1[i] + 4 * fj[i] - 3 * fjp1[i] + fjp2[i]);
+    if (diff > NOISE_FLOOR * 6)
+      linesum += diff;
+  }
+
+  return linesum;
+}
+
+/* the highest score of the blocks of the row */
+static guint
+block_score_for_row (Stream * stream, gint comb_method,
+    const guint8 * base_fj, const guint8 * base_fjp1)
+{
+  const gint incr = stream->pstride, stridex2 = 2 * stream->stride;
+  const gint width = stream->width - stream->width % BLOCK_WIDTH;
+  const guint8 *fjm2, *fjm1, *fj, *fjp1, *fjp2;
+  guint8 *comb_mask = g_newa (guint8, width);
+  guint *block_scores = g_newa (guint, width / BLOCK_WIDTH);
+  guint block_score = 0;
+  gint i, j;
+
+  memset (block_scores, 0, (width / BLOCK_WIDTH) * sizeof (guint));
+  fjm2 = base_fj - stridex2;
+  fjm1 = base_fjp1 - stridex2;
+  fj = base_fj;
+  fjp1 = base_fjp1;
+  fjp2 = fj + stridex2;
+
+  for (j = 0; j < BLOCK_HEIGHT; j++) {
+    for (i = 0; i < width; i++) {
+      const gint idx = i * incr;
+      const gint diff1 = fj[idx] - fjm1[idx], diff2 = fj[idx] - fjp1[idx];
+
+      if (!((diff1 > SPATIAL_THRESH && diff2 > SPATIAL_THRESH)
+              || (diff1 < -SPATIAL_THRESH && diff2 < -SPATIAL_THRESH)))
+        comb_mask[i] = FALSE;
+      else if (comb_method == 0)
+        comb_mask[i] = abs (fj[idx] - fjm2[idx]) < 10
+            && abs (fj[idx] - fjm1[idx]) > 15;
+      else if (comb_method == 1)
+        comb_mask[i] = (fjm1[idx] - fj[idx]) * (fjp1[idx] - fj[idx]) >
+            SPATIAL_THRESH * SPATIAL_THRESH;
+      else
+        comb_mask[i] = abs (fjm2[idx] + (fj[idx] << 2) + fjp2[idx] -
+            3 * (fjm1[idx] + fjp1[idx])) > 6 * SPATIAL_THRESH;
+    }
+
+    for (i = 0; i < width; i++) {
+      if (comb_mask[i] && (i == 0 || comb_mask[i - 1])
+          && (i == width - 1 || comb_mask[i + 1]))
+        block_scores[i / BLOCK_WIDTH]++;
+    }
+
+    fjm2 = fjm1;
+    fjm1 = fj;
+    fj = fjp1;
+    fjp1 = fjm1 + stridex2;
+    fjp2 = fj + stridex2;
+  }
+
+  for (i = 0; i < width / BLOCK_WIDTH; i++)
+    block_score = MAX (block_score, block_scores[i]);
+
+  return block_score;
+}
+
+/* top and bottom point to the frames the top and bottom fields are from,
+ * comb_method is -1 for the 5-tap frame metric */
+static gfloat
+same_frame_score (Stream * stream, gint comb_method, const guint8 * top,
+    const guint8 * bottom)
+{
+  const gint width = stream->width, height = stream->height;
+  const gint stridex2 = 2 * stream->stride;
+  const guint8 *fjm2, *fjm1, *fj, *fjp1, *fjp2;
+  gboolean slightly_combed = FALSE;
+  gfloat sum = 0.0f;
+  gint j;
+
+  if (comb_method >= 0) {
+    for (j = 0; j <= height - IGNORED_LINES - BLOCK_HEIGHT; j += BLOCK_HEIGHT) {
+      const gint offset = (IGNORED_LINES + j) * stream->stride;
+      guint block_score = block_score_for_row (stream, comb_method,
+          top + offset, bottom + stream->stride + offset);
+
+      if (block_score > (BLOCK_THRESH >> 1) && block_score <= BLOCK_THRESH)
+        slightly_combed = TRUE;
+      else if (block_score > BLOCK_THRESH)
+        return 2.0f;
+    }
+    return slightly_combed;
+  }
+
+  fj = top;
+  fjp1 = bottom + stream->stride;
+  fjp2 = fj + stridex2;
+  sum += five_tap_line (stream, fjp2, fjp1, fj, fjp1, fjp2);
+  for (j = 1; j < (height >> 1) - 1; j++) {
+    fjm2 = fj;
+    fjm1 = fjp1;
+    fj = fjp2;
+    fjp1 += stridex2;
+    fjp2 += stridex2;
+    sum += five_tap_line (stream, fjm2, fjm1, fj, fjp1, fjp2);
+  }
+  fjm2 = fj;
+  fjm1 = fjp1;
+  fj = fjp2;
+  sum += five_tap_line (stream, fjm2, fjm1, fj, fjm1, fjm2);
+
+  return sum / ((6.0f / 2.0f) * width * height);
+}
+
+/* Returns the time to analyse a frame, or GST_CLOCK_TIME_NONE on errors */
+static GstClockTime
+run_pipeline (Stream * stream, const gchar * filter, gint n_frames)
+{
+  GstElement *pipeline, *src;
+  GstMessage *msg;
+  GstBus *bus;
+  GError *err = NULL;
+  GstFlowReturn ret;
+  GstClockTime start, elapsed = 0;
+  gchar *desc;
+  gint n;
+
+  desc = g_strdup_printf ("appsrc name=src format=time max-bytes=0"
+      " caps=video/x-raw,format=%s,width=%d,height=%d,framerate=25/1"
+      " ! %s ! fakesink", stream->format, stream->width, stream->height,
+      filter);
+  pipeline = gst_parse_launch (desc, &err);
+  g_free (desc);
+  if (pipeline == NULL) {
+    g_printerr ("Could not create pipeline: %s\n", err->message);
+    g_clear_error (&err);
+    return GST_CLOCK_TIME_NONE;
+  }
+
+  /* Only start measuring once all frames were queued */
+  bus = gst_element_get_bus (pipeline);
+  gst_element_set_state (pipeline, GST_STATE_PAUSED);
+  src = gst_bin_get_by_name (GST_BIN (pipeline), "src");
+  for (n = 0; n < n_frames; n++)
+    g_signal_emit_by_name (src, "push-buffer",
+        g_ptr_array_index (stream->buffers, n), &ret);
+  g_signal_emit_by_name (src, "end-of-stream", &ret);
+  gst_object_unref (src);
+
+  msg = gst_bus_pop_filtered (bus, GST_MESSAGE_ERROR);
+  if (msg == NULL) {
+    start = gst_util_get_timestamp ();
+    gst_element_set_state (pipeline, GST_STATE_PLAYING);
+    msg = gst_bus_timed_pop_filtered (bus, GST_CLOCK_TIME_NONE,
+        GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+    elapsed = gst_util_get_timestamp () - start;
+  }
+
+  if (GST_MESSAGE_TYPE (msg) == GST_MESSAGE_ERROR) {
+    gst_message_parse_error (msg, &err, NULL);
+    g_printerr ("%s: %s\n", filter, err->message);
+    g_clear_error (&err);
+    elapsed = GST_CLOCK_TIME_NONE;
+  } else {
+    elapsed /= n_frames;
+  }
+
+  gst_message_unref (msg);
+  gst_object_unref (bus);
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (pipeline);
+
+  return elapsed;
+}
+
+static gboolean
+check_score (Stream * stream, const gchar * desc, gint n, const gchar * name,
+    gfloat score, gfloat expected)
+{
+  if (memcmp (&score, &expected, sizeof (gfloat)) == 0)
+    return TRUE;
+
+  g_printerr ("%s %dx%d, %s, frame %d: %s %.9g instead of %.9g\n",
+      stream->format, stream->width, stream->height, desc, n, name, score,
+      expected);
+  return FALSE;
+}
+
+/* Returns the score of the frame metric of filter for the fields of the given
+ * parities of frame1 and frame2 */
+static gfloat
+frame_score (GstFieldAnalysis * filter, GstVideoFrame * frame1, gint parity1,
+    GstVideoFrame * frame2, gint parity2)
+{
+  FieldAnalysisFields history[2];
+
+  history[0].frame = *frame1;
+  history[0].parity = parity1;
+  history[1].frame = *frame2;
+  history[1].parity = parity2;
+
+  return filter->same_frame (filter, &history);
+}
+
+static gfloat
+field_score (GstFieldAnalysis * filter, GstVideoFrame * frame1,
+    GstVideoFrame * frame2, gint parity)
+{
+  FieldAnalysisFields history[2];
+
+  history[0].frame = *frame1;
+  history[0].parity = parity;
+  history[1].frame = *frame2;
+  history[1].parity = parity;
+
+  return filter->same_field (filter, &history);
+}
+
+/* Returns FALSE if the scores the metrics of fieldanalysis return differ from
+ * those of the scalar metrics, comb_method is -1 for the 5-tap frame metric */
+static gboolean
+verify_scores (Stream * stream, gint field_metric, gint comb_method,
+    guint n_threads)
+{
+  GstElement *element;
+  GstFieldAnalysis *filter;
+  GstVideoInfo info;
+  GstVideoFrame *frames;
+  gboolean ret = TRUE;
+  gchar *desc;
+  gint n, n_frames = MIN (num_frames, VERIFY_FRAMES);
+
+  element = gst_element_factory_make ("fieldanalysis", NULL);
+  if (element == NULL) {
+    g_printerr ("Could not create fieldanalysis\n");
+    return FALSE;
+  }
+  gst_util_set_object_arg (G_OBJECT (element), "field-metric",
+      field_metrics[field_metric]);
+  gst_util_set_object_arg (G_OBJECT (element), "frame-metric",
+      comb_method < 0 ? "5-tap" : "windowed-comb");
+  gst_util_set_object_arg (G_OBJECT (element), "comb-method",
+      comb_methods[MAX (comb_method, 0)]);
+  g_object_set (element, "noise-floor", (guint) NOISE_FLOOR,
+      "spatial-threshold", (gint64) SPATIAL_THRESH,
+      "block-width", (guint64) BLOCK_WIDTH,
+      "block-height", (guint64) BLOCK_HEIGHT,
+      "block-threshold", (guint64) BLOCK_THRESH,
+      "ignored-lines", (guint64) IGNORED_LINES, NULL);
+
+  /* the metrics run on the threads of the task runner of the element, that
+   * is freed with it */
+  filter = (GstFieldAnalysis *) element;
+  gst_parallelized_task_runner_update (&filter->task_runner, n_threads);
+
+  desc = g_strdup_printf ("field-metric=%s frame-metric=%s comb-method=%s",
+      field_metrics[field_metric], comb_method < 0 ? "5-tap" : "windowed-comb",
+      comb_methods[MAX (comb_method, 0)]);
+
+  gst_video_info_set_format (&info,
+      gst_video_format_from_string (stream->format), stream->width,
+      stream->height);
+  frames = g_newa (GstVideoFrame, n_frames);
+  for (n = 0; n < n_frames; n++)
+    gst_video_frame_map (&frames[n], &info,
+        g_ptr_array_index (stream->buffers, n), GST_MAP_READ);
+
+  for (n = 0; ret && n < n_frames; n++) {
+    const guint8 *cur = GST_VIDEO_FRAME_PLANE_DATA (&frames[n], 0), *prev;
+
+    ret = check_score (stream, desc, n, "f",
+        frame_score (filter, &frames[n], TOP_FIELD, &frames[n], BOTTOM_FIELD),
+        same_frame_score (stream, comb_method, cur, cur));
+    if (!ret || n == 0)
+      continue;
+
+    prev = GST_VIDEO_FRAME_PLANE_DATA (&frames[n - 1], 0);
+    ret = check_score (stream, desc, n, "t",
+        field_score (filter, &frames[n], &frames[n - 1], TOP_FIELD),
+        same_field_score (stream, field_metric, cur, prev))
+        && check_score (stream, desc, n, "b",
+        field_score (filter, &frames[n], &frames[n - 1], BOTTOM_FIELD),
+        same_field_score (stream, field_metric, cur + stream->stride,
+            prev + stream->stride))
+        && check_score (stream, desc, n, "t_b",
+        frame_score (filter, &frames[n], TOP_FIELD, &frames[n - 1],
+            BOTTOM_FIELD), same_frame_score (stream, comb_method, cur, prev))
+        && check_score (stream, desc, n, "b_t",
+        frame_score (filter, &frames[n], BOTTOM_FIELD, &frames[n - 1],
+            TOP_FIELD), same_frame_score (stream, comb_method, prev, cur));
+  }
+
+  for (n = 0; n < n_frames; n++)
+    gst_video_frame_unmap (&frames[n]);
+  g_free (desc);
+  gst_object_unref (element);
+
+  return ret;
+}
+
+static void
+run_benchmark (Stream * stream, guint n_threads, GstClockTime baseline)
+{
+  gchar *filter;
+  gint windowed;
+
+  g_print ("%2u threads:", n_threads);
+  for (windowed = 0; windowed < 2; windowed++) {
+    GstClockTime time;
+
+    filter = g_strdup_printf ("fieldanalysis frame-metric=%s n-threads=%u",
+        windowed ? "windowed-comb" : "5-tap", n_threads);
+    time = run_pipeline (stream, filter, num_frames);
+    g_free (filter);
+
+    if (time == GST_CLOCK_TIME_NONE)
+      g_print (" %8s", "failed");
+    else
+      g_print (" %6.2f ms", (gdouble) (time > baseline ? time - baseline : 0) /
+          GST_MSECOND);
+  }
+  g_print ("\n");
+}
+
+/* Returns FALSE on errors, or if the scores were not bit-exact */
+static gboolean
+run_benchmarks (const gchar * format, gint width, gint height)
+{
+  Stream stream;
+  GstClockTime baseline;
+  guint n_threads, max_threads = g_get_num_processors ();
+  gint field_metric, comb_method;
+  gboolean ret = TRUE;
+
+  create_stream (&stream, format, width, height);
+
+  for (field_metric = 0; field_metric < (gint) G_N_ELEMENTS (field_metrics);
+      field_metric++) {
+    for (comb_method = -1; comb_method < (gint) G_N_ELEMENTS (comb_methods);
+        comb_method++)
+      ret &= verify_scores (&stream, field_metric, comb_method, max_threads);
+  }
+
+  baseline = run_pipeline (&stream, "identity", num_frames);
+  if (baseline != GST_CLOCK_TIME_NONE) {
+    g_print ("%d frames of %s %dx%d, scores %s, time per frame with the"
+        " 5-tap and windowed comb frame metrics\n", num_frames, format, width,
+        height, ret ? "bit-exact" : "different");
+    for (n_threads = 1; n_threads < max_threads; n_threads *= 2)
+      run_benchmark (&stream, n_threads, baseline);
+    run_benchmark (&stream, max_threads, baseline);
+  } else {
+    ret = FALSE;
+  }
+
+  g_ptr_array_free (stream.buffers, TRUE);
+
+  return ret;
+}
+
+int
+main (int argc, char **argv)
+{
+  GOptionContext *ctx;
+  GError *err = NULL;
+  gboolean ret = TRUE;
+
+  ctx = g_option_context_new ("- field analysis benchmark");
+  g_option_context_add_main_entries (ctx, entries, NULL);
+  g_option_context_add_group (ctx, gst_init_get_option_group ());
+  if (!g_option_context_parse (ctx, &argc, &argv, &err)) {
+    g_printerr ("Error initializing: %s\n", err->message);
+    g_clear_error (&err);
+    g_option_context_free (ctx);
+    return 1;
+  }
+  g_option_context_free (ctx);
+
+  if (num_frames < 2) {
+    g_printerr ("Invalid parameters\n");
+    return 1;
+  }
+
+  ret &= run_benchmarks ("I420", 720, 576);
+  ret &= run_benchmarks ("YUY2", 720, 576);
+  ret &= run_benchmarks ("I420", 1920, 1080);
+  ret &= run_benchmarks ("YUY2", 1920, 1080);
+
+  return ret ? 0 : 1;
+}
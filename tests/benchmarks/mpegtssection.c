@@ -0,0 +1,308 @@
+/*
+ * mpegtssection.c - Benchmark the CRC checking of MPEG-TS sections
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Parses EIT sections (either extracted from a capture given with
+ * --location, or generated) with each of the CRC32 implementations of the
+ * mpegts library. The implementation being picked once, when the library is
+ * initialized, each of them is run in a child process with GST_MPEGTS_CRC32
+ * set accordingly. */
+
+#include <string.h>
+#include <gst/gst.h>
+#include <gst/mpegts/mpegts.h>
+
+#define TS_PACKET_SIZE 188
+#define EIT_PID 0x12
+#define DEFAULT_ITERATIONS 200
+
+/* Generated EIT sections */
+#define NUM_SECTIONS 256
+#define EVENTS_PER_SECTION 32
+#define EVENT_DESCRIPTOR_SIZE 100
+
+static gchar *location = NULL;
+static gint iterations = DEFAULT_ITERATIONS;
+
+static GOptionEntry entries[] = {
+  {"location", 'l', 0, G_OPTION_ARG_FILENAME, &location,
+      "MPEG-TS capture (188 byte packets) to take the EIT sections from", NULL},
+  {"iterations", 'i', 0, G_OPTION_ARG_INT, &iterations,
+      "Number of times all sections are parsed", NULL},
+  {NULL}
+};
+
+static const gchar *implementations[] = { "bytewise", "slice8", "clmul" };
+
+/* Only used to generate sections, hence not bothering with tables */
+static guint32
+calc_crc32 (const guint8 * data, guint len)
+{
+  guint32 crc = 0xffffffff;
+  guint i, j;
+
+  for (i = 0; i < len; i++) {
+    crc ^= data[i] << 24;
+    for (j = 0; j < 8; j++)
+      crc = (crc & 0x80000000) ? (crc << 1) ^ 0x04c11db7 : crc << 1;
+  }
+
+  return crc;
+}
+
+static GPtrArray *
+create_sections (void)
+{
+  GPtrArray *sections = g_ptr_array_new_with_free_func (g_free);
+  guint i, j, size;
+
+  size = 14 + EVENTS_PER_SECTION * (12 + EVENT_DESCRIPTOR_SIZE) + 4;
+
+  for (i = 0; i < NUM_SECTIONS; i++) {
+    guint8 *data = g_malloc0 (size + 2);
+    guint8 *event;
+
+    /* The section size goes first, the section itself after */
+    GST_WRITE_UINT16_BE (data, size);
+    data += 2;
+
+    data[0] = 0x50 + (i / 64) % 16;     /* EIT schedule, actual TS */
+    GST_WRITE_UINT16_BE (data + 1, 0xf000 | (size - 3));
+    GST_WRITE_UINT16_BE (data + 3, 1 + i / 256);        /* service_id */
+    data[5] = 0xc1;             /* version 0, current */
+    data[6] = i % 256;          /* section_number */
+    data[7] = 0xff;             /* last_section_number */
+    GST_WRITE_UINT16_BE (data + 8, 1);  /* transport_stream_id */
+    GST_WRITE_UINT16_BE (data + 10, 1); /* original_network_id */
+    data[12] = 0xff;            /* segment_last_section_number */
+    data[13] = 0x5f;            /* last_table_id */
+
+    for (j = 0; j < EVENTS_PER_SECTION; j++) {
+      event = data + 14 + j * (12 + EVENT_DESCRIPTOR_SIZE);
+
+      GST_WRITE_UINT16_BE (event, i * EVENTS_PER_SECTION + j);
+      /* start time and duration */
+      memset (event + 2, 0xff, 8);
+      GST_WRITE_UINT16_BE (event + 10, 0x4000 | EVENT_DESCRIPTOR_SIZE);
+      /* a single (private) descriptor */
+      event[12] = 0x80;
+      event[13] = EVENT_DESCRIPTOR_SIZE - 2;
+      memset (event + 14, j, EVENT_DESCRIPTOR_SIZE - 2);
+    }
+
+    GST_WRITE_UINT32_BE (data + size - 4, calc_crc32 (data, size - 4));
+    g_ptr_array_add (sections, data - 2);
+  }
+
+  return sections;
+}
+
+/* Moves all complete sections at the start of @pending to @sections */
+static void
+extract_sections (GByteArray * pending, GPtrArray * sections)
+{
+  while (pending->len >= 3) {
+    guint size;
+    guint8 *section;
+
+    /* Stuffing */
+    if (pending->data[0] == 0xff) {
+      g_byte_array_set_size (pending, 0);
+      break;
+    }
+
+    size = (GST_READ_UINT16_BE (pending->data + 1) & 0xfff) + 3;
+    if (pending->len < size)
+      break;
+
+    section = g_malloc (size + 2);
+    GST_WRITE_UINT16_BE (section, size);
+    memcpy (section + 2, pending->data, size);
+    g_ptr_array_add (sections, section);
+    g_byte_array_remove_range (pending, 0, size);
+  }
+}
+
+/* Reassembles the sections carried on the EIT PID */
+static GPtrArray *
+read_sections (const gchar * filename)
+{
+  GPtrArray *sections = g_ptr_array_new_with_free_func (g_free);
+  GByteArray *pending = g_byte_array_new ();
+  GError *err = NULL;
+  gchar *contents;
+  gsize length, offset;
+
+  if (!g_file_get_contents (filename, &contents, &length, &err)) {
+    g_printerr ("Could not read %s: %s\n", filename, err->message);
+    g_clear_error (&err);
+    g_byte_array_unref (pending);
+    return sections;
+  }
+
+  for (offset = 0; offset + TS_PACKET_SIZE <= length;
+      offset += TS_PACKET_SIZE) {
+    const guint8 *data = (const guint8 *) contents + offset;
+    const guint8 *payload = data + 4;
+    const guint8 *end = data + TS_PACKET_SIZE;
+
+    if (data[0] != 0x47) {
+      g_printerr ("Lost sync at offset %" G_GSIZE_FORMAT "\n", offset);
+      break;
+    }
+    if ((GST_READ_UINT16_BE (data + 1) & 0x1fff) != EIT_PID ||
+        !(data[3] & 0x10))
+      continue;
+    if (data[3] & 0x20)
+      payload += 1 + data[4];
+    if (payload >= end)
+      continue;
+
+    if (data[1] & 0x40) {
+      guint8 pointer = *payload++;
+
+      if (payload + pointer > end) {
+        g_byte_array_set_size (pending, 0);
+        continue;
+      }
+
+      /* Finish the previous section, and drop it if it is still not
+       * complete */
+      if (pending->len) {
+        g_byte_array_append (pending, payload, pointer);
+        extract_sections (pending, sections);
+        g_byte_array_set_size (pending, 0);
+      }
+      payload += pointer;
+    } else if (pending->len == 0) {
+      continue;
+    }
+
+    g_byte_array_append (pending, payload, end - payload);
+    extract_sections (pending, sections);
+  }
+
+  g_byte_array_unref (pending);
+  g_free (contents);
+
+  return sections;
+}
+
+static void
+run_benchmark (GPtrArray * sections)
+{
+  GstClockTime start, total = 0;
+  guint64 bytes = 0;
+  guint i, failed = 0;
+  gint n;
+
+  for (n = 0; n < iterations; n++) {
+    for (i = 0; i < sections->len; i++) {
+      const guint8 *data = g_ptr_array_index (sections, i);
+      guint size = GST_READ_UINT16_BE (data);
+      GstMpegtsSection *section;
+
+      section = gst_mpegts_section_new (EIT_PID, g_memdup (data + 2, size),
+          size);
+      if (section == NULL) {
+        failed++;
+        continue;
+      }
+
+      /* Only account for the parsing, which checks the CRC */
+      start = gst_util_get_timestamp ();
+      if (gst_mpegts_section_get_eit (section) == NULL)
+        failed++;
+      total += gst_util_get_timestamp () - start;
+
+      bytes += size;
+      gst_mpegts_section_unref (section);
+    }
+  }
+
+  g_print ("%-8s: %u sections, %.1f MB/s", g_getenv ("GST_MPEGTS_CRC32"),
+      sections->len, bytes / ((gdouble) total / GST_SECOND) / 1000000.0);
+  if (failed)
+    g_print (" (%u failed)", failed / iterations);
+  g_print ("\n");
+}
+
+int
+main (int argc, char **argv)
+{
+  GOptionContext *ctx;
+  GPtrArray *sections;
+  GError *err = NULL;
+  gchar **child_argv;
+  gint i;
+
+  /* Keep the arguments around for the child processes */
+  child_argv = g_new0 (gchar *, argc + 1);
+  for (i = 0; i < argc; i++)
+    child_argv[i] = g_strdup (argv[i]);
+
+  ctx = g_option_context_new ("- MPEG-TS section CRC benchmark");
+  g_option_context_add_main_entries (ctx, entries, NULL);
+  g_option_context_add_group (ctx, gst_init_get_option_group ());
+  if (!g_option_context_parse (ctx, &argc, &argv, &err)) {
+    g_printerr ("Error initializing: %s\n", err->message);
+    g_clear_error (&err);
+    g_option_context_free (ctx);
+    g_strfreev (child_argv);
+    return 1;
+  }
+  g_option_context_free (ctx);
+
+  if (g_getenv ("GST_MPEGTS_CRC32") == NULL) {
+    for (i = 0; i < G_N_ELEMENTS (implementations); i++) {
+      gchar **envp = g_environ_setenv (g_get_environ (), "GST_MPEGTS_CRC32",
+          implementations[i], TRUE);
+      gchar *output = NULL;
+
+      if (g_spawn_sync (NULL, child_argv, envp, 0, NULL, NULL, &output, NULL,
+              NULL, &err)) {
+        g_print ("%s", output);
+      } else {
+        g_printerr ("Could not run the %s benchmark: %s\n", implementations[i],
+            err->message);
+        g_clear_error (&err);
+      }
+      g_free (output);
+      g_strfreev (envp);
+    }
+    g_strfreev (child_argv);
+    return 0;
+  }
+  g_strfreev (child_argv);
+
+  gst_mpegts_initialize ();
+
+  if (location)
+    sections = read_sections (location);
+  else
+    sections = create_sections ();
+
+  if (sections->len == 0)
+    g_printerr ("No EIT sections to parse\n");
+  else
+    run_benchmark (sections);
+
+  g_ptr_array_unref (sections);
+
+  return 0;
+}
@@ -0,0 +1,274 @@
+/*
+ * shm.c - Benchmark the transports of shmsink and shmsrc
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Sends --buffers buffers of --size bytes from a shmsink to a shmsrc in the
+ * same process, signalled over the control socket and through rings of
+ * --ring-size slots. Each buffer carries the time it was sent. The number
+ * of messages per second is measured with the sink sending as fast as it
+ * can, and the latency over one second of the sink sending PACED_RATE
+ * buffers per second, so that the source has to be woken up for each of
+ * them. The first buffer waits for the pipelines to start and is left out
+ * of the latency. */
+
+#include <gst/gst.h>
+
+#define DEFAULT_BUFFERS 100000
+#define DEFAULT_SIZE 64
+#define DEFAULT_RING_SIZE 256
+#define PACED_RATE 1000
+
+static gint num_buffers = DEFAULT_BUFFERS;
+static gint size = DEFAULT_SIZE;
+static gint ring_size = DEFAULT_RING_SIZE;
+
+static GOptionEntry entries[] = {
+  {"buffers", 'b', 0, G_OPTION_ARG_INT, &num_buffers,
+      "Number of buffers to send", NULL},
+  {"size", 's', 0, G_OPTION_ARG_INT, &size, "Size of the buffers", NULL},
+  {"ring-size", 'r', 0, G_OPTION_ARG_INT, &ring_size,
+      "Number of slots of the ring", NULL},
+  {NULL}
+};
+
+typedef struct
+{
+  GMutex lock;
+  GCond cond;
+
+  gint n_expected;
+  gint n_received;
+  GstClockTime first, last;
+  GstClockTime latency_sum, latency_max;
+} Stats;
+
+static GstPadProbeReturn
+stamp_probe (GstPad * pad, GstPadProbeInfo * info, gpointer user_data)
+{
+  GstBuffer *buf = GST_PAD_PROBE_INFO_BUFFER (info);
+  GstClockTime now;
+
+  buf = gst_buffer_make_writable (buf);
+  now = gst_util_get_timestamp ();
+  gst_buffer_fill (buf, 0, &now, sizeof (now));
+  GST_PAD_PROBE_INFO_DATA (info) = buf;
+
+  return GST_PAD_PROBE_OK;
+}
+
+static GstPadProbeReturn
+receive_probe (GstPad * pad, GstPadProbeInfo * info, Stats * stats)
+{
+  GstClockTime now = gst_util_get_timestamp ();
+  GstClockTime sent;
+
+  gst_buffer_extract (GST_PAD_PROBE_INFO_BUFFER (info), 0, &sent,
+      sizeof (sent));
+
+  g_mutex_lock (&stats->lock);
+  if (stats->n_received == 0) {
+    stats->first = now;
+  } else {
+    stats->latency_sum += now - sent;
+    stats->latency_max = MAX (stats->latency_max, now - sent);
+  }
+  stats->last = now;
+  if (++stats->n_received == stats->n_expected)
+    g_cond_signal (&stats->cond);
+  g_mutex_unlock (&stats->lock);
+
+  return GST_PAD_PROBE_OK;
+}
+
+static void
+add_probe (GstElement * pipeline, const gchar * name, GstPadProbeCallback func,
+    gpointer user_data)
+{
+  GstElement *element;
+  GstPad *pad;
+
+  element = gst_bin_get_by_name (GST_BIN (pipeline), name);
+  pad = gst_element_get_static_pad (element, "sink");
+  gst_pad_add_probe (pad, GST_PAD_PROBE_TYPE_BUFFER, func, user_data, NULL);
+  gst_object_unref (pad);
+  gst_object_unref (element);
+}
+
+static GstElement *
+create_pipeline (const gchar * desc)
+{
+  GstElement *pipeline;
+  GError *err = NULL;
+
+  pipeline = gst_parse_launch (desc, &err);
+  if (pipeline == NULL) {
+    g_printerr ("Could not create pipeline: %s\n", err->message);
+    g_clear_error (&err);
+  }
+
+  return pipeline;
+}
+
+static gboolean
+check_errors (GstElement * pipeline)
+{
+  GstBus *bus = gst_element_get_bus (pipeline);
+  GstMessage *msg;
+  GError *err = NULL;
+
+  msg = gst_bus_pop_filtered (bus, GST_MESSAGE_ERROR);
+  gst_object_unref (bus);
+  if (msg == NULL)
+    return TRUE;
+
+  gst_message_parse_error (msg, &err, NULL);
+  g_printerr ("%s: %s\n", GST_OBJECT_NAME (GST_MESSAGE_SRC (msg)),
+      err->message);
+  g_clear_error (&err);
+  gst_message_unref (msg);
+
+  return FALSE;
+}
+
+/* Returns FALSE on errors, or if not all buffers made it in time */
+static gboolean
+run_pipelines (guint n_slots, gint n_buffers, gboolean paced, Stats * stats)
+{
+  GstElement *sink_pipeline, *src_pipeline = NULL, *sink;
+  gchar *desc, *socket_path = NULL;
+  gboolean ret = FALSE;
+
+  desc = g_strdup_printf ("fakesrc num-buffers=%d sizetype=fixed sizemax=%d"
+      " filltype=nothing datarate=%d ! shmsink name=sink"
+      " socket-path=%s/shm-benchmark ring-size=%u sync=%s", n_buffers, size,
+      paced ? size * PACED_RATE : 0, g_get_tmp_dir (), n_slots,
+      paced ? "true" : "false");
+  sink_pipeline = create_pipeline (desc);
+  g_free (desc);
+  if (sink_pipeline == NULL)
+    return FALSE;
+  add_probe (sink_pipeline, "sink", stamp_probe, NULL);
+
+  /* shmsink picks another path if that one is taken */
+  gst_element_set_state (sink_pipeline, GST_STATE_PAUSED);
+  sink = gst_bin_get_by_name (GST_BIN (sink_pipeline), "sink");
+  g_object_get (sink, "socket-path", &socket_path, NULL);
+  gst_object_unref (sink);
+  if (socket_path == NULL || !check_errors (sink_pipeline))
+    goto done;
+
+  desc = g_strdup_printf ("shmsrc socket-path=%s ! fakesink name=fake"
+      " sync=false", socket_path);
+  src_pipeline = create_pipeline (desc);
+  g_free (desc);
+  if (src_pipeline == NULL)
+    goto done;
+  add_probe (src_pipeline, "fake", (GstPadProbeCallback) receive_probe,
+      stats);
+
+  stats->n_expected = n_buffers;
+  stats->n_received = 0;
+  stats->latency_sum = stats->latency_max = 0;
+
+  gst_element_set_state (src_pipeline, GST_STATE_PLAYING);
+  gst_element_set_state (sink_pipeline, GST_STATE_PLAYING);
+
+  g_mutex_lock (&stats->lock);
+  ret = TRUE;
+  while (ret && stats->n_received < stats->n_expected) {
+    if (!g_cond_wait_until (&stats->cond, &stats->lock,
+            g_get_monotonic_time () + 100 * G_TIME_SPAN_MILLISECOND)) {
+      g_mutex_unlock (&stats->lock);
+      ret = check_errors (sink_pipeline) && check_errors (src_pipeline);
+      g_mutex_lock (&stats->lock);
+    }
+  }
+  g_mutex_unlock (&stats->lock);
+
+done:
+  if (src_pipeline) {
+    gst_element_set_state (src_pipeline, GST_STATE_NULL);
+    gst_object_unref (src_pipeline);
+  }
+  gst_element_set_state (sink_pipeline, GST_STATE_NULL);
+  gst_object_unref (sink_pipeline);
+  g_free (socket_path);
+
+  return ret;
+}
+
+static void
+run_benchmark (guint n_slots)
+{
+  Stats stats = { {0}, };
+
+  g_mutex_init (&stats.lock);
+  g_cond_init (&stats.cond);
+
+  if (n_slots)
+    g_print ("ring of %4u:", n_slots);
+  else
+    g_print ("socket:      ");
+
+  if (run_pipelines (n_slots, num_buffers, FALSE, &stats) &&
+      stats.last > stats.first)
+    g_print (" %10.0f msgs/s", (gdouble) (stats.n_received - 1) * GST_SECOND /
+        (stats.last - stats.first));
+  else
+    g_print (" %10s msgs/s", "failed");
+
+  if (run_pipelines (n_slots, MIN (num_buffers, PACED_RATE), TRUE, &stats))
+    g_print (", latency %8.2f us avg %8.2f us max\n",
+        (gdouble) stats.latency_sum / (stats.n_received - 1) / GST_USECOND,
+        (gdouble) stats.latency_max / GST_USECOND);
+  else
+    g_print (", latency failed\n");
+
+  g_mutex_clear (&stats.lock);
+  g_cond_clear (&stats.cond);
+}
+
+int
+main (int argc, char **argv)
+{
+  GOptionContext *ctx;
+  GError *err = NULL;
+
+  ctx = g_option_context_new ("- shared memory transport benchmark");
+  g_option_context_add_main_entries (ctx, entries, NULL);
+  g_option_context_add_group (ctx, gst_init_get_option_group ());
+  if (!g_option_context_parse (ctx, &argc, &argv, &err)) {
+    g_printerr ("Error initializing: %s\n", err->message);
+    g_clear_error (&err);
+    g_option_context_free (ctx);
+    return 1;
+  }
+  g_option_context_free (ctx);
+
+  if (num_buffers < 2 || size < (gint) sizeof (GstClockTime) || ring_size < 1) {
+    g_printerr ("Invalid parameters\n");
+    return 1;
+  }
+
+  g_print ("%d buffers of %d bytes, latency at %d buffers per second\n",
+      num_buffers, size, PACED_RATE);
+  run_benchmark (0);
+  run_benchmark (ring_size);
+
+  return 0;
+}
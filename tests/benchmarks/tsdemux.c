@@ -0,0 +1,176 @@
+/*
+ * tsdemux.c - Benchmark the MPEG-TS packet processing of tsdemux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <string.h>
+#include <gst/gst.h>
+
+#define TS_PACKET_SIZE 188
+#define PACKETS_PER_BUFFER 1024
+#define DEFAULT_NUM_BUFFERS 2000
+
+#define PCR_PID 0x100
+/* Insert a PCR every PCR_INTERVAL packets */
+#define PCR_INTERVAL 40
+
+static gint num_buffers = DEFAULT_NUM_BUFFERS;
+
+static GOptionEntry entries[] = {
+  {"buffers", 'b', 0, G_OPTION_ARG_INT, &num_buffers,
+      "Number of buffers to push for each packet size", NULL},
+  {NULL}
+};
+
+/* Creates a buffer of packets spread over 8 PIDs. The 192 byte variant
+ * gets a (zero) 4 byte timecode prefix, the 204 byte variant 16 trailing
+ * bytes of (zero) FEC data */
+static GstBuffer *
+create_ts_buffer (guint packet_size, guint64 * pcr)
+{
+  GstBuffer *buf;
+  GstMapInfo map;
+  guint8 *data;
+  guint i, prefix;
+
+  prefix = packet_size == 192 ? 4 : 0;
+
+  buf = gst_buffer_new_allocate (NULL, packet_size * PACKETS_PER_BUFFER, NULL);
+  gst_buffer_map (buf, &map, GST_MAP_WRITE);
+  memset (map.data, 0, map.size);
+
+  for (i = 0; i < PACKETS_PER_BUFFER; i++) {
+    guint16 pid = PCR_PID + (i % 8);
+
+    data = map.data + i * packet_size + prefix;
+    memset (data, 0xff, TS_PACKET_SIZE);
+
+    data[0] = 0x47;
+    data[1] = (pid >> 8) & 0x1f;
+    data[2] = pid & 0xff;
+
+    if (pid == PCR_PID && (i % PCR_INTERVAL) == 0) {
+      guint64 base = *pcr / 300;
+      guint16 ext = *pcr % 300;
+
+      /* adaptation field + payload */
+      data[3] = 0x30 | ((i / 8) & 0x0f);
+      data[4] = 7;
+      data[5] = 0x10;
+      data[6] = (base >> 25) & 0xff;
+      data[7] = (base >> 17) & 0xff;
+      data[8] = (base >> 9) & 0xff;
+      data[9] = (base >> 1) & 0xff;
+      data[10] = ((base & 0x1) << 7) | 0x7e | ((ext >> 8) & 0x1);
+      data[11] = ext & 0xff;
+
+      /* 40ms at 27MHz */
+      *pcr += 27000 * 40;
+    } else {
+      /* payload only */
+      data[3] = 0x10 | ((i / 8) & 0x0f);
+    }
+  }
+
+  gst_buffer_unmap (buf, &map);
+
+  return buf;
+}
+
+static void
+run_benchmark (guint packet_size)
+{
+  GstElement *demux;
+  GstPad *srcpad, *sinkpad;
+  GstSegment segment;
+  GstCaps *caps;
+  GstBuffer *buf;
+  GstClockTime start, total = 0;
+  guint64 offset = 0, pcr = 0;
+  gdouble elapsed;
+  gint i;
+
+  demux = gst_element_factory_make ("tsdemux", NULL);
+  if (demux == NULL) {
+    g_printerr ("tsdemux element not available\n");
+    return;
+  }
+
+  srcpad = gst_pad_new ("src", GST_PAD_SRC);
+  sinkpad = gst_element_get_static_pad (demux, "sink");
+  gst_pad_link (srcpad, sinkpad);
+  gst_object_unref (sinkpad);
+  gst_pad_set_active (srcpad, TRUE);
+
+  gst_element_set_state (demux, GST_STATE_PLAYING);
+
+  gst_pad_push_event (srcpad, gst_event_new_stream_start ("tsdemux-bench"));
+  caps = gst_caps_new_simple ("video/mpegts",
+      "systemstream", G_TYPE_BOOLEAN, TRUE,
+      "packetsize", G_TYPE_INT, packet_size, NULL);
+  gst_pad_push_event (srcpad, gst_event_new_caps (caps));
+  gst_caps_unref (caps);
+  gst_segment_init (&segment, GST_FORMAT_BYTES);
+  gst_pad_push_event (srcpad, gst_event_new_segment (&segment));
+
+  /* Only account for the time spent in the demuxer */
+  for (i = 0; i < num_buffers; i++) {
+    buf = create_ts_buffer (packet_size, &pcr);
+    GST_BUFFER_OFFSET (buf) = offset;
+    offset += gst_buffer_get_size (buf);
+
+    start = gst_util_get_timestamp ();
+    gst_pad_push (srcpad, buf);
+    total += gst_util_get_timestamp () - start;
+  }
+
+  elapsed = (gdouble) total / GST_SECOND;
+  g_print ("%3u bytes: %" G_GUINT64_FORMAT " packets in %.3fs, "
+      "%.0f packets/s (%.1f Mbit/s)\n", packet_size,
+      (guint64) num_buffers * PACKETS_PER_BUFFER, elapsed,
+      num_buffers * PACKETS_PER_BUFFER / elapsed,
+      offset * 8 / elapsed / 1000000.0);
+
+  gst_element_set_state (demux, GST_STATE_NULL);
+  gst_pad_set_active (srcpad, FALSE);
+  gst_object_unref (srcpad);
+  gst_object_unref (demux);
+}
+
+int
+main (int argc, char **argv)
+{
+  GOptionContext *ctx;
+  GError *err = NULL;
+
+  ctx = g_option_context_new ("- tsdemux packet processing benchmark");
+  g_option_context_add_main_entries (ctx, entries, NULL);
+  g_option_context_add_group (ctx, gst_init_get_option_group ());
+  if (!g_option_context_parse (ctx, &argc, &argv, &err)) {
+    g_printerr ("Error initializing: %s\n", err->message);
+    g_clear_error (&err);
+    g_option_context_free (ctx);
+    return 1;
+  }
+  g_option_context_free (ctx);
+
+  run_benchmark (188);
+  run_benchmark (192);
+  run_benchmark (204);
+
+  return 0;
+}
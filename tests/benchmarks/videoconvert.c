@@ -0,0 +1,144 @@
+/*
+ * videoconvert.c - Benchmark the conversions of the videoaggregator inputs
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Feeds --frames queued frames of each of the --formats to a single
+ * compositor input, with each of the --formats as output, at 1080p and 4K.
+ * This is run with 1 conversion thread and with one per processor, and
+ * reports the time spent per frame on top of the same pipeline without
+ * conversion, which is run first for each output format. */
+
+#include <gst/gst.h>
+
+#include "benchutils.h"
+
+#define DEFAULT_FRAMES 20
+#define DEFAULT_FORMATS "AYUV,BGRA,ARGB,RGBA,ABGR,Y444,Y42B,YUY2,UYVY,YVYU," \
+    "I420,YV12,NV12,NV21,Y41B,RGB,BGR,xRGB,xBGR,RGBx,BGRx"
+
+static gint num_frames = DEFAULT_FRAMES;
+static gchar *format_list = NULL;
+
+static GOptionEntry entries[] = {
+  {"frames", 'f', 0, G_OPTION_ARG_INT, &num_frames,
+      "Number of frames to convert", NULL},
+  {"formats", 'F', 0, G_OPTION_ARG_STRING, &format_list,
+      "Comma separated list of formats (default: all compositor formats)",
+        NULL},
+  {NULL}
+};
+
+static const struct
+{
+  gint width, height;
+} sizes[] = { {1920, 1080}, {3840, 2160} };
+
+/* Returns the time to process a frame, or GST_CLOCK_TIME_NONE on errors */
+static GstClockTime
+run_pipeline (const gchar * in_format, const gchar * out_format, gint width,
+    gint height, guint n_threads)
+{
+  GstClockTime elapsed;
+  gchar *desc, *name;
+
+  desc = g_strdup_printf ("videotestsrc pattern=snow num-buffers=%d"
+      " ! video/x-raw,format=%s,width=%d,height=%d,framerate=30/1"
+      " ! queue name=q0 max-size-buffers=0 max-size-bytes=0 max-size-time=0"
+      " ! compositor conversion-threads=%u ! video/x-raw,format=%s"
+      " ! fakesink", num_frames, in_format, width, height, n_threads,
+      out_format);
+  name = g_strdup_printf ("%s -> %s", in_format, out_format);
+  elapsed = bench_run_queued_pipeline (desc, 1, num_frames, name);
+  g_free (name);
+  g_free (desc);
+
+  return elapsed;
+}
+
+static void
+print_time (GstClockTime time, GstClockTime baseline)
+{
+  if (time == GST_CLOCK_TIME_NONE)
+    g_print (" %8s", "failed");
+  else
+    g_print (" %6.2f ms", (gdouble) (time > baseline ? time - baseline : 0) /
+        GST_MSECOND);
+}
+
+static void
+run_benchmark (gchar ** formats, gint width, gint height, guint max_threads)
+{
+  guint i, j;
+
+  g_print ("%dx%d, time per frame with 1 and %u conversion threads\n", width,
+      height, max_threads);
+
+  for (i = 0; formats[i]; i++) {
+    GstClockTime baseline;
+
+    baseline = run_pipeline (formats[i], formats[i], width, height, 1);
+    if (baseline == GST_CLOCK_TIME_NONE)
+      continue;
+
+    for (j = 0; formats[j]; j++) {
+      if (i == j)
+        continue;
+
+      g_print ("%-4s -> %-4s:", formats[j], formats[i]);
+      print_time (run_pipeline (formats[j], formats[i], width, height, 1),
+          baseline);
+      print_time (run_pipeline (formats[j], formats[i], width, height,
+              max_threads), baseline);
+      g_print ("\n");
+    }
+  }
+}
+
+int
+main (int argc, char **argv)
+{
+  GOptionContext *ctx;
+  GError *err = NULL;
+  gchar **formats;
+  guint i;
+
+  ctx = g_option_context_new ("- video conversion benchmark");
+  g_option_context_add_main_entries (ctx, entries, NULL);
+  g_option_context_add_group (ctx, gst_init_get_option_group ());
+  if (!g_option_context_parse (ctx, &argc, &argv, &err)) {
+    g_printerr ("Error initializing: %s\n", err->message);
+    g_clear_error (&err);
+    g_option_context_free (ctx);
+    return 1;
+  }
+  g_option_context_free (ctx);
+
+  if (num_frames < 1) {
+    g_printerr ("Invalid parameters\n");
+    return 1;
+  }
+
+  formats = g_strsplit (format_list ? format_list : DEFAULT_FORMATS, ",", -1);
+  for (i = 0; i < G_N_ELEMENTS (sizes); i++)
+    run_benchmark (formats, sizes[i].width, sizes[i].height,
+        g_get_num_processors ());
+  g_strfreev (formats);
+  g_free (format_list);
+
+  return 0;
+}
@@ -0,0 +1,117 @@
+/*
+ * yadif.c - Benchmark the deinterlacing of yadif
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Deinterlaces --frames queued 1080i25 frames, at frame and at field rate,
+ * for 1 up to the number of processors filtering threads, and reports the
+ * time spent per input frame on top of the same pipeline without yadif.
+ * The line filter can be picked by setting GST_YADIF_IMPL to "c", "sse2" or
+ * "avx2". */
+
+#include <gst/gst.h>
+
+#include "benchutils.h"
+
+#define DEFAULT_FRAMES 100
+
+static gint num_frames = DEFAULT_FRAMES;
+
+static GOptionEntry entries[] = {
+  {"frames", 'f', 0, G_OPTION_ARG_INT, &num_frames,
+      "Number of frames to deinterlace", NULL},
+  {NULL}
+};
+
+/* Returns the time to process a frame, or GST_CLOCK_TIME_NONE on errors */
+static GstClockTime
+run_pipeline (const gchar * filter)
+{
+  GstClockTime elapsed;
+  gchar *desc;
+
+  desc = g_strdup_printf ("videotestsrc pattern=ball num-buffers=%d"
+      " ! video/x-raw,format=I420,width=1920,height=1080,framerate=25/1"
+      " ! queue name=q0 max-size-buffers=0 max-size-bytes=0 max-size-time=0"
+      " ! %s ! fakesink", num_frames, filter);
+  elapsed = bench_run_queued_pipeline (desc, 1, num_frames, filter);
+  g_free (desc);
+
+  return elapsed;
+}
+
+static void
+run_benchmark (guint n_threads, GstClockTime baseline)
+{
+  gchar *filter;
+  gint double_rate;
+
+  g_print ("%2u threads:", n_threads);
+  for (double_rate = 0; double_rate < 2; double_rate++) {
+    GstClockTime time;
+
+    filter = g_strdup_printf ("yadif mode=interlaced n-threads=%u"
+        " double-rate=%d", n_threads, double_rate);
+    time = run_pipeline (filter);
+    g_free (filter);
+
+    if (time == GST_CLOCK_TIME_NONE)
+      g_print (" %8s", "failed");
+    else
+      g_print (" %6.2f ms", (gdouble) (time > baseline ? time - baseline : 0) /
+          GST_MSECOND);
+  }
+  g_print ("\n");
+}
+
+int
+main (int argc, char **argv)
+{
+  GOptionContext *ctx;
+  GError *err = NULL;
+  GstClockTime baseline;
+  guint n_threads, max_threads;
+
+  ctx = g_option_context_new ("- deinterlacing benchmark");
+  g_option_context_add_main_entries (ctx, entries, NULL);
+  g_option_context_add_group (ctx, gst_init_get_option_group ());
+  if (!g_option_context_parse (ctx, &argc, &argv, &err)) {
+    g_printerr ("Error initializing: %s\n", err->message);
+    g_clear_error (&err);
+    g_option_context_free (ctx);
+    return 1;
+  }
+  g_option_context_free (ctx);
+
+  if (num_frames < 2) {
+    g_printerr ("Invalid parameters\n");
+    return 1;
+  }
+
+  baseline = run_pipeline ("identity");
+  if (baseline == GST_CLOCK_TIME_NONE)
+    return 1;
+
+  g_print ("%d frames of 1080i, time per frame at frame and field rate\n",
+      num_frames);
+  max_threads = g_get_num_processors ();
+  for (n_threads = 1; n_threads < max_threads; n_threads *= 2)
+    run_benchmark (n_threads, baseline);
+  run_benchmark (max_threads, baseline);
+
+  return 0;
+}
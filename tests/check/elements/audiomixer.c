@@ -21,6 +21,9 @@
  * Boston, MA 02110-1301, USA.
  */
 
+/* for GValueArray, which the mix-matrix property uses */
+#define GLIB_DISABLE_DEPRECATION_WARNINGS
+
 #ifdef HAVE_CONFIG_H
 # include <config.h>
 #endif
@@ -870,12 +873,31 @@ GST_END_TEST;
 
 
 static GstBuffer *handoff_buffer = NULL;
+static GMutex handoff_lock;
+static GCond handoff_cond;
+
 static void
 handoff_buffer_cb (GstElement * fakesink, GstBuffer * buffer, GstPad * pad,
     gpointer user_data)
 {
   GST_DEBUG ("got buffer %p", buffer);
+  g_mutex_lock (&handoff_lock);
   gst_buffer_replace (&handoff_buffer, buffer);
+  g_cond_signal (&handoff_cond);
+  g_mutex_unlock (&handoff_lock);
+}
+
+/* the output is pushed from the streaming thread of audiomixer, wait until
+ * the mixed data reaches @end */
+static void
+wait_for_handoff (GstClockTime end)
+{
+  g_mutex_lock (&handoff_lock);
+  while (handoff_buffer == NULL
+      || GST_BUFFER_TIMESTAMP (handoff_buffer) +
+      GST_BUFFER_DURATION (handoff_buffer) < end)
+    g_cond_wait (&handoff_cond, &handoff_lock);
+  g_mutex_unlock (&handoff_lock);
 }
 
 /* check if clipping works as expected */
@@ -905,6 +927,8 @@ GST_START_TEST (test_clip)
 
   /* just an audiomixer and a fakesink */
   audiomixer = gst_element_factory_make ("audiomixer", "audiomixer");
+  /* 10ms blocks, that end exactly where the input buffers do */
+  g_object_set (audiomixer, "blocksize", 441, NULL);
   sink = gst_element_factory_make ("fakesink", "sink");
   g_object_set (sink, "signal-handoffs", TRUE, NULL);
   g_signal_connect (sink, "handoff", (GCallback) handoff_buffer_cb, NULL);
@@ -953,25 +977,30 @@ GST_START_TEST (test_clip)
   ck_assert_int_eq (ret, GST_FLOW_OK);
   fail_unless (handoff_buffer == NULL);
 
-  /* should be partially clipped */
+  /* should be partially clipped, to 150ms */
   buffer = gst_buffer_new_and_alloc (44100);
   GST_BUFFER_TIMESTAMP (buffer) = 900 * GST_MSECOND;
   GST_BUFFER_DURATION (buffer) = 250 * GST_MSECOND;
   GST_DEBUG ("pushing buffer %p", buffer);
   ret = gst_pad_chain (sinkpad, buffer);
   ck_assert_int_eq (ret, GST_FLOW_OK);
-  fail_unless (handoff_buffer != NULL);
+  wait_for_handoff (150 * GST_MSECOND);
+  g_mutex_lock (&handoff_lock);
   gst_buffer_replace (&handoff_buffer, NULL);
+  g_mutex_unlock (&handoff_lock);
 
-  /* should not be clipped */
+  /* should not be clipped, and is mixed right after the previous one as the
+   * gap is shorter than discont-wait */
   buffer = gst_buffer_new_and_alloc (44100);
   GST_BUFFER_TIMESTAMP (buffer) = 1 * GST_SECOND;
   GST_BUFFER_DURATION (buffer) = 250 * GST_MSECOND;
   GST_DEBUG ("pushing buffer %p", buffer);
   ret = gst_pad_chain (sinkpad, buffer);
   ck_assert_int_eq (ret, GST_FLOW_OK);
-  fail_unless (handoff_buffer != NULL);
+  wait_for_handoff (400 * GST_MSECOND);
+  g_mutex_lock (&handoff_lock);
   gst_buffer_replace (&handoff_buffer, NULL);
+  g_mutex_unlock (&handoff_lock);
 
   /* should be clipped and ok */
   buffer = gst_buffer_new_and_alloc (44100);
@@ -1242,11 +1271,15 @@ GST_START_TEST (test_flush_start_flush_stop)
   fail_unless (gst_element_get_state (pipeline, NULL, NULL,
           GST_CLOCK_TIME_NONE) == GST_STATE_CHANGE_SUCCESS);
 
+  /* a flush of one of the inputs only flushes that input, the output keeps
+   * being mixed from the others */
   audiomixer_src = gst_element_get_static_pad (audiomixer, "src");
   fail_if (GST_PAD_IS_FLUSHING (audiomixer_src));
   gst_pad_send_event (sinkpad1, gst_event_new_flush_start ());
-  fail_unless (GST_PAD_IS_FLUSHING (audiomixer_src));
+  fail_unless (GST_PAD_IS_FLUSHING (sinkpad1));
+  fail_if (GST_PAD_IS_FLUSHING (audiomixer_src));
   gst_pad_send_event (sinkpad1, gst_event_new_flush_stop (TRUE));
+  fail_if (GST_PAD_IS_FLUSHING (sinkpad1));
   fail_if (GST_PAD_IS_FLUSHING (audiomixer_src));
   gst_object_unref (audiomixer_src);
 
@@ -1262,6 +1295,71 @@ GST_START_TEST (test_flush_start_flush_stop)
 
 GST_END_TEST;
 
+/* in live mode, a pad without data is mixed as silence once the deadline of
+ * the output block passed, instead of stalling the other inputs */
+GST_START_TEST (test_live_late_pad)
+{
+  GstPadTemplate *sink_template;
+  GstPad *tmppad, *sinkpad1, *sinkpad2;
+  GstElement *pipeline, *src1, *src2, *drop, *audiomixer, *sink;
+
+  GST_INFO ("preparing test");
+
+  /* build pipeline */
+  pipeline = gst_pipeline_new ("pipeline");
+  src1 = gst_element_factory_make ("audiotestsrc", "src1");
+  g_object_set (src1, "wave", 4, "is-live", TRUE, "samplesperbuffer", 441,
+      NULL);
+  src2 = gst_element_factory_make ("audiotestsrc", "src2");
+  g_object_set (src2, "wave", 4, "is-live", TRUE, "samplesperbuffer", 441,
+      NULL);
+  /* src2 only provides the caps, segment and latency, but never any data */
+  drop = gst_element_factory_make ("identity", "drop");
+  g_object_set (drop, "drop-probability", 1.0, NULL);
+  audiomixer = gst_element_factory_make ("audiomixer", "audiomixer");
+  g_object_set (audiomixer, "blocksize", 441, NULL);
+  sink = gst_element_factory_make ("fakesink", "sink");
+  g_object_set (sink, "signal-handoffs", TRUE, NULL);
+  g_signal_connect (sink, "handoff", (GCallback) handoff_buffer_cb, NULL);
+  gst_bin_add_many (GST_BIN (pipeline), src1, src2, drop, audiomixer, sink,
+      NULL);
+  fail_unless (gst_element_link (src2, drop));
+
+  sink_template =
+      gst_element_class_get_pad_template (GST_ELEMENT_GET_CLASS (audiomixer),
+      "sink_%u");
+  fail_unless (GST_IS_PAD_TEMPLATE (sink_template));
+  sinkpad1 = gst_element_request_pad (audiomixer, sink_template, NULL, NULL);
+  tmppad = gst_element_get_static_pad (src1, "src");
+  gst_pad_link (tmppad, sinkpad1);
+  gst_object_unref (tmppad);
+
+  sinkpad2 = gst_element_request_pad (audiomixer, sink_template, NULL, NULL);
+  tmppad = gst_element_get_static_pad (drop, "src");
+  gst_pad_link (tmppad, sinkpad2);
+  gst_object_unref (tmppad);
+
+  fail_unless (gst_element_link (audiomixer, sink));
+
+  gst_element_set_state (pipeline, GST_STATE_PLAYING);
+  wait_for_handoff (100 * GST_MSECOND);
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+
+  g_mutex_lock (&handoff_lock);
+  gst_buffer_replace (&handoff_buffer, NULL);
+  g_mutex_unlock (&handoff_lock);
+
+  gst_element_release_request_pad (audiomixer, sinkpad1);
+  gst_object_unref (sinkpad1);
+  gst_element_release_request_pad (audiomixer, sinkpad2);
+  gst_object_unref (sinkpad2);
+
+  /* cleanup */
+  gst_object_unref (pipeline);
+}
+
+GST_END_TEST;
+
 static void
 handoff_buffer_collect_cb (GstElement * fakesink, GstBuffer * buffer,
     GstPad * pad, gpointer user_data)
@@ -1725,6 +1823,285 @@ GST_START_TEST (test_sync_unaligned)
 
 GST_END_TEST;
 
+#if G_BYTE_ORDER == G_BIG_ENDIAN
+#define S16_NE "S16BE"
+#else
+#define S16_NE "S16LE"
+#endif
+
+/* Links a queue to a new sink pad of @audiomixer, returns the sink pad and
+ * the one of the queue in @queue_sinkpad */
+static GstPad *
+create_input (GstElement * bin, GstElement * audiomixer,
+    GstPad ** queue_sinkpad)
+{
+  GstElement *queue;
+  GstPad *sinkpad, *pad;
+
+  queue = gst_element_factory_make ("queue", NULL);
+  gst_bin_add (GST_BIN (bin), queue);
+  gst_element_sync_state_with_parent (queue);
+
+  sinkpad = gst_element_get_request_pad (audiomixer, "sink_%u");
+  fail_if (sinkpad == NULL, NULL);
+  pad = gst_element_get_static_pad (queue, "src");
+  fail_unless (gst_pad_link (pad, sinkpad) == GST_PAD_LINK_OK);
+  gst_object_unref (pad);
+
+  *queue_sinkpad = gst_element_get_static_pad (queue, "sink");
+
+  return sinkpad;
+}
+
+/* Pushes a second of 1000Hz S16 audio to @queue_sinkpad, with every sample
+ * of each channel set to the matching one of @values, followed by EOS */
+static void
+push_s16_input (GstPad * queue_sinkpad, gint channels, const gint16 * values)
+{
+  GstSegment segment;
+  GstBuffer *buffer;
+  GstMapInfo map;
+  GstCaps *caps;
+  gint16 *data;
+  gint i;
+
+  gst_pad_send_event (queue_sinkpad, gst_event_new_stream_start ("test"));
+
+  caps = gst_caps_new_simple ("audio/x-raw", "format", G_TYPE_STRING, S16_NE,
+      "layout", G_TYPE_STRING, "interleaved", "rate", G_TYPE_INT, 1000,
+      "channels", G_TYPE_INT, channels, NULL);
+  /* FL, FR, FC, LFE1, RL and RR */
+  if (channels == 6)
+    gst_caps_set_simple (caps, "channel-mask", GST_TYPE_BITMASK,
+        G_GUINT64_CONSTANT (0x3f), NULL);
+  gst_pad_set_caps (queue_sinkpad, caps);
+  gst_caps_unref (caps);
+
+  gst_segment_init (&segment, GST_FORMAT_TIME);
+  gst_pad_send_event (queue_sinkpad, gst_event_new_segment (&segment));
+
+  buffer = gst_buffer_new_and_alloc (1000 * channels * sizeof (gint16));
+  gst_buffer_map (buffer, &map, GST_MAP_WRITE);
+  data = (gint16 *) map.data;
+  for (i = 0; i < 1000 * channels; i++)
+    data[i] = values[i % channels];
+  gst_buffer_unmap (buffer, &map);
+  GST_BUFFER_TIMESTAMP (buffer) = 0;
+  GST_BUFFER_DURATION (buffer) = 1 * GST_SECOND;
+  ck_assert_int_eq (gst_pad_chain (queue_sinkpad, buffer), GST_FLOW_OK);
+
+  gst_pad_send_event (queue_sinkpad, gst_event_new_eos ());
+  gst_object_unref (queue_sinkpad);
+}
+
+/* Runs @bin until EOS and returns the buffers of its "sink" */
+static GList *
+run_and_collect_buffers (GstElement * bin)
+{
+  GstElement *sink;
+  GstBus *bus;
+  GList *received_buffers = NULL;
+
+  main_loop = g_main_loop_new (NULL, FALSE);
+  bus = gst_element_get_bus (bin);
+  gst_bus_add_signal_watch_full (bus, G_PRIORITY_HIGH);
+  g_signal_connect (bus, "message::error", (GCallback) message_received, bin);
+  g_signal_connect (bus, "message::warning", (GCallback) message_received, bin);
+  g_signal_connect (bus, "message::eos", (GCallback) message_received, bin);
+
+  sink = gst_bin_get_by_name (GST_BIN (bin), "sink");
+  g_signal_connect (sink, "handoff", (GCallback) handoff_buffer_collect_cb,
+      &received_buffers);
+  gst_object_unref (sink);
+
+  g_idle_add ((GSourceFunc) set_playing, bin);
+  g_main_loop_run (main_loop);
+
+  gst_element_set_state (bin, GST_STATE_NULL);
+  gst_bus_remove_signal_watch (bus);
+  gst_object_unref (bus);
+  g_main_loop_unref (main_loop);
+
+  return received_buffers;
+}
+
+static GstElement *
+create_remix_pipeline (GstElement ** audiomixer, gint channels)
+{
+  GstElement *bin, *sink;
+  GstCaps *caps;
+
+  bin = gst_pipeline_new ("pipeline");
+  *audiomixer = gst_element_factory_make ("audiomixer", "audiomixer");
+  caps = gst_caps_new_simple ("audio/x-raw", "format", G_TYPE_STRING, S16_NE,
+      "rate", G_TYPE_INT, 1000, "channels", G_TYPE_INT, channels, NULL);
+  g_object_set (*audiomixer, "blocksize", 500, "caps", caps, NULL);
+  gst_caps_unref (caps);
+  sink = gst_element_factory_make ("fakesink", "sink");
+  g_object_set (sink, "signal-handoffs", TRUE, NULL);
+  gst_bin_add_many (GST_BIN (bin), *audiomixer, sink, NULL);
+  fail_unless (gst_element_link (*audiomixer, sink));
+
+  ck_assert_int_ne (gst_element_set_state (bin, GST_STATE_PAUSED),
+      GST_STATE_CHANGE_FAILURE);
+
+  return bin;
+}
+
+/* inputs with other channels than the output are remixed to it, with the
+ * default matrix or the mix-matrix of their pad */
+GST_START_TEST (test_remix)
+{
+  static const gint16 stereo[] = { 100, 200 };
+  static const gint16 mono[] = { 50 };
+  static const gfloat swap[] = { 0.0, 1.0, 1.0, 0.0 };
+  GstElement *bin, *audiomixer;
+  GstPad *sinkpad1, *sinkpad2, *queue_sinkpad1, *queue_sinkpad2;
+  GValueArray *matrix;
+  GValue v = { 0, };
+  GList *received_buffers, *l;
+  GstMapInfo map;
+  gint16 *data;
+  guint i;
+
+  bin = create_remix_pipeline (&audiomixer, 2);
+
+  /* the stereo input has its channels swapped, the mono one is played on
+   * both channels */
+  sinkpad1 = create_input (bin, audiomixer, &queue_sinkpad1);
+  sinkpad2 = create_input (bin, audiomixer, &queue_sinkpad2);
+  matrix = g_value_array_new (G_N_ELEMENTS (swap));
+  g_value_init (&v, G_TYPE_FLOAT);
+  for (i = 0; i < G_N_ELEMENTS (swap); i++) {
+    g_value_set_float (&v, swap[i]);
+    g_value_array_append (matrix, &v);
+  }
+  g_value_unset (&v);
+  g_object_set (sinkpad1, "mix-matrix", matrix, NULL);
+  g_value_array_free (matrix);
+
+  push_s16_input (queue_sinkpad1, 2, stereo);
+  push_s16_input (queue_sinkpad2, 1, mono);
+
+  received_buffers = run_and_collect_buffers (bin);
+
+  fail_unless_equals_int (g_list_length (received_buffers), 2);
+  for (l = received_buffers; l; l = l->next) {
+    gst_buffer_map (l->data, &map, GST_MAP_READ);
+    fail_unless_equals_int (map.size, 500 * 2 * sizeof (gint16));
+    data = (gint16 *) map.data;
+    for (i = 0; i < 500; i++) {
+      fail_unless_equals_int (data[2 * i], 250);
+      fail_unless_equals_int (data[2 * i + 1], 150);
+    }
+    gst_buffer_unmap (l->data, &map);
+  }
+  g_list_free_full (received_buffers, (GDestroyNotify) gst_buffer_unref);
+
+  gst_element_release_request_pad (audiomixer, sinkpad1);
+  gst_object_unref (sinkpad1);
+  gst_element_release_request_pad (audiomixer, sinkpad2);
+  gst_object_unref (sinkpad2);
+  gst_object_unref (bin);
+}
+
+GST_END_TEST;
+
+/* 5.1 is downmixed to stereo with the center and rear channels at -3dB and
+ * without the LFE */
+GST_START_TEST (test_remix_5_1)
+{
+  static const gint16 surround[] = { 1000, 2000, 300, 5000, 400, 800 };
+  GstElement *bin, *audiomixer;
+  GstPad *sinkpad, *queue_sinkpad;
+  GList *received_buffers, *l;
+  GstMapInfo map;
+  gint16 *data;
+  guint i;
+
+  bin = create_remix_pipeline (&audiomixer, 2);
+  sinkpad = create_input (bin, audiomixer, &queue_sinkpad);
+
+  push_s16_input (queue_sinkpad, 6, surround);
+
+  received_buffers = run_and_collect_buffers (bin);
+
+  fail_unless_equals_int (g_list_length (received_buffers), 2);
+  for (l = received_buffers; l; l = l->next) {
+    gst_buffer_map (l->data, &map, GST_MAP_READ);
+    fail_unless_equals_int (map.size, 500 * 2 * sizeof (gint16));
+    data = (gint16 *) map.data;
+    for (i = 0; i < 500; i++) {
+      /* 1000 + (300 + 400) / sqrt (2) and 2000 + (300 + 800) / sqrt (2) */
+      fail_unless_equals_int (data[2 * i], 1494);
+      fail_unless_equals_int (data[2 * i + 1], 2777);
+    }
+    gst_buffer_unmap (l->data, &map);
+  }
+  g_list_free_full (received_buffers, (GDestroyNotify) gst_buffer_unref);
+
+  gst_element_release_request_pad (audiomixer, sinkpad);
+  gst_object_unref (sinkpad);
+  gst_object_unref (bin);
+}
+
+GST_END_TEST;
+
+static void
+handoff_mute_cb (GstElement * fakesink, GstBuffer * buffer, GstPad * pad,
+    GstPad * mixer_pad)
+{
+  g_object_set (mixer_pad, "mute", TRUE, NULL);
+}
+
+/* muting a pad ramps its volume down instead of cutting it */
+GST_START_TEST (test_mute_ramp)
+{
+  static const gint16 mono[] = { 1000 };
+  GstElement *bin, *audiomixer, *sink;
+  GstPad *sinkpad, *queue_sinkpad;
+  GList *received_buffers;
+  GstMapInfo map;
+  gint16 *data;
+  gint i;
+
+  bin = create_remix_pipeline (&audiomixer, 1);
+  sinkpad = create_input (bin, audiomixer, &queue_sinkpad);
+
+  /* the second block is mixed after the first one was pushed */
+  sink = gst_bin_get_by_name (GST_BIN (bin), "sink");
+  g_signal_connect (sink, "handoff", (GCallback) handoff_mute_cb, sinkpad);
+  gst_object_unref (sink);
+
+  push_s16_input (queue_sinkpad, 1, mono);
+
+  received_buffers = run_and_collect_buffers (bin);
+  fail_unless_equals_int (g_list_length (received_buffers), 2);
+
+  gst_buffer_map (received_buffers->data, &map, GST_MAP_READ);
+  data = (gint16 *) map.data;
+  for (i = 0; i < 500; i++)
+    fail_unless_equals_int (data[i], 1000);
+  gst_buffer_unmap (received_buffers->data, &map);
+
+  /* a unit of volume is ramped over 10ms, 10 samples at 1000Hz */
+  gst_buffer_map (received_buffers->next->data, &map, GST_MAP_READ);
+  data = (gint16 *) map.data;
+  fail_unless (data[0] > 0 && data[0] < 1000);
+  for (i = 1; i < 10; i++)
+    fail_unless (data[i] < data[i - 1]);
+  for (i = 9; i < 500; i++)
+    fail_unless_equals_int (data[i], 0);
+  gst_buffer_unmap (received_buffers->next->data, &map);
+  g_list_free_full (received_buffers, (GDestroyNotify) gst_buffer_unref);
+
+  gst_element_release_request_pad (audiomixer, sinkpad);
+  gst_object_unref (sinkpad);
+  gst_object_unref (bin);
+}
+
+GST_END_TEST;
+
 static Suite *
 audiomixer_suite (void)
 {
@@ -1745,9 +2122,13 @@ audiomixer_suite (void)
   tcase_add_test (tc_chain, test_duration_unknown_overrides);
   tcase_add_test (tc_chain, test_loop);
   tcase_add_test (tc_chain, test_flush_start_flush_stop);
+  tcase_add_test (tc_chain, test_live_late_pad);
   tcase_add_test (tc_chain, test_sync);
   tcase_add_test (tc_chain, test_sync_discont);
   tcase_add_test (tc_chain, test_sync_unaligned);
+  tcase_add_test (tc_chain, test_remix);
+  tcase_add_test (tc_chain, test_remix_5_1);
+  tcase_add_test (tc_chain, test_mute_ramp);
 
   /* Use a longer timeout */
 #ifdef HAVE_VALGRIND
@@ -0,0 +1,455 @@
+/* GStreamer
+ *
+ * unit test for compare
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include <gst/check/gstcheck.h>
+#include <gst/check/gsttestclock.h>
+
+#define WIDTH 64
+#define HEIGHT 48
+#define FRAME_SIZE (WIDTH * HEIGHT)
+#define FRAME_DURATION (40 * GST_MSECOND)
+
+#define VIDEO_CAPS_STRING \
+    "video/x-raw, format = (string) GRAY8, width = (int) 64, " \
+    "height = (int) 48, framerate = (fraction) 25/1"
+
+static GstElement *compare;
+static GstPad *mysrcpad, *mycheckpad, *mysinkpad;
+static GstBus *bus;
+static GList *messages;
+
+static GstStaticPadTemplate sinktemplate = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS_ANY);
+
+static GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS (VIDEO_CAPS_STRING));
+
+static gboolean
+live_query_func (GstPad * pad, GstObject * parent, GstQuery * query)
+{
+  if (GST_QUERY_TYPE (query) == GST_QUERY_LATENCY) {
+    gst_query_set_latency (query, TRUE, 0, GST_CLOCK_TIME_NONE);
+    return TRUE;
+  }
+
+  return gst_pad_query_default (pad, parent, query);
+}
+
+static void
+setup_compare (const gchar * method, GstClock * clock)
+{
+  GstCaps *caps;
+
+  compare = gst_check_setup_element ("compare");
+  g_object_set (compare, "method", method, "post-messages", TRUE, NULL);
+  bus = gst_bus_new ();
+  gst_element_set_bus (compare, bus);
+  if (clock) {
+    gst_element_set_clock (compare, clock);
+    gst_element_set_base_time (compare, 0);
+    g_object_set (compare, "latency", 10 * GST_MSECOND, NULL);
+  }
+
+  mysrcpad = gst_check_setup_src_pad_by_name (compare, &srctemplate, "sink");
+  mycheckpad = gst_check_setup_src_pad_by_name (compare, &srctemplate,
+      "check");
+  mysinkpad = gst_check_setup_sink_pad (compare, &sinktemplate);
+  if (clock) {
+    gst_pad_set_query_function (mysrcpad, live_query_func);
+    gst_pad_set_query_function (mycheckpad, live_query_func);
+  }
+  gst_pad_set_active (mysrcpad, TRUE);
+  gst_pad_set_active (mycheckpad, TRUE);
+  gst_pad_set_active (mysinkpad, TRUE);
+
+  fail_unless (gst_element_set_state (compare,
+          GST_STATE_PLAYING) != GST_STATE_CHANGE_FAILURE);
+
+  caps = gst_caps_from_string (VIDEO_CAPS_STRING);
+  gst_check_setup_events_with_stream_id (mysrcpad, compare, caps,
+      GST_FORMAT_TIME, "compare-sink");
+  gst_check_setup_events_with_stream_id (mycheckpad, compare, caps,
+      GST_FORMAT_TIME, "compare-check");
+  gst_caps_unref (caps);
+}
+
+static void
+cleanup_compare (void)
+{
+  gst_check_drop_buffers ();
+
+  fail_unless (gst_element_set_state (compare,
+          GST_STATE_NULL) == GST_STATE_CHANGE_SUCCESS);
+  gst_pad_set_active (mysrcpad, FALSE);
+  gst_pad_set_active (mycheckpad, FALSE);
+  gst_pad_set_active (mysinkpad, FALSE);
+  gst_check_teardown_pad_by_name (compare, "check");
+  gst_check_teardown_src_pad (compare);
+  gst_check_teardown_sink_pad (compare);
+
+  gst_bus_set_flushing (bus, TRUE);
+  gst_element_set_bus (compare, NULL);
+  gst_object_unref (bus);
+  g_list_free_full (messages, (GDestroyNotify) gst_message_unref);
+  messages = NULL;
+  gst_check_teardown_element (compare);
+}
+
+static GstBuffer *
+create_frame (const guint8 * data, guint index)
+{
+  GstBuffer *buffer;
+
+  buffer = gst_buffer_new_and_alloc (FRAME_SIZE);
+  gst_buffer_fill (buffer, 0, data, FRAME_SIZE);
+  GST_BUFFER_PTS (buffer) = index * FRAME_DURATION;
+  GST_BUFFER_DURATION (buffer) = FRAME_DURATION;
+
+  return buffer;
+}
+
+/* Pushes the @index-th frame, filled with @value, on @pad */
+static void
+push_frame (GstPad * pad, guint8 value, guint index)
+{
+  guint8 data[FRAME_SIZE];
+
+  memset (data, value, FRAME_SIZE);
+  fail_unless_equals_int (gst_pad_push (pad, create_frame (data, index)),
+      GST_FLOW_OK);
+}
+
+static void
+wait_for_buffers (guint n)
+{
+  g_mutex_lock (&check_mutex);
+  while (g_list_length (buffers) < n)
+    g_cond_wait (&check_cond, &check_mutex);
+  g_mutex_unlock (&check_mutex);
+}
+
+/* Pops the first element message named @name, the messages with other
+ * names are kept for later */
+static GstMessage *
+pop_message (const gchar * name)
+{
+  GstMessage *msg;
+  GList *l;
+
+  while ((msg = gst_bus_pop_filtered (bus, GST_MESSAGE_ELEMENT)))
+    messages = g_list_append (messages, msg);
+
+  for (l = messages; l; l = l->next) {
+    msg = l->data;
+    if (gst_structure_has_name (gst_message_get_structure (msg), name)) {
+      messages = g_list_delete_link (messages, l);
+      return msg;
+    }
+  }
+
+  return NULL;
+}
+
+/* Pops the next "compare" message and checks its running time, returns its
+ * content */
+static gdouble
+pop_compare_message (GstClockTime running_time)
+{
+  const GstStructure *s;
+  GstMessage *msg;
+  guint64 msg_running_time;
+  gdouble content;
+
+  msg = pop_message ("compare");
+  fail_unless (msg != NULL);
+  s = gst_message_get_structure (msg);
+  fail_unless (gst_structure_get_uint64 (s, "running-time",
+          &msg_running_time));
+  fail_unless_equals_uint64 (msg_running_time, running_time);
+  fail_unless (gst_structure_get_double (s, "content", &content));
+  gst_message_unref (msg);
+
+  return content;
+}
+
+/* Counts the "delta" messages about missing buffers, and checks that they
+ * number them in order */
+static guint
+count_missing_messages (void)
+{
+  GstMessage *msg;
+  gint count, n = 0;
+
+  while ((msg = pop_message ("delta"))) {
+    if (gst_structure_get_int (gst_message_get_structure (msg), "count",
+            &count)) {
+      n++;
+      fail_unless_equals_int (count, n);
+    }
+    gst_message_unref (msg);
+  }
+
+  return n;
+}
+
+/* Two frames with smooth content and some deterministic noise */
+static void
+create_reference_frames (guint8 * data1, guint8 * data2)
+{
+  GRand *rand = g_rand_new_with_seed (1);
+  gint x, y;
+
+  for (y = 0; y < HEIGHT; y++) {
+    for (x = 0; x < WIDTH; x++) {
+      gint v = (x * 3 + y * 2 + g_rand_int_range (rand, 0, 16)) & 0xff;
+
+      data1[y * WIDTH + x] = v;
+      data2[y * WIDTH + x] = CLAMP (v + g_rand_int_range (rand, -12, 13), 0,
+          255);
+    }
+  }
+
+  g_rand_free (rand);
+}
+
+/* SSIM over 16x16 windows every 8 pixels, each window computed on its own */
+static gdouble
+reference_ssim (const guint8 * data1, const guint8 * data2)
+{
+  const gdouble c1 = (0.01 * 255) * (0.01 * 255);
+  const gdouble c2 = (0.03 * 255) * (0.03 * 255);
+  gdouble ssim = 0;
+  gint wx, wy, x, y, count = 0;
+
+  for (wy = 0; wy + 16 <= HEIGHT; wy += 8) {
+    for (wx = 0; wx + 16 <= WIDTH; wx += 8) {
+      gdouble sum1 = 0, sum2 = 0, ssum1 = 0, ssum2 = 0, cross = 0;
+      gdouble avg1, avg2, var1, var2, cov;
+
+      for (y = wy; y < wy + 16; y++) {
+        for (x = wx; x < wx + 16; x++) {
+          gdouble a = data1[y * WIDTH + x], b = data2[y * WIDTH + x];
+
+          sum1 += a;
+          sum2 += b;
+          ssum1 += a * a;
+          ssum2 += b * b;
+          cross += a * b;
+        }
+      }
+
+      avg1 = sum1 / 256;
+      avg2 = sum2 / 256;
+      var1 = ssum1 / 256 - avg1 * avg1;
+      var2 = ssum2 / 256 - avg2 * avg2;
+      cov = cross / 256 - avg1 * avg2;
+      ssim += (2 * avg1 * avg2 + c1) / (avg1 * avg1 + avg2 * avg2 + c1) *
+          (2 * cov + c2) / (var1 + var2 + c2);
+      count++;
+    }
+  }
+
+  return ssim / count;
+}
+
+static gdouble
+reference_psnr (const guint8 * data1, const guint8 * data2)
+{
+  guint64 sse = 0;
+  gint i;
+
+  for (i = 0; i < FRAME_SIZE; i++)
+    sse += (data1[i] - data2[i]) * (data1[i] - data2[i]);
+
+  return 10 * log10 (255.0 * 255.0 * FRAME_SIZE / sse);
+}
+
+static void
+check_metric (const gchar * method, gdouble expected)
+{
+  guint8 data1[FRAME_SIZE], data2[FRAME_SIZE];
+  gdouble content;
+
+  create_reference_frames (data1, data2);
+
+  setup_compare (method, NULL);
+  fail_unless_equals_int (gst_pad_push (mysrcpad, create_frame (data1, 0)),
+      GST_FLOW_OK);
+  fail_unless_equals_int (gst_pad_push (mycheckpad, create_frame (data2, 0)),
+      GST_FLOW_OK);
+  wait_for_buffers (1);
+
+  content = pop_compare_message (0);
+  GST_DEBUG ("%s %.17g, reference %.17g", method, content, expected);
+  fail_unless (fabs (content - expected) < 1e-12,
+      "%s of %.17g instead of %.17g", method, content, expected);
+
+  cleanup_compare ();
+}
+
+GST_START_TEST (test_ssim)
+{
+  guint8 data1[FRAME_SIZE], data2[FRAME_SIZE];
+
+  create_reference_frames (data1, data2);
+  check_metric ("ssim", reference_ssim (data1, data2));
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_psnr)
+{
+  guint8 data1[FRAME_SIZE], data2[FRAME_SIZE];
+
+  create_reference_frames (data1, data2);
+  check_metric ("psnr", reference_psnr (data1, data2));
+}
+
+GST_END_TEST;
+
+/* The buffers of the sink and check pads are compared in order, the output
+ * is the stream of the sink pad */
+GST_START_TEST (test_pairing)
+{
+  GstMapInfo map;
+  guint i;
+
+  setup_compare ("max", NULL);
+
+  for (i = 0; i < 3; i++) {
+    push_frame (mysrcpad, 10 * i, i);
+    push_frame (mycheckpad, i == 1 ? 15 : 10 * i, i);
+  }
+  wait_for_buffers (3);
+
+  fail_unless (pop_compare_message (0) == 0);
+  fail_unless (pop_compare_message (FRAME_DURATION) == 5);
+  fail_unless (pop_compare_message (2 * FRAME_DURATION) == 0);
+  fail_unless_equals_int (count_missing_messages (), 0);
+
+  for (i = 0; i < 3; i++) {
+    GstBuffer *buffer = g_list_nth_data (buffers, i);
+
+    fail_unless_equals_uint64 (GST_BUFFER_PTS (buffer), i * FRAME_DURATION);
+    fail_unless (gst_buffer_map (buffer, &map, GST_MAP_READ));
+    fail_unless_equals_int (map.data[0], 10 * i);
+    gst_buffer_unmap (buffer, &map);
+  }
+
+  cleanup_compare ();
+}
+
+GST_END_TEST;
+
+/* A buffer waiting on a pad is compared with the caps it came with, not
+ * with those of a caps event queued after it */
+GST_START_TEST (test_queued_caps)
+{
+  GstCaps *caps;
+
+  setup_compare ("ssim", NULL);
+
+  push_frame (mysrcpad, 100, 0);
+  caps = gst_caps_from_string ("video/x-raw, format = (string) GRAY8, "
+      "width = (int) 32, height = (int) 48, framerate = (fraction) 25/1");
+  fail_unless (gst_pad_push_event (mysrcpad, gst_event_new_caps (caps)));
+  gst_caps_unref (caps);
+
+  push_frame (mycheckpad, 100, 0);
+  wait_for_buffers (1);
+
+  fail_unless (pop_compare_message (0) == 1.0);
+
+  cleanup_compare ();
+}
+
+GST_END_TEST;
+
+/* A check buffer missing the live deadline is counted as missing, and is not
+ * compared to the next sink buffer when it arrives after all */
+GST_START_TEST (test_live_late_check)
+{
+  GstClock *clock;
+  GstClockID id;
+  GstQuery *query;
+
+  clock = gst_test_clock_new ();
+  setup_compare ("max", clock);
+
+  /* paired before the element knows upstream is live */
+  push_frame (mysrcpad, 0, 0);
+  push_frame (mycheckpad, 0, 0);
+  wait_for_buffers (1);
+
+  query = gst_query_new_latency ();
+  fail_unless (gst_pad_peer_query (mysinkpad, query));
+  gst_query_unref (query);
+
+  /* the check buffer for the second frame misses its deadline, at 50 ms */
+  push_frame (mysrcpad, 1, 1);
+  gst_test_clock_wait_for_next_pending_id (GST_TEST_CLOCK (clock), &id);
+  fail_unless_equals_uint64 (gst_clock_id_get_time (id),
+      FRAME_DURATION + 10 * GST_MSECOND);
+  gst_clock_id_unref (id);
+  gst_test_clock_set_time (GST_TEST_CLOCK (clock), 60 * GST_MSECOND);
+  gst_test_clock_process_next_clock_id (GST_TEST_CLOCK (clock));
+  wait_for_buffers (2);
+
+  /* it is skipped when it arrives, the next frames are paired again */
+  push_frame (mycheckpad, 1, 1);
+  push_frame (mysrcpad, 2, 2);
+  push_frame (mycheckpad, 2, 2);
+  wait_for_buffers (3);
+
+  fail_unless (pop_compare_message (0) == 0);
+  fail_unless (pop_compare_message (2 * FRAME_DURATION) == 0);
+  fail_unless (pop_message ("compare") == NULL);
+  fail_unless_equals_int (count_missing_messages (), 2);
+
+  cleanup_compare ();
+  gst_object_unref (clock);
+}
+
+GST_END_TEST;
+
+static Suite *
+compare_suite (void)
+{
+  Suite *s = suite_create ("compare");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_ssim);
+  tcase_add_test (tc_chain, test_psnr);
+  tcase_add_test (tc_chain, test_pairing);
+  tcase_add_test (tc_chain, test_queued_caps);
+  tcase_add_test (tc_chain, test_live_late_check);
+
+  return s;
+}
+
+GST_CHECK_MAIN (compare);
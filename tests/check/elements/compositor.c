@@ -30,6 +30,7 @@
 #endif
 
 #include <unistd.h>
+#include <string.h>
 
 #include <gst/check/gstcheck.h>
 #include <gst/check/gstconsistencychecker.h>
@@ -83,6 +84,306 @@ GST_START_TEST (test_caps)
 
 GST_END_TEST;
 
+/* the output is sized after the scaled input */
+GST_START_TEST (test_scale)
+{
+  GstElement *pipeline, *src, *capsfilter, *compositor, *outfilter, *sink;
+  GstStateChangeReturn state_res;
+  GstStructure *s;
+  GstSample *sample;
+  GstMapInfo map;
+  GstCaps *caps;
+  GstPad *pad;
+  gint width, height, i;
+
+  pipeline = gst_pipeline_new ("pipeline");
+
+  src = gst_element_factory_make ("videotestsrc", "src1");
+  capsfilter = gst_element_factory_make ("capsfilter", "capsfilter");
+  compositor = gst_element_factory_make ("compositor", "compositor");
+  outfilter = gst_element_factory_make ("capsfilter", "outfilter");
+  sink = gst_element_factory_make ("fakesink", "sink");
+  gst_bin_add_many (GST_BIN (pipeline), src, capsfilter, compositor, outfilter,
+      sink, NULL);
+
+  /* a plain white input, it only covers the whole output once scaled */
+  gst_util_set_object_arg (G_OBJECT (src), "pattern", "white");
+
+  caps = gst_caps_from_string (VIDEO_CAPS_STRING);
+  g_object_set (capsfilter, "caps", caps, NULL);
+  gst_caps_unref (caps);
+
+  caps = gst_caps_from_string ("video/x-raw, format = (string) I420");
+  g_object_set (outfilter, "caps", caps, NULL);
+  gst_caps_unref (caps);
+
+  fail_unless (gst_element_link_many (src, capsfilter, compositor, outfilter,
+          sink, NULL));
+
+  pad = gst_element_get_static_pad (compositor, "sink_0");
+  fail_unless (pad != NULL);
+  g_object_set (pad, "width", 640, "height", 360, NULL);
+  gst_object_unref (pad);
+
+  state_res = gst_element_set_state (pipeline, GST_STATE_PAUSED);
+  fail_unless_equals_int (state_res, GST_STATE_CHANGE_ASYNC);
+
+  state_res = gst_element_get_state (pipeline, NULL, NULL, GST_CLOCK_TIME_NONE);
+  fail_unless_equals_int (state_res, GST_STATE_CHANGE_SUCCESS);
+
+  pad = gst_element_get_static_pad (sink, "sink");
+  caps = gst_pad_get_current_caps (pad);
+  fail_unless (caps != NULL);
+  s = gst_caps_get_structure (caps, 0);
+  fail_unless (gst_structure_get_int (s, "width", &width));
+  fail_unless (gst_structure_get_int (s, "height", &height));
+  fail_unless_equals_int (width, 640);
+  fail_unless_equals_int (height, 360);
+  gst_caps_unref (caps);
+  gst_object_unref (pad);
+
+  /* the luma plane comes first in I420, with no padding at this width,
+   * and is white all over instead of having black borders */
+  g_object_get (sink, "last-sample", &sample, NULL);
+  fail_unless (sample != NULL);
+  fail_unless (gst_buffer_map (gst_sample_get_buffer (sample), &map,
+          GST_MAP_READ));
+  fail_unless (map.size >= 640 * 360);
+  for (i = 0; i < 640 * 360; i++) {
+    if (ABS (map.data[i] - 235) > 1)
+      break;
+  }
+  fail_unless (i == 640 * 360, "luma %u at %d,%d", map.data[i], i % 640,
+      i / 640);
+  gst_buffer_unmap (gst_sample_get_buffer (sample), &map);
+  gst_sample_unref (sample);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (pipeline);
+}
+
+GST_END_TEST;
+
+static void
+handoff_last_buffer_cb (GstElement * fakesink, GstBuffer * buffer,
+    GstPad * pad, GstBuffer ** last)
+{
+  gst_buffer_replace (last, buffer);
+}
+
+/* composites I420 inputs straddling the band edges and returns the last
+ * output frame */
+static GstBuffer *
+_composite_i420 (guint n_threads)
+{
+  GstElement *pipeline, *compositor, *sink;
+  GstBuffer *last = NULL;
+  GstMessage *msg;
+  GstBus *bus;
+  GstPad *pad;
+
+  pipeline = gst_parse_launch ("videotestsrc num-buffers=3 pattern=smpte ! "
+      "video/x-raw,format=I420,width=320,height=240 ! "
+      "compositor name=comp ! video/x-raw,format=I420 ! "
+      "fakesink name=sink signal-handoffs=true "
+      "videotestsrc num-buffers=3 pattern=ball ! "
+      "video/x-raw,format=I420,width=80,height=100 ! comp. "
+      "videotestsrc num-buffers=3 pattern=colors ! "
+      "video/x-raw,format=I420,width=120,height=120 ! comp. "
+      "videotestsrc num-buffers=3 pattern=checkers-8 ! "
+      "video/x-raw,format=I420,width=64,height=90 ! comp.", NULL);
+  fail_unless (pipeline != NULL);
+
+  compositor = gst_bin_get_by_name (GST_BIN (pipeline), "comp");
+  g_object_set (compositor, "n-threads", n_threads, NULL);
+
+  /* across the first band edge, blended */
+  pad = gst_element_get_static_pad (compositor, "sink_1");
+  g_object_set (pad, "xpos", 30, "ypos", 50, "alpha", 0.6, NULL);
+  gst_object_unref (pad);
+  /* above the top left corner, copied */
+  pad = gst_element_get_static_pad (compositor, "sink_2");
+  g_object_set (pad, "xpos", -10, "ypos", -20, NULL);
+  gst_object_unref (pad);
+  /* across the last band edge and below the bottom */
+  pad = gst_element_get_static_pad (compositor, "sink_3");
+  g_object_set (pad, "xpos", 200, "ypos", 170, "alpha", 0.3, NULL);
+  gst_object_unref (pad);
+  gst_object_unref (compositor);
+
+  sink = gst_bin_get_by_name (GST_BIN (pipeline), "sink");
+  g_signal_connect (sink, "handoff", G_CALLBACK (handoff_last_buffer_cb),
+      &last);
+  gst_object_unref (sink);
+
+  bus = gst_element_get_bus (pipeline);
+  fail_unless_equals_int (gst_element_set_state (pipeline, GST_STATE_PLAYING),
+      GST_STATE_CHANGE_ASYNC);
+  msg = gst_bus_timed_pop_filtered (bus, GST_CLOCK_TIME_NONE,
+      GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  fail_unless_equals_int (GST_MESSAGE_TYPE (msg), GST_MESSAGE_EOS);
+  gst_message_unref (msg);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (bus);
+  gst_object_unref (pipeline);
+
+  fail_unless (last != NULL);
+  return last;
+}
+
+/* blending in bands gives the same frame as blending it whole */
+GST_START_TEST (test_bands)
+{
+  GstBuffer *whole, *banded;
+  GstMapInfo whole_map, banded_map;
+
+  whole = _composite_i420 (1);
+  banded = _composite_i420 (4);
+
+  fail_unless (gst_buffer_map (whole, &whole_map, GST_MAP_READ));
+  fail_unless (gst_buffer_map (banded, &banded_map, GST_MAP_READ));
+  fail_unless_equals_int (whole_map.size, banded_map.size);
+  fail_unless (memcmp (whole_map.data, banded_map.data, whole_map.size) == 0);
+  gst_buffer_unmap (whole, &whole_map);
+  gst_buffer_unmap (banded, &banded_map);
+
+  gst_buffer_unref (whole);
+  gst_buffer_unref (banded);
+}
+
+GST_END_TEST;
+
+/* the converted frames are taken from a pool, and allocated only once */
+GST_START_TEST (test_conversion_allocations)
+{
+  GstElement *pipeline, *compositor;
+  GstMessage *msg;
+  GstBus *bus;
+  GstPad *pad;
+  guint64 pool_allocations, buffer_allocations;
+
+  pipeline = gst_parse_launch ("videotestsrc num-buffers=20 ! "
+      "video/x-raw,format=I420,width=320,height=240 ! compositor name=comp "
+      "! fakesink videotestsrc num-buffers=20 ! "
+      "video/x-raw,format=AYUV,width=320,height=240 ! comp.", NULL);
+  fail_unless (pipeline != NULL);
+
+  bus = gst_element_get_bus (pipeline);
+  fail_unless_equals_int (gst_element_set_state (pipeline, GST_STATE_PLAYING),
+      GST_STATE_CHANGE_ASYNC);
+  msg = gst_bus_timed_pop_filtered (bus, GST_CLOCK_TIME_NONE,
+      GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  fail_unless_equals_int (GST_MESSAGE_TYPE (msg), GST_MESSAGE_EOS);
+  gst_message_unref (msg);
+
+  /* the I420 input is converted to AYUV */
+  compositor = gst_bin_get_by_name (GST_BIN (pipeline), "comp");
+  pad = gst_element_get_static_pad (compositor, "sink_0");
+  g_object_get (pad, "pool-allocations", &pool_allocations,
+      "buffer-allocations", &buffer_allocations, NULL);
+  fail_unless_equals_uint64 (pool_allocations, 1);
+  fail_unless_equals_uint64 (buffer_allocations, 1);
+  gst_object_unref (pad);
+
+  pad = gst_element_get_static_pad (compositor, "sink_1");
+  g_object_get (pad, "pool-allocations", &pool_allocations,
+      "buffer-allocations", &buffer_allocations, NULL);
+  fail_unless_equals_uint64 (pool_allocations, 0);
+  fail_unless_equals_uint64 (buffer_allocations, 0);
+  gst_object_unref (pad);
+  gst_object_unref (compositor);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (bus);
+  gst_object_unref (pipeline);
+}
+
+GST_END_TEST;
+
+/* composites inputs that all need to be converted to AYUV and returns the
+ * last output frame */
+static GstBuffer *
+_composite_converted (guint conversion_threads)
+{
+  GstElement *pipeline, *compositor, *sink;
+  GstBuffer *last = NULL;
+  GstMessage *msg;
+  GstBus *bus;
+  GstPad *pad;
+
+  pipeline = gst_parse_launch ("videotestsrc num-buffers=3 pattern=smpte ! "
+      "video/x-raw,format=I420,width=320,height=240 ! "
+      "compositor name=comp ! video/x-raw,format=AYUV ! "
+      "fakesink name=sink signal-handoffs=true "
+      "videotestsrc num-buffers=3 pattern=ball ! "
+      "video/x-raw,format=NV12,width=160,height=120 ! comp. "
+      "videotestsrc num-buffers=3 pattern=colors ! "
+      "video/x-raw,format=BGRA,width=120,height=100 ! comp.", NULL);
+  fail_unless (pipeline != NULL);
+
+  compositor = gst_bin_get_by_name (GST_BIN (pipeline), "comp");
+  g_object_set (compositor, "conversion-threads", conversion_threads,
+      "n-threads", 1, NULL);
+
+  pad = gst_element_get_static_pad (compositor, "sink_1");
+  g_object_set (pad, "xpos", 30, "ypos", 50, "alpha", 0.6, NULL);
+  gst_object_unref (pad);
+  pad = gst_element_get_static_pad (compositor, "sink_2");
+  g_object_set (pad, "xpos", 180, "ypos", 100, NULL);
+  gst_object_unref (pad);
+  gst_object_unref (compositor);
+
+  sink = gst_bin_get_by_name (GST_BIN (pipeline), "sink");
+  g_signal_connect (sink, "handoff", G_CALLBACK (handoff_last_buffer_cb),
+      &last);
+  gst_object_unref (sink);
+
+  bus = gst_element_get_bus (pipeline);
+  fail_unless_equals_int (gst_element_set_state (pipeline, GST_STATE_PLAYING),
+      GST_STATE_CHANGE_ASYNC);
+  msg = gst_bus_timed_pop_filtered (bus, GST_CLOCK_TIME_NONE,
+      GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  fail_unless_equals_int (GST_MESSAGE_TYPE (msg), GST_MESSAGE_EOS);
+  gst_message_unref (msg);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (bus);
+  gst_object_unref (pipeline);
+
+  fail_unless (last != NULL);
+  return last;
+}
+
+/* converting the pads in parallel, and each of them in slices, gives the
+ * same frame as converting them one after the other */
+GST_START_TEST (test_conversion_threads)
+{
+  GstBuffer *serial, *parallel;
+  GstMapInfo serial_map, parallel_map;
+  guint n_threads[] = { 0, 2, 8 };
+  guint i;
+
+  serial = _composite_converted (1);
+  fail_unless (gst_buffer_map (serial, &serial_map, GST_MAP_READ));
+
+  for (i = 0; i < G_N_ELEMENTS (n_threads); i++) {
+    parallel = _composite_converted (n_threads[i]);
+    fail_unless (gst_buffer_map (parallel, &parallel_map, GST_MAP_READ));
+    fail_unless_equals_int (serial_map.size, parallel_map.size);
+    fail_unless (memcmp (serial_map.data, parallel_map.data,
+            serial_map.size) == 0, "output differs with %u threads",
+        n_threads[i]);
+    gst_buffer_unmap (parallel, &parallel_map);
+    gst_buffer_unref (parallel);
+  }
+
+  gst_buffer_unmap (serial, &serial_map);
+  gst_buffer_unref (serial);
+}
+
+GST_END_TEST;
+
 static void
 message_received (GstBus * bus, GstMessage * message, GstPipeline * bin)
 {
@@ -1036,6 +1337,76 @@ GST_START_TEST (test_flush_start_flush_stop)
 GST_END_TEST;
 
 
+static void
+handoff_count_cb (GstElement * fakesink, GstBuffer * buffer, GstPad * pad,
+    gint * count)
+{
+  g_atomic_int_inc (count);
+}
+
+/* a live input missing its deadline does not end the stream, its last frame
+ * is shown again and the output carries on */
+GST_START_TEST (test_live_late_pad)
+{
+  GstElement *pipeline, *src, *sink;
+  GstStateChangeReturn state_res;
+  GstFlowReturn flow;
+  GstMessage *msg;
+  GstBuffer *buf;
+  GstMapInfo map;
+  GstBus *bus;
+  gint count = 0;
+  gboolean late = FALSE;
+
+  pipeline = gst_parse_launch ("appsrc name=src is-live=true format=time "
+      "caps=video/x-raw,format=I420,width=320,height=240,framerate=25/1 ! "
+      "compositor ! fakesink name=sink signal-handoffs=true", NULL);
+  fail_unless (pipeline != NULL);
+
+  sink = gst_bin_get_by_name (GST_BIN (pipeline), "sink");
+  g_signal_connect (sink, "handoff", G_CALLBACK (handoff_count_cb), &count);
+  gst_object_unref (sink);
+
+  bus = gst_element_get_bus (pipeline);
+  state_res = gst_element_set_state (pipeline, GST_STATE_PLAYING);
+  fail_if (state_res == GST_STATE_CHANGE_FAILURE);
+
+  /* a single frame, then nothing until well after the next deadlines */
+  src = gst_bin_get_by_name (GST_BIN (pipeline), "src");
+  buf = gst_buffer_new_allocate (NULL, 320 * 240 * 3 / 2, NULL);
+  gst_buffer_map (buf, &map, GST_MAP_WRITE);
+  memset (map.data, 0x80, map.size);
+  gst_buffer_unmap (buf, &map);
+  GST_BUFFER_PTS (buf) = 0;
+  GST_BUFFER_DURATION (buf) = 40 * GST_MSECOND;
+  g_signal_emit_by_name (src, "push-buffer", buf, &flow);
+  fail_unless_equals_int (flow, GST_FLOW_OK);
+  gst_buffer_unref (buf);
+
+  while (!late || g_atomic_int_get (&count) < 5) {
+    msg = gst_bus_timed_pop_filtered (bus, 5 * GST_SECOND,
+        GST_MESSAGE_ELEMENT | GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+    fail_unless (msg != NULL);
+    fail_unless_equals_int (GST_MESSAGE_TYPE (msg), GST_MESSAGE_ELEMENT);
+    if (gst_message_has_name (msg, "GstAggregatorPadLate"))
+      late = TRUE;
+    gst_message_unref (msg);
+  }
+
+  g_signal_emit_by_name (src, "end-of-stream", &flow);
+  gst_object_unref (src);
+  msg = gst_bus_timed_pop_filtered (bus, GST_CLOCK_TIME_NONE,
+      GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  fail_unless_equals_int (GST_MESSAGE_TYPE (msg), GST_MESSAGE_EOS);
+  gst_message_unref (msg);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (bus);
+  gst_object_unref (pipeline);
+}
+
+GST_END_TEST;
+
 static Suite *
 compositor_suite (void)
 {
@@ -1044,6 +1415,10 @@ compositor_suite (void)
 
   suite_add_tcase (s, tc_chain);
   tcase_add_test (tc_chain, test_caps);
+  tcase_add_test (tc_chain, test_scale);
+  tcase_add_test (tc_chain, test_bands);
+  tcase_add_test (tc_chain, test_conversion_allocations);
+  tcase_add_test (tc_chain, test_conversion_threads);
   tcase_add_test (tc_chain, test_event);
   tcase_add_test (tc_chain, test_play_twice);
   tcase_add_test (tc_chain, test_play_twice_then_add_and_play_again);
@@ -1054,6 +1429,7 @@ compositor_suite (void)
   tcase_add_test (tc_chain, test_duration_unknown_overrides);
   tcase_add_test (tc_chain, test_loop);
   tcase_add_test (tc_chain, test_flush_start_flush_stop);
+  tcase_add_test (tc_chain, test_live_late_pad);
 
   /* Use a longer timeout */
 #ifdef HAVE_VALGRIND
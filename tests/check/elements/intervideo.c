@@ -0,0 +1,322 @@
+/* GStreamer
+ *
+ * unit test for intervideosink and intervideosrc
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <string.h>
+
+#include <gst/check/gstcheck.h>
+#include <gst/check/gsttestclock.h>
+
+#define VIDEO_CAPS_STRING \
+    "video/x-raw, format = (string) I420, width = (int) 64, " \
+    "height = (int) 48, framerate = (fraction) 25/1"
+#define FRAME_SIZE (64 * 48 * 3 / 2)
+#define FRAME_DURATION (GST_SECOND / 25)
+
+static GstStaticPadTemplate sinktemplate = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS (VIDEO_CAPS_STRING));
+
+static GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS (VIDEO_CAPS_STRING));
+
+/* An intervideosrc whose output is let through one buffer at a time, so
+ * that each buffer is created after the frames pushed before the step */
+typedef struct
+{
+  GstElement *src;
+  GstPad *sinkpad;
+
+  GMutex lock;
+  GCond cond;
+  guint received;
+  guint8 value;
+  gboolean go;
+  gboolean stopping;
+} SrcData;
+
+static GstFlowReturn
+src_data_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+{
+  SrcData *data = gst_pad_get_element_private (pad);
+  gboolean stopping;
+
+  g_mutex_lock (&data->lock);
+  gst_buffer_extract (buffer, 0, &data->value, 1);
+  data->received++;
+  g_cond_broadcast (&data->cond);
+  while (!data->go && !data->stopping)
+    g_cond_wait (&data->cond, &data->lock);
+  data->go = FALSE;
+  stopping = data->stopping;
+  g_mutex_unlock (&data->lock);
+
+  gst_buffer_unref (buffer);
+
+  return stopping ? GST_FLOW_FLUSHING : GST_FLOW_OK;
+}
+
+static void
+src_data_init (SrcData * data, const gchar * channel, GstClock * clock)
+{
+  memset (data, 0, sizeof (SrcData));
+  g_mutex_init (&data->lock);
+  g_cond_init (&data->cond);
+
+  data->src = gst_check_setup_element ("intervideosrc");
+  g_object_set (data->src, "channel", channel, NULL);
+  if (clock) {
+    gst_element_set_clock (data->src, clock);
+    gst_element_set_base_time (data->src, 0);
+  }
+
+  data->sinkpad = gst_check_setup_sink_pad (data->src, &sinktemplate);
+  gst_pad_set_element_private (data->sinkpad, data);
+  gst_pad_set_chain_function (data->sinkpad, src_data_chain);
+  gst_pad_set_active (data->sinkpad, TRUE);
+
+  fail_unless (gst_element_set_state (data->src,
+          GST_STATE_PLAYING) != GST_STATE_CHANGE_FAILURE);
+
+  /* the first buffer is created before any frame was pushed */
+  g_mutex_lock (&data->lock);
+  while (data->received == 0)
+    g_cond_wait (&data->cond, &data->lock);
+  g_mutex_unlock (&data->lock);
+}
+
+/* Lets one buffer through and returns the value of the first byte of the
+ * next one */
+static guint8
+src_data_step (SrcData * data)
+{
+  guint received;
+  guint8 value;
+
+  g_mutex_lock (&data->lock);
+  received = data->received;
+  data->go = TRUE;
+  g_cond_broadcast (&data->cond);
+  while (data->received == received)
+    g_cond_wait (&data->cond, &data->lock);
+  value = data->value;
+  g_mutex_unlock (&data->lock);
+
+  return value;
+}
+
+static void
+src_data_get_counters (SrcData * data, guint64 expected_drop,
+    guint64 expected_duplicate)
+{
+  guint64 drop, duplicate;
+
+  g_object_get (data->src, "drop", &drop, "duplicate", &duplicate, NULL);
+  fail_unless_equals_uint64 (drop, expected_drop);
+  fail_unless_equals_uint64 (duplicate, expected_duplicate);
+}
+
+static void
+src_data_clear (SrcData * data)
+{
+  g_mutex_lock (&data->lock);
+  data->stopping = TRUE;
+  g_cond_broadcast (&data->cond);
+  g_mutex_unlock (&data->lock);
+
+  fail_unless (gst_element_set_state (data->src,
+          GST_STATE_NULL) == GST_STATE_CHANGE_SUCCESS);
+  gst_pad_set_active (data->sinkpad, FALSE);
+  gst_check_teardown_sink_pad (data->src);
+  gst_check_teardown_element (data->src);
+
+  g_mutex_clear (&data->lock);
+  g_cond_clear (&data->cond);
+}
+
+static GstElement *
+setup_intervideosink (const gchar * channel, gint ring_size, GstClock * clock,
+    GstPad ** srcpad)
+{
+  GstElement *sink;
+  GstCaps *caps;
+
+  sink = gst_check_setup_element ("intervideosink");
+  g_object_set (sink, "channel", channel, "ring-size", ring_size,
+      "sync", FALSE, NULL);
+  if (clock) {
+    gst_element_set_clock (sink, clock);
+    gst_element_set_base_time (sink, 0);
+  }
+
+  *srcpad = gst_check_setup_src_pad (sink, &srctemplate);
+  gst_pad_set_active (*srcpad, TRUE);
+
+  fail_unless (gst_element_set_state (sink,
+          GST_STATE_PLAYING) != GST_STATE_CHANGE_FAILURE);
+
+  caps = gst_caps_from_string (VIDEO_CAPS_STRING);
+  gst_check_setup_events (*srcpad, sink, caps, GST_FORMAT_TIME);
+  gst_caps_unref (caps);
+
+  return sink;
+}
+
+static void
+cleanup_intervideosink (GstElement * sink, GstPad * srcpad)
+{
+  fail_unless (gst_element_set_state (sink,
+          GST_STATE_NULL) == GST_STATE_CHANGE_SUCCESS);
+  gst_pad_set_active (srcpad, FALSE);
+  gst_check_teardown_src_pad (sink);
+  gst_check_teardown_element (sink);
+}
+
+/* Pushes a frame filled with @value, shown at @index frames */
+static void
+push_frame (GstPad * srcpad, guint8 value, guint index)
+{
+  GstBuffer *buffer;
+
+  buffer = gst_buffer_new_and_alloc (FRAME_SIZE);
+  gst_buffer_memset (buffer, 0, value, FRAME_SIZE);
+  GST_BUFFER_PTS (buffer) = index * FRAME_DURATION;
+  GST_BUFFER_DURATION (buffer) = FRAME_DURATION;
+  fail_unless_equals_int (gst_pad_push (srcpad, buffer), GST_FLOW_OK);
+}
+
+GST_START_TEST (test_pick_by_time)
+{
+  GstElement *sink;
+  GstPad *srcpad;
+  GstClock *clock;
+  SrcData data;
+  guint i;
+
+  /* far ahead of all the timestamps, nothing waits on it */
+  clock = gst_test_clock_new_with_start_time (10 * GST_SECOND);
+
+  sink = setup_intervideosink ("test_pick_by_time", 4, clock, &srcpad);
+  src_data_init (&data, "test_pick_by_time", clock);
+
+  /* The source picks the last frame shown before the middle of each of its
+   * frames, the first one it created (frame 0) is already out */
+  for (i = 0; i < 4; i++)
+    push_frame (srcpad, 100 + i, i);
+  fail_unless_equals_int (src_data_step (&data), 101);
+  fail_unless_equals_int (src_data_step (&data), 102);
+  fail_unless_equals_int (src_data_step (&data), 103);
+  src_data_get_counters (&data, 0, 0);
+
+  /* no newer frame, the last one is repeated */
+  fail_unless_equals_int (src_data_step (&data), 103);
+  src_data_get_counters (&data, 0, 1);
+
+  /* frame 4 is overtaken by frame 5 before the source gets to it */
+  for (i = 4; i < 8; i++)
+    push_frame (srcpad, 100 + i, i);
+  fail_unless_equals_int (src_data_step (&data), 105);
+  src_data_get_counters (&data, 1, 1);
+  fail_unless_equals_int (src_data_step (&data), 106);
+  fail_unless_equals_int (src_data_step (&data), 107);
+  src_data_get_counters (&data, 1, 1);
+
+  src_data_clear (&data);
+  cleanup_intervideosink (sink, srcpad);
+  gst_object_unref (clock);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_pick_without_clock)
+{
+  GstElement *sink;
+  GstPad *srcpad;
+  SrcData data;
+
+  sink = setup_intervideosink ("test_pick_without_clock", 4, NULL, &srcpad);
+  src_data_init (&data, "test_pick_without_clock", NULL);
+
+  /* Without times, the newest frame is picked */
+  push_frame (srcpad, 100, 0);
+  push_frame (srcpad, 101, 1);
+  fail_unless_equals_int (src_data_step (&data), 101);
+  src_data_get_counters (&data, 0, 0);
+
+  push_frame (srcpad, 102, 2);
+  push_frame (srcpad, 103, 3);
+  push_frame (srcpad, 104, 4);
+  fail_unless_equals_int (src_data_step (&data), 104);
+  src_data_get_counters (&data, 2, 0);
+
+  fail_unless_equals_int (src_data_step (&data), 104);
+  fail_unless_equals_int (src_data_step (&data), 104);
+  src_data_get_counters (&data, 2, 2);
+
+  src_data_clear (&data);
+  cleanup_intervideosink (sink, srcpad);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_two_sources)
+{
+  GstElement *sink;
+  GstPad *srcpad;
+  SrcData data1, data2;
+  guint i;
+
+  sink = setup_intervideosink ("test_two_sources", 2, NULL, &srcpad);
+  src_data_init (&data1, "test_two_sources", NULL);
+  src_data_init (&data2, "test_two_sources", NULL);
+
+  /* Reading the ring does not take the frames away from the other source */
+  for (i = 0; i < 10; i++) {
+    push_frame (srcpad, 100 + i, i);
+    fail_unless_equals_int (src_data_step (&data1), 100 + i);
+    fail_unless_equals_int (src_data_step (&data2), 100 + i);
+  }
+  src_data_get_counters (&data1, 0, 0);
+  src_data_get_counters (&data2, 0, 0);
+
+  src_data_clear (&data1);
+  src_data_clear (&data2);
+  cleanup_intervideosink (sink, srcpad);
+}
+
+GST_END_TEST;
+
+static Suite *
+intervideo_suite (void)
+{
+  Suite *s = suite_create ("intervideo");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_pick_by_time);
+  tcase_add_test (tc_chain, test_pick_without_clock);
+  tcase_add_test (tc_chain, test_two_sources);
+
+  return s;
+}
+
+GST_CHECK_MAIN (intervideo);
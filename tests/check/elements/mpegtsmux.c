@@ -716,6 +716,372 @@ GST_START_TEST (test_multiple_state_change)
 
 GST_END_TEST;
 
+GST_START_TEST (test_aligned_output)
+{
+  GstElement *mux;
+  gchar *padname;
+  GstBuffer *inbuffer;
+  GstCaps *caps;
+  GList *l;
+  gint i;
+
+  mux = setup_tsmux (&video_src_template, "sink_%d", &padname);
+  g_object_set (mux, "alignment", 7, NULL);
+
+  fail_unless (gst_element_set_state (mux,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+
+  caps = gst_caps_from_string (VIDEO_CAPS_STRING);
+  gst_check_setup_events (mysrcpad, mux, caps, GST_FORMAT_TIME);
+  gst_caps_unref (caps);
+
+  for (i = 0; i < 10; i++) {
+    inbuffer = gst_buffer_new_and_alloc (3000);
+    gst_buffer_memset (inbuffer, 0, 0, 3000);
+    GST_BUFFER_PTS (inbuffer) = i * 40 * GST_MSECOND;
+    fail_unless (gst_pad_push (mysrcpad, inbuffer) == GST_FLOW_OK);
+  }
+  fail_unless (gst_pad_push_event (mysrcpad, gst_event_new_eos ()));
+
+  fail_unless (buffers != NULL);
+  for (l = buffers; l; l = l->next) {
+    GstBuffer *outbuffer = l->data;
+    GstMapInfo map;
+    gsize offset;
+
+    /* the last buffer is padded with null packets */
+    fail_unless_equals_int (gst_buffer_get_size (outbuffer), 7 * 188);
+
+    gst_buffer_map (outbuffer, &map, GST_MAP_READ);
+    for (offset = 0; offset < map.size; offset += 188)
+      fail_unless_equals_int (map.data[offset], 0x47);
+    gst_buffer_unmap (outbuffer, &map);
+  }
+  gst_check_drop_buffers ();
+
+  cleanup_tsmux (mux, padname);
+  g_free (padname);
+}
+
+GST_END_TEST;
+
+#define CBR_BITRATE 2000000
+
+typedef struct
+{
+  guint64 offset;
+  guint64 pcr;
+  gboolean discont;
+} PcrInfo;
+
+/* Collects the PCRs of the output with their byte offset, and checks that
+ * the buffers are timestamped by their position in the output */
+static GArray *
+collect_pcrs (guint64 bitrate, guint * null_packets)
+{
+  GArray *pcrs = g_array_new (FALSE, FALSE, sizeof (PcrInfo));
+  GstClockTime first_pts = GST_CLOCK_TIME_NONE;
+  guint64 offset = 0;
+  GList *l;
+
+  *null_packets = 0;
+
+  for (l = buffers; l; l = l->next) {
+    GstBuffer *outbuffer = l->data;
+    GstMapInfo map;
+    gsize pos;
+
+    fail_unless (GST_BUFFER_PTS_IS_VALID (outbuffer));
+    if (!GST_CLOCK_TIME_IS_VALID (first_pts))
+      first_pts = GST_BUFFER_PTS (outbuffer);
+    fail_unless (ABS ((gint64) (GST_BUFFER_PTS (outbuffer) - first_pts) -
+            (gint64) gst_util_uint64_scale (offset * 8, GST_SECOND,
+                bitrate)) <= 188 * 8 * GST_SECOND / bitrate);
+
+    gst_buffer_map (outbuffer, &map, GST_MAP_READ);
+    fail_unless (map.size % 188 == 0);
+    for (pos = 0; pos < map.size; pos += 188, offset += 188) {
+      const guint8 *data = map.data + pos;
+      guint pid = GST_READ_UINT16_BE (data + 1) & 0x1fff;
+
+      fail_unless_equals_int (data[0], 0x47);
+      if (pid == 0x1fff)
+        (*null_packets)++;
+
+      /* adaptation field with the PCR flag */
+      if ((data[3] & 0x20) && data[4] >= 7 && (data[5] & 0x10)) {
+        PcrInfo info;
+        guint64 base, ext;
+
+        base = ((guint64) GST_READ_UINT32_BE (data + 6) << 1) | (data[10] >>
+            7);
+        ext = ((data[10] & 0x01) << 8) | data[11];
+
+        info.offset = offset;
+        info.pcr = base * 300 + ext;
+        info.discont = (data[5] & 0x80) != 0;
+        g_array_append_val (pcrs, info);
+      }
+    }
+    gst_buffer_unmap (outbuffer, &map);
+  }
+  gst_check_drop_buffers ();
+
+  return pcrs;
+}
+
+/* Over any window between two PCRs in [@from, @to), the amount of bytes
+ * matches the bitrate to within one packet */
+static void
+check_cbr (GArray * pcrs, guint from, guint to)
+{
+  guint i, j;
+
+  for (i = from; i < to; i++) {
+    for (j = i + 1; j < to; j++) {
+      const PcrInfo *a = &g_array_index (pcrs, PcrInfo, i);
+      const PcrInfo *b = &g_array_index (pcrs, PcrInfo, j);
+      guint64 bytes, expected;
+
+      bytes = b->offset - a->offset;
+      expected =
+          gst_util_uint64_scale (b->pcr - a->pcr, CBR_BITRATE, 8 * 27000000);
+
+      fail_unless (ABS ((gint64) bytes - (gint64) expected) <= 188,
+          "%" G_GUINT64_FORMAT " bytes between PCR %u and %u, expected %"
+          G_GUINT64_FORMAT, bytes, i, j, expected);
+    }
+  }
+}
+
+static void
+push_cbr_frames (guint n_frames, GstClockTime base_ts, gsize size)
+{
+  GstBuffer *inbuffer;
+  guint i;
+
+  for (i = 0; i < n_frames; i++) {
+    gsize frame_size = size ? size : (i % 10) == 0 ? 30000 : 1000 +
+        (i % 3) * 2000;
+
+    inbuffer = gst_buffer_new_and_alloc (frame_size);
+    gst_buffer_memset (inbuffer, 0, 0, frame_size);
+    GST_BUFFER_PTS (inbuffer) = base_ts + i * 40 * GST_MSECOND;
+    GST_BUFFER_DTS (inbuffer) = base_ts + i * 40 * GST_MSECOND;
+    if (i % 10)
+      GST_BUFFER_FLAG_SET (inbuffer, GST_BUFFER_FLAG_DELTA_UNIT);
+    fail_unless (gst_pad_push (mysrcpad, inbuffer) == GST_FLOW_OK);
+  }
+}
+
+GST_START_TEST (test_cbr)
+{
+  GstElement *mux;
+  gchar *padname;
+  GstCaps *caps;
+  GArray *pcrs;
+  guint null_packets, i;
+
+  mux = setup_tsmux (&video_src_template, "sink_%d", &padname);
+  g_object_set (mux, "bitrate", (guint64) CBR_BITRATE, NULL);
+
+  fail_unless (gst_element_set_state (mux,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+
+  caps = gst_caps_from_string (VIDEO_CAPS_STRING);
+  gst_check_setup_events (mysrcpad, mux, caps, GST_FORMAT_TIME);
+  gst_caps_unref (caps);
+
+  /* 2 seconds of very variable frame sizes, well below the bitrate */
+  push_cbr_frames (50, 0, 0);
+  fail_unless (gst_pad_push_event (mysrcpad, gst_event_new_eos ()));
+
+  pcrs = collect_pcrs (CBR_BITRATE, &null_packets);
+
+  fail_unless (null_packets > 0);
+  /* close to 2 seconds at the default interval of 40ms */
+  fail_unless (pcrs->len >= 40);
+  for (i = 0; i < pcrs->len; i++)
+    fail_if (g_array_index (pcrs, PcrInfo, i).discont);
+
+  check_cbr (pcrs, 0, pcrs->len);
+
+  g_array_free (pcrs, TRUE);
+
+  cleanup_tsmux (mux, padname);
+  g_free (padname);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_cbr_timestamp_jump)
+{
+  GstElement *mux;
+  gchar *padname;
+  GstCaps *caps;
+  GArray *pcrs;
+  guint null_packets, i, jump = 0;
+
+  mux = setup_tsmux (&video_src_template, "sink_%d", &padname);
+  g_object_set (mux, "bitrate", (guint64) CBR_BITRATE, NULL);
+
+  fail_unless (gst_element_set_state (mux,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+
+  caps = gst_caps_from_string (VIDEO_CAPS_STRING);
+  gst_check_setup_events (mysrcpad, mux, caps, GST_FORMAT_TIME);
+  gst_caps_unref (caps);
+
+  /* 1 second, then a 10 seconds jump which restarts the CBR output rather
+   * than stuffing it */
+  push_cbr_frames (25, 0, 0);
+  push_cbr_frames (25, 11 * GST_SECOND, 0);
+  fail_unless (gst_pad_push_event (mysrcpad, gst_event_new_eos ()));
+
+  pcrs = collect_pcrs (CBR_BITRATE, &null_packets);
+  fail_unless (pcrs->len >= 40);
+
+  /* Only the first PCR after the jump is flagged as discontinuous */
+  for (i = 0; i < pcrs->len; i++) {
+    if (g_array_index (pcrs, PcrInfo, i).discont) {
+      fail_unless (jump == 0, "PCR %u and %u are both discontinuous", jump,
+          i);
+      jump = i;
+    }
+  }
+  fail_unless (jump > 0);
+  fail_unless (g_array_index (pcrs, PcrInfo, jump).pcr -
+      g_array_index (pcrs, PcrInfo, jump - 1).pcr > 27000000);
+
+  /* and the output is constant bitrate on both sides */
+  check_cbr (pcrs, 0, jump);
+  check_cbr (pcrs, jump, pcrs->len);
+
+  g_array_free (pcrs, TRUE);
+
+  cleanup_tsmux (mux, padname);
+  g_free (padname);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_cbr_overrun)
+{
+  GstElement *mux;
+  gchar *padname;
+  GstCaps *caps;
+  GstBus *bus;
+  GstMessage *msg;
+
+  mux = setup_tsmux (&video_src_template, "sink_%d", &padname);
+  bus = gst_bus_new ();
+  gst_element_set_bus (mux, bus);
+  /* a tenth of what the streams need */
+  g_object_set (mux, "bitrate", (guint64) 200000, NULL);
+
+  fail_unless (gst_element_set_state (mux,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+
+  caps = gst_caps_from_string (VIDEO_CAPS_STRING);
+  gst_check_setup_events (mysrcpad, mux, caps, GST_FORMAT_TIME);
+  gst_caps_unref (caps);
+
+  push_cbr_frames (25, 0, 10000);
+  fail_unless (gst_pad_push_event (mysrcpad, gst_event_new_eos ()));
+  gst_check_drop_buffers ();
+
+  /* The output falling behind is reported once */
+  msg = gst_bus_pop_filtered (bus, GST_MESSAGE_WARNING);
+  fail_unless (msg != NULL);
+  fail_unless (GST_MESSAGE_SRC (msg) == GST_OBJECT (mux));
+  gst_message_unref (msg);
+  fail_unless (gst_bus_pop_filtered (bus, GST_MESSAGE_WARNING) == NULL);
+
+  gst_element_set_bus (mux, NULL);
+  gst_object_unref (bus);
+
+  cleanup_tsmux (mux, padname);
+  g_free (padname);
+}
+
+GST_END_TEST;
+
+/* A key frame that takes longer than the default mux delay to output at the
+ * bitrate makes the output fall behind, unless a longer delay lets it start
+ * earlier. The output is scheduled on the DTS, the PTS of the reordered
+ * frames do not matter. */
+GST_START_TEST (test_cbr_mux_delay)
+{
+  GstElement *mux;
+  gchar *padname;
+  GstCaps *caps;
+  GstBus *bus;
+  GstMessage *msg;
+  GstBuffer *inbuffer;
+  GArray *pcrs;
+  guint null_packets, i, j;
+
+  for (i = 0; i < 2; i++) {
+    mux = setup_tsmux (&video_src_template, "sink_%d", &padname);
+    bus = gst_bus_new ();
+    gst_element_set_bus (mux, bus);
+    g_object_set (mux, "bitrate", (guint64) CBR_BITRATE, NULL);
+    /* a second, the default is an eighth */
+    if (i == 1)
+      g_object_set (mux, "mux-delay", 90000, NULL);
+
+    fail_unless (gst_element_set_state (mux,
+            GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+        "could not set to playing");
+
+    caps = gst_caps_from_string (VIDEO_CAPS_STRING);
+    gst_check_setup_events (mysrcpad, mux, caps, GST_FORMAT_TIME);
+    gst_caps_unref (caps);
+
+    /* a key frame of 0.32s at the bitrate every second, in IBB order */
+    for (j = 0; j < 50; j++) {
+      gsize frame_size = (j % 25) == 0 ? 80000 : 2000;
+
+      inbuffer = gst_buffer_new_and_alloc (frame_size);
+      gst_buffer_memset (inbuffer, 0, 0, frame_size);
+      GST_BUFFER_DTS (inbuffer) = j * 40 * GST_MSECOND;
+      GST_BUFFER_PTS (inbuffer) = GST_BUFFER_DTS (inbuffer) +
+          ((j % 3) == 0 ? 120 * GST_MSECOND : 0);
+      if (j % 25)
+        GST_BUFFER_FLAG_SET (inbuffer, GST_BUFFER_FLAG_DELTA_UNIT);
+      fail_unless (gst_pad_push (mysrcpad, inbuffer) == GST_FLOW_OK);
+    }
+    fail_unless (gst_pad_push_event (mysrcpad, gst_event_new_eos ()));
+
+    pcrs = collect_pcrs (CBR_BITRATE, &null_packets);
+
+    msg = gst_bus_pop_filtered (bus, GST_MESSAGE_WARNING);
+    if (i == 0) {
+      fail_unless (msg != NULL);
+      gst_message_unref (msg);
+    } else {
+      fail_unless (msg == NULL);
+      fail_unless (null_packets > 0);
+      for (j = 0; j < pcrs->len; j++)
+        fail_if (g_array_index (pcrs, PcrInfo, j).discont);
+      check_cbr (pcrs, 0, pcrs->len);
+    }
+    g_array_free (pcrs, TRUE);
+
+    gst_element_set_bus (mux, NULL);
+    gst_object_unref (bus);
+
+    cleanup_tsmux (mux, padname);
+    g_free (padname);
+  }
+}
+
+GST_END_TEST;
+
 static Suite *
 mpegtsmux_suite (void)
 {
@@ -730,6 +1096,11 @@ mpegtsmux_suite (void)
   tcase_add_test (tc_chain, test_force_key_unit_event_upstream);
   tcase_add_test (tc_chain, test_propagate_flow_status);
   tcase_add_test (tc_chain, test_multiple_state_change);
+  tcase_add_test (tc_chain, test_aligned_output);
+  tcase_add_test (tc_chain, test_cbr);
+  tcase_add_test (tc_chain, test_cbr_timestamp_jump);
+  tcase_add_test (tc_chain, test_cbr_overrun);
+  tcase_add_test (tc_chain, test_cbr_mux_delay);
 
   return s;
 }
@@ -42,7 +42,7 @@ GstElement *src, *sink;
 GstPad *sinkpad, *srcpad;
 
 static void
-setup_shm (void)
+setup_shm_full (guint ring_size, guint shm_size)
 {
   gchar *socket_path = NULL;
 
@@ -52,7 +52,10 @@ setup_shm (void)
   srcpad = gst_check_setup_src_pad (sink, &src_template);
   sinkpad = gst_check_setup_sink_pad (src, &sink_template);
 
-  g_object_set (sink, "socket-path", "shm-unit-test", NULL);
+  g_object_set (sink, "socket-path", "shm-unit-test", "ring-size", ring_size,
+      NULL);
+  if (shm_size)
+    g_object_set (sink, "shm-size", shm_size, NULL);
 
   fail_unless (gst_element_set_state (sink, GST_STATE_PLAYING) ==
       GST_STATE_CHANGE_ASYNC);
@@ -69,6 +72,24 @@ setup_shm (void)
       GST_STATE_CHANGE_SUCCESS);
 }
 
+static void
+setup_shm (void)
+{
+  setup_shm_full (0, 0);
+}
+
+static void
+setup_shm_ring (void)
+{
+  setup_shm_full (2, 0);
+}
+
+static void
+setup_shm_small (void)
+{
+  setup_shm_full (0, 1024 * 1024);
+}
+
 static void
 teardown_shm (void)
 {
@@ -169,6 +190,189 @@ GST_START_TEST (test_shm_alloc)
 
 GST_END_TEST;
 
+static GstAllocator *
+get_shm_allocator (GstAllocationParams * params)
+{
+  GstCaps *caps = gst_caps_new_empty_simple ("application/x-test");
+  GstAllocator *alloc;
+  GstQuery *query;
+  GstSegment segment;
+
+  gst_pad_push_event (srcpad, gst_event_new_stream_start ("test"));
+  gst_pad_push_event (srcpad, gst_event_new_caps (caps));
+  gst_segment_init (&segment, GST_FORMAT_BYTES);
+  gst_pad_push_event (srcpad, gst_event_new_segment (&segment));
+
+  query = gst_query_new_allocation (caps, FALSE);
+  gst_caps_unref (caps);
+  fail_unless (gst_pad_peer_query (srcpad, query));
+  fail_unless (gst_query_get_n_allocation_params (query) == 1);
+  gst_query_parse_nth_allocation_param (query, 0, &alloc, params);
+  fail_unless (alloc != NULL);
+  gst_query_unref (query);
+
+  return alloc;
+}
+
+static void
+check_memory (GstMemory * mem, guint8 value)
+{
+  GstMapInfo map;
+  gsize i;
+
+  fail_unless (gst_memory_map (mem, &map, GST_MAP_READ));
+  for (i = 0; i < map.size; i++)
+    fail_unless (map.data[i] == value);
+  gst_memory_unmap (mem, &map);
+}
+
+GST_START_TEST (test_shm_alloc_stress)
+{
+  GstAllocator *alloc;
+  GstAllocationParams params;
+  GstMemory *mems[64] = { NULL, };
+  GstMapInfo map;
+  GRand *rand;
+  guint64 used, high_water_mark;
+  gdouble fragmentation;
+  guint size, n_shm = 0;
+  gint i, n;
+
+  alloc = get_shm_allocator (&params);
+  rand = g_rand_new_with_seed (0);
+
+  /* Mostly small buffers, some of which share pages, and big ones that
+   * don't all fit in the area, each filled with its own value to catch
+   * overlaps */
+  for (i = 0; i < 10000; i++) {
+    n = g_rand_int_range (rand, 0, G_N_ELEMENTS (mems));
+
+    if (mems[n]) {
+      check_memory (mems[n], n);
+      gst_memory_unref (mems[n]);
+      mems[n] = NULL;
+      continue;
+    }
+
+    if (g_rand_int_range (rand, 0, 4))
+      size = g_rand_int_range (rand, 1, 2048);
+    else
+      size = g_rand_int_range (rand, 2048, 128 * 1024);
+
+    mems[n] = gst_allocator_alloc (alloc, size, &params);
+    fail_unless (mems[n] != NULL);
+    if (mems[n]->allocator == alloc)
+      n_shm++;
+
+    fail_unless (gst_memory_map (mems[n], &map, GST_MAP_WRITE));
+    memset (map.data, n, map.size);
+    gst_memory_unmap (mems[n], &map);
+  }
+  g_rand_free (rand);
+  fail_unless (n_shm > 0);
+
+  g_object_get (sink, "shm-high-water-mark", &high_water_mark,
+      "shm-fragmentation", &fragmentation, NULL);
+  fail_unless (high_water_mark > 0);
+  fail_unless (fragmentation >= 0.0 && fragmentation <= 1.0);
+
+  for (n = 0; n < G_N_ELEMENTS (mems); n++) {
+    if (mems[n]) {
+      check_memory (mems[n], n);
+      gst_memory_unref (mems[n]);
+    }
+  }
+
+  /* once everything is freed, the whole area is available again */
+  g_object_get (sink, "shm-size", &size, NULL);
+  size -= params.align | gst_memory_alignment;
+  mems[0] = gst_allocator_alloc (alloc, size, &params);
+  fail_unless (mems[0]->allocator == alloc);
+  gst_memory_unref (mems[0]);
+
+  g_object_get (sink, "shm-used", &used, "shm-fragmentation", &fragmentation,
+      NULL);
+  fail_unless_equals_uint64 (used, 0);
+  fail_unless (fragmentation == 0.0);
+
+  gst_object_unref (alloc);
+  teardown_shm ();
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_shm_ring)
+{
+  GstBuffer *buf;
+  GstSegment segment;
+  guint8 data[16];
+  gint i;
+
+  gst_pad_push_event (srcpad, gst_event_new_stream_start ("test"));
+  gst_segment_init (&segment, GST_FORMAT_BYTES);
+  gst_pad_push_event (srcpad, gst_event_new_segment (&segment));
+
+  /* more buffers than the ring has slots, so this only goes through if the
+   * acks of the dropped buffers come back */
+  g_object_set (sink, "ring-blocking", TRUE, NULL);
+  for (i = 0; i < 20; i++) {
+    buf = gst_buffer_new_allocate (NULL, sizeof (data), NULL);
+    gst_buffer_memset (buf, 0, i, sizeof (data));
+    fail_unless (gst_pad_push (srcpad, buf) == GST_FLOW_OK);
+
+    g_mutex_lock (&check_mutex);
+    while (buffers == NULL)
+      g_cond_wait (&check_cond, &check_mutex);
+    g_mutex_unlock (&check_mutex);
+    fail_unless (g_list_length (buffers) == 1);
+
+    buf = buffers->data;
+    fail_unless (gst_buffer_get_size (buf) == sizeof (data));
+    gst_buffer_extract (buf, 0, data, sizeof (data));
+    fail_unless (data[0] == i && data[sizeof (data) - 1] == i);
+
+    gst_check_drop_buffers ();
+  }
+
+  teardown_shm ();
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_shm_ring_drops)
+{
+  GstBuffer *buf;
+  GstSegment segment;
+  guint64 drops;
+  gint i;
+
+  gst_pad_push_event (srcpad, gst_event_new_stream_start ("test"));
+  gst_segment_init (&segment, GST_FORMAT_BYTES);
+  gst_pad_push_event (srcpad, gst_event_new_segment (&segment));
+
+  /* the received buffers are kept, so nothing is acked and the client
+   * misses the buffers past the 2 slots of its ring without blocking us */
+  for (i = 0; i < 5; i++) {
+    buf = gst_buffer_new_allocate (NULL, 16, NULL);
+    gst_buffer_memset (buf, 0, i, 16);
+    fail_unless (gst_pad_push (srcpad, buf) == GST_FLOW_OK);
+  }
+
+  g_object_get (sink, "ring-drops", &drops, NULL);
+  fail_unless_equals_uint64 (drops, 3);
+
+  g_mutex_lock (&check_mutex);
+  while (g_list_length (buffers) < 2)
+    g_cond_wait (&check_cond, &check_mutex);
+  g_mutex_unlock (&check_mutex);
+  fail_unless (g_list_length (buffers) == 2);
+
+  gst_check_drop_buffers ();
+  teardown_shm ();
+}
+
+GST_END_TEST;
+
 static Suite *
 shm_suite (void)
 {
@@ -181,6 +385,17 @@ shm_suite (void)
   tcase_add_test (tc, test_shm_alloc);
   suite_add_tcase (s, tc);
 
+  tc = tcase_create ("shm-small");
+  tcase_add_checked_fixture (tc, setup_shm_small, NULL);
+  tcase_add_test (tc, test_shm_alloc_stress);
+  suite_add_tcase (s, tc);
+
+  tc = tcase_create ("shm-ring");
+  tcase_add_checked_fixture (tc, setup_shm_ring, NULL);
+  tcase_add_test (tc, test_shm_ring);
+  tcase_add_test (tc, test_shm_ring_drops);
+  suite_add_tcase (s, tc);
+
   return s;
 }
 
@@ -0,0 +1,143 @@
+/* GStreamer
+ *
+ * unit test for tsdemux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <gst/check/gstcheck.h>
+#include <string.h>
+
+static void
+handoff_cb (GstElement * fakesink, GstBuffer * buffer, GstPad * pad,
+    GstBuffer ** out)
+{
+  gst_buffer_replace (out, buffer);
+}
+
+/* Muxes a single video frame of @size bytes and returns the buffer tsdemux
+ * outputs for it, with its input data in @data */
+static GstBuffer *
+demux_video_frame (gsize size, guint8 ** data)
+{
+  GstElement *pipeline, *src, *sink;
+  GstBuffer *in, *out = NULL;
+  GstFlowReturn flow;
+  GstMessage *msg;
+  GstBus *bus;
+  gsize i;
+
+  pipeline = gst_parse_launch ("appsrc name=src format=time "
+      "caps=video/x-h264,stream-format=byte-stream,alignment=au ! "
+      "mpegtsmux ! tsdemux ! fakesink name=sink signal-handoffs=true", NULL);
+  fail_unless (pipeline != NULL);
+
+  sink = gst_bin_get_by_name (GST_BIN (pipeline), "sink");
+  g_signal_connect (sink, "handoff", G_CALLBACK (handoff_cb), &out);
+  gst_object_unref (sink);
+
+  *data = g_malloc (size);
+  for (i = 0; i < size; i++)
+    (*data)[i] = 0x10 + i % 0xe0;
+  /* access unit delimiter, then an IDR slice */
+  memcpy (*data, "\x00\x00\x00\x01\x09\xf0\x00\x00\x00\x01\x65", 11);
+
+  in = gst_buffer_new_wrapped (g_memdup (*data, size), size);
+  GST_BUFFER_PTS (in) = GST_BUFFER_DTS (in) = 0;
+  GST_BUFFER_DURATION (in) = 40 * GST_MSECOND;
+
+  bus = gst_element_get_bus (pipeline);
+  fail_unless (gst_element_set_state (pipeline, GST_STATE_PLAYING) !=
+      GST_STATE_CHANGE_FAILURE);
+
+  src = gst_bin_get_by_name (GST_BIN (pipeline), "src");
+  g_signal_emit_by_name (src, "push-buffer", in, &flow);
+  fail_unless_equals_int (flow, GST_FLOW_OK);
+  gst_buffer_unref (in);
+  g_signal_emit_by_name (src, "end-of-stream", &flow);
+  gst_object_unref (src);
+
+  msg = gst_bus_timed_pop_filtered (bus, GST_CLOCK_TIME_NONE,
+      GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  fail_unless_equals_int (GST_MESSAGE_TYPE (msg), GST_MESSAGE_EOS);
+  gst_message_unref (msg);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (bus);
+  gst_object_unref (pipeline);
+
+  fail_unless (out != NULL);
+  fail_unless_equals_uint64 (gst_buffer_get_size (out), size);
+
+  return out;
+}
+
+/* a PES made of a few TS packets shares the memory of the input buffers */
+GST_START_TEST (test_small_pes)
+{
+  GstBuffer *out;
+  guint8 *data;
+  guint i;
+
+  out = demux_video_frame (1000, &data);
+
+  fail_unless (gst_buffer_n_memory (out) > 1);
+  for (i = 0; i < gst_buffer_n_memory (out); i++)
+    fail_unless (gst_buffer_peek_memory (out, i)->parent != NULL);
+  fail_unless (gst_buffer_memcmp (out, 0, data, 1000) == 0);
+
+  gst_buffer_unref (out);
+  g_free (data);
+}
+
+GST_END_TEST;
+
+/* a PES spanning more TS packets than a buffer can hold memories is
+ * copied into a single contiguous memory */
+GST_START_TEST (test_large_pes)
+{
+  GstBuffer *out;
+  GstMemory *mem;
+  guint8 *data;
+
+  out = demux_video_frame (200000, &data);
+
+  fail_unless_equals_int (gst_buffer_n_memory (out), 1);
+  mem = gst_buffer_peek_memory (out, 0);
+  fail_unless (mem->parent == NULL);
+  fail_unless (gst_buffer_memcmp (out, 0, data, 200000) == 0);
+
+  gst_buffer_unref (out);
+  g_free (data);
+}
+
+GST_END_TEST;
+
+static Suite *
+tsdemux_suite (void)
+{
+  Suite *s = suite_create ("tsdemux");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+
+  tcase_add_test (tc_chain, test_small_pes);
+  tcase_add_test (tc_chain, test_large_pes);
+
+  return s;
+}
+
+GST_CHECK_MAIN (tsdemux);
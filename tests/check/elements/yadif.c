@@ -0,0 +1,249 @@
+/* GStreamer
+ *
+ * unit test for yadif
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <string.h>
+
+#include <gst/check/gstcheck.h>
+#include <gst/video/video.h>
+
+#define WIDTH 32
+#define HEIGHT 16
+#define FRAME_DURATION (GST_SECOND / 25)
+
+/* luma of the lines of the top and of the bottom field of the input */
+#define TOP_LUMA 200
+#define BOTTOM_LUMA 50
+
+#define VIDEO_CAPS_STRING \
+    "video/x-raw, format = (string) I420, width = (int) 32, " \
+    "height = (int) 16, framerate = (fraction) 25/1, " \
+    "interlace-mode = (string) interleaved"
+
+static GstPad *mysrcpad, *mysinkpad;
+
+static GstStaticPadTemplate sinktemplate = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("video/x-raw, format = (string) I420, "
+        "interlace-mode = (string) progressive"));
+
+static GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS (VIDEO_CAPS_STRING));
+
+static GstElement *
+setup_yadif (gboolean double_rate, guint n_threads)
+{
+  GstElement *yadif;
+  GstCaps *caps;
+
+  yadif = gst_check_setup_element ("yadif");
+  g_object_set (yadif, "double-rate", double_rate, "n-threads", n_threads,
+      NULL);
+  mysrcpad = gst_check_setup_src_pad (yadif, &srctemplate);
+  mysinkpad = gst_check_setup_sink_pad (yadif, &sinktemplate);
+  gst_pad_set_active (mysrcpad, TRUE);
+  gst_pad_set_active (mysinkpad, TRUE);
+
+  fail_unless (gst_element_set_state (yadif,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS);
+
+  caps = gst_caps_from_string (VIDEO_CAPS_STRING);
+  gst_check_setup_events (mysrcpad, yadif, caps, GST_FORMAT_TIME);
+  gst_caps_unref (caps);
+
+  return yadif;
+}
+
+static void
+cleanup_yadif (GstElement * yadif)
+{
+  gst_check_drop_buffers ();
+
+  fail_unless (gst_element_set_state (yadif,
+          GST_STATE_NULL) == GST_STATE_CHANGE_SUCCESS);
+  gst_pad_set_active (mysrcpad, FALSE);
+  gst_pad_set_active (mysinkpad, FALSE);
+  gst_check_teardown_src_pad (yadif);
+  gst_check_teardown_sink_pad (yadif);
+  gst_check_teardown_element (yadif);
+}
+
+/* Pushes the @index-th frame, its fields filled with TOP_LUMA and
+ * BOTTOM_LUMA */
+static void
+push_frame (guint index, gboolean tff)
+{
+  GstVideoInfo info;
+  GstVideoFrame frame;
+  GstBuffer *buffer;
+  guint8 *data;
+  gint y;
+
+  gst_video_info_set_format (&info, GST_VIDEO_FORMAT_I420, WIDTH, HEIGHT);
+  buffer = gst_buffer_new_and_alloc (GST_VIDEO_INFO_SIZE (&info));
+  fail_unless (gst_video_frame_map (&frame, &info, buffer, GST_MAP_WRITE));
+  for (y = 0; y < HEIGHT; y++) {
+    data = GST_VIDEO_FRAME_COMP_DATA (&frame, 0) +
+        y * GST_VIDEO_FRAME_COMP_STRIDE (&frame, 0);
+    memset (data, y & 1 ? BOTTOM_LUMA : TOP_LUMA, WIDTH);
+  }
+  for (y = 0; y < HEIGHT / 2; y++) {
+    memset (GST_VIDEO_FRAME_COMP_DATA (&frame, 1) +
+        y * GST_VIDEO_FRAME_COMP_STRIDE (&frame, 1), 128, WIDTH / 2);
+    memset (GST_VIDEO_FRAME_COMP_DATA (&frame, 2) +
+        y * GST_VIDEO_FRAME_COMP_STRIDE (&frame, 2), 128, WIDTH / 2);
+  }
+  gst_video_frame_unmap (&frame);
+
+  GST_BUFFER_PTS (buffer) = index * FRAME_DURATION;
+  GST_BUFFER_DURATION (buffer) = FRAME_DURATION;
+  if (tff)
+    GST_BUFFER_FLAG_SET (buffer, GST_VIDEO_BUFFER_FLAG_TFF);
+
+  fail_unless_equals_int (gst_pad_push (mysrcpad, buffer), GST_FLOW_OK);
+}
+
+/* Checks that the lines away from the edges of the output frame have the
+ * luma of the field it was interpolated from */
+static void
+check_frame (GstBuffer * buffer, guint8 luma, GstClockTime pts,
+    GstClockTime duration)
+{
+  GstVideoInfo info;
+  GstVideoFrame frame;
+  guint8 *data;
+  gint x, y;
+
+  fail_unless_equals_uint64 (GST_BUFFER_PTS (buffer), pts);
+  fail_unless_equals_uint64 (GST_BUFFER_DURATION (buffer), duration);
+  fail_if (GST_BUFFER_FLAG_IS_SET (buffer, GST_VIDEO_BUFFER_FLAG_INTERLACED));
+
+  gst_video_info_set_format (&info, GST_VIDEO_FORMAT_I420, WIDTH, HEIGHT);
+  fail_unless (gst_video_frame_map (&frame, &info, buffer, GST_MAP_READ));
+  for (y = 2; y < HEIGHT - 2; y++) {
+    data = GST_VIDEO_FRAME_COMP_DATA (&frame, 0) +
+        y * GST_VIDEO_FRAME_COMP_STRIDE (&frame, 0);
+    for (x = 0; x < WIDTH; x++)
+      fail_unless (data[x] == luma, "luma %u at %d,%d instead of %u", data[x],
+          x, y, luma);
+  }
+  gst_video_frame_unmap (&frame);
+}
+
+/* The lines of the field shown first are kept, the others are interpolated
+ * from them */
+GST_START_TEST (test_field_order)
+{
+  GstElement *yadif;
+
+  yadif = setup_yadif (FALSE, 1);
+
+  push_frame (0, TRUE);
+  push_frame (1, TRUE);
+  push_frame (2, FALSE);
+  push_frame (3, FALSE);
+  fail_unless_equals_int (g_list_length (buffers), 3);
+
+  check_frame (g_list_nth_data (buffers, 0), TOP_LUMA, 0, FRAME_DURATION);
+  check_frame (g_list_nth_data (buffers, 1), TOP_LUMA, FRAME_DURATION,
+      FRAME_DURATION);
+  check_frame (g_list_nth_data (buffers, 2), BOTTOM_LUMA, 2 * FRAME_DURATION,
+      FRAME_DURATION);
+
+  cleanup_yadif (yadif);
+}
+
+GST_END_TEST;
+
+/* With double-rate, each field gets its own frame, in the order they are
+ * shown, at twice the frame rate */
+GST_START_TEST (test_double_rate)
+{
+  GstElement *yadif;
+  GstClockTime half = FRAME_DURATION / 2;
+
+  yadif = setup_yadif (TRUE, 4);
+
+  push_frame (0, TRUE);
+  push_frame (1, FALSE);
+  push_frame (2, TRUE);
+  fail_unless_equals_int (g_list_length (buffers), 4);
+
+  check_frame (g_list_nth_data (buffers, 0), TOP_LUMA, 0, half);
+  check_frame (g_list_nth_data (buffers, 1), BOTTOM_LUMA, half,
+      FRAME_DURATION - half);
+  check_frame (g_list_nth_data (buffers, 2), BOTTOM_LUMA, FRAME_DURATION,
+      half);
+  check_frame (g_list_nth_data (buffers, 3), TOP_LUMA, FRAME_DURATION + half,
+      FRAME_DURATION - half);
+
+  cleanup_yadif (yadif);
+}
+
+GST_END_TEST;
+
+/* The last frame waits for a next one, and is output at the end of the
+ * stream */
+GST_START_TEST (test_drain_at_eos)
+{
+  GstElement *yadif;
+  GstEvent *event;
+
+  yadif = setup_yadif (TRUE, 0);
+
+  push_frame (0, TRUE);
+  push_frame (1, TRUE);
+  fail_unless_equals_int (g_list_length (buffers), 2);
+
+  fail_unless (gst_pad_push_event (mysrcpad, gst_event_new_eos ()));
+  fail_unless_equals_int (g_list_length (buffers), 4);
+  check_frame (g_list_nth_data (buffers, 2), TOP_LUMA, FRAME_DURATION,
+      FRAME_DURATION / 2);
+  check_frame (g_list_nth_data (buffers, 3), BOTTOM_LUMA,
+      FRAME_DURATION + FRAME_DURATION / 2,
+      FRAME_DURATION - FRAME_DURATION / 2);
+
+  /* and the EOS still goes downstream */
+  event = gst_pad_get_sticky_event (mysinkpad, GST_EVENT_EOS, 0);
+  fail_unless (event != NULL);
+  gst_event_unref (event);
+
+  cleanup_yadif (yadif);
+}
+
+GST_END_TEST;
+
+static Suite *
+yadif_suite (void)
+{
+  Suite *s = suite_create ("yadif");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_field_order);
+  tcase_add_test (tc_chain, test_double_rate);
+  tcase_add_test (tc_chain, test_drain_at_eos);
+
+  return s;
+}
+
+GST_CHECK_MAIN (yadif);
@@ -55,6 +55,8 @@ struct _GstTestAggregator
   GstAggregator parent;
 
   guint64 timestamp;
+  /* running times of the consumed timestamped buffers */
+  GArray *running_times;
 };
 
 struct _GstTestAggregatorClass
@@ -87,6 +89,14 @@ gst_test_aggregator_aggregate (GstAggregator * aggregator)
         if (pad->eos == FALSE)
           all_eos = FALSE;
         buffer = gst_aggregator_pad_steal_buffer (pad);
+        if (buffer && GST_BUFFER_PTS_IS_VALID (buffer) &&
+            pad->segment.format == GST_FORMAT_TIME) {
+          GstClockTime running_time;
+
+          running_time = gst_segment_to_running_time (&pad->segment,
+              GST_FORMAT_TIME, GST_BUFFER_PTS (buffer));
+          g_array_append_val (testagg->running_times, running_time);
+        }
         gst_buffer_replace (&buffer, NULL);
 
         g_value_reset (&value);
@@ -125,9 +135,20 @@ gst_test_aggregator_aggregate (GstAggregator * aggregator)
 #define gst_test_aggregator_parent_class parent_class
 G_DEFINE_TYPE (GstTestAggregator, gst_test_aggregator, GST_TYPE_AGGREGATOR);
 
+static void
+gst_test_aggregator_finalize (GObject * object)
+{
+  GstTestAggregator *self = GST_TEST_AGGREGATOR (object);
+
+  g_array_free (self->running_times, TRUE);
+
+  G_OBJECT_CLASS (parent_class)->finalize (object);
+}
+
 static void
 gst_test_aggregator_class_init (GstTestAggregatorClass * klass)
 {
+  GObjectClass *gobject_class = (GObjectClass *) klass;
   GstElementClass *gstelement_class = (GstElementClass *) klass;
   GstAggregatorClass *base_aggregator_class = (GstAggregatorClass *) klass;
 
@@ -148,6 +169,8 @@ gst_test_aggregator_class_init (GstTestAggregatorClass * klass)
   gst_element_class_set_static_metadata (gstelement_class, "Aggregator",
       "Testing", "Combine N buffers", "Stefan Sauer <ensonic@users.sf.net>");
 
+  gobject_class->finalize = gst_test_aggregator_finalize;
+
   base_aggregator_class->aggregate =
       GST_DEBUG_FUNCPTR (gst_test_aggregator_aggregate);
 }
@@ -158,6 +181,7 @@ gst_test_aggregator_init (GstTestAggregator * self)
   GstAggregator *agg = GST_AGGREGATOR (self);
   gst_segment_init (&agg->segment, GST_FORMAT_BYTES);
   self->timestamp = 0;
+  self->running_times = g_array_new (FALSE, FALSE, sizeof (GstClockTime));
 }
 
 static gboolean
@@ -453,6 +477,199 @@ GST_START_TEST (test_aggregate_eos)
 
 GST_END_TEST;
 
+#define QUEUED_BUFFERS 3
+
+GST_START_TEST (test_aggregate_queue)
+{
+  GThread *thread;
+  GstSegment segment;
+  GstCaps *caps;
+  guint max_buffers;
+  gint i;
+
+  ChainData data1 = { 0, };
+  ChainData data2 = { 0, };
+  TestData test = { 0, };
+
+  _test_data_init (&test, FALSE);
+  _chain_data_init (&data1, test.aggregator);
+  _chain_data_init (&data2, test.aggregator);
+
+  g_object_get (data1.sinkpad, "max-buffers", &max_buffers, NULL);
+  fail_unless_equals_int (max_buffers, 1);
+  g_object_set (data1.sinkpad, "max-buffers", QUEUED_BUFFERS, NULL);
+
+  gst_pad_push_event (data1.srcpad, gst_event_new_stream_start ("test"));
+  caps = gst_caps_new_empty_simple ("foo/x-bar");
+  gst_pad_push_event (data1.srcpad, gst_event_new_caps (caps));
+  gst_caps_unref (caps);
+  gst_segment_init (&segment, GST_FORMAT_TIME);
+  gst_pad_push_event (data1.srcpad, gst_event_new_segment (&segment));
+
+  /* Nothing can be aggregated as long as the second pad has no data, these
+   * must be queued without blocking */
+  for (i = 0; i < QUEUED_BUFFERS; i++) {
+    fail_unless_equals_int (gst_pad_push (data1.srcpad, gst_buffer_new ()),
+        GST_FLOW_OK);
+  }
+
+  data2.event = gst_event_new_eos ();
+  thread = g_thread_try_new ("gst-check", push_event, &data2, NULL);
+
+  g_main_loop_run (test.ml);
+  g_source_remove (test.timeout_id);
+
+  g_thread_join (thread);
+
+  _chain_data_clear (&data1);
+  _chain_data_clear (&data2);
+  _test_data_clear (&test);
+}
+
+GST_END_TEST;
+
+static GstPadProbeReturn
+_eos_cb (GstPad * pad, GstPadProbeInfo * info, GMainLoop * ml)
+{
+  if (GST_EVENT_TYPE (GST_PAD_PROBE_INFO_EVENT (info)) == GST_EVENT_EOS) {
+    g_object_set_data (G_OBJECT (pad), "got-eos", GINT_TO_POINTER (TRUE));
+    g_idle_add ((GSourceFunc) _quit, ml);
+  }
+
+  return GST_PAD_PROBE_OK;
+}
+
+GST_START_TEST (test_aggregate_queued_segment)
+{
+  GstTestAggregator *testagg;
+  GstSegment segment;
+  GstBuffer *buffer;
+  GstCaps *caps;
+  gint i;
+
+  ChainData data1 = { 0, };
+  ChainData data2 = { 0, };
+  TestData test = { 0, };
+
+  _test_data_init (&test, FALSE);
+  _chain_data_init (&data1, test.aggregator);
+  _chain_data_init (&data2, test.aggregator);
+  testagg = GST_TEST_AGGREGATOR (test.aggregator);
+
+  gst_pad_add_probe (test.srcpad, GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM,
+      (GstPadProbeCallback) _eos_cb, test.ml, NULL);
+
+  g_object_set (data1.sinkpad, "max-buffers", 4, NULL);
+
+  gst_pad_push_event (data1.srcpad, gst_event_new_stream_start ("test"));
+  caps = gst_caps_new_empty_simple ("foo/x-bar");
+  gst_pad_push_event (data1.srcpad, gst_event_new_caps (caps));
+  gst_caps_unref (caps);
+  gst_segment_init (&segment, GST_FORMAT_TIME);
+  gst_pad_push_event (data1.srcpad, gst_event_new_segment (&segment));
+
+  /* The second pad has no data yet, so everything is queued on the first
+   * one, the new segment in the middle of the buffers */
+  for (i = 0; i < 4; i++) {
+    if (i == 2) {
+      segment.base = 10 * GST_SECOND;
+      fail_unless (gst_pad_push_event (data1.srcpad,
+              gst_event_new_segment (&segment)));
+    }
+    buffer = gst_buffer_new ();
+    GST_BUFFER_PTS (buffer) = (i % 2) * BUFFER_DURATION;
+    GST_BUFFER_DURATION (buffer) = BUFFER_DURATION;
+    fail_unless_equals_int (gst_pad_push (data1.srcpad, buffer), GST_FLOW_OK);
+  }
+  fail_unless (gst_pad_push_event (data1.srcpad, gst_event_new_eos ()));
+  fail_unless (gst_pad_push_event (data2.srcpad, gst_event_new_eos ()));
+
+  while (!g_object_get_data (G_OBJECT (test.srcpad), "got-eos"))
+    g_main_loop_run (test.ml);
+  g_source_remove (test.timeout_id);
+
+  /* The segment only applies to the buffers pushed after it */
+  fail_unless_equals_int (testagg->running_times->len, 4);
+  fail_unless_equals_uint64 (g_array_index (testagg->running_times,
+          GstClockTime, 0), 0);
+  fail_unless_equals_uint64 (g_array_index (testagg->running_times,
+          GstClockTime, 1), BUFFER_DURATION);
+  fail_unless_equals_uint64 (g_array_index (testagg->running_times,
+          GstClockTime, 2), 10 * GST_SECOND);
+  fail_unless_equals_uint64 (g_array_index (testagg->running_times,
+          GstClockTime, 3), 10 * GST_SECOND + BUFFER_DURATION);
+
+  _chain_data_clear (&data1);
+  _chain_data_clear (&data2);
+  _test_data_clear (&test);
+}
+
+GST_END_TEST;
+
+static gboolean
+_live_query_func (GstPad * pad, GstObject * parent, GstQuery * query)
+{
+  if (GST_QUERY_TYPE (query) == GST_QUERY_LATENCY) {
+    gst_query_set_latency (query, TRUE, 0, GST_CLOCK_TIME_NONE);
+    return TRUE;
+  }
+
+  return gst_pad_query_default (pad, parent, query);
+}
+
+GST_START_TEST (test_aggregate_live_timeout)
+{
+  GThread *thread;
+  GstClock *clock;
+  GstQuery *query;
+  gboolean live;
+  GstClockTime min, max;
+
+  ChainData data1 = { 0, };
+  ChainData data2 = { 0, };
+  TestData test = { 0, };
+
+  _test_data_init (&test, FALSE);
+  _chain_data_init (&data1, test.aggregator);
+  _chain_data_init (&data2, test.aggregator);
+
+  gst_pad_set_query_function (data1.srcpad, _live_query_func);
+  gst_pad_set_query_function (data2.srcpad, _live_query_func);
+
+  clock = gst_system_clock_obtain ();
+  gst_element_set_clock (test.aggregator, clock);
+  gst_element_set_base_time (test.aggregator, gst_clock_get_time (clock));
+  gst_object_unref (clock);
+
+  g_object_set (test.aggregator, "latency", 10 * GST_MSECOND, NULL);
+  query = gst_query_new_latency ();
+  fail_unless (gst_pad_query (test.srcpad, query));
+  gst_query_parse_latency (query, &live, &min, &max);
+  fail_unless (live);
+  fail_unless_equals_uint64 (min, 10 * GST_MSECOND);
+  fail_unless_equals_uint64 (max, GST_CLOCK_TIME_NONE);
+  gst_query_unref (query);
+
+  /* Only the first pad gets data, the output must still be produced once the
+   * deadline is reached */
+  thread = g_thread_try_new ("gst-check", push_buffer, &data1, NULL);
+
+  g_main_loop_run (test.ml);
+  g_source_remove (test.timeout_id);
+
+  g_thread_join (thread);
+
+  fail_if (gst_aggregator_pad_is_late (GST_AGGREGATOR_PAD (data1.sinkpad)));
+  fail_unless (gst_aggregator_pad_is_late (GST_AGGREGATOR_PAD
+          (data2.sinkpad)));
+
+  _chain_data_clear (&data1);
+  _chain_data_clear (&data2);
+  _test_data_clear (&test);
+}
+
+GST_END_TEST;
+
 #define NUM_BUFFERS 3
 static void
 handoff (GstElement * fakesink, GstBuffer * buf, GstPad * pad, guint * count)
@@ -1012,6 +1229,9 @@ gst_aggregator_suite (void)
   suite_add_tcase (suite, general);
   tcase_add_test (general, test_aggregate);
   tcase_add_test (general, test_aggregate_eos);
+  tcase_add_test (general, test_aggregate_queue);
+  tcase_add_test (general, test_aggregate_queued_segment);
+  tcase_add_test (general, test_aggregate_live_timeout);
   tcase_add_test (general, test_flushing_seek);
   tcase_add_test (general, test_infinite_seek);
   tcase_add_test (general, test_infinite_seek_50_src);
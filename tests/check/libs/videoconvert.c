@@ -0,0 +1,246 @@
+/* GStreamer
+ *
+ * unit test for the converter of libgstbadvideo
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include <string.h>
+
+#include <gst/check/gstcheck.h>
+#include <gst/video/videoconvert.h>
+
+#define WIDTH 322
+#define HEIGHT 242
+
+static const GstVideoFormat formats[] = {
+  GST_VIDEO_FORMAT_I420,
+  GST_VIDEO_FORMAT_YV12,
+  GST_VIDEO_FORMAT_NV12,
+  GST_VIDEO_FORMAT_AYUV,
+  GST_VIDEO_FORMAT_BGRA,
+  GST_VIDEO_FORMAT_BGRx,
+};
+
+static GstBuffer *
+create_frame (GstVideoInfo * info, GRand * rand)
+{
+  GstBuffer *buffer;
+  GstMapInfo map;
+  gsize i;
+
+  buffer = gst_buffer_new_allocate (NULL, GST_VIDEO_INFO_SIZE (info), NULL);
+  gst_buffer_map (buffer, &map, GST_MAP_WRITE);
+  if (rand) {
+    for (i = 0; i < map.size; i++)
+      map.data[i] = g_rand_int_range (rand, 0, 256);
+  } else {
+    memset (map.data, 0, map.size);
+  }
+  gst_buffer_unmap (buffer, &map);
+
+  return buffer;
+}
+
+static GstBuffer *
+convert_frame (GstVideoInfo * in_info, GstVideoInfo * out_info,
+    GstBuffer * inbuf, gint dither, guint n_threads)
+{
+  VideoConvert *convert;
+  GstVideoFrame in_frame, out_frame;
+  GstBuffer *outbuf;
+
+  convert = badvideoconvert_convert_new (in_info, out_info);
+  fail_unless (convert != NULL);
+  badvideoconvert_convert_set_n_threads (convert, n_threads);
+  badvideoconvert_convert_set_dither (convert, dither);
+
+  outbuf = create_frame (out_info, NULL);
+  fail_unless (gst_video_frame_map (&in_frame, in_info, inbuf, GST_MAP_READ));
+  fail_unless (gst_video_frame_map (&out_frame, out_info, outbuf,
+          GST_MAP_WRITE));
+  badvideoconvert_convert_convert (convert, &out_frame, &in_frame);
+  gst_video_frame_unmap (&out_frame);
+  gst_video_frame_unmap (&in_frame);
+
+  badvideoconvert_convert_free (convert);
+
+  return outbuf;
+}
+
+GST_START_TEST (test_sliced_conversion)
+{
+  GstVideoInfo in_info, out_info;
+  GstBuffer *inbuf, *outbuf, *sliced_outbuf;
+  GstMapInfo map, sliced_map;
+  GRand *rand;
+  guint i, j;
+
+  rand = g_rand_new_with_seed (42);
+
+  /* Every pair of formats, fast paths and generic path alike, gives the
+   * same output when the frame is converted in slices */
+  for (i = 0; i < G_N_ELEMENTS (formats); i++) {
+    for (j = 0; j < G_N_ELEMENTS (formats); j++) {
+      if (i == j)
+        continue;
+
+      GST_DEBUG ("converting %s to %s",
+          gst_video_format_to_string (formats[i]),
+          gst_video_format_to_string (formats[j]));
+
+      gst_video_info_set_format (&in_info, formats[i], WIDTH, HEIGHT);
+      gst_video_info_set_format (&out_info, formats[j], WIDTH, HEIGHT);
+
+      inbuf = create_frame (&in_info, rand);
+      outbuf = convert_frame (&in_info, &out_info, inbuf, 0, 1);
+      sliced_outbuf = convert_frame (&in_info, &out_info, inbuf, 0, 4);
+
+      gst_buffer_map (outbuf, &map, GST_MAP_READ);
+      gst_buffer_map (sliced_outbuf, &sliced_map, GST_MAP_READ);
+      fail_unless_equals_int (map.size, sliced_map.size);
+      fail_unless (memcmp (map.data, sliced_map.data, map.size) == 0,
+          "sliced conversion from %s to %s differs",
+          gst_video_format_to_string (formats[i]),
+          gst_video_format_to_string (formats[j]));
+      gst_buffer_unmap (sliced_outbuf, &sliced_map);
+      gst_buffer_unmap (outbuf, &map);
+
+      gst_buffer_unref (sliced_outbuf);
+      gst_buffer_unref (outbuf);
+      gst_buffer_unref (inbuf);
+    }
+  }
+
+  g_rand_free (rand);
+}
+
+GST_END_TEST;
+
+/* The error diffusion dither carries the error over from line to line, the
+ * frames are not sliced with it */
+GST_START_TEST (test_verterr_dither)
+{
+  GstVideoInfo in_info, out_info;
+  GstBuffer *inbuf, *outbuf, *threaded_outbuf;
+  GstMapInfo map, threaded_map;
+  GRand *rand;
+
+  rand = g_rand_new_with_seed (42);
+
+  gst_video_info_set_format (&in_info, GST_VIDEO_FORMAT_AYUV64, WIDTH, HEIGHT);
+  gst_video_info_set_format (&out_info, GST_VIDEO_FORMAT_I420, WIDTH, HEIGHT);
+
+  inbuf = create_frame (&in_info, rand);
+  outbuf = convert_frame (&in_info, &out_info, inbuf, 1, 1);
+  threaded_outbuf = convert_frame (&in_info, &out_info, inbuf, 1, 4);
+
+  gst_buffer_map (outbuf, &map, GST_MAP_READ);
+  gst_buffer_map (threaded_outbuf, &threaded_map, GST_MAP_READ);
+  fail_unless_equals_int (map.size, threaded_map.size);
+  fail_unless (memcmp (map.data, threaded_map.data, map.size) == 0);
+  gst_buffer_unmap (threaded_outbuf, &threaded_map);
+  gst_buffer_unmap (outbuf, &map);
+
+  gst_buffer_unref (threaded_outbuf);
+  gst_buffer_unref (outbuf);
+  gst_buffer_unref (inbuf);
+  g_rand_free (rand);
+}
+
+GST_END_TEST;
+
+/* Scaling down 4 times averages each 4x4 block of a pattern repeating every
+ * 4 pixels and lines, which nearest or 2 tap sampling would alias. The chroma
+ * alternating every sample is upsampled first and averages out as well. */
+GST_START_TEST (test_scale_down)
+{
+  GstVideoInfo in_info, out_info;
+  GstVideoFrame frame;
+  GstBuffer *inbuf, *outbuf;
+  guint8 *data, *u, *v;
+  gint x, y, stride;
+
+  gst_video_info_set_format (&in_info, GST_VIDEO_FORMAT_I420, 64, 64);
+  gst_video_info_set_format (&out_info, GST_VIDEO_FORMAT_I420, 16, 16);
+
+  inbuf = create_frame (&in_info, NULL);
+  fail_unless (gst_video_frame_map (&frame, &in_info, inbuf, GST_MAP_WRITE));
+  data = GST_VIDEO_FRAME_COMP_DATA (&frame, 0);
+  stride = GST_VIDEO_FRAME_COMP_STRIDE (&frame, 0);
+  for (y = 0; y < 64; y++)
+    for (x = 0; x < 64; x++)
+      data[y * stride + x] = (x % 4 == 0 || y % 4 == 0) ? 235 : 16;
+  u = GST_VIDEO_FRAME_COMP_DATA (&frame, 1);
+  v = GST_VIDEO_FRAME_COMP_DATA (&frame, 2);
+  stride = GST_VIDEO_FRAME_COMP_STRIDE (&frame, 1);
+  for (y = 0; y < 32; y++) {
+    for (x = 0; x < 32; x++) {
+      u[y * stride + x] = ((x + y) & 1) ? 240 : 16;
+      v[y * stride + x] = ((x + y) & 1) ? 16 : 240;
+    }
+  }
+  gst_video_frame_unmap (&frame);
+
+  outbuf = convert_frame (&in_info, &out_info, inbuf, 0, 1);
+
+  /* the edges repeat the edge pixels and are left out, the blocks are 7
+   * pixels of 235 and 9 of 16 */
+  fail_unless (gst_video_frame_map (&frame, &out_info, outbuf, GST_MAP_READ));
+  data = GST_VIDEO_FRAME_COMP_DATA (&frame, 0);
+  stride = GST_VIDEO_FRAME_COMP_STRIDE (&frame, 0);
+  for (y = 1; y < 15; y++)
+    for (x = 1; x < 15; x++)
+      fail_unless (ABS (data[y * stride + x] - 112) <= 1,
+          "luma %d at %d,%d", data[y * stride + x], x, y);
+  u = GST_VIDEO_FRAME_COMP_DATA (&frame, 1);
+  v = GST_VIDEO_FRAME_COMP_DATA (&frame, 2);
+  stride = GST_VIDEO_FRAME_COMP_STRIDE (&frame, 1);
+  for (y = 1; y < 7; y++) {
+    for (x = 1; x < 7; x++) {
+      fail_unless (ABS (u[y * stride + x] - 128) <= 2,
+          "u %d at %d,%d", u[y * stride + x], x, y);
+      fail_unless (ABS (v[y * stride + x] - 128) <= 2,
+          "v %d at %d,%d", v[y * stride + x], x, y);
+    }
+  }
+  gst_video_frame_unmap (&frame);
+
+  gst_buffer_unref (outbuf);
+  gst_buffer_unref (inbuf);
+}
+
+GST_END_TEST;
+
+static Suite *
+videoconvert_suite (void)
+{
+  Suite *s = suite_create ("videoconvert");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_sliced_conversion);
+  tcase_add_test (tc_chain, test_verterr_dither);
+  tcase_add_test (tc_chain, test_scale_down);
+
+  return s;
+}
+
+GST_CHECK_MAIN (videoconvert);